@@ -32,6 +32,7 @@
 #include "marginal_probability_density_evolution_monte_carlo.h"
 #include "type1pili_gillespie_ci.h"
 #include "ctmc_analysis_back_end_processor.h"
+#include "ctmc_stationary_analysis_back_end_processor.h"
 #include "ssa_with_user_update.h"
 
 static RET_VAL _AddPostProcessingMethods( COMPILER_RECORD_T *record, char *methodIDs[] );
@@ -81,6 +82,7 @@ typedef struct {
 
 BACK_END_PROCESSOR_INFO *GetInfoOnBackEndProcessors() {
     static BACK_END_PROCESSOR_INFO info[] = {
+        { "bsimp", 1, "${out-dir}/bsimp-run.${ext}", "ODE simulation with Bader and Deuflhard's semi-implicit extrapolation method" },
         { "bunker", 1, "${out-dir}/run-${run-num}.${ext}", "perform Bunker's method, i.e., Gillepie's method except for the next reaction time is averaged" },
         { "dot", 0, "./${filename}.dot", "Generate a dot file of the network" },
         { "euler", 1, "${out-dir}/euler-run.${ext}", "ODE simulation with Euler method" },
@@ -90,6 +92,8 @@ BACK_END_PROCESSOR_INFO *GetInfoOnBackEndProcessors() {
         { "mp", 1, "${out-dir}/run-${run-num}.${ext}", "perform mean path method" },
         { "mp-adaptive", 1, "${out-dir}/run-${run-num}.${ext}", "perform mean path adaptive method" },
         { "mp-event", 1, "${out-dir}/run-${run-num}.${ext}", "perform mean path event method" },
+        { "nrm", 1, "${out-dir}/run-${run-num}.${ext}", "perform Gibson and Bruck's next reaction method" },
+        { "tau-leap", 1, "${out-dir}/run-${run-num}.${ext}", "perform Cao, Gillespie and Petzold's tau-leaping method" },
         { "gear1", 1, "${out-dir}/gear1-run.${ext}", "ODE simulation with Gear method, M=1" },
         { "gear2", 1, "${out-dir}/gear2-run.${ext}", "ODE simulation with Gear method, M=2" },
         { NULL, -1, NULL, NULL }
@@ -137,6 +141,13 @@ RET_VAL InitBackendProcessor( COMPILER_RECORD_T *record, BACK_END_PROCESSOR *bac
                 backend->Process = DoMonteCarloAnalysis;
                 backend->Close = CloseMonteCarloAnalyzer;
             }
+            else if( strcmp( backend->encoding, "bsimp" ) == 0 ) {
+                if( IS_FAILED( ( ret = _AddPostProcessingMethods( record, __ODE_POST_PROCESSING_METHODS ) ) ) ) {
+                    return ret;
+                }
+                backend->Process = DoODESimulation;
+                backend->Close = CloseODESimulation;
+            }
             else {
                 fprintf( stderr, "target backend->encoding type %s is invalid", backend->encoding ); 
                 return ErrorReport( FAILING, "InitBackendProcessor", "target backend->encoding type %s is invalid", backend->encoding );
@@ -148,6 +159,10 @@ RET_VAL InitBackendProcessor( COMPILER_RECORD_T *record, BACK_END_PROCESSOR *bac
                 backend->Process = ProcessCTMCAnalysisBackend;
                 backend->Close = CloseCTMCAnalysisBackend;
             }
+            else if( strcmp( backend->encoding, "ctmc-stationary" ) == 0 ) {
+                backend->Process = ProcessCTMCStationaryAnalysisBackend;
+                backend->Close = CloseCTMCStationaryAnalysisBackend;
+            }
             else {
                 fprintf( stderr, "target backend->encoding type %s is invalid", backend->encoding ); 
                 return ErrorReport( FAILING, "InitBackendProcessor", "target backend->encoding type %s is invalid", backend->encoding );
@@ -267,6 +282,13 @@ RET_VAL InitBackendProcessor( COMPILER_RECORD_T *record, BACK_END_PROCESSOR *bac
                 backend->Process = DoMonteCarloAnalysis;
                 backend->Close = CloseMonteCarloAnalyzer;
             }
+            else if(strcmp( backend->encoding, "nrm" ) == 0 ) {
+                if( IS_FAILED( ( ret = _AddPostProcessingMethods( record, __MONTE_CARLO_POST_PROCESSING_METHODS ) ) ) ) {
+                    return ret;
+                }
+                backend->Process = DoMonteCarloAnalysis;
+                backend->Close = CloseMonteCarloAnalyzer;
+            }
             else {
                 fprintf( stderr, "target backend->encoding type %s is invalid", backend->encoding ); 
                 return ErrorReport( FAILING, "InitBackendProcessor", "target backend->encoding type %s is invalid", backend->encoding );
@@ -333,6 +355,20 @@ RET_VAL InitBackendProcessor( COMPILER_RECORD_T *record, BACK_END_PROCESSOR *bac
             }
         break;
         
+        case 't':
+            if( strcmp( backend->encoding, "tau-leap" ) == 0 ) {
+                if( IS_FAILED( ( ret = _AddPostProcessingMethods( record, __MONTE_CARLO_POST_PROCESSING_METHODS ) ) ) ) {
+                    return ret;
+                }
+                backend->Process = DoMonteCarloAnalysis;
+                backend->Close = CloseMonteCarloAnalyzer;
+            }
+            else {
+                fprintf( stderr, "target backend->encoding type %s is invalid", backend->encoding ); 
+                return ErrorReport( FAILING, "InitBackendProcessor", "target backend->encoding type %s is invalid", backend->encoding );
+            }
+        break;
+        
         
         case 'x':
             if( strcmp( backend->encoding, "xhtml" ) == 0 ) {
@@ -0,0 +1,299 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the reb2sac contributors                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#include "binary_simulation_printer.h"
+
+static RET_VAL _PrintStart( SIMULATION_PRINTER *printer, char *filenameStem );
+static RET_VAL _PrintHeader( SIMULATION_PRINTER *printer );
+static RET_VAL _PrintValues( SIMULATION_PRINTER *printer, double time );
+static RET_VAL _PrintEnd( SIMULATION_PRINTER *printer );
+static RET_VAL _Destroy( SIMULATION_PRINTER *printer );
+
+static UINT32 _CountColumns( BINARY_SIMULATION_PRINTER_RECORD *printer );
+static RET_VAL _WriteColumnName( FILE *out, BYTE kind, char *name );
+static RET_VAL _WriteBlock( BINARY_SIMULATION_PRINTER_RECORD *printer );
+
+ 
+DLLSCOPE SIMULATION_PRINTER * STDCALL CreateBinarySimulationPrinter( BACK_END_PROCESSOR *backend, 
+								     COMPARTMENT **compartmentArray, int compSize,
+								     SPECIES **speciesArray, int size, 
+								     REB2SAC_SYMBOL **symbolArray, int symSize,
+								     BOOL isAmount ) {
+    BINARY_SIMULATION_PRINTER_RECORD *printer = NULL;
+    char *valueString = NULL;
+    REB2SAC_PROPERTIES *properties = NULL;
+    COMPILER_RECORD_T *compRec = backend->record;
+    
+    START_FUNCTION("CreateBinarySimulationPrinter");
+    
+    if( ( printer = (BINARY_SIMULATION_PRINTER_RECORD*)MALLOC( sizeof(BINARY_SIMULATION_PRINTER_RECORD) ) ) == NULL ) {
+        END_FUNCTION("CreateBinarySimulationPrinter",  FAILING );
+        return NULL;
+    }
+    
+    printer->compartmentArray = compartmentArray;
+    printer->compSize = compSize;
+    printer->speciesArray = speciesArray;
+    printer->size = size;
+    printer->symbolArray = symbolArray;
+    printer->symSize = symSize;
+    printer->PrintStart = _PrintStart;
+    printer->PrintHeader = _PrintHeader;
+    printer->PrintValues = _PrintValues;
+    printer->PrintEnd = _PrintEnd;
+    printer->Destroy = _Destroy;
+    printer->isAmount = isAmount;
+    
+    properties = compRec->properties;
+    printer->valueSize = sizeof(double);
+    if( ( valueString = properties->GetProperty( properties, BINARY_SIMULATION_PRINTER_PRECISION_KEY ) ) != NULL ) {
+        if( strcmp( valueString, BINARY_SIMULATION_PRINTER_PRECISION_SINGLE ) == 0 ) {
+            printer->valueSize = sizeof(float);
+        }
+        else if( strcmp( valueString, BINARY_SIMULATION_PRINTER_PRECISION_DOUBLE ) != 0 ) {
+            TRACE_1( "%s is not a valid precision for the binary printer", valueString );
+            FREE( printer );
+            END_FUNCTION("CreateBinarySimulationPrinter",  FAILING );
+            return NULL;
+        }
+    }
+    
+    END_FUNCTION("CreateBinarySimulationPrinter",  SUCCESS );
+    return (SIMULATION_PRINTER*)printer;
+}
+
+static RET_VAL _PrintStart( SIMULATION_PRINTER *printer, char *filenameStem ) {
+    RET_VAL ret = SUCCESS;
+    char filename[1024];
+    BINARY_SIMULATION_PRINTER_RECORD *binaryPrinter = (BINARY_SIMULATION_PRINTER_RECORD*)printer;
+    
+    if( binaryPrinter->block == NULL ) {
+        binaryPrinter->columnsSize = _CountColumns( binaryPrinter );
+        if( ( binaryPrinter->block = (double*)MALLOC( binaryPrinter->columnsSize * BINARY_SIMULATION_PRINTER_BLOCK_ROWS * sizeof(double) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_PrintStart", "could not allocate memory for the binary printer block" );
+        }
+        if( ( binaryPrinter->valueSize == sizeof(float) ) && 
+            ( ( binaryPrinter->singleBlock = (float*)MALLOC( BINARY_SIMULATION_PRINTER_BLOCK_ROWS * sizeof(float) ) ) == NULL ) ) {
+            return ErrorReport( FAILING, "_PrintStart", "could not allocate memory for the binary printer block" );
+        }
+    }
+    binaryPrinter->rowsSize = 0;
+    
+    sprintf( filename, "%s.bin", filenameStem );
+    if( OpenSimulationPrinterFile( printer, filename, "wb" ) == NULL ) {
+        TRACE_1( "could not open %s", filename );
+        return FAILING;
+    }
+    
+    return ret;            
+}
+
+static RET_VAL _PrintHeader( SIMULATION_PRINTER *printer ) {
+    RET_VAL ret = SUCCESS;
+    FILE *out = printer->out;
+    int i = 0;
+    uint32_t fields[4];
+    char magic[BINARY_SIMULATION_PRINTER_MAGIC_SIZE];
+    BINARY_SIMULATION_PRINTER_RECORD *binaryPrinter = (BINARY_SIMULATION_PRINTER_RECORD*)printer;
+    int compSize = printer->compSize;
+    COMPARTMENT **compartmentArray = printer->compartmentArray;
+    int size = printer->size;
+    SPECIES **speciesArray = printer->speciesArray;
+    int symSize = printer->symSize;
+    REB2SAC_SYMBOL **symbolArray = printer->symbolArray;
+
+    memset( magic, 0, sizeof(magic) );
+    strcpy( magic, BINARY_SIMULATION_PRINTER_MAGIC );
+    fields[0] = BINARY_SIMULATION_PRINTER_VERSION;
+    fields[1] = BINARY_SIMULATION_PRINTER_BYTE_ORDER;
+    fields[2] = (uint32_t)binaryPrinter->valueSize;
+    fields[3] = (uint32_t)binaryPrinter->columnsSize;
+    if( ( fwrite( magic, 1, sizeof(magic), out ) != sizeof(magic) ) || 
+        ( fwrite( fields, sizeof(uint32_t), 4, out ) != 4 ) ) {
+        return ErrorReport( FAILING, "_PrintHeader", "could not write the binary header" );
+    }
+    
+    if( IS_FAILED( ( ret = _WriteColumnName( out, BINARY_SIMULATION_PRINTER_COLUMN_TIME, "time" ) ) ) ) {
+        return ret;
+    }
+    for( i = 0; i < compSize; i++ ) {
+      if (PrintCompartment( compartmentArray[i] )) {
+        if( IS_FAILED( ( ret = _WriteColumnName( out, BINARY_SIMULATION_PRINTER_COLUMN_COMPARTMENT, 
+                                                 GetCharArrayOfString(GetCompartmentID( compartmentArray[i] )) ) ) ) ) {
+          return ret;
+        }
+      }
+    }
+    for( i = 0; i < size; i++ ) {
+      if (IsPrintFlagSetInSpeciesNode(speciesArray[i])) {
+        if( IS_FAILED( ( ret = _WriteColumnName( out, BINARY_SIMULATION_PRINTER_COLUMN_SPECIES, 
+                                                 GetCharArrayOfString(GetSpeciesNodeName( speciesArray[i] )) ) ) ) ) {
+          return ret;
+        }
+      }
+    }                 
+    for( i = 0; i < symSize; i++ ) {
+      if (PrintSymbol( symbolArray[i] )) {
+        if( IS_FAILED( ( ret = _WriteColumnName( out, BINARY_SIMULATION_PRINTER_COLUMN_SYMBOL, 
+                                                 GetCharArrayOfString(GetSymbolID( symbolArray[i] )) ) ) ) ) {
+          return ret;
+        }
+      }
+    }
+    
+    return ret;            
+}
+
+static RET_VAL _PrintValues( SIMULATION_PRINTER *printer, double time ) {
+    RET_VAL ret = SUCCESS;
+    int i = 0;
+    BINARY_SIMULATION_PRINTER_RECORD *binaryPrinter = (BINARY_SIMULATION_PRINTER_RECORD*)printer;
+    double *value = binaryPrinter->block + binaryPrinter->rowsSize;
+    int compSize = printer->compSize;
+    COMPARTMENT **compartmentArray = printer->compartmentArray;
+    int size = printer->size;
+    SPECIES **speciesArray = printer->speciesArray;
+    int symSize = printer->symSize;
+    REB2SAC_SYMBOL **symbolArray = printer->symbolArray;
+    
+    *value = time;
+    value += BINARY_SIMULATION_PRINTER_BLOCK_ROWS;
+    for( i = 0; i < compSize; i++ ) {
+      if (PrintCompartment( compartmentArray[i] )) {
+        *value = GetCurrentSizeInCompartment( compartmentArray[i] );
+        value += BINARY_SIMULATION_PRINTER_BLOCK_ROWS;
+      }
+    }                 
+    for( i = 0; i < size; i++ ) {
+      if (IsPrintFlagSetInSpeciesNode(speciesArray[i])) {
+        *value = binaryPrinter->isAmount ? GetAmountInSpeciesNode( speciesArray[i] ) : GetConcentrationInSpeciesNode( speciesArray[i] );
+        value += BINARY_SIMULATION_PRINTER_BLOCK_ROWS;
+      }
+    }                 
+    for( i = 0; i < symSize; i++ ) {
+      if (PrintSymbol( symbolArray[i] )) {
+        *value = GetCurrentRealValueInSymbol( symbolArray[i] );
+        value += BINARY_SIMULATION_PRINTER_BLOCK_ROWS;
+      }
+    }                 
+    binaryPrinter->rowsSize++;
+    if( binaryPrinter->rowsSize == BINARY_SIMULATION_PRINTER_BLOCK_ROWS ) {
+        ret = _WriteBlock( binaryPrinter );
+    }
+    
+    return ret;            
+}
+
+
+static RET_VAL _PrintEnd( SIMULATION_PRINTER *printer ) {
+    RET_VAL ret = SUCCESS;    
+    
+    if( IS_FAILED( ( ret = _WriteBlock( (BINARY_SIMULATION_PRINTER_RECORD*)printer ) ) ) ) {
+        CloseSimulationPrinterFile( printer );
+        return ret;
+    }
+    ret = CloseSimulationPrinterFile( printer );
+    return ret;            
+}
+
+static RET_VAL _Destroy( SIMULATION_PRINTER *printer ) {
+    BINARY_SIMULATION_PRINTER_RECORD *binaryPrinter = (BINARY_SIMULATION_PRINTER_RECORD*)printer;
+    
+    if( binaryPrinter->buffer != NULL ) {
+        FREE( binaryPrinter->buffer );
+    }
+    if( binaryPrinter->block != NULL ) {
+        FREE( binaryPrinter->block );
+    }
+    if( binaryPrinter->singleBlock != NULL ) {
+        FREE( binaryPrinter->singleBlock );
+    }
+    FREE( binaryPrinter );
+    return SUCCESS;
+}
+
+static UINT32 _CountColumns( BINARY_SIMULATION_PRINTER_RECORD *printer ) {
+    int i = 0;
+    UINT32 columnsSize = 1;
+    
+    for( i = 0; i < printer->compSize; i++ ) {
+        if( PrintCompartment( printer->compartmentArray[i] ) ) {
+            columnsSize++;
+        }
+    }
+    for( i = 0; i < printer->size; i++ ) {
+        if( IsPrintFlagSetInSpeciesNode( printer->speciesArray[i] ) ) {
+            columnsSize++;
+        }
+    }
+    for( i = 0; i < printer->symSize; i++ ) {
+        if( PrintSymbol( printer->symbolArray[i] ) ) {
+            columnsSize++;
+        }
+    }
+    return columnsSize;
+}
+
+static RET_VAL _WriteColumnName( FILE *out, BYTE kind, char *name ) {
+    uint32_t length = (uint32_t)strlen( name );
+    
+    if( ( fwrite( &kind, sizeof(BYTE), 1, out ) != 1 ) || 
+        ( fwrite( &length, sizeof(uint32_t), 1, out ) != 1 ) || 
+        ( fwrite( name, 1, length, out ) != length ) ) {
+        return ErrorReport( FAILING, "_WriteColumnName", "could not write the name of column %s", name );
+    }
+    return SUCCESS;
+}
+
+/*
+ * Writes the rows gathered so far column by column, converting them to float32 first when 
+ * the file holds single precision values.
+ */
+static RET_VAL _WriteBlock( BINARY_SIMULATION_PRINTER_RECORD *printer ) {
+    UINT32 i = 0;
+    UINT32 j = 0;
+    UINT32 rowsSize = printer->rowsSize;
+    uint32_t rowsField = (uint32_t)rowsSize;
+    double *column = NULL;
+    FILE *out = printer->out;
+    
+    if( rowsSize == 0 ) {
+        return SUCCESS;
+    }
+    if( fwrite( &rowsField, sizeof(uint32_t), 1, out ) != 1 ) {
+        return ErrorReport( FAILING, "_WriteBlock", "could not write a block of %lu rows", rowsSize );
+    }
+    for( i = 0; i < printer->columnsSize; i++ ) {
+        column = printer->block + i * BINARY_SIMULATION_PRINTER_BLOCK_ROWS;
+        if( printer->valueSize == sizeof(float) ) {
+            for( j = 0; j < rowsSize; j++ ) {
+                printer->singleBlock[j] = (float)column[j];
+            }
+            if( fwrite( printer->singleBlock, sizeof(float), rowsSize, out ) != rowsSize ) {
+                return ErrorReport( FAILING, "_WriteBlock", "could not write a block of %lu rows", rowsSize );
+            }
+        }
+        else if( fwrite( column, sizeof(double), rowsSize, out ) != rowsSize ) {
+            return ErrorReport( FAILING, "_WriteBlock", "could not write a block of %lu rows", rowsSize );
+        }
+    }
+    printer->rowsSize = 0;
+    return SUCCESS;
+}
+
+ 
@@ -0,0 +1,87 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the reb2sac contributors                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#if !defined(HAVE_BINARY_SIMULATION_PRINTER)
+#define HAVE_BINARY_SIMULATION_PRINTER
+
+#include <stdint.h>
+#include "simulation_printer.h"
+
+BEGIN_C_NAMESPACE
+
+#define BINARY_SIMULATION_PRINTER "bin.printer"
+#define BINARY_SIMULATION_PRINTER_PRECISION_KEY "simulation.printer.binary.precision"
+#define BINARY_SIMULATION_PRINTER_PRECISION_SINGLE "single"
+#define BINARY_SIMULATION_PRINTER_PRECISION_DOUBLE "double"
+
+/*
+ * A .bin file starts with the 8 bytes of BINARY_SIMULATION_PRINTER_MAGIC followed by 32-bit 
+ * uint32_t fields in the byte order of the writer, whatever the width of UINT32 there: the format version, BINARY_SIMULATION_PRINTER_BYTE_ORDER 
+ * so a reader can detect the byte order, the size of each value (8 for float64, 4 for float32) 
+ * and the number of columns.  Each column then has a BYTE kind and a uint32_t name length 
+ * followed by the name.  The time column comes first, then compartments, species and 
+ * parameters in the order the tsd printer uses.  The rows follow in blocks of up to 
+ * BINARY_SIMULATION_PRINTER_BLOCK_ROWS: a uint32_t row count, then the values of each column 
+ * for those rows, one column after the other.
+ */
+#define BINARY_SIMULATION_PRINTER_MAGIC "REB2SAC"
+#define BINARY_SIMULATION_PRINTER_MAGIC_SIZE 8
+#define BINARY_SIMULATION_PRINTER_VERSION 1
+#define BINARY_SIMULATION_PRINTER_BYTE_ORDER 0x01020304
+#define BINARY_SIMULATION_PRINTER_BLOCK_ROWS 4096
+
+#define BINARY_SIMULATION_PRINTER_COLUMN_TIME 0
+#define BINARY_SIMULATION_PRINTER_COLUMN_COMPARTMENT 1
+#define BINARY_SIMULATION_PRINTER_COLUMN_SPECIES 2
+#define BINARY_SIMULATION_PRINTER_COLUMN_SYMBOL 3
+
+struct _BINARY_SIMULATION_PRINTER_RECORD;
+typedef struct _BINARY_SIMULATION_PRINTER_RECORD BINARY_SIMULATION_PRINTER_RECORD;
+
+struct _BINARY_SIMULATION_PRINTER_RECORD {
+    COMPARTMENT **compartmentArray;
+    int compSize;
+    SPECIES **speciesArray;
+    int size;
+    REB2SAC_SYMBOL **symbolArray;
+    int symSize;
+    FILE *out;
+    char *buffer;
+    RET_VAL (*PrintStart)( SIMULATION_PRINTER *printer, char *filenameStem );
+    RET_VAL (*PrintHeader)( SIMULATION_PRINTER *printer );
+    RET_VAL (*PrintValues)( SIMULATION_PRINTER *printer, double time );
+    RET_VAL (*PrintEnd)( SIMULATION_PRINTER *printer );
+    RET_VAL (*Destroy)( SIMULATION_PRINTER *printer );
+    
+    BOOL isAmount;
+    UINT32 valueSize;
+    UINT32 columnsSize;
+    UINT32 rowsSize;
+    double *block;
+    float *singleBlock;
+};
+
+DLLSCOPE SIMULATION_PRINTER * STDCALL CreateBinarySimulationPrinter( BACK_END_PROCESSOR *backend, 
+								     COMPARTMENT **compartmentArray, int compSize,
+								     SPECIES **speciesArray, int size, 
+								     REB2SAC_SYMBOL **symbolArray, int symSize,
+								     BOOL isAmount );
+
+END_C_NAMESPACE
+
+#endif
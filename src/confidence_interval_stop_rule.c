@@ -20,6 +20,7 @@
 #include "confidence_interval_stop_rule.h"
 #include "compiler_def.h"
 #include <math.h>
+#include <gsl/gsl_cdf.h>
 
 static BOOL _IsConditionMet( CONFIDENCE_INTERVAL_STOP_RULE *stopRule );
 static RET_VAL _AddNewSample( CONFIDENCE_INTERVAL_STOP_RULE *stopRule, double sample );    
@@ -92,6 +93,33 @@ CONFIDENCE_INTERVAL_STOP_RULE *CreateConfidenceIntervalStopRule( double confiden
     return stopRule;
 }
 
+/*
+ * Stop rule on the mean of arbitrary samples: the half-width of the Student t interval at 
+ * confidenceLevel must not exceed tolerance times the absolute sample mean.  A zero mean or 
+ * a zero variance never meets the rule, since the interval then says nothing about the runs 
+ * still to come.
+ */
+CONFIDENCE_INTERVAL_STOP_RULE *CreateSampleMeanConfidenceIntervalStopRule( double confidenceLevel, double tolerance ) {
+    CONFIDENCE_INTERVAL_STOP_RULE *stopRule = NULL;
+
+    START_FUNCTION("CreateSampleMeanConfidenceIntervalStopRule");
+    
+    if( ( stopRule = CreateConfidenceIntervalStopRule( confidenceLevel, tolerance, 1 ) ) == NULL ) {
+        END_FUNCTION("CreateSampleMeanConfidenceIntervalStopRule", FAILING );    
+        return NULL;
+    }
+    stopRule->IsConditionMet = _IsConditionMet;
+    stopRule->AddNewSample = _AddNewSample;
+    stopRule->Report = _Report;
+    if( ( confidenceLevel > 0.0 ) && ( confidenceLevel < 1.0 ) ) {
+        stopRule->confidenceLevel = confidenceLevel;
+        stopRule->zValue = gsl_cdf_ugaussian_Pinv( 0.5 + confidenceLevel / 2.0 );
+    }
+    
+    END_FUNCTION("CreateSampleMeanConfidenceIntervalStopRule", SUCCESS );    
+    return stopRule;
+}
+
 RET_VAL FreeConfidenceIntervalStopRule( CONFIDENCE_INTERVAL_STOP_RULE **stopRule ) {
     START_FUNCTION("FreeConfidenceIntervalStopRule");
     FREE( *stopRule );
@@ -106,15 +134,12 @@ static BOOL _IsConditionMet( CONFIDENCE_INTERVAL_STOP_RULE *stopRule ) {
     double sampleMean = stopRule->sampleMean;
     int sampleCount = stopRule->sampleCount;
     
-    if( ( sampleCount < 2 ) || ( sampleMean == 0.0 )  ) {
-    /*    
-    if( sampleCount < 2 ) {
-    */
+    if( ( sampleCount < 2 ) || ( sampleMean == 0.0 ) || ( stopRule->sampleVariance <= 0.0 ) ) {
         return FALSE;
     }
     else { 
         halfInterval = _CalculateHalfInterval( stopRule );
-        expected = stopRule->tolerance * sampleMean;        
+        expected = stopRule->tolerance * fabs( sampleMean );        
         return ( ( halfInterval <= expected ) ? TRUE : FALSE );
     }
 }
@@ -262,7 +287,14 @@ static double _GetBatchSize( CONFIDENCE_INTERVAL_STOP_RULE *stopRule ) {
 }        
 
 static double _CalculateHalfInterval( CONFIDENCE_INTERVAL_STOP_RULE *stopRule ) {
-    double halfInterval = stopRule->zValue * sqrt( stopRule->sampleVariance / ( stopRule->sampleCount ) );
+    double quantile = stopRule->zValue;
+    double halfInterval = 0.0;
+    
+    /* the normal quantile understates the interval of small samples */
+    if( stopRule->sampleCount > 1 ) {
+        quantile = gsl_cdf_tdist_Pinv( 0.5 + stopRule->confidenceLevel / 2.0, stopRule->sampleCount - 1.0 );
+    }
+    halfInterval = quantile * sqrt( stopRule->sampleVariance / ( stopRule->sampleCount ) );
     return halfInterval; 
 }
 
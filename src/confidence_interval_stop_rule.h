@@ -49,6 +49,7 @@ struct _CONFIDENCE_INTERVAL_STOP_RULE {
 };
 
 CONFIDENCE_INTERVAL_STOP_RULE *CreateConfidenceIntervalStopRule( double confidenceLevel, double tolerance, int batchSize );
+CONFIDENCE_INTERVAL_STOP_RULE *CreateSampleMeanConfidenceIntervalStopRule( double confidenceLevel, double tolerance );
 RET_VAL FreeConfidenceIntervalStopRule( CONFIDENCE_INTERVAL_STOP_RULE **stopRule );
 
 
@@ -180,7 +180,6 @@ static RET_VAL __AddListOfCriticalConcentrationLevels( double amplifier, KINETIC
 }
 
 static BOOL _FindCriticalConcentrationLevel( double amplifier, KINETIC_LAW *kineticLaw, SPECIES *species, LINKED_LIST *list ) {
-    static KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     int num = 0;
     double rateConstant = 1.0;
@@ -303,18 +302,17 @@ static BOOL _FindCriticalConcentrationLevel( double amplifier, KINETIC_LAW *kine
 
  
 static BOOL _FindSpecies( KINETIC_LAW *kineticLaw, SPECIES *species ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     BOOL flag = FALSE;
     
     START_FUNCTION("_FindSpecies");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToFindSpecies;
-        visitor.VisitInt = _VisitIntToFindSpecies;
-        visitor.VisitReal = _VisitRealToFindSpecies;
-        visitor.VisitSpecies = _VisitSpeciesToFindSpecies;
-        visitor.VisitSymbol = _VisitSymbolToFindSpecies;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToFindSpecies;
+    visitor.VisitInt = _VisitIntToFindSpecies;
+    visitor.VisitReal = _VisitRealToFindSpecies;
+    visitor.VisitSpecies = _VisitSpeciesToFindSpecies;
+    visitor.VisitSymbol = _VisitSymbolToFindSpecies;
     
     visitor._internal1 = (CADDR_T)species;
     visitor._internal2 = (CADDR_T)(&flag);
@@ -372,18 +370,17 @@ static RET_VAL _VisitSpeciesToFindSpecies( KINETIC_LAW_VISITOR *visitor, KINETIC
 
 
 static LINKED_LIST *_CreateListOfMultipleTerms( KINETIC_LAW *kineticLaw  ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     LINKED_LIST *list = NULL;
     
     START_FUNCTION("_CreateListOfMultipleTerms");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToCreateListOfMultipleTerms;
-        visitor.VisitInt = _VisitIntToCreateListOfMultipleTerms;
-        visitor.VisitReal = _VisitRealToCreateListOfMultipleTerms;
-        visitor.VisitSpecies = _VisitSpeciesToCreateListOfMultipleTerms;
-        visitor.VisitSymbol = _VisitSymbolToCreateListOfMultipleTerms;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToCreateListOfMultipleTerms;
+    visitor.VisitInt = _VisitIntToCreateListOfMultipleTerms;
+    visitor.VisitReal = _VisitRealToCreateListOfMultipleTerms;
+    visitor.VisitSpecies = _VisitSpeciesToCreateListOfMultipleTerms;
+    visitor.VisitSymbol = _VisitSymbolToCreateListOfMultipleTerms;
     
     if( ( list = CreateLinkedList() ) == NULL ) {
         END_FUNCTION("_CreateListOfMultipleTerms", FAILING );
@@ -507,18 +504,17 @@ static RET_VAL _VisitSymbolToCreateListOfMultipleTerms( KINETIC_LAW_VISITOR *vis
 
 
 static LINKED_LIST *_CreateListOfSumTerms( KINETIC_LAW *kineticLaw  ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     LINKED_LIST *list = NULL;
     
     START_FUNCTION("_CreateListOfSumTerms");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToCreateListOfSumTerms;
-        visitor.VisitInt = _VisitIntToCreateListOfSumTerms;
-        visitor.VisitReal = _VisitRealToCreateListOfSumTerms;
-        visitor.VisitSpecies = _VisitSpeciesToCreateListOfSumTerms;
-        visitor.VisitSymbol = _VisitSymbolToCreateListOfSumTerms;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToCreateListOfSumTerms;
+    visitor.VisitInt = _VisitIntToCreateListOfSumTerms;
+    visitor.VisitReal = _VisitRealToCreateListOfSumTerms;
+    visitor.VisitSpecies = _VisitSpeciesToCreateListOfSumTerms;
+    visitor.VisitSymbol = _VisitSymbolToCreateListOfSumTerms;
     
     if( ( list = CreateLinkedList() ) == NULL ) {
         END_FUNCTION("_CreateListOfSumTerms", FAILING );
@@ -643,17 +639,16 @@ static RET_VAL _VisitSymbolToCreateListOfSumTerms( KINETIC_LAW_VISITOR *visitor,
 
  
 static KINETIC_LAW *_FindDivisor( KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     
     START_FUNCTION("_FindDivisor");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToFindDivisor;
-        visitor.VisitInt = _VisitIntToFindDivisor;
-        visitor.VisitReal = _VisitRealToFindDivisor;
-        visitor.VisitSpecies = _VisitSpeciesToFindDivisor;
-        visitor.VisitSymbol = _VisitSymbolToFindDivisor;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToFindDivisor;
+    visitor.VisitInt = _VisitIntToFindDivisor;
+    visitor.VisitReal = _VisitRealToFindDivisor;
+    visitor.VisitSpecies = _VisitSpeciesToFindDivisor;
+    visitor.VisitSymbol = _VisitSymbolToFindDivisor;
     
     visitor._internal1 = NULL;
     
@@ -724,20 +719,19 @@ static RET_VAL _VisitSymbolToFindDivisor( KINETIC_LAW_VISITOR *visitor, KINETIC_
 
 
 static BOOL _FindMultiplicationOfSpecies( KINETIC_LAW *kineticLaw, SPECIES *species, double *result ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
 #ifdef DEBUG    
     STRING *string = NULL;
 #endif
     
     START_FUNCTION("_FindMultiplicationOfSpecies");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToFindMultiplicationOfSpecies;
-        visitor.VisitInt = _VisitIntToFindMultiplicationOfSpecies;
-        visitor.VisitReal = _VisitRealToFindMultiplicationOfSpecies;
-        visitor.VisitSpecies = _VisitSpeciesToFindMultiplicationOfSpecies;
-        visitor.VisitSymbol = _VisitSymbolToFindMultiplicationOfSpecies;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToFindMultiplicationOfSpecies;
+    visitor.VisitInt = _VisitIntToFindMultiplicationOfSpecies;
+    visitor.VisitReal = _VisitRealToFindMultiplicationOfSpecies;
+    visitor.VisitSpecies = _VisitSpeciesToFindMultiplicationOfSpecies;
+    visitor.VisitSymbol = _VisitSymbolToFindMultiplicationOfSpecies;
     *result = 0.0;
     
     visitor._internal1 = (CADDR_T)species;
@@ -858,20 +852,19 @@ static RET_VAL _VisitSpeciesToFindMultiplicationOfSpecies( KINETIC_LAW_VISITOR *
 
 
 static int _GetNumberOfSpecies( KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     LINKED_LIST *list = NULL;
     int num = 0;
 #ifdef DEBUG    
     STRING *string = NULL;
 #endif
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToGetNumberOfSpecies;
-        visitor.VisitInt = _VisitIntToGetNumberOfSpecies;
-        visitor.VisitReal = _VisitRealToGetNumberOfSpecies;
-        visitor.VisitSpecies = _VisitSpeciesToGetNumberOfSpecies;
-        visitor.VisitSymbol = _VisitSymbolToGetNumberOfSpecies;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToGetNumberOfSpecies;
+    visitor.VisitInt = _VisitIntToGetNumberOfSpecies;
+    visitor.VisitReal = _VisitRealToGetNumberOfSpecies;
+    visitor.VisitSpecies = _VisitSpeciesToGetNumberOfSpecies;
+    visitor.VisitSymbol = _VisitSymbolToGetNumberOfSpecies;
 
     if( ( list = CreateLinkedList() ) == NULL ) {
         TRACE_0("could not create a list to store distinct species" );
@@ -17,6 +17,7 @@
  *   Free Software Foundation, Inc.,                                       *
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
+#include <ctype.h>
 #include "ctmc_analysis_back_end_processor.h"
 #include "markov_chain.h"
 #include "ctmc_analyzer.h"
@@ -26,6 +27,8 @@
 #include "markov_analysis_result_reporter.h"
 
 static double _FindTimeLimit( REB2SAC_PROPERTIES *properties );
+static RET_VAL _FindTimePoints( REB2SAC_PROPERTIES *properties, double **pTimes, int *pSize );
+static RET_VAL _SetTransientMethod( CTMC_ANALYZER *analyzer, REB2SAC_PROPERTIES *properties );
 static double _GetStateProb( CTMC_STATE *state );
 static RET_VAL _ReportResults( FILE *file, CTMC *ctmc, IR2CTMC_TRANSFORMER *transformer );
 static RET_VAL _PrintState( FILE *file, int state, int size, double *currentLevelArray, double prob );
@@ -33,7 +36,10 @@ static RET_VAL _PrintState( FILE *file, int state, int size, double *currentLeve
 RET_VAL ProcessCTMCAnalysisBackend( BACK_END_PROCESSOR *backend, IR *ir ) {
     RET_VAL ret = SUCCESS;
     char *filename = NULL;
+    int i = 0;
+    int timeSize = 0;
     double timeLimit = 0.0;
+    double *times = NULL;
     FILE *file = NULL;
     COMPILER_RECORD_T *record = backend->record;
     REB2SAC_PROPERTIES *properties = record->properties;
@@ -70,6 +76,40 @@ RET_VAL ProcessCTMCAnalysisBackend( BACK_END_PROCESSOR *backend, IR *ir ) {
     if( ( analyzer = CreateCTMCAnalyzer( ctmc ) ) == NULL ) {
         return ErrorReport( FAILING, "ProcessCTMCAnalysisBackend", "failed to create CTMC analyzer" );
     }
+    if( IS_FAILED( ( ret = _SetTransientMethod( analyzer, properties ) ) ) ) {
+        END_FUNCTION("ProcessCTMCAnalysisBackend", ret );
+        return ret;
+    }
+    if( IS_FAILED( ( ret = _FindTimePoints( properties, &times, &timeSize ) ) ) ) {
+        END_FUNCTION("ProcessCTMCAnalysisBackend", ret );
+        return ret;
+    }
+    
+    if( times != NULL ) {
+        /* every time point is computed in one pass, then reported in turn */
+        if( IS_FAILED( ( ret = analyzer->AnalyzeAtTimes( analyzer, times, timeSize ) ) ) ) {
+            END_FUNCTION("ProcessCTMCAnalysisBackend", ret );
+            return ret;
+        }
+        if( ( reporter = CreateMarkovAnalysisResultReporter( properties ) ) == NULL ) {
+            return ErrorReport( FAILING, "ProcessCTMCAnalysisBackend", "could not create a markov analysis reporter" );
+        } 
+        ctmc = analyzer->GetResult( analyzer );
+        for( i = 0; i < timeSize; i++ ) {
+            if( IS_FAILED( ( ret = analyzer->SelectResult( analyzer, i ) ) ) ) {
+                END_FUNCTION("ProcessCTMCAnalysisBackend", ret );
+                return ret;
+            }
+            fprintf( file, "# time %g" NEW_LINE, times[i] );
+            if( IS_FAILED( ( ret = reporter->Report( reporter, file, (MARKOV_CHAIN*)ctmc, (CADDR_T)transformer ) ) ) ) {
+                END_FUNCTION("ProcessCTMCAnalysisBackend", ret );
+                return ret;
+            }
+        }
+        FREE( times );
+        END_FUNCTION("ProcessCTMCAnalysisBackend", ret );
+        return ret;
+    }
     
     /*
     if( IS_FAILED( ( ret = _ReportResults( file, ctmc, transformer ) ) ) ) {
@@ -128,6 +168,74 @@ static double _FindTimeLimit( REB2SAC_PROPERTIES *properties ) {
     return timeLimit;    
 }
 
+static RET_VAL _FindTimePoints( REB2SAC_PROPERTIES *properties, double **pTimes, int *pSize ) {
+    int size = 0;
+    char *valueString = NULL;
+    char *end = NULL;
+    double value = 0.0;
+    double *times = NULL;
+    
+    *pTimes = NULL;
+    *pSize = 0;
+    if( ( valueString = properties->GetProperty( properties, MARKOV_CHAIN_ANALYSIS_TIME_POINTS_KEY ) ) == NULL ) {
+        return SUCCESS;
+    }
+    /* there are at most as many numbers as characters */
+    if( ( times = (double*)CALLOC( strlen( valueString ) + 1, sizeof(double) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_FindTimePoints", "failed to allocate memory for the time points" );
+    }
+    while( *valueString != '\0' ) {
+        if( ( *valueString == ',' ) || isspace( (int)*valueString ) ) {
+            valueString++;
+            continue;
+        }
+        value = strtod( valueString, &end );
+        if( end == valueString ) {
+            FREE( times );
+            return ErrorReport( FAILING, "_FindTimePoints", "invalid time point in %s", MARKOV_CHAIN_ANALYSIS_TIME_POINTS_KEY );
+        }
+        times[size] = value;
+        size++;
+        valueString = end;
+    }
+    if( size == 0 ) {
+        FREE( times );
+        return SUCCESS;
+    }
+    
+    *pTimes = times;
+    *pSize = size;
+    return SUCCESS;
+}
+
+static RET_VAL _SetTransientMethod( CTMC_ANALYZER *analyzer, REB2SAC_PROPERTIES *properties ) {
+    int method = CTMC_TRANSIENT_METHOD_UNIFORMIZATION;
+    char *valueString = NULL;
+    double errorBound = DEFAULT_CTMC_TRANSIENT_ERROR;
+    
+    if( ( valueString = properties->GetProperty( properties, MARKOV_CHAIN_TRANSIENT_METHOD_KEY ) ) != NULL ) {
+        if( strcmp( valueString, MARKOV_CHAIN_TRANSIENT_METHOD_UNIFORMIZATION ) == 0 ) {
+            method = CTMC_TRANSIENT_METHOD_UNIFORMIZATION;
+        }
+        else if( strcmp( valueString, MARKOV_CHAIN_TRANSIENT_METHOD_KRYLOV ) == 0 ) {
+            method = CTMC_TRANSIENT_METHOD_KRYLOV;
+        }
+        else if( strcmp( valueString, MARKOV_CHAIN_TRANSIENT_METHOD_FIXED_STEP ) == 0 ) {
+            method = CTMC_TRANSIENT_METHOD_FIXED_STEP;
+        }
+        else {
+            return ErrorReport( FAILING, "_SetTransientMethod", "unknown transient method %s", valueString );
+        }
+    }
+    if( ( valueString = properties->GetProperty( properties, MARKOV_CHAIN_TRANSIENT_ERROR_KEY ) ) != NULL ) {
+        if( IS_FAILED( ( StrToFloat( &errorBound, valueString ) ) ) ) {
+            return ErrorReport( FAILING, "_SetTransientMethod", "invalid value %s for %s", valueString, MARKOV_CHAIN_TRANSIENT_ERROR_KEY );
+        }
+    }
+    
+    return analyzer->SetTransientMethod( analyzer, method, errorBound );
+}
+
 static double _GetStateProb( CTMC_STATE *state ) {
     CTMC_ANALYSIS_REC *rec = (CTMC_ANALYSIS_REC*)(state->analysisRecord);
     return rec->currentProb;    
@@ -18,16 +18,36 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <float.h>
+#include <math.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_linalg.h>
+#include <gsl/gsl_sf_gamma.h>
 #include "ctmc_analyzer.h"
 
 static RET_VAL _ResetDt( CTMC_ANALYZER *analyzer, double dt );
+static RET_VAL _SetTransientMethod( CTMC_ANALYZER *analyzer, int method, double errorBound );
 static RET_VAL _Analyze( CTMC_ANALYZER *analyzer, double timeLimit );
+static RET_VAL _AnalyzeAtTimes( CTMC_ANALYZER *analyzer, double *times, int size );
+static RET_VAL _SelectResult( CTMC_ANALYZER *analyzer, int index );
 static CTMC *_GetResult( CTMC_ANALYZER *analyzer );
 static double _GetDt( CTMC_ANALYZER *analyzer );    
 
 static double _CalculateOutRate( CTMC_STATE *state );
 static double _CalculateDt( CTMC_ANALYZER *analyzer );
 static RET_VAL _UpdateDistribution( int stateSize, CTMC_STATE *states );
+
+static RET_VAL _BuildRateMatrix( CTMC_ANALYZER *analyzer );
+static void _MultiplyGenerator( CTMC_ANALYZER *analyzer, double *x, double *y );
+static void _MultiplyUniformized( CTMC_ANALYZER *analyzer, double q, double *x, double *y );
+static RET_VAL _FindPoissonWeights( double lambda, double epsilon, int *left, int *right, double **weights );
+static RET_VAL _AnalyzeWithUniformization( CTMC_ANALYZER *analyzer, double *initial, double *times, int size );
+static RET_VAL _KrylovPropagate( CTMC_ANALYZER *analyzer, double *w, double duration );
+static RET_VAL _AnalyzeWithKrylov( CTMC_ANALYZER *analyzer, double *initial, double *times, int size );
+static RET_VAL _AnalyzeWithFixedSteps( CTMC_ANALYZER *analyzer, double *times, int size );
+static double _Dot( double *x, double *y, int size );
+static void _Axpy( double a, double *x, double *y, int size );
+static void _Scale( double a, double *x, int size );
   
 
 CTMC_ANALYZER *CreateCTMCAnalyzer( CTMC *markovChain ) {
@@ -75,11 +95,16 @@ CTMC_ANALYZER *CreateCTMCAnalyzer( CTMC *markovChain ) {
         TRACE_0( "failed to calculate dt for CTMC analysis" );    
     }
     analyzer->dt = dt;
+    analyzer->method = CTMC_TRANSIENT_METHOD_UNIFORMIZATION;
+    analyzer->errorBound = DEFAULT_CTMC_TRANSIENT_ERROR;
     
     analyzer->ResetDt = _ResetDt;
     analyzer->GetDt = _GetDt;
     analyzer->GetResult = _GetResult;
+    analyzer->SetTransientMethod = _SetTransientMethod;
     analyzer->Analyze = _Analyze;    
+    analyzer->AnalyzeAtTimes = _AnalyzeAtTimes;    
+    analyzer->SelectResult = _SelectResult;    
        
     return analyzer;
 }
@@ -98,6 +123,11 @@ RET_VAL FreeCTMCAnalyzer( CTMC_ANALYZER **panalyzer ) {
         FREE( state->analysisRecord );        
     }
     
+    FREE( analyzer->rowStart );
+    FREE( analyzer->columnIndex );
+    FREE( analyzer->rates );
+    FREE( analyzer->outRates );
+    FREE( analyzer->distributions );
     FREE( analyzer );
         
     return SUCCESS;
@@ -136,20 +166,101 @@ static RET_VAL _ResetDt( CTMC_ANALYZER *analyzer, double dt ) {
     return SUCCESS;
 }
 
+static RET_VAL _SetTransientMethod( CTMC_ANALYZER *analyzer, int method, double errorBound ) {
+    if( ( method < CTMC_TRANSIENT_METHOD_UNIFORMIZATION ) || ( method > CTMC_TRANSIENT_METHOD_FIXED_STEP ) ) {
+        return ErrorReport( FAILING, "_SetTransientMethod", "unknown transient method %i", method );
+    }
+    if( !( errorBound > 0.0 ) || ( errorBound >= 1.0 ) ) {
+        return ErrorReport( FAILING, "_SetTransientMethod", "error bound %g must be in (0, 1)", errorBound );
+    }
+    analyzer->method = method;
+    analyzer->errorBound = errorBound;
+    
+    return SUCCESS;
+}
+
 static RET_VAL _Analyze( CTMC_ANALYZER *analyzer, double timeLimit ) {
     RET_VAL ret = SUCCESS;
-    double time = 0.0;
+    
+    if( IS_FAILED( ( ret = _AnalyzeAtTimes( analyzer, &timeLimit, 1 ) ) ) ) {
+        return ret;
+    }
+    
+    return _SelectResult( analyzer, 0 );
+}
+
+/*
+ * computes the transient distribution at every requested time in one pass, starting from the 
+ * current probabilities of the states. the results are kept until SelectResult copies one of them 
+ * back into the analysis records.
+ */
+static RET_VAL _AnalyzeAtTimes( CTMC_ANALYZER *analyzer, double *times, int size ) {
+    RET_VAL ret = SUCCESS;
+    int i = 0;
     CTMC *markovChain = analyzer->markovChain;
     CTMC_STATE *states = markovChain->states;
     int stateSize = markovChain->stateSize; 
-    double dt = analyzer->dt;
+    double *distributions = NULL;
+    double *initial = NULL;
+    CTMC_ANALYSIS_REC *rec = NULL;
     
-    while( time <= timeLimit ) {
-        TRACE_1("at time %g", time );
-        if( IS_FAILED( ( ret = _UpdateDistribution( stateSize, states ) ) ) ) {
-            return ret;
+    for( i = 0; i < size; i++ ) {
+        if( ( times[i] < 0.0 ) || ( ( i > 0 ) && ( times[i] < times[i - 1] ) ) ) {
+            return ErrorReport( FAILING, "_AnalyzeAtTimes", "analysis times must be non-negative and increasing" );
         }
-        time += dt;
+    }
+    if( ( analyzer->rowStart == NULL ) && IS_FAILED( ( ret = _BuildRateMatrix( analyzer ) ) ) ) {
+        return ret;
+    }
+    
+    if( ( distributions = (double*)CALLOC( (long)size * stateSize, sizeof(double) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_AnalyzeAtTimes", "failed to allocate memory for %i distributions", size );
+    }
+    FREE( analyzer->distributions );
+    analyzer->distributions = distributions;
+    analyzer->timeSize = size;
+    
+    if( ( initial = (double*)CALLOC( stateSize, sizeof(double) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_AnalyzeAtTimes", "failed to allocate memory for the initial distribution" );
+    }
+    for( i = 0; i < stateSize; i++ ) {
+        rec = (CTMC_ANALYSIS_REC*)(states[i].analysisRecord);
+        initial[i] = rec->currentProb;
+    }
+    
+    switch( analyzer->method ) {
+        case CTMC_TRANSIENT_METHOD_KRYLOV:
+            ret = _AnalyzeWithKrylov( analyzer, initial, times, size );
+        break;
+        
+        case CTMC_TRANSIENT_METHOD_FIXED_STEP:
+            ret = _AnalyzeWithFixedSteps( analyzer, times, size );
+        break;
+        
+        default:
+            ret = _AnalyzeWithUniformization( analyzer, initial, times, size );
+        break;
+    }
+    
+    FREE( initial );
+    return ret;
+}
+
+static RET_VAL _SelectResult( CTMC_ANALYZER *analyzer, int index ) {
+    int i = 0;
+    CTMC *markovChain = analyzer->markovChain;
+    CTMC_STATE *states = markovChain->states;
+    int stateSize = markovChain->stateSize; 
+    double *distribution = NULL;
+    CTMC_ANALYSIS_REC *rec = NULL;
+    
+    if( ( index < 0 ) || ( index >= analyzer->timeSize ) ) {
+        return ErrorReport( FAILING, "_SelectResult", "no result for time index %i", index );
+    }
+    distribution = analyzer->distributions + (long)index * stateSize;
+    for( i = 0; i < stateSize; i++ ) {
+        rec = (CTMC_ANALYSIS_REC*)(states[i].analysisRecord);
+        rec->currentProb = distribution[i];
     }
     
     return SUCCESS;
@@ -232,3 +343,454 @@ static RET_VAL _UpdateDistribution( int stateSize, CTMC_STATE *states ) {
 }
 
 
+static RET_VAL _BuildRateMatrix( CTMC_ANALYZER *analyzer ) {
+    int i = 0;
+    int j = 0;
+    int k = 0;
+    int transitionSize = 0; 
+    int totalSize = 0; 
+    CTMC *markovChain = analyzer->markovChain;
+    CTMC_STATE *states = markovChain->states;
+    int stateSize = markovChain->stateSize; 
+    VECTOR *transitions = NULL;
+    CTMC_TRANSITION *transition = NULL;
+    CTMC_ANALYSIS_REC *rec = NULL;
+    
+    for( i = 0; i < stateSize; i++ ) {
+        totalSize += GetVectorSize( states[i].transitions );
+    }
+    if( ( ( analyzer->rowStart = (int*)CALLOC( stateSize + 1, sizeof(int) ) ) == NULL ) ||
+        ( ( analyzer->outRates = (double*)CALLOC( stateSize, sizeof(double) ) ) == NULL ) ) {
+        return ErrorReport( FAILING, "_BuildRateMatrix", "failed to allocate memory for %i states", stateSize );
+    }
+    if( ( totalSize > 0 ) && 
+        ( ( ( analyzer->columnIndex = (int*)CALLOC( totalSize, sizeof(int) ) ) == NULL ) ||
+          ( ( analyzer->rates = (double*)CALLOC( totalSize, sizeof(double) ) ) == NULL ) ) ) {
+        return ErrorReport( FAILING, "_BuildRateMatrix", "failed to allocate memory for %i transitions", totalSize );
+    }
+    
+    for( i = 0; i < stateSize; i++ ) {
+        rec = (CTMC_ANALYSIS_REC*)(states[i].analysisRecord);
+        analyzer->outRates[i] = rec->outRate;
+        analyzer->rowStart[i] = k;
+        transitions = states[i].transitions;
+        transitionSize = GetVectorSize( transitions );
+        for( j = 0; j < transitionSize; j++ ) {
+            transition = (CTMC_TRANSITION*)GetElementFromVector( transitions, j );
+            analyzer->columnIndex[k] = (int)( transition->to - states );
+            analyzer->rates[k] = transition->rate;
+            k++;
+        }
+    }
+    analyzer->rowStart[stateSize] = k;
+    
+    return SUCCESS;
+}
+
+/* y = x Q, with x a row vector of state probabilities */
+static void _MultiplyGenerator( CTMC_ANALYZER *analyzer, double *x, double *y ) {
+    int i = 0;
+    int k = 0;
+    int end = 0;
+    int stateSize = analyzer->markovChain->stateSize; 
+    int *rowStart = analyzer->rowStart;
+    int *columnIndex = analyzer->columnIndex;
+    double xi = 0.0;
+    double *rates = analyzer->rates;
+    double *outRates = analyzer->outRates;
+    
+    for( i = 0; i < stateSize; i++ ) {
+        y[i] = -outRates[i] * x[i];
+    }
+    for( i = 0; i < stateSize; i++ ) {
+        if( ( xi = x[i] ) == 0.0 ) {
+            continue;
+        }
+        end = rowStart[i + 1];
+        for( k = rowStart[i]; k < end; k++ ) {
+            y[columnIndex[k]] += xi * rates[k];
+        }
+    }
+}
+
+/* y = x P, where P = I + Q / q is the uniformized chain */
+static void _MultiplyUniformized( CTMC_ANALYZER *analyzer, double q, double *x, double *y ) {
+    int i = 0;
+    int stateSize = analyzer->markovChain->stateSize; 
+    
+    _MultiplyGenerator( analyzer, x, y );
+    for( i = 0; i < stateSize; i++ ) {
+        y[i] = x[i] + y[i] / q;
+    }
+}
+
+/*
+ * Poisson( lambda ) weights on [left, right] whose truncated mass is at most epsilon, following 
+ * Fox and Glynn. the window grows outwards from the mode, always taking the heavier neighbour, and 
+ * the weights are computed relative to the mode so that they neither underflow nor overflow for 
+ * large lambda. the returned weights are normalized to sum to one.
+ */
+static RET_VAL _FindPoissonWeights( double lambda, double epsilon, int *left, int *right, double **weights ) {
+    int i = 0;
+    int mode = 0;
+    int l = 0;
+    int r = 0;
+    double total = 1.0;
+    double leftWeight = 1.0;
+    double rightWeight = 1.0;
+    double nextLeft = 0.0;
+    double nextRight = 0.0;
+    double modeProb = 0.0;
+    double *w = NULL;
+    
+    if( lambda <= 0.0 ) {
+        if( ( w = (double*)MALLOC( sizeof(double) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_FindPoissonWeights", "failed to allocate memory for the weights" );
+        }
+        w[0] = 1.0;
+        *left = *right = 0;
+        *weights = w;
+        return SUCCESS;
+    }
+    
+    mode = (int)floor( lambda );
+    modeProb = exp( -lambda + mode * log( lambda ) - gsl_sf_lngamma( mode + 1.0 ) );
+    l = r = mode;
+    /* weights are relative to the mode, so the target mass is ( 1 - epsilon ) / modeProb */
+    while( total * modeProb < 1.0 - epsilon ) {
+        nextLeft = ( l > 0 ) ? leftWeight * l / lambda : 0.0;
+        nextRight = rightWeight * lambda / ( r + 1.0 );
+        if( nextLeft + nextRight < total * DBL_EPSILON ) {
+            break;
+        }
+        if( nextLeft >= nextRight ) {
+            l--;
+            leftWeight = nextLeft;
+            total += nextLeft;
+        }
+        else {
+            r++;
+            rightWeight = nextRight;
+            total += nextRight;
+        }
+    }
+    
+    if( ( w = (double*)MALLOC( ( r - l + 1 ) * sizeof(double) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_FindPoissonWeights", "failed to allocate memory for %i weights", r - l + 1 );
+    }
+    w[mode - l] = 1.0 / total;
+    for( i = mode; i > l; i-- ) {
+        w[i - 1 - l] = w[i - l] * i / lambda;
+    }
+    for( i = mode; i < r; i++ ) {
+        w[i + 1 - l] = w[i - l] * lambda / ( i + 1.0 );
+    }
+    
+    *left = l;
+    *right = r;
+    *weights = w;
+    return SUCCESS;
+}
+
+/*
+ * Jensen's method: pi(t) = sum_k Poisson( k; q t ) pi(0) P^k. 
+ * the powers pi(0) P^k are computed once up to the largest right truncation point, 
+ * and added into the result of every time whose window contains k.
+ */
+static RET_VAL _AnalyzeWithUniformization( CTMC_ANALYZER *analyzer, double *initial, double *times, int size ) {
+    RET_VAL ret = SUCCESS;
+    int i = 0;
+    int j = 0;
+    int k = 0;
+    int maxRight = 0;
+    int stateSize = analyzer->markovChain->stateSize; 
+    int *lefts = NULL;
+    int *rights = NULL;
+    double q = analyzer->highestOutRate;
+    double weight = 0.0;
+    double *current = NULL;
+    double *next = NULL;
+    double *swap = NULL;
+    double *distribution = NULL;
+    double **weights = NULL;
+    
+    if( !( q > 0.0 ) ) {
+        /* no transitions, so the distribution never changes */
+        for( j = 0; j < size; j++ ) {
+            memcpy( analyzer->distributions + (long)j * stateSize, initial, stateSize * sizeof(double) );
+        }
+        return SUCCESS;
+    }
+    
+    if( ( ( lefts = (int*)CALLOC( size, sizeof(int) ) ) == NULL ) ||
+        ( ( rights = (int*)CALLOC( size, sizeof(int) ) ) == NULL ) ||
+        ( ( weights = (double**)CALLOC( size, sizeof(double*) ) ) == NULL ) ||
+        ( ( current = (double*)CALLOC( stateSize, sizeof(double) ) ) == NULL ) ||
+        ( ( next = (double*)CALLOC( stateSize, sizeof(double) ) ) == NULL ) ) {
+        ret = ErrorReport( FAILING, "_AnalyzeWithUniformization", "failed to allocate memory" );
+        goto FREE_ARRAYS;
+    }
+    
+    for( j = 0; j < size; j++ ) {
+        if( IS_FAILED( ( ret = _FindPoissonWeights( q * times[j], analyzer->errorBound, lefts + j, rights + j, weights + j ) ) ) ) {
+            goto FREE_ARRAYS;
+        }
+        if( rights[j] > maxRight ) {
+            maxRight = rights[j];
+        }
+    }
+    TRACE_2( "uniformization rate %g, %i iterations", q, maxRight );
+    
+    memcpy( current, initial, stateSize * sizeof(double) );
+    for( k = 0; k <= maxRight; k++ ) {
+        for( j = 0; j < size; j++ ) {
+            if( ( k < lefts[j] ) || ( k > rights[j] ) ) {
+                continue;
+            }
+            weight = weights[j][k - lefts[j]];
+            distribution = analyzer->distributions + (long)j * stateSize;
+            for( i = 0; i < stateSize; i++ ) {
+                distribution[i] += weight * current[i];
+            }
+        }
+        if( k < maxRight ) {
+            _MultiplyUniformized( analyzer, q, current, next );
+            swap = current;
+            current = next;
+            next = swap;
+        }
+    }
+    
+FREE_ARRAYS:
+    if( weights != NULL ) {
+        for( j = 0; j < size; j++ ) {
+            FREE( weights[j] );
+        }
+    }
+    FREE( weights );
+    FREE( lefts );
+    FREE( rights );
+    FREE( current );
+    FREE( next );
+    
+    return ret;
+}
+
+/*
+ * exp( t Q^T ) applied to the distribution by restarted Arnoldi with adaptive steps, 
+ * in the manner of Expokit's expv. each step projects onto a Krylov subspace of 
+ * dimension CTMC_KRYLOV_SUBSPACE_SIZE and exponentiates the small Hessenberg matrix, 
+ * so the step size is not tied to the fastest rate of the chain.
+ */
+static RET_VAL _KrylovPropagate( CTMC_ANALYZER *analyzer, double *w, double duration ) {
+    RET_VAL ret = SUCCESS;
+    int i = 0;
+    int j = 0;
+    int m = 0;
+    int mb = 0;
+    int rejections = 0;
+    int stateSize = analyzer->markovChain->stateSize; 
+    BOOL isBreakdown = FALSE;
+    double tolerance = analyzer->errorBound;
+    double normA = 2.0 * analyzer->highestOutRate;
+    double now = 0.0;
+    double tau = 0.0;
+    double beta = 0.0;
+    double s = 0.0;
+    double hNext = 0.0;
+    double error = 0.0;
+    double factor = 0.0;
+    double *V = NULL;
+    double *H = NULL;
+    double *p = NULL;
+    gsl_matrix *tauH = NULL;
+    gsl_matrix *F = NULL;
+    
+    if( !( duration > 0.0 ) || !( normA > 0.0 ) ) {
+        return SUCCESS;
+    }
+    
+    m = GET_MIN( CTMC_KRYLOV_SUBSPACE_SIZE, stateSize );
+    if( ( ( V = (double*)CALLOC( (long)( m + 1 ) * stateSize, sizeof(double) ) ) == NULL ) ||
+        ( ( H = (double*)CALLOC( ( m + 1 ) * ( m + 1 ), sizeof(double) ) ) == NULL ) ) {
+        ret = ErrorReport( FAILING, "_KrylovPropagate", "failed to allocate memory for the Krylov basis" );
+        goto FREE_ARRAYS;
+    }
+    
+    factor = pow( ( m + 1 ) / exp( 1.0 ), m + 1 ) * 2.5066282746310002 * sqrt( m + 1.0 );
+    tau = GET_MIN( duration, ( 1.0 / normA ) * pow( ( factor * tolerance ) / ( 4.0 * normA ), 1.0 / m ) );
+    
+    while( now < duration ) {
+        for( beta = 0.0, i = 0; i < stateSize; i++ ) {
+            beta += w[i] * w[i];
+        }
+        if( ( beta = sqrt( beta ) ) == 0.0 ) {
+            break;
+        }
+        for( i = 0; i < stateSize; i++ ) {
+            V[i] = w[i] / beta;
+        }
+        memset( H, 0, ( m + 1 ) * ( m + 1 ) * sizeof(double) );
+        
+        /* Arnoldi with modified Gram-Schmidt; H is stored row-major with ( m + 1 ) columns */
+        mb = m;
+        isBreakdown = FALSE;
+        for( j = 0; j < m; j++ ) {
+            p = V + (long)( j + 1 ) * stateSize;
+            _MultiplyGenerator( analyzer, V + (long)j * stateSize, p );
+            for( i = 0; i <= j; i++ ) {
+                H[i * ( m + 1 ) + j] = _Dot( V + (long)i * stateSize, p, stateSize );
+                _Axpy( -H[i * ( m + 1 ) + j], V + (long)i * stateSize, p, stateSize );
+            }
+            s = sqrt( _Dot( p, p, stateSize ) );
+            if( s <= normA * tolerance * 1.0e-3 ) {
+                /* happy breakdown: the subspace is invariant, so the rest of the interval is exact */
+                mb = j + 1;
+                isBreakdown = TRUE;
+                tau = duration - now;
+                break;
+            }
+            H[( j + 1 ) * ( m + 1 ) + j] = s;
+            _Scale( 1.0 / s, p, stateSize );
+        }
+        hNext = isBreakdown ? 0.0 : H[m * ( m + 1 ) + ( m - 1 )];
+        
+        if( ( ( tauH = gsl_matrix_alloc( mb, mb ) ) == NULL ) || ( ( F = gsl_matrix_alloc( mb, mb ) ) == NULL ) ) {
+            ret = ErrorReport( FAILING, "_KrylovPropagate", "failed to allocate memory for the Hessenberg matrix" );
+            goto FREE_ARRAYS;
+        }
+        for( rejections = 0; ; rejections++ ) {
+            for( i = 0; i < mb; i++ ) {
+                for( j = 0; j < mb; j++ ) {
+                    gsl_matrix_set( tauH, i, j, tau * H[i * ( m + 1 ) + j] );
+                }
+            }
+            if( gsl_linalg_exponential_ss( tauH, F, GSL_PREC_DOUBLE ) != 0 ) {
+                ret = ErrorReport( FAILING, "_KrylovPropagate", "failed to exponentiate the Hessenberg matrix" );
+                goto FREE_ARRAYS;
+            }
+            /* local error estimate: beta h(m+1,m) |e_m^T exp( tau H ) e_1| */
+            error = beta * hNext * fabs( gsl_matrix_get( F, mb - 1, 0 ) );
+            if( error <= tolerance * tau / duration ) {
+                break;
+            }
+            if( rejections == CTMC_KRYLOV_MAX_REJECTIONS ) {
+                ret = ErrorReport( FAILING, "_KrylovPropagate", "step size control failed at time %g", now );
+                goto FREE_ARRAYS;
+            }
+            tau *= GET_MAX( 0.2, GET_MIN( 0.5, 0.9 * pow( ( tolerance * tau / duration ) / error, 1.0 / mb ) ) );
+        }
+        
+        for( i = 0; i < stateSize; i++ ) {
+            w[i] = 0.0;
+        }
+        for( j = 0; j < mb; j++ ) {
+            _Axpy( beta * gsl_matrix_get( F, j, 0 ), V + (long)j * stateSize, w, stateSize );
+        }
+        gsl_matrix_free( tauH );
+        gsl_matrix_free( F );
+        tauH = F = NULL;
+        
+        now += tau;
+        if( error > 0.0 ) {
+            tau *= GET_MAX( 0.2, GET_MIN( 10.0, 0.9 * pow( ( tolerance * tau / duration ) / error, 1.0 / mb ) ) );
+        }
+        else {
+            tau *= 10.0;
+        }
+        tau = GET_MIN( tau, duration - now );
+    }
+    
+    /* round-off can leave tiny negative probabilities */
+    for( i = 0; i < stateSize; i++ ) {
+        if( w[i] < 0.0 ) {
+            w[i] = 0.0;
+        }
+    }
+    
+FREE_ARRAYS:
+    if( tauH != NULL ) {
+        gsl_matrix_free( tauH );
+    }
+    if( F != NULL ) {
+        gsl_matrix_free( F );
+    }
+    FREE( V );
+    FREE( H );
+    
+    return ret;
+}
+
+static RET_VAL _AnalyzeWithKrylov( CTMC_ANALYZER *analyzer, double *initial, double *times, int size ) {
+    RET_VAL ret = SUCCESS;
+    int j = 0;
+    int stateSize = analyzer->markovChain->stateSize; 
+    double time = 0.0;
+    
+    for( j = 0; j < size; j++ ) {
+        if( IS_FAILED( ( ret = _KrylovPropagate( analyzer, initial, times[j] - time ) ) ) ) {
+            return ret;
+        }
+        time = times[j];
+        memcpy( analyzer->distributions + (long)j * stateSize, initial, stateSize * sizeof(double) );
+    }
+    
+    return SUCCESS;
+}
+
+/* the original explicit scheme, kept for comparison */
+static RET_VAL _AnalyzeWithFixedSteps( CTMC_ANALYZER *analyzer, double *times, int size ) {
+    RET_VAL ret = SUCCESS;
+    int i = 0;
+    int j = 0;
+    double time = 0.0;
+    double *distribution = NULL;
+    CTMC *markovChain = analyzer->markovChain;
+    CTMC_STATE *states = markovChain->states;
+    int stateSize = markovChain->stateSize; 
+    double dt = analyzer->dt;
+    CTMC_ANALYSIS_REC *rec = NULL;
+    
+    for( j = 0; j < size; j++ ) {
+        while( time <= times[j] ) {
+            TRACE_1("at time %g", time );
+            if( IS_FAILED( ( ret = _UpdateDistribution( stateSize, states ) ) ) ) {
+                return ret;
+            }
+            time += dt;
+        }
+        distribution = analyzer->distributions + (long)j * stateSize;
+        for( i = 0; i < stateSize; i++ ) {
+            rec = (CTMC_ANALYSIS_REC*)(states[i].analysisRecord);
+            distribution[i] = rec->currentProb;
+        }
+    }
+    
+    return SUCCESS;
+}
+
+static double _Dot( double *x, double *y, int size ) {
+    int i = 0;
+    double sum = 0.0;
+    
+    for( i = 0; i < size; i++ ) {
+        sum += x[i] * y[i];
+    }
+    return sum;
+}
+
+static void _Axpy( double a, double *x, double *y, int size ) {
+    int i = 0;
+    
+    for( i = 0; i < size; i++ ) {
+        y[i] += a * x[i];
+    }
+}
+
+static void _Scale( double a, double *x, int size ) {
+    int i = 0;
+    
+    for( i = 0; i < size; i++ ) {
+        x[i] *= a;
+    }
+}
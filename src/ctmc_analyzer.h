@@ -28,6 +28,14 @@ BEGIN_C_NAMESPACE
 
 #define CTMC_ANALYSIS_DT_RATE 0.1
 
+#define CTMC_TRANSIENT_METHOD_UNIFORMIZATION 0
+#define CTMC_TRANSIENT_METHOD_KRYLOV 1
+#define CTMC_TRANSIENT_METHOD_FIXED_STEP 2
+
+#define DEFAULT_CTMC_TRANSIENT_ERROR 1.0e-9
+#define CTMC_KRYLOV_SUBSPACE_SIZE 30
+#define CTMC_KRYLOV_MAX_REJECTIONS 20
+
 typedef struct {
     double currentProb;
     double newProb;
@@ -42,9 +50,22 @@ struct _CTMC_ANALYZER {
     CTMC *markovChain;
     double dt;
     double highestOutRate;
+    int method;
+    double errorBound;
+    /* the rate matrix in compressed rows, built on the first analysis */
+    int *rowStart;
+    int *columnIndex;
+    double *rates;
+    double *outRates;
+    /* one row of stateSize probabilities per requested time */
+    int timeSize;
+    double *distributions;
     double (*GetDt)( CTMC_ANALYZER *analyzer );    
     RET_VAL (*ResetDt)( CTMC_ANALYZER *analyzer, double dt );
+    RET_VAL (*SetTransientMethod)( CTMC_ANALYZER *analyzer, int method, double errorBound );
     RET_VAL (*Analyze)( CTMC_ANALYZER *analyzer, double timeLimit );
+    RET_VAL (*AnalyzeAtTimes)( CTMC_ANALYZER *analyzer, double *times, int size );
+    RET_VAL (*SelectResult)( CTMC_ANALYZER *analyzer, int index );
     CTMC *(*GetResult)( CTMC_ANALYZER *analyzer );
 };
 
@@ -19,16 +19,77 @@
  ***************************************************************************/
 #include "ctmc_stationary_analysis_back_end_processor.h"
 #include "markov_chain.h"
+#include "ctmc_stationary_analyzer.h"
+#include "ir2ctmc_transformer.h"
+#include "strconv.h"
+#include "markov_chain_analysis_properties.h"
+#include "markov_analysis_result_reporter.h"
 
 
-
-static BOOL _IsConditionSatisfied( BACK_END_PROCESSOR *backend, IR *ir );
+static RET_VAL _SetStationaryMethod( CTMC_STATIONARY_ANALYZER *analyzer, REB2SAC_PROPERTIES *properties );
+static RET_VAL _PrintDiagnostics( FILE *file, CTMC_STATIONARY_ANALYZER *analyzer, char *methodName );
 
 
 
 RET_VAL ProcessCTMCStationaryAnalysisBackend( BACK_END_PROCESSOR *backend, IR *ir ) {
     RET_VAL ret = SUCCESS;
+    char *filename = NULL;
+    char *methodName = NULL;
+    FILE *file = NULL;
+    COMPILER_RECORD_T *record = backend->record;
+    REB2SAC_PROPERTIES *properties = record->properties;
+    CTMC *ctmc = NULL;
+    CTMC_STATIONARY_ANALYZER *analyzer = NULL;
+    IR2CTMC_TRANSFORMER *transformer = NULL;
+    MARKOV_ANALYSIS_RESULT_REPORTER *reporter = NULL;
+    
+    START_FUNCTION("ProcessCTMCStationaryAnalysisBackend");
+    
+    if( ( filename = backend->outputFilename ) == NULL ) {
+        filename = DEFAULT_CTMC_STATIONARY_ANALYSIS_OUTPUT_NAME;
+    }
+    if( ( file = fopen( filename, "w" ) ) == NULL ) {
+        return ErrorReport( FAILING, "ProcessCTMCStationaryAnalysisBackend", "stationary probability analysis file open error" ); 
+    }
+    
+    if( ( transformer = CreateIR2CTMCTransformer( ir, properties ) ) == NULL ) {
+        return ErrorReport( FAILING, "ProcessCTMCStationaryAnalysisBackend", "failed to transform IR to CTMC" );
+    }
+    if( ( ctmc = transformer->Generate( transformer ) ) == NULL ) {
+        return ErrorReport( FAILING, "ProcessCTMCStationaryAnalysisBackend", "failed to generate CTMC" );
+    } 
+    
+    if( ( analyzer = CreateCTMCStationaryAnalyzer( ctmc ) ) == NULL ) {
+        return ErrorReport( FAILING, "ProcessCTMCStationaryAnalysisBackend", "failed to create CTMC stationary analyzer" );
+    }
+    if( IS_FAILED( ( ret = _SetStationaryMethod( analyzer, properties ) ) ) ) {
+        END_FUNCTION("ProcessCTMCStationaryAnalysisBackend", ret );
+        return ret;
+    }
+    if( IS_FAILED( ( ret = analyzer->Analyze( analyzer ) ) ) ) {
+        END_FUNCTION("ProcessCTMCStationaryAnalysisBackend", ret );
+        return ret;
+    }
+    ctmc = analyzer->GetResult( analyzer );
     
+    if( ( methodName = properties->GetProperty( properties, MARKOV_CHAIN_STATIONARY_METHOD_KEY ) ) == NULL ) {
+        methodName = DEFAULT_MARKOV_CHAIN_STATIONARY_METHOD;
+    }
+    if( IS_FAILED( ( ret = _PrintDiagnostics( file, analyzer, methodName ) ) ) ) {
+        END_FUNCTION("ProcessCTMCStationaryAnalysisBackend", ret );
+        return ret;
+    }
+    
+    if( ( reporter = CreateMarkovAnalysisResultReporter( properties ) ) == NULL ) {
+        return ErrorReport( FAILING, "ProcessCTMCStationaryAnalysisBackend", "could not create a markov analysis reporter" );
+    } 
+    if( IS_FAILED( ( ret = reporter->Report( reporter, file, (MARKOV_CHAIN*)ctmc, (CADDR_T)transformer ) ) ) ) {
+        END_FUNCTION("ProcessCTMCStationaryAnalysisBackend", ret );
+        return ret;
+    }
+    fclose( file );
+    
+    END_FUNCTION("ProcessCTMCStationaryAnalysisBackend", ret );
     return ret;
 }
 
@@ -39,3 +100,76 @@ RET_VAL CloseCTMCStationaryAnalysisBackend( BACK_END_PROCESSOR *backend ) {
     return ret;
 }
 
+
+static RET_VAL _SetStationaryMethod( CTMC_STATIONARY_ANALYZER *analyzer, REB2SAC_PROPERTIES *properties ) {
+    RET_VAL ret = SUCCESS;
+    int method = EMC_STATIONARY_METHOD_GAUSS_SEIDEL;
+    UINT32 iterationMax = 0;
+    char *valueString = NULL;
+    double omega = DEFAULT_EMC_STATIONARY_SOR_OMEGA;
+    double tolerance = DEFAULT_EMC_STATIONARY_ANALYSIS_TOLERANCE;
+    
+    if( ( valueString = properties->GetProperty( properties, MARKOV_CHAIN_STATIONARY_METHOD_KEY ) ) != NULL ) {
+        if( strcmp( valueString, MARKOV_CHAIN_STATIONARY_METHOD_POWER ) == 0 ) {
+            method = EMC_STATIONARY_METHOD_POWER;
+        }
+        else if( strcmp( valueString, MARKOV_CHAIN_STATIONARY_METHOD_GAUSS_SEIDEL ) == 0 ) {
+            method = EMC_STATIONARY_METHOD_GAUSS_SEIDEL;
+        }
+        else if( strcmp( valueString, MARKOV_CHAIN_STATIONARY_METHOD_SOR ) == 0 ) {
+            method = EMC_STATIONARY_METHOD_SOR;
+        }
+        else if( strcmp( valueString, MARKOV_CHAIN_STATIONARY_METHOD_BICGSTAB ) == 0 ) {
+            method = EMC_STATIONARY_METHOD_BICGSTAB;
+        }
+        else {
+            return ErrorReport( FAILING, "_SetStationaryMethod", "unknown stationary method %s", valueString );
+        }
+    }
+    if( ( valueString = properties->GetProperty( properties, MARKOV_CHAIN_STATIONARY_SOR_OMEGA_KEY ) ) != NULL ) {
+        if( IS_FAILED( ( StrToFloat( &omega, valueString ) ) ) ) {
+            return ErrorReport( FAILING, "_SetStationaryMethod", "invalid value %s for %s", valueString, MARKOV_CHAIN_STATIONARY_SOR_OMEGA_KEY );
+        }
+    }
+    if( ( valueString = properties->GetProperty( properties, MARKOV_CHAIN_STATIONARY_TOLERANCE_KEY ) ) != NULL ) {
+        if( IS_FAILED( ( StrToFloat( &tolerance, valueString ) ) ) ) {
+            return ErrorReport( FAILING, "_SetStationaryMethod", "invalid value %s for %s", valueString, MARKOV_CHAIN_STATIONARY_TOLERANCE_KEY );
+        }
+    }
+    if( ( valueString = properties->GetProperty( properties, MARKOV_CHAIN_STATIONARY_MAX_ITERATIONS_KEY ) ) != NULL ) {
+        if( IS_FAILED( ( StrToUINT32( &iterationMax, valueString ) ) ) ) {
+            return ErrorReport( FAILING, "_SetStationaryMethod", "invalid value %s for %s", valueString, MARKOV_CHAIN_STATIONARY_MAX_ITERATIONS_KEY );
+        }
+        if( IS_FAILED( ( ret = analyzer->SetIterationMax( analyzer, (int)iterationMax ) ) ) ) {
+            return ret;
+        }
+    }
+    
+    return analyzer->SetMethod( analyzer, method, omega, tolerance );
+}
+
+static RET_VAL _PrintDiagnostics( FILE *file, CTMC_STATIONARY_ANALYZER *analyzer, char *methodName ) {
+    int i = 0;
+    int size = 0;
+    int iterations = 0;
+    double *history = NULL;
+    EMC_STATIONARY_ANALYZER *emcAnalyzer = analyzer->GetEMCAnalyzer( analyzer );
+    
+    iterations = emcAnalyzer->GetIterations( emcAnalyzer );
+    history = emcAnalyzer->GetResidualHistory( emcAnalyzer, &size );
+    
+    fprintf( file, "# stationary-method %s iterations %i residual %g" NEW_LINE, 
+        methodName, iterations, ( size > 0 ) ? history[size - 1] : 0.0 );
+    fprintf( file, "# residual-history" );
+    for( i = 0; i < size; i++ ) {
+        fprintf( file, " %g", history[i] );
+    }
+    fprintf( file, NEW_LINE );
+    
+    if( ( size > 0 ) && ( history[size - 1] > emcAnalyzer->GetTolerance( emcAnalyzer ) ) ) {
+        fprintf( stderr, "stationary analysis did not converge: residual %g after %i iterations" NEW_LINE, 
+            history[size - 1], iterations );
+    }
+    
+    return SUCCESS;
+}
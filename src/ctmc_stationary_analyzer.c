@@ -19,12 +19,13 @@
  ***************************************************************************/
 
 #include "ctmc_stationary_analyzer.h"
-#include "emc_stationary_analyzer.h"
 
 static RET_VAL _Analyze( CTMC_STATIONARY_ANALYZER *analyzer );
 static CTMC *_GetResult( CTMC_STATIONARY_ANALYZER *analyzer );
 static RET_VAL _SetIterationMax( CTMC_STATIONARY_ANALYZER *analyzer, int iterationMax );
 static int _GetIterationMax( CTMC_STATIONARY_ANALYZER *analyzer );
+static RET_VAL _SetMethod( CTMC_STATIONARY_ANALYZER *analyzer, int method, double omega, double tolerance );
+static EMC_STATIONARY_ANALYZER *_GetEMCAnalyzer( CTMC_STATIONARY_ANALYZER *analyzer );
 static CTMC *_ConvertEMCResultToCTMCResult( EMC *emc );
 
 CTMC_STATIONARY_ANALYZER *CreateCTMCStationaryAnalyzer( CTMC *markovChain ) {
@@ -45,15 +46,26 @@ CTMC_STATIONARY_ANALYZER *CreateCTMCStationaryAnalyzer( CTMC *markovChain ) {
     
     analyzer->markovChain = markovChain;
     analyzer->iterationMax = DEFAULT_CTMC_ITERATION_MAX;
+    analyzer->method = EMC_STATIONARY_METHOD_GAUSS_SEIDEL;
+    analyzer->omega = DEFAULT_EMC_STATIONARY_SOR_OMEGA;
+    analyzer->tolerance = DEFAULT_EMC_STATIONARY_ANALYSIS_TOLERANCE;
     analyzer->GetResult = _GetResult;
     analyzer->Analyze = _Analyze;    
+    analyzer->SetIterationMax = _SetIterationMax;
+    analyzer->GetIterationMax = _GetIterationMax;
+    analyzer->SetMethod = _SetMethod;
+    analyzer->GetEMCAnalyzer = _GetEMCAnalyzer;
        
     return analyzer;
 }
 
 RET_VAL FreeCTMCStationaryAnalyzer( CTMC_STATIONARY_ANALYZER **panalyzer ) {
-    CTMC_STATIONARY_ANALYZER *analyzer;
-    FREE( analyzer );
+    CTMC_STATIONARY_ANALYZER *analyzer = *panalyzer;
+    
+    if( analyzer->emcAnalyzer != NULL ) {
+        FreeEMCStationaryAnalyzer( &(analyzer->emcAnalyzer) );
+    }
+    FREE( *panalyzer );
         
     return SUCCESS;
 }
@@ -70,6 +82,14 @@ static RET_VAL _Analyze( CTMC_STATIONARY_ANALYZER *analyzer ) {
     if( ( emcAnalyzer = CreateEMCStationaryAnalyzer( ctmc ) ) == NULL ) {
         return FAILING;
     }
+    /* kept alive for the analysis records and the convergence diagnostics */
+    analyzer->emcAnalyzer = emcAnalyzer;
+    if( IS_FAILED( ( ret = emcAnalyzer->SetMethod( emcAnalyzer, analyzer->method, analyzer->omega ) ) ) ) {
+        return ret;    
+    }
+    if( IS_FAILED( ( ret = emcAnalyzer->SetTolerance( emcAnalyzer, analyzer->tolerance ) ) ) ) {
+        return ret;    
+    }
     if( IS_FAILED( ( ret = emcAnalyzer->Analyze( emcAnalyzer, analyzer->iterationMax ) ) ) ) {
         return ret;    
     }
@@ -85,12 +105,24 @@ static CTMC *_GetResult( CTMC_STATIONARY_ANALYZER *analyzer ) {
 
 static RET_VAL _SetIterationMax( CTMC_STATIONARY_ANALYZER *analyzer, int iterationMax ) {
     analyzer->iterationMax = iterationMax;
+    return SUCCESS;
 }
 
 static int _GetIterationMax( CTMC_STATIONARY_ANALYZER *analyzer ) {
     return analyzer->iterationMax;
 }
 
+static RET_VAL _SetMethod( CTMC_STATIONARY_ANALYZER *analyzer, int method, double omega, double tolerance ) {
+    analyzer->method = method;
+    analyzer->omega = omega;
+    analyzer->tolerance = tolerance;
+    return SUCCESS;
+}
+
+static EMC_STATIONARY_ANALYZER *_GetEMCAnalyzer( CTMC_STATIONARY_ANALYZER *analyzer ) {
+    return analyzer->emcAnalyzer;
+}
+
 
 
 static double _CalculateOutRate( CTMC_STATE *state ) {
@@ -112,7 +144,6 @@ static double _CalculateOutRate( CTMC_STATE *state ) {
 static CTMC *_ConvertEMCResultToCTMCResult( EMC *emc ) {
     EMC_STATIONARY_ANALYSIS_REC *rec = NULL;
     EMC_STATE *states = emc->states;
-    EMC_STATE *state = NULL;
     int i = 0;
     int stateSize = emc->stateSize;
     VECTOR *transitions = NULL;
@@ -131,7 +162,7 @@ static CTMC *_ConvertEMCResultToCTMCResult( EMC *emc ) {
             transition = (EMC_TRANSITION*)GetElementFromVector( transitions, j );
             outRate += transition->rate;
         }
-        rec = (EMC_STATIONARY_ANALYSIS_REC*)(state->analysisRecord);
+        rec = (EMC_STATIONARY_ANALYSIS_REC*)(states[i].analysisRecord);
         currentProb = rec->currentProb / outRate;
         norm1 += currentProb;
         rec->currentProb = currentProb;
@@ -23,6 +23,7 @@
 
 #include "common.h"
 #include "markov_chain.h"
+#include "emc_stationary_analyzer.h"
 
 BEGIN_C_NAMESPACE
 
@@ -40,8 +41,14 @@ typedef struct _CTMC_STATIONARY_ANALYZER CTMC_STATIONARY_ANALYZER;
 struct _CTMC_STATIONARY_ANALYZER {
     CTMC *markovChain;
     int iterationMax;
+    int method;
+    double omega;
+    double tolerance;
+    EMC_STATIONARY_ANALYZER *emcAnalyzer;
     RET_VAL (*SetIterationMax)( CTMC_STATIONARY_ANALYZER *analyzer, int iterationMax );
     int (*GetIterationMax)( CTMC_STATIONARY_ANALYZER *analyzer );
+    RET_VAL (*SetMethod)( CTMC_STATIONARY_ANALYZER *analyzer, int method, double omega, double tolerance );
+    EMC_STATIONARY_ANALYZER *(*GetEMCAnalyzer)( CTMC_STATIONARY_ANALYZER *analyzer );
     RET_VAL (*Analyze)( CTMC_STATIONARY_ANALYZER *analyzer );
     CTMC *(*GetResult)( CTMC_STATIONARY_ANALYZER *analyzer );
 };
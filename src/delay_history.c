@@ -0,0 +1,192 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the reb2sac contributors                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#include "delay_history.h"
+
+#define _POSITION( history, i ) ( ( (history)->start + (i) ) % (history)->capacity )
+
+static void _PruneDelayHistory( DELAY_HISTORY *history );
+static RET_VAL _GrowDelayHistory( DELAY_HISTORY *history );
+
+DLLSCOPE DELAY_HISTORY * STDCALL CreateDelayHistory( double horizon ) {
+    DELAY_HISTORY *history = NULL;
+
+    START_FUNCTION("CreateDelayHistory");
+
+    if( ( history = (DELAY_HISTORY*)MALLOC( sizeof(DELAY_HISTORY) ) ) == NULL ) {
+        END_FUNCTION("CreateDelayHistory", FAILING );
+        return NULL;
+    }
+    history->capacity = DELAY_HISTORY_INITIAL_CAPACITY;
+    history->horizon = horizon;
+    if( ( ( history->times = (double*)CALLOC( history->capacity, sizeof(double) ) ) == NULL ) ||
+        ( ( history->values = (double*)CALLOC( history->capacity, sizeof(double) ) ) == NULL ) ) {
+        FreeDelayHistory( &history );
+        END_FUNCTION("CreateDelayHistory", FAILING );
+        return NULL;
+    }
+    ResetDelayHistory( history );
+
+    END_FUNCTION("CreateDelayHistory", SUCCESS );
+    return history;
+}
+
+DLLSCOPE RET_VAL STDCALL FreeDelayHistory( DELAY_HISTORY **history ) {
+    RET_VAL ret = SUCCESS;
+
+    START_FUNCTION("FreeDelayHistory");
+
+    if( ( history == NULL ) || ( *history == NULL ) ) {
+        END_FUNCTION("FreeDelayHistory", SUCCESS );
+        return ret;
+    }
+    FREE( (*history)->times );
+    FREE( (*history)->values );
+    FREE( *history );
+
+    END_FUNCTION("FreeDelayHistory", SUCCESS );
+    return ret;
+}
+
+DLLSCOPE RET_VAL STDCALL ResetDelayHistory( DELAY_HISTORY *history ) {
+    history->start = 0;
+    history->size = 0;
+    return SUCCESS;
+}
+
+DLLSCOPE RET_VAL STDCALL ExtendHorizonOfDelayHistory( DELAY_HISTORY *history, double horizon ) {
+    if( ( history->horizon >= 0.0 ) && ( horizon > history->horizon ) ) {
+        history->horizon = horizon;
+    }
+    return SUCCESS;
+}
+
+DLLSCOPE RET_VAL STDCALL RecordInDelayHistory( DELAY_HISTORY *history, double time, double value ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 position = 0;
+
+    while( ( history->size > 0 ) && ( history->times[_POSITION( history, history->size - 1 )] > time ) ) {
+        history->size--;
+    }
+    if( history->size > 0 ) {
+        position = _POSITION( history, history->size - 1 );
+        if( history->times[position] == time ) {
+            history->values[position] = value;
+            return SUCCESS;
+        }
+    }
+    if( history->size == history->capacity ) {
+        _PruneDelayHistory( history );
+        if( ( history->size == history->capacity ) && IS_FAILED( ( ret = _GrowDelayHistory( history ) ) ) ) {
+            return ret;
+        }
+    }
+    position = _POSITION( history, history->size );
+    history->times[position] = time;
+    history->values[position] = value;
+    history->size++;
+    return SUCCESS;
+}
+
+/*
+ * The value at the given time: that of the newest entry not after it, or, when interpolate 
+ * is set, the linear interpolation between it and the next entry.  Times before the oldest 
+ * entry get the oldest value.
+ */
+DLLSCOPE double STDCALL GetValueFromDelayHistory( DELAY_HISTORY *history, double time, BOOL interpolate ) {
+    UINT32 low = 0;
+    UINT32 high = 0;
+    UINT32 middle = 0;
+    UINT32 position = 0;
+    UINT32 next = 0;
+
+    if( history->size == 0 ) {
+        return 0.0;
+    }
+    if( time <= history->times[_POSITION( history, 0 )] ) {
+        return history->values[_POSITION( history, 0 )];
+    }
+    high = history->size - 1;
+    if( time >= history->times[_POSITION( history, high )] ) {
+        return history->values[_POSITION( history, high )];
+    }
+    /* times[low] <= time < times[high] */
+    while( high - low > 1 ) {
+        middle = low + ( high - low ) / 2;
+        if( history->times[_POSITION( history, middle )] <= time ) {
+            low = middle;
+        }
+        else {
+            high = middle;
+        }
+    }
+    position = _POSITION( history, low );
+    if( !interpolate || ( history->times[position] == time ) ) {
+        return history->values[position];
+    }
+    next = _POSITION( history, high );
+    return history->values[position] + ( history->values[next] - history->values[position] ) *
+        ( ( time - history->times[position] ) / ( history->times[next] - history->times[position] ) );
+}
+
+DLLSCOPE UINT32 STDCALL GetDelayHistorySize( DELAY_HISTORY *history ) {
+    return history->size;
+}
+
+/*
+ * Drops the entries that no lookup within the horizon of the newest time can reach, keeping 
+ * the newest entry at or before that horizon for the step and interpolating lookups.
+ */
+static void _PruneDelayHistory( DELAY_HISTORY *history ) {
+    double oldest = 0.0;
+
+    if( ( history->horizon < 0.0 ) || ( history->size == 0 ) ) {
+        return;
+    }
+    oldest = history->times[_POSITION( history, history->size - 1 )] - history->horizon;
+    while( ( history->size > 1 ) && ( history->times[_POSITION( history, 1 )] <= oldest ) ) {
+        history->start = _POSITION( history, 1 );
+        history->size--;
+    }
+}
+
+static RET_VAL _GrowDelayHistory( DELAY_HISTORY *history ) {
+    double *times = NULL;
+    double *values = NULL;
+    UINT32 capacity = history->capacity * 2;
+    UINT32 i = 0;
+
+    if( ( ( times = (double*)CALLOC( capacity, sizeof(double) ) ) == NULL ) ||
+        ( ( values = (double*)CALLOC( capacity, sizeof(double) ) ) == NULL ) ) {
+        if( times != NULL ) {
+            FREE( times );
+        }
+        return ErrorReport( FAILING, "_GrowDelayHistory", "could not grow the delay history to %lu entries", capacity );
+    }
+    for( i = 0; i < history->size; i++ ) {
+        times[i] = history->times[_POSITION( history, i )];
+        values[i] = history->values[_POSITION( history, i )];
+    }
+    FREE( history->times );
+    FREE( history->values );
+    history->times = times;
+    history->values = values;
+    history->capacity = capacity;
+    history->start = 0;
+    return SUCCESS;
+}
@@ -0,0 +1,57 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the reb2sac contributors                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#if !defined(HAVE_DELAY_HISTORY)
+#define HAVE_DELAY_HISTORY
+
+#include "common.h"
+
+BEGIN_C_NAMESPACE
+
+#define DELAY_HISTORY_INITIAL_CAPACITY 64
+#define DELAY_HISTORY_UNBOUNDED -1.0
+
+/*
+ * The recorded values of the first argument of a delay( x, d ) node, kept in a circular 
+ * buffer ordered by time so the value at time - d is found by binary search.  Entries older 
+ * than horizon, the largest delay the node is evaluated with, are dropped before the buffer 
+ * grows, so its size is bounded by the number of distinct times within one horizon.  A 
+ * negative horizon keeps every entry.  Recording at a time earlier than the newest entry, 
+ * as on a new run or a rejected ODE step, discards the entries after it.
+ */
+typedef struct {
+    double *times;
+    double *values;
+    UINT32 capacity;
+    UINT32 start;
+    UINT32 size;
+    double horizon;
+} DELAY_HISTORY;
+
+DLLSCOPE DELAY_HISTORY * STDCALL CreateDelayHistory( double horizon );
+DLLSCOPE RET_VAL STDCALL FreeDelayHistory( DELAY_HISTORY **history );
+
+DLLSCOPE RET_VAL STDCALL ResetDelayHistory( DELAY_HISTORY *history );
+DLLSCOPE RET_VAL STDCALL ExtendHorizonOfDelayHistory( DELAY_HISTORY *history, double horizon );
+DLLSCOPE RET_VAL STDCALL RecordInDelayHistory( DELAY_HISTORY *history, double time, double value );
+DLLSCOPE double STDCALL GetValueFromDelayHistory( DELAY_HISTORY *history, double time, BOOL interpolate );
+DLLSCOPE UINT32 STDCALL GetDelayHistorySize( DELAY_HISTORY *history );
+
+END_C_NAMESPACE
+
+#endif
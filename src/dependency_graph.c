@@ -1,6 +1,6 @@
 /***************************************************************************
  *   Copyright (C) 2004 by Hiroyuki Kuwahara                               *
- *   kuwahara@cs.utah.edu                                                  *
+ *   kuwahara@cs.utah.edu                                                 *
  *                                                                         *
  *   This program is free software; you can redistribute it and/or modify  *
  *   it under the terms of the GNU General Public License as published by  *
@@ -18,3 +18,610 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 #include "dependency_graph.h"
+
+typedef struct {
+    HASH_TABLE *table;
+    UINT32 *variableIndices;
+    UINT32 variablesSize;
+    UINT32 *variableMarks;
+    UINT32 *reactionMarks;
+    UINT32 mark;
+    UINT32 *items;
+    UINT32 itemsSize;
+    UINT32 itemsCapacity;
+} DEPENDENCY_COLLECTOR;
+
+typedef struct {
+    UINT32 *offsets;
+    UINT32 *entries;
+    UINT32 rowsSize;
+    UINT32 entriesSize;
+    UINT32 entriesCapacity;
+} DEPENDENCY_ROWS;
+
+static RET_VAL _InitCollector( DEPENDENCY_COLLECTOR *collector, UINT32 reactionsSize,
+                               SPECIES **speciesArray, UINT32 speciesSize,
+                               COMPARTMENT **compartmentArray, UINT32 compartmentsSize,
+                               REB2SAC_SYMBOL **symbolArray, UINT32 symbolsSize );
+static void _FreeCollector( DEPENDENCY_COLLECTOR *collector );
+static void _StartCollecting( DEPENDENCY_COLLECTOR *collector );
+static RET_VAL _AddItem( DEPENDENCY_COLLECTOR *collector, UINT32 item );
+static RET_VAL _AddVariable( DEPENDENCY_COLLECTOR *collector, CADDR_T node );
+static RET_VAL _AddSpecies( DEPENDENCY_COLLECTOR *collector, SPECIES *species );
+static RET_VAL _AddReaction( DEPENDENCY_COLLECTOR *collector, UINT32 reactionIndex );
+static RET_VAL _CollectKineticLaw( DEPENDENCY_COLLECTOR *collector, KINETIC_LAW *law );
+static RET_VAL _CollectReaction( DEPENDENCY_COLLECTOR *collector, REACTION *reaction );
+
+static RET_VAL _InitRows( DEPENDENCY_ROWS *rows, UINT32 rowsSize );
+static void _FreeRows( DEPENDENCY_ROWS *rows );
+static RET_VAL _AppendRow( DEPENDENCY_ROWS *rows, UINT32 row, UINT32 *items, UINT32 itemsSize );
+static RET_VAL _InvertRows( DEPENDENCY_ROWS *rows, UINT32 columnsSize, DEPENDENCY_ROWS *inverted );
+
+static RET_VAL _VisitPWToCollect( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw );
+static RET_VAL _VisitOpToCollect( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw );
+static RET_VAL _VisitUnaryOpToCollect( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw );
+static RET_VAL _VisitConstantToCollect( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw );
+static RET_VAL _VisitCompartmentToCollect( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw );
+static RET_VAL _VisitSpeciesToCollect( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw );
+static RET_VAL _VisitSymbolToCollect( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw );
+
+
+/*
+ * The graph is built in three passes.  The variables read by every reaction ( kinetic law, 
+ * reactant stoichiometry and conversion factors ) and by every assignment rule are collected 
+ * first.  For each variable, the reactions reading it are then gathered by following the 
+ * assignment rules that read the variable to their targets.  Finally, each reaction is given 
+ * the union of the rows of the species it changes.
+ */
+DLLSCOPE NEXT_REACTION_DEPENDENCY_GRAPH * STDCALL 
+CreateNextReactionDependencyGraph( REACTION **reactionArray, UINT32 reactionsSize, 
+                                   SPECIES **speciesArray, UINT32 speciesSize,
+                                   COMPARTMENT **compartmentArray, UINT32 compartmentsSize,
+                                   REB2SAC_SYMBOL **symbolArray, UINT32 symbolsSize,
+                                   RULE **ruleArray, UINT32 rulesSize ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 j = 0;
+    UINT32 k = 0;
+    UINT32 u = 0;
+    UINT32 v = 0;
+    UINT32 head = 0;
+    UINT32 *index = NULL;
+    UINT32 *targets = NULL;
+    UINT32 *queue = NULL;
+    BYTE varType = 0;
+    SPECIES *species = NULL;
+    IR_EDGE *edge = NULL;
+    LINKED_LIST *edges = NULL;
+    RULE *rule = NULL;
+    DEPENDENCY_COLLECTOR collector;
+    DEPENDENCY_ROWS reactionReads;
+    DEPENDENCY_ROWS ruleReads;
+    DEPENDENCY_ROWS directReaders;
+    DEPENDENCY_ROWS readingRules;
+    DEPENDENCY_ROWS readers;
+    DEPENDENCY_ROWS affectees;
+    NEXT_REACTION_DEPENDENCY_GRAPH *graph = NULL;
+
+    START_FUNCTION("CreateNextReactionDependencyGraph");
+
+    memset( &reactionReads, 0, sizeof(reactionReads) );
+    memset( &ruleReads, 0, sizeof(ruleReads) );
+    memset( &directReaders, 0, sizeof(directReaders) );
+    memset( &readingRules, 0, sizeof(readingRules) );
+    memset( &readers, 0, sizeof(readers) );
+    memset( &affectees, 0, sizeof(affectees) );
+
+    if( IS_FAILED( ( ret = _InitCollector( &collector, reactionsSize, speciesArray, speciesSize, 
+                                           compartmentArray, compartmentsSize, symbolArray, symbolsSize ) ) ) ) {
+        ErrorReport( ret, "CreateNextReactionDependencyGraph", "could not create the variable table" );
+        goto CLEANUP;
+    }
+    if( IS_FAILED( ( ret = _InitRows( &reactionReads, reactionsSize ) ) ) ||
+        IS_FAILED( ( ret = _InitRows( &ruleReads, rulesSize ) ) ) ||
+        IS_FAILED( ( ret = _InitRows( &readers, collector.variablesSize ) ) ) ||
+        IS_FAILED( ( ret = _InitRows( &affectees, reactionsSize ) ) ) ) {
+        ErrorReport( ret, "CreateNextReactionDependencyGraph", "could not allocate dependency rows" );
+        goto CLEANUP;
+    }
+    if( rulesSize > 0 ) {
+        if( ( targets = (UINT32*)MALLOC( rulesSize * sizeof(UINT32) ) ) == NULL ) {
+            ret = ErrorReport( FAILING, "CreateNextReactionDependencyGraph", "could not allocate rule targets" );
+            goto CLEANUP;
+        }
+    }
+    if( collector.variablesSize > 0 ) {
+        if( ( queue = (UINT32*)MALLOC( collector.variablesSize * sizeof(UINT32) ) ) == NULL ) {
+            ret = ErrorReport( FAILING, "CreateNextReactionDependencyGraph", "could not allocate variable queue" );
+            goto CLEANUP;
+        }
+    }
+
+    for( i = 0; i < reactionsSize; i++ ) {
+        _StartCollecting( &collector );
+        if( IS_FAILED( ( ret = _CollectReaction( &collector, reactionArray[i] ) ) ) ||
+            IS_FAILED( ( ret = _AppendRow( &reactionReads, i, collector.items, collector.itemsSize ) ) ) ) {
+            ErrorReport( ret, "CreateNextReactionDependencyGraph", "could not collect the variables of reaction %s", 
+                         GetCharArrayOfString( GetReactionNodeName( reactionArray[i] ) ) );
+            goto CLEANUP;
+        }
+    }
+
+    /* rules other than resolved assignment rules contribute empty rows */
+    for( i = 0; i < rulesSize; i++ ) {
+        rule = ruleArray[i];
+        _StartCollecting( &collector );
+        targets[i] = collector.variablesSize;
+        varType = GetRuleVarType( rule );
+        if( ( GetRuleType( rule ) == RULE_TYPE_ASSIGNMENT ) && ( varType != 0 ) ) {
+            j = GetRuleIndex( rule );
+            if( varType == SPECIES_RULE ) {
+                targets[i] = j;
+            } else if( varType == COMPARTMENT_RULE ) {
+                targets[i] = speciesSize + j;
+            } else {
+                targets[i] = speciesSize + compartmentsSize + j;
+            }
+            if( IS_FAILED( ( ret = _CollectKineticLaw( &collector, GetMathInRule( rule ) ) ) ) ) {
+                ErrorReport( ret, "CreateNextReactionDependencyGraph", "could not collect the variables of the rule for %s", 
+                             GetCharArrayOfString( GetRuleVar( rule ) ) );
+                goto CLEANUP;
+            }
+        }
+        if( IS_FAILED( ( ret = _AppendRow( &ruleReads, i, collector.items, collector.itemsSize ) ) ) ) {
+            goto CLEANUP;
+        }
+    }
+
+    if( IS_FAILED( ( ret = _InvertRows( &reactionReads, collector.variablesSize, &directReaders ) ) ) ||
+        IS_FAILED( ( ret = _InvertRows( &ruleReads, collector.variablesSize, &readingRules ) ) ) ) {
+        ErrorReport( ret, "CreateNextReactionDependencyGraph", "could not invert dependency rows" );
+        goto CLEANUP;
+    }
+
+    for( v = 0; v < collector.variablesSize; v++ ) {
+        _StartCollecting( &collector );
+        queue[0] = v;
+        collector.variableMarks[v] = collector.mark;
+        head = 0;
+        k = 1;
+        while( head < k ) {
+            u = queue[head++];
+            for( j = directReaders.offsets[u]; j < directReaders.offsets[u+1]; j++ ) {
+                if( IS_FAILED( ( ret = _AddReaction( &collector, directReaders.entries[j] ) ) ) ) {
+                    goto CLEANUP;
+                }
+            }
+            for( j = readingRules.offsets[u]; j < readingRules.offsets[u+1]; j++ ) {
+                i = targets[readingRules.entries[j]];
+                if( collector.variableMarks[i] != collector.mark ) {
+                    collector.variableMarks[i] = collector.mark;
+                    queue[k++] = i;
+                }
+            }
+        }
+        if( IS_FAILED( ( ret = _AppendRow( &readers, v, collector.items, collector.itemsSize ) ) ) ) {
+            goto CLEANUP;
+        }
+    }
+
+    for( i = 0; i < reactionsSize; i++ ) {
+        _StartCollecting( &collector );
+        if( IS_FAILED( ( ret = _AddReaction( &collector, i ) ) ) ) {
+            goto CLEANUP;
+        }
+        for( k = 0; k < 2; k++ ) {
+            edges = ( k == 0 ) ? GetReactantEdges( (IR_NODE*)reactionArray[i] ) : GetProductEdges( (IR_NODE*)reactionArray[i] );
+            ResetCurrentElement( edges );
+            while( ( edge = GetNextEdge( edges ) ) != NULL ) {
+                species = GetSpeciesInIREdge( edge );
+                if( HasBoundaryConditionInSpeciesNode( species ) ) {
+                    continue;
+                }
+                if( ( index = (UINT32*)GetValueFromHashTable( (CADDR_T)&species, sizeof(species), collector.table ) ) == NULL ) {
+                    continue;
+                }
+                for( j = readers.offsets[*index]; j < readers.offsets[*index+1]; j++ ) {
+                    if( IS_FAILED( ( ret = _AddReaction( &collector, readers.entries[j] ) ) ) ) {
+                        goto CLEANUP;
+                    }
+                }
+            }
+        }
+        if( IS_FAILED( ( ret = _AppendRow( &affectees, i, collector.items, collector.itemsSize ) ) ) ) {
+            goto CLEANUP;
+        }
+    }
+
+    if( ( graph = (NEXT_REACTION_DEPENDENCY_GRAPH*)MALLOC( sizeof(NEXT_REACTION_DEPENDENCY_GRAPH) ) ) == NULL ) {
+        ret = ErrorReport( FAILING, "CreateNextReactionDependencyGraph", "could not allocate the dependency graph" );
+        goto CLEANUP;
+    }
+    graph->reactionArray = reactionArray;
+    graph->reactionsSize = reactionsSize;
+    graph->speciesSize = speciesSize;
+    graph->compartmentsSize = compartmentsSize;
+    graph->symbolsSize = symbolsSize;
+    graph->affecteeOffsets = affectees.offsets;
+    graph->affectees = affectees.entries;
+    graph->readerOffsets = readers.offsets;
+    graph->readers = readers.entries;
+    memset( &affectees, 0, sizeof(affectees) );
+    memset( &readers, 0, sizeof(readers) );
+
+    TRACE_2( "dependency graph has %i reaction edges and %i variable edges", 
+             graph->affecteeOffsets[reactionsSize], graph->readerOffsets[collector.variablesSize] );
+
+CLEANUP:
+    _FreeRows( &reactionReads );
+    _FreeRows( &ruleReads );
+    _FreeRows( &directReaders );
+    _FreeRows( &readingRules );
+    _FreeRows( &readers );
+    _FreeRows( &affectees );
+    _FreeCollector( &collector );
+    FREE( targets );
+    FREE( queue );
+
+    END_FUNCTION("CreateNextReactionDependencyGraph", ret );
+    return graph;
+}
+
+DLLSCOPE RET_VAL STDCALL FreeNextReactionDependencyGraph( NEXT_REACTION_DEPENDENCY_GRAPH **graph ) {
+    NEXT_REACTION_DEPENDENCY_GRAPH *target = *graph;
+
+    START_FUNCTION("FreeNextReactionDependencyGraph");
+
+    if( target == NULL ) {
+        END_FUNCTION("FreeNextReactionDependencyGraph", SUCCESS );
+        return SUCCESS;
+    }
+    FREE( target->affecteeOffsets );
+    FREE( target->affectees );
+    FREE( target->readerOffsets );
+    FREE( target->readers );
+    FREE( *graph );
+
+    END_FUNCTION("FreeNextReactionDependencyGraph", SUCCESS );
+    return SUCCESS;
+}
+
+DLLSCOPE UINT32 * STDCALL GetAffectedReactionsInDependencyGraph( NEXT_REACTION_DEPENDENCY_GRAPH *graph, UINT32 reactionIndex, UINT32 *size ) {
+    UINT32 *offsets = graph->affecteeOffsets;
+
+    *size = offsets[reactionIndex+1] - offsets[reactionIndex];
+    return graph->affectees + offsets[reactionIndex];
+}
+
+DLLSCOPE UINT32 * STDCALL GetReactionsDependingOnSpecies( NEXT_REACTION_DEPENDENCY_GRAPH *graph, UINT32 speciesIndex, UINT32 *size ) {
+    UINT32 *offsets = graph->readerOffsets;
+
+    *size = offsets[speciesIndex+1] - offsets[speciesIndex];
+    return graph->readers + offsets[speciesIndex];
+}
+
+DLLSCOPE UINT32 * STDCALL GetReactionsDependingOnCompartment( NEXT_REACTION_DEPENDENCY_GRAPH *graph, UINT32 compartmentIndex, UINT32 *size ) {
+    return GetReactionsDependingOnSpecies( graph, graph->speciesSize + compartmentIndex, size );
+}
+
+DLLSCOPE UINT32 * STDCALL GetReactionsDependingOnSymbol( NEXT_REACTION_DEPENDENCY_GRAPH *graph, UINT32 symbolIndex, UINT32 *size ) {
+    return GetReactionsDependingOnSpecies( graph, graph->speciesSize + graph->compartmentsSize + symbolIndex, size );
+}
+
+
+/*
+ * Variables are numbered species first, then compartments, then symbols.  The table is 
+ * keyed by the node addresses stored in the caller's arrays, so the arrays must outlive it. 
+ */
+static RET_VAL _InitCollector( DEPENDENCY_COLLECTOR *collector, UINT32 reactionsSize,
+                               SPECIES **speciesArray, UINT32 speciesSize,
+                               COMPARTMENT **compartmentArray, UINT32 compartmentsSize,
+                               REB2SAC_SYMBOL **symbolArray, UINT32 symbolsSize ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 v = 0;
+    UINT32 size = speciesSize + compartmentsSize + symbolsSize;
+
+    memset( collector, 0, sizeof(DEPENDENCY_COLLECTOR) );
+    collector->variablesSize = size;
+    if( ( collector->table = CreateHashTable( GET_MAX( size, 16 ) ) ) == NULL ) {
+        return FAILING;
+    }
+    if( size > 0 ) {
+        if( ( ( collector->variableIndices = (UINT32*)MALLOC( size * sizeof(UINT32) ) ) == NULL ) ||
+            ( ( collector->variableMarks = (UINT32*)MALLOC( size * sizeof(UINT32) ) ) == NULL ) ) {
+            return FAILING;
+        }
+    }
+    if( reactionsSize > 0 ) {
+        if( ( collector->reactionMarks = (UINT32*)MALLOC( reactionsSize * sizeof(UINT32) ) ) == NULL ) {
+            return FAILING;
+        }
+    }
+    for( i = 0; i < speciesSize; i++, v++ ) {
+        collector->variableIndices[v] = v;
+        if( IS_FAILED( ( ret = PutInHashTable( (CADDR_T)(speciesArray + i), sizeof(SPECIES*), 
+                                               (CADDR_T)(collector->variableIndices + v), collector->table ) ) ) ) {
+            return ret;
+        }
+    }
+    for( i = 0; i < compartmentsSize; i++, v++ ) {
+        collector->variableIndices[v] = v;
+        if( IS_FAILED( ( ret = PutInHashTable( (CADDR_T)(compartmentArray + i), sizeof(COMPARTMENT*), 
+                                               (CADDR_T)(collector->variableIndices + v), collector->table ) ) ) ) {
+            return ret;
+        }
+    }
+    for( i = 0; i < symbolsSize; i++, v++ ) {
+        collector->variableIndices[v] = v;
+        if( IS_FAILED( ( ret = PutInHashTable( (CADDR_T)(symbolArray + i), sizeof(REB2SAC_SYMBOL*), 
+                                               (CADDR_T)(collector->variableIndices + v), collector->table ) ) ) ) {
+            return ret;
+        }
+    }
+    return ret;
+}
+
+static void _FreeCollector( DEPENDENCY_COLLECTOR *collector ) {
+    if( collector->table != NULL ) {
+        DeleteHashTable( &(collector->table) );
+    }
+    FREE( collector->variableIndices );
+    FREE( collector->variableMarks );
+    FREE( collector->reactionMarks );
+    FREE( collector->items );
+}
+
+static void _StartCollecting( DEPENDENCY_COLLECTOR *collector ) {
+    collector->mark++;
+    collector->itemsSize = 0;
+}
+
+static RET_VAL _AddItem( DEPENDENCY_COLLECTOR *collector, UINT32 item ) {
+    UINT32 capacity = 0;
+    UINT32 *items = NULL;
+
+    if( collector->itemsSize == collector->itemsCapacity ) {
+        capacity = ( collector->itemsCapacity == 0 ) ? 16 : 2 * collector->itemsCapacity;
+        if( ( items = (UINT32*)REALLOC( collector->items, capacity * sizeof(UINT32) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_AddItem", "could not grow the dependency buffer" );
+        }
+        collector->items = items;
+        collector->itemsCapacity = capacity;
+    }
+    collector->items[collector->itemsSize++] = item;
+    return SUCCESS;
+}
+
+/* nodes that are not in the arrays, such as local parameters, are constant and ignored */
+static RET_VAL _AddVariable( DEPENDENCY_COLLECTOR *collector, CADDR_T node ) {
+    UINT32 *index = NULL;
+
+    if( node == NULL ) {
+        return SUCCESS;
+    }
+    if( ( index = (UINT32*)GetValueFromHashTable( (CADDR_T)&node, sizeof(node), collector->table ) ) == NULL ) {
+        return SUCCESS;
+    }
+    if( collector->variableMarks[*index] == collector->mark ) {
+        return SUCCESS;
+    }
+    collector->variableMarks[*index] = collector->mark;
+    return _AddItem( collector, *index );
+}
+
+/* a species read as a concentration also depends on the size of its compartment */
+static RET_VAL _AddSpecies( DEPENDENCY_COLLECTOR *collector, SPECIES *species ) {
+    RET_VAL ret = SUCCESS;
+
+    if( IS_FAILED( ( ret = _AddVariable( collector, (CADDR_T)species ) ) ) ) {
+        return ret;
+    }
+    if( !HasOnlySubstanceUnitsInSpeciesNode( species ) ) {
+        ret = _AddVariable( collector, (CADDR_T)GetCompartmentInSpeciesNode( species ) );
+    }
+    return ret;
+}
+
+static RET_VAL _AddReaction( DEPENDENCY_COLLECTOR *collector, UINT32 reactionIndex ) {
+    if( collector->reactionMarks[reactionIndex] == collector->mark ) {
+        return SUCCESS;
+    }
+    collector->reactionMarks[reactionIndex] = collector->mark;
+    return _AddItem( collector, reactionIndex );
+}
+
+static RET_VAL _CollectKineticLaw( DEPENDENCY_COLLECTOR *collector, KINETIC_LAW *law ) {
+    KINETIC_LAW_VISITOR visitor;
+
+    if( law == NULL ) {
+        return SUCCESS;
+    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor._internal1 = (CADDR_T)collector;
+    visitor.VisitPW = _VisitPWToCollect;
+    visitor.VisitOp = _VisitOpToCollect;
+    visitor.VisitUnaryOp = _VisitUnaryOpToCollect;
+    visitor.VisitInt = _VisitConstantToCollect;
+    visitor.VisitReal = _VisitConstantToCollect;
+    visitor.VisitCompartment = _VisitCompartmentToCollect;
+    visitor.VisitSpecies = _VisitSpeciesToCollect;
+    visitor.VisitSymbol = _VisitSymbolToCollect;
+    visitor.VisitFunctionSymbol = _VisitConstantToCollect;
+
+    return law->Accept( law, &visitor );
+}
+
+/* 
+ * A propensity reads its kinetic law, and the amounts and stoichiometries of its reactants 
+ * and modifiers.  
+ */
+static RET_VAL _CollectReaction( DEPENDENCY_COLLECTOR *collector, REACTION *reaction ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 k = 0;
+    SPECIES *species = NULL;
+    IR_EDGE *edge = NULL;
+    LINKED_LIST *edges = NULL;
+
+    if( IS_FAILED( ( ret = _CollectKineticLaw( collector, GetKineticLawInReactionNode( reaction ) ) ) ) ) {
+        return ret;
+    }
+    for( k = 0; k < 2; k++ ) {
+        edges = ( k == 0 ) ? GetReactantEdges( (IR_NODE*)reaction ) : GetModifierEdges( (IR_NODE*)reaction );
+        ResetCurrentElement( edges );
+        while( ( edge = GetNextEdge( edges ) ) != NULL ) {
+            species = GetSpeciesInIREdge( edge );
+            if( IS_FAILED( ( ret = _AddVariable( collector, (CADDR_T)species ) ) ) ) {
+                return ret;
+            }
+            if( IS_FAILED( ( ret = _AddVariable( collector, (CADDR_T)GetSpeciesRefInIREdge( edge ) ) ) ) ) {
+                return ret;
+            }
+            if( IS_FAILED( ( ret = _AddVariable( collector, (CADDR_T)GetConversionFactorInSpeciesNode( species ) ) ) ) ) {
+                return ret;
+            }
+        }
+    }
+    return ret;
+}
+
+
+static RET_VAL _InitRows( DEPENDENCY_ROWS *rows, UINT32 rowsSize ) {
+    memset( rows, 0, sizeof(DEPENDENCY_ROWS) );
+    rows->rowsSize = rowsSize;
+    if( ( rows->offsets = (UINT32*)MALLOC( ( rowsSize + 1 ) * sizeof(UINT32) ) ) == NULL ) {
+        return FAILING;
+    }
+    return SUCCESS;
+}
+
+static void _FreeRows( DEPENDENCY_ROWS *rows ) {
+    FREE( rows->offsets );
+    FREE( rows->entries );
+}
+
+/* rows must be appended in order */
+static RET_VAL _AppendRow( DEPENDENCY_ROWS *rows, UINT32 row, UINT32 *items, UINT32 itemsSize ) {
+    UINT32 capacity = 0;
+    UINT32 *entries = NULL;
+
+    if( rows->entriesSize + itemsSize > rows->entriesCapacity ) {
+        capacity = GET_MAX( 2 * rows->entriesCapacity, rows->entriesSize + itemsSize );
+        if( ( entries = (UINT32*)REALLOC( rows->entries, capacity * sizeof(UINT32) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_AppendRow", "could not grow dependency rows" );
+        }
+        rows->entries = entries;
+        rows->entriesCapacity = capacity;
+    }
+    if( itemsSize > 0 ) {
+        memcpy( rows->entries + rows->entriesSize, items, itemsSize * sizeof(UINT32) );
+    }
+    rows->offsets[row] = rows->entriesSize;
+    rows->entriesSize += itemsSize;
+    rows->offsets[row+1] = rows->entriesSize;
+    return SUCCESS;
+}
+
+static RET_VAL _InvertRows( DEPENDENCY_ROWS *rows, UINT32 columnsSize, DEPENDENCY_ROWS *inverted ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 j = 0;
+    UINT32 column = 0;
+    UINT32 *next = NULL;
+
+    if( IS_FAILED( ( ret = _InitRows( inverted, columnsSize ) ) ) ) {
+        return ret;
+    }
+    if( rows->entriesSize > 0 ) {
+        if( ( inverted->entries = (UINT32*)MALLOC( rows->entriesSize * sizeof(UINT32) ) ) == NULL ) {
+            return FAILING;
+        }
+    }
+    inverted->entriesSize = inverted->entriesCapacity = rows->entriesSize;
+    for( j = 0; j < rows->entriesSize; j++ ) {
+        inverted->offsets[rows->entries[j] + 1]++;
+    }
+    for( column = 0; column < columnsSize; column++ ) {
+        inverted->offsets[column + 1] += inverted->offsets[column];
+    }
+    if( columnsSize > 0 ) {
+        if( ( next = (UINT32*)MALLOC( columnsSize * sizeof(UINT32) ) ) == NULL ) {
+            return FAILING;
+        }
+        memcpy( next, inverted->offsets, columnsSize * sizeof(UINT32) );
+    }
+    for( i = 0; i < rows->rowsSize; i++ ) {
+        for( j = rows->offsets[i]; j < rows->offsets[i+1]; j++ ) {
+            column = rows->entries[j];
+            inverted->entries[next[column]++] = i;
+        }
+    }
+    FREE( next );
+    return ret;
+}
+
+
+static RET_VAL _VisitPWToCollect( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw ) {
+    RET_VAL ret = SUCCESS;
+    KINETIC_LAW *child = NULL;
+    LINKED_LIST *children = NULL;
+    UINT num = 0;
+    UINT i = 0;
+
+    children = GetPWChildrenFromKineticLaw( kineticLaw );
+    num = GetLinkedListSize( children );
+    for( i = 0; i < num; i++ ) {
+        child = (KINETIC_LAW*)GetElementByIndex( i, children );
+        if( IS_FAILED( ( ret = child->Accept( child, visitor ) ) ) ) {
+            return ret;
+        }
+    }
+    return ret;
+}
+
+/* the time symbol of a delay is a read as well, since the delayed value moves with time */
+static RET_VAL _VisitOpToCollect( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw ) {
+    RET_VAL ret = SUCCESS;
+    KINETIC_LAW *left = NULL;
+    KINETIC_LAW *right = NULL;
+    DEPENDENCY_COLLECTOR *collector = (DEPENDENCY_COLLECTOR*)(visitor->_internal1);
+
+    left = GetOpLeftFromKineticLaw( kineticLaw );
+    if( IS_FAILED( ( ret = left->Accept( left, visitor ) ) ) ) {
+        return ret;
+    }
+    right = GetOpRightFromKineticLaw( kineticLaw );
+    if( IS_FAILED( ( ret = right->Accept( right, visitor ) ) ) ) {
+        return ret;
+    }
+    return _AddVariable( collector, (CADDR_T)GetTimeFromKineticLaw( kineticLaw ) );
+}
+
+static RET_VAL _VisitUnaryOpToCollect( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw ) {
+    KINETIC_LAW *child = NULL;
+
+    child = GetUnaryOpChildFromKineticLaw( kineticLaw );
+    return child->Accept( child, visitor );
+}
+
+static RET_VAL _VisitConstantToCollect( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw ) {
+    return SUCCESS;
+}
+
+static RET_VAL _VisitCompartmentToCollect( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw ) {
+    DEPENDENCY_COLLECTOR *collector = (DEPENDENCY_COLLECTOR*)(visitor->_internal1);
+
+    return _AddVariable( collector, (CADDR_T)GetCompartmentFromKineticLaw( kineticLaw ) );
+}
+
+static RET_VAL _VisitSpeciesToCollect( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw ) {
+    DEPENDENCY_COLLECTOR *collector = (DEPENDENCY_COLLECTOR*)(visitor->_internal1);
+
+    return _AddSpecies( collector, GetSpeciesFromKineticLaw( kineticLaw ) );
+}
+
+static RET_VAL _VisitSymbolToCollect( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw ) {
+    DEPENDENCY_COLLECTOR *collector = (DEPENDENCY_COLLECTOR*)(visitor->_internal1);
+
+    return _AddVariable( collector, (CADDR_T)GetSymbolFromKineticLaw( kineticLaw ) );
+}
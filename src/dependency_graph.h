@@ -21,39 +21,46 @@
 #define HAVE_DEPENDENCY_GRAPH
 
 #include "common.h"
-#include "linked_list.h"
-#include "reaction_node.h"
+#include "IR.h"
 
 BEGIN_C_NAMESPACE
 
-struct _NEXT_REACTION_DEPENDENCY_GRAPH_NODE;
-typedef struct _NEXT_REACTION_DEPENDENCY_GRAPH_NODE NEXT_REACTION_DEPENDENCY_GRAPH_NODE;
-
-struct _NEXT_REACTION_DEPENDENCY_GRAPH_NODE {
-    REACTION *reaction;
-    LINKED_LIST *affecteeList;        
-};
-
-
-
 struct _NEXT_REACTION_DEPENDENCY_GRAPH;
 typedef struct _NEXT_REACTION_DEPENDENCY_GRAPH NEXT_REACTION_DEPENDENCY_GRAPH;
 
-
+/*
+ * Static dependency graph of a reaction network, stored in compressed sparse row form.
+ * Reactions, species, compartments and symbols are identified by their positions in
+ * the arrays the graph was created from.  Each row lists the reactions whose propensity
+ * must be recomputed when the row's reaction fires or the row's variable is changed,
+ * including reactions that read the variable through chains of assignment rules.
+ */
 struct _NEXT_REACTION_DEPENDENCY_GRAPH {
     REACTION **reactionArray;
     UINT32 reactionsSize;
-    
+    UINT32 speciesSize;
+    UINT32 compartmentsSize;
+    UINT32 symbolsSize;
+    UINT32 *affecteeOffsets;
+    UINT32 *affectees;
+    UINT32 *readerOffsets;
+    UINT32 *readers;
 };
 
 
 DLLSCOPE NEXT_REACTION_DEPENDENCY_GRAPH * STDCALL 
-CreateNextReactionDependencyGraph( REACTION **reactionArray, UINT32 reactionsSize );
+CreateNextReactionDependencyGraph( REACTION **reactionArray, UINT32 reactionsSize, 
+                                   SPECIES **speciesArray, UINT32 speciesSize,
+                                   COMPARTMENT **compartmentArray, UINT32 compartmentsSize,
+                                   REB2SAC_SYMBOL **symbolArray, UINT32 symbolsSize,
+                                   RULE **ruleArray, UINT32 rulesSize );
 
 DLLSCOPE RET_VAL STDCALL FreeNextReactionDependencyGraph( NEXT_REACTION_DEPENDENCY_GRAPH **graph );
 
-
-
+DLLSCOPE UINT32 * STDCALL GetAffectedReactionsInDependencyGraph( NEXT_REACTION_DEPENDENCY_GRAPH *graph, UINT32 reactionIndex, UINT32 *size );
+DLLSCOPE UINT32 * STDCALL GetReactionsDependingOnSpecies( NEXT_REACTION_DEPENDENCY_GRAPH *graph, UINT32 speciesIndex, UINT32 *size );
+DLLSCOPE UINT32 * STDCALL GetReactionsDependingOnCompartment( NEXT_REACTION_DEPENDENCY_GRAPH *graph, UINT32 compartmentIndex, UINT32 *size );
+DLLSCOPE UINT32 * STDCALL GetReactionsDependingOnSymbol( NEXT_REACTION_DEPENDENCY_GRAPH *graph, UINT32 symbolIndex, UINT32 *size );
 
 
 END_C_NAMESPACE
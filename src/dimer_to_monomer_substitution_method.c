@@ -326,20 +326,19 @@ static BOOL _IsDimerizationFormValid( KINETIC_LAW *kineticLaw, SPECIES *monomer,
 
 
 static BOOL _FindMultiplicationOfSpecies( KINETIC_LAW *kineticLaw, SPECIES *species, double *result ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
 #ifdef DEBUG    
     STRING *string = NULL;
 #endif
     
     START_FUNCTION("_FindMultiplicationOfSpecies");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToFindMultiplicationOfSpecies;
-        visitor.VisitInt = _VisitIntToFindMultiplicationOfSpecies;
-        visitor.VisitReal = _VisitRealToFindMultiplicationOfSpecies;
-        visitor.VisitSpecies = _VisitSpeciesToFindMultiplicationOfSpecies;
-        visitor.VisitSymbol = _VisitSymbolToFindMultiplicationOfSpecies;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToFindMultiplicationOfSpecies;
+    visitor.VisitInt = _VisitIntToFindMultiplicationOfSpecies;
+    visitor.VisitReal = _VisitRealToFindMultiplicationOfSpecies;
+    visitor.VisitSpecies = _VisitSpeciesToFindMultiplicationOfSpecies;
+    visitor.VisitSymbol = _VisitSymbolToFindMultiplicationOfSpecies;
     *result = 0.0;
     
     visitor._internal1 = (CADDR_T)species;
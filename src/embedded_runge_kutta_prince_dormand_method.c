@@ -54,7 +54,7 @@ DLLSCOPE RET_VAL STDCALL DoEmbeddedRungeKuttaPrinceDormandSimulation( BACK_END_P
     UINT i = 0;
     UINT runs = 1;
     char *namePrefix = NULL;
-    static EMBEDDED_RUNGE_KUTTA_PRINCE_DORMAND_SIMULATION_RECORD rec;
+    EMBEDDED_RUNGE_KUTTA_PRINCE_DORMAND_SIMULATION_RECORD *rec = NULL;
     UINT timeout = 0;
 
     START_FUNCTION("DoEmbeddedRungeKuttaPrinceDormandSimulation");
@@ -64,28 +64,34 @@ DLLSCOPE RET_VAL STDCALL DoEmbeddedRungeKuttaPrinceDormandSimulation( BACK_END_P
                             "Embedded Runge-Kutta-Prince-Dormand method cannot be applied to the model" );
     }
 
-    if( IS_FAILED( ( ret = _InitializeRecord( &rec, backend, ir ) ) ) )  {
+    if( ( rec = (EMBEDDED_RUNGE_KUTTA_PRINCE_DORMAND_SIMULATION_RECORD*)MALLOC( sizeof(EMBEDDED_RUNGE_KUTTA_PRINCE_DORMAND_SIMULATION_RECORD) ) ) == NULL ) {
+        return ErrorReport( FAILING, "DoEmbeddedRungeKuttaPrinceDormandSimulation", "could not allocate the record" );
+    }
+    if( IS_FAILED( ( ret = _InitializeRecord( rec, backend, ir ) ) ) )  {
+        _CleanRecord( rec );
+        FREE( rec );
+        backend->_internal1 = NULL;
         return ErrorReport( ret, "DoEmbeddedRungeKuttaPrinceDormandSimulation", "initialization of the record failed" );
     }
-    runs = rec.runs;
+    runs = rec->runs;
     for( i = 1; i <= runs; i++ ) {
       timeout = 0;
-      SeedRandomNumberGenerators( rec.seed );
-      rec.seed = GetNextUniformRandomNumber(0,RAND_MAX);
+      SeedRandomNumberGenerators( rec->seed );
+      rec->seed = GetNextUniformRandomNumber(0,RAND_MAX);
       do {
-	SeedRandomNumberGenerators( rec.seed );
-	if( IS_FAILED( ( ret = _InitializeSimulation( &rec, i ) ) ) ) {
+	SeedRandomNumberGenerators( rec->seed );
+	if( IS_FAILED( ( ret = _InitializeSimulation( rec, i ) ) ) ) {
 	  return ErrorReport( ret, "DoEmbeddedRungeKuttaPrinceDormandSimulation", "initialization of the %i-th simulation failed", i );
 	}
 	timeout++;
-      } while ( (ret == CHANGE) && (timeout <= (rec.speciesSize + rec.compartmentsSize + rec.symbolsSize)) );
-      if (timeout > (rec.speciesSize + rec.compartmentsSize + rec.symbolsSize)) {
+      } while ( (ret == CHANGE) && (timeout <= (rec->speciesSize + rec->compartmentsSize + rec->symbolsSize)) );
+      if (timeout > (rec->speciesSize + rec->compartmentsSize + rec->symbolsSize)) {
 	return ErrorReport( ret, "DoEmbeddedRungeKuttaPrinceDormandSimulation", "Cycle detected in initial and rule assignments" );
       }
-      if( IS_FAILED( ( ret = _RunSimulation( &rec ) ) ) ) {
-        return ErrorReport( ret, "DoEmbeddedRungeKuttaPrinceDormandSimulation", "%i-th simulation failed at time %f", i, rec.time );
+      if( IS_FAILED( ( ret = _RunSimulation( rec ) ) ) ) {
+        return ErrorReport( ret, "DoEmbeddedRungeKuttaPrinceDormandSimulation", "%i-th simulation failed at time %f", i, rec->time );
       }
-      if( IS_FAILED( ( ret = _CleanSimulation( &rec ) ) ) ) {
+      if( IS_FAILED( ( ret = _CleanSimulation( rec ) ) ) ) {
         return ErrorReport( ret, "DoEmbeddedRungeKuttaPrinceDormandSimulation", "cleaning of the %i-th simulation failed", i );
       }
       printf("Run = %d\n",i);
@@ -105,6 +111,8 @@ DLLSCOPE RET_VAL STDCALL CloseEmbeddedRungeKuttaPrinceDormandSimulation( BACK_EN
     if( IS_FAILED( ( ret = _CleanRecord( rec ) ) ) )  {
         return ErrorReport( ret, "CloseEmbeddedRungeKuttaPrinceDormandSimulation", "cleaning of the record failed" );
     }
+    FREE( rec );
+    backend->_internal1 = NULL;
 
     END_FUNCTION("CloseEmbeddedRungeKuttaPrinceDormandSimulation",  SUCCESS );
     return ret;
@@ -272,6 +280,7 @@ static RET_VAL _InitializeRecord( EMBEDDED_RUNGE_KUTTA_PRINCE_DORMAND_SIMULATION
     if( ( rec->evaluator = CreateKineticLawEvaluater() ) == NULL ) {
         return ErrorReport( FAILING, "_InitializeRecord", "could not create evaluator" );
     }
+    rec->evaluator->interpolateDelays = TRUE;
 
     if( ( rec->findNextTime = CreateKineticLawFind_Next_Time() ) == NULL ) {
         return ErrorReport( FAILING, "_InitializeRecord", "could not create find next time" );
@@ -718,8 +727,12 @@ static RET_VAL _CleanRecord( EMBEDDED_RUNGE_KUTTA_PRINCE_DORMAND_SIMULATION_RECO
         FREE( rec->concentrations );
     }
 
-    printer->Destroy( printer );
-    decider->Destroy( decider );
+    if( printer != NULL ) {
+        printer->Destroy( printer );
+    }
+    if( decider != NULL ) {
+        decider->Destroy( decider );
+    }
 
     return ret;
 }
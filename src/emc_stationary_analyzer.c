@@ -18,14 +18,28 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <float.h>
 #include "emc_stationary_analyzer.h"
 
 static RET_VAL _Analyze( EMC_STATIONARY_ANALYZER *analyzer, int maxIteration );
 static EMC *_GetResult( EMC_STATIONARY_ANALYZER *analyzer );
 static RET_VAL _SetTolerance( EMC_STATIONARY_ANALYZER *analyzer, double tolerance );
 static double _GetTolerance( EMC_STATIONARY_ANALYZER *analyzer );
-static RET_VAL _ComputeNewDistribution( int stateSize, EMC_STATE *states );
-static BOOL _UpdateDistribution( int jumpCount, int stateSize, EMC_STATE *states, double tolerance ); 
+static RET_VAL _SetMethod( EMC_STATIONARY_ANALYZER *analyzer, int method, double omega );
+static int _GetIterations( EMC_STATIONARY_ANALYZER *analyzer );
+static double *_GetResidualHistory( EMC_STATIONARY_ANALYZER *analyzer, int *size );
+static RET_VAL _BuildMatrix( EMC_STATIONARY_ANALYZER *analyzer );
+static void _Multiply( EMC_STATIONARY_ANALYZER *analyzer, double *x, double *y );
+static double _Normalize( double *x, int size );
+static RET_VAL _RecordResidual( EMC_STATIONARY_ANALYZER *analyzer, double residual );
+static double _FindResidual( EMC_STATIONARY_ANALYZER *analyzer, double *x, double *work );
+static RET_VAL _SolveWithPowerIteration( EMC_STATIONARY_ANALYZER *analyzer, double *x, int maxIteration );
+static RET_VAL _SolveWithSOR( EMC_STATIONARY_ANALYZER *analyzer, double *x, int maxIteration );
+static RET_VAL _FactorizeILU0( int size, int *rowStart, int *columnIndex, int *diagonalIndex, double *lu );
+static void _SolveILU0( int size, int *rowStart, int *columnIndex, int *diagonalIndex, double *lu, double *v, double *z );
+static void _MultiplyNormalized( int size, int *rowStart, int *columnIndex, double *a, double *x, double *y );
+static double _Dot( double *x, double *y, int size );
+static RET_VAL _SolveWithBiCGSTAB( EMC_STATIONARY_ANALYZER *analyzer, double *x, int maxIteration );
 static EMC *_ConvertCTMC2EMC( CTMC *markovChain );
 static RET_VAL _CalculateTransitionProbs( CTMC_STATE *state );
 
@@ -65,10 +79,15 @@ EMC_STATIONARY_ANALYZER *CreateEMCStationaryAnalyzer( CTMC *ctmc ) {
             
     analyzer->markovChain = markovChain;
     analyzer->tolerance = DEFAULT_EMC_STATIONARY_ANALYSIS_TOLERANCE;   
+    analyzer->method = EMC_STATIONARY_METHOD_GAUSS_SEIDEL;
+    analyzer->omega = DEFAULT_EMC_STATIONARY_SOR_OMEGA;
     analyzer->GetResult = _GetResult;
     analyzer->Analyze = _Analyze;    
     analyzer->SetTolerance = _SetTolerance;
     analyzer->GetTolerance = _GetTolerance;
+    analyzer->SetMethod = _SetMethod;
+    analyzer->GetIterations = _GetIterations;
+    analyzer->GetResidualHistory = _GetResidualHistory;
     return analyzer;
 }
 
@@ -84,6 +103,11 @@ RET_VAL FreeEMCStationaryAnalyzer( EMC_STATIONARY_ANALYZER **panalyzer ) {
         FREE( states[i].analysisRecord );
     }
     
+    FREE( analyzer->rowStart );
+    FREE( analyzer->columnIndex );
+    FREE( analyzer->values );
+    FREE( analyzer->diagonalIndex );
+    FREE( analyzer->residualHistory );
     FREE( analyzer );
         
     return SUCCESS;
@@ -101,23 +125,83 @@ static double _GetTolerance( EMC_STATIONARY_ANALYZER *analyzer ) {
 
 
 
+static RET_VAL _SetMethod( EMC_STATIONARY_ANALYZER *analyzer, int method, double omega ) {
+    if( ( method < EMC_STATIONARY_METHOD_POWER ) || ( method > EMC_STATIONARY_METHOD_BICGSTAB ) ) {
+        return ErrorReport( FAILING, "_SetMethod", "unknown stationary method %i", method );
+    }
+    if( !( omega > 0.0 ) || !( omega < 2.0 ) ) {
+        return ErrorReport( FAILING, "_SetMethod", "relaxation factor %g must be in (0, 2)", omega );
+    }
+    analyzer->method = method;
+    analyzer->omega = omega;
+    return SUCCESS;
+}
+
+static int _GetIterations( EMC_STATIONARY_ANALYZER *analyzer ) {
+    return analyzer->iterations;
+}
+
+static double *_GetResidualHistory( EMC_STATIONARY_ANALYZER *analyzer, int *size ) {
+    *size = analyzer->residualHistorySize;
+    return analyzer->residualHistory;
+}
+
+
+
+/*
+ * solves x P = x with sum( x ) = 1, starting from the current probabilities, 
+ * and stops once || x ( P - I ) ||_1 is within the tolerance or after maxIteration iterations.
+ */
 static RET_VAL _Analyze( EMC_STATIONARY_ANALYZER *analyzer, int maxIteration ) {
     RET_VAL ret = SUCCESS;
-    double time = 0.0;
-    double tolerance = analyzer->tolerance;
+    int i = 0;
     EMC *markovChain = analyzer->markovChain;
     EMC_STATE *states = markovChain->states;
     int stateSize = markovChain->stateSize; 
-    int i = 1;
-    BOOL done = FALSE;
+    double *x = NULL;
+    EMC_STATIONARY_ANALYSIS_REC *rec = NULL;
+    
+    if( ( analyzer->rowStart == NULL ) && IS_FAILED( ( ret = _BuildMatrix( analyzer ) ) ) ) {
+        return ret;
+    }
+    if( ( x = (double*)CALLOC( stateSize, sizeof(double) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_Analyze", "failed to allocate memory for the distribution" );
+    }
+    /* 
+     * the power iteration starts from the current distribution as before. the other solvers start 
+     * from the uniform one, since a Gauss-Seidel sweep can wipe out a point mass entirely.
+     */
+    for( i = 0; i < stateSize; i++ ) {
+        rec = (EMC_STATIONARY_ANALYSIS_REC*)(states[i].analysisRecord);
+        x[i] = ( analyzer->method == EMC_STATIONARY_METHOD_POWER ) ? rec->currentProb : 1.0;
+    }
+    _Normalize( x, stateSize );
+    
+    analyzer->iterations = 0;
+    analyzer->residualHistorySize = 0;
+    switch( analyzer->method ) {
+        case EMC_STATIONARY_METHOD_POWER:
+            ret = _SolveWithPowerIteration( analyzer, x, maxIteration );
+        break;
+        
+        case EMC_STATIONARY_METHOD_BICGSTAB:
+            ret = _SolveWithBiCGSTAB( analyzer, x, maxIteration );
+        break;
+        
+        default:
+            ret = _SolveWithSOR( analyzer, x, maxIteration );
+        break;
+    }
     
-    while( ( !done ) || ( i <= maxIteration ) ) {        
-        if( IS_FAILED( ( ret = _ComputeNewDistribution( stateSize, states ) ) ) ) {
-            return ret;
+    if( !IS_FAILED( ret ) ) {
+        for( i = 0; i < stateSize; i++ ) {
+            rec = (EMC_STATIONARY_ANALYSIS_REC*)(states[i].analysisRecord);
+            rec->currentProb = x[i];
         }
-        done = _UpdateDistribution( i, stateSize, states, tolerance ); 
-        i++;
     }
+    FREE( x );
+    
+    return ret;
 }
 
 static EMC *_GetResult( EMC_STATIONARY_ANALYZER *analyzer ) {
@@ -125,67 +209,480 @@ static EMC *_GetResult( EMC_STATIONARY_ANALYZER *analyzer ) {
 }
 
 
-static RET_VAL _ComputeNewDistribution( int stateSize, EMC_STATE *states ) {
+
+/* 
+ * packs P^T - I into compressed rows. sources are visited in increasing order, so 
+ * every row comes out with sorted columns, which the incomplete factorization relies on.
+ */
+static RET_VAL _BuildMatrix( EMC_STATIONARY_ANALYZER *analyzer ) {
     int i = 0;
     int j = 0;
+    int k = 0;
+    int to = 0;
     int transitionSize = 0; 
-    double prob = 0.0;    
-    double fromProb = 0.0;    
-    EMC_STATE *to = NULL;
-    EMC_STATE *from = NULL;
+    int totalSize = 0; 
+    EMC *markovChain = analyzer->markovChain;
+    EMC_STATE *states = markovChain->states;
+    int stateSize = markovChain->stateSize; 
+    int *rowStart = NULL;
+    int *next = NULL;
     VECTOR *transitions = NULL;
     EMC_TRANSITION *transition = NULL;
-    EMC_STATIONARY_ANALYSIS_REC *rec = NULL;
-    EMC_STATIONARY_ANALYSIS_REC *toRec = NULL;
-    EMC_STATIONARY_ANALYSIS_REC *fromRec = NULL;
+    
+    if( ( ( rowStart = (int*)CALLOC( stateSize + 1, sizeof(int) ) ) == NULL ) ||
+        ( ( next = (int*)CALLOC( stateSize, sizeof(int) ) ) == NULL ) ||
+        ( ( analyzer->diagonalIndex = (int*)CALLOC( stateSize, sizeof(int) ) ) == NULL ) ) {
+        FREE( rowStart );
+        FREE( next );
+        return ErrorReport( FAILING, "_BuildMatrix", "failed to allocate memory for %i states", stateSize );
+    }
     
     for( i = 0; i < stateSize; i++ ) {
-        rec = (EMC_STATIONARY_ANALYSIS_REC*)(states[i].analysisRecord);
-        rec->newProb = 0.0;
+        transitions = states[i].transitions;
+        transitionSize = GetVectorSize( transitions );
+        if( transitionSize == 0 ) {
+            FREE( rowStart );
+            FREE( next );
+            return ErrorReport( FAILING, "_BuildMatrix", "state %i is absorbing, so the chain has no unique stationary distribution", i );
+        }
+        rowStart[i + 1]++;
+        for( j = 0; j < transitionSize; j++ ) {
+            transition = (EMC_TRANSITION*)GetElementFromVector( transitions, j );
+            if( ( to = (int)( transition->to - states ) ) != i ) {
+                rowStart[to + 1]++;
+            }
+        }
     }
     for( i = 0; i < stateSize; i++ ) {
-        from = states + i;
-        fromRec = (EMC_STATIONARY_ANALYSIS_REC*)(from->analysisRecord);
-        fromProb = rec->currentProb;
-        transitions = from->transitions;
+        rowStart[i + 1] += rowStart[i];
+        next[i] = rowStart[i];
+    }
+    totalSize = rowStart[stateSize];
+    if( ( ( analyzer->columnIndex = (int*)CALLOC( totalSize, sizeof(int) ) ) == NULL ) ||
+        ( ( analyzer->values = (double*)CALLOC( totalSize, sizeof(double) ) ) == NULL ) ) {
+        FREE( rowStart );
+        FREE( next );
+        return ErrorReport( FAILING, "_BuildMatrix", "failed to allocate memory for %i transitions", totalSize );
+    }
+    
+    for( i = 0; i < stateSize; i++ ) {
+        /* column i reaches row i here, so the diagonal lands in order */
+        k = next[i]++;
+        analyzer->diagonalIndex[i] = k;
+        analyzer->columnIndex[k] = i;
+        analyzer->values[k] = -1.0;
+        transitions = states[i].transitions;
         transitionSize = GetVectorSize( transitions );
         for( j = 0; j < transitionSize; j++ ) {
             transition = (EMC_TRANSITION*)GetElementFromVector( transitions, j );
-            toRec = (EMC_STATIONARY_ANALYSIS_REC*)(transition->to->analysisRecord);            
-            toRec->newProb += (transition->prob * fromProb);
-        }                
+            to = (int)( transition->to - states );
+            if( to == i ) {
+                analyzer->values[analyzer->diagonalIndex[i]] += transition->prob;
+                continue;
+            }
+            k = next[to]++;
+            analyzer->columnIndex[k] = i;
+            analyzer->values[k] = transition->prob;
+        }
+        /* 
+         * a state whose transitions all loop back to itself never leaves either, and its zero 
+         * pivot would stall every solver. the probabilities only sum to 1 up to rounding.
+         */
+        if( fabs( analyzer->values[analyzer->diagonalIndex[i]] ) <= transitionSize * DBL_EPSILON ) {
+            FREE( rowStart );
+            FREE( next );
+            return ErrorReport( FAILING, "_BuildMatrix", "state %i only returns to itself, so it is absorbing and the chain has no unique stationary distribution", i );
+        }
     }
     
+    FREE( next );
+    /* set last, since a non-NULL rowStart marks the matrix as built */
+    analyzer->rowStart = rowStart;
     return SUCCESS;
 }
 
+/* y = ( P^T - I ) x, so || y ||_1 is the residual of a normalized x */
+static void _Multiply( EMC_STATIONARY_ANALYZER *analyzer, double *x, double *y ) {
+    int i = 0;
+    int k = 0;
+    int end = 0;
+    int stateSize = analyzer->markovChain->stateSize; 
+    int *rowStart = analyzer->rowStart;
+    int *columnIndex = analyzer->columnIndex;
+    double sum = 0.0;
+    double *values = analyzer->values;
+    
+    for( i = 0; i < stateSize; i++ ) {
+        sum = 0.0;
+        end = rowStart[i + 1];
+        for( k = rowStart[i]; k < end; k++ ) {
+            sum += values[k] * x[columnIndex[k]];
+        }
+        y[i] = sum;
+    }
+}
+
+static double _Normalize( double *x, int size ) {
+    int i = 0;
+    double norm1 = 0.0;
+    
+    for( i = 0; i < size; i++ ) {
+        norm1 += fabs( x[i] );
+    }
+    if( norm1 > 0.0 ) {
+        for( i = 0; i < size; i++ ) {
+            x[i] /= norm1;
+        }
+    }
+    return norm1;
+}
 
+static RET_VAL _RecordResidual( EMC_STATIONARY_ANALYZER *analyzer, double residual ) {
+    int capacity = analyzer->residualHistoryCapacity;
+    double *history = NULL;
+    
+    if( analyzer->residualHistorySize == capacity ) {
+        capacity = ( capacity == 0 ) ? 64 : 2 * capacity;
+        if( ( history = (double*)REALLOC( analyzer->residualHistory, capacity * sizeof(double) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_RecordResidual", "failed to allocate memory for the residual history" );
+        }
+        analyzer->residualHistory = history;
+        analyzer->residualHistoryCapacity = capacity;
+    }
+    analyzer->residualHistory[analyzer->residualHistorySize] = residual;
+    analyzer->residualHistorySize++;
+    analyzer->iterations++;
+    TRACE_2( "stationary iteration %i residual %g", analyzer->iterations, residual );
+    
+    return SUCCESS;
+}
 
-static BOOL _UpdateDistribution( int jumpCount, int stateSize, EMC_STATE *states, double tolerance ) {
+static double _FindResidual( EMC_STATIONARY_ANALYZER *analyzer, double *x, double *work ) {
     int i = 0;
-    BOOL canDone = TRUE;
-    EMC_STATIONARY_ANALYSIS_REC *rec = NULL;
+    int stateSize = analyzer->markovChain->stateSize; 
+    double residual = 0.0;
+    
+    _Multiply( analyzer, x, work );
+    for( i = 0; i < stateSize; i++ ) {
+        residual += fabs( work[i] );
+    }
+    return residual;
+}
 
-    /* check the end condition only for the even jump count */
-    if( ( jumpCount & 0x01 ) == 0x00 ) {
+/* 
+ * power iteration on the lazy chain ( I + P ) / 2, which has the same stationary 
+ * distribution but does not oscillate when P is periodic, as birth-death EMCs are.
+ */
+static RET_VAL _SolveWithPowerIteration( EMC_STATIONARY_ANALYZER *analyzer, double *x, int maxIteration ) {
+    RET_VAL ret = SUCCESS;
+    int i = 0;
+    int iteration = 0;
+    int stateSize = analyzer->markovChain->stateSize; 
+    double residual = 0.0;
+    double *work = NULL;
+    
+    if( ( work = (double*)CALLOC( stateSize, sizeof(double) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_SolveWithPowerIteration", "failed to allocate memory" );
+    }
+    for( iteration = 0; iteration < maxIteration; iteration++ ) {
+        residual = _FindResidual( analyzer, x, work );
+        if( IS_FAILED( ( ret = _RecordResidual( analyzer, residual ) ) ) ) {
+            break;
+        }
+        if( residual <= analyzer->tolerance ) {
+            break;
+        }
         for( i = 0; i < stateSize; i++ ) {
-            rec = (EMC_STATIONARY_ANALYSIS_REC*)(states[i].analysisRecord);
-            if( canDone ) {
-                if( fabs( rec->currentProb - rec->newProb ) >= tolerance ) {
-                    canDone = FALSE;
+            x[i] += 0.5 * work[i];
+        }
+        _Normalize( x, stateSize );
+    }
+    
+    FREE( work );
+    return ret;
+}
+
+/* 
+ * forward sweeps solving row j of ( P^T - I ) x = 0 for x_j with the newest values, 
+ * over-relaxed by omega. omega = 1 is plain Gauss-Seidel.
+ */
+static RET_VAL _SolveWithSOR( EMC_STATIONARY_ANALYZER *analyzer, double *x, int maxIteration ) {
+    RET_VAL ret = SUCCESS;
+    int i = 0;
+    int k = 0;
+    int end = 0;
+    int iteration = 0;
+    int diagonal = 0;
+    int stateSize = analyzer->markovChain->stateSize; 
+    int *rowStart = analyzer->rowStart;
+    int *columnIndex = analyzer->columnIndex;
+    int *diagonalIndex = analyzer->diagonalIndex;
+    double sum = 0.0;
+    double residual = 0.0;
+    double omega = ( analyzer->method == EMC_STATIONARY_METHOD_SOR ) ? analyzer->omega : 1.0;
+    double *values = analyzer->values;
+    double *work = NULL;
+    
+    if( ( work = (double*)CALLOC( stateSize, sizeof(double) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_SolveWithSOR", "failed to allocate memory" );
+    }
+    for( iteration = 0; iteration < maxIteration; iteration++ ) {
+        for( i = 0; i < stateSize; i++ ) {
+            sum = 0.0;
+            diagonal = diagonalIndex[i];
+            end = rowStart[i + 1];
+            for( k = rowStart[i]; k < end; k++ ) {
+                if( k != diagonal ) {
+                    sum += values[k] * x[columnIndex[k]];
                 }
             }
-            rec->currentProb = rec->newProb;
+            /* over-relaxation can overshoot below zero, which is never a probability */
+            x[i] = GET_MAX( 0.0, ( 1.0 - omega ) * x[i] - omega * sum / values[diagonal] );
+        }
+        if( !( _Normalize( x, stateSize ) > 0.0 ) ) {
+            ret = ErrorReport( FAILING, "_SolveWithSOR", "the iterate vanished after %i sweeps", iteration + 1 );
+            break;
+        }
+        
+        residual = _FindResidual( analyzer, x, work );
+        if( IS_FAILED( ( ret = _RecordResidual( analyzer, residual ) ) ) ) {
+            break;
+        }
+        if( residual <= analyzer->tolerance ) {
+            break;
         }
-        return canDone;
     }
-    else {
-        for( i = 0; i < stateSize; i++ ) {
-            rec = (EMC_STATIONARY_ANALYSIS_REC*)(states[i].analysisRecord);
-            rec->currentProb = rec->newProb;
+    
+    FREE( work );
+    return ret;
+}
+
+/* 
+ * ILU(0) of the system matrix, which is P^T - I with its last row replaced by ones. 
+ * the factors share the sparsity of the matrix; L has a unit diagonal that is not stored.
+ */
+static RET_VAL _FactorizeILU0( int size, int *rowStart, int *columnIndex, int *diagonalIndex, double *lu ) {
+    int i = 0;
+    int j = 0;
+    int k = 0;
+    int kk = 0;
+    int column = 0;
+    int *position = NULL;
+    double factor = 0.0;
+    
+    if( ( position = (int*)MALLOC( size * sizeof(int) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_FactorizeILU0", "failed to allocate memory" );
+    }
+    for( i = 0; i < size; i++ ) {
+        position[i] = -1;
+    }
+    for( i = 0; i < size; i++ ) {
+        for( k = rowStart[i]; k < rowStart[i + 1]; k++ ) {
+            position[columnIndex[k]] = k;
+        }
+        for( k = rowStart[i]; ( k < rowStart[i + 1] ) && ( ( column = columnIndex[k] ) < i ); k++ ) {
+            factor = lu[k] / lu[diagonalIndex[column]];
+            lu[k] = factor;
+            for( kk = diagonalIndex[column] + 1; kk < rowStart[column + 1]; kk++ ) {
+                if( ( j = position[columnIndex[kk]] ) >= 0 ) {
+                    lu[j] -= factor * lu[kk];
+                }
+            }
+        }
+        if( fabs( lu[diagonalIndex[i]] ) < DBL_EPSILON ) {
+            /* a zero pivot only weakens the preconditioner */
+            lu[diagonalIndex[i]] = ( lu[diagonalIndex[i]] < 0.0 ) ? -DBL_EPSILON : DBL_EPSILON;
+        }
+        for( k = rowStart[i]; k < rowStart[i + 1]; k++ ) {
+            position[columnIndex[k]] = -1;
+        }
+    }
+    
+    FREE( position );
+    return SUCCESS;
+}
+
+/* z = ( L U )^-1 v */
+static void _SolveILU0( int size, int *rowStart, int *columnIndex, int *diagonalIndex, double *lu, double *v, double *z ) {
+    int i = 0;
+    int k = 0;
+    double sum = 0.0;
+    
+    for( i = 0; i < size; i++ ) {
+        sum = v[i];
+        for( k = rowStart[i]; k < diagonalIndex[i]; k++ ) {
+            sum -= lu[k] * z[columnIndex[k]];
+        }
+        z[i] = sum;
+    }
+    for( i = size - 1; i >= 0; i-- ) {
+        sum = z[i];
+        for( k = diagonalIndex[i] + 1; k < rowStart[i + 1]; k++ ) {
+            sum -= lu[k] * z[columnIndex[k]];
+        }
+        z[i] = sum / lu[diagonalIndex[i]];
+    }
+}
+
+/* y = A x, where A is P^T - I with its last row replaced by ones */
+static void _MultiplyNormalized( int size, int *rowStart, int *columnIndex, double *a, double *x, double *y ) {
+    int i = 0;
+    int k = 0;
+    double sum = 0.0;
+    
+    for( i = 0; i < size; i++ ) {
+        sum = 0.0;
+        for( k = rowStart[i]; k < rowStart[i + 1]; k++ ) {
+            sum += a[k] * x[columnIndex[k]];
+        }
+        y[i] = sum;
+    }
+}
+
+static double _Dot( double *x, double *y, int size ) {
+    int i = 0;
+    double sum = 0.0;
+    
+    for( i = 0; i < size; i++ ) {
+        sum += x[i] * y[i];
+    }
+    return sum;
+}
+
+/* 
+ * ILU(0)-preconditioned BiCGSTAB on the nonsingular system obtained by replacing the 
+ * balance equation of the last state with the normalization sum( x ) = 1.
+ */
+static RET_VAL _SolveWithBiCGSTAB( EMC_STATIONARY_ANALYZER *analyzer, double *x, int maxIteration ) {
+    RET_VAL ret = SUCCESS;
+    int i = 0;
+    int k = 0;
+    int iteration = 0;
+    int n = analyzer->markovChain->stateSize; 
+    int last = n - 1;
+    int totalSize = 0;
+    int *rowStart = NULL;
+    int *columnIndex = NULL;
+    int *diagonalIndex = NULL;
+    double rho = 1.0;
+    double rhoNew = 0.0;
+    double alpha = 1.0;
+    double omega = 1.0;
+    double beta = 0.0;
+    double tt = 0.0;
+    double residual = 0.0;
+    double *a = NULL;
+    double *lu = NULL;
+    double *buffer = NULL;
+    double *r = NULL;
+    double *rHat = NULL;
+    double *p = NULL;
+    double *pHat = NULL;
+    double *v = NULL;
+    double *s = NULL;
+    double *sHat = NULL;
+    double *t = NULL;
+    double *work = NULL;
+    
+    /* the system matrix: rows 0..n-2 as in P^T - I, then a dense row of ones */
+    totalSize = analyzer->rowStart[last] + n;
+    if( ( ( rowStart = (int*)CALLOC( n + 1, sizeof(int) ) ) == NULL ) ||
+        ( ( columnIndex = (int*)CALLOC( totalSize, sizeof(int) ) ) == NULL ) ||
+        ( ( diagonalIndex = (int*)CALLOC( n, sizeof(int) ) ) == NULL ) ||
+        ( ( a = (double*)CALLOC( totalSize, sizeof(double) ) ) == NULL ) ||
+        ( ( lu = (double*)CALLOC( totalSize, sizeof(double) ) ) == NULL ) ||
+        ( ( buffer = (double*)CALLOC( 9 * (long)n, sizeof(double) ) ) == NULL ) ) {
+        ret = ErrorReport( FAILING, "_SolveWithBiCGSTAB", "failed to allocate memory" );
+        goto FREE_ARRAYS;
+    }
+    memcpy( rowStart, analyzer->rowStart, n * sizeof(int) );
+    memcpy( columnIndex, analyzer->columnIndex, analyzer->rowStart[last] * sizeof(int) );
+    memcpy( a, analyzer->values, analyzer->rowStart[last] * sizeof(double) );
+    memcpy( diagonalIndex, analyzer->diagonalIndex, last * sizeof(int) );
+    for( i = 0, k = rowStart[last]; i < n; i++, k++ ) {
+        columnIndex[k] = i;
+        a[k] = 1.0;
+    }
+    rowStart[n] = totalSize;
+    diagonalIndex[last] = totalSize - 1;
+    memcpy( lu, a, totalSize * sizeof(double) );
+    if( IS_FAILED( ( ret = _FactorizeILU0( n, rowStart, columnIndex, diagonalIndex, lu ) ) ) ) {
+        goto FREE_ARRAYS;
+    }
+    
+    r = buffer;
+    rHat = r + n;
+    p = rHat + n;
+    pHat = p + n;
+    v = pHat + n;
+    s = v + n;
+    sHat = s + n;
+    t = sHat + n;
+    work = t + n;
+    
+    /* r = e_last - A x */
+    _MultiplyNormalized( n, rowStart, columnIndex, a, x, r );
+    for( i = 0; i < n; i++ ) {
+        r[i] = -r[i];
+    }
+    r[last] += 1.0;
+    memcpy( rHat, r, n * sizeof(double) );
+    
+    for( iteration = 0; iteration < maxIteration; iteration++ ) {
+        residual = _FindResidual( analyzer, x, work );
+        if( IS_FAILED( ( ret = _RecordResidual( analyzer, residual ) ) ) ) {
+            goto FREE_ARRAYS;
+        }
+        if( residual <= analyzer->tolerance ) {
+            break;
+        }
+        
+        if( ( rhoNew = _Dot( rHat, r, n ) ) == 0.0 ) {
+            TRACE_0( "BiCGSTAB broke down" );
+            break;
+        }
+        beta = ( rhoNew / rho ) * ( alpha / omega );
+        for( i = 0; i < n; i++ ) {
+            p[i] = r[i] + beta * ( p[i] - omega * v[i] );
+        }
+        _SolveILU0( n, rowStart, columnIndex, diagonalIndex, lu, p, pHat );
+        _MultiplyNormalized( n, rowStart, columnIndex, a, pHat, v );
+        alpha = rhoNew / _Dot( rHat, v, n );
+        for( i = 0; i < n; i++ ) {
+            s[i] = r[i] - alpha * v[i];
+        }
+        _SolveILU0( n, rowStart, columnIndex, diagonalIndex, lu, s, sHat );
+        _MultiplyNormalized( n, rowStart, columnIndex, a, sHat, t );
+        tt = _Dot( t, t, n );
+        omega = ( tt > 0.0 ) ? _Dot( t, s, n ) / tt : 0.0;
+        for( i = 0; i < n; i++ ) {
+            x[i] += alpha * pHat[i] + omega * sHat[i];
+            r[i] = s[i] - omega * t[i];
+        }
+        rho = rhoNew;
+        if( omega == 0.0 ) {
+            TRACE_0( "BiCGSTAB stagnated" );
+            break;
         }
-        return FALSE;
     }
+    
+    /* round-off can leave tiny negative probabilities */
+    for( i = 0; i < n; i++ ) {
+        if( x[i] < 0.0 ) {
+            x[i] = 0.0;
+        }
+    }
+    _Normalize( x, n );
+    
+FREE_ARRAYS:
+    FREE( rowStart );
+    FREE( columnIndex );
+    FREE( diagonalIndex );
+    FREE( a );
+    FREE( lu );
+    FREE( buffer );
+    
+    return ret;
 }
 
 
@@ -26,7 +26,14 @@
 
 BEGIN_C_NAMESPACE
 
-#define DEFAULT_EMC_STATIONARY_ANALYSIS_TOLERANCE 0.0001
+/* bound on || x ( P - I ) ||_1 for a normalized distribution x */
+#define DEFAULT_EMC_STATIONARY_ANALYSIS_TOLERANCE 1.0e-10
+#define DEFAULT_EMC_STATIONARY_SOR_OMEGA 1.2
+
+#define EMC_STATIONARY_METHOD_POWER 0
+#define EMC_STATIONARY_METHOD_GAUSS_SEIDEL 1
+#define EMC_STATIONARY_METHOD_SOR 2
+#define EMC_STATIONARY_METHOD_BICGSTAB 3
 
 typedef struct {
     double currentProb;
@@ -39,8 +46,22 @@ typedef struct _EMC_STATIONARY_ANALYZER EMC_STATIONARY_ANALYZER;
 struct _EMC_STATIONARY_ANALYZER {
     EMC *markovChain;
     double tolerance;
+    int method;
+    double omega;
+    /* P^T - I in compressed rows: row j holds the transitions into state j */
+    int *rowStart;
+    int *columnIndex;
+    double *values;
+    int *diagonalIndex;
+    int iterations;
+    int residualHistorySize;
+    int residualHistoryCapacity;
+    double *residualHistory;
     RET_VAL (*SetTolerance)( EMC_STATIONARY_ANALYZER *analyzer, double tolerance );
     double (*GetTolerance)( EMC_STATIONARY_ANALYZER *analyzer );
+    RET_VAL (*SetMethod)( EMC_STATIONARY_ANALYZER *analyzer, int method, double omega );
+    int (*GetIterations)( EMC_STATIONARY_ANALYZER *analyzer );
+    double *(*GetResidualHistory)( EMC_STATIONARY_ANALYZER *analyzer, int *size );
     RET_VAL (*Analyze)( EMC_STATIONARY_ANALYZER *analyzer, int maxIteration );
     EMC *(*GetResult)( EMC_STATIONARY_ANALYZER *analyzer );
 };
@@ -55,7 +55,7 @@ DLLSCOPE RET_VAL STDCALL DoEulerSimulation( BACK_END_PROCESSOR *backend, IR *ir
     UINT i = 0;
     UINT runs = 1;
     char *namePrefix = NULL;
-    static EULER_SIMULATION_RECORD rec;
+    EULER_SIMULATION_RECORD *rec = NULL;
     UINT timeout = 0;
 
     START_FUNCTION("DoEulerSimulation");
@@ -63,28 +63,34 @@ DLLSCOPE RET_VAL STDCALL DoEulerSimulation( BACK_END_PROCESSOR *backend, IR *ir
         return ErrorReport( FAILING, "DoEulerSimulation", "euler method cannot be applied to the model" );
     }
 
-    if( IS_FAILED( ( ret = _InitializeRecord( &rec, backend, ir ) ) ) )  {
+    if( ( rec = (EULER_SIMULATION_RECORD*)MALLOC( sizeof(EULER_SIMULATION_RECORD) ) ) == NULL ) {
+        return ErrorReport( FAILING, "DoEulerSimulation", "could not allocate the record" );
+    }
+    if( IS_FAILED( ( ret = _InitializeRecord( rec, backend, ir ) ) ) )  {
+        _CleanRecord( rec );
+        FREE( rec );
+        backend->_internal1 = NULL;
         return ErrorReport( ret, "DoEulerSimulation", "initialization of the record failed" );
     }
-    runs = rec.runs;
+    runs = rec->runs;
     for( i = 1; i <= runs; i++ ) {
       timeout = 0;
-      SeedRandomNumberGenerators( rec.seed );
-      rec.seed = GetNextUniformRandomNumber(0,RAND_MAX);
+      SeedRandomNumberGenerators( rec->seed );
+      rec->seed = GetNextUniformRandomNumber(0,RAND_MAX);
       do {
-	SeedRandomNumberGenerators( rec.seed );
-	if( IS_FAILED( ( ret = _InitializeSimulation( &rec, i ) ) ) ) {
+	SeedRandomNumberGenerators( rec->seed );
+	if( IS_FAILED( ( ret = _InitializeSimulation( rec, i ) ) ) ) {
 	  return ErrorReport( ret, "DoEulerSimulation", "initialization of the %i-th simulation failed", i );
 	}
 	timeout++;
-      } while ( (ret == CHANGE) && (timeout <= (rec.speciesSize + rec.compartmentsSize + rec.symbolsSize)) );
-      if (timeout > (rec.speciesSize + rec.compartmentsSize + rec.symbolsSize + 1)) {
+      } while ( (ret == CHANGE) && (timeout <= (rec->speciesSize + rec->compartmentsSize + rec->symbolsSize)) );
+      if (timeout > (rec->speciesSize + rec->compartmentsSize + rec->symbolsSize + 1)) {
 	return ErrorReport( ret, "DoEulerSimulation", "Cycle detected in initial and rule assignments" );
       }
-      if( IS_FAILED( ( ret = _RunSimulation( &rec ) ) ) ) {
-        return ErrorReport( ret, "DoEulerSimulation", "%i-th simulation failed at time %f", i, rec.time );
+      if( IS_FAILED( ( ret = _RunSimulation( rec ) ) ) ) {
+        return ErrorReport( ret, "DoEulerSimulation", "%i-th simulation failed at time %f", i, rec->time );
       }
-      if( IS_FAILED( ( ret = _CleanSimulation( &rec ) ) ) ) {
+      if( IS_FAILED( ( ret = _CleanSimulation( rec ) ) ) ) {
         return ErrorReport( ret, "DoEulerSimulation", "cleaning of the %i-th simulation failed", i );
       }
       printf("Run = %d\n",i);
@@ -104,6 +110,8 @@ DLLSCOPE RET_VAL STDCALL CloseEulerSimulation( BACK_END_PROCESSOR *backend ) {
     if( IS_FAILED( ( ret = _CleanRecord( rec ) ) ) )  {
         return ErrorReport( ret, "CloseEulerSimulation", "cleaning of the record failed" );
     }
+    FREE( rec );
+    backend->_internal1 = NULL;
 
     END_FUNCTION("CloseEulerSimulation",  SUCCESS );
     return ret;
@@ -323,6 +331,7 @@ static RET_VAL _InitializeRecord( EULER_SIMULATION_RECORD *rec, BACK_END_PROCESS
     if( ( rec->evaluator = CreateKineticLawEvaluater() ) == NULL ) {
         return ErrorReport( FAILING, "_InitializeRecord", "could not create evaluator" );
     }
+    rec->evaluator->interpolateDelays = TRUE;
 
     if( ( rec->findNextTime = CreateKineticLawFind_Next_Time() ) == NULL ) {
         return ErrorReport( FAILING, "_InitializeRecord", "could not create find next time" );
@@ -748,8 +757,12 @@ static RET_VAL _CleanRecord( EULER_SIMULATION_RECORD *rec ) {
         FREE( rec->speciesArray );
     }
 
-    printer->Destroy( printer );
-    decider->Destroy( decider );
+    if( printer != NULL ) {
+        printer->Destroy( printer );
+    }
+    if( decider != NULL ) {
+        decider->Destroy( decider );
+    }
 
     return ret;
 }
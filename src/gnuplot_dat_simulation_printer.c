@@ -68,13 +68,11 @@ static RET_VAL _PrintStart( SIMULATION_PRINTER *printer, char *filenameStem ) {
     FILE *out = NULL;
     
     sprintf( filename, "%s.dat", filenameStem );
-    if( ( out = fopen( filename, "w" ) ) == NULL ) {
+    if( ( out = OpenSimulationPrinterFile( printer, filename, "w" ) ) == NULL ) {
         TRACE_1( "could not open %s", filename );
         return FAILING;
     }
     
-    printer->out = out;    
-    
     return ret;            
 }
 
@@ -181,15 +179,16 @@ static RET_VAL _PrintConcentrationValues( SIMULATION_PRINTER *printer, double ti
 
 static RET_VAL _PrintEnd( SIMULATION_PRINTER *printer ) {
     RET_VAL ret = SUCCESS;    
-    FILE *out = printer->out;
     
-    fflush( out );
-    fclose( out );
+    ret = CloseSimulationPrinterFile( printer );
     
     return ret;            
 }
 
 static RET_VAL _Destroy( SIMULATION_PRINTER *printer ) {
+    if( printer->buffer != NULL ) {
+        FREE( printer->buffer );
+    }
     FREE( printer );
     return SUCCESS;
 }
@@ -12,15 +12,29 @@
 
 #include "hash_table.h"
 
+#define HASH_TABLE_MIN_CAPACITY 8
+
+typedef struct {
+	UINT32 bucket;
+	UINT32 order;
+	HASH_ENTRY *entry;
+} HASH_ORDER_ELEMENT;
 
 UINT32 ComputeBucketIndex( CADDR_T key, UINT32 key_size, UINT32 bucket_size );
 
+static UINT32 _ComputeHash( CADDR_T key, UINT32 key_size );
+static HASH_ENTRY *_FindEntry( CADDR_T key, UINT32 key_size, UINT32 hash, HASH_TABLE *table );
+static void _PlaceEntry( HASH_ENTRY *entry, HASH_TABLE *table );
+static RET_VAL _Resize( HASH_TABLE *table, UINT32 capacity );
+static LINKED_LIST *_GenerateOrderedList( HASH_TABLE *table, BOOL keys );
+static int _CompareOrderElements( const void *a, const void *b );
+
 
 
 
 HASH_TABLE *CreateHashTable( UINT32 bucket_size )
 {
-	UINT32 i = 0;
+	UINT32 capacity = HASH_TABLE_MIN_CAPACITY;
 	HASH_TABLE *table = NULL;
 
 	START_FUNCTION("CreateHashTable");
@@ -36,21 +50,17 @@ HASH_TABLE *CreateHashTable( UINT32 bucket_size )
 		return NULL;
 	}
 
-	table->buckets = (LINKED_LIST**)CALLOC( bucket_size, sizeof(LINKED_LIST*) );
-	if( table->buckets == NULL ) {
+	while( capacity < bucket_size ) {
+		capacity <<= 1;
+	}
+	table->entries = (HASH_ENTRY*)CALLOC( capacity, sizeof(HASH_ENTRY) );
+	if( table->entries == NULL ) {
+		DeleteHashTable( &table );
 		END_FUNCTION("CreateHashTable", FAILING );
 		return NULL;
 	}
-
-	for( i = 0; i < bucket_size; i++ ) {
-		table->buckets[i] = CreateLinkedList();
-		if( table->buckets[i] == NULL ) {
-			DeleteHashTable( &table );
-			END_FUNCTION("CreateHashTable", FAILING );
-			return NULL;
-		}
-	}
 	
+	table->capacity = capacity;
 	table->bucket_size = bucket_size;
 
 	END_FUNCTION( "CreateHashTable", SUCCESS );
@@ -61,42 +71,34 @@ HASH_TABLE *CreateHashTable( UINT32 bucket_size )
 RET_VAL PutInHashTable( CADDR_T key, UINT32 key_size, CADDR_T value, HASH_TABLE *table )
 {
 	RET_VAL ret = SUCCESS;
-	UINT32 bucket_index = 0;
-	LINKED_LIST *list = NULL;
-	HASH_ENTRY *entry = NULL;
+	UINT32 hash = 0;
+	HASH_ENTRY entry;
 	HASH_ENTRY *target = NULL;
 
 
 	START_FUNCTION("PutInHashTable");
 
-	bucket_index = ComputeBucketIndex( key, key_size, table->bucket_size );
-	list = table->buckets[bucket_index];
-
-	ResetCurrentElement( list );
-	while( (target = (HASH_ENTRY*)GetNextFromLinkedList(list)) != NULL ) {
-		if( key_size == target->key_size ) {
-			if( memcmp( key, target->key, key_size ) == 0 ) {
-				/*same key is found*/
-				target->value = value;
-				END_FUNCTION( "PutInHashTable", ret );
-				return ret;
-			}
-		}
+	hash = _ComputeHash( key, key_size );
+	if( (target = _FindEntry( key, key_size, hash, table )) != NULL ) {
+		/*same key is found*/
+		target->value = value;
+		END_FUNCTION( "PutInHashTable", ret );
+		return ret;
 	}
 
 	/*same key not found*/
-	entry = (HASH_ENTRY*)MALLOC( sizeof(HASH_ENTRY) );
-	if( entry == NULL ) {
-		return ErrorReport( FAILING, "PutInHashTable", "hash entry allocation error" );
+	if( (table->entry_count + 1) * 4 > table->capacity * 3 ) {
+		if( IS_FAILED( ( ret = _Resize( table, table->capacity * 2 ) ) ) ) {
+			END_FUNCTION( "PutInHashTable", ret );
+			return ret;
+		}
 	}
-	entry->key = key;
-	entry->key_size = key_size;
-	entry->value = value;
-
-	if( IS_FAILED( ( ret = AddElementInLinkedList( (CADDR_T)entry, list ) ) ) ) {
-		END_FUNCTION( "PutInHashTable", ret );
-		return ret;
-	}	
+	entry.key = key;
+	entry.key_size = key_size;
+	entry.value = value;
+	entry.hash = hash;
+	entry.order = table->next_order++;
+	_PlaceEntry( &entry, table );
 	table->entry_count++;
 	END_FUNCTION( "PutInHashTable", ret );
 	return ret;
@@ -106,28 +108,31 @@ RET_VAL PutInHashTable( CADDR_T key, UINT32 key_size, CADDR_T value, HASH_TABLE
 RET_VAL RemoveFromHashTable( CADDR_T key, UINT32 key_size, HASH_TABLE *table )
 {
 	RET_VAL ret = SUCCESS;
-	UINT32 bucket_index = 0;
-	LINKED_LIST *list = NULL;
+	UINT32 mask = 0;
+	UINT32 index = 0;
+	UINT32 next = 0;
 	HASH_ENTRY *target = NULL;
 
 
 	START_FUNCTION("RemoveFromHashTable");
 
-	bucket_index = ComputeBucketIndex( key, key_size, table->bucket_size );
-	list = table->buckets[bucket_index];
-
-	ResetCurrentElement( list );
-	while( (target = (HASH_ENTRY*)GetNextFromLinkedList(list)) != NULL ) {
-		if( key_size == target->key_size ) {
-			if( memcmp( key, target->key, key_size ) == 0 ) {
-				/*same key is found*/
-				RemoveCurrentFromLinkedList(list);
-				table->entry_count--;
-				END_FUNCTION( "RemoveFromHashTable", ret );
-				return ret;
-			}
-		}
+	if( (target = _FindEntry( key, key_size, _ComputeHash( key, key_size ), table )) == NULL ) {
+		END_FUNCTION( "RemoveFromHashTable", ret );
+		return ret;
+	}
+
+	/*shift the following entries of the cluster back by one slot*/
+	mask = table->capacity - 1;
+	index = (UINT32)(target - table->entries);
+	next = (index + 1) & mask;
+	while( table->entries[next].distance > 1 ) {
+		table->entries[index] = table->entries[next];
+		table->entries[index].distance--;
+		index = next;
+		next = (next + 1) & mask;
 	}
+	memset( &(table->entries[index]), 0, sizeof(HASH_ENTRY) );
+	table->entry_count--;
 
 	END_FUNCTION( "RemoveFromHashTable", ret );
 	return ret;
@@ -137,25 +142,15 @@ RET_VAL RemoveFromHashTable( CADDR_T key, UINT32 key_size, HASH_TABLE *table )
 CADDR_T GetValueFromHashTable( CADDR_T key, UINT32 key_size, HASH_TABLE *table )
 {
 	RET_VAL ret = SUCCESS;
-	UINT32 bucket_index = 0;
-	LINKED_LIST *list = NULL;
 	HASH_ENTRY *target = NULL;
 
 
 	START_FUNCTION("GetValueFromHashTable");
 
-	bucket_index = ComputeBucketIndex( key, key_size, table->bucket_size );
-	list = table->buckets[bucket_index];
-
-	ResetCurrentElement( list );
-	while( (target = (HASH_ENTRY*)GetNextFromLinkedList(list)) != NULL ) {
-		if( key_size == target->key_size ) {
-			if( memcmp( key, target->key, key_size ) == 0 ) {
-				/*found*/
-				END_FUNCTION( "GetValueFromHashTable", ret );
-				return target->value;
-			}
-		}
+	if( (target = _FindEntry( key, key_size, _ComputeHash( key, key_size ), table )) != NULL ) {
+		/*found*/
+		END_FUNCTION( "GetValueFromHashTable", ret );
+		return target->value;
 	}
 
 	END_FUNCTION( "GetValueFromHashTable", ret );
@@ -165,31 +160,11 @@ CADDR_T GetValueFromHashTable( CADDR_T key, UINT32 key_size, HASH_TABLE *table )
 
 LINKED_LIST *GenerateKeyList( HASH_TABLE *table )
 {
-	RET_VAL ret = SUCCESS;
-	UINT32 i = 0;
-	HASH_ENTRY *entry = NULL;
 	LINKED_LIST *keys = NULL;
-	LINKED_LIST *list = NULL;
 	
 	START_FUNCTION("GenerateKeyList");
 	
-	keys = CreateLinkedList();
-	if( keys == NULL ) {
-		return NULL;
-	}
-
-	for( i = 0; i < table->bucket_size; i++ ) {
-		list = table->buckets[i];
-		
-		ResetCurrentElement(list);
-		while( (entry = (HASH_ENTRY*)GetNextFromLinkedList(list)) != NULL ) {
-			if( IS_FAILED( (ret = AddElementInLinkedList( entry->key, keys ) ) ) ) {
-				DeleteLinkedList( &keys );
-				END_FUNCTION( "GenerateKeyList", ret );
-				return NULL;
-			}
-		}
-	}
+	keys = _GenerateOrderedList( table, TRUE );
 	
 	END_FUNCTION( "GenerateKeyList", SUCCESS );
 	return keys;
@@ -197,31 +172,12 @@ LINKED_LIST *GenerateKeyList( HASH_TABLE *table )
 
 LINKED_LIST *GenerateValueList( HASH_TABLE *table )
 {
-	RET_VAL ret = SUCCESS;
-	UINT32 i = 0;
-	HASH_ENTRY *entry = NULL;
 	LINKED_LIST *values = NULL;
-	LINKED_LIST *list = NULL;
 
 	START_FUNCTION("GenerateValueList");
 
-	values = CreateLinkedList();
-	if( values == NULL ) {
-		return NULL;
-	}
+	values = _GenerateOrderedList( table, FALSE );
 
-	for( i = 0; i < table->bucket_size; i++ ) {
-		list = table->buckets[i];
-		
-		ResetCurrentElement(list);
-		while( (entry = (HASH_ENTRY*)GetNextFromLinkedList(list)) != NULL ) {
-			if( IS_FAILED( (ret = AddElementInLinkedList( entry->value, values ) ) ) ) {
-				DeleteLinkedList( &values );
-				END_FUNCTION( "GenerateValueList", ret );
-				return NULL;
-			}
-		}
-	}
 	END_FUNCTION( "GenerateValueList", SUCCESS );
 	return values;
 }
@@ -237,25 +193,14 @@ UINT32 GetHashEntryCount( HASH_TABLE *table )
 BOOL ExistInHashTable( CADDR_T key, UINT32 key_size, HASH_TABLE *table )
 {
 	RET_VAL ret = SUCCESS;
-	UINT32 bucket_index = 0;
-	LINKED_LIST *list = NULL;
-	HASH_ENTRY *target = NULL;
 
 
 	START_FUNCTION("ExistInHashTable");
 
-	bucket_index = ComputeBucketIndex( key, key_size, table->bucket_size );
-	list = table->buckets[bucket_index];
-
-	ResetCurrentElement( list );
-	while( (target = (HASH_ENTRY*)GetNextFromLinkedList(list)) != NULL ) {
-		if( key_size == target->key_size ) {
-			if( memcmp( key, target->key, key_size ) == 0 ) {
-				/*found*/
-				END_FUNCTION( "ExistInHashTable", ret );
-				return TRUE;
-			}
-		}
+	if( _FindEntry( key, key_size, _ComputeHash( key, key_size ), table ) != NULL ) {
+		/*found*/
+		END_FUNCTION( "ExistInHashTable", ret );
+		return TRUE;
 	}
 
 	END_FUNCTION( "ExistInHashTable", ret );
@@ -266,27 +211,18 @@ BOOL ExistInHashTable( CADDR_T key, UINT32 key_size, HASH_TABLE *table )
 RET_VAL DeleteHashTable( HASH_TABLE **table )
 {
 	RET_VAL ret = SUCCESS;
-	UINT32 i = 0;
-	HASH_ENTRY *entry = NULL;
-	LINKED_LIST *list = NULL;
 	
-	START_FUNCTION("GenerateKeyList");
+	START_FUNCTION("DeleteHashTable");
 	
 	if( *table == NULL ) {
-		END_FUNCTION( "GenerateKeyList", ret );
+		END_FUNCTION( "DeleteHashTable", ret );
 		return ret;
 	}
-	for( i = 0; i < (*table)->bucket_size; i++ ) {
-		list = (*table)->buckets[i];
-					
-		ResetCurrentElement(list);
-		while( (entry = (HASH_ENTRY*)GetNextFromLinkedList(list)) != NULL ) {
-			FREE(entry);
-		}
-		DeleteLinkedList( &list );
+	if( (*table)->entries != NULL ) {
+		FREE( (*table)->entries );
 	}
 	FREE(*table);
-	END_FUNCTION( "GenerateKeyList", ret );
+	END_FUNCTION( "DeleteHashTable", ret );
 	return ret;
 }
 
@@ -310,3 +246,139 @@ UINT32 ComputeBucketIndex( CADDR_T key, UINT32 key_size, UINT32 bucket_size )
 	return index;
 }
 
+/*
+ * 32-bit FNV-1a over the key bytes.  UINT32 may be wider than 32 bits, so the product is 
+ * truncated after every step.
+ */
+static UINT32 _ComputeHash( CADDR_T key, UINT32 key_size )
+{
+	UINT32 i = 0;
+	UINT32 hash = 2166136261U;
+	BYTE *bytes = (BYTE*)key;
+
+	for( i = 0; i < key_size; i++ ) {
+		hash = ((hash ^ bytes[i]) * 16777619U) & 0xFFFFFFFFUL;
+	}
+	return hash;
+}
+
+static HASH_ENTRY *_FindEntry( CADDR_T key, UINT32 key_size, UINT32 hash, HASH_TABLE *table )
+{
+	UINT32 mask = table->capacity - 1;
+	UINT32 index = hash & mask;
+	UINT32 distance = 1;
+	HASH_ENTRY *entry = NULL;
+
+	for( ;; ) {
+		entry = table->entries + index;
+		/*an entry closer to its slot than the key would be ends the search*/
+		if( entry->distance < distance ) {
+			return NULL;
+		}
+		if( (entry->hash == hash) && (entry->key_size == key_size) && 
+		    ((entry->key == key) || (memcmp( key, entry->key, key_size ) == 0)) ) {
+			return entry;
+		}
+		index = (index + 1) & mask;
+		distance++;
+	}
+}
+
+static void _PlaceEntry( HASH_ENTRY *entry, HASH_TABLE *table )
+{
+	UINT32 mask = table->capacity - 1;
+	UINT32 index = entry->hash & mask;
+	HASH_ENTRY carried = *entry;
+	HASH_ENTRY swapped;
+
+	carried.distance = 1;
+	for( ;; ) {
+		if( table->entries[index].distance == 0 ) {
+			table->entries[index] = carried;
+			return;
+		}
+		/*the entry further from its slot takes this one*/
+		if( table->entries[index].distance < carried.distance ) {
+			swapped = table->entries[index];
+			table->entries[index] = carried;
+			carried = swapped;
+		}
+		index = (index + 1) & mask;
+		carried.distance++;
+	}
+}
+
+static RET_VAL _Resize( HASH_TABLE *table, UINT32 capacity )
+{
+	UINT32 i = 0;
+	UINT32 old_capacity = table->capacity;
+	HASH_ENTRY *old_entries = table->entries;
+
+	if( (table->entries = (HASH_ENTRY*)CALLOC( capacity, sizeof(HASH_ENTRY) )) == NULL ) {
+		table->entries = old_entries;
+		return ErrorReport( FAILING, "_Resize", "could not grow the hash table to %lu entries", capacity );
+	}
+	table->capacity = capacity;
+	for( i = 0; i < old_capacity; i++ ) {
+		if( old_entries[i].distance != 0 ) {
+			_PlaceEntry( old_entries + i, table );
+		}
+	}
+	FREE( old_entries );
+	return SUCCESS;
+}
+
+static LINKED_LIST *_GenerateOrderedList( HASH_TABLE *table, BOOL keys )
+{
+	RET_VAL ret = SUCCESS;
+	UINT32 i = 0;
+	UINT32 size = 0;
+	HASH_ENTRY *entry = NULL;
+	HASH_ORDER_ELEMENT *elements = NULL;
+	LINKED_LIST *list = NULL;
+
+	list = CreateLinkedList();
+	if( list == NULL ) {
+		return NULL;
+	}
+	if( table->entry_count == 0 ) {
+		return list;
+	}
+	if( (elements = (HASH_ORDER_ELEMENT*)MALLOC( table->entry_count * sizeof(HASH_ORDER_ELEMENT) )) == NULL ) {
+		DeleteLinkedList( &list );
+		return NULL;
+	}
+	for( i = 0; i < table->capacity; i++ ) {
+		entry = table->entries + i;
+		if( entry->distance != 0 ) {
+			elements[size].bucket = ComputeBucketIndex( entry->key, entry->key_size, table->bucket_size );
+			elements[size].order = entry->order;
+			elements[size].entry = entry;
+			size++;
+		}
+	}
+	qsort( elements, size, sizeof(HASH_ORDER_ELEMENT), _CompareOrderElements );
+	for( i = 0; i < size; i++ ) {
+		entry = elements[i].entry;
+		if( IS_FAILED( (ret = AddElementInLinkedList( keys ? entry->key : entry->value, list ) ) ) ) {
+			DeleteLinkedList( &list );
+			break;
+		}
+	}
+	FREE( elements );
+	return list;
+}
+
+static int _CompareOrderElements( const void *a, const void *b )
+{
+	const HASH_ORDER_ELEMENT *first = (const HASH_ORDER_ELEMENT*)a;
+	const HASH_ORDER_ELEMENT *second = (const HASH_ORDER_ELEMENT*)b;
+
+	if( first->bucket != second->bucket ) {
+		return (first->bucket < second->bucket) ? -1 : 1;
+	}
+	if( first->order != second->order ) {
+		return (first->order < second->order) ? -1 : 1;
+	}
+	return 0;
+}
@@ -23,18 +23,36 @@ Interface for hash_table API
 	extern "C" {
 #endif
 
-		typedef struct {
-			LINKED_LIST **buckets;
-			UINT32 bucket_size;
-			UINT32 entry_count;
-		} HASH_TABLE;
-		
+		/*
+		 * Entries are kept in place in a power-of-two array with Robin Hood open
+		 * addressing: distance is one more than how far an entry sits from the slot
+		 * its hash points to, and 0 marks an empty slot.  The hash of each key is
+		 * cached, so probes compare key bytes only when the hashes and sizes match.
+		 * The array doubles when it is more than three quarters full.
+		 */
 		typedef struct {
 			CADDR_T key;
 			UINT32 key_size;
 			CADDR_T value;
+			UINT32 hash;
+			UINT32 distance;
+			UINT32 order;
 		} HASH_ENTRY;
 
+		/*
+		 * bucket_size is the size the table was created with.  The key and value
+		 * lists are generated in the order of the former chained table, by the
+		 * byte sum of the key modulo bucket_size and then by insertion, so that
+		 * everything built from them keeps its order.
+		 */
+		typedef struct {
+			HASH_ENTRY *entries;
+			UINT32 capacity;
+			UINT32 bucket_size;
+			UINT32 entry_count;
+			UINT32 next_order;
+		} HASH_TABLE;
+
 
 		DLLSCOPE HASH_TABLE * STDCALL CreateHashTable( UINT32 bucket_size );
 		DLLSCOPE RET_VAL  STDCALL PutInHashTable( CADDR_T key, UINT32 key_size, CADDR_T value, HASH_TABLE *table );
@@ -54,7 +54,7 @@ DLLSCOPE RET_VAL STDCALL DoImplicitGear1Simulation( BACK_END_PROCESSOR *backend,
     UINT i = 0;
     UINT runs = 1;
     char *namePrefix = NULL;
-    static IMPLICIT_GEAR1_SIMULATION_RECORD rec;
+    IMPLICIT_GEAR1_SIMULATION_RECORD *rec = NULL;
     UINT timeout = 0;
 
 
@@ -65,28 +65,34 @@ DLLSCOPE RET_VAL STDCALL DoImplicitGear1Simulation( BACK_END_PROCESSOR *backend,
             "gear 1 method cannot be applied to the model" );
     }
 
-    if( IS_FAILED( ( ret = _InitializeRecord( &rec, backend, ir ) ) ) )  {
+    if( ( rec = (IMPLICIT_GEAR1_SIMULATION_RECORD*)MALLOC( sizeof(IMPLICIT_GEAR1_SIMULATION_RECORD) ) ) == NULL ) {
+        return ErrorReport( FAILING, "DoImplicitGear1Simulation", "could not allocate the record" );
+    }
+    if( IS_FAILED( ( ret = _InitializeRecord( rec, backend, ir ) ) ) )  {
+        _CleanRecord( rec );
+        FREE( rec );
+        backend->_internal1 = NULL;
         return ErrorReport( ret, "DoImplicitGear1Simulation", "initialization of the record failed" );
     }
-    runs = rec.runs;
+    runs = rec->runs;
     for( i = 1; i <= runs; i++ ) {
       timeout = 0;
-      SeedRandomNumberGenerators( rec.seed );
-      rec.seed = GetNextUniformRandomNumber(0,RAND_MAX);
+      SeedRandomNumberGenerators( rec->seed );
+      rec->seed = GetNextUniformRandomNumber(0,RAND_MAX);
       do {
-	SeedRandomNumberGenerators( rec.seed );
-	if( IS_FAILED( ( ret = _InitializeSimulation( &rec, i ) ) ) ) {
+	SeedRandomNumberGenerators( rec->seed );
+	if( IS_FAILED( ( ret = _InitializeSimulation( rec, i ) ) ) ) {
 	  return ErrorReport( ret, "DoImplicitGear1Simulation", "initialization of the %i-th simulation failed", i );
 	}
 	timeout++;
-      } while ( (ret == CHANGE) && (timeout <= (rec.speciesSize + rec.compartmentsSize + rec.symbolsSize)) );
-      if (timeout > (rec.speciesSize + rec.compartmentsSize + rec.symbolsSize)) {
+      } while ( (ret == CHANGE) && (timeout <= (rec->speciesSize + rec->compartmentsSize + rec->symbolsSize)) );
+      if (timeout > (rec->speciesSize + rec->compartmentsSize + rec->symbolsSize)) {
 	return ErrorReport( ret, "DoImplicitGear1Simulation", "Cycle detected in initial and rule assignments" );
       }
-      if( IS_FAILED( ( ret = _RunSimulation( &rec ) ) ) ) {
-        return ErrorReport( ret, "DoImplicitGear1Simulation", "%i-th simulation failed at time %f", i, rec.time );
+      if( IS_FAILED( ( ret = _RunSimulation( rec ) ) ) ) {
+        return ErrorReport( ret, "DoImplicitGear1Simulation", "%i-th simulation failed at time %f", i, rec->time );
       }
-      if( IS_FAILED( ( ret = _CleanSimulation( &rec ) ) ) ) {
+      if( IS_FAILED( ( ret = _CleanSimulation( rec ) ) ) ) {
         return ErrorReport( ret, "DoImplicitGear1Simulation", "cleaning of the %i-th simulation failed", i );
       }
       printf("Run = %d\n",i);
@@ -106,6 +112,8 @@ DLLSCOPE RET_VAL STDCALL CloseImplicitGear1Simulation( BACK_END_PROCESSOR *backe
     if( IS_FAILED( ( ret = _CleanRecord( rec ) ) ) )  {
         return ErrorReport( ret, "CloseImplicitGear1Simulation", "cleaning of the record failed" );
     }
+    FREE( rec );
+    backend->_internal1 = NULL;
 
     END_FUNCTION("CloseImplicitGear1Simulation",  SUCCESS );
     return ret;
@@ -273,6 +281,7 @@ static RET_VAL _InitializeRecord( IMPLICIT_GEAR1_SIMULATION_RECORD *rec, BACK_EN
     if( ( rec->evaluator = CreateKineticLawEvaluater() ) == NULL ) {
         return ErrorReport( FAILING, "_InitializeRecord", "could not create evaluator" );
     }
+    rec->evaluator->interpolateDelays = TRUE;
 
     if( ( rec->findNextTime = CreateKineticLawFind_Next_Time() ) == NULL ) {
         return ErrorReport( FAILING, "_InitializeRecord", "could not create find next time" );
@@ -719,8 +728,12 @@ static RET_VAL _CleanRecord( IMPLICIT_GEAR1_SIMULATION_RECORD *rec ) {
         FREE( rec->concentrations );
     }
 
-    printer->Destroy( printer );
-    decider->Destroy( decider );
+    if( printer != NULL ) {
+        printer->Destroy( printer );
+    }
+    if( decider != NULL ) {
+        decider->Destroy( decider );
+    }
 
     return ret;
 }
@@ -20,6 +20,8 @@
 #include "ir2ctmc_transformer.h"
 #include "ctmc_transformation_checker.h"
 #include "species_critical_level_generator.h"
+#include "markov_chain_analysis_properties.h"
+#include "strconv.h"
 
 
 static CTMC *_Generate( IR2CTMC_TRANSFORMER *transformer );
@@ -28,8 +30,7 @@ static SPECIES_CRITICAL_LEVEL **_GetCriticalLevelArray( IR2CTMC_TRANSFORMER *tra
 static RET_VAL _ResetCurrentLevelArray( IR2CTMC_TRANSFORMER *transformer );
 static RET_VAL _IncrementCurrentLevelArray( IR2CTMC_TRANSFORMER *transformer );
 static double *_GetCurrentLevelArray( IR2CTMC_TRANSFORMER *transformer );
-static RET_VAL _ResetCurrentArray( int speciesSize, int *currentArray );
-static RET_VAL _IncrementCurrentArray( int speciesSize, int *currentArray, SPECIES_CRITICAL_LEVEL **criticalLevelArray );
+static RET_VAL _SetCurrentArray( IR2CTMC_TRANSFORMER *transformer, int state );
 static RET_VAL _UpdateCurrenLevelArray( 
                 int speciesSize, 
                 int *currentArray, 
@@ -44,16 +45,18 @@ static RET_VAL _ReleaseResource( IR2CTMC_TRANSFORMER *transformer );
 
 static SPECIES_CRITICAL_LEVEL **_CreateCriticalLevelArray( LINKED_LIST *speciesList, REB2SAC_PROPERTIES *properties );
 static RET_VAL _InitTransformer( IR2CTMC_TRANSFORMER *transformer, IR *ir, REB2SAC_PROPERTIES *properties );
-static int _FindNumberOfStates( SPECIES_CRITICAL_LEVEL **criticalLevelArray, int speciesSize );
-static RET_VAL _AddTransitions( IR2CTMC_TRANSFORMER *transformer, CTMC_GENERATOR *gen, int state );
-static RET_VAL _AddProductionTransition( IR2CTMC_TRANSFORMER *transformer, CTMC_GENERATOR *gen, int state, int index );
-static RET_VAL _AddDegradationTransition( IR2CTMC_TRANSFORMER *transformer, CTMC_GENERATOR *gen, int state, int index );
-static RET_VAL _Update( IR2CTMC_TRANSFORMER *transformer, int state );
-static RET_VAL _UpdateLevels( IR2CTMC_TRANSFORMER *transformer, int state );
+static RET_VAL _Explore( IR2CTMC_TRANSFORMER *transformer );
+static RET_VAL _AddState( IR2CTMC_TRANSFORMER *transformer, int *levelIndices, int *state );
+static RET_VAL _ResizeStateTable( IR2CTMC_TRANSFORMER *transformer );
+static UINT32 _HashLevelIndices( int *levelIndices, int speciesSize );
+static RET_VAL _AddTransitions( IR2CTMC_TRANSFORMER *transformer, int state, int *targetArray );
+static RET_VAL _AddProductionTransition( IR2CTMC_TRANSFORMER *transformer, int state, int index, int *targetArray );
+static RET_VAL _AddDegradationTransition( IR2CTMC_TRANSFORMER *transformer, int state, int index, int *targetArray );
+static RET_VAL _RecordTransition( IR2CTMC_TRANSFORMER *transformer, int from, int to, double rate );
+static RET_VAL _LoadState( IR2CTMC_TRANSFORMER *transformer, int state );
 static RET_VAL _UpdateReactionRates( IR2CTMC_TRANSFORMER *transformer, int state );
 static RET_VAL _GenerateCurrentRate( KINETIC_LAW_EVALUATER *evaluator, REACTION *reaction, int state );
 static RET_VAL _SetLevelInSpecies( SPECIES *species, double level );
-static int _FindInitialState( IR2CTMC_TRANSFORMER *transformer );
 static double _GetLevelInSpecies( SPECIES *species );
 
 IR2CTMC_TRANSFORMER *CreateIR2CTMCTransformer( IR *ir, REB2SAC_PROPERTIES *properties ) {
@@ -94,11 +97,12 @@ RET_VAL FreeIR2CTMCTransformer( IR2CTMC_TRANSFORMER **pTransformer ) {
 static RET_VAL _InitTransformer( IR2CTMC_TRANSFORMER *transformer, IR *ir, REB2SAC_PROPERTIES *properties ) {
     RET_VAL ret = SUCCESS;
     int i = 0;
-    int multiply = 1;
     int reactionSize = 0;
     int speciesSize = 0;
+    int initialLevelIndex = 0;
     int *currentArray = NULL;
-    int *multiplyArray = NULL;
+    UINT32 maxStateSize = DEFAULT_MARKOV_CHAIN_MAX_STATES;
+    char *valueString = NULL;
     double *currentLevelArray = NULL;
     SPECIES *species = NULL;
     SPECIES **updatedSpeciesArray = NULL;
@@ -133,21 +137,25 @@ static RET_VAL _InitTransformer( IR2CTMC_TRANSFORMER *transformer, IR *ir, REB2S
     if( ( currentLevelArray = (double*)CALLOC( speciesSize, sizeof(double) ) ) == NULL ) {
         return ErrorReport( FAILING, "_InitArrays", "failed to allocate memory for currentLevelArray" );
     } 
-    if( ( multiplyArray = (int*)MALLOC( speciesSize * sizeof(int) ) ) == NULL ) {
-        return ErrorReport( FAILING, "_InitArrays", "failed to allocate memory for multiplyArray" );
-    } 
     if( ( updatedSpeciesArray = (SPECIES**)MALLOC( speciesSize * sizeof(SPECIES*) ) ) == NULL ) {
         return ErrorReport( FAILING, "_InitArrays", "failed to allocate memory for updatedSpeciesArray" );
     } 
     
+    /* the exploration starts from the initial state, which becomes state 0 */
     for( i = 0; i < speciesSize; i++ ) {
         criticalLevel = criticalLevelArray[i];
         species = criticalLevel->species;
-        if( IS_FAILED(  ( ret = _SetLevelInSpecies( species, criticalLevel->levels[0] ) ) ) ) {
+        initialLevelIndex = criticalLevel->initialLevelIndex;
+        if( IS_FAILED(  ( ret = _SetLevelInSpecies( species, criticalLevel->levels[initialLevelIndex] ) ) ) ) {
             return ret;
         }
-        multiplyArray[i] = multiply;
-        multiply *= criticalLevel->size;
+        currentArray[i] = initialLevelIndex;
+    }
+    
+    if( ( valueString = properties->GetProperty( properties, MARKOV_CHAIN_MAX_STATES_KEY ) ) != NULL ) {
+        if( IS_FAILED( ( ret = StrToUINT32( &maxStateSize, valueString ) ) ) ) {
+            return ErrorReport( FAILING, "_InitArrays", "invalid value %s for %s", valueString, MARKOV_CHAIN_MAX_STATES_KEY );
+        }
     }
     
     if( ( evaluator = CreateKineticLawEvaluater() ) == NULL ) {
@@ -164,14 +172,15 @@ static RET_VAL _InitTransformer( IR2CTMC_TRANSFORMER *transformer, IR *ir, REB2S
         }
     }
     
-    transformer->stateSize = _FindNumberOfStates( criticalLevelArray, speciesSize );
+    transformer->stateSize = 0;
+    transformer->maxStateSize = (int)maxStateSize;
+    transformer->isExplored = FALSE;
     transformer->reactionSize = reactionSize;
     transformer->reactionArray = reactions;
     transformer->speciesSize = speciesSize;
     transformer->criticalLevelArray = criticalLevelArray;
     transformer->currentArray = currentArray;
     transformer->currentLevelArray = currentLevelArray;
-    transformer->multiplyArray = multiplyArray; 
     transformer->evaluator = evaluator;
     transformer->updatedSpeciesArray = updatedSpeciesArray;
 
@@ -190,15 +199,19 @@ static RET_VAL _InitTransformer( IR2CTMC_TRANSFORMER *transformer, IR *ir, REB2S
 
 static CTMC *_Generate( IR2CTMC_TRANSFORMER *transformer ) {
     int i = 0;
-    int stateSize = transformer->stateSize;
+    int stateSize = 0;
+    int transitionSize = 0;
     int speciesSize = transformer->speciesSize;
-    int *currentArray = transformer->currentArray; 
-    int initialState = 0;
-    SPECIES_CRITICAL_LEVEL **criticalLevelArray = transformer->criticalLevelArray;
+    double peakMemory = 0.0;
     CTMC *ctmc = NULL;
     CTMC_STATE *states = NULL;
     CTMC_GENERATOR *gen = NULL;
-    KINETIC_LAW_EVALUATER *evaluator = transformer->evaluator;
+    
+    if( IS_FAILED( ( _Explore( transformer ) ) ) ) {
+        return NULL;
+    }
+    stateSize = transformer->stateSize;
+    transitionSize = transformer->transitionSize;
     
     if( ( gen = CreateCTMCGenerator() ) == NULL ) {
         return NULL;
@@ -208,21 +221,17 @@ static CTMC *_Generate( IR2CTMC_TRANSFORMER *transformer ) {
         return NULL;
     }
     
-    if( IS_FAILED( ( _AddTransitions( transformer, gen, 0 ) ) ) ) {
-        return NULL;
-    }    
-    for( i = 1; i < stateSize; i++ ) {        
-        if( IS_FAILED( ( _Update( transformer, i ) ) ) ) {
+    for( i = 0; i < transitionSize; i++ ) {
+        TRACE_3( "Adding transition from %i to %i at rate %g", 
+            transformer->transitionFromArray[i], transformer->transitionToArray[i], transformer->transitionRateArray[i] );
+        if( IS_FAILED( ( gen->AddTransition( gen, transformer->transitionFromArray[i], 
+                            transformer->transitionToArray[i], transformer->transitionRateArray[i] ) ) ) ) {
             return NULL;
         }
-        
-        if( IS_FAILED( ( _AddTransitions( transformer, gen, i ) ) ) ) {
-            return NULL;
-        }        
     }
     
-    initialState = _FindInitialState( transformer );
-    if( IS_FAILED( ( gen->SetInitialState( gen, initialState ) ) ) ) {
+    /* the breadth-first exploration numbers the initial state 0 */
+    if( IS_FAILED( ( gen->SetInitialState( gen, 0 ) ) ) ) {
         return NULL;    
     }        
     
@@ -234,6 +243,24 @@ static CTMC *_Generate( IR2CTMC_TRANSFORMER *transformer ) {
         return NULL;
     }
     
+    /* the exploration buffers and the CTMC are both alive at this point */
+    peakMemory = (double)(transformer->stateCapacity) * speciesSize * sizeof(int) 
+        + (double)(transformer->stateTableSize) * sizeof(int)
+        + (double)(transformer->transitionCapacity) * ( 2 * sizeof(int) + sizeof(double) )
+        + (double)stateSize * sizeof(CTMC_STATE)
+        + (double)transitionSize * ( sizeof(CTMC_TRANSITION) + sizeof(CADDR_T) );
+    printf( "CTMC: %i reachable states, %i transitions, peak memory %.1f KB" NEW_LINE, 
+        stateSize, transitionSize, peakMemory / 1024.0 );
+    fflush( stdout );
+    
+    /* only the level vectors of the states are needed from now on */
+    FREE( transformer->stateTable );
+    FREE( transformer->transitionFromArray );
+    FREE( transformer->transitionToArray );
+    FREE( transformer->transitionRateArray );
+    transformer->stateTableSize = 0;
+    transformer->transitionCapacity = 0;
+    
     return ctmc;
 }
 
@@ -252,7 +279,11 @@ static RET_VAL _ResetCurrentLevelArray( IR2CTMC_TRANSFORMER *transformer ) {
     double *currentLevelArray = transformer->currentLevelArray;
     SPECIES_CRITICAL_LEVEL **criticalLevelArray = transformer->criticalLevelArray;
     
-    if( IS_FAILED( ( ret = _ResetCurrentArray( speciesSize, currentArray ) ) ) ) {
+    /* states are walked in the order the exploration numbered them */
+    if( IS_FAILED( ( ret = _Explore( transformer ) ) ) ) {
+        return ret;
+    }
+    if( IS_FAILED( ( ret = _SetCurrentArray( transformer, 0 ) ) ) ) {
         return ret;
     }
     
@@ -270,7 +301,10 @@ static RET_VAL _IncrementCurrentLevelArray( IR2CTMC_TRANSFORMER *transformer ) {
     double *currentLevelArray = transformer->currentLevelArray;
     SPECIES_CRITICAL_LEVEL **criticalLevelArray = transformer->criticalLevelArray;
     
-    if( IS_FAILED( ( ret = _IncrementCurrentArray( speciesSize, currentArray, criticalLevelArray ) ) ) ) {
+    if( transformer->currentState + 1 >= transformer->stateSize ) {
+        return SUCCESS;
+    }
+    if( IS_FAILED( ( ret = _SetCurrentArray( transformer, transformer->currentState + 1 ) ) ) ) {
         return ret;
     }
     
@@ -286,40 +320,16 @@ static double *_GetCurrentLevelArray( IR2CTMC_TRANSFORMER *transformer ) {
 }
 
 
-static RET_VAL _ResetCurrentArray( int speciesSize, int *currentArray ) {
-    RET_VAL ret = SUCCESS;
-    int i = 0;
-
-    for( ; i < speciesSize; i++ ){
-        currentArray[i] = 0;
-    }
-    
-    return ret;
-}
-
-static RET_VAL _IncrementCurrentArray( int speciesSize, int *currentArray, SPECIES_CRITICAL_LEVEL **criticalLevelArray ){
-    int i = 0;
-    int current = 0;
-    int delta = 0;
-    SPECIES_CRITICAL_LEVEL *criticalLevel = NULL;
+static RET_VAL _SetCurrentArray( IR2CTMC_TRANSFORMER *transformer, int state ) {
+    int speciesSize = transformer->speciesSize;
     
-    for( i = 0; i < speciesSize; i++ ) {
-        criticalLevel = criticalLevelArray[i];
-        current = currentArray[i];
-        delta = criticalLevel->size - current;
-        if( ( delta == 1 ) && ( current == 0 ) ) {
-            continue;
-        }
-        else if( delta == 1 ) {
-            currentArray[i] = 0;
-        }
-        else {
-            current++;
-            currentArray[i] = current;
-            return SUCCESS;
-        }        
+    if( ( state < 0 ) || ( state >= transformer->stateSize ) ) {
+        return ErrorReport( FAILING, "_SetCurrentArray", "state %i is out of range", state );
     }
-    return SUCCESS;    
+    memcpy( transformer->currentArray, transformer->stateLevelArray + (long)state * speciesSize, speciesSize * sizeof(int) );
+    transformer->currentState = state;
+    
+    return SUCCESS;
 }
 
 static RET_VAL _UpdateCurrenLevelArray( 
@@ -355,10 +365,14 @@ static RET_VAL _ReleaseResource( IR2CTMC_TRANSFORMER *transformer ) {
     
     FREE( criticalLevelArray );
     FREE( transformer->reactionArray );
-    FREE( transformer->multiplyArray );
     FREE( transformer->currentArray );
     FREE( transformer->currentLevelArray );
     FREE( transformer->updatedSpeciesArray );
+    FREE( transformer->stateLevelArray );
+    FREE( transformer->stateTable );
+    FREE( transformer->transitionFromArray );
+    FREE( transformer->transitionToArray );
+    FREE( transformer->transitionRateArray );
 
     return SUCCESS;
 }
@@ -397,28 +411,166 @@ static SPECIES_CRITICAL_LEVEL **_CreateCriticalLevelArray( LINKED_LIST *speciesL
 
 
 
-static int _FindNumberOfStates( SPECIES_CRITICAL_LEVEL **criticalLevelArray, int speciesSize ) {
+/* 
+ * breadth-first exploration from the initial state. 
+ * states are appended to stateLevelArray in discovery order, so the array itself is the queue.
+ */
+static RET_VAL _Explore( IR2CTMC_TRANSFORMER *transformer ) {
+    RET_VAL ret = SUCCESS;
     int i = 0;
-    int num = 1;
-    SPECIES_CRITICAL_LEVEL *criticalLevel = 0;
+    int state = 0;
+    int speciesSize = transformer->speciesSize;
+    int *targetArray = NULL;
+    SPECIES_CRITICAL_LEVEL **criticalLevelArray = transformer->criticalLevelArray;
+    
+    if( transformer->isExplored ) {
+        return SUCCESS;
+    }
+    
+    transformer->stateCapacity = 512;
+    transformer->stateTableSize = 1024;
+    if( ( transformer->stateLevelArray = (int*)MALLOC( transformer->stateCapacity * speciesSize * sizeof(int) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_Explore", "failed to allocate memory for the state level array" );
+    }
+    if( ( transformer->stateTable = (int*)MALLOC( transformer->stateTableSize * sizeof(int) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_Explore", "failed to allocate memory for the state table" );
+    }
+    for( i = 0; i < transformer->stateTableSize; i++ ) {
+        transformer->stateTable[i] = -1;
+    }
+    if( ( targetArray = (int*)MALLOC( speciesSize * sizeof(int) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_Explore", "failed to allocate memory for the target array" );
+    }
     
     for( i = 0; i < speciesSize; i++ ) {
-        criticalLevel = criticalLevelArray[i];
-        num *= criticalLevel->size;        
+        targetArray[i] = criticalLevelArray[i]->initialLevelIndex;
+    }
+    if( IS_FAILED( ( ret = _AddState( transformer, targetArray, &state ) ) ) ) {
+        FREE( targetArray );
+        return ret;
+    }
+    
+    for( state = 0; state < transformer->stateSize; state++ ) {
+        if( IS_FAILED( ( ret = _LoadState( transformer, state ) ) ) ) {
+            FREE( targetArray );
+            return ret;
+        }
+        memcpy( targetArray, transformer->currentArray, speciesSize * sizeof(int) );
+        if( IS_FAILED( ( ret = _AddTransitions( transformer, state, targetArray ) ) ) ) {
+            FREE( targetArray );
+            return ret;
+        }
+    }
+    
+    FREE( targetArray );
+    transformer->isExplored = TRUE;
+    
+    return SUCCESS;
+}
+
+/* 
+ * finds the id of the state with the given level indices, adding it if it has not been reached yet.
+ * the state table is open addressing with linear probing, and holds state ids (-1 is empty).
+ */
+static RET_VAL _AddState( IR2CTMC_TRANSFORMER *transformer, int *levelIndices, int *state ) {
+    RET_VAL ret = SUCCESS;
+    int id = 0;
+    int speciesSize = transformer->speciesSize;
+    int *stateLevelArray = NULL;
+    UINT32 mask = (UINT32)(transformer->stateTableSize - 1);
+    UINT32 slot = 0;
+    
+    for( slot = _HashLevelIndices( levelIndices, speciesSize ) & mask; 
+         ( id = transformer->stateTable[slot] ) >= 0; 
+         slot = ( slot + 1 ) & mask ) {
+        if( memcmp( transformer->stateLevelArray + (long)id * speciesSize, levelIndices, speciesSize * sizeof(int) ) == 0 ) {
+            *state = id;
+            return SUCCESS;
+        }
+    }
+    
+    if( ( transformer->maxStateSize > 0 ) && ( transformer->stateSize >= transformer->maxStateSize ) ) {
+        return ErrorReport( FAILING, "_AddState", 
+            "the reachable state space exceeds %i states; raise %s to analyze this model", 
+            transformer->maxStateSize, MARKOV_CHAIN_MAX_STATES_KEY );
+    }
+    
+    if( transformer->stateSize == transformer->stateCapacity ) {
+        stateLevelArray = (int*)REALLOC( transformer->stateLevelArray, 
+                                         2 * (long)(transformer->stateCapacity) * speciesSize * sizeof(int) );
+        if( stateLevelArray == NULL ) {
+            return ErrorReport( FAILING, "_AddState", "failed to allocate memory for %i states", 2 * transformer->stateCapacity );
+        }
+        transformer->stateLevelArray = stateLevelArray;
+        transformer->stateCapacity *= 2;
+    }
+    
+    id = transformer->stateSize;
+    memcpy( transformer->stateLevelArray + (long)id * speciesSize, levelIndices, speciesSize * sizeof(int) );
+    transformer->stateTable[slot] = id;
+    transformer->stateSize++;
+    *state = id;
+    
+    if( 2 * transformer->stateSize > transformer->stateTableSize ) {
+        if( IS_FAILED( ( ret = _ResizeStateTable( transformer ) ) ) ) {
+            return ret;
+        }
+    }
+    
+    return SUCCESS;
+}
+
+static RET_VAL _ResizeStateTable( IR2CTMC_TRANSFORMER *transformer ) {
+    int i = 0;
+    int id = 0;
+    int speciesSize = transformer->speciesSize;
+    int stateTableSize = 2 * transformer->stateTableSize;
+    int *stateTable = NULL;
+    UINT32 mask = (UINT32)(stateTableSize - 1);
+    UINT32 slot = 0;
+    
+    if( ( stateTable = (int*)MALLOC( stateTableSize * sizeof(int) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_ResizeStateTable", "failed to allocate memory for the state table" );
+    }
+    for( i = 0; i < stateTableSize; i++ ) {
+        stateTable[i] = -1;
+    }
+    for( id = 0; id < transformer->stateSize; id++ ) {
+        slot = _HashLevelIndices( transformer->stateLevelArray + (long)id * speciesSize, speciesSize ) & mask;
+        while( stateTable[slot] >= 0 ) {
+            slot = ( slot + 1 ) & mask;
+        }
+        stateTable[slot] = id;
+    }
+    
+    FREE( transformer->stateTable );
+    transformer->stateTable = stateTable;
+    transformer->stateTableSize = stateTableSize;
+    
+    return SUCCESS;
+}
+
+static UINT32 _HashLevelIndices( int *levelIndices, int speciesSize ) {
+    int i = 0;
+    UINT32 hash = 2166136261U;
+    
+    for( i = 0; i < speciesSize; i++ ) {
+        hash = ( hash ^ (UINT32)levelIndices[i] ) * 16777619U;
+        hash &= 0xFFFFFFFFU;
     }
-    return num;
+    return hash ^ ( hash >> 15 );
 }
 
-static RET_VAL _AddTransitions( IR2CTMC_TRANSFORMER *transformer, CTMC_GENERATOR *gen, int state ) {
+static RET_VAL _AddTransitions( IR2CTMC_TRANSFORMER *transformer, int state, int *targetArray ) {
     RET_VAL ret = SUCCESS;
     int i = 0;
     int speciesSize = transformer->speciesSize;
     
     for( ; i < speciesSize; i++ ){
-        if( IS_FAILED( ( ret = _AddProductionTransition( transformer, gen, state, i ) ) ) ) {
+        if( IS_FAILED( ( ret = _AddProductionTransition( transformer, state, i, targetArray ) ) ) ) {
             return ret;
         } 
-        if( IS_FAILED( ( ret = _AddDegradationTransition( transformer, gen, state, i ) ) ) ) {
+        if( IS_FAILED( ( ret = _AddDegradationTransition( transformer, state, i, targetArray ) ) ) ) {
             return ret;
         } 
     }
@@ -426,11 +578,9 @@ static RET_VAL _AddTransitions( IR2CTMC_TRANSFORMER *transformer, CTMC_GENERATOR
     return SUCCESS;
 }
 
-static RET_VAL _AddProductionTransition( IR2CTMC_TRANSFORMER *transformer, CTMC_GENERATOR *gen, int state, int index ) {
+static RET_VAL _AddProductionTransition( IR2CTMC_TRANSFORMER *transformer, int state, int index, int *targetArray ) {
     RET_VAL ret = SUCCESS;
-    int *multiplyArray = transformer->multiplyArray;
-    int levelIndex = 0;
-    int targetState = state;    
+    int targetState = 0;    
     int current = 0;
     int *currentArray = transformer->currentArray;
     double stoichiometry = 0.0;
@@ -466,21 +616,23 @@ static RET_VAL _AddProductionTransition( IR2CTMC_TRANSFORMER *transformer, CTMC_
     }
     
     deltaLevel = criticalLevel->levels[current + 1] - criticalLevel->levels[current];
-    targetState += multiplyArray[index];
+    targetArray[index] = current + 1;
+    ret = _AddState( transformer, targetArray, &targetState );
+    targetArray[index] = current;
+    if( IS_FAILED( ret ) ) {
+        return ret;
+    }
     
-    TRACE_3( "Adding transition from %i to %i at rate %g", state, targetState, rate / deltaLevel );
-    if( IS_FAILED( ( ret = gen->AddTransition( gen, state, targetState, rate / deltaLevel ) ) ) ) {
+    if( IS_FAILED( ( ret = _RecordTransition( transformer, state, targetState, rate / deltaLevel ) ) ) ) {
         return ret;
     }
     
     return SUCCESS;
 }
 
-static RET_VAL _AddDegradationTransition( IR2CTMC_TRANSFORMER *transformer, CTMC_GENERATOR *gen, int state, int index ) {
+static RET_VAL _AddDegradationTransition( IR2CTMC_TRANSFORMER *transformer, int state, int index, int *targetArray ) {
     RET_VAL ret = SUCCESS;
-    int *multiplyArray = transformer->multiplyArray;
-    int levelIndex = 0;
-    int targetState = state;    
+    int targetState = 0;    
     int current = 0;
     int *currentArray = transformer->currentArray;
     double stoichiometry = 0.0;
@@ -516,73 +668,88 @@ static RET_VAL _AddDegradationTransition( IR2CTMC_TRANSFORMER *transformer, CTMC
     }
     
     deltaLevel = criticalLevel->levels[current] - criticalLevel->levels[current - 1];
-    targetState -= multiplyArray[index];
+    targetArray[index] = current - 1;
+    ret = _AddState( transformer, targetArray, &targetState );
+    targetArray[index] = current;
+    if( IS_FAILED( ret ) ) {
+        return ret;
+    }
     
-    TRACE_3( "Adding transition from %i to %i at rate %g", state, targetState, rate / deltaLevel );
-    if( IS_FAILED( ( ret = gen->AddTransition( gen, state, targetState, rate / deltaLevel ) ) ) ) {
+    if( IS_FAILED( ( ret = _RecordTransition( transformer, state, targetState, rate / deltaLevel ) ) ) ) {
         return ret;
     }
     
     return SUCCESS;
 }
 
-
-
-static RET_VAL _Update( IR2CTMC_TRANSFORMER *transformer, int state ) {
-    RET_VAL ret = SUCCESS;
-    
-    if( IS_FAILED( ( ret = _UpdateLevels( transformer, state ) ) ) ) {
-        return ret;
-    }
-    if( IS_FAILED( ( ret = _UpdateReactionRates( transformer, state ) ) ) ) {
-        return ret;
+static RET_VAL _RecordTransition( IR2CTMC_TRANSFORMER *transformer, int from, int to, double rate ) {
+    int size = transformer->transitionSize;
+    int capacity = transformer->transitionCapacity;
+    int *fromArray = NULL;
+    int *toArray = NULL;
+    double *rateArray = NULL;
+    
+    if( size == capacity ) {
+        capacity = ( capacity == 0 ) ? 1024 : 2 * capacity;
+        if( ( fromArray = (int*)REALLOC( transformer->transitionFromArray, capacity * sizeof(int) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_RecordTransition", "failed to allocate memory for %i transitions", capacity );
+        }
+        transformer->transitionFromArray = fromArray;
+        if( ( toArray = (int*)REALLOC( transformer->transitionToArray, capacity * sizeof(int) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_RecordTransition", "failed to allocate memory for %i transitions", capacity );
+        }
+        transformer->transitionToArray = toArray;
+        if( ( rateArray = (double*)REALLOC( transformer->transitionRateArray, capacity * sizeof(double) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_RecordTransition", "failed to allocate memory for %i transitions", capacity );
+        }
+        transformer->transitionRateArray = rateArray;
+        transformer->transitionCapacity = capacity;
     }
     
+    transformer->transitionFromArray[size] = from;
+    transformer->transitionToArray[size] = to;
+    transformer->transitionRateArray[size] = rate;
+    transformer->transitionSize = size + 1;
+    
     return SUCCESS;
 }
 
-static RET_VAL _UpdateLevels( IR2CTMC_TRANSFORMER *transformer, int state ) {
+
+
+/* 
+ * sets the species to the levels of the given state, 
+ * and re-evaluates only the reactions touching the species whose level changed.
+ */
+static RET_VAL _LoadState( IR2CTMC_TRANSFORMER *transformer, int state ) {
     RET_VAL ret = SUCCESS;
     int i = 0;
-    int current = 0;
-    int delta = 0;
+    int levelIndex = 0;
     int updatedSpeciesIndex = 0;    
     int speciesSize = transformer->speciesSize;
     int *currentArray = transformer->currentArray;
+    int *levelIndices = transformer->stateLevelArray + (long)state * speciesSize;
     SPECIES *species = NULL;
     SPECIES **updatedSpeciesArray = transformer->updatedSpeciesArray;
     SPECIES_CRITICAL_LEVEL *criticalLevel = NULL;
     SPECIES_CRITICAL_LEVEL **criticalLevelArray = transformer->criticalLevelArray;
     
     for( i = 0; i < speciesSize; i++ ) {
-        criticalLevel = criticalLevelArray[i];
-        current = currentArray[i];
-        delta = criticalLevel->size - current;
-        species = criticalLevel->species;
-        if( ( delta == 1 ) && ( current == 0 ) ) {
+        levelIndex = levelIndices[i];
+        if( levelIndex == currentArray[i] ) {
             continue;
         }
-        else if( delta == 1 ) {
-            currentArray[i] = 0;
-            if( IS_FAILED(  ( ret = _SetLevelInSpecies( species, criticalLevel->levels[0] ) ) ) ) {
-                return ret;
-            }
-            updatedSpeciesArray[updatedSpeciesIndex] = species;
-            updatedSpeciesIndex++;
-        }
-        else {
-            current++;
-            if( IS_FAILED(  ( ret = _SetLevelInSpecies( species, criticalLevel->levels[current] ) ) ) ) {
-                return ret;
-            }
-            updatedSpeciesArray[updatedSpeciesIndex] = species;
-            updatedSpeciesIndex++;
-            transformer->updatedSpeciesSize = updatedSpeciesIndex;
-            currentArray[i] = current;
-            return SUCCESS;
+        criticalLevel = criticalLevelArray[i];
+        species = criticalLevel->species;
+        if( IS_FAILED(  ( ret = _SetLevelInSpecies( species, criticalLevel->levels[levelIndex] ) ) ) ) {
+            return ret;
         }
+        currentArray[i] = levelIndex;
+        updatedSpeciesArray[updatedSpeciesIndex] = species;
+        updatedSpeciesIndex++;
     }
-    return FAILING;
+    transformer->updatedSpeciesSize = updatedSpeciesIndex;
+    
+    return _UpdateReactionRates( transformer, state );
 }
 
 static RET_VAL _UpdateReactionRates( IR2CTMC_TRANSFORMER *transformer, int state ) {
@@ -689,29 +856,6 @@ static double _GetLevelInSpecies( SPECIES *species ) {
     /*return GetConcentrationInSpeciesNode( species );*/
 }
 
-static int _FindInitialState( IR2CTMC_TRANSFORMER *transformer ) {
-    RET_VAL ret = SUCCESS;
-    int i = 0;
-    int initialLevelIndex = 0;    
-    int multiply = 0;
-    int speciesSize = transformer->speciesSize;
-    int *multiplyArray = transformer->multiplyArray;
-    int initialState = 0;
-    SPECIES_CRITICAL_LEVEL *criticalLevel = NULL;
-    SPECIES_CRITICAL_LEVEL **criticalLevelArray = transformer->criticalLevelArray;
-    
-    for( i = 0; i < speciesSize; i++ ) {
-        criticalLevel = criticalLevelArray[i];
-        initialLevelIndex = criticalLevel->initialLevelIndex;
-        multiply = multiplyArray[i];
-        initialState += (initialLevelIndex * multiply);
-    }
-    return initialState;
-}
-
-
-
-
 static RET_VAL _Print( IR2CTMC_TRANSFORMER *transformer, FILE *file ) {
     RET_VAL ret = SUCCESS;
     int i = 0;
@@ -44,10 +44,21 @@ struct _IR2CTMC_TRANSFORMER {
     SPECIES_CRITICAL_LEVEL **criticalLevelArray;
     int updatedSpeciesSize;
     SPECIES **updatedSpeciesArray;
-    int *multiplyArray;
     int *currentArray;
     double *currentLevelArray;
     int stateSize;
+    int maxStateSize;
+    int stateCapacity;
+    int *stateLevelArray;
+    int stateTableSize;
+    int *stateTable;
+    int transitionSize;
+    int transitionCapacity;
+    int *transitionFromArray;
+    int *transitionToArray;
+    double *transitionRateArray;
+    int currentState;
+    BOOL isExplored;
     KINETIC_LAW_EVALUATER *evaluator;
     
     CTMC *(*Generate)( IR2CTMC_TRANSFORMER *transformer );
@@ -705,7 +705,7 @@ static RET_VAL _PrintConstraintListInXHTML( LINKED_LIST *list, FILE *file ) {
 }
 
 static RET_VAL _PrintEventAssignmentInXHTML( LINKED_LIST *assignments, FILE *file ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     int tabCount = 1;
     EVENT_ASSIGNMENT *assignment;
@@ -714,17 +714,16 @@ static RET_VAL _PrintEventAssignmentInXHTML( LINKED_LIST *assignments, FILE *fil
 
     START_FUNCTION("_PrintMathInXHTML");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToPrintInXHTML;
-        visitor.VisitUnaryOp = _VisitUnaryOpToPrintInXHTML;
-        visitor.VisitOp = _VisitOpToPrintInXHTML;
-        visitor.VisitInt = _VisitIntToPrintInXHTML;
-        visitor.VisitReal = _VisitRealToPrintInXHTML;
-        visitor.VisitFunctionSymbol = _VisitFunctionSymbolToPrintInXHTML;
-        visitor.VisitCompartment = _VisitCompartmentToPrintInXHTML;
-        visitor.VisitSpecies = _VisitSpeciesToPrintInXHTML;
-        visitor.VisitSymbol = _VisitSymbolToPrintInXHTML;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitPW = _VisitPWToPrintInXHTML;
+    visitor.VisitUnaryOp = _VisitUnaryOpToPrintInXHTML;
+    visitor.VisitOp = _VisitOpToPrintInXHTML;
+    visitor.VisitInt = _VisitIntToPrintInXHTML;
+    visitor.VisitReal = _VisitRealToPrintInXHTML;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToPrintInXHTML;
+    visitor.VisitCompartment = _VisitCompartmentToPrintInXHTML;
+    visitor.VisitSpecies = _VisitSpeciesToPrintInXHTML;
+    visitor.VisitSymbol = _VisitSymbolToPrintInXHTML;
     
     visitor._internal1 = (CADDR_T)file;
     visitor._internal2 = (CADDR_T)(&tabCount);
@@ -1060,23 +1059,22 @@ static RET_VAL _PrintSpeciesListInXHTML( LINKED_LIST *list, FILE *file ) {
 }
 
 static RET_VAL _PrintMathInXHTML( KINETIC_LAW *kineticLaw, char * LHS, FILE *file ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     int tabCount = 1;
     
     START_FUNCTION("_PrintMathInXHTML");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToPrintInXHTML;
-        visitor.VisitUnaryOp = _VisitUnaryOpToPrintInXHTML;
-        visitor.VisitOp = _VisitOpToPrintInXHTML;
-        visitor.VisitInt = _VisitIntToPrintInXHTML;
-        visitor.VisitReal = _VisitRealToPrintInXHTML;
-        visitor.VisitFunctionSymbol = _VisitFunctionSymbolToPrintInXHTML;
-        visitor.VisitCompartment = _VisitCompartmentToPrintInXHTML;
-        visitor.VisitSpecies = _VisitSpeciesToPrintInXHTML;
-        visitor.VisitSymbol = _VisitSymbolToPrintInXHTML;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitPW = _VisitPWToPrintInXHTML;
+    visitor.VisitUnaryOp = _VisitUnaryOpToPrintInXHTML;
+    visitor.VisitOp = _VisitOpToPrintInXHTML;
+    visitor.VisitInt = _VisitIntToPrintInXHTML;
+    visitor.VisitReal = _VisitRealToPrintInXHTML;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToPrintInXHTML;
+    visitor.VisitCompartment = _VisitCompartmentToPrintInXHTML;
+    visitor.VisitSpecies = _VisitSpeciesToPrintInXHTML;
+    visitor.VisitSymbol = _VisitSymbolToPrintInXHTML;
     
     visitor._internal1 = (CADDR_T)file;
     visitor._internal2 = (CADDR_T)(&tabCount);
@@ -1114,7 +1112,6 @@ static RET_VAL _PrintMathInXHTML( KINETIC_LAW *kineticLaw, char * LHS, FILE *fil
 }
 
 static RET_VAL _PrintKineticLawInXHTML( KINETIC_LAW *kineticLaw, FILE *file ) {
-    static KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     int tabCount = 1;
     
@@ -48,10 +48,10 @@ static RET_VAL _AcceptForSpeciesKineticLaw( KINETIC_LAW *law, KINETIC_LAW_VISITO
 static RET_VAL _AcceptForSymbolKineticLaw( KINETIC_LAW *law, KINETIC_LAW_VISITOR *visitor );
 static RET_VAL _AcceptForFunctionSymbolKineticLaw( KINETIC_LAW *law, KINETIC_LAW_VISITOR *visitor );
 
+static double _GetDelayHorizon( KINETIC_LAW *delay );
 
-static KINETIC_LAW_VISITOR speciesReplacementVisitor;
 
-static KINETIC_LAW_VISITOR compartmentReplacementVisitor;
+static void _InitSpeciesReplacementVisitor( KINETIC_LAW_VISITOR *visitor );
 
 static RET_VAL _VisitPWToReplaceSpecies( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw );
 static RET_VAL _VisitOpToReplaceSpecies( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw );
@@ -89,7 +89,6 @@ static RET_VAL _VisitSymbolToReplaceConstant( KINETIC_LAW_VISITOR *visitor, KINE
 static RET_VAL _VisitFunctionSymbolToReplaceConstant( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *kineticLaw );
 
 
-static KINETIC_LAW_VISITOR toStringVisitor;
 typedef struct {
     LINKED_LIST *stack;
     BYTE parentOp;
@@ -333,7 +332,11 @@ KINETIC_LAW *CreateDelayKineticLaw( BYTE opType, KINETIC_LAW *left, KINETIC_LAW
     law->value.op.left = left;
     law->value.op.right = right;
     law->value.op.time = time;
-    law->value.op.values = CreateLinkedList();
+    if( ( law->value.op.history = CreateDelayHistory( _GetDelayHorizon( right ) ) ) == NULL ) {
+        FREE( law );
+        END_FUNCTION("CreateOpKineticLaw", FAILING );        
+        return NULL;
+    }
     law->AcceptPostOrder = _AcceptPostOrderForOpKineticLaw;
     law->AcceptPreOrder = _AcceptPreOrderForOpKineticLaw;
     law->AcceptInOrder = _AcceptInOrderForOpKineticLaw;
@@ -343,6 +346,28 @@ KINETIC_LAW *CreateDelayKineticLaw( BYTE opType, KINETIC_LAW *left, KINETIC_LAW
     return law;
 }
 
+/*
+ * The history of a delay node needs to reach back as far as its delay, which is known up 
+ * front only when the delay is a number or a constant parameter.
+ */
+static double _GetDelayHorizon( KINETIC_LAW *delay ) {
+    REB2SAC_SYMBOL *symbol = NULL;
+
+    if( IsIntValueKineticLaw( delay ) ) {
+        return (double)GetIntValueFromKineticLaw( delay );
+    }
+    if( IsRealValueKineticLaw( delay ) ) {
+        return GetRealValueFromKineticLaw( delay );
+    }
+    if( IsSymbolKineticLaw( delay ) ) {
+        symbol = GetSymbolFromKineticLaw( delay );
+        if( IsSymbolConstant( symbol ) && IsRealValueSymbol( symbol ) ) {
+            return GetRealValueInSymbol( symbol );
+        }
+    }
+    return DELAY_HISTORY_UNBOUNDED;
+}
+
 KINETIC_LAW *CreateOpKineticLaw( BYTE opType, KINETIC_LAW *left, KINETIC_LAW *right ) {
     KINETIC_LAW *law = NULL;
     
@@ -363,7 +388,7 @@ KINETIC_LAW *CreateOpKineticLaw( BYTE opType, KINETIC_LAW *left, KINETIC_LAW *ri
     law->value.op.left = left;
     law->value.op.right = right;
     law->value.op.time = NULL;
-    law->value.op.values = NULL;
+    law->value.op.history = NULL;
     law->AcceptPostOrder = _AcceptPostOrderForOpKineticLaw;
     law->AcceptPreOrder = _AcceptPreOrderForOpKineticLaw;
     law->AcceptInOrder = _AcceptInOrderForOpKineticLaw;
@@ -466,7 +491,12 @@ KINETIC_LAW *CloneKineticLaw( KINETIC_LAW *law ) {
         }                        
         clone->value.op.opType = law->value.op.opType;
 	clone->value.op.time = law->value.op.time;
-	clone->value.op.values = law->value.op.values;
+	if( law->value.op.history != NULL ) {
+	    if( ( clone->value.op.history = CreateDelayHistory( law->value.op.history->horizon ) ) == NULL ) {
+	        END_FUNCTION("CloneKineticLaw", FAILING );        
+	        return NULL;
+	    }
+	}
         clone->AcceptPostOrder = _AcceptPostOrderForOpKineticLaw;
         clone->AcceptPreOrder = _AcceptPreOrderForOpKineticLaw;
         clone->AcceptInOrder = _AcceptInOrderForOpKineticLaw;
@@ -1036,7 +1066,7 @@ REB2SAC_SYMBOL *GetTimeFromKineticLaw(KINETIC_LAW *law) {
     return law->value.op.time;
 }
 
-LINKED_LIST *GetValuesFromKineticLaw(KINETIC_LAW *law) {
+DELAY_HISTORY *GetDelayHistoryFromKineticLaw(KINETIC_LAW *law) {
     START_FUNCTION("GetOpTypeFromKineticLaw");
     
     if( law == NULL ) {
@@ -1050,16 +1080,7 @@ LINKED_LIST *GetValuesFromKineticLaw(KINETIC_LAW *law) {
     }
     
     END_FUNCTION("GetOpTypeFromKineticLaw", SUCCESS );        
-    return law->value.op.values;
-}
-
-RET_VAL SetValuesKineticLaw(KINETIC_LAW *law, LINKED_LIST *list) {
-    START_FUNCTION("SetValuesKineticLaw");
-
-    law->value.op.values = list;
-    
-    END_FUNCTION("SetValuesKineticLaw", SUCCESS );        
-    return SUCCESS;
+    return law->value.op.history;
 }
 
 BYTE GetOpTypeFromKineticLaw(KINETIC_LAW *law) {
@@ -1176,6 +1197,7 @@ void FreeKineticLaw(KINETIC_LAW **law) {
     if( (*law)->valueType == KINETIC_LAW_VALUE_TYPE_OP ) {
         FreeKineticLaw( &((*law)->value.op.left) );
         FreeKineticLaw( &((*law)->value.op.right) );
+        FreeDelayHistory( &((*law)->value.op.history) );
     } else if( (*law)->valueType == KINETIC_LAW_VALUE_TYPE_UNARY_OP ) {
         FreeKineticLaw( &((*law)->value.unaryOp.child) );
     } else if( (*law)->valueType == KINETIC_LAW_VALUE_TYPE_PW ) {
@@ -1188,26 +1210,18 @@ void FreeKineticLaw(KINETIC_LAW **law) {
 
 
 RET_VAL ReplaceSpeciesWithIntInKineticLaw( KINETIC_LAW *law, SPECIES *from, long to ) {
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     
     START_FUNCTION("ReplaceSpeciesWithIntInKineticLaw");
     
-    if( speciesReplacementVisitor.VisitOp == NULL ) {
-        speciesReplacementVisitor.VisitPW = _VisitPWToReplaceSpecies;
-        speciesReplacementVisitor.VisitOp = _VisitOpToReplaceSpecies;
-        speciesReplacementVisitor.VisitUnaryOp = _VisitUnaryOpToReplaceSpecies;
-        speciesReplacementVisitor.VisitInt = _VisitIntToReplaceSpecies;
-        speciesReplacementVisitor.VisitReal = _VisitRealToReplaceSpecies;
-        speciesReplacementVisitor.VisitSymbol = _VisitSymbolToReplaceSpecies;
-        speciesReplacementVisitor.VisitCompartment = _VisitCompartmentToReplaceSpecies;
-        speciesReplacementVisitor.VisitFunctionSymbol = _VisitFunctionSymbolToReplaceSpecies;
-    }
-    speciesReplacementVisitor.VisitSpecies = _VisitSpeciesToReplaceSpeciesWithInt;
+    _InitSpeciesReplacementVisitor( &visitor );
+    visitor.VisitSpecies = _VisitSpeciesToReplaceSpeciesWithInt;
     
-    speciesReplacementVisitor._internal1 = (CADDR_T)(&to);
-    speciesReplacementVisitor._internal2 = (CADDR_T)from;
+    visitor._internal1 = (CADDR_T)(&to);
+    visitor._internal2 = (CADDR_T)from;
     
-    if( IS_FAILED( ( ret = law->AcceptPostOrder( law, &speciesReplacementVisitor ) ) ) ) {
+    if( IS_FAILED( ( ret = law->AcceptPostOrder( law, &visitor ) ) ) ) {
         END_FUNCTION("ReplaceSpeciesWithIntInKineticLaw", ret );
         return ret;        
     }
@@ -1217,27 +1231,19 @@ RET_VAL ReplaceSpeciesWithIntInKineticLaw( KINETIC_LAW *law, SPECIES *from, long
 }
 
 RET_VAL ReplaceSpeciesWithRealInKineticLaw( KINETIC_LAW *law, SPECIES *from, double to ) {
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     
     START_FUNCTION("ReplaceSpeciesWithRealInKineticLaw");
     
-    if( speciesReplacementVisitor.VisitOp == NULL ) {
-        speciesReplacementVisitor.VisitPW = _VisitPWToReplaceSpecies;
-        speciesReplacementVisitor.VisitOp = _VisitOpToReplaceSpecies;
-        speciesReplacementVisitor.VisitUnaryOp = _VisitUnaryOpToReplaceSpecies;
-        speciesReplacementVisitor.VisitInt = _VisitIntToReplaceSpecies;
-        speciesReplacementVisitor.VisitReal = _VisitRealToReplaceSpecies;
-        speciesReplacementVisitor.VisitSymbol = _VisitSymbolToReplaceSpecies;
-        speciesReplacementVisitor.VisitCompartment = _VisitCompartmentToReplaceSpecies;
-        speciesReplacementVisitor.VisitFunctionSymbol = _VisitFunctionSymbolToReplaceSpecies;
-    }
-    speciesReplacementVisitor.VisitSpecies = _VisitSpeciesToReplaceSpeciesWithReal;
+    _InitSpeciesReplacementVisitor( &visitor );
+    visitor.VisitSpecies = _VisitSpeciesToReplaceSpeciesWithReal;
     
     TRACE_2( "replacing %s with %f", GetCharArrayOfString( GetSpeciesNodeID( from ) ), to );
-    speciesReplacementVisitor._internal1 = (CADDR_T)(&to);
-    speciesReplacementVisitor._internal2 = (CADDR_T)from;
+    visitor._internal1 = (CADDR_T)(&to);
+    visitor._internal2 = (CADDR_T)from;
     
-    if( IS_FAILED( ( ret = law->AcceptPostOrder( law, &speciesReplacementVisitor ) ) ) ) {
+    if( IS_FAILED( ( ret = law->AcceptPostOrder( law, &visitor ) ) ) ) {
         END_FUNCTION("ReplaceSpeciesWithRealInKineticLaw", ret );
         return ret;        
     }
@@ -1247,26 +1253,18 @@ RET_VAL ReplaceSpeciesWithRealInKineticLaw( KINETIC_LAW *law, SPECIES *from, dou
 }
 
 RET_VAL ReplaceSpeciesWithKineticLawInKineticLaw( KINETIC_LAW *law, SPECIES *from, KINETIC_LAW * to ) {
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     
     START_FUNCTION("ReplaceSpeciesWithKineticLawInKineticLaw");
     
-    if( speciesReplacementVisitor.VisitOp == NULL ) {
-        speciesReplacementVisitor.VisitPW = _VisitPWToReplaceSpecies;
-        speciesReplacementVisitor.VisitOp = _VisitOpToReplaceSpecies;
-        speciesReplacementVisitor.VisitUnaryOp = _VisitUnaryOpToReplaceSpecies;
-        speciesReplacementVisitor.VisitInt = _VisitIntToReplaceSpecies;
-        speciesReplacementVisitor.VisitReal = _VisitRealToReplaceSpecies;
-        speciesReplacementVisitor.VisitSymbol = _VisitSymbolToReplaceSpecies;
-        speciesReplacementVisitor.VisitCompartment = _VisitCompartmentToReplaceSpecies;
-        speciesReplacementVisitor.VisitFunctionSymbol = _VisitFunctionSymbolToReplaceSpecies;
-    }
-    speciesReplacementVisitor.VisitSpecies = _VisitSpeciesToReplaceSpeciesWithKineticLaw;
+    _InitSpeciesReplacementVisitor( &visitor );
+    visitor.VisitSpecies = _VisitSpeciesToReplaceSpeciesWithKineticLaw;
     
-    speciesReplacementVisitor._internal1 = (CADDR_T)(to);
-    speciesReplacementVisitor._internal2 = (CADDR_T)from;
+    visitor._internal1 = (CADDR_T)(to);
+    visitor._internal2 = (CADDR_T)from;
     
-    if( IS_FAILED( ( ret = law->AcceptPostOrder( law, &speciesReplacementVisitor ) ) ) ) {
+    if( IS_FAILED( ( ret = law->AcceptPostOrder( law, &visitor ) ) ) ) {
         END_FUNCTION("ReplaceSpeciesWithKineticLawInKineticLaw", ret );
         return ret;        
     }
@@ -1276,26 +1274,19 @@ RET_VAL ReplaceSpeciesWithKineticLawInKineticLaw( KINETIC_LAW *law, SPECIES *fro
 }
 
 RET_VAL ReplaceFunctionSymbolWithKineticLawInKineticLaw( KINETIC_LAW *law, char *from, KINETIC_LAW * to ) {
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     
     START_FUNCTION("ReplaceFunctionSymbolWithKineticLawInKineticLaw");
     
-    if( speciesReplacementVisitor.VisitOp == NULL ) {
-        speciesReplacementVisitor.VisitPW = _VisitPWToReplaceSpecies;
-        speciesReplacementVisitor.VisitOp = _VisitOpToReplaceSpecies;
-        speciesReplacementVisitor.VisitUnaryOp = _VisitUnaryOpToReplaceSpecies;
-        speciesReplacementVisitor.VisitInt = _VisitIntToReplaceSpecies;
-        speciesReplacementVisitor.VisitReal = _VisitRealToReplaceSpecies;
-        speciesReplacementVisitor.VisitSymbol = _VisitSymbolToReplaceSpecies;
-        speciesReplacementVisitor.VisitCompartment = _VisitCompartmentToReplaceSpecies;
-        speciesReplacementVisitor.VisitSpecies = _VisitSpeciesToReplaceConstant;
-    }
-    speciesReplacementVisitor.VisitFunctionSymbol = _VisitFunctionSymbolToReplaceWithKineticLaw;
+    _InitSpeciesReplacementVisitor( &visitor );
+    visitor.VisitSpecies = _VisitSpeciesToReplaceConstant;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToReplaceWithKineticLaw;
     
-    speciesReplacementVisitor._internal1 = (CADDR_T)(to);
-    speciesReplacementVisitor._internal2 = (CADDR_T)from;
+    visitor._internal1 = (CADDR_T)(to);
+    visitor._internal2 = (CADDR_T)from;
     
-    if( IS_FAILED( ( ret = law->AcceptPostOrder( law, &speciesReplacementVisitor ) ) ) ) {
+    if( IS_FAILED( ( ret = law->AcceptPostOrder( law, &visitor ) ) ) ) {
         END_FUNCTION("ReplaceSpeciesWithKineticLawInKineticLaw", ret );
         return ret;        
     }
@@ -1306,24 +1297,34 @@ RET_VAL ReplaceFunctionSymbolWithKineticLawInKineticLaw( KINETIC_LAW *law, char
 
 
 
+static void _InitSpeciesReplacementVisitor( KINETIC_LAW_VISITOR *visitor ) {
+    memset( visitor, 0, sizeof(KINETIC_LAW_VISITOR) );
+    visitor->VisitPW = _VisitPWToReplaceSpecies;
+    visitor->VisitOp = _VisitOpToReplaceSpecies;
+    visitor->VisitUnaryOp = _VisitUnaryOpToReplaceSpecies;
+    visitor->VisitInt = _VisitIntToReplaceSpecies;
+    visitor->VisitReal = _VisitRealToReplaceSpecies;
+    visitor->VisitSymbol = _VisitSymbolToReplaceSpecies;
+    visitor->VisitCompartment = _VisitCompartmentToReplaceSpecies;
+    visitor->VisitFunctionSymbol = _VisitFunctionSymbolToReplaceSpecies;
+}
+
 RET_VAL ReplaceConstantWithAnotherConstantInKineticLaw( KINETIC_LAW *law, double from, double to ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
         
     START_FUNCTION("ReplaceConstantWithAnotherConstantInKineticLaw");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToReplaceConstant;
-        visitor.VisitOp = _VisitOpToReplaceConstant;
-        visitor.VisitUnaryOp = _VisitUnaryOpToReplaceConstant;
-        visitor.VisitInt = _VisitIntToReplaceConstant;
-        visitor.VisitReal = _VisitRealToReplaceConstant;
-        visitor.VisitSpecies = _VisitSpeciesToReplaceConstant;
-        visitor.VisitCompartment = _VisitCompartmentToReplaceConstant;
-        visitor.VisitSymbol = _VisitSymbolToReplaceConstant;
-        speciesReplacementVisitor.VisitCompartment = _VisitCompartmentToReplaceSpecies;
-        visitor.VisitFunctionSymbol = _VisitFunctionSymbolToReplaceConstant;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitPW = _VisitPWToReplaceConstant;
+    visitor.VisitOp = _VisitOpToReplaceConstant;
+    visitor.VisitUnaryOp = _VisitUnaryOpToReplaceConstant;
+    visitor.VisitInt = _VisitIntToReplaceConstant;
+    visitor.VisitReal = _VisitRealToReplaceConstant;
+    visitor.VisitSpecies = _VisitSpeciesToReplaceConstant;
+    visitor.VisitCompartment = _VisitCompartmentToReplaceConstant;
+    visitor.VisitSymbol = _VisitSymbolToReplaceConstant;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToReplaceConstant;
     
     visitor._internal1 = (CADDR_T)(&from);
     visitor._internal2 = (CADDR_T)(&to);
@@ -2056,21 +2057,21 @@ static RET_VAL _AcceptForFunctionSymbolKineticLaw( KINETIC_LAW *law, KINETIC_LAW
 
 STRING *ToStringKineticLaw( KINETIC_LAW *law ) {
     STRING *string = NULL;
+    KINETIC_LAW_VISITOR toStringVisitor;
     TO_STRING_VISITOR_INTERNAL internal;
     
     START_FUNCTION("ToStringKineticLaw");
     
-    if( toStringVisitor.VisitOp == NULL ) {
-        toStringVisitor.VisitPW = _VisitPWToString;
-        toStringVisitor.VisitOp = _VisitOpToString;
-        toStringVisitor.VisitUnaryOp = _VisitUnaryOpToString;
-        toStringVisitor.VisitInt = _VisitIntToString;
-        toStringVisitor.VisitReal = _VisitRealToString;
-        toStringVisitor.VisitCompartment = _VisitCompartmentToString;
-        toStringVisitor.VisitSpecies = _VisitSpeciesToString;
-        toStringVisitor.VisitSymbol = _VisitSymbolToString;
-        toStringVisitor.VisitFunctionSymbol = _VisitFunctionSymbolToString;
-    }
+    memset( &toStringVisitor, 0, sizeof(toStringVisitor) );
+    toStringVisitor.VisitPW = _VisitPWToString;
+    toStringVisitor.VisitOp = _VisitOpToString;
+    toStringVisitor.VisitUnaryOp = _VisitUnaryOpToString;
+    toStringVisitor.VisitInt = _VisitIntToString;
+    toStringVisitor.VisitReal = _VisitRealToString;
+    toStringVisitor.VisitCompartment = _VisitCompartmentToString;
+    toStringVisitor.VisitSpecies = _VisitSpeciesToString;
+    toStringVisitor.VisitSymbol = _VisitSymbolToString;
+    toStringVisitor.VisitFunctionSymbol = _VisitFunctionSymbolToString;
     if( ( internal.stack = CreateLinkedList() ) == NULL ) {
         END_FUNCTION("ToStringKineticLaw", FAILING );
         return NULL;        
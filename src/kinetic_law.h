@@ -26,6 +26,7 @@
 #include "species_node.h"
 #include "symtab.h"
 #include "random_number_generator.h"
+#include "delay_history.h"
 
 BEGIN_C_NAMESPACE
 
@@ -149,7 +150,7 @@ struct _KINETIC_LAW_OP {
     struct _KINETIC_LAW *left;
     struct _KINETIC_LAW *right;
     REB2SAC_SYMBOL *time;
-    LINKED_LIST *values;
+    DELAY_HISTORY *history;
 };
 
 struct _KINETIC_LAW_UNARY_OP {
@@ -218,7 +219,6 @@ RET_VAL SetFunctionSymbolKineticLaw( KINETIC_LAW *law, char *funcSymbol );
 RET_VAL SetPWKineticLaw( KINETIC_LAW *law, BYTE opType, LINKED_LIST *children );
 RET_VAL SetOpKineticLaw( KINETIC_LAW *law, BYTE opType, KINETIC_LAW *left, KINETIC_LAW *right );
 RET_VAL SetUnaryOpKineticLaw( KINETIC_LAW *law, BYTE opType, KINETIC_LAW *child );
-RET_VAL SetValuesKineticLaw(KINETIC_LAW *law, LINKED_LIST *list);
 
 BOOL IsIntValueKineticLaw(KINETIC_LAW *law);
 BOOL IsRealValueKineticLaw(KINETIC_LAW *law);
@@ -239,7 +239,7 @@ REB2SAC_SYMBOL *GetSymbolFromKineticLaw(KINETIC_LAW *law);
 char *GetFunctionSymbolFromKineticLaw(KINETIC_LAW *law);
 BYTE GetPWTypeFromKineticLaw(KINETIC_LAW *law);
 REB2SAC_SYMBOL *GetTimeFromKineticLaw(KINETIC_LAW *law);
-LINKED_LIST *GetValuesFromKineticLaw(KINETIC_LAW *law);
+DELAY_HISTORY *GetDelayHistoryFromKineticLaw(KINETIC_LAW *law);
 BYTE GetOpTypeFromKineticLaw(KINETIC_LAW *law);
 BYTE GetUnaryOpTypeFromKineticLaw(KINETIC_LAW *law);
 LINKED_LIST *GetPWChildrenFromKineticLaw(KINETIC_LAW *law);
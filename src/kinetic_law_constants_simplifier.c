@@ -100,7 +100,7 @@ static RET_VAL _ApplyKineticLawConstantsSimplifierMethod( ABSTRACTION_METHOD *me
 }      
 
 RET_VAL SimplifyInitialAssignment( KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;    
 #ifdef DEBUG
     STRING *kineticLawString = NULL;
@@ -108,16 +108,15 @@ RET_VAL SimplifyInitialAssignment( KINETIC_LAW *kineticLaw ) {
 
     START_FUNCTION("_SimplifyInitialAssignment");
 
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToSimplifyInitial;
-        visitor.VisitOp = _VisitOpToSimplifyInitial;
-        visitor.VisitUnaryOp = _VisitUnaryOpToSimplifyInitial;
-        visitor.VisitInt = _VisitIntToSimplify;
-        visitor.VisitReal = _VisitRealToSimplify;
-        visitor.VisitSpecies = _VisitSpeciesToSimplify;
-        visitor.VisitCompartment = _VisitCompartmentToSimplify;
-        visitor.VisitSymbol = _VisitSymbolToSimplify;
-    }    
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitPW = _VisitPWToSimplifyInitial;
+    visitor.VisitOp = _VisitOpToSimplifyInitial;
+    visitor.VisitUnaryOp = _VisitUnaryOpToSimplifyInitial;
+    visitor.VisitInt = _VisitIntToSimplify;
+    visitor.VisitReal = _VisitRealToSimplify;
+    visitor.VisitSpecies = _VisitSpeciesToSimplify;
+    visitor.VisitCompartment = _VisitCompartmentToSimplify;
+    visitor.VisitSymbol = _VisitSymbolToSimplify;
 
     if( IS_FAILED( ( ret = kineticLaw->Accept( kineticLaw, &visitor ) ) ) ) {    
         END_FUNCTION("_SimplifyInitialAssignment", ret );
@@ -132,8 +131,36 @@ RET_VAL SimplifyInitialAssignment( KINETIC_LAW *kineticLaw ) {
     return ret;
 }
 
+/*
+ * Folds the subexpressions of kineticLaw whose operands are numbers or constant 
+ * symbols.  Species and non-constant symbols are left in place.
+ */
+RET_VAL SimplifyConstantsInKineticLaw( KINETIC_LAW *kineticLaw ) {
+    KINETIC_LAW_VISITOR visitor;
+    RET_VAL ret = SUCCESS;    
+
+    START_FUNCTION("SimplifyConstantsInKineticLaw");
+
+    visitor.VisitPW = _VisitPWToSimplifyKineticLaw;
+    visitor.VisitOp = _VisitOpToSimplifyKineticLaw;
+    visitor.VisitUnaryOp = _VisitUnaryOpToSimplifyKineticLaw;
+    visitor.VisitInt = _VisitIntToSimplifyKineticLaw;
+    visitor.VisitReal = _VisitRealToSimplifyKineticLaw;
+    visitor.VisitSpecies = _VisitSpeciesToSimplifyKineticLaw;
+    visitor.VisitCompartment = _VisitCompartmentToSimplifyKineticLaw;
+    visitor.VisitSymbol = _VisitSymbolToSimplifyKineticLaw;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToSimplifyKineticLaw;
+
+    if( IS_FAILED( ( ret = kineticLaw->Accept( kineticLaw, &visitor ) ) ) ) {    
+        END_FUNCTION("SimplifyConstantsInKineticLaw", ret );
+        return ret;
+    }     
+    END_FUNCTION("SimplifyConstantsInKineticLaw", SUCCESS );
+    return ret;
+}
+
 static RET_VAL _SimplifyKineticLaw( ABSTRACTION_METHOD *method, IR *ir, REACTION *reaction ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;    
     KINETIC_LAW *kineticLaw = NULL;
 #ifdef DEBUG
@@ -142,17 +169,16 @@ static RET_VAL _SimplifyKineticLaw( ABSTRACTION_METHOD *method, IR *ir, REACTION
 
     START_FUNCTION("_SimplifyKineticLaw");
 
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToSimplifyKineticLaw;
-        visitor.VisitOp = _VisitOpToSimplifyKineticLaw;
-        visitor.VisitUnaryOp = _VisitUnaryOpToSimplifyKineticLaw;
-        visitor.VisitInt = _VisitIntToSimplifyKineticLaw;
-        visitor.VisitReal = _VisitRealToSimplifyKineticLaw;
-        visitor.VisitSpecies = _VisitSpeciesToSimplifyKineticLaw;
-        visitor.VisitCompartment = _VisitCompartmentToSimplifyKineticLaw;
-        visitor.VisitSymbol = _VisitSymbolToSimplifyKineticLaw;
-        visitor.VisitFunctionSymbol = _VisitFunctionSymbolToSimplifyKineticLaw;
-    }    
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitPW = _VisitPWToSimplifyKineticLaw;
+    visitor.VisitOp = _VisitOpToSimplifyKineticLaw;
+    visitor.VisitUnaryOp = _VisitUnaryOpToSimplifyKineticLaw;
+    visitor.VisitInt = _VisitIntToSimplifyKineticLaw;
+    visitor.VisitReal = _VisitRealToSimplifyKineticLaw;
+    visitor.VisitSpecies = _VisitSpeciesToSimplifyKineticLaw;
+    visitor.VisitCompartment = _VisitCompartmentToSimplifyKineticLaw;
+    visitor.VisitSymbol = _VisitSymbolToSimplifyKineticLaw;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToSimplifyKineticLaw;
 
     kineticLaw = GetKineticLawInReactionNode( reaction );
     /*
@@ -0,0 +1,519 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the reb2sac contributors                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#include "kinetic_law_derivative.h"
+
+static KINETIC_LAW *_Differentiate( KINETIC_LAW *law, SPECIES *species );
+static KINETIC_LAW *_DifferentiatePW( KINETIC_LAW *law, SPECIES *species );
+static KINETIC_LAW *_DifferentiateOp( KINETIC_LAW *law, SPECIES *species );
+static KINETIC_LAW *_DifferentiateUnaryOp( KINETIC_LAW *law, SPECIES *species );
+
+static KINETIC_LAW *_Constant( double value );
+static KINETIC_LAW *_Add( KINETIC_LAW *left, KINETIC_LAW *right );
+static KINETIC_LAW *_Subtract( KINETIC_LAW *left, KINETIC_LAW *right );
+static KINETIC_LAW *_Multiply( KINETIC_LAW *left, KINETIC_LAW *right );
+static KINETIC_LAW *_Divide( KINETIC_LAW *left, KINETIC_LAW *right );
+static KINETIC_LAW *_Power( KINETIC_LAW *left, KINETIC_LAW *right );
+static KINETIC_LAW *_Negate( KINETIC_LAW *child );
+static KINETIC_LAW *_Apply( BYTE opType, KINETIC_LAW *child );
+static KINETIC_LAW *_Square( KINETIC_LAW *law );
+static BOOL _IsOneKineticLaw( KINETIC_LAW *law );
+
+
+KINETIC_LAW *CreateDerivativeOfKineticLaw( KINETIC_LAW *law, SPECIES *species ) {
+    KINETIC_LAW *derivative = NULL;
+
+    START_FUNCTION("CreateDerivativeOfKineticLaw");
+
+    if( ( law == NULL ) || ( species == NULL ) ) {
+        END_FUNCTION("CreateDerivativeOfKineticLaw", FAILING );
+        return NULL;
+    }
+    if( ( derivative = _Differentiate( law, species ) ) == NULL ) {
+        TRACE_1( "could not differentiate with respect to %s", GetCharArrayOfString( GetSpeciesNodeID( species ) ) );
+        END_FUNCTION("CreateDerivativeOfKineticLaw", FAILING );
+        return NULL;
+    }
+    if( IS_FAILED( SimplifyConstantsInKineticLaw( derivative ) ) ) {
+        FreeKineticLaw( &derivative );
+        END_FUNCTION("CreateDerivativeOfKineticLaw", FAILING );
+        return NULL;
+    }
+
+    END_FUNCTION("CreateDerivativeOfKineticLaw", SUCCESS );
+    return derivative;
+}
+
+BOOL IsZeroKineticLaw( KINETIC_LAW *law ) {
+    if( IsRealValueKineticLaw( law ) ) {
+        return ( GetRealValueFromKineticLaw( law ) == 0.0 ) ? TRUE : FALSE;
+    }
+    if( IsIntValueKineticLaw( law ) ) {
+        return ( GetIntValueFromKineticLaw( law ) == 0 ) ? TRUE : FALSE;
+    }
+    return FALSE;
+}
+
+
+static KINETIC_LAW *_Differentiate( KINETIC_LAW *law, SPECIES *species ) {
+    switch( law->valueType ) {
+        case KINETIC_LAW_VALUE_TYPE_SPECIES:
+            return _Constant( ( GetSpeciesFromKineticLaw( law ) == species ) ? 1.0 : 0.0 );
+
+        case KINETIC_LAW_VALUE_TYPE_PW:
+            return _DifferentiatePW( law, species );
+
+        case KINETIC_LAW_VALUE_TYPE_OP:
+            return _DifferentiateOp( law, species );
+
+        case KINETIC_LAW_VALUE_TYPE_UNARY_OP:
+            return _DifferentiateUnaryOp( law, species );
+
+        default:
+            return _Constant( 0.0 );
+    }
+}
+
+/*
+ * The derivative of a piecewise function keeps the conditions and differentiates 
+ * the pieces.  The logical forms are piecewise constant.
+ */
+static KINETIC_LAW *_DifferentiatePW( KINETIC_LAW *law, SPECIES *species ) {
+    UINT32 i = 0;
+    UINT32 num = 0;
+    BOOL isZero = TRUE;
+    LINKED_LIST *children = NULL;
+    LINKED_LIST *derivatives = NULL;
+    KINETIC_LAW *child = NULL;
+    KINETIC_LAW *derivative = NULL;
+
+    if( GetPWTypeFromKineticLaw( law ) != KINETIC_LAW_OP_PW ) {
+        return _Constant( 0.0 );
+    }
+    if( ( derivatives = CreateLinkedList() ) == NULL ) {
+        return NULL;
+    }
+    children = GetPWChildrenFromKineticLaw( law );
+    num = GetLinkedListSize( children );
+    for( i = 0; i < num; i++ ) {
+        child = (KINETIC_LAW*)GetElementByIndex( i, children );
+        if( ( i % 2 ) == 0 ) {
+            derivative = _Differentiate( child, species );
+            if( ( derivative != NULL ) && !IsZeroKineticLaw( derivative ) ) {
+                isZero = FALSE;
+            }
+        }
+        else {
+            derivative = CloneKineticLaw( child );
+        }
+        if( ( derivative == NULL ) || IS_FAILED( AddElementInLinkedList( (CADDR_T)derivative, derivatives ) ) ) {
+            FreeKineticLaw( &derivative );
+            ResetCurrentElement( derivatives );
+            while( ( child = (KINETIC_LAW*)GetNextFromLinkedList( derivatives ) ) != NULL ) {
+                FreeKineticLaw( &child );
+            }
+            DeleteLinkedList( &derivatives );
+            return NULL;
+        }
+    }
+    if( isZero ) {
+        ResetCurrentElement( derivatives );
+        while( ( child = (KINETIC_LAW*)GetNextFromLinkedList( derivatives ) ) != NULL ) {
+            FreeKineticLaw( &child );
+        }
+        DeleteLinkedList( &derivatives );
+        return _Constant( 0.0 );
+    }
+    return CreatePWKineticLaw( KINETIC_LAW_OP_PW, derivatives );
+}
+
+static KINETIC_LAW *_DifferentiateOp( KINETIC_LAW *law, SPECIES *species ) {
+    BYTE opType = GetOpTypeFromKineticLaw( law );
+    KINETIC_LAW *left = GetOpLeftFromKineticLaw( law );
+    KINETIC_LAW *right = GetOpRightFromKineticLaw( law );
+    KINETIC_LAW *dLeft = NULL;
+    KINETIC_LAW *dRight = NULL;
+    KINETIC_LAW *rewritten = NULL;
+    KINETIC_LAW *derivative = NULL;
+
+    if( opType == KINETIC_LAW_OP_DELAY ) {
+        /* a delayed value does not depend on the current state */
+        return _Constant( 0.0 );
+    }
+    if( ( dLeft = _Differentiate( left, species ) ) == NULL ) {
+        return NULL;
+    }
+    if( ( dRight = _Differentiate( right, species ) ) == NULL ) {
+        FreeKineticLaw( &dLeft );
+        return NULL;
+    }
+    if( IsZeroKineticLaw( dLeft ) && IsZeroKineticLaw( dRight ) ) {
+        FreeKineticLaw( &dRight );
+        return dLeft;
+    }
+
+    switch( opType ) {
+        case KINETIC_LAW_OP_PLUS:
+            return _Add( dLeft, dRight );
+
+        case KINETIC_LAW_OP_MINUS:
+            return _Subtract( dLeft, dRight );
+
+        case KINETIC_LAW_OP_TIMES:
+            return _Add( _Multiply( dLeft, CloneKineticLaw( right ) ), 
+                         _Multiply( CloneKineticLaw( left ), dRight ) );
+
+        case KINETIC_LAW_OP_DIVIDE:
+            return _Subtract( _Divide( dLeft, CloneKineticLaw( right ) ), 
+                              _Divide( _Multiply( CloneKineticLaw( left ), dRight ), _Square( CloneKineticLaw( right ) ) ) );
+
+        case KINETIC_LAW_OP_POW:
+            if( IsZeroKineticLaw( dRight ) ) {
+                FreeKineticLaw( &dRight );
+                return _Multiply( _Multiply( CloneKineticLaw( right ), 
+                                             _Power( CloneKineticLaw( left ), _Subtract( CloneKineticLaw( right ), _Constant( 1.0 ) ) ) ), 
+                                  dLeft );
+            }
+            /* d(u^v) = u^v * ( v' ln(u) + v u' / u ) */
+            return _Multiply( CloneKineticLaw( law ), 
+                              _Add( _Multiply( dRight, _Apply( KINETIC_LAW_UNARY_OP_LN, CloneKineticLaw( left ) ) ), 
+                                    _Divide( _Multiply( CloneKineticLaw( right ), dLeft ), CloneKineticLaw( left ) ) ) );
+
+        case KINETIC_LAW_OP_ROOT:
+            /* root(n, x) = x^(1/n) */
+            FreeKineticLaw( &dLeft );
+            FreeKineticLaw( &dRight );
+            if( ( rewritten = _Power( CloneKineticLaw( right ), _Divide( _Constant( 1.0 ), CloneKineticLaw( left ) ) ) ) == NULL ) {
+                return NULL;
+            }
+            derivative = _Differentiate( rewritten, species );
+            FreeKineticLaw( &rewritten );
+            return derivative;
+
+        case KINETIC_LAW_OP_LOG:
+            /* log(b, x) = ln(x) / ln(b) */
+            FreeKineticLaw( &dLeft );
+            FreeKineticLaw( &dRight );
+            if( ( rewritten = _Divide( _Apply( KINETIC_LAW_UNARY_OP_LN, CloneKineticLaw( right ) ), 
+                                       _Apply( KINETIC_LAW_UNARY_OP_LN, CloneKineticLaw( left ) ) ) ) == NULL ) {
+                return NULL;
+            }
+            derivative = _Differentiate( rewritten, species );
+            FreeKineticLaw( &rewritten );
+            return derivative;
+
+        case KINETIC_LAW_OP_AND:
+        case KINETIC_LAW_OP_OR:
+        case KINETIC_LAW_OP_XOR:
+        case KINETIC_LAW_OP_EQ:
+        case KINETIC_LAW_OP_NEQ:
+        case KINETIC_LAW_OP_GEQ:
+        case KINETIC_LAW_OP_GT:
+        case KINETIC_LAW_OP_LEQ:
+        case KINETIC_LAW_OP_LT:
+        case KINETIC_LAW_OP_BITWISE_AND:
+        case KINETIC_LAW_OP_BITWISE_OR:
+        case KINETIC_LAW_OP_BITWISE_XOR:
+        case KINETIC_LAW_OP_MOD:
+        case KINETIC_LAW_OP_BIT:
+            FreeKineticLaw( &dLeft );
+            FreeKineticLaw( &dRight );
+            return _Constant( 0.0 );
+
+        default:
+            TRACE_1( "operator %c cannot be differentiated", opType );
+            FreeKineticLaw( &dLeft );
+            FreeKineticLaw( &dRight );
+            return NULL;
+    }
+}
+
+static KINETIC_LAW *_DifferentiateUnaryOp( KINETIC_LAW *law, SPECIES *species ) {
+    BYTE opType = GetUnaryOpTypeFromKineticLaw( law );
+    KINETIC_LAW *child = GetUnaryOpChildFromKineticLaw( law );
+    KINETIC_LAW *dChild = NULL;
+    KINETIC_LAW *negative = NULL;
+    KINETIC_LAW *condition = NULL;
+    LINKED_LIST *pieces = NULL;
+
+    if( ( dChild = _Differentiate( child, species ) ) == NULL ) {
+        return NULL;
+    }
+    if( IsZeroKineticLaw( dChild ) ) {
+        return dChild;
+    }
+
+    switch( opType ) {
+        case KINETIC_LAW_UNARY_OP_NEG:
+            return _Negate( dChild );
+
+        case KINETIC_LAW_UNARY_OP_EXP:
+            return _Multiply( CloneKineticLaw( law ), dChild );
+
+        case KINETIC_LAW_UNARY_OP_LN:
+            return _Divide( dChild, CloneKineticLaw( child ) );
+
+        case KINETIC_LAW_UNARY_OP_ABS:
+            /* piecewise( -u', u < 0, u' ) */
+            negative = _Negate( CloneKineticLaw( dChild ) );
+            condition = CreateOpKineticLaw( KINETIC_LAW_OP_LT, CloneKineticLaw( child ), _Constant( 0.0 ) );
+            if( ( negative == NULL ) || ( condition == NULL ) || ( ( pieces = CreateLinkedList() ) == NULL ) ||
+                IS_FAILED( AddElementInLinkedList( (CADDR_T)negative, pieces ) ) ||
+                IS_FAILED( AddElementInLinkedList( (CADDR_T)condition, pieces ) ) ||
+                IS_FAILED( AddElementInLinkedList( (CADDR_T)dChild, pieces ) ) ) {
+                FreeKineticLaw( &negative );
+                FreeKineticLaw( &condition );
+                FreeKineticLaw( &dChild );
+                DeleteLinkedList( &pieces );
+                return NULL;
+            }
+            return CreatePWKineticLaw( KINETIC_LAW_OP_PW, pieces );
+
+        case KINETIC_LAW_UNARY_OP_SIN:
+            return _Multiply( _Apply( KINETIC_LAW_UNARY_OP_COS, CloneKineticLaw( child ) ), dChild );
+
+        case KINETIC_LAW_UNARY_OP_COS:
+            return _Negate( _Multiply( _Apply( KINETIC_LAW_UNARY_OP_SIN, CloneKineticLaw( child ) ), dChild ) );
+
+        case KINETIC_LAW_UNARY_OP_TAN:
+            return _Divide( dChild, _Square( _Apply( KINETIC_LAW_UNARY_OP_COS, CloneKineticLaw( child ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_COT:
+            return _Negate( _Divide( dChild, _Square( _Apply( KINETIC_LAW_UNARY_OP_SIN, CloneKineticLaw( child ) ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_SEC:
+            return _Divide( _Multiply( _Apply( KINETIC_LAW_UNARY_OP_SIN, CloneKineticLaw( child ) ), dChild ), 
+                            _Square( _Apply( KINETIC_LAW_UNARY_OP_COS, CloneKineticLaw( child ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_CSC:
+            return _Negate( _Divide( _Multiply( _Apply( KINETIC_LAW_UNARY_OP_COS, CloneKineticLaw( child ) ), dChild ), 
+                                     _Square( _Apply( KINETIC_LAW_UNARY_OP_SIN, CloneKineticLaw( child ) ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_SINH:
+            return _Multiply( _Apply( KINETIC_LAW_UNARY_OP_COSH, CloneKineticLaw( child ) ), dChild );
+
+        case KINETIC_LAW_UNARY_OP_COSH:
+            return _Multiply( _Apply( KINETIC_LAW_UNARY_OP_SINH, CloneKineticLaw( child ) ), dChild );
+
+        case KINETIC_LAW_UNARY_OP_TANH:
+            return _Divide( dChild, _Square( _Apply( KINETIC_LAW_UNARY_OP_COSH, CloneKineticLaw( child ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_COTH:
+            return _Negate( _Divide( dChild, _Square( _Apply( KINETIC_LAW_UNARY_OP_SINH, CloneKineticLaw( child ) ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_SECH:
+            return _Negate( _Divide( _Multiply( _Apply( KINETIC_LAW_UNARY_OP_SINH, CloneKineticLaw( child ) ), dChild ), 
+                                     _Square( _Apply( KINETIC_LAW_UNARY_OP_COSH, CloneKineticLaw( child ) ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_CSCH:
+            return _Negate( _Divide( _Multiply( _Apply( KINETIC_LAW_UNARY_OP_COSH, CloneKineticLaw( child ) ), dChild ), 
+                                     _Square( _Apply( KINETIC_LAW_UNARY_OP_SINH, CloneKineticLaw( child ) ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_ARCSIN:
+            return _Divide( dChild, _Power( _Subtract( _Constant( 1.0 ), _Square( CloneKineticLaw( child ) ) ), _Constant( 0.5 ) ) );
+
+        case KINETIC_LAW_UNARY_OP_ARCCOS:
+            return _Negate( _Divide( dChild, _Power( _Subtract( _Constant( 1.0 ), _Square( CloneKineticLaw( child ) ) ), _Constant( 0.5 ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_ARCTAN:
+            return _Divide( dChild, _Add( _Constant( 1.0 ), _Square( CloneKineticLaw( child ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_ARCCOT:
+            return _Negate( _Divide( dChild, _Add( _Constant( 1.0 ), _Square( CloneKineticLaw( child ) ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_ARCSINH:
+            return _Divide( dChild, _Power( _Add( _Square( CloneKineticLaw( child ) ), _Constant( 1.0 ) ), _Constant( 0.5 ) ) );
+
+        case KINETIC_LAW_UNARY_OP_ARCCOSH:
+            return _Divide( dChild, _Power( _Subtract( _Square( CloneKineticLaw( child ) ), _Constant( 1.0 ) ), _Constant( 0.5 ) ) );
+
+        case KINETIC_LAW_UNARY_OP_ARCTANH:
+        case KINETIC_LAW_UNARY_OP_ARCCOTH:
+            return _Divide( dChild, _Subtract( _Constant( 1.0 ), _Square( CloneKineticLaw( child ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_ARCSEC:
+            return _Divide( dChild, _Multiply( _Apply( KINETIC_LAW_UNARY_OP_ABS, CloneKineticLaw( child ) ), 
+                                               _Power( _Subtract( _Square( CloneKineticLaw( child ) ), _Constant( 1.0 ) ), _Constant( 0.5 ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_ARCCSC:
+            return _Negate( _Divide( dChild, _Multiply( _Apply( KINETIC_LAW_UNARY_OP_ABS, CloneKineticLaw( child ) ), 
+                                                        _Power( _Subtract( _Square( CloneKineticLaw( child ) ), _Constant( 1.0 ) ), _Constant( 0.5 ) ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_ARCSECH:
+            return _Negate( _Divide( dChild, _Multiply( CloneKineticLaw( child ), 
+                                                        _Power( _Subtract( _Constant( 1.0 ), _Square( CloneKineticLaw( child ) ) ), _Constant( 0.5 ) ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_ARCCSCH:
+            return _Negate( _Divide( dChild, _Multiply( _Apply( KINETIC_LAW_UNARY_OP_ABS, CloneKineticLaw( child ) ), 
+                                                        _Power( _Add( _Constant( 1.0 ), _Square( CloneKineticLaw( child ) ) ), _Constant( 0.5 ) ) ) ) );
+
+        case KINETIC_LAW_UNARY_OP_NOT:
+        case KINETIC_LAW_UNARY_OP_FLOOR:
+        case KINETIC_LAW_UNARY_OP_CEILING:
+        case KINETIC_LAW_UNARY_OP_INT:
+        case KINETIC_LAW_UNARY_OP_BITWISE_NOT:
+            FreeKineticLaw( &dChild );
+            return _Constant( 0.0 );
+
+        default:
+            TRACE_1( "operator %c cannot be differentiated", opType );
+            FreeKineticLaw( &dChild );
+            return NULL;
+    }
+}
+
+
+/*
+ * The constructors below take over their arguments, return NULL if any of them is NULL, 
+ * and drop the terms that are zero or one so that derivatives stay small.
+ */
+static KINETIC_LAW *_Constant( double value ) {
+    return CreateRealValueKineticLaw( value );
+}
+
+static KINETIC_LAW *_Add( KINETIC_LAW *left, KINETIC_LAW *right ) {
+    if( ( left == NULL ) || ( right == NULL ) ) {
+        FreeKineticLaw( &left );
+        FreeKineticLaw( &right );
+        return NULL;
+    }
+    if( IsZeroKineticLaw( left ) ) {
+        FreeKineticLaw( &left );
+        return right;
+    }
+    if( IsZeroKineticLaw( right ) ) {
+        FreeKineticLaw( &right );
+        return left;
+    }
+    return CreateOpKineticLaw( KINETIC_LAW_OP_PLUS, left, right );
+}
+
+static KINETIC_LAW *_Subtract( KINETIC_LAW *left, KINETIC_LAW *right ) {
+    if( ( left == NULL ) || ( right == NULL ) ) {
+        FreeKineticLaw( &left );
+        FreeKineticLaw( &right );
+        return NULL;
+    }
+    if( IsZeroKineticLaw( right ) ) {
+        FreeKineticLaw( &right );
+        return left;
+    }
+    if( IsZeroKineticLaw( left ) ) {
+        FreeKineticLaw( &left );
+        return _Negate( right );
+    }
+    return CreateOpKineticLaw( KINETIC_LAW_OP_MINUS, left, right );
+}
+
+static KINETIC_LAW *_Multiply( KINETIC_LAW *left, KINETIC_LAW *right ) {
+    if( ( left == NULL ) || ( right == NULL ) ) {
+        FreeKineticLaw( &left );
+        FreeKineticLaw( &right );
+        return NULL;
+    }
+    if( IsZeroKineticLaw( left ) ) {
+        FreeKineticLaw( &right );
+        return left;
+    }
+    if( IsZeroKineticLaw( right ) ) {
+        FreeKineticLaw( &left );
+        return right;
+    }
+    if( _IsOneKineticLaw( left ) ) {
+        FreeKineticLaw( &left );
+        return right;
+    }
+    if( _IsOneKineticLaw( right ) ) {
+        FreeKineticLaw( &right );
+        return left;
+    }
+    return CreateOpKineticLaw( KINETIC_LAW_OP_TIMES, left, right );
+}
+
+static KINETIC_LAW *_Divide( KINETIC_LAW *left, KINETIC_LAW *right ) {
+    if( ( left == NULL ) || ( right == NULL ) ) {
+        FreeKineticLaw( &left );
+        FreeKineticLaw( &right );
+        return NULL;
+    }
+    if( IsZeroKineticLaw( left ) || _IsOneKineticLaw( right ) ) {
+        FreeKineticLaw( &right );
+        return left;
+    }
+    return CreateOpKineticLaw( KINETIC_LAW_OP_DIVIDE, left, right );
+}
+
+static KINETIC_LAW *_Power( KINETIC_LAW *left, KINETIC_LAW *right ) {
+    if( ( left == NULL ) || ( right == NULL ) ) {
+        FreeKineticLaw( &left );
+        FreeKineticLaw( &right );
+        return NULL;
+    }
+    if( IsZeroKineticLaw( right ) ) {
+        FreeKineticLaw( &left );
+        FreeKineticLaw( &right );
+        return _Constant( 1.0 );
+    }
+    if( _IsOneKineticLaw( right ) ) {
+        FreeKineticLaw( &right );
+        return left;
+    }
+    return CreateOpKineticLaw( KINETIC_LAW_OP_POW, left, right );
+}
+
+static KINETIC_LAW *_Negate( KINETIC_LAW *child ) {
+    KINETIC_LAW *grandChild = NULL;
+
+    if( child == NULL ) {
+        return NULL;
+    }
+    if( IsZeroKineticLaw( child ) ) {
+        return child;
+    }
+    if( IsUnaryOpKineticLaw( child ) && ( GetUnaryOpTypeFromKineticLaw( child ) == KINETIC_LAW_UNARY_OP_NEG ) ) {
+        grandChild = GetUnaryOpChildFromKineticLaw( child );
+        child->value.unaryOp.child = NULL;
+        FreeKineticLaw( &child );
+        return grandChild;
+    }
+    return CreateUnaryOpKineticLaw( KINETIC_LAW_UNARY_OP_NEG, child );
+}
+
+static KINETIC_LAW *_Apply( BYTE opType, KINETIC_LAW *child ) {
+    if( child == NULL ) {
+        return NULL;
+    }
+    return CreateUnaryOpKineticLaw( opType, child );
+}
+
+static KINETIC_LAW *_Square( KINETIC_LAW *law ) {
+    if( law == NULL ) {
+        return NULL;
+    }
+    return _Multiply( law, CloneKineticLaw( law ) );
+}
+
+static BOOL _IsOneKineticLaw( KINETIC_LAW *law ) {
+    if( IsRealValueKineticLaw( law ) ) {
+        return ( GetRealValueFromKineticLaw( law ) == 1.0 ) ? TRUE : FALSE;
+    }
+    if( IsIntValueKineticLaw( law ) ) {
+        return ( GetIntValueFromKineticLaw( law ) == 1 ) ? TRUE : FALSE;
+    }
+    return FALSE;
+}
@@ -0,0 +1,46 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the reb2sac contributors                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#if !defined(HAVE_KINETIC_LAW_DERIVATIVE)
+#define HAVE_KINETIC_LAW_DERIVATIVE
+
+#include "common.h"
+#include "kinetic_law.h"
+#include "species_node.h"
+
+BEGIN_C_NAMESPACE
+
+/*
+ * Returns a new kinetic law for the partial derivative of law with respect to species, 
+ * or NULL if law uses an operator that cannot be differentiated, such as factorial or 
+ * rateOf applied to an expression of the species.  The species stands for the value the 
+ * evaluators give it, i.e., its concentration unless it has only substance units.  
+ * Compartments and symbols are held constant, and comparisons, logical operators, floor, 
+ * ceiling and delay are taken to be piecewise constant.  The result is simplified with 
+ * SimplifyConstantsInKineticLaw and must be freed by the caller.
+ */
+KINETIC_LAW *CreateDerivativeOfKineticLaw( KINETIC_LAW *law, SPECIES *species );
+
+BOOL IsZeroKineticLaw( KINETIC_LAW *law );
+
+/* defined in kinetic_law_constants_simplifier.c */
+RET_VAL SimplifyConstantsInKineticLaw( KINETIC_LAW *kineticLaw );
+
+END_C_NAMESPACE
+
+#endif
@@ -24,6 +24,9 @@
 
 #include "kinetic_law_evaluater.h"
 
+#define _GET_RANDOM_NUMBER_CONTEXT(visitor) ( ((KINETIC_LAW_EVALUATER*)((visitor)->_internal1))->randomNumberContext )
+#define _GET_INTERPOLATE_DELAYS(visitor) ( ((KINETIC_LAW_EVALUATER*)((visitor)->_internal1))->interpolateDelays )
+
 
 static RET_VAL _SetSpeciesValue( KINETIC_LAW_EVALUATER *evaluater, SPECIES *species, double value );
 static RET_VAL _RemoveSpeciesValue( KINETIC_LAW_EVALUATER *evaluater, SPECIES *species );
@@ -72,6 +75,8 @@ KINETIC_LAW_EVALUATER *CreateKineticLawEvaluater() {
         return NULL;
     }
     
+    evaluater->randomNumberContext = NULL;
+    evaluater->interpolateDelays = FALSE;
     evaluater->SetSpeciesValue = _SetSpeciesValue;
     evaluater->RemoveSpeciesValue = _RemoveSpeciesValue;
     evaluater->SetDefaultSpeciesValue = _SetDefaultSpeciesValue;
@@ -105,16 +110,35 @@ RET_VAL FreeKineticLawEvaluater( KINETIC_LAW_EVALUATER **evaluater ) {
     return ret;
 }
 
-TIME_STAMP *CreateTimeStamp(double time, double value) {
-    TIME_STAMP *time_stamp = NULL;
+/*
+ * The value of delay( x, d ) given the current value of x and d.  The current value is 
+ * recorded in the history of the delay node, and the value at time - d is looked up there, 
+ * interpolated between the recorded times when interpolate is set, or found from the 
+ * initial values when time - d is negative.
+ */
+RET_VAL EvaluateDelayInKineticLaw( KINETIC_LAW *kineticLaw, double leftValue, double rightValue, BOOL interpolate, double *result ) {
+    RET_VAL ret = SUCCESS;
+    double time = 0.0;
+    DELAY_HISTORY *history = NULL;
+    KINETIC_LAW_EVALUATER evaluator;
 
-    if( ( time_stamp = (TIME_STAMP*)MALLOC( sizeof(TIME_STAMP) ) ) == NULL ) {
-      return NULL;
-    } 
-    time_stamp->time = time;
-    time_stamp->value = value;
-                
-    return time_stamp;
+    time = GetCurrentRealValueInSymbol( GetTimeFromKineticLaw( kineticLaw ) );
+    history = GetDelayHistoryFromKineticLaw( kineticLaw );
+    if( IS_FAILED( ( ret = RecordInDelayHistory( history, time, leftValue ) ) ) ) {
+        return ErrorReport( ret, "EvaluateDelayInKineticLaw", "could not record the value at time %g", time );
+    }
+    ExtendHorizonOfDelayHistory( history, rightValue );
+    if (time - rightValue < 0) {
+      /* only the visitor callbacks are used, so no table is needed */
+      memset( &evaluator, 0, sizeof(evaluator) );
+      evaluator.interpolateDelays = interpolate;
+      SetRealValueInSymbol( GetTimeFromKineticLaw( kineticLaw ), time - rightValue );
+      *result = _EvaluateAtNegativeTime( &evaluator, GetOpLeftFromKineticLaw( kineticLaw ) );
+      SetRealValueInSymbol( GetTimeFromKineticLaw( kineticLaw ), time );
+    } else {
+      *result = GetValueFromDelayHistory( history, time - rightValue, interpolate );
+    }
+    return SUCCESS;
 }
 
 static RET_VAL _SetSpeciesValue( KINETIC_LAW_EVALUATER *evaluater, SPECIES *species, double value ) {
@@ -182,7 +206,7 @@ static RET_VAL _SetDefaultSpeciesValue( KINETIC_LAW_EVALUATER *evaluater, double
 }
 
 static double _Evaluate( KINETIC_LAW_EVALUATER *evaluater, KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     double result = 0.0;
     
@@ -192,17 +216,15 @@ static double _Evaluate( KINETIC_LAW_EVALUATER *evaluater, KINETIC_LAW *kineticL
     
     START_FUNCTION("_Evaluate");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToEvaluate;
-        visitor.VisitOp = _VisitOpToEvaluate;
-        visitor.VisitUnaryOp = _VisitUnaryOpToEvaluate;
-        visitor.VisitInt = _VisitIntToEvaluate;
-        visitor.VisitReal = _VisitRealToEvaluate;
-        visitor.VisitSpecies = _VisitSpeciesToEvaluate;
-        visitor.VisitCompartment = _VisitCompartmentToEvaluate;
-        visitor.VisitSymbol = _VisitSymbolToEvaluate;
-        visitor.VisitFunctionSymbol = _VisitFunctionSymbolToEvaluate;
-    }
+    visitor.VisitPW = _VisitPWToEvaluate;
+    visitor.VisitOp = _VisitOpToEvaluate;
+    visitor.VisitUnaryOp = _VisitUnaryOpToEvaluate;
+    visitor.VisitInt = _VisitIntToEvaluate;
+    visitor.VisitReal = _VisitRealToEvaluate;
+    visitor.VisitSpecies = _VisitSpeciesToEvaluate;
+    visitor.VisitCompartment = _VisitCompartmentToEvaluate;
+    visitor.VisitSymbol = _VisitSymbolToEvaluate;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToEvaluate;
     
     visitor._internal1 = (CADDR_T)evaluater;
     visitor._internal2 = (CADDR_T)(&result);
@@ -218,7 +240,7 @@ static double _Evaluate( KINETIC_LAW_EVALUATER *evaluater, KINETIC_LAW *kineticL
 
 
 static double _EvaluateWithCurrentAmounts( KINETIC_LAW_EVALUATER *evaluater, KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     double result = 0.0;
     
@@ -228,17 +250,15 @@ static double _EvaluateWithCurrentAmounts( KINETIC_LAW_EVALUATER *evaluater, KIN
     
     START_FUNCTION("_Evaluate");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToEvaluate;
-        visitor.VisitOp = _VisitOpToEvaluate;
-        visitor.VisitUnaryOp = _VisitUnaryOpToEvaluate;
-        visitor.VisitInt = _VisitIntToEvaluate;
-        visitor.VisitReal = _VisitRealToEvaluate;
-        visitor.VisitSpecies = _VisitSpeciesToEvaluateWithCurrentAmounts;
-        visitor.VisitCompartment = _VisitCompartmentToEvaluateWithCurrentSize;
-        visitor.VisitSymbol = _VisitSymbolToEvaluate;
-	visitor.VisitFunctionSymbol = _VisitFunctionSymbolToEvaluate;
-    }
+    visitor.VisitPW = _VisitPWToEvaluate;
+    visitor.VisitOp = _VisitOpToEvaluate;
+    visitor.VisitUnaryOp = _VisitUnaryOpToEvaluate;
+    visitor.VisitInt = _VisitIntToEvaluate;
+    visitor.VisitReal = _VisitRealToEvaluate;
+    visitor.VisitSpecies = _VisitSpeciesToEvaluateWithCurrentAmounts;
+    visitor.VisitCompartment = _VisitCompartmentToEvaluateWithCurrentSize;
+    visitor.VisitSymbol = _VisitSymbolToEvaluate;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToEvaluate;
     
     visitor._internal1 = (CADDR_T)evaluater;
     visitor._internal2 = (CADDR_T)(&result);
@@ -254,7 +274,7 @@ static double _EvaluateWithCurrentAmounts( KINETIC_LAW_EVALUATER *evaluater, KIN
 
 
 static double _EvaluateWithCurrentAmountsDeter( KINETIC_LAW_EVALUATER *evaluater, KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     double result = 0.0;
     
@@ -264,17 +284,15 @@ static double _EvaluateWithCurrentAmountsDeter( KINETIC_LAW_EVALUATER *evaluater
     
     START_FUNCTION("_Evaluate");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToEvaluate;
-        visitor.VisitOp = _VisitOpToEvaluateDeter;
-        visitor.VisitUnaryOp = _VisitUnaryOpToEvaluateDeter;
-        visitor.VisitInt = _VisitIntToEvaluate;
-        visitor.VisitReal = _VisitRealToEvaluate;
-        visitor.VisitSpecies = _VisitSpeciesToEvaluateWithCurrentAmounts;
-        visitor.VisitCompartment = _VisitCompartmentToEvaluateWithCurrentSize;
-        visitor.VisitSymbol = _VisitSymbolToEvaluate;
-	visitor.VisitFunctionSymbol = _VisitFunctionSymbolToEvaluate;
-    }
+    visitor.VisitPW = _VisitPWToEvaluate;
+    visitor.VisitOp = _VisitOpToEvaluateDeter;
+    visitor.VisitUnaryOp = _VisitUnaryOpToEvaluateDeter;
+    visitor.VisitInt = _VisitIntToEvaluate;
+    visitor.VisitReal = _VisitRealToEvaluate;
+    visitor.VisitSpecies = _VisitSpeciesToEvaluateWithCurrentAmounts;
+    visitor.VisitCompartment = _VisitCompartmentToEvaluateWithCurrentSize;
+    visitor.VisitSymbol = _VisitSymbolToEvaluate;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToEvaluate;
     
     visitor._internal1 = (CADDR_T)evaluater;
     visitor._internal2 = (CADDR_T)(&result);
@@ -289,7 +307,7 @@ static double _EvaluateWithCurrentAmountsDeter( KINETIC_LAW_EVALUATER *evaluater
 }     
 
 static double _EvaluateAtNegativeTime( KINETIC_LAW_EVALUATER *evaluater, KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     double result = 0.0;
     
@@ -299,17 +317,15 @@ static double _EvaluateAtNegativeTime( KINETIC_LAW_EVALUATER *evaluater, KINETIC
     
     START_FUNCTION("_Evaluate");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToEvaluate;
-        visitor.VisitOp = _VisitOpToEvaluateDeter;
-        visitor.VisitUnaryOp = _VisitUnaryOpToEvaluateDeter;
-        visitor.VisitInt = _VisitIntToEvaluate;
-        visitor.VisitReal = _VisitRealToEvaluate;
-        visitor.VisitSpecies = _VisitSpeciesToEvaluateAtNegativeTime;
-        visitor.VisitCompartment = _VisitCompartmentToEvaluateAtNegativeTime;
-        visitor.VisitSymbol = _VisitSymbolToEvaluateAtNegativeTime;
-	visitor.VisitFunctionSymbol = _VisitFunctionSymbolToEvaluate;
-    }
+    visitor.VisitPW = _VisitPWToEvaluate;
+    visitor.VisitOp = _VisitOpToEvaluateDeter;
+    visitor.VisitUnaryOp = _VisitUnaryOpToEvaluateDeter;
+    visitor.VisitInt = _VisitIntToEvaluate;
+    visitor.VisitReal = _VisitRealToEvaluate;
+    visitor.VisitSpecies = _VisitSpeciesToEvaluateAtNegativeTime;
+    visitor.VisitCompartment = _VisitCompartmentToEvaluateAtNegativeTime;
+    visitor.VisitSymbol = _VisitSymbolToEvaluateAtNegativeTime;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToEvaluate;
     
     visitor._internal1 = (CADDR_T)evaluater;
     visitor._internal2 = (CADDR_T)(&result);
@@ -325,7 +341,7 @@ static double _EvaluateAtNegativeTime( KINETIC_LAW_EVALUATER *evaluater, KINETIC
 
 
 static double _EvaluateWithCurrentConcentrations( KINETIC_LAW_EVALUATER *evaluater, KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     double result = 0.0;
     
@@ -335,17 +351,15 @@ static double _EvaluateWithCurrentConcentrations( KINETIC_LAW_EVALUATER *evaluat
     
     START_FUNCTION("_Evaluate");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToEvaluate;
-        visitor.VisitOp = _VisitOpToEvaluate;
-        visitor.VisitUnaryOp = _VisitUnaryOpToEvaluate;
-        visitor.VisitInt = _VisitIntToEvaluate;
-        visitor.VisitReal = _VisitRealToEvaluate;
-        visitor.VisitSpecies = _VisitSpeciesToEvaluateWithCurrentConcentrations;
-        visitor.VisitCompartment = _VisitCompartmentToEvaluateWithCurrentSize;
-        visitor.VisitSymbol = _VisitSymbolToEvaluate;
-	visitor.VisitFunctionSymbol = _VisitFunctionSymbolToEvaluate;
-    }
+    visitor.VisitPW = _VisitPWToEvaluate;
+    visitor.VisitOp = _VisitOpToEvaluate;
+    visitor.VisitUnaryOp = _VisitUnaryOpToEvaluate;
+    visitor.VisitInt = _VisitIntToEvaluate;
+    visitor.VisitReal = _VisitRealToEvaluate;
+    visitor.VisitSpecies = _VisitSpeciesToEvaluateWithCurrentConcentrations;
+    visitor.VisitCompartment = _VisitCompartmentToEvaluateWithCurrentSize;
+    visitor.VisitSymbol = _VisitSymbolToEvaluate;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToEvaluate;
     
     visitor._internal1 = (CADDR_T)evaluater;
     visitor._internal2 = (CADDR_T)(&result);
@@ -361,7 +375,7 @@ static double _EvaluateWithCurrentConcentrations( KINETIC_LAW_EVALUATER *evaluat
 
 
 static double _EvaluateWithCurrentConcentrationsDeter( KINETIC_LAW_EVALUATER *evaluater, KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     double result = 0.0;
     
@@ -371,17 +385,15 @@ static double _EvaluateWithCurrentConcentrationsDeter( KINETIC_LAW_EVALUATER *ev
     
     START_FUNCTION("_Evaluate");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToEvaluate;
-        visitor.VisitOp = _VisitOpToEvaluateDeter;
-        visitor.VisitUnaryOp = _VisitUnaryOpToEvaluateDeter;
-        visitor.VisitInt = _VisitIntToEvaluate;
-        visitor.VisitReal = _VisitRealToEvaluate;
-        visitor.VisitSpecies = _VisitSpeciesToEvaluateWithCurrentConcentrations;
-        visitor.VisitCompartment = _VisitCompartmentToEvaluateWithCurrentSize;
-        visitor.VisitSymbol = _VisitSymbolToEvaluate;
-	visitor.VisitFunctionSymbol = _VisitFunctionSymbolToEvaluate;
-    }
+    visitor.VisitPW = _VisitPWToEvaluate;
+    visitor.VisitOp = _VisitOpToEvaluateDeter;
+    visitor.VisitUnaryOp = _VisitUnaryOpToEvaluateDeter;
+    visitor.VisitInt = _VisitIntToEvaluate;
+    visitor.VisitReal = _VisitRealToEvaluate;
+    visitor.VisitSpecies = _VisitSpeciesToEvaluateWithCurrentConcentrations;
+    visitor.VisitCompartment = _VisitCompartmentToEvaluateWithCurrentSize;
+    visitor.VisitSymbol = _VisitSymbolToEvaluate;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToEvaluate;
     
     visitor._internal1 = (CADDR_T)evaluater;
     visitor._internal2 = (CADDR_T)(&result);
@@ -631,11 +643,6 @@ static RET_VAL _VisitOpToEvaluate( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *ki
     double *result = NULL;
     KINETIC_LAW *left = NULL;
     KINETIC_LAW *right = NULL;
-    double time = 0.0;
-    LINKED_LIST *values = NULL;
-    TIME_STAMP *time_stamp = NULL;
-    TIME_STAMP *last_time_stamp = NULL;
-    KINETIC_LAW_EVALUATER *evaluator = NULL;
     
     START_FUNCTION("_VisitOpToEvaluate");
     
@@ -682,47 +689,9 @@ static RET_VAL _VisitOpToEvaluate( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *ki
         break;
 
         case KINETIC_LAW_OP_DELAY:
-	  time = GetCurrentRealValueInSymbol( GetTimeFromKineticLaw( kineticLaw ) );
-	  values = GetValuesFromKineticLaw( kineticLaw );
-	  if (time == 0.0 && values != NULL && GetLinkedListSize(values) > 0) {
-	    DeleteLinkedList( values );
-	    values = CreateLinkedList();
-	    SetValuesKineticLaw( kineticLaw, values );
-	  } 
-	  ResetCurrentElement( values );
-	  if ( ( time_stamp = (TIME_STAMP*)GetNextFromLinkedList( values ) ) != NULL ) {
-	    if (time - time_stamp->time > 0.0) {
-	      time_stamp = CreateTimeStamp(time,leftValue);
-	      InsertHeadInLinkedList( (CADDR_T)time_stamp, values );
-	    } 
-	  } else {
-	    time_stamp = CreateTimeStamp(time,leftValue);
-	    InsertHeadInLinkedList( (CADDR_T)time_stamp, values );
-	  }
-	  if (time - rightValue < 0) {
-	    SetRealValueInSymbol( GetTimeFromKineticLaw( kineticLaw ), time - rightValue );
-	    if( ( evaluator = CreateKineticLawEvaluater() ) == NULL ) {
-	      return ErrorReport( FAILING, "_InitializeRecord", "could not create evaluator" );
-	    }
-	    *result = evaluator->EvaluateAtNegativeTime( evaluator, left );
-	    if( evaluator != NULL ) {
-	      FreeKineticLawEvaluater( &(evaluator) );
-	    }
-	    SetRealValueInSymbol( GetTimeFromKineticLaw( kineticLaw ), time );
-	  } else {
-	    *result = 0;
-	    ResetCurrentElement( values );
-	    while( ( time_stamp = (TIME_STAMP*)GetNextFromLinkedList( values ) ) != NULL ) {
-	      if (time_stamp->time <= time - rightValue) {
-		*result = time_stamp->value;
-		if ((time_stamp->time != time - rightValue) && (last_time_stamp!=NULL)) {
-		  *result = time_stamp->value + (last_time_stamp->value - time_stamp->value) *
-		    (((time - rightValue) - time_stamp->time) / (last_time_stamp->time - time_stamp->time));
-		}
-		break;
-	      }
-	      last_time_stamp = time_stamp;
-	    }
+	  if( IS_FAILED( ( ret = EvaluateDelayInKineticLaw( kineticLaw, leftValue, rightValue, _GET_INTERPOLATE_DELAYS( visitor ), result ) ) ) ) {
+	    END_FUNCTION("_VisitOpToEvaluate", ret );
+	    return ret;
 	  }
         break;        
         
@@ -780,23 +749,23 @@ static RET_VAL _VisitOpToEvaluate( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW *ki
         break;
 
         case KINETIC_LAW_OP_UNIFORM:
-	    *result = GetNextUniformRandomNumber(leftValue,rightValue);
+	    *result = GetNextUniformRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),leftValue,rightValue);
         break;
 
         case KINETIC_LAW_OP_NORMAL:
-	    *result = GetNextNormalRandomNumber(leftValue,rightValue);
+	    *result = GetNextNormalRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),leftValue,rightValue);
         break;
 
         case KINETIC_LAW_OP_BINOMIAL:
-	  *result = GetNextBinomialRandomNumber(leftValue,(unsigned int)rightValue);
+	  *result = GetNextBinomialRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),leftValue,(unsigned int)rightValue);
         break;
 
         case KINETIC_LAW_OP_GAMMA:
-	    *result = GetNextGammaRandomNumber(leftValue,rightValue);
+	    *result = GetNextGammaRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),leftValue,rightValue);
         break;
 
         case KINETIC_LAW_OP_LOGNORMAL:
-	    *result = GetNextLogNormalRandomNumber(leftValue,rightValue);
+	    *result = GetNextLogNormalRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),leftValue,rightValue);
         break;
 
         case KINETIC_LAW_OP_BITWISE_AND:
@@ -951,25 +920,25 @@ static RET_VAL _VisitUnaryOpToEvaluate( KINETIC_LAW_VISITOR *visitor, KINETIC_LA
 	  *result = log(childValue);
         break;
         case KINETIC_LAW_UNARY_OP_EXPRAND:
-	  *result = GetNextExponentialRandomNumber(childValue);
+	  *result = GetNextExponentialRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),childValue);
         break;
         case KINETIC_LAW_UNARY_OP_POISSON:
-	  *result = GetNextPoissonRandomNumber(childValue);
+	  *result = GetNextPoissonRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),childValue);
         break;
         case KINETIC_LAW_UNARY_OP_CHISQ:
-	  *result = GetNextChiSquaredRandomNumber(childValue);
+	  *result = GetNextChiSquaredRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),childValue);
         break;
         case KINETIC_LAW_UNARY_OP_LAPLACE:
-	  *result = GetNextLaplaceRandomNumber(childValue);
+	  *result = GetNextLaplaceRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),childValue);
         break;
         case KINETIC_LAW_UNARY_OP_CAUCHY:
-	  *result = GetNextCauchyRandomNumber(childValue);
+	  *result = GetNextCauchyRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),childValue);
         break;
         case KINETIC_LAW_UNARY_OP_RAYLEIGH:
-	  *result = GetNextRayleighRandomNumber(childValue);
+	  *result = GetNextRayleighRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),childValue);
         break;
         case KINETIC_LAW_UNARY_OP_BERNOULLI:
-	  *result = GetNextBernoulliRandomNumber(childValue);
+	  *result = GetNextBernoulliRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),childValue);
         break;
         case KINETIC_LAW_UNARY_OP_RATE:
 	  if (IsSymbolKineticLaw( child )) {
@@ -1008,11 +977,6 @@ static RET_VAL _VisitOpToEvaluateDeter( KINETIC_LAW_VISITOR *visitor, KINETIC_LA
     double *result = NULL;
     KINETIC_LAW *left = NULL;
     KINETIC_LAW *right = NULL;
-    double time = 0.0;
-    LINKED_LIST *values = NULL;
-    TIME_STAMP *time_stamp = NULL;
-    TIME_STAMP *last_time_stamp = NULL;
-    KINETIC_LAW_EVALUATER *evaluator = NULL;
     
     START_FUNCTION("_VisitOpToEvaluate");
     
@@ -1059,47 +1023,9 @@ static RET_VAL _VisitOpToEvaluateDeter( KINETIC_LAW_VISITOR *visitor, KINETIC_LA
         break;
         
         case KINETIC_LAW_OP_DELAY:
-	  time = GetCurrentRealValueInSymbol( GetTimeFromKineticLaw( kineticLaw ) );
-	  values = GetValuesFromKineticLaw( kineticLaw );
-	  if (time == 0.0 && values != NULL && GetLinkedListSize(values) > 0) {
-	    DeleteLinkedList( values );
-	    values = CreateLinkedList();
-	    SetValuesKineticLaw( kineticLaw, values );
-	  } 
-	  ResetCurrentElement( values );
-	  if ( ( time_stamp = (TIME_STAMP*)GetNextFromLinkedList( values ) ) != NULL ) {
-	    if (time - time_stamp->time > 0.0) {
-	      time_stamp = CreateTimeStamp(time,leftValue);
-	      InsertHeadInLinkedList( (CADDR_T)time_stamp, values );
-	    } 
-	  } else {
-	    time_stamp = CreateTimeStamp(time,leftValue);
-	    InsertHeadInLinkedList( (CADDR_T)time_stamp, values );
-	  }
-	  if (time - rightValue < 0) {
-	    SetRealValueInSymbol( GetTimeFromKineticLaw( kineticLaw ), time - rightValue );
-	    if( ( evaluator = CreateKineticLawEvaluater() ) == NULL ) {
-	      return ErrorReport( FAILING, "_InitializeRecord", "could not create evaluator" );
-	    }
-	    *result = evaluator->EvaluateAtNegativeTime( evaluator, left );
-	    if( evaluator != NULL ) {
-	      FreeKineticLawEvaluater( &(evaluator) );
-	    }
-	    SetRealValueInSymbol( GetTimeFromKineticLaw( kineticLaw ), time );
-	  } else {
-	    *result = 0;
-	    ResetCurrentElement( values );
-	    while( ( time_stamp = (TIME_STAMP*)GetNextFromLinkedList( values ) ) != NULL ) {
-	      if (time_stamp->time <= time - rightValue) {
-		*result = time_stamp->value;
-		if ((time_stamp->time != time - rightValue) && (last_time_stamp!=NULL)) {
-		  *result = time_stamp->value + (last_time_stamp->value - time_stamp->value) *
-		    (((time - rightValue) - time_stamp->time) / (last_time_stamp->time - time_stamp->time));
-		}
-		break;
-	      }
-	      last_time_stamp = time_stamp;
-	    }
+	  if( IS_FAILED( ( ret = EvaluateDelayInKineticLaw( kineticLaw, leftValue, rightValue, _GET_INTERPOLATE_DELAYS( visitor ), result ) ) ) ) {
+	    END_FUNCTION("_VisitOpToEvaluate", ret );
+	    return ret;
 	  }
         break;        
 
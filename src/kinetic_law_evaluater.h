@@ -32,18 +32,14 @@ typedef struct {
     double value;
 } KINETIC_LAW_EVALUATION_ELEMENT;
 
-typedef struct {
-  double time;
-  double value;
-} TIME_STAMP;
-
-
 struct _KINETIC_LAW_EVALUATER;
 typedef struct _KINETIC_LAW_EVALUATER KINETIC_LAW_EVALUATER;
 
 struct _KINETIC_LAW_EVALUATER {
     HASH_TABLE *table;
     double defaultValue;
+    RANDOM_NUMBER_CONTEXT *randomNumberContext;
+    BOOL interpolateDelays;
     RET_VAL (*SetSpeciesValue)( KINETIC_LAW_EVALUATER*evaluater, SPECIES *species, double value );
     RET_VAL (*RemoveSpeciesValue)( KINETIC_LAW_EVALUATER *evaluater, SPECIES *species );
     RET_VAL (*SetDefaultSpeciesValue)( KINETIC_LAW_EVALUATER *evaluater, double value ); 
@@ -58,6 +54,8 @@ struct _KINETIC_LAW_EVALUATER {
 KINETIC_LAW_EVALUATER *CreateKineticLawEvaluater();
 RET_VAL FreeKineticLawEvaluater( KINETIC_LAW_EVALUATER **evaluater );
 
+RET_VAL EvaluateDelayInKineticLaw( KINETIC_LAW *kineticLaw, double leftValue, double rightValue, BOOL interpolate, double *result );
+
 END_C_NAMESPACE
 
 #endif
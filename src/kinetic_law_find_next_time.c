@@ -24,6 +24,8 @@
 
 #include "kinetic_law_find_next_time.h"
 
+#define _GET_RANDOM_NUMBER_CONTEXT(visitor) ( ((KINETIC_LAW_FIND_NEXT_TIME*)((visitor)->_internal1))->randomNumberContext )
+
 
 static RET_VAL _SetSpeciesValue( KINETIC_LAW_FIND_NEXT_TIME *find_next_time, SPECIES *species, double value );
 static RET_VAL _RemoveSpeciesValue( KINETIC_LAW_FIND_NEXT_TIME *find_next_time, SPECIES *species );
@@ -67,6 +69,7 @@ KINETIC_LAW_FIND_NEXT_TIME *CreateKineticLawFind_Next_Time() {
         return NULL;
     }
     
+    find_next_time->randomNumberContext = NULL;
     find_next_time->SetSpeciesValue = _SetSpeciesValue;
     find_next_time->RemoveSpeciesValue = _RemoveSpeciesValue;
     find_next_time->SetDefaultSpeciesValue = _SetDefaultSpeciesValue;
@@ -164,7 +167,7 @@ static RET_VAL _SetDefaultSpeciesValue( KINETIC_LAW_FIND_NEXT_TIME *find_next_ti
 }
 
 static double _FindNextTime( KINETIC_LAW_FIND_NEXT_TIME *find_next_time, KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     double result = 0.0;
     
@@ -174,17 +177,15 @@ static double _FindNextTime( KINETIC_LAW_FIND_NEXT_TIME *find_next_time, KINETIC
     
     START_FUNCTION("_FindNextTime");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToFindNextTime;
-        visitor.VisitOp = _VisitOpToFindNextTime;
-        visitor.VisitUnaryOp = _VisitUnaryOpToFindNextTime;
-        visitor.VisitInt = _VisitIntToFindNextTime;
-        visitor.VisitReal = _VisitRealToFindNextTime;
-        visitor.VisitSpecies = _VisitSpeciesToFindNextTime;
-        visitor.VisitCompartment = _VisitCompartmentToFindNextTime;
-        visitor.VisitSymbol = _VisitSymbolToFindNextTime;
-        visitor.VisitFunctionSymbol = _VisitFunctionSymbolToFindNextTime;
-    }
+    visitor.VisitPW = _VisitPWToFindNextTime;
+    visitor.VisitOp = _VisitOpToFindNextTime;
+    visitor.VisitUnaryOp = _VisitUnaryOpToFindNextTime;
+    visitor.VisitInt = _VisitIntToFindNextTime;
+    visitor.VisitReal = _VisitRealToFindNextTime;
+    visitor.VisitSpecies = _VisitSpeciesToFindNextTime;
+    visitor.VisitCompartment = _VisitCompartmentToFindNextTime;
+    visitor.VisitSymbol = _VisitSymbolToFindNextTime;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToFindNextTime;
     
     visitor._internal1 = (CADDR_T)find_next_time;
     visitor._internal2 = (CADDR_T)(&result);
@@ -200,7 +201,7 @@ static double _FindNextTime( KINETIC_LAW_FIND_NEXT_TIME *find_next_time, KINETIC
 
 
 static double _FindNextTimeWithCurrentAmounts( KINETIC_LAW_FIND_NEXT_TIME *find_next_time, KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     double result = 0.0;
     
@@ -210,17 +211,15 @@ static double _FindNextTimeWithCurrentAmounts( KINETIC_LAW_FIND_NEXT_TIME *find_
     
     START_FUNCTION("_FindNextTime");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToFindNextTime;
-        visitor.VisitOp = _VisitOpToFindNextTime;
-        visitor.VisitUnaryOp = _VisitUnaryOpToFindNextTime;
-        visitor.VisitInt = _VisitIntToFindNextTime;
-        visitor.VisitReal = _VisitRealToFindNextTime;
-        visitor.VisitSpecies = _VisitSpeciesToFindNextTimeWithCurrentAmounts;
-        visitor.VisitCompartment = _VisitCompartmentToFindNextTimeWithCurrentSize;
-        visitor.VisitSymbol = _VisitSymbolToFindNextTime;
-	visitor.VisitFunctionSymbol = _VisitFunctionSymbolToFindNextTime;
-    }
+    visitor.VisitPW = _VisitPWToFindNextTime;
+    visitor.VisitOp = _VisitOpToFindNextTime;
+    visitor.VisitUnaryOp = _VisitUnaryOpToFindNextTime;
+    visitor.VisitInt = _VisitIntToFindNextTime;
+    visitor.VisitReal = _VisitRealToFindNextTime;
+    visitor.VisitSpecies = _VisitSpeciesToFindNextTimeWithCurrentAmounts;
+    visitor.VisitCompartment = _VisitCompartmentToFindNextTimeWithCurrentSize;
+    visitor.VisitSymbol = _VisitSymbolToFindNextTime;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToFindNextTime;
     
     visitor._internal1 = (CADDR_T)find_next_time;
     visitor._internal2 = (CADDR_T)(&result);
@@ -236,7 +235,7 @@ static double _FindNextTimeWithCurrentAmounts( KINETIC_LAW_FIND_NEXT_TIME *find_
 
 
 static double _FindNextTimeWithCurrentConcentrations( KINETIC_LAW_FIND_NEXT_TIME *find_next_time, KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     double result = 0.0;
     
@@ -246,17 +245,15 @@ static double _FindNextTimeWithCurrentConcentrations( KINETIC_LAW_FIND_NEXT_TIME
     
     START_FUNCTION("_FindNextTime");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToFindNextTime;
-        visitor.VisitOp = _VisitOpToFindNextTime;
-        visitor.VisitUnaryOp = _VisitUnaryOpToFindNextTime;
-        visitor.VisitInt = _VisitIntToFindNextTime;
-        visitor.VisitReal = _VisitRealToFindNextTime;
-        visitor.VisitSpecies = _VisitSpeciesToFindNextTimeWithCurrentConcentrations;
-        visitor.VisitCompartment = _VisitCompartmentToFindNextTimeWithCurrentSize;
-        visitor.VisitSymbol = _VisitSymbolToFindNextTime;
-	visitor.VisitFunctionSymbol = _VisitFunctionSymbolToFindNextTime;
-    }
+    visitor.VisitPW = _VisitPWToFindNextTime;
+    visitor.VisitOp = _VisitOpToFindNextTime;
+    visitor.VisitUnaryOp = _VisitUnaryOpToFindNextTime;
+    visitor.VisitInt = _VisitIntToFindNextTime;
+    visitor.VisitReal = _VisitRealToFindNextTime;
+    visitor.VisitSpecies = _VisitSpeciesToFindNextTimeWithCurrentConcentrations;
+    visitor.VisitCompartment = _VisitCompartmentToFindNextTimeWithCurrentSize;
+    visitor.VisitSymbol = _VisitSymbolToFindNextTime;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToFindNextTime;
     
     visitor._internal1 = (CADDR_T)find_next_time;
     visitor._internal2 = (CADDR_T)(&result);
@@ -272,7 +269,7 @@ static double _FindNextTimeWithCurrentConcentrations( KINETIC_LAW_FIND_NEXT_TIME
 
 
 static double _FindNextTimeWithCurrentConcentrationsDeter( KINETIC_LAW_FIND_NEXT_TIME *find_next_time, KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
     double result = 0.0;
     
@@ -282,17 +279,15 @@ static double _FindNextTimeWithCurrentConcentrationsDeter( KINETIC_LAW_FIND_NEXT
     
     START_FUNCTION("_FindNextTime");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToFindNextTime;
-        visitor.VisitOp = _VisitOpToFindNextTimeDeter;
-        visitor.VisitUnaryOp = _VisitUnaryOpToFindNextTimeDeter;
-        visitor.VisitInt = _VisitIntToFindNextTime;
-        visitor.VisitReal = _VisitRealToFindNextTime;
-        visitor.VisitSpecies = _VisitSpeciesToFindNextTimeWithCurrentConcentrations;
-        visitor.VisitCompartment = _VisitCompartmentToFindNextTimeWithCurrentSize;
-        visitor.VisitSymbol = _VisitSymbolToFindNextTime;
-	visitor.VisitFunctionSymbol = _VisitFunctionSymbolToFindNextTime;
-    }
+    visitor.VisitPW = _VisitPWToFindNextTime;
+    visitor.VisitOp = _VisitOpToFindNextTimeDeter;
+    visitor.VisitUnaryOp = _VisitUnaryOpToFindNextTimeDeter;
+    visitor.VisitInt = _VisitIntToFindNextTime;
+    visitor.VisitReal = _VisitRealToFindNextTime;
+    visitor.VisitSpecies = _VisitSpeciesToFindNextTimeWithCurrentConcentrations;
+    visitor.VisitCompartment = _VisitCompartmentToFindNextTimeWithCurrentSize;
+    visitor.VisitSymbol = _VisitSymbolToFindNextTime;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToFindNextTime;
     
     visitor._internal1 = (CADDR_T)find_next_time;
     visitor._internal2 = (CADDR_T)(&result);
@@ -622,23 +617,23 @@ static RET_VAL _VisitOpToFindNextTime( KINETIC_LAW_VISITOR *visitor, KINETIC_LAW
         break;
 
         case KINETIC_LAW_OP_UNIFORM:
-	    *result = GetNextUniformRandomNumber(leftValue,rightValue);
+	    *result = GetNextUniformRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),leftValue,rightValue);
         break;
 
         case KINETIC_LAW_OP_NORMAL:
-	    *result = GetNextNormalRandomNumber(leftValue,rightValue);
+	    *result = GetNextNormalRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),leftValue,rightValue);
         break;
 
         case KINETIC_LAW_OP_BINOMIAL:
-	  *result = GetNextBinomialRandomNumber(leftValue,(unsigned int)rightValue);
+	  *result = GetNextBinomialRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),leftValue,(unsigned int)rightValue);
         break;
 
         case KINETIC_LAW_OP_GAMMA:
-	    *result = GetNextGammaRandomNumber(leftValue,rightValue);
+	    *result = GetNextGammaRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),leftValue,rightValue);
         break;
 
         case KINETIC_LAW_OP_LOGNORMAL:
-	    *result = GetNextLogNormalRandomNumber(leftValue,rightValue);
+	    *result = GetNextLogNormalRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),leftValue,rightValue);
         break;
 
         case KINETIC_LAW_OP_BITWISE_AND:
@@ -790,25 +785,25 @@ static RET_VAL _VisitUnaryOpToFindNextTime( KINETIC_LAW_VISITOR *visitor, KINETI
 	  *result = log(childValue);
         break;
         case KINETIC_LAW_UNARY_OP_EXPRAND:
-	  *result = GetNextExponentialRandomNumber(childValue);
+	  *result = GetNextExponentialRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),childValue);
         break;
         case KINETIC_LAW_UNARY_OP_POISSON:
-	  *result = GetNextPoissonRandomNumber(childValue);
+	  *result = GetNextPoissonRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),childValue);
         break;
         case KINETIC_LAW_UNARY_OP_CHISQ:
-	  *result = GetNextChiSquaredRandomNumber(childValue);
+	  *result = GetNextChiSquaredRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),childValue);
         break;
         case KINETIC_LAW_UNARY_OP_LAPLACE:
-	  *result = GetNextLaplaceRandomNumber(childValue);
+	  *result = GetNextLaplaceRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),childValue);
         break;
         case KINETIC_LAW_UNARY_OP_CAUCHY:
-	  *result = GetNextCauchyRandomNumber(childValue);
+	  *result = GetNextCauchyRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),childValue);
         break;
         case KINETIC_LAW_UNARY_OP_RAYLEIGH:
-	  *result = GetNextRayleighRandomNumber(childValue);
+	  *result = GetNextRayleighRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),childValue);
         break;
         case KINETIC_LAW_UNARY_OP_BERNOULLI:
-	  *result = GetNextBernoulliRandomNumber(childValue);
+	  *result = GetNextBernoulliRandomNumberInContext(_GET_RANDOM_NUMBER_CONTEXT(visitor),childValue);
         break;
         case KINETIC_LAW_UNARY_OP_RATE:
 	  if (IsSymbolKineticLaw( child )) {
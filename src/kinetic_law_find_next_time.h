@@ -40,6 +40,7 @@ typedef struct _KINETIC_LAW_FIND_NEXT_TIME KINETIC_LAW_FIND_NEXT_TIME;
 struct _KINETIC_LAW_FIND_NEXT_TIME {
     HASH_TABLE *table;
     double defaultValue;
+    RANDOM_NUMBER_CONTEXT *randomNumberContext;
     RET_VAL (*SetSpeciesValue)( KINETIC_LAW_FIND_NEXT_TIME*find_next_time, SPECIES *species, double value );
     RET_VAL (*RemoveSpeciesValue)( KINETIC_LAW_FIND_NEXT_TIME *find_next_time, SPECIES *species );
     RET_VAL (*SetDefaultSpeciesValue)( KINETIC_LAW_FIND_NEXT_TIME *find_next_time, double value ); 
@@ -0,0 +1,894 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the reb2sac contributors                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#include <math.h>
+#include "kinetic_law_program.h"
+
+typedef struct {
+    KINETIC_LAW_COMPILER *compiler;
+    KINETIC_LAW_PROGRAM *program;
+    UINT32 instructionsCapacity;
+    UINT32 constantsCapacity;
+    UINT32 referencesCapacity;
+    UINT32 depth;
+} KINETIC_LAW_PROGRAM_BUILDER;
+
+static RET_VAL _CompileNode( KINETIC_LAW_PROGRAM_BUILDER *builder, KINETIC_LAW *law );
+static RET_VAL _CompilePW( KINETIC_LAW_PROGRAM_BUILDER *builder, KINETIC_LAW *law );
+static RET_VAL _CompilePiecewise( KINETIC_LAW_PROGRAM_BUILDER *builder, LINKED_LIST *children );
+static RET_VAL _CompileOp( KINETIC_LAW_PROGRAM_BUILDER *builder, KINETIC_LAW *law );
+static RET_VAL _CompileUnaryOp( KINETIC_LAW_PROGRAM_BUILDER *builder, KINETIC_LAW *law );
+static RET_VAL _CompileSpecies( KINETIC_LAW_PROGRAM_BUILDER *builder, SPECIES *species );
+static RET_VAL _CompileVariable( KINETIC_LAW_PROGRAM_BUILDER *builder, CADDR_T node, BYTE referenceCode );
+static RET_VAL _Emit( KINETIC_LAW_PROGRAM_BUILDER *builder, BYTE code, BYTE opType, UINT32 operand, UINT32 operand2 );
+static RET_VAL _EmitConstant( KINETIC_LAW_PROGRAM_BUILDER *builder, double value );
+static RET_VAL _EmitReference( KINETIC_LAW_PROGRAM_BUILDER *builder, BYTE code, CADDR_T reference );
+static BYTE _GetBinaryInstruction( BYTE opType );
+static BOOL _IsSupportedBinaryOp( BYTE opType );
+static BOOL _IsSupportedUnaryOp( BYTE opType );
+static double _ApplyBinaryOp( BYTE opType, double leftValue, double rightValue, RANDOM_NUMBER_CONTEXT *context, BOOL deterministic );
+static double _ApplyUnaryOp( BYTE opType, double childValue, RANDOM_NUMBER_CONTEXT *context, BOOL deterministic );
+static void _FreeProgram( KINETIC_LAW_PROGRAM **program );
+static RET_VAL _FreePrograms( HASH_TABLE **programs );
+
+
+KINETIC_LAW_COMPILER *CreateKineticLawCompiler( SIM_STATE *state ) {
+    KINETIC_LAW_COMPILER *compiler = NULL;
+
+    START_FUNCTION("CreateKineticLawCompiler");
+
+    if( ( compiler = (KINETIC_LAW_COMPILER*)MALLOC( sizeof(KINETIC_LAW_COMPILER) ) ) == NULL ) {
+        END_FUNCTION("CreateKineticLawCompiler", FAILING );
+        return NULL;
+    }
+    compiler->state = state;
+    compiler->interpolateDelays = FALSE;
+    if( ( ( compiler->programs = CreateHashTable( 64 ) ) == NULL ) ||
+        ( ( compiler->deterministicPrograms = CreateHashTable( 64 ) ) == NULL ) ) {
+        FreeKineticLawCompiler( &compiler );
+        END_FUNCTION("CreateKineticLawCompiler", FAILING );
+        return NULL;
+    }
+
+    END_FUNCTION("CreateKineticLawCompiler", SUCCESS );
+    return compiler;
+}
+
+RET_VAL FreeKineticLawCompiler( KINETIC_LAW_COMPILER **compiler ) {
+    KINETIC_LAW_COMPILER *target = *compiler;
+
+    START_FUNCTION("FreeKineticLawCompiler");
+
+    if( target == NULL ) {
+        END_FUNCTION("FreeKineticLawCompiler", SUCCESS );
+        return SUCCESS;
+    }
+    _FreePrograms( &(target->programs) );
+    _FreePrograms( &(target->deterministicPrograms) );
+    FREE( *compiler );
+
+    END_FUNCTION("FreeKineticLawCompiler", SUCCESS );
+    return SUCCESS;
+}
+
+/*
+ * Returns the program of the kinetic law, compiling it on first use.  Returns NULL if the 
+ * law uses an operator the interpreter does not know or needs too deep a stack; callers 
+ * evaluate such laws with the KINETIC_LAW_EVALUATER instead.
+ */
+KINETIC_LAW_PROGRAM *CompileKineticLaw( KINETIC_LAW_COMPILER *compiler, KINETIC_LAW *law, BOOL deterministic ) {
+    HASH_TABLE *programs = NULL;
+    KINETIC_LAW_PROGRAM *program = NULL;
+    KINETIC_LAW_PROGRAM_BUILDER builder;
+
+    START_FUNCTION("CompileKineticLaw");
+
+    if( law == NULL ) {
+        END_FUNCTION("CompileKineticLaw", FAILING );
+        return NULL;
+    }
+    programs = deterministic ? compiler->deterministicPrograms : compiler->programs;
+    if( ( program = (KINETIC_LAW_PROGRAM*)GetValueFromHashTable( (CADDR_T)&law, sizeof(law), programs ) ) != NULL ) {
+        END_FUNCTION("CompileKineticLaw", SUCCESS );
+        return program;
+    }
+
+    if( ( program = (KINETIC_LAW_PROGRAM*)MALLOC( sizeof(KINETIC_LAW_PROGRAM) ) ) == NULL ) {
+        END_FUNCTION("CompileKineticLaw", FAILING );
+        return NULL;
+    }
+    program->law = law;
+    program->deterministic = deterministic;
+    program->interpolateDelays = compiler->interpolateDelays;
+    builder.compiler = compiler;
+    builder.program = program;
+    builder.instructionsCapacity = 0;
+    builder.constantsCapacity = 0;
+    builder.referencesCapacity = 0;
+    builder.depth = 0;
+    if( IS_FAILED( _CompileNode( &builder, law ) ) ) {
+        _FreeProgram( &program );
+        END_FUNCTION("CompileKineticLaw", FAILING );
+        return NULL;
+    }
+    if( IS_FAILED( PutInHashTable( (CADDR_T)&(program->law), sizeof(law), (CADDR_T)program, programs ) ) ) {
+        _FreeProgram( &program );
+        END_FUNCTION("CompileKineticLaw", FAILING );
+        return NULL;
+    }
+
+    END_FUNCTION("CompileKineticLaw", SUCCESS );
+    return program;
+}
+
+/*
+ * Runs the program against the values block of a SIM_STATE.  The operations mirror those of the 
+ * KINETIC_LAW_EVALUATER, which remains the reference, so both give the same results.
+ */
+double EvaluateKineticLawProgram( KINETIC_LAW_PROGRAM *program, double *values, RANDOM_NUMBER_CONTEXT *context ) {
+    double stack[KINETIC_LAW_PROGRAM_MAX_STACK_SIZE];
+    double size = 0.0;
+    UINT32 top = 0;
+    UINT32 pc = 0;
+    UINT32 end = program->instructionsSize;
+    KINETIC_LAW_INSTRUCTION *instruction = NULL;
+    KINETIC_LAW_INSTRUCTION *instructions = program->instructions;
+
+    while( pc < end ) {
+        instruction = instructions + pc;
+        pc++;
+        switch( instruction->code ) {
+            case KINETIC_LAW_INSTRUCTION_CONSTANT:
+                stack[top++] = program->constants[instruction->operand];
+            break;
+            case KINETIC_LAW_INSTRUCTION_LOAD:
+                stack[top++] = values[instruction->operand];
+            break;
+            case KINETIC_LAW_INSTRUCTION_LOAD_CONCENTRATION:
+                size = values[instruction->operand2];
+                stack[top++] = ( size == -1.0 ) ? values[instruction->operand] : values[instruction->operand] / size;
+            break;
+            case KINETIC_LAW_INSTRUCTION_LOAD_SPECIES:
+                if( HasOnlySubstanceUnitsInSpeciesNode( (SPECIES*)program->references[instruction->operand] ) ) {
+                    stack[top++] = GetAmountInSpeciesNode( (SPECIES*)program->references[instruction->operand] );
+                } else {
+                    stack[top++] = GetConcentrationInSpeciesNode( (SPECIES*)program->references[instruction->operand] );
+                }
+            break;
+            case KINETIC_LAW_INSTRUCTION_LOAD_COMPARTMENT:
+                stack[top++] = GetCurrentSizeInCompartment( (COMPARTMENT*)program->references[instruction->operand] );
+            break;
+            case KINETIC_LAW_INSTRUCTION_LOAD_SYMBOL:
+                stack[top++] = GetCurrentRealValueInSymbol( (REB2SAC_SYMBOL*)program->references[instruction->operand] );
+            break;
+            case KINETIC_LAW_INSTRUCTION_RATE_SPECIES:
+                stack[top++] = GetRateInSpeciesNode( (SPECIES*)program->references[instruction->operand] );
+            break;
+            case KINETIC_LAW_INSTRUCTION_RATE_COMPARTMENT:
+                stack[top++] = GetCurrentRateInCompartment( (COMPARTMENT*)program->references[instruction->operand] );
+            break;
+            case KINETIC_LAW_INSTRUCTION_RATE_SYMBOL:
+                stack[top++] = GetCurrentRateInSymbol( (REB2SAC_SYMBOL*)program->references[instruction->operand] );
+            break;
+            case KINETIC_LAW_INSTRUCTION_ADD:
+                top--;
+                stack[top-1] = stack[top-1] + stack[top];
+            break;
+            case KINETIC_LAW_INSTRUCTION_SUBTRACT:
+                top--;
+                stack[top-1] = stack[top-1] - stack[top];
+            break;
+            case KINETIC_LAW_INSTRUCTION_MULTIPLY:
+                top--;
+                stack[top-1] = stack[top-1] * stack[top];
+            break;
+            case KINETIC_LAW_INSTRUCTION_DIVIDE:
+                top--;
+                stack[top-1] = stack[top-1] / stack[top];
+            break;
+            case KINETIC_LAW_INSTRUCTION_POW:
+                top--;
+                stack[top-1] = pow( stack[top-1], stack[top] );
+            break;
+            case KINETIC_LAW_INSTRUCTION_EQ:
+                top--;
+                stack[top-1] = ( stack[top-1] == stack[top] );
+            break;
+            case KINETIC_LAW_INSTRUCTION_NEQ:
+                top--;
+                stack[top-1] = ( stack[top-1] != stack[top] );
+            break;
+            case KINETIC_LAW_INSTRUCTION_GEQ:
+                top--;
+                stack[top-1] = ( stack[top-1] >= stack[top] );
+            break;
+            case KINETIC_LAW_INSTRUCTION_GT:
+                top--;
+                stack[top-1] = ( stack[top-1] > stack[top] );
+            break;
+            case KINETIC_LAW_INSTRUCTION_LEQ:
+                top--;
+                stack[top-1] = ( stack[top-1] <= stack[top] );
+            break;
+            case KINETIC_LAW_INSTRUCTION_LT:
+                top--;
+                stack[top-1] = ( stack[top-1] < stack[top] );
+            break;
+            case KINETIC_LAW_INSTRUCTION_AND:
+                top--;
+                stack[top-1] = ( stack[top-1] && stack[top] );
+            break;
+            case KINETIC_LAW_INSTRUCTION_OR:
+                top--;
+                stack[top-1] = ( stack[top-1] || stack[top] );
+            break;
+            case KINETIC_LAW_INSTRUCTION_XOR:
+                top--;
+                stack[top-1] = ( !stack[top-1] && stack[top] ) || ( stack[top-1] && !stack[top] );
+            break;
+            case KINETIC_LAW_INSTRUCTION_NEG:
+                stack[top-1] = (-1) * stack[top-1];
+            break;
+            case KINETIC_LAW_INSTRUCTION_NOT:
+                stack[top-1] = !stack[top-1];
+            break;
+            case KINETIC_LAW_INSTRUCTION_BINARY_OP:
+                top--;
+                stack[top-1] = _ApplyBinaryOp( instruction->opType, stack[top-1], stack[top], context, program->deterministic );
+            break;
+            case KINETIC_LAW_INSTRUCTION_UNARY_OP:
+                stack[top-1] = _ApplyUnaryOp( instruction->opType, stack[top-1], context, program->deterministic );
+            break;
+            case KINETIC_LAW_INSTRUCTION_DELAY:
+                top--;
+                if( IS_FAILED( EvaluateDelayInKineticLaw( (KINETIC_LAW*)program->references[instruction->operand], 
+                                                          stack[top-1], stack[top], program->interpolateDelays, stack + top - 1 ) ) ) {
+                    return -1.0;
+                }
+            break;
+            case KINETIC_LAW_INSTRUCTION_JUMP:
+                pc = instruction->operand;
+            break;
+            case KINETIC_LAW_INSTRUCTION_JUMP_IF_FALSE:
+                top--;
+                if( !stack[top] ) {
+                    pc = instruction->operand;
+                }
+            break;
+            default:
+                return -1.0;
+        }
+    }
+    return stack[0];
+}
+
+
+static RET_VAL _CompileNode( KINETIC_LAW_PROGRAM_BUILDER *builder, KINETIC_LAW *law ) {
+    switch( law->valueType ) {
+        case KINETIC_LAW_VALUE_TYPE_PW:
+            return _CompilePW( builder, law );
+        case KINETIC_LAW_VALUE_TYPE_OP:
+            return _CompileOp( builder, law );
+        case KINETIC_LAW_VALUE_TYPE_UNARY_OP:
+            return _CompileUnaryOp( builder, law );
+        case KINETIC_LAW_VALUE_TYPE_INT:
+            return _EmitConstant( builder, (double)GetIntValueFromKineticLaw( law ) );
+        case KINETIC_LAW_VALUE_TYPE_REAL:
+            return _EmitConstant( builder, GetRealValueFromKineticLaw( law ) );
+        case KINETIC_LAW_VALUE_TYPE_SPECIES:
+            return _CompileSpecies( builder, GetSpeciesFromKineticLaw( law ) );
+        case KINETIC_LAW_VALUE_TYPE_COMPARTMENT:
+            return _CompileVariable( builder, (CADDR_T)GetCompartmentFromKineticLaw( law ), KINETIC_LAW_INSTRUCTION_LOAD_COMPARTMENT );
+        case KINETIC_LAW_VALUE_TYPE_SYMBOL:
+            return _CompileVariable( builder, (CADDR_T)GetSymbolFromKineticLaw( law ), KINETIC_LAW_INSTRUCTION_LOAD_SYMBOL );
+        case KINETIC_LAW_VALUE_TYPE_FUNCTION_SYMBOL:
+            /* the evaluator leaves the value of a function symbol at 0 */
+            return _EmitConstant( builder, 0.0 );
+        default:
+            return E_WRONGDATA;
+    }
+}
+
+/*
+ * The n-ary operators evaluate every child, in order and without short-circuiting, as the 
+ * evaluator does; a chain of comparisons compares each pair of neighbours.
+ */
+static RET_VAL _CompilePW( KINETIC_LAW_PROGRAM_BUILDER *builder, KINETIC_LAW *law ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 num = 0;
+    BYTE opType = GetPWTypeFromKineticLaw( law );
+    BYTE code = 0;
+    LINKED_LIST *children = GetPWChildrenFromKineticLaw( law );
+
+    num = GetLinkedListSize( children );
+    switch( opType ) {
+        case KINETIC_LAW_OP_PW:
+            return _CompilePiecewise( builder, children );
+
+        case KINETIC_LAW_OP_XOR:
+        case KINETIC_LAW_OP_OR:
+        case KINETIC_LAW_OP_PLUS:
+            code = ( opType == KINETIC_LAW_OP_XOR ) ? KINETIC_LAW_INSTRUCTION_XOR :
+                ( ( opType == KINETIC_LAW_OP_OR ) ? KINETIC_LAW_INSTRUCTION_OR : KINETIC_LAW_INSTRUCTION_ADD );
+            if( IS_FAILED( ( ret = _EmitConstant( builder, 0.0 ) ) ) ) {
+                return ret;
+            }
+            for( i = 0; i < num; i++ ) {
+                if( IS_FAILED( ( ret = _CompileNode( builder, (KINETIC_LAW*)GetElementByIndex( i, children ) ) ) ) ) {
+                    return ret;
+                }
+                if( IS_FAILED( ( ret = _Emit( builder, code, 0, 0, 0 ) ) ) ) {
+                    return ret;
+                }
+            }
+            return ret;
+
+        case KINETIC_LAW_OP_AND:
+        case KINETIC_LAW_OP_TIMES:
+            code = ( opType == KINETIC_LAW_OP_AND ) ? KINETIC_LAW_INSTRUCTION_AND : KINETIC_LAW_INSTRUCTION_MULTIPLY;
+            if( IS_FAILED( ( ret = _EmitConstant( builder, 1.0 ) ) ) ) {
+                return ret;
+            }
+            for( i = 0; i < num; i++ ) {
+                if( IS_FAILED( ( ret = _CompileNode( builder, (KINETIC_LAW*)GetElementByIndex( i, children ) ) ) ) ) {
+                    return ret;
+                }
+                if( IS_FAILED( ( ret = _Emit( builder, code, 0, 0, 0 ) ) ) ) {
+                    return ret;
+                }
+            }
+            return ret;
+
+        case KINETIC_LAW_OP_EQ:
+        case KINETIC_LAW_OP_NEQ:
+        case KINETIC_LAW_OP_LEQ:
+        case KINETIC_LAW_OP_LT:
+        case KINETIC_LAW_OP_GEQ:
+        case KINETIC_LAW_OP_GT:
+            code = _GetBinaryInstruction( opType );
+            if( IS_FAILED( ( ret = _EmitConstant( builder, 1.0 ) ) ) ) {
+                return ret;
+            }
+            for( i = 1; i < num; i++ ) {
+                if( IS_FAILED( ( ret = _CompileNode( builder, (KINETIC_LAW*)GetElementByIndex( i - 1, children ) ) ) ) ) {
+                    return ret;
+                }
+                if( IS_FAILED( ( ret = _CompileNode( builder, (KINETIC_LAW*)GetElementByIndex( i, children ) ) ) ) ) {
+                    return ret;
+                }
+                if( IS_FAILED( ( ret = _Emit( builder, code, 0, 0, 0 ) ) ) ) {
+                    return ret;
+                }
+                if( IS_FAILED( ( ret = _Emit( builder, KINETIC_LAW_INSTRUCTION_AND, 0, 0, 0 ) ) ) ) {
+                    return ret;
+                }
+            }
+            return ret;
+
+        default:
+            return E_WRONGDATA;
+    }
+}
+
+/*
+ * piecewise( v1, c1, v2, c2, ..., otherwise ): each condition jumps past its value when 
+ * false, each value jumps to the end.  Without an otherwise the value is 0.
+ */
+static RET_VAL _CompilePiecewise( KINETIC_LAW_PROGRAM_BUILDER *builder, LINKED_LIST *children ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 j = 0;
+    UINT32 num = GetLinkedListSize( children );
+    UINT32 pairs = num / 2;
+    UINT32 branch = 0;
+    UINT32 *exits = NULL;
+    KINETIC_LAW_INSTRUCTION *instructions = NULL;
+
+    if( pairs > 0 ) {
+        if( ( exits = (UINT32*)MALLOC( pairs * sizeof(UINT32) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_CompilePiecewise", "could not allocate memory for jumps" );
+        }
+    }
+    for( i = 1, j = 0; i < num; i += 2, j++ ) {
+        if( IS_FAILED( ( ret = _CompileNode( builder, (KINETIC_LAW*)GetElementByIndex( i, children ) ) ) ) ) {
+            FREE( exits );
+            return ret;
+        }
+        branch = builder->program->instructionsSize;
+        if( IS_FAILED( ( ret = _Emit( builder, KINETIC_LAW_INSTRUCTION_JUMP_IF_FALSE, 0, 0, 0 ) ) ) ) {
+            FREE( exits );
+            return ret;
+        }
+        if( IS_FAILED( ( ret = _CompileNode( builder, (KINETIC_LAW*)GetElementByIndex( i - 1, children ) ) ) ) ) {
+            FREE( exits );
+            return ret;
+        }
+        exits[j] = builder->program->instructionsSize;
+        if( IS_FAILED( ( ret = _Emit( builder, KINETIC_LAW_INSTRUCTION_JUMP, 0, 0, 0 ) ) ) ) {
+            FREE( exits );
+            return ret;
+        }
+        /* the value is on the stack only on the path that took it */
+        builder->depth--;
+        builder->program->instructions[branch].operand = builder->program->instructionsSize;
+    }
+    if( num % 2 == 1 ) {
+        ret = _CompileNode( builder, (KINETIC_LAW*)GetElementByIndex( num - 1, children ) );
+    }
+    else {
+        ret = _EmitConstant( builder, 0.0 );
+    }
+    if( IS_FAILED( ret ) ) {
+        FREE( exits );
+        return ret;
+    }
+    instructions = builder->program->instructions;
+    for( j = 0; j < pairs; j++ ) {
+        instructions[exits[j]].operand = builder->program->instructionsSize;
+    }
+    FREE( exits );
+    return ret;
+}
+
+static RET_VAL _CompileOp( KINETIC_LAW_PROGRAM_BUILDER *builder, KINETIC_LAW *law ) {
+    RET_VAL ret = SUCCESS;
+    BYTE opType = GetOpTypeFromKineticLaw( law );
+
+    if( !_IsSupportedBinaryOp( opType ) ) {
+        return E_WRONGDATA;
+    }
+    if( IS_FAILED( ( ret = _CompileNode( builder, GetOpLeftFromKineticLaw( law ) ) ) ) ) {
+        return ret;
+    }
+    if( IS_FAILED( ( ret = _CompileNode( builder, GetOpRightFromKineticLaw( law ) ) ) ) ) {
+        return ret;
+    }
+    if( opType == KINETIC_LAW_OP_DELAY ) {
+        return _EmitReference( builder, KINETIC_LAW_INSTRUCTION_DELAY, (CADDR_T)law );
+    }
+    return _Emit( builder, _GetBinaryInstruction( opType ), opType, 0, 0 );
+}
+
+static RET_VAL _CompileUnaryOp( KINETIC_LAW_PROGRAM_BUILDER *builder, KINETIC_LAW *law ) {
+    RET_VAL ret = SUCCESS;
+    BYTE opType = GetUnaryOpTypeFromKineticLaw( law );
+    KINETIC_LAW *child = GetUnaryOpChildFromKineticLaw( law );
+
+    if( !_IsSupportedUnaryOp( opType ) ) {
+        return E_WRONGDATA;
+    }
+    if( opType == KINETIC_LAW_UNARY_OP_RATE ) {
+        if( IsSymbolKineticLaw( child ) ) {
+            return _EmitReference( builder, KINETIC_LAW_INSTRUCTION_RATE_SYMBOL, (CADDR_T)GetSymbolFromKineticLaw( child ) );
+        } 
+        else if( IsSpeciesKineticLaw( child ) ) {
+            return _EmitReference( builder, KINETIC_LAW_INSTRUCTION_RATE_SPECIES, (CADDR_T)GetSpeciesFromKineticLaw( child ) );
+        } 
+        else if( IsCompartmentKineticLaw( child ) ) {
+            return _EmitReference( builder, KINETIC_LAW_INSTRUCTION_RATE_COMPARTMENT, (CADDR_T)GetCompartmentFromKineticLaw( child ) );
+        }
+        return E_WRONGDATA;
+    }
+    if( IS_FAILED( ( ret = _CompileNode( builder, child ) ) ) ) {
+        return ret;
+    }
+    switch( opType ) {
+        case KINETIC_LAW_UNARY_OP_NEG:
+            return _Emit( builder, KINETIC_LAW_INSTRUCTION_NEG, opType, 0, 0 );
+        case KINETIC_LAW_UNARY_OP_NOT:
+            return _Emit( builder, KINETIC_LAW_INSTRUCTION_NOT, opType, 0, 0 );
+        default:
+            return _Emit( builder, KINETIC_LAW_INSTRUCTION_UNARY_OP, opType, 0, 0 );
+    }
+}
+
+/*
+ * A species in amount units is read from the values block as is; one in concentration 
+ * units is divided by the size of its compartment, unless that size is undefined.
+ */
+static RET_VAL _CompileSpecies( KINETIC_LAW_PROGRAM_BUILDER *builder, SPECIES *species ) {
+    UINT32 index = 0;
+    UINT32 compartmentIndex = 0;
+    COMPARTMENT *compartment = NULL;
+    SIM_STATE *state = builder->compiler->state;
+
+    if( FindVariableInSimState( state, (CADDR_T)species, &index ) ) {
+        if( HasOnlySubstanceUnitsInSpeciesNode( species ) ) {
+            return _Emit( builder, KINETIC_LAW_INSTRUCTION_LOAD, 0, index, 0 );
+        }
+        compartment = GetCompartmentInSpeciesNode( species );
+        if( ( compartment != NULL ) && FindVariableInSimState( state, (CADDR_T)compartment, &compartmentIndex ) ) {
+            return _Emit( builder, KINETIC_LAW_INSTRUCTION_LOAD_CONCENTRATION, 0, index, compartmentIndex );
+        }
+    }
+    return _EmitReference( builder, KINETIC_LAW_INSTRUCTION_LOAD_SPECIES, (CADDR_T)species );
+}
+
+static RET_VAL _CompileVariable( KINETIC_LAW_PROGRAM_BUILDER *builder, CADDR_T node, BYTE referenceCode ) {
+    UINT32 index = 0;
+
+    if( FindVariableInSimState( builder->compiler->state, node, &index ) ) {
+        return _Emit( builder, KINETIC_LAW_INSTRUCTION_LOAD, 0, index, 0 );
+    }
+    return _EmitReference( builder, referenceCode, node );
+}
+
+static RET_VAL _Emit( KINETIC_LAW_PROGRAM_BUILDER *builder, BYTE code, BYTE opType, UINT32 operand, UINT32 operand2 ) {
+    UINT32 capacity = 0;
+    KINETIC_LAW_INSTRUCTION *instruction = NULL;
+    KINETIC_LAW_PROGRAM *program = builder->program;
+
+    if( program->instructionsSize == builder->instructionsCapacity ) {
+        capacity = GET_MAX( 2 * builder->instructionsCapacity, 16 );
+        if( ( instruction = (KINETIC_LAW_INSTRUCTION*)REALLOC( program->instructions, 
+                                                               capacity * sizeof(KINETIC_LAW_INSTRUCTION) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_Emit", "could not allocate memory for instructions" );
+        }
+        program->instructions = instruction;
+        builder->instructionsCapacity = capacity;
+    }
+    instruction = program->instructions + program->instructionsSize;
+    instruction->code = code;
+    instruction->opType = opType;
+    instruction->operand = operand;
+    instruction->operand2 = operand2;
+    program->instructionsSize++;
+
+    switch( code ) {
+        case KINETIC_LAW_INSTRUCTION_CONSTANT:
+        case KINETIC_LAW_INSTRUCTION_LOAD:
+        case KINETIC_LAW_INSTRUCTION_LOAD_CONCENTRATION:
+        case KINETIC_LAW_INSTRUCTION_LOAD_SPECIES:
+        case KINETIC_LAW_INSTRUCTION_LOAD_COMPARTMENT:
+        case KINETIC_LAW_INSTRUCTION_LOAD_SYMBOL:
+        case KINETIC_LAW_INSTRUCTION_RATE_SPECIES:
+        case KINETIC_LAW_INSTRUCTION_RATE_COMPARTMENT:
+        case KINETIC_LAW_INSTRUCTION_RATE_SYMBOL:
+            builder->depth++;
+        break;
+        case KINETIC_LAW_INSTRUCTION_NEG:
+        case KINETIC_LAW_INSTRUCTION_NOT:
+        case KINETIC_LAW_INSTRUCTION_UNARY_OP:
+        case KINETIC_LAW_INSTRUCTION_JUMP:
+        break;
+        default:
+            builder->depth--;
+        break;
+    }
+    if( builder->depth > program->stackSize ) {
+        program->stackSize = builder->depth;
+        if( program->stackSize > KINETIC_LAW_PROGRAM_MAX_STACK_SIZE ) {
+            return E_WRONGDATA;
+        }
+    }
+    return SUCCESS;
+}
+
+static RET_VAL _EmitConstant( KINETIC_LAW_PROGRAM_BUILDER *builder, double value ) {
+    UINT32 capacity = 0;
+    double *constants = NULL;
+    KINETIC_LAW_PROGRAM *program = builder->program;
+
+    if( program->constantsSize == builder->constantsCapacity ) {
+        capacity = GET_MAX( 2 * builder->constantsCapacity, 8 );
+        if( ( constants = (double*)REALLOC( program->constants, capacity * sizeof(double) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_EmitConstant", "could not allocate memory for constants" );
+        }
+        program->constants = constants;
+        builder->constantsCapacity = capacity;
+    }
+    program->constants[program->constantsSize] = value;
+    program->constantsSize++;
+    return _Emit( builder, KINETIC_LAW_INSTRUCTION_CONSTANT, 0, program->constantsSize - 1, 0 );
+}
+
+static RET_VAL _EmitReference( KINETIC_LAW_PROGRAM_BUILDER *builder, BYTE code, CADDR_T reference ) {
+    UINT32 capacity = 0;
+    CADDR_T *references = NULL;
+    KINETIC_LAW_PROGRAM *program = builder->program;
+
+    if( program->referencesSize == builder->referencesCapacity ) {
+        capacity = GET_MAX( 2 * builder->referencesCapacity, 4 );
+        if( ( references = (CADDR_T*)REALLOC( program->references, capacity * sizeof(CADDR_T) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_EmitReference", "could not allocate memory for references" );
+        }
+        program->references = references;
+        builder->referencesCapacity = capacity;
+    }
+    program->references[program->referencesSize] = reference;
+    program->referencesSize++;
+    return _Emit( builder, code, 0, program->referencesSize - 1, 0 );
+}
+
+static BYTE _GetBinaryInstruction( BYTE opType ) {
+    switch( opType ) {
+        case KINETIC_LAW_OP_PLUS:
+            return KINETIC_LAW_INSTRUCTION_ADD;
+        case KINETIC_LAW_OP_MINUS:
+            return KINETIC_LAW_INSTRUCTION_SUBTRACT;
+        case KINETIC_LAW_OP_TIMES:
+            return KINETIC_LAW_INSTRUCTION_MULTIPLY;
+        case KINETIC_LAW_OP_DIVIDE:
+            return KINETIC_LAW_INSTRUCTION_DIVIDE;
+        case KINETIC_LAW_OP_POW:
+            return KINETIC_LAW_INSTRUCTION_POW;
+        case KINETIC_LAW_OP_EQ:
+            return KINETIC_LAW_INSTRUCTION_EQ;
+        case KINETIC_LAW_OP_NEQ:
+            return KINETIC_LAW_INSTRUCTION_NEQ;
+        case KINETIC_LAW_OP_GEQ:
+            return KINETIC_LAW_INSTRUCTION_GEQ;
+        case KINETIC_LAW_OP_GT:
+            return KINETIC_LAW_INSTRUCTION_GT;
+        case KINETIC_LAW_OP_LEQ:
+            return KINETIC_LAW_INSTRUCTION_LEQ;
+        case KINETIC_LAW_OP_LT:
+            return KINETIC_LAW_INSTRUCTION_LT;
+        case KINETIC_LAW_OP_AND:
+            return KINETIC_LAW_INSTRUCTION_AND;
+        case KINETIC_LAW_OP_OR:
+            return KINETIC_LAW_INSTRUCTION_OR;
+        case KINETIC_LAW_OP_XOR:
+            return KINETIC_LAW_INSTRUCTION_XOR;
+        default:
+            return KINETIC_LAW_INSTRUCTION_BINARY_OP;
+    }
+}
+
+static BOOL _IsSupportedBinaryOp( BYTE opType ) {
+    switch( opType ) {
+        case KINETIC_LAW_OP_PLUS:
+        case KINETIC_LAW_OP_MINUS:
+        case KINETIC_LAW_OP_TIMES:
+        case KINETIC_LAW_OP_DIVIDE:
+        case KINETIC_LAW_OP_POW:
+        case KINETIC_LAW_OP_LOG:
+        case KINETIC_LAW_OP_DELAY:
+        case KINETIC_LAW_OP_ROOT:
+        case KINETIC_LAW_OP_AND:
+        case KINETIC_LAW_OP_OR:
+        case KINETIC_LAW_OP_XOR:
+        case KINETIC_LAW_OP_EQ:
+        case KINETIC_LAW_OP_NEQ:
+        case KINETIC_LAW_OP_GEQ:
+        case KINETIC_LAW_OP_GT:
+        case KINETIC_LAW_OP_LEQ:
+        case KINETIC_LAW_OP_LT:
+        case KINETIC_LAW_OP_UNIFORM:
+        case KINETIC_LAW_OP_NORMAL:
+        case KINETIC_LAW_OP_BINOMIAL:
+        case KINETIC_LAW_OP_GAMMA:
+        case KINETIC_LAW_OP_LOGNORMAL:
+        case KINETIC_LAW_OP_BITWISE_AND:
+        case KINETIC_LAW_OP_BITWISE_OR:
+        case KINETIC_LAW_OP_BITWISE_XOR:
+        case KINETIC_LAW_OP_MOD:
+        case KINETIC_LAW_OP_BIT:
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
+
+static BOOL _IsSupportedUnaryOp( BYTE opType ) {
+    switch( opType ) {
+        case KINETIC_LAW_UNARY_OP_NEG:
+        case KINETIC_LAW_UNARY_OP_NOT:
+        case KINETIC_LAW_UNARY_OP_ABS:
+        case KINETIC_LAW_UNARY_OP_COT:
+        case KINETIC_LAW_UNARY_OP_COTH:
+        case KINETIC_LAW_UNARY_OP_CSC:
+        case KINETIC_LAW_UNARY_OP_CSCH:
+        case KINETIC_LAW_UNARY_OP_SEC:
+        case KINETIC_LAW_UNARY_OP_SECH:
+        case KINETIC_LAW_UNARY_OP_COS:
+        case KINETIC_LAW_UNARY_OP_COSH:
+        case KINETIC_LAW_UNARY_OP_SIN:
+        case KINETIC_LAW_UNARY_OP_SINH:
+        case KINETIC_LAW_UNARY_OP_TAN:
+        case KINETIC_LAW_UNARY_OP_TANH:
+        case KINETIC_LAW_UNARY_OP_ARCCOT:
+        case KINETIC_LAW_UNARY_OP_ARCCOTH:
+        case KINETIC_LAW_UNARY_OP_ARCCSC:
+        case KINETIC_LAW_UNARY_OP_ARCCSCH:
+        case KINETIC_LAW_UNARY_OP_ARCSEC:
+        case KINETIC_LAW_UNARY_OP_ARCSECH:
+        case KINETIC_LAW_UNARY_OP_ARCCOS:
+        case KINETIC_LAW_UNARY_OP_ARCCOSH:
+        case KINETIC_LAW_UNARY_OP_ARCSIN:
+        case KINETIC_LAW_UNARY_OP_ARCSINH:
+        case KINETIC_LAW_UNARY_OP_ARCTAN:
+        case KINETIC_LAW_UNARY_OP_ARCTANH:
+        case KINETIC_LAW_UNARY_OP_CEILING:
+        case KINETIC_LAW_UNARY_OP_EXP:
+        case KINETIC_LAW_UNARY_OP_FACTORIAL:
+        case KINETIC_LAW_UNARY_OP_FLOOR:
+        case KINETIC_LAW_UNARY_OP_LN:
+        case KINETIC_LAW_UNARY_OP_EXPRAND:
+        case KINETIC_LAW_UNARY_OP_POISSON:
+        case KINETIC_LAW_UNARY_OP_CHISQ:
+        case KINETIC_LAW_UNARY_OP_LAPLACE:
+        case KINETIC_LAW_UNARY_OP_CAUCHY:
+        case KINETIC_LAW_UNARY_OP_RAYLEIGH:
+        case KINETIC_LAW_UNARY_OP_BERNOULLI:
+        case KINETIC_LAW_UNARY_OP_RATE:
+        case KINETIC_LAW_UNARY_OP_BITWISE_NOT:
+        case KINETIC_LAW_UNARY_OP_INT:
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
+
+static double _ApplyBinaryOp( BYTE opType, double leftValue, double rightValue, RANDOM_NUMBER_CONTEXT *context, BOOL deterministic ) {
+    switch( opType ) {
+        case KINETIC_LAW_OP_LOG:
+            return log( rightValue ) / log( leftValue );
+        case KINETIC_LAW_OP_ROOT:
+            return pow( rightValue, ( 1. / leftValue ) );
+        case KINETIC_LAW_OP_UNIFORM:
+            return deterministic ? ( leftValue + rightValue ) / 2 : 
+                GetNextUniformRandomNumberInContext( context, leftValue, rightValue );
+        case KINETIC_LAW_OP_NORMAL:
+            return deterministic ? leftValue : 
+                GetNextNormalRandomNumberInContext( context, leftValue, rightValue );
+        case KINETIC_LAW_OP_BINOMIAL:
+            return deterministic ? ( leftValue * rightValue ) : 
+                GetNextBinomialRandomNumberInContext( context, leftValue, (unsigned int)rightValue );
+        case KINETIC_LAW_OP_GAMMA:
+            return deterministic ? ( leftValue * rightValue ) : 
+                GetNextGammaRandomNumberInContext( context, leftValue, rightValue );
+        case KINETIC_LAW_OP_LOGNORMAL:
+            return deterministic ? exp( leftValue + ( rightValue * rightValue ) / 2 ) : 
+                GetNextLogNormalRandomNumberInContext( context, leftValue, rightValue );
+        case KINETIC_LAW_OP_BITWISE_AND:
+            return ( (int)rint( leftValue ) & (int)rint( rightValue ) );
+        case KINETIC_LAW_OP_BITWISE_OR:
+            return ( (int)rint( leftValue ) | (int)rint( rightValue ) );
+        case KINETIC_LAW_OP_BITWISE_XOR:
+            return ( (int)rint( leftValue ) ^ (int)rint( rightValue ) );
+        case KINETIC_LAW_OP_MOD:
+            return ( (int)rint( leftValue ) % (int)rint( rightValue ) );
+        case KINETIC_LAW_OP_BIT:
+            return ( (int)rint( leftValue ) >> (int)rint( rightValue ) ) & 1;
+        default:
+            return 0.0;
+    }
+}
+
+static double _ApplyUnaryOp( BYTE opType, double childValue, RANDOM_NUMBER_CONTEXT *context, BOOL deterministic ) {
+    double result = 0.0;
+    UINT i = 0;
+
+    switch( opType ) {
+        case KINETIC_LAW_UNARY_OP_ABS:
+            return fabs( childValue );
+        case KINETIC_LAW_UNARY_OP_COT:
+            return ( 1. / tan( childValue ) );
+        case KINETIC_LAW_UNARY_OP_COTH:
+            return cosh( childValue ) / sinh( childValue );
+        case KINETIC_LAW_UNARY_OP_CSC:
+            return ( 1. / sin( childValue ) );
+        case KINETIC_LAW_UNARY_OP_CSCH:
+            return ( 1. / cosh( childValue ) );
+        case KINETIC_LAW_UNARY_OP_SEC:
+            return ( 1. / cos( childValue ) );
+        case KINETIC_LAW_UNARY_OP_SECH:
+            return ( 1. / sinh( childValue ) );
+        case KINETIC_LAW_UNARY_OP_COS:
+            return cos( childValue );
+        case KINETIC_LAW_UNARY_OP_COSH:
+            return cosh( childValue );
+        case KINETIC_LAW_UNARY_OP_SIN:
+            return sin( childValue );
+        case KINETIC_LAW_UNARY_OP_SINH:
+            return sinh( childValue );
+        case KINETIC_LAW_UNARY_OP_TAN:
+            return tan( childValue );
+        case KINETIC_LAW_UNARY_OP_TANH:
+            return tanh( childValue );
+        case KINETIC_LAW_UNARY_OP_ARCCOT:
+            return atan( 1. / ( childValue ) );
+        case KINETIC_LAW_UNARY_OP_ARCCOTH:
+            return ( ( 1. / 2. ) * log( ( childValue + 1. ) / ( childValue - 1. ) ) );
+        case KINETIC_LAW_UNARY_OP_ARCCSC:
+            return asin( 1. / childValue );
+        case KINETIC_LAW_UNARY_OP_ARCCSCH:
+            return log( 1. / childValue + SQRT( 1. / SQR( childValue ) + 1 ) );
+        case KINETIC_LAW_UNARY_OP_ARCSEC:
+            return acos( 1. / childValue );
+        case KINETIC_LAW_UNARY_OP_ARCSECH:
+            return log( 1. / childValue + SQRT( 1. / childValue + 1 ) * SQRT( 1. / childValue - 1 ) );
+        case KINETIC_LAW_UNARY_OP_ARCCOS:
+            return acos( childValue );
+        case KINETIC_LAW_UNARY_OP_ARCCOSH:
+            return acosh( childValue );
+        case KINETIC_LAW_UNARY_OP_ARCSIN:
+            return asin( childValue );
+        case KINETIC_LAW_UNARY_OP_ARCSINH:
+            return asinh( childValue );
+        case KINETIC_LAW_UNARY_OP_ARCTAN:
+            return atan( childValue );
+        case KINETIC_LAW_UNARY_OP_ARCTANH:
+            return atanh( childValue );
+        case KINETIC_LAW_UNARY_OP_CEILING:
+            return ceil( childValue );
+        case KINETIC_LAW_UNARY_OP_EXP:
+            return exp( childValue );
+        case KINETIC_LAW_UNARY_OP_FACTORIAL:
+            i = floor( childValue );
+            for( result = 1; i > 1; --i ) {
+                result *= i;
+            }
+            return result;
+        case KINETIC_LAW_UNARY_OP_FLOOR:
+            return floor( childValue );
+        case KINETIC_LAW_UNARY_OP_LN:
+            return log( childValue );
+        case KINETIC_LAW_UNARY_OP_EXPRAND:
+            return deterministic ? 1 / childValue : GetNextExponentialRandomNumberInContext( context, childValue );
+        case KINETIC_LAW_UNARY_OP_POISSON:
+            return deterministic ? childValue : GetNextPoissonRandomNumberInContext( context, childValue );
+        case KINETIC_LAW_UNARY_OP_CHISQ:
+            return deterministic ? childValue : GetNextChiSquaredRandomNumberInContext( context, childValue );
+        case KINETIC_LAW_UNARY_OP_LAPLACE:
+            return deterministic ? 0 : GetNextLaplaceRandomNumberInContext( context, childValue );
+        case KINETIC_LAW_UNARY_OP_CAUCHY:
+            return deterministic ? childValue : GetNextCauchyRandomNumberInContext( context, childValue );
+        case KINETIC_LAW_UNARY_OP_RAYLEIGH:
+            return deterministic ? childValue : GetNextRayleighRandomNumberInContext( context, childValue );
+        case KINETIC_LAW_UNARY_OP_BERNOULLI:
+            return deterministic ? childValue : GetNextBernoulliRandomNumberInContext( context, childValue );
+        case KINETIC_LAW_UNARY_OP_BITWISE_NOT:
+            return ~( (int)rint( childValue ) );
+        case KINETIC_LAW_UNARY_OP_INT:
+            return childValue;
+        default:
+            return 0.0;
+    }
+}
+
+static void _FreeProgram( KINETIC_LAW_PROGRAM **program ) {
+    KINETIC_LAW_PROGRAM *target = *program;
+
+    if( target == NULL ) {
+        return;
+    }
+    FREE( target->instructions );
+    FREE( target->constants );
+    FREE( target->references );
+    FREE( *program );
+}
+
+static RET_VAL _FreePrograms( HASH_TABLE **programs ) {
+    LINKED_LIST *list = NULL;
+    KINETIC_LAW_PROGRAM *program = NULL;
+
+    if( *programs == NULL ) {
+        return SUCCESS;
+    }
+    if( ( list = GenerateValueList( *programs ) ) != NULL ) {
+        ResetCurrentElement( list );
+        while( ( program = (KINETIC_LAW_PROGRAM*)GetNextFromLinkedList( list ) ) != NULL ) {
+            _FreeProgram( &program );
+        }
+        DeleteLinkedList( &list );
+    }
+    return DeleteHashTable( programs );
+}
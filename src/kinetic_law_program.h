@@ -0,0 +1,122 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the reb2sac contributors                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#if !defined(HAVE_KINETIC_LAW_PROGRAM)
+#define HAVE_KINETIC_LAW_PROGRAM
+
+#include "common.h"
+#include "hash_table.h"
+#include "kinetic_law.h"
+#include "kinetic_law_evaluater.h"
+#include "sim_state.h"
+
+BEGIN_C_NAMESPACE
+
+#define KINETIC_LAW_PROGRAM_MAX_STACK_SIZE 256
+
+#define KINETIC_LAW_INSTRUCTION_CONSTANT ((BYTE)1)
+#define KINETIC_LAW_INSTRUCTION_LOAD ((BYTE)2)
+#define KINETIC_LAW_INSTRUCTION_LOAD_CONCENTRATION ((BYTE)3)
+#define KINETIC_LAW_INSTRUCTION_LOAD_SPECIES ((BYTE)4)
+#define KINETIC_LAW_INSTRUCTION_LOAD_COMPARTMENT ((BYTE)5)
+#define KINETIC_LAW_INSTRUCTION_LOAD_SYMBOL ((BYTE)6)
+#define KINETIC_LAW_INSTRUCTION_RATE_SPECIES ((BYTE)7)
+#define KINETIC_LAW_INSTRUCTION_RATE_COMPARTMENT ((BYTE)8)
+#define KINETIC_LAW_INSTRUCTION_RATE_SYMBOL ((BYTE)9)
+#define KINETIC_LAW_INSTRUCTION_ADD ((BYTE)10)
+#define KINETIC_LAW_INSTRUCTION_SUBTRACT ((BYTE)11)
+#define KINETIC_LAW_INSTRUCTION_MULTIPLY ((BYTE)12)
+#define KINETIC_LAW_INSTRUCTION_DIVIDE ((BYTE)13)
+#define KINETIC_LAW_INSTRUCTION_POW ((BYTE)14)
+#define KINETIC_LAW_INSTRUCTION_EQ ((BYTE)15)
+#define KINETIC_LAW_INSTRUCTION_NEQ ((BYTE)16)
+#define KINETIC_LAW_INSTRUCTION_GEQ ((BYTE)17)
+#define KINETIC_LAW_INSTRUCTION_GT ((BYTE)18)
+#define KINETIC_LAW_INSTRUCTION_LEQ ((BYTE)19)
+#define KINETIC_LAW_INSTRUCTION_LT ((BYTE)20)
+#define KINETIC_LAW_INSTRUCTION_AND ((BYTE)21)
+#define KINETIC_LAW_INSTRUCTION_OR ((BYTE)22)
+#define KINETIC_LAW_INSTRUCTION_XOR ((BYTE)23)
+#define KINETIC_LAW_INSTRUCTION_NEG ((BYTE)24)
+#define KINETIC_LAW_INSTRUCTION_NOT ((BYTE)25)
+#define KINETIC_LAW_INSTRUCTION_BINARY_OP ((BYTE)26)
+#define KINETIC_LAW_INSTRUCTION_UNARY_OP ((BYTE)27)
+#define KINETIC_LAW_INSTRUCTION_DELAY ((BYTE)28)
+#define KINETIC_LAW_INSTRUCTION_JUMP ((BYTE)29)
+#define KINETIC_LAW_INSTRUCTION_JUMP_IF_FALSE ((BYTE)30)
+
+/*
+ * One instruction of a compiled kinetic law.  The common operations have their own codes; 
+ * the rest are BINARY_OP and UNARY_OP instructions that carry the KINETIC_LAW_OP_* or 
+ * KINETIC_LAW_UNARY_OP_* type of the original node.  The operand is an index into the 
+ * values block, the constants, the references or the instructions, depending on the code.
+ */
+typedef struct {
+    BYTE code;
+    BYTE opType;
+    UINT32 operand;
+    UINT32 operand2;
+} KINETIC_LAW_INSTRUCTION;
+
+struct _KINETIC_LAW_PROGRAM;
+typedef struct _KINETIC_LAW_PROGRAM KINETIC_LAW_PROGRAM;
+
+/*
+ * A kinetic law compiled to postfix code for a stack machine.  Species, compartments and 
+ * symbols of the compiler's SIM_STATE are read from its values block; the others, and the 
+ * nodes that delay() and rateOf() need, are kept as references.  A deterministic program 
+ * replaces every random distribution by its mean, as EvaluateWithCurrentAmountsDeter does.
+ * Delays are looked up with interpolation when the compiler was set to interpolate them.
+ */
+struct _KINETIC_LAW_PROGRAM {
+    KINETIC_LAW *law;
+    BOOL deterministic;
+    BOOL interpolateDelays;
+    KINETIC_LAW_INSTRUCTION *instructions;
+    UINT32 instructionsSize;
+    double *constants;
+    UINT32 constantsSize;
+    CADDR_T *references;
+    UINT32 referencesSize;
+    UINT32 stackSize;
+};
+
+struct _KINETIC_LAW_COMPILER;
+typedef struct _KINETIC_LAW_COMPILER KINETIC_LAW_COMPILER;
+
+/*
+ * Programs read the values block of the SIM_STATE the compiler was created from.  
+ * Compiled programs are cached by kinetic law and mode.  ODE simulators set interpolateDelays 
+ * before compiling, since their delay histories are sampled at the solver's steps.
+ */
+struct _KINETIC_LAW_COMPILER {
+    SIM_STATE *state;
+    BOOL interpolateDelays;
+    HASH_TABLE *programs;
+    HASH_TABLE *deterministicPrograms;
+};
+
+KINETIC_LAW_COMPILER *CreateKineticLawCompiler( SIM_STATE *state );
+RET_VAL FreeKineticLawCompiler( KINETIC_LAW_COMPILER **compiler );
+
+KINETIC_LAW_PROGRAM *CompileKineticLaw( KINETIC_LAW_COMPILER *compiler, KINETIC_LAW *law, BOOL deterministic );
+double EvaluateKineticLawProgram( KINETIC_LAW_PROGRAM *program, double *values, RANDOM_NUMBER_CONTEXT *context );
+
+END_C_NAMESPACE
+
+#endif
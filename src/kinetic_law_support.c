@@ -73,24 +73,22 @@ RET_VAL FreeKineticLawSupport( KINETIC_LAW_SUPPORT **support ) {
 
 
 static LINKED_LIST* _Support( KINETIC_LAW_SUPPORT *support, KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;
 
     START_FUNCTION("_Support");
 
     LINKED_LIST *result = CreateLinkedList();
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitPW = _VisitPWToSupport;
-        visitor.VisitOp = _VisitOpToSupport;
-        visitor.VisitUnaryOp = _VisitUnaryOpToSupport;
-        visitor.VisitInt = _VisitIntToSupport;
-        visitor.VisitReal = _VisitRealToSupport;
-        visitor.VisitSpecies = _VisitSpeciesToSupport;
-        visitor.VisitCompartment = _VisitCompartmentToSupport;
-        visitor.VisitSymbol = _VisitSymbolToSupport;
-        visitor.VisitFunctionSymbol = _VisitFunctionSymbolToSupport;
-    }
+    visitor.VisitPW = _VisitPWToSupport;
+    visitor.VisitOp = _VisitOpToSupport;
+    visitor.VisitUnaryOp = _VisitUnaryOpToSupport;
+    visitor.VisitInt = _VisitIntToSupport;
+    visitor.VisitReal = _VisitRealToSupport;
+    visitor.VisitSpecies = _VisitSpeciesToSupport;
+    visitor.VisitCompartment = _VisitCompartmentToSupport;
+    visitor.VisitSymbol = _VisitSymbolToSupport;
+    visitor.VisitFunctionSymbol = _VisitFunctionSymbolToSupport;
     
     visitor._internal1 = (CADDR_T)support;
     visitor._internal2 = (CADDR_T)result;
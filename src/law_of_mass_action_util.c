@@ -637,18 +637,17 @@ static BOOL  _FindRateConstant( KINETIC_LAW *kineticLaw, double *result ) {
     return TRUE;
 
 #else    
-    static KINETIC_LAW_VISITOR rateConstantFinderVisitor;
+    KINETIC_LAW_VISITOR rateConstantFinderVisitor;
     double rateConstant = 0.0; 
 
     START_FUNCTION("_FindRateConstant");
     
-    if( rateConstantFinderVisitor.VisitOp == NULL ) {
-        rateConstantFinderVisitor.VisitOp = _VisitOpToFindRateConstant;
-        rateConstantFinderVisitor.VisitInt = _VisitIntToFindRateConstant;
-        rateConstantFinderVisitor.VisitReal = _VisitRealToFindRateConstant;
-        rateConstantFinderVisitor.VisitSpecies = _VisitSpeciesToFindRateConstant;
-        rateConstantFinderVisitor.VisitSymbol = _VisitSymbolToFindRateConstant;
-    }
+    memset( &rateConstantFinderVisitor, 0, sizeof(rateConstantFinderVisitor) );
+    rateConstantFinderVisitor.VisitOp = _VisitOpToFindRateConstant;
+    rateConstantFinderVisitor.VisitInt = _VisitIntToFindRateConstant;
+    rateConstantFinderVisitor.VisitReal = _VisitRealToFindRateConstant;
+    rateConstantFinderVisitor.VisitSpecies = _VisitSpeciesToFindRateConstant;
+    rateConstantFinderVisitor.VisitSymbol = _VisitSymbolToFindRateConstant;
     rateConstant = 1.0;
     rateConstantFinderVisitor._internal1 = (CADDR_T)(&rateConstant);
     
@@ -811,18 +810,17 @@ static RET_VAL _VisitSymbolToFindRateConstant( KINETIC_LAW_VISITOR *visitor, KIN
 
 
 static BOOL _FindSpecies( KINETIC_LAW *kineticLaw, SPECIES *species ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     BOOL flag = FALSE;
     
     START_FUNCTION("_FindSpecies");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToFindSpecies;
-        visitor.VisitInt = _VisitIntToFindSpecies;
-        visitor.VisitReal = _VisitRealToFindSpecies;
-        visitor.VisitSpecies = _VisitSpeciesToFindSpecies;
-        visitor.VisitSymbol = _VisitSymbolToFindSpecies;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToFindSpecies;
+    visitor.VisitInt = _VisitIntToFindSpecies;
+    visitor.VisitReal = _VisitRealToFindSpecies;
+    visitor.VisitSpecies = _VisitSpeciesToFindSpecies;
+    visitor.VisitSymbol = _VisitSymbolToFindSpecies;
     
     visitor._internal1 = (CADDR_T)species;
     visitor._internal2 = (CADDR_T)(&flag);
@@ -878,18 +876,17 @@ static RET_VAL _VisitSpeciesToFindSpecies( KINETIC_LAW_VISITOR *visitor, KINETIC
 
 
 static BOOL _ContainSpecies( KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     BOOL flag = FALSE;
     
     START_FUNCTION("_ContainSpecies");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToContainSpecies;
-        visitor.VisitInt = _VisitIntToContainSpecies;
-        visitor.VisitReal = _VisitRealToContainSpecies;
-        visitor.VisitSpecies = _VisitSpeciesToContainSpecies;
-        visitor.VisitSymbol = _VisitSymbolToContainSpecies;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToContainSpecies;
+    visitor.VisitInt = _VisitIntToContainSpecies;
+    visitor.VisitReal = _VisitRealToContainSpecies;
+    visitor.VisitSpecies = _VisitSpeciesToContainSpecies;
+    visitor.VisitSymbol = _VisitSymbolToContainSpecies;
     
     visitor._internal1 = (CADDR_T)(&flag);
     
@@ -941,17 +938,16 @@ static RET_VAL _VisitSymbolToContainSpecies( KINETIC_LAW_VISITOR *visitor, KINET
 
 
 static KINETIC_LAW *_FindDivisor( KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     
     START_FUNCTION("_FindDivisor");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToFindDivisor;
-        visitor.VisitInt = _VisitIntToFindDivisor;
-        visitor.VisitReal = _VisitRealToFindDivisor;
-        visitor.VisitSpecies = _VisitSpeciesToFindDivisor;
-        visitor.VisitSymbol = _VisitSymbolToFindDivisor;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToFindDivisor;
+    visitor.VisitInt = _VisitIntToFindDivisor;
+    visitor.VisitReal = _VisitRealToFindDivisor;
+    visitor.VisitSpecies = _VisitSpeciesToFindDivisor;
+    visitor.VisitSymbol = _VisitSymbolToFindDivisor;
     
     visitor._internal1 = NULL;
     
@@ -1021,7 +1017,6 @@ static RET_VAL _VisitSymbolToFindDivisor( KINETIC_LAW_VISITOR *visitor, KINETIC_
 
 
 static BOOL _FindCriticalConcentrationLevel( KINETIC_LAW *kineticLaw, SPECIES *species, double *result ) {
-    static KINETIC_LAW_VISITOR visitor;
     double rateConstant = 1.0;
     double power = 0.0;
     KINETIC_LAW *term = NULL;
@@ -1188,17 +1183,16 @@ static RET_VAL __AddListOfCriticalConcentrationLevels( KINETIC_LAW *kineticLaw,
 
 
 static BOOL _IsKineticLawMultipleOfSpecies(  KINETIC_LAW *kineticLaw, SPECIES *species ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     
     START_FUNCTION("_IsKineticLawMultipleOfSpecies");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpMultipleOfSpecies;
-        visitor.VisitInt = _VisitIntMultipleOfSpecies;
-        visitor.VisitReal = _VisitRealMultipleOfSpecies;
-        visitor.VisitSpecies = _VisitSpeciesMultipleOfSpecies;
-        visitor.VisitSymbol = _VisitSymbolMultipleOfSpecies;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpMultipleOfSpecies;
+    visitor.VisitInt = _VisitIntMultipleOfSpecies;
+    visitor.VisitReal = _VisitRealMultipleOfSpecies;
+    visitor.VisitSpecies = _VisitSpeciesMultipleOfSpecies;
+    visitor.VisitSymbol = _VisitSymbolMultipleOfSpecies;
     
     visitor._internal1 = (CADDR_T)species;
     
@@ -1292,18 +1286,17 @@ static RET_VAL _VisitSpeciesMultipleOfSpecies( KINETIC_LAW_VISITOR *visitor, KIN
 
 
 static KINETIC_LAW *_CreateMassActionRatio( KINETIC_LAW *forward, SPECIES *op, double rateRatio  ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     KINETIC_LAW *massActionRatio = NULL;
     
     START_FUNCTION("_CreateMassActionRatio");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToCreateMassActionRatio;
-        visitor.VisitInt = _VisitIntToCreateMassActionRatio;
-        visitor.VisitReal = _VisitRealToCreateMassActionRatio;
-        visitor.VisitSpecies = _VisitSpeciesToCreateMassActionRatio;
-        visitor.VisitSymbol = _VisitSymbolToCreateMassActionRatio;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToCreateMassActionRatio;
+    visitor.VisitInt = _VisitIntToCreateMassActionRatio;
+    visitor.VisitReal = _VisitRealToCreateMassActionRatio;
+    visitor.VisitSpecies = _VisitSpeciesToCreateMassActionRatio;
+    visitor.VisitSymbol = _VisitSymbolToCreateMassActionRatio;
     
     if( ( massActionRatio = CreateRealValueKineticLaw( rateRatio ) ) == NULL ) {
         END_FUNCTION("_CreateMassActionRatio", FAILING );
@@ -1423,18 +1416,17 @@ static RET_VAL _VisitSpeciesToCreateMassActionRatio( KINETIC_LAW_VISITOR *visito
 
 
 static KINETIC_LAW *_CreateRateConstantKineticLaw( KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     KINETIC_LAW *rateConstant = NULL;; 
 
     START_FUNCTION("_CreateRateConstantKineticLaw");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToCreateRateConstantKineticLaw;
-        visitor.VisitInt = _VisitIntToCreateRateConstantKineticLaw;
-        visitor.VisitReal = _VisitRealToCreateRateConstantKineticLaw;
-        visitor.VisitSpecies = _VisitSpeciesToCreateRateConstantKineticLaw;
-        visitor.VisitSymbol = _VisitSymbolToCreateRateConstantKineticLaw;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToCreateRateConstantKineticLaw;
+    visitor.VisitInt = _VisitIntToCreateRateConstantKineticLaw;
+    visitor.VisitReal = _VisitRealToCreateRateConstantKineticLaw;
+    visitor.VisitSpecies = _VisitSpeciesToCreateRateConstantKineticLaw;
+    visitor.VisitSymbol = _VisitSymbolToCreateRateConstantKineticLaw;
     visitor._internal1 = (CADDR_T)(&rateConstant);
     
     if( IS_FAILED( kineticLaw->Accept( kineticLaw, &visitor ) ) ) {
@@ -1614,18 +1606,17 @@ static RET_VAL _VisitSymbolToCreateRateConstantKineticLaw( KINETIC_LAW_VISITOR *
 
 
 static KINETIC_LAW *_CreateMassActionRatioWithRateConstantInKineticLaw( KINETIC_LAW *forward, SPECIES *op, KINETIC_LAW *rateRatio  ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     KINETIC_LAW *massActionRatio = NULL;
     
     START_FUNCTION("_CreateMassActionRatio");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToCreateMassActionRatio;
-        visitor.VisitInt = _VisitIntToCreateMassActionRatio;
-        visitor.VisitReal = _VisitRealToCreateMassActionRatio;
-        visitor.VisitSpecies = _VisitSpeciesToCreateMassActionRatio;
-        visitor.VisitSymbol = _VisitSymbolToCreateMassActionRatio;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToCreateMassActionRatio;
+    visitor.VisitInt = _VisitIntToCreateMassActionRatio;
+    visitor.VisitReal = _VisitRealToCreateMassActionRatio;
+    visitor.VisitSpecies = _VisitSpeciesToCreateMassActionRatio;
+    visitor.VisitSymbol = _VisitSymbolToCreateMassActionRatio;
     
     massActionRatio = rateRatio;
     visitor._internal1 = (CADDR_T)(&massActionRatio);
@@ -1643,18 +1634,17 @@ static KINETIC_LAW *_CreateMassActionRatioWithRateConstantInKineticLaw( KINETIC_
 
 
 static LINKED_LIST *_CreateListOfMultipleTerms( KINETIC_LAW *kineticLaw  ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     LINKED_LIST *list = NULL;
     
     START_FUNCTION("_CreateListOfMultipleTerms");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToCreateListOfMultipleTerms;
-        visitor.VisitInt = _VisitIntToCreateListOfMultipleTerms;
-        visitor.VisitReal = _VisitRealToCreateListOfMultipleTerms;
-        visitor.VisitSpecies = _VisitSpeciesToCreateListOfMultipleTerms;
-        visitor.VisitSymbol = _VisitSymbolToCreateListOfMultipleTerms;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToCreateListOfMultipleTerms;
+    visitor.VisitInt = _VisitIntToCreateListOfMultipleTerms;
+    visitor.VisitReal = _VisitRealToCreateListOfMultipleTerms;
+    visitor.VisitSpecies = _VisitSpeciesToCreateListOfMultipleTerms;
+    visitor.VisitSymbol = _VisitSymbolToCreateListOfMultipleTerms;
     
     if( ( list = CreateLinkedList() ) == NULL ) {
         END_FUNCTION("_CreateListOfMultipleTerms", FAILING );
@@ -1778,18 +1768,17 @@ static RET_VAL _VisitSymbolToCreateListOfMultipleTerms( KINETIC_LAW_VISITOR *vis
 
 
 static LINKED_LIST *_CreateListOfSumTerms( KINETIC_LAW *kineticLaw  ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     LINKED_LIST *list = NULL;
     
     START_FUNCTION("_CreateListOfSumTerms");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToCreateListOfSumTerms;
-        visitor.VisitInt = _VisitIntToCreateListOfSumTerms;
-        visitor.VisitReal = _VisitRealToCreateListOfSumTerms;
-        visitor.VisitSpecies = _VisitSpeciesToCreateListOfSumTerms;
-        visitor.VisitSymbol = _VisitSymbolToCreateListOfSumTerms;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToCreateListOfSumTerms;
+    visitor.VisitInt = _VisitIntToCreateListOfSumTerms;
+    visitor.VisitReal = _VisitRealToCreateListOfSumTerms;
+    visitor.VisitSpecies = _VisitSpeciesToCreateListOfSumTerms;
+    visitor.VisitSymbol = _VisitSymbolToCreateListOfSumTerms;
     
     if( ( list = CreateLinkedList() ) == NULL ) {
         END_FUNCTION("_CreateListOfSumTerms", FAILING );
@@ -1916,20 +1905,19 @@ static RET_VAL _VisitSymbolToCreateListOfSumTerms( KINETIC_LAW_VISITOR *visitor,
 
 
 static BOOL _FindMultiplicationOfSpecies( KINETIC_LAW *kineticLaw, SPECIES *species, double *result ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
 #ifdef DEBUG    
     STRING *string = NULL;
 #endif
     
     START_FUNCTION("_FindMultiplicationOfSpecies");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToFindMultiplicationOfSpecies;
-        visitor.VisitInt = _VisitIntToFindMultiplicationOfSpecies;
-        visitor.VisitReal = _VisitRealToFindMultiplicationOfSpecies;
-        visitor.VisitSpecies = _VisitSpeciesToFindMultiplicationOfSpecies;
-        visitor.VisitSymbol = _VisitSymbolToFindMultiplicationOfSpecies;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToFindMultiplicationOfSpecies;
+    visitor.VisitInt = _VisitIntToFindMultiplicationOfSpecies;
+    visitor.VisitReal = _VisitRealToFindMultiplicationOfSpecies;
+    visitor.VisitSpecies = _VisitSpeciesToFindMultiplicationOfSpecies;
+    visitor.VisitSymbol = _VisitSymbolToFindMultiplicationOfSpecies;
     *result = 0.0;
     
     visitor._internal1 = (CADDR_T)species;
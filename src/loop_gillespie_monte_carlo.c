@@ -62,7 +62,7 @@ DLLSCOPE RET_VAL STDCALL DoLoopGillespieMonteCarloAnalysis( BACK_END_PROCESSOR *
     UINT i = 0;
     UINT runs = 1;
     char *namePrefix = NULL;
-    static GILLESPIE_MONTE_CARLO_RECORD rec;
+    GILLESPIE_MONTE_CARLO_RECORD *rec = NULL;
     
     START_FUNCTION("DoLoopGillespieMonteCarloAnalysis");
     
@@ -70,19 +70,25 @@ DLLSCOPE RET_VAL STDCALL DoLoopGillespieMonteCarloAnalysis( BACK_END_PROCESSOR *
         return ErrorReport( FAILING, "DoLoopGillespieMonteCarloAnalysis", "Gillespie method cannot be applied to the model" );
     }
     
-    if( IS_FAILED( ( ret = _InitializeRecord( &rec, backend, ir ) ) ) )  {
+    if( ( rec = (GILLESPIE_MONTE_CARLO_RECORD*)MALLOC( sizeof(GILLESPIE_MONTE_CARLO_RECORD) ) ) == NULL ) {
+        return ErrorReport( FAILING, "DoLoopGillespieMonteCarloAnalysis", "could not allocate the record" );
+    }
+    if( IS_FAILED( ( ret = _InitializeRecord( rec, backend, ir ) ) ) )  {
+        _CleanRecord( rec );
+        FREE( rec );
+        backend->_internal1 = NULL;
         return ErrorReport( ret, "DoLoopGillespieMonteCarloAnalysis", "initialization of the record failed" );
     }
     
-    runs = rec.runs;    
+    runs = rec->runs;    
     for( i = 1; i <= runs; i++ ) {
-        if( IS_FAILED( ( ret = _InitializeSimulation( &rec, i ) ) ) ) {
+        if( IS_FAILED( ( ret = _InitializeSimulation( rec, i ) ) ) ) {
             return ErrorReport( ret, "DoLoopGillespieMonteCarloAnalysis", "initialization of the %i-th simulation failed", i );
         }
-        if( IS_FAILED( ( ret = _RunSimulation( &rec ) ) ) ) {
-            return ErrorReport( ret, "DoLoopGillespieMonteCarloAnalysis", "%i-th simulation failed at time %f", i, rec.time );
+        if( IS_FAILED( ( ret = _RunSimulation( rec ) ) ) ) {
+            return ErrorReport( ret, "DoLoopGillespieMonteCarloAnalysis", "%i-th simulation failed at time %f", i, rec->time );
         }
-        if( IS_FAILED( ( ret = _CleanSimulation( &rec ) ) ) ) {
+        if( IS_FAILED( ( ret = _CleanSimulation( rec ) ) ) ) {
             return ErrorReport( ret, "DoLoopGillespieMonteCarloAnalysis", "cleaning of the %i-th simulation failed", i );
         }       
 	printf("Run = %d\n",i);
@@ -101,6 +107,8 @@ DLLSCOPE RET_VAL STDCALL CloseLoopGillespieMonteCarloAnalyzer( BACK_END_PROCESSO
     if( IS_FAILED( ( ret = _CleanRecord( rec ) ) ) )  {
         return ErrorReport( ret, "CloseLoopGillespieMonteCarloAnalyzer", "cleaning of the record failed" );
     }
+    FREE( rec );
+    backend->_internal1 = NULL;
         
     END_FUNCTION("CloseLoopGillespieMonteCarloAnalyzer",  SUCCESS );
     return ret;            
@@ -488,8 +496,12 @@ static RET_VAL _CleanRecord( GILLESPIE_MONTE_CARLO_RECORD *rec ) {
         FREE( rec->speciesArray );    
     }
     
-    printer->Destroy( printer );
-    decider->Destroy( decider );
+    if( printer != NULL ) {
+        printer->Destroy( printer );
+    }
+    if( decider != NULL ) {
+        decider->Destroy( decider );
+    }
     
     return ret;            
 }
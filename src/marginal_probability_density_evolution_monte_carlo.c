@@ -3,14 +3,34 @@
 #include "gsl/gsl_vector.h"
 #include "gsl/gsl_multiroots.h"
 #include "marginal_probability_density_evolution_monte_carlo.h"
+#include "default_simulation_run_termination_decider.h"
 #include "conservation_analysis.c"
 
+#if !defined(WIN32) && !defined(_WIN32)
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#define MPDE_USE_WORKER_PROCESSES 1
+#endif
+
 static BOOL _IsModelConditionSatisfied(IR *ir);
 
 static RET_VAL _InitializeRecord(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *backend, IR *ir);
 static RET_VAL _InitializeSimulation(MPDE_MONTE_CARLO_RECORD *rec, int runNum);
 static RET_VAL _RunSimulation(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *backend);
 static RET_VAL _CheckBifurcation(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns, double *mpTimes, int useMP, BIFURCATION_RECORD *birec, int previousNumberFirstCluster, FILE *file, FILE *tsdFile, BOOL useMedian);
+static void _FindClusterDistances(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns, double *mpTimes, int useMP, BYTE *isPrinted, double *means1, double *means2, double time1, double time2, double *distances1, double *distances2);
+static void _SaveRunStartState(MPDE_MONTE_CARLO_RECORD *rec);
+static void _RestoreRunStartState(MPDE_MONTE_CARLO_RECORD *rec);
+static RET_VAL _AdvanceRun(MPDE_MONTE_CARLO_RECORD *rec, MPDE_INTERVAL *interval, UINT32 k);
+static RET_VAL _AdvanceRuns(MPDE_MONTE_CARLO_RECORD *rec, MPDE_INTERVAL *interval, double **mpRuns, double *mpTimes);
+#if defined(MPDE_USE_WORKER_PROCESSES)
+static RET_VAL _AdvanceRunsInWorkers(MPDE_MONTE_CARLO_RECORD *rec, MPDE_INTERVAL *interval, double **mpRuns, double *mpTimes);
+static RET_VAL _StartWorkers(MPDE_MONTE_CARLO_RECORD *rec);
+static void _StopWorkers(MPDE_MONTE_CARLO_RECORD *rec);
+#endif
 
 static RET_VAL _CleanSimulation(MPDE_MONTE_CARLO_RECORD *rec);
 static RET_VAL _CleanRecord(MPDE_MONTE_CARLO_RECORD *rec);
@@ -29,8 +49,10 @@ static RET_VAL _UpdateSpeciesValues(MPDE_MONTE_CARLO_RECORD *rec);
 static RET_VAL _UpdateReactionRateUpdateTime(MPDE_MONTE_CARLO_RECORD *rec);
 static RET_VAL _UpdateReactionRateUpdateTimeForSpecies(MPDE_MONTE_CARLO_RECORD *rec, SPECIES* species);
 static RET_VAL _UpdateAllReactionRateUpdateTimes(MPDE_MONTE_CARLO_RECORD *rec, double time);
+static RET_VAL _UpdateReactionRateUpdateTimeForCompartment(MPDE_MONTE_CARLO_RECORD *rec, UINT32 index);
+static RET_VAL _UpdateReactionRateUpdateTimeForSymbol(MPDE_MONTE_CARLO_RECORD *rec, UINT32 index);
+static RET_VAL _UpdateReactionRateUpdateTimes(MPDE_MONTE_CARLO_RECORD *rec, UINT32 *reactions, UINT32 size);
 
-static int _ComparePropensity(REACTION *a, REACTION *b);
 static BOOL _IsTerminationConditionMet(MPDE_MONTE_CARLO_RECORD *rec);
 static gsl_matrix* _GetStoichiometricMatrix(MPDE_MONTE_CARLO_RECORD *rec);
 
@@ -47,7 +69,7 @@ DLLSCOPE RET_VAL STDCALL DoMPDEMonteCarloAnalysis(BACK_END_PROCESSOR *backend, I
     UINT i = 0;
     UINT runs = 1;
     char *namePrefix = NULL;
-    static MPDE_MONTE_CARLO_RECORD rec;
+    MPDE_MONTE_CARLO_RECORD *rec = NULL;
     UINT timeout = 0;
     char *valueString = NULL;
 
@@ -57,29 +79,34 @@ DLLSCOPE RET_VAL STDCALL DoMPDEMonteCarloAnalysis(BACK_END_PROCESSOR *backend, I
         return ErrorReport(FAILING, "DoMPDEMonteCarloAnalysis",
                 "Marginal Probability Density Evolution method cannot be applied to the model");
     }
-    if (IS_FAILED((ret = _InitializeRecord(&rec, backend, ir)))) {
+    if ((rec = (MPDE_MONTE_CARLO_RECORD *) MALLOC(sizeof(MPDE_MONTE_CARLO_RECORD))) == NULL) {
+        return ErrorReport(FAILING, "DoMPDEMonteCarloAnalysis", "could not allocate the record");
+    }
+    if (IS_FAILED((ret = _InitializeRecord(rec, backend, ir)))) {
+        FREE(rec);
+        backend->_internal1 = NULL;
         return ErrorReport(ret, "DoMPDEMonteCarloAnalysis", "initialization of the record failed");
     }
 
-    runs = rec.runs;
+    runs = rec->runs;
     //for( i = 1; i <= runs; i++ ) {
-    SeedRandomNumberGenerators(rec.seed);
-    rec.seed = GetNextUniformRandomNumber(0, RAND_MAX);
+    SeedRandomNumberGenerators(rec->seed);
+    rec->seed = GetNextUniformRandomNumber(0, RAND_MAX);
     timeout = 0;
     do {
-        SeedRandomNumberGenerators(rec.seed);
-        if (IS_FAILED((ret = _InitializeSimulation(&rec, 1)))) {
+        SeedRandomNumberGenerators(rec->seed);
+        if (IS_FAILED((ret = _InitializeSimulation(rec, 1)))) {
             return ErrorReport(ret, "DoMPDEMonteCarloAnalysis", "initialization of the %i-th simulation failed", i);
         }
         timeout++;
-    } while ((ret == CHANGE) && (timeout <= (rec.speciesSize + rec.compartmentsSize + rec.symbolsSize)));
-    if (timeout > (rec.speciesSize + rec.compartmentsSize + rec.symbolsSize + 1)) {
+    } while ((ret == CHANGE) && (timeout <= (rec->speciesSize + rec->compartmentsSize + rec->symbolsSize)));
+    if (timeout > (rec->speciesSize + rec->compartmentsSize + rec->symbolsSize + 1)) {
         return ErrorReport(ret, "DoMPDEMonteCarloAnalysis", "Cycle detected in initial and rule assignments");
     }
-    if (IS_FAILED((ret = _RunSimulation(&rec, backend)))) {
-        return ErrorReport(ret, "DoMPDEMonteCarloAnalysis", "%i-th simulation failed at time %f", i, rec.time);
+    if (IS_FAILED((ret = _RunSimulation(rec, backend)))) {
+        return ErrorReport(ret, "DoMPDEMonteCarloAnalysis", "%i-th simulation failed at time %f", i, rec->time);
     }
-    if (IS_FAILED((ret = _CleanSimulation(&rec)))) {
+    if (IS_FAILED((ret = _CleanSimulation(rec)))) {
         return ErrorReport(ret, "DoMPDEMonteCarloAnalysis", "cleaning of the %i-th simulation failed", i);
     }
     //}
@@ -96,6 +123,8 @@ DLLSCOPE RET_VAL STDCALL CloseMPDEMonteCarloAnalyzer(BACK_END_PROCESSOR *backend
     if (IS_FAILED((ret = _CleanRecord(rec)))) {
         return ErrorReport(ret, "CloseMPDEMonteCarloAnalyzer", "cleaning of the record failed");
     }
+    FREE(rec);
+    backend->_internal1 = NULL;
 
     END_FUNCTION("CloseMPDEMonteCarloAnalyzer", SUCCESS);
     return ret;
@@ -172,6 +201,7 @@ static RET_VAL _InitializeRecord(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSO
       ResetCurrentElement( list );
       while( ( reaction = (REACTION*)GetNextFromLinkedList( list ) ) != NULL ) {
         reactions[i] = reaction;
+        SetReactionIndex( reaction, i );
         i++;
 	if (IsReactionFastInReactionNode( reaction )) {
 	  rec->numberFastReactions++;
@@ -349,10 +379,25 @@ static RET_VAL _InitializeRecord(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSO
         return ErrorReport(FAILING, "_InitializeRecord", "could not create evaluator");
     }
 
+    if ((rec->state = CreateSimState(rec->speciesArray, rec->speciesSize, rec->compartmentArray, rec->compartmentsSize,
+            rec->symbolArray, rec->symbolsSize, rec->reactionArray, rec->reactionsSize)) == NULL) {
+        return ErrorReport(FAILING, "_InitializeRecord", "could not create simulation state");
+    }
+
+    if ((rec->dependencyGraph = CreateNextReactionDependencyGraph(rec->reactionArray, rec->reactionsSize,
+            rec->speciesArray, rec->speciesSize, rec->compartmentArray, rec->compartmentsSize,
+            rec->symbolArray, rec->symbolsSize, rec->ruleArray, rec->rulesSize)) == NULL) {
+        return ErrorReport(FAILING, "_InitializeRecord", "could not create reaction dependency graph");
+    }
+
     if ((rec->findNextTime = CreateKineticLawFind_Next_Time()) == NULL) {
         return ErrorReport(FAILING, "_InitializeRecord", "could not create find next time");
     }
 
+    if ((rec->propensityTree = CreateSumTree(rec->reactionsSize)) == NULL) {
+        return ErrorReport(FAILING, "_InitializeRecord", "could not create propensity tree");
+    }
+
     if ((valueString = properties->GetProperty(properties, MONTE_CARLO_SIMULATION_START_INDEX)) == NULL) {
         rec->startIndex = DEFAULT_MONTE_CARLO_SIMULATION_START_INDEX;
     } else {
@@ -585,6 +630,42 @@ static RET_VAL _InitializeRecord(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSO
         }
     }
 
+    if ((rec->randomNumberContext = CreateRandomNumberContext()) == NULL) {
+        return ErrorReport(FAILING, "_InitializeRecord", "could not create random number context");
+    }
+    rec->evaluator->randomNumberContext = rec->randomNumberContext;
+    rec->findNextTime->randomNumberContext = rec->randomNumberContext;
+    rec->intervalIndex = 0;
+    if ((rec->runStartValues = (double*) MALLOC(GET_MAX(rec->state->valuesSize, 1) * sizeof(double))) == NULL) {
+        return ErrorReport(FAILING, "_InitializeRecord", "could not allocate memory for run start values");
+    }
+    if ((rec->runStartEventTimes = (double*) MALLOC(GET_MAX(rec->eventsSize, 1) * sizeof(double))) == NULL) {
+        return ErrorReport(FAILING, "_InitializeRecord", "could not allocate memory for run start event times");
+    }
+    if ((rec->runStartTriggersEnabled = (BYTE*) MALLOC(GET_MAX(rec->eventsSize, 1) * sizeof(BYTE))) == NULL) {
+        return ErrorReport(FAILING, "_InitializeRecord", "could not allocate memory for run start triggers");
+    }
+
+    if ((valueString = compRec->options->GetProperty(compRec->options, MONTE_CARLO_SIMULATION_THREADS_OPTION)) == NULL) {
+        valueString = properties->GetProperty(properties, MONTE_CARLO_SIMULATION_THREADS);
+    }
+    if (valueString == NULL) {
+        rec->threads = DEFAULT_MONTE_CARLO_SIMULATION_THREADS_VALUE;
+    } else {
+        if (IS_FAILED((ret = StrToUINT32(&(rec->threads), valueString))) || (rec->threads == 0)) {
+            rec->threads = DEFAULT_MONTE_CARLO_SIMULATION_THREADS_VALUE;
+        }
+    }
+    /* termination deciders keep their counts across runs in the process that ran them */
+    if ((properties->GetProperty(properties, SIMULATION_RUN_TERMINATION_DECIDER_KEY) != NULL) ||
+        (properties->GetProperty(properties, SIMULATION_RUN_TERMINATION_CONDITION_KEY_PREFIX "1") != NULL)) {
+        if (rec->threads > 1) {
+            TRACE_0("termination decider counts are not merged across workers, running serially");
+        }
+        rec->threads = 1;
+    }
+    ret = SUCCESS;
+
     backend->_internal1 = (CADDR_T) rec;
 
     return ret;
@@ -751,6 +832,7 @@ static RET_VAL _InitializeSimulation(MPDE_MONTE_CARLO_RECORD *rec, int runNum) {
             return ret;
         }
     }
+    LoadSimStateFromIR(rec->state);
     for (i = 0; i < rec->eventsSize; i++) {
         /* SetTriggerEnabledInEvent( rec->eventArray[i], FALSE ); */
         /* Use the line below to support true SBML semantics, i.e., nothing can be trigger at t=0 */
@@ -866,6 +948,9 @@ static RET_VAL _CheckBifurcation(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns,
     int secondCounter;
     double *duplicate1;
     double *duplicate2;
+    double *distances1 = NULL;
+    double *distances2 = NULL;
+    BYTE *isPrinted = NULL;
 
     // Allocate memory for vector indicating which species bifurcated
 
@@ -968,6 +1053,17 @@ static RET_VAL _CheckBifurcation(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns,
 //    	}
 //    }
 
+    if( ( ( distances1 = (double*)MALLOC( runs * sizeof(double) ) ) == NULL ) ||
+        ( ( distances2 = (double*)MALLOC( runs * sizeof(double) ) ) == NULL ) ||
+        ( ( isPrinted = (BYTE*)MALLOC( size * sizeof(BYTE) ) ) == NULL ) ) {
+        FREE( distances1 );
+        FREE( distances2 );
+        return ErrorReport( FAILING, "_CheckBifurcation", "could not allocate memory for cluster distances" );
+    }
+    for (i = 0; i < size; i++) {
+    	isPrinted[i] = IsPrintFlagSetInSpeciesNode(speciesArray[i]) ? 1 : 0;
+    }
+
     half = runs/2;
     for (i = 0; i < size; i++) {
     	birec->meansFirstCluster[i] = 0;
@@ -979,7 +1075,7 @@ static RET_VAL _CheckBifurcation(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns,
     }
     for (k = 0; k < half; k++) {
     	for (i = 0; i < size; i++) {
-    		if (IsPrintFlagSetInSpeciesNode(speciesArray[i])) {
+    		if (isPrinted[i]) {
     			birec->meansFirstCluster[i] += mpRuns[k][i];
     		}
     	}
@@ -988,7 +1084,7 @@ static RET_VAL _CheckBifurcation(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns,
     	}
     }
     for (i = 0; i < size; i++) {
-    	if (IsPrintFlagSetInSpeciesNode(speciesArray[i])) {
+    	if (isPrinted[i]) {
     		birec->meansFirstCluster[i] /= half;
     	}
     }
@@ -998,7 +1094,7 @@ static RET_VAL _CheckBifurcation(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns,
     half = runs - half;
     for (k = runs/2; k < runs; k++) {
     	for (i = 0; i < size; i++) {
-    		if (IsPrintFlagSetInSpeciesNode(speciesArray[i])) {
+    		if (isPrinted[i]) {
     			birec->meansSecondCluster[i] += mpRuns[k][i];
     		}
     	}
@@ -1007,7 +1103,7 @@ static RET_VAL _CheckBifurcation(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns,
     	}
     }
     for (i = 0; i < size; i++) {
-    	if (IsPrintFlagSetInSpeciesNode(speciesArray[i])) {
+    	if (isPrinted[i]) {
     		birec->meansSecondCluster[i] /= half;
     	}
     }
@@ -1024,22 +1120,12 @@ static RET_VAL _CheckBifurcation(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns,
     	newMeanTimeSecondCluster = 0;
     	birec->numberFirstCluster = 0;
     	birec->numberSecondCluster = 0;
+    	_FindClusterDistances(rec, mpRuns, mpTimes, useMP, isPrinted, birec->meansFirstCluster, birec->meansSecondCluster,
+    			meanTimeFirstCluster, meanTimeSecondCluster, distances1, distances2);
     	for (k = 0; k < runs; k++) {
-    		newDistance1 = 0;
-    		newDistance2 = 0;
-    		for (i = 0; i < size; i++) {
-    			if (IsPrintFlagSetInSpeciesNode(speciesArray[i])) {
-    				newDistance1 += pow(mpRuns[k][i] - birec->meansFirstCluster[i], 2);
-    				newDistance2 += pow(mpRuns[k][i] - birec->meansSecondCluster[i], 2);
-    			}
-    		}
-    		if (useMP == 2 || useMP == 3) {
-    			newDistance1 += pow(mpTimes[k] - meanTimeFirstCluster, 2);
-    			newDistance2 += pow(mpTimes[k] - meanTimeSecondCluster, 2);
-    		}
-    		if (newDistance1 <= newDistance2) {
+    		if (distances1[k] <= distances2[k]) {
     			for (i = 0; i < size; i++) {
-    				if (IsPrintFlagSetInSpeciesNode(speciesArray[i])) {
+    				if (isPrinted[i]) {
     					meanCluster1[i] += mpRuns[k][i];
     				}
     			}
@@ -1050,7 +1136,7 @@ static RET_VAL _CheckBifurcation(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns,
     		}
     		else {
     			for (i = 0; i < size; i++) {
-    				if (IsPrintFlagSetInSpeciesNode(speciesArray[i])) {
+    				if (isPrinted[i]) {
     					meanCluster2[i] += mpRuns[k][i];
     				}
     			}
@@ -1069,7 +1155,7 @@ static RET_VAL _CheckBifurcation(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns,
     	meanTimeFirstCluster = newMeanTimeFirstCluster;
     	meanTimeSecondCluster = newMeanTimeSecondCluster;
     	for (i = 0; i < size; i++) {
-    		if (IsPrintFlagSetInSpeciesNode(speciesArray[i])) {
+    		if (isPrinted[i]) {
     			meanCluster1[i] /= birec->numberFirstCluster;
     			meanCluster2[i] /= birec->numberSecondCluster;
     			if (meanCluster1[i] != birec->meansFirstCluster[i] || meanCluster2[i] != birec->meansSecondCluster[i]) {
@@ -1142,19 +1228,11 @@ static RET_VAL _CheckBifurcation(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns,
     index2 = -1;
     birec->numberFirstCluster = 0;
     birec->numberSecondCluster = 0;
+    _FindClusterDistances(rec, mpRuns, mpTimes, useMP, isPrinted, birec->meansFirstCluster, birec->meansSecondCluster,
+    		meanTimeFirstCluster, meanTimeSecondCluster, distances1, distances2);
     for (k = 0; k < runs; k++) {
-    	newDistance1 = 0;
-    	newDistance2 = 0;
-    	for (l = 0; l < size; l++) {
-    		if (IsPrintFlagSetInSpeciesNode(speciesArray[l])) {
-    			newDistance1 += pow(mpRuns[k][l] - birec->meansFirstCluster[l], 2);
-    			newDistance2 += pow(mpRuns[k][l] - birec->meansSecondCluster[l], 2);
-    		}
-    	}
-    	if (useMP == 2 || useMP == 3) {
-    		newDistance1 += pow(mpTimes[k] - meanTimeFirstCluster, 2);
-    		newDistance2 += pow(mpTimes[k] - meanTimeSecondCluster, 2);
-    	}
+    	newDistance1 = distances1[k];
+    	newDistance2 = distances2[k];
     	if (min_dist1 == -1) {
     		min_dist1 = newDistance1;
     		index1 = k;
@@ -1180,6 +1258,9 @@ static RET_VAL _CheckBifurcation(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns,
     	}
     }
     if( IS_FAILED( ( ret = _PrintBifurcationStatistics( rec->time, birec->numberFirstCluster, birec->numberSecondCluster, runs, file, tsdFile ) ) ) ) {
+    	FREE( distances1 );
+    	FREE( distances2 );
+    	FREE( isPrinted );
     	return ret;
     }
     percentFirst = ((double) previousNumberFirstCluster) / ((double) runs);
@@ -1198,19 +1279,7 @@ static RET_VAL _CheckBifurcation(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns,
     	firstCounter = 0;
     	secondCounter = 0;
         for (k = 0; k < runs; k++) {
-        	newDistance1 = 0;
-        	newDistance2 = 0;
-        	for (l = 0; l < size; l++) {
-        		if (IsPrintFlagSetInSpeciesNode(speciesArray[l])) {
-        			newDistance1 += pow(mpRuns[k][l] - birec->meansFirstCluster[l], 2);
-        			newDistance2 += pow(mpRuns[k][l] - birec->meansSecondCluster[l], 2);
-        		}
-        	}
-        	if (useMP == 2 || useMP == 3) {
-        		newDistance1 += pow(mpTimes[k] - meanTimeFirstCluster, 2);
-        		newDistance2 += pow(mpTimes[k] - meanTimeSecondCluster, 2);
-        	}
-        	if (newDistance1 <= newDistance2) {
+        	if (distances1[k] <= distances2[k]) {
         		for (l = 0; l < size; l++) {
         			mpRunsCluster1[firstCounter][l] = mpRuns[k][l];
         		}
@@ -1239,19 +1308,11 @@ static RET_VAL _CheckBifurcation(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns,
         }
         newMeanTimeFirstCluster = Find_Median(mpTimesCluster1);
         newMeanTimeSecondCluster = Find_Median(mpTimesCluster2);
+        _FindClusterDistances(rec, mpRuns, mpTimes, useMP, isPrinted, meanCluster1, meanCluster2,
+        		newMeanTimeFirstCluster, newMeanTimeSecondCluster, distances1, distances2);
         for (k = 0; k < runs; k++) {
-        	newDistance1 = 0;
-        	newDistance2 = 0;
-        	for (l = 0; l < size; l++) {
-        		if (IsPrintFlagSetInSpeciesNode(speciesArray[l])) {
-        			newDistance1 += pow(mpRuns[k][l] - meanCluster1[l], 2);
-        			newDistance2 += pow(mpRuns[k][l] - meanCluster2[l], 2);
-        		}
-        	}
-        	if (useMP == 2 || useMP == 3) {
-        		newDistance1 += pow(mpTimes[k] - newMeanTimeFirstCluster, 2);
-        		newDistance2 += pow(mpTimes[k] - newMeanTimeSecondCluster, 2);
-        	}
+        	newDistance1 = distances1[k];
+        	newDistance2 = distances2[k];
         	if (min_dist1 == -1) {
         		min_dist1 = newDistance1;
         		index1 = k;
@@ -1300,10 +1361,614 @@ static RET_VAL _CheckBifurcation(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns,
     		birec->timeSecondCluster = mpTimes[index2];
     	}
     }
+    FREE( distances1 );
+    FREE( distances2 );
+    FREE( isPrinted );
+
+    return ret;
+}
+
+// This function computes the squared distances of every run to the two cluster centers.
+// The distance of a run depends only on that run, so the runs can be handled in any order
+// and the clustering stays the same whatever order they were advanced in
+
+static void _FindClusterDistances(MPDE_MONTE_CARLO_RECORD *rec, double **mpRuns, double *mpTimes, int useMP, BYTE *isPrinted, double *means1, double *means2, double time1, double time2, double *distances1, double *distances2) {
+    UINT32 k = 0;
+    UINT32 l = 0;
+    UINT32 size = rec->speciesSize;
+    UINT32 runs = rec->runs;
+    double *mpRun = NULL;
+    double distance1 = 0.0;
+    double distance2 = 0.0;
+    double delta = 0.0;
+
+    for (k = 0; k < runs; k++) {
+    	mpRun = mpRuns[k];
+    	distance1 = 0.0;
+    	distance2 = 0.0;
+    	for (l = 0; l < size; l++) {
+    		if (isPrinted[l]) {
+    			delta = mpRun[l] - means1[l];
+    			distance1 += delta * delta;
+    			delta = mpRun[l] - means2[l];
+    			distance2 += delta * delta;
+    		}
+    	}
+    	if (useMP == 2 || useMP == 3) {
+    		delta = mpTimes[k] - time1;
+    		distance1 += delta * delta;
+    		delta = mpTimes[k] - time2;
+    		distance2 += delta * delta;
+    	}
+    	distances1[k] = distance1;
+    	distances2[k] = distance2;
+    }
+}
+
+/*
+ * Snapshot of the state a print interval starts from.  Every run of the interval is 
+ * started from it, so a run does not see the compartments, parameters and events left 
+ * by the runs advanced before it, and its outcome depends only on the seed, the interval 
+ * and its own index.
+ */
+static void _SaveRunStartState(MPDE_MONTE_CARLO_RECORD *rec) {
+    UINT32 i = 0;
+
+    memcpy(rec->runStartValues, rec->state->values, rec->state->valuesSize * sizeof(double));
+    for (i = 0; i < rec->eventsSize; i++) {
+        rec->runStartEventTimes[i] = GetNextEventTimeInEvent(rec->eventArray[i]);
+        rec->runStartTriggersEnabled[i] = (BYTE) GetTriggerEnabledInEvent(rec->eventArray[i]);
+    }
+}
+
+static void _RestoreRunStartState(MPDE_MONTE_CARLO_RECORD *rec) {
+    UINT32 i = 0;
+
+    memcpy(rec->state->values, rec->runStartValues, rec->state->valuesSize * sizeof(double));
+    StoreSimStateInIR(rec->state);
+    for (i = 0; i < rec->eventsSize; i++) {
+        SetNextEventTimeInEvent(rec->eventArray[i], rec->runStartEventTimes[i]);
+        SetTriggerEnabledInEvent(rec->eventArray[i], (BOOL) rec->runStartTriggersEnabled[i]);
+    }
+}
+
+/*
+ * Advances the k-th run of the current interval on the random number stream 
+ * ( seed, interval * runs + k - 1 ), leaving its final state in rec->state and rec->time.
+ */
+static RET_VAL _AdvanceRun(MPDE_MONTE_CARLO_RECORD *rec, MPDE_INTERVAL *interval, UINT32 k) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 l = 0;
+    UINT32 size = rec->speciesSize;
+    UINT32 reacSize = rec->reactionsSize;
+    int useMP = rec->useMP;
+    BOOL useBifur = rec->useBifur;
+    BIFURCATION_RECORD *birec = interval->birec;
+    SIMULATION_RUN_TERMINATION_DECIDER *decider = rec->decider;
+    REACTION *reaction = NULL;
+    double timeStep = rec->timeStep;
+    double timeLimit = rec->timeLimit;
+    double maxTime = 0.0;
+    double nextEventTime = 0.0;
+    double newValue = 0.0;
+    double end = interval->end;
+    double start = interval->start;
+    double smallProp = interval->smallProp;
+    double remainingEvents = interval->remainingEvents;
+    double prop = 0.0;
+    double n = 0.0;
+    int eventCounter = 0;
+    int maxEvents = ceil(rec->timeStep);
+
+    SeedRandomNumberContext(rec->randomNumberContext, rec->seed, rec->intervalIndex * rec->runs + (k - 1));
+    _RestoreRunStartState(rec);
+    decider->timeLimit = end;
+    rec->time = interval->time;
+    if (useMP != 0) {
+        if (!useBifur || birec->isBifurcated == NULL) {
+            for (l = 0; l < size; l++) {
+                SetSpeciesAmountInSimState(rec->state, l, interval->mpRun[l]);
+            }
+        }
+        else if (k <= birec->numberFirstCluster) {
+            for (l = 0; l < size; l++) {
+                SetSpeciesAmountInSimState(rec->state, l, birec->meanPathCluster1[l]);
+            }
+            if (useMP == 2 || useMP == 3) {
+                rec->time = birec->timeFirstCluster;
+            }
+        }
+        else {
+            for (l = 0; l < size; l++) {
+                SetSpeciesAmountInSimState(rec->state, l, birec->meanPathCluster2[l]);
+            }
+            if (useMP == 2 || useMP == 3) {
+                rec->time = birec->timeSecondCluster;
+            }
+        }
+    } else {
+        do {
+            for (l = 0; l < size; l++) {
+                if (rec->speciesSD[l] == 0) {
+                    newValue = rec->oldSpeciesMeans[l];
+                } else {
+                    newValue = GetNextNormalRandomNumberInContext(rec->randomNumberContext, rec->oldSpeciesMeans[l], rec->speciesSD[l]);
+                }
+                newValue = round(newValue);
+                if (newValue < 0.0)
+                    newValue = 0.0;
+                SetSpeciesAmountInSimState(rec->state, l, newValue);
+            }
+        } while ((decider->IsTerminationConditionMet(decider, reaction, rec->time)));
+    }
+    if (IS_FAILED((ret = _UpdateAllReactionRateUpdateTimes(rec, rec->time)))) {
+        return ret;
+    }
+    maxTime = rec->time;
+    while (!(decider->IsTerminationConditionMet(decider, reaction, rec->time))) {
+        i++;
+
+        if (useMP == 2 || useMP == 3) {
+            maxTime = DBL_MAX;
+        } else {
+            if (timeStep == DBL_MAX) {
+                maxTime = DBL_MAX;
+            } else {
+                maxTime = maxTime + timeStep;
+            }
+        }
+        nextEventTime = fireEvents(rec, rec->time);
+        if (decider->IsTerminationConditionMet(decider, reaction, rec->time)) break;
+        if (nextEventTime == -2.0) {
+            return FAILING;
+        }
+        if ((nextEventTime != -1) && (nextEventTime < maxTime)) {
+            maxTime = nextEventTime;
+        }
+
+        if (IS_FAILED((ret = _CalculatePropensities(rec)))) {
+            return ret;
+        }
+        if (IS_FAILED((ret = _CalculateTotalPropensities(rec)))) {
+            return ret;
+        }
+        if (IS_REAL_EQUAL(rec->totalPropensities, 0.0)) {
+            TRACE_1("the total propensity is 0 at iteration %i", i);
+            rec->t = maxTime - rec->time;
+            rec->time = maxTime;
+            reaction = NULL;
+            rec->nextReaction = NULL;
+            if (IS_FAILED((ret = _UpdateNodeValues(rec)))) {
+                return ret;
+            }
+        } else {
+            if (IS_FAILED((ret = _FindNextReactionTime(rec)))) {
+                return ret;
+            }
+            if (maxTime < rec->time) {
+                rec->time -= rec->t;
+                rec->t = maxTime - rec->time;
+                rec->time = maxTime;
+                reaction = NULL;
+                rec->nextReaction = NULL;
+                if (IS_FAILED((ret = _UpdateNodeValues(rec)))) {
+                    return ret;
+                }
+            } else {
+                maxTime = rec->time;
+                if (rec->time < timeLimit) {
+                    if (IS_FAILED((ret = _FindNextReaction(rec)))) {
+                        return ret;
+                    }
+                    reaction = rec->nextReaction;
+                    if (IS_FAILED((ret = _UpdateNodeValues(rec)))) {
+                        return ret;
+                    }
+                }
+            }
+        }
+        if (useMP == 3) {
+            eventCounter++;
+            if (eventCounter >= maxEvents) {
+                break;
+            }
+        }
+        else if (useMP == 2) {
+            remainingEvents = remainingEvents - (rec->time - start) * smallProp;
+            if (reacSize > 0) {
+                smallProp = rec->state->propensities[0];
+                for (l = 1; l < reacSize; l++) {
+                    prop = rec->state->propensities[l];
+                    if (IS_REAL_EQUAL(smallProp, 0.0)) {
+                        smallProp = prop;
+                    }
+                    else if (smallProp > prop && !IS_REAL_EQUAL(prop, 0.0)) {
+                        smallProp = prop;
+                    }
+                }
+            }
+            if (IS_REAL_EQUAL(smallProp, 0.0)) {
+                n = remainingEvents;
+            } else {
+                n = (remainingEvents / smallProp);
+            }
+            if (rec->minPrintInterval >= 0.0) {
+                if ((n + rec->time) > interval->nextPrintTime) {
+                    end = interval->nextPrintTime;
+                } else {
+                    end = n + rec->time;
+                }
+            }
+            else {
+                end = n + rec->time;
+            }
+            start = rec->time;
+            decider->timeLimit = end;
+        }
+    }
+    return ret;
+}
+
+/*
+ * Advances every run of the current interval and stores the final species amounts and 
+ * times in mpRuns and mpTimes.  The record is left in the final state of the last run, 
+ * as if the runs had been advanced one after another.
+ */
+static RET_VAL _AdvanceRuns(MPDE_MONTE_CARLO_RECORD *rec, MPDE_INTERVAL *interval, double **mpRuns, double *mpTimes) {
+    RET_VAL ret = SUCCESS;
+    UINT32 k = 0;
+    UINT32 l = 0;
 
+    _SaveRunStartState(rec);
+#if defined(MPDE_USE_WORKER_PROCESSES)
+    if ((rec->threads > 1) && (rec->runs > 1)) {
+        return _AdvanceRunsInWorkers(rec, interval, mpRuns, mpTimes);
+    }
+#endif
+    for (k = 1; k <= rec->runs; k++) {
+        if (IS_FAILED((ret = _AdvanceRun(rec, interval, k)))) {
+            return ret;
+        }
+        for (l = 0; l < rec->speciesSize; l++) {
+            mpRuns[k - 1][l] = GetAmountInSpeciesNode(rec->speciesArray[l]);
+        }
+        mpTimes[k - 1] = rec->time;
+    }
     return ret;
 }
 
+#if defined(MPDE_USE_WORKER_PROCESSES)
+
+struct _MPDE_WORKER {
+    pid_t pid;
+    int toWorker;
+    int fromWorker;
+};
+
+typedef struct {
+    UINT32 intervalIndex;
+    UINT32 numberFirstCluster;
+    BOOL isBifurcated;
+    double time;
+    double end;
+    double start;
+    double smallProp;
+    double remainingEvents;
+    double nextPrintTime;
+    double timeFirstCluster;
+    double timeSecondCluster;
+} MPDE_WORKER_REQUEST;
+
+typedef struct {
+    UINT32 run;
+    RET_VAL ret;
+    double time;
+} MPDE_WORKER_RESULT;
+
+static RET_VAL _WriteFully(int fd, void *buf, size_t size) {
+    char *p = (char*) buf;
+    ssize_t n = 0;
+
+    while (size > 0) {
+        if ((n = write(fd, p, size)) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return FAILING;
+        }
+        p += n;
+        size -= n;
+    }
+    return SUCCESS;
+}
+
+static RET_VAL _ReadFully(int fd, void *buf, size_t size) {
+    char *p = (char*) buf;
+    ssize_t n = 0;
+
+    while (size > 0) {
+        if ((n = read(fd, p, size)) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return FAILING;
+        }
+        if (n == 0) {
+            return FAILING;
+        }
+        p += n;
+        size -= n;
+    }
+    return SUCCESS;
+}
+
+/*
+ * A request is the header followed by the run start snapshot ( values, event times, 
+ * triggers ) and five species blocks: the mean path, the old means, the standard 
+ * deviations and the mean paths of the two clusters.  A result is the run's header 
+ * followed by its values block and the state of its events.
+ */
+static UINT32 _GetWorkerRequestSize(MPDE_MONTE_CARLO_RECORD *rec) {
+    return rec->state->valuesSize + 2 * rec->eventsSize + 5 * rec->speciesSize;
+}
+
+/*
+ * Loop of a worker: advance runs first to last of every interval the parent sends until 
+ * the parent closes the request pipe.  The process only ever leaves through _exit, so 
+ * nothing the parent owns is flushed or freed twice.
+ */
+static void _ServeIntervals(MPDE_MONTE_CARLO_RECORD *rec, int toWorker, int fromWorker, UINT32 first, UINT32 last) {
+    UINT32 i = 0;
+    UINT32 k = 0;
+    UINT32 size = rec->speciesSize;
+    UINT32 valuesSize = rec->state->valuesSize;
+    UINT32 eventsSize = rec->eventsSize;
+    UINT32 resultSize = valuesSize + 2 * eventsSize;
+    UINT32 requestSize = _GetWorkerRequestSize(rec);
+    BOOL isBifurcated = TRUE;
+    double *buffer = NULL;
+    double *species = NULL;
+    MPDE_WORKER_REQUEST request;
+    MPDE_WORKER_RESULT result;
+    MPDE_INTERVAL interval;
+    BIFURCATION_RECORD birec;
+
+    if ((buffer = (double*) CALLOC(GET_MAX(requestSize, 1), sizeof(double))) == NULL) {
+        _exit(1);
+    }
+    memset(&birec, 0, sizeof(birec));
+    species = buffer + resultSize;
+    interval.mpRun = species;
+    interval.birec = &birec;
+    birec.meanPathCluster1 = species + 3 * size;
+    birec.meanPathCluster2 = species + 4 * size;
+    while (!IS_FAILED(_ReadFully(toWorker, &request, sizeof(request))) &&
+           !IS_FAILED(_ReadFully(toWorker, buffer, requestSize * sizeof(double)))) {
+        rec->intervalIndex = request.intervalIndex;
+        memcpy(rec->runStartValues, buffer, valuesSize * sizeof(double));
+        for (i = 0; i < eventsSize; i++) {
+            rec->runStartEventTimes[i] = buffer[valuesSize + i];
+            rec->runStartTriggersEnabled[i] = (BYTE) (buffer[valuesSize + eventsSize + i] != 0.0);
+        }
+        memcpy(rec->oldSpeciesMeans, species + size, size * sizeof(double));
+        memcpy(rec->speciesSD, species + 2 * size, size * sizeof(double));
+        interval.time = request.time;
+        interval.end = request.end;
+        interval.start = request.start;
+        interval.smallProp = request.smallProp;
+        interval.remainingEvents = request.remainingEvents;
+        interval.nextPrintTime = request.nextPrintTime;
+        birec.isBifurcated = request.isBifurcated ? &isBifurcated : NULL;
+        birec.numberFirstCluster = request.numberFirstCluster;
+        birec.timeFirstCluster = request.timeFirstCluster;
+        birec.timeSecondCluster = request.timeSecondCluster;
+
+        /* the species blocks of the request stay in place behind the results */
+        for (k = first; k <= last; k++) {
+            result.run = k;
+            result.ret = _AdvanceRun(rec, &interval, k);
+            result.time = rec->time;
+            memcpy(buffer, rec->state->values, valuesSize * sizeof(double));
+            for (i = 0; i < eventsSize; i++) {
+                buffer[valuesSize + i] = GetNextEventTimeInEvent(rec->eventArray[i]);
+                buffer[valuesSize + eventsSize + i] = GetTriggerEnabledInEvent(rec->eventArray[i]) ? 1.0 : 0.0;
+            }
+            if (IS_FAILED(_WriteFully(fromWorker, &result, sizeof(result))) ||
+                IS_FAILED(_WriteFully(fromWorker, buffer, resultSize * sizeof(double))) ||
+                IS_FAILED(result.ret)) {
+                close(toWorker);
+                close(fromWorker);
+                _exit(1);
+            }
+        }
+    }
+    close(toWorker);
+    close(fromWorker);
+    fflush(NULL);
+    _exit(0);
+}
+
+static void _StopWorkers(MPDE_MONTE_CARLO_RECORD *rec) {
+    UINT32 w = 0;
+
+    if (rec->workers == NULL) {
+        return;
+    }
+    for (w = 0; w < rec->workersSize; w++) {
+        close(rec->workers[w].toWorker);
+        close(rec->workers[w].fromWorker);
+    }
+    for (w = 0; w < rec->workersSize; w++) {
+        while ((waitpid(rec->workers[w].pid, NULL, 0) < 0) && (errno == EINTR));
+    }
+    FREE(rec->workers);
+    rec->workersSize = 0;
+}
+
+/*
+ * Forks GET_MIN( threads, runs ) workers once per simulation.  Worker w owns the w-th 
+ * contiguous block of runs for the whole simulation, and every fork copies the record 
+ * as it is before the first interval, so later intervals only need what a request carries.
+ */
+static RET_VAL _StartWorkers(MPDE_MONTE_CARLO_RECORD *rec) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 w = 0;
+    UINT32 runs = rec->runs;
+    UINT32 workersSize = GET_MIN(rec->threads, rec->runs);
+    int toWorker[2];
+    int fromWorker[2];
+    MPDE_WORKER *worker = NULL;
+
+    if ((rec->workers = (MPDE_WORKER*) CALLOC(workersSize, sizeof(MPDE_WORKER))) == NULL) {
+        return ErrorReport(FAILING, "_StartWorkers", "could not allocate memory for workers");
+    }
+    fflush(NULL);
+    for (w = 0; w < workersSize; w++) {
+        worker = rec->workers + w;
+        if (pipe(toWorker) != 0) {
+            ret = ErrorReport(FAILING, "_StartWorkers", "could not create pipes for worker %i", w);
+            break;
+        }
+        if (pipe(fromWorker) != 0) {
+            close(toWorker[0]);
+            close(toWorker[1]);
+            ret = ErrorReport(FAILING, "_StartWorkers", "could not create pipes for worker %i", w);
+            break;
+        }
+        if ((worker->pid = fork()) < 0) {
+            close(toWorker[0]);
+            close(toWorker[1]);
+            close(fromWorker[0]);
+            close(fromWorker[1]);
+            ret = ErrorReport(FAILING, "_StartWorkers", "could not create worker %i", w);
+            break;
+        }
+        if (worker->pid == 0) {
+            /* the pipes of earlier workers must only stay open in the parent, or they never see the end */
+            for (i = 0; i < w; i++) {
+                close(rec->workers[i].toWorker);
+                close(rec->workers[i].fromWorker);
+            }
+            close(toWorker[1]);
+            close(fromWorker[0]);
+            _ServeIntervals(rec, toWorker[0], fromWorker[1], (w * runs) / workersSize + 1, ((w + 1) * runs) / workersSize);
+        }
+        close(toWorker[0]);
+        close(fromWorker[1]);
+        worker->toWorker = toWorker[1];
+        worker->fromWorker = fromWorker[0];
+        rec->workersSize = w + 1;
+    }
+    if (IS_FAILED(ret)) {
+        _StopWorkers(rec);
+    }
+    return ret;
+}
+
+/*
+ * Advances the runs of an interval on the long-lived workers.  The parent sends every 
+ * worker the interval's start snapshot and the statistics the runs sample from, then 
+ * reads the blocks back in run order.  Since each run restarts from the snapshot on its 
+ * own ( seed, stream ), the results are those of the serial path for any number of 
+ * workers.  After a failure the workers are stopped, since some of them may be left 
+ * in the middle of an interval.
+ */
+static RET_VAL _AdvanceRunsInWorkers(MPDE_MONTE_CARLO_RECORD *rec, MPDE_INTERVAL *interval, double **mpRuns, double *mpTimes) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 k = 0;
+    UINT32 l = 0;
+    UINT32 w = 0;
+    UINT32 runs = rec->runs;
+    UINT32 size = rec->speciesSize;
+    UINT32 valuesSize = rec->state->valuesSize;
+    UINT32 eventsSize = rec->eventsSize;
+    UINT32 requestSize = _GetWorkerRequestSize(rec);
+    double *buffer = NULL;
+    double *species = NULL;
+    BIFURCATION_RECORD *birec = interval->birec;
+    MPDE_WORKER_REQUEST request;
+    MPDE_WORKER_RESULT result;
+    void (*oldPipeHandler)(int) = NULL;
+
+    if ((buffer = (double*) CALLOC(GET_MAX(requestSize, 1), sizeof(double))) == NULL) {
+        return ErrorReport(FAILING, "_AdvanceRunsInWorkers", "could not allocate memory for workers");
+    }
+    memset(&request, 0, sizeof(request));
+    request.intervalIndex = rec->intervalIndex;
+    request.time = interval->time;
+    request.end = interval->end;
+    request.start = interval->start;
+    request.smallProp = interval->smallProp;
+    request.remainingEvents = interval->remainingEvents;
+    request.nextPrintTime = interval->nextPrintTime;
+    memcpy(buffer, rec->runStartValues, valuesSize * sizeof(double));
+    for (i = 0; i < eventsSize; i++) {
+        buffer[valuesSize + i] = rec->runStartEventTimes[i];
+        buffer[valuesSize + eventsSize + i] = rec->runStartTriggersEnabled[i] ? 1.0 : 0.0;
+    }
+    species = buffer + valuesSize + 2 * eventsSize;
+    memcpy(species, interval->mpRun, size * sizeof(double));
+    memcpy(species + size, rec->oldSpeciesMeans, size * sizeof(double));
+    memcpy(species + 2 * size, rec->speciesSD, size * sizeof(double));
+    if ((birec != NULL) && (birec->isBifurcated != NULL)) {
+        request.isBifurcated = TRUE;
+        request.numberFirstCluster = birec->numberFirstCluster;
+        request.timeFirstCluster = birec->timeFirstCluster;
+        request.timeSecondCluster = birec->timeSecondCluster;
+        memcpy(species + 3 * size, birec->meanPathCluster1, size * sizeof(double));
+        memcpy(species + 4 * size, birec->meanPathCluster2, size * sizeof(double));
+    }
+
+    /* a dead worker must surface as an error, not as SIGPIPE in the parent */
+    oldPipeHandler = signal(SIGPIPE, SIG_IGN);
+    if (rec->workers == NULL) {
+        ret = _StartWorkers(rec);
+    }
+    for (w = 0; w < rec->workersSize && !IS_FAILED(ret); w++) {
+        if (IS_FAILED(_WriteFully(rec->workers[w].toWorker, &request, sizeof(request))) ||
+            IS_FAILED(_WriteFully(rec->workers[w].toWorker, buffer, requestSize * sizeof(double)))) {
+            ret = ErrorReport(FAILING, "_AdvanceRunsInWorkers", "worker %i terminated abnormally", w);
+        }
+    }
+    for (w = 0; w < rec->workersSize && !IS_FAILED(ret); w++) {
+        for (k = (w * runs) / rec->workersSize + 1; k <= ((w + 1) * runs) / rec->workersSize; k++) {
+            if (IS_FAILED(_ReadFully(rec->workers[w].fromWorker, &result, sizeof(result))) ||
+                IS_FAILED(_ReadFully(rec->workers[w].fromWorker, buffer, (valuesSize + 2 * eventsSize) * sizeof(double)))) {
+                ret = ErrorReport(FAILING, "_AdvanceRunsInWorkers", "worker advancing the %i-th run terminated abnormally", k);
+                break;
+            }
+            if (IS_FAILED(result.ret)) {
+                ret = result.ret;
+                break;
+            }
+            for (l = 0; l < size; l++) {
+                mpRuns[k - 1][l] = buffer[l];
+            }
+            mpTimes[k - 1] = result.time;
+            if (k == runs) {
+                memcpy(rec->state->values, buffer, valuesSize * sizeof(double));
+                StoreSimStateInIR(rec->state);
+                for (i = 0; i < eventsSize; i++) {
+                    SetNextEventTimeInEvent(rec->eventArray[i], buffer[valuesSize + i]);
+                    SetTriggerEnabledInEvent(rec->eventArray[i], buffer[valuesSize + eventsSize + i] != 0.0);
+                }
+                rec->time = result.time;
+            }
+        }
+    }
+    if (IS_FAILED(ret)) {
+        _StopWorkers(rec);
+    }
+    signal(SIGPIPE, oldPipeHandler);
+    FREE(buffer);
+    return ret;
+}
+
+#endif
+
 static RET_VAL _RunSimulation(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *backend) {
     RET_VAL ret = SUCCESS;
     int i = 0;
@@ -1313,25 +1978,22 @@ static RET_VAL _RunSimulation(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *
     double timeLimit = rec->timeLimit;
     double timeStep = rec->timeStep;
     double time = 0.0;
-    double maxTime = 0.0;
     double nextPrintTime = 0.0;
-    REACTION *reaction = NULL;
     SIMULATION_PRINTER *meanPrinter = NULL;
     SIMULATION_PRINTER *varPrinter = NULL;
     SIMULATION_PRINTER *sdPrinter = NULL;
     SIMULATION_PRINTER *mpPrinter1 = NULL;
     SIMULATION_PRINTER *mpPrinter2 = NULL;
-    SIMULATION_RUN_TERMINATION_DECIDER *decider = NULL;
     int nextEvent = 0;
-    double nextEventTime = 0;
     UINT32 size = rec->speciesSize;
     UINT32 numberSteps = rec->numberSteps;
     SPECIES *species = NULL;
     SPECIES **speciesArray = rec->speciesArray;
     SPECIES **speciesOrder = NULL;
-    double end;
-    double start;
+    double end = 0.0;
+    double start = 0.0;
     double newValue;
+    MPDE_INTERVAL interval;
     int useMP = rec->useMP;
     BOOL useMedian = rec->useMedian;
     BOOL useBifur = rec->useBifur;
@@ -1343,8 +2005,6 @@ static RET_VAL _RunSimulation(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *
     double *mpTimes;
     double n;
     double remainingEvents;
-    int eventCounter = 0;
-    int maxEvents = ceil(rec->timeStep);
     double minPrintInterval = rec->minPrintInterval;
     gsl_matrix *stoich_matrix = NULL;
     gsl_matrix *L_matrix = NULL;
@@ -1354,7 +2014,6 @@ static RET_VAL _RunSimulation(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *
     UINT32 reacSize = rec->reactionsSize;
     double smallProp = 0.0;
     double prop = 0.0;
-    REACTION **reactionArray = rec->reactionArray;
     int numberFirstCluster = 0;
     FILE *bifurFile = NULL;
     FILE *bifurTSDFile = NULL;
@@ -1458,7 +2117,7 @@ static RET_VAL _RunSimulation(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *
     }
     for (l = 0; l < size; l++) {
         species = speciesArray[l];
-        SetAmountInSpeciesNode(species, GetInitialAmountInSpeciesNode(species));
+        SetSpeciesAmountInSimState(rec->state, l, GetInitialAmountInSpeciesNode(species));
     }
     if (useMP != 0) {
         for (l = 0; l < size; l++) {
@@ -1477,9 +2136,8 @@ static RET_VAL _RunSimulation(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *
                 end = timeLimit;
             } else if (useMP == 2) {
                 for (l = 0; l < size; l++) {
-                    species = speciesArray[l];
                     newValue = mpRun[l];
-                    SetAmountInSpeciesNode(species, newValue);
+                    SetSpeciesAmountInSimState(rec->state, l, newValue);
                 }
                 if (IS_FAILED((ret = _UpdateAllReactionRateUpdateTimes(rec, rec->time)))) {
                     return ret;
@@ -1488,9 +2146,9 @@ static RET_VAL _RunSimulation(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *
                     return ret;
                 }
                 if (reacSize > 0) {
-                	smallProp = GetReactionRate(reactionArray[0]);
+                	smallProp = rec->state->propensities[0];
                     for (i = 1; i < reacSize; i++) {
-                    	prop = GetReactionRate(reactionArray[i]);
+                    	prop = rec->state->propensities[i];
                     	if (IS_REAL_EQUAL(smallProp, 0.0)) {
                     		smallProp = prop;
                     	}
@@ -1527,9 +2185,8 @@ static RET_VAL _RunSimulation(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *
                 end = nextPrintTime;
             } else if (useMP == 2) {
                 for (l = 0; l < size; l++) {
-                    species = speciesArray[l];
                     newValue = mpRun[l];
-                    SetAmountInSpeciesNode(species, newValue);
+                    SetSpeciesAmountInSimState(rec->state, l, newValue);
                 }
                 if (IS_FAILED((ret = _UpdateAllReactionRateUpdateTimes(rec, rec->time)))) {
                     return ret;
@@ -1538,9 +2195,9 @@ static RET_VAL _RunSimulation(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *
                     return ret;
                 }
                 if (reacSize > 0) {
-                	smallProp = GetReactionRate(reactionArray[0]);
+                	smallProp = rec->state->propensities[0];
                 	for (i = 1; i < reacSize; i++) {
-                		prop = GetReactionRate(reactionArray[i]);
+                		prop = rec->state->propensities[i];
                 		if (IS_REAL_EQUAL(smallProp, 0.0)) {
                 			smallProp = prop;
                 		}
@@ -1584,208 +2241,41 @@ static RET_VAL _RunSimulation(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *
             return ErrorReport(FAILING, "_RunSimulation", "could not create simulation decider");
         }
 	*/
-	rec->decider->timeLimit = end;
-        decider = rec->decider;
-        for (k = 1; k <= rec->runs; k++) {
-
-            eventCounter = 0;
-            rec->time = time;
-            i = 0;
-            if (useMP != 0) {
-            	if (!useBifur || birec->isBifurcated == NULL) {
-            		for (l = 0; l < size; l++) {
-                    	species = speciesArray[l];
-                    	newValue = mpRun[l];
-                    	SetAmountInSpeciesNode(species, newValue);
-                	}
-            	}
-            	else if (birec->isBifurcated != NULL) {
-            		if (k <= birec->numberFirstCluster) {
-            			for (l = 0; l < size; l++) {
-            				species = speciesArray[l];
-            			    newValue = birec->meanPathCluster1[l];
-            			    SetAmountInSpeciesNode(species, newValue);
-            			}
-            			if (useMP == 2 || useMP == 3) {
-            				rec->time = birec->timeFirstCluster;
-            			}
-            		}
-            		else {
-            			for (l = 0; l < size; l++) {
-            			    species = speciesArray[l];
-            			    newValue = birec->meanPathCluster2[l];
-            			    SetAmountInSpeciesNode(species, newValue);
-            			}
-            			if (useMP == 2 || useMP == 3) {
-            				rec->time = birec->timeSecondCluster;
-            			}
-            		}
-            	}
-            } else {
-                do {
-                    for (l = 0; l < size; l++) {
-                        species = speciesArray[l];
-                        if (rec->speciesSD[l] == 0) {
-                            newValue = rec->oldSpeciesMeans[l];
-                        } else {
-                            newValue = GetNextNormalRandomNumber(rec->oldSpeciesMeans[l], rec->speciesSD[l]);
-                        }
-                        newValue = round(newValue);
-                        if (newValue < 0.0)
-                            newValue = 0.0;
-                        SetAmountInSpeciesNode(species, newValue);
-                    }
-                } while ((decider->IsTerminationConditionMet(decider, reaction, rec->time)));
-            }
-            if (IS_FAILED((ret = _UpdateAllReactionRateUpdateTimes(rec, rec->time)))) {
-                return ret;
-            }
-            while (!(decider->IsTerminationConditionMet(decider, reaction, rec->time))) {
-                i++;
-
-                if (useMP == 2 || useMP == 3) {
-                    maxTime = DBL_MAX;
-                } else {
-                    if (timeStep == DBL_MAX) {
-                        maxTime = DBL_MAX;
-                    } else {
-                        maxTime = maxTime + timeStep;
-                    }
-                }
-                nextEventTime = fireEvents(rec, rec->time);
-		if (decider->IsTerminationConditionMet( decider, reaction, rec->time )) break;
-                if (nextEventTime == -2.0) {
-                    return FAILING;
-                }
-                if ((nextEventTime != -1) && (nextEventTime < maxTime)) {
-                    maxTime = nextEventTime;
-                }
-
-                if (IS_FAILED((ret = _CalculatePropensities(rec)))) {
-                    return ret;
-                }
-                if (IS_FAILED((ret = _CalculateTotalPropensities(rec)))) {
-                    return ret;
-                }
-                if (IS_REAL_EQUAL(rec->totalPropensities, 0.0)) {
-                    TRACE_1("the total propensity is 0 at iteration %i", i);
-		    rec->t = maxTime - rec->time;
-		    rec->time = maxTime;
-                    reaction = NULL;
-                    rec->nextReaction = NULL;
-                    if (IS_FAILED((ret = _UpdateNodeValues(rec)))) {
-                        return ret;
-                    }
-                    //if( IS_FAILED( ( ret = _Print( rec ) ) ) ) {
-                    //  return ret;
-                    //}
-                } else {
-                    if (IS_FAILED((ret = _FindNextReactionTime(rec)))) {
-                        return ret;
-                    }
-                    if (maxTime < rec->time) {
-                        rec->time -= rec->t;
-                        rec->t = maxTime - rec->time;
-                        rec->time = maxTime;
-                        reaction = NULL;
-                        rec->nextReaction = NULL;
-                        if (IS_FAILED((ret = _UpdateNodeValues(rec)))) {
-                            return ret;
-                        }
-                        //if( IS_FAILED( ( ret = _Print( rec ) ) ) ) {
-                        //  return ret;
-                        //}
-                    } else {
-                        maxTime = rec->time;
-                        if (rec->time < timeLimit) {
-                            if (IS_FAILED((ret = _FindNextReaction(rec)))) {
-                                return ret;
-                            }
-                            reaction = rec->nextReaction;
-                            if (IS_FAILED((ret = _UpdateNodeValues(rec)))) {
-                                return ret;
-                            }
-                        } else {
-                            //if( IS_FAILED( ( ret = _Print( rec ) ) ) ) {
-                            //  return ret;
-                            //}
-                        }
-                    }
-                }
-                if (useMP == 3) {
-                    eventCounter++;
-                    if (eventCounter >= maxEvents) {
-                        break;
-                    }
-                }
-                else if (useMP == 2) {
-                	remainingEvents = remainingEvents - (rec->time - start) * smallProp;
-                	if (reacSize > 0) {
-                		smallProp = GetReactionRate(reactionArray[0]);
-                		for (i = 1; i < reacSize; i++) {
-                			prop = GetReactionRate(reactionArray[i]);
-                			if (IS_REAL_EQUAL(smallProp, 0.0)) {
-                				smallProp = prop;
-                			}
-                			else if (smallProp > prop && !IS_REAL_EQUAL(prop, 0.0)) {
-                				smallProp = prop;
-                			}
-                		}
-                	}
-                	if (IS_REAL_EQUAL(smallProp, 0.0)) {
-                		n = remainingEvents;
-                	} else {
-                		n = (remainingEvents / smallProp);
-                	}
-                	if (minPrintInterval >= 0.0) {
-                		if ((n + rec->time) > nextPrintTime) {
-                			end = nextPrintTime;
-                		} else {
-                			end = n + rec->time;
-                		}
-                	}
-                	else {
-                		end = n + rec->time;
-                	}
-                	start = rec->time;
-                	rec->decider->timeLimit = end;
-                }
-            }
+        interval.time = time;
+        interval.end = end;
+        interval.start = start;
+        interval.smallProp = smallProp;
+        interval.remainingEvents = remainingEvents;
+        interval.nextPrintTime = nextPrintTime;
+        interval.mpRun = mpRun;
+        interval.birec = birec;
+        if (IS_FAILED((ret = _AdvanceRuns(rec, &interval, mpRuns, mpTimes)))) {
+            return ret;
+        }
+        rec->intervalIndex++;
 
+        /* the runs are reduced in run order, so the statistics do not depend on the workers */
+        for (k = 1; k <= rec->runs; k++) {
             if (k == 1) {
                 for (l = 0; l < size; l++) {
-                    species = speciesArray[l];
-                    rec->newSpeciesMeans[l] = GetAmountInSpeciesNode(species);
+                    rec->newSpeciesMeans[l] = mpRuns[k - 1][l];
                     rec->newSpeciesVariances[l] = 0;
-                    if (useMP != 0) {
-                        mpRuns[k - 1][l] = GetAmountInSpeciesNode(species);
-                    }
                 }
-                rec->newTimeMean = rec->time;
-                //printf("\n");
-                fflush(stdout);
+                rec->newTimeMean = mpTimes[k - 1];
             } else {
                 for (l = 0; l < size; l++) {
-                    species = speciesArray[l];
                     double old = rec->newSpeciesMeans[l];
-                    rec->newSpeciesMeans[l] = old + ((GetAmountInSpeciesNode(species) - old) / k);
+                    rec->newSpeciesMeans[l] = old + ((mpRuns[k - 1][l] - old) / k);
                     double new = rec->newSpeciesMeans[l];
                     double oldVary = rec->newSpeciesVariances[l];
-                    double newVary = (((k - 2) * oldVary) + (GetAmountInSpeciesNode(species) - new)
-                            * (GetAmountInSpeciesNode(species) - old)) / (k - 1);
+                    double newVary = (((k - 2) * oldVary) + (mpRuns[k - 1][l] - new)
+                            * (mpRuns[k - 1][l] - old)) / (k - 1);
                     rec->newSpeciesVariances[l] = newVary;
-                    if (useMP != 0) {
-                        mpRuns[k - 1][l] = GetAmountInSpeciesNode(species);
-                    }
                 }
                 double old = rec->newTimeMean;
-                rec->newTimeMean = old + ((rec->time - old) / k);
-            }
-            if (useMP == 2 || useMP == 3) {
-                mpTimes[k - 1] = rec->time;
+                rec->newTimeMean = old + ((mpTimes[k - 1] - old) / k);
             }
         }
-
         if (useMP != 3) {
             time = end;
         }
@@ -1922,10 +2412,15 @@ static RET_VAL _RunSimulation(MPDE_MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *
             }
         }
     }
+#if defined(MPDE_USE_WORKER_PROCESSES)
+    _StopWorkers(rec);
+#endif
     if (rec->time >= timeLimit) {
         rec->time = timeLimit;
     }
-    nextEventTime = fireEvents(rec, rec->time);
+    if (fireEvents(rec, rec->time) == -2.0) {
+        return FAILING;
+    }
     printf("Time = %g\n", timeLimit);
     fflush(stdout);
     for (l = 0; l < size; l++) {
@@ -2056,6 +2551,9 @@ static RET_VAL _CleanRecord(MPDE_MONTE_CARLO_RECORD *rec) {
     SIMULATION_PRINTER *mpPrinter2 = rec->mpPrinter2;
     SIMULATION_RUN_TERMINATION_DECIDER *decider = rec->decider;
 
+#if defined(MPDE_USE_WORKER_PROCESSES)
+    _StopWorkers(rec);
+#endif
     sprintf(filename, "%s%csim-rep.txt", rec->outDir, FILE_SEPARATOR);
     if ((file = fopen(filename, "w")) == NULL) {
         return ErrorReport(FAILING, "_CleanRecord", "could not create a report file");
@@ -2068,6 +2566,15 @@ static RET_VAL _CleanRecord(MPDE_MONTE_CARLO_RECORD *rec) {
     if (rec->evaluator != NULL) {
         FreeKineticLawEvaluater(&(rec->evaluator));
     }
+    if (rec->state != NULL) {
+        FreeSimState(&(rec->state));
+    }
+    if (rec->dependencyGraph != NULL) {
+        FreeNextReactionDependencyGraph(&(rec->dependencyGraph));
+    }
+    if (rec->propensityTree != NULL) {
+        FreeSumTree(&(rec->propensityTree));
+    }
     if (rec->reactionArray != NULL) {
         FREE(rec->reactionArray);
     }
@@ -2092,6 +2599,18 @@ static RET_VAL _CleanRecord(MPDE_MONTE_CARLO_RECORD *rec) {
     if (rec->speciesSD != NULL) {
         FREE(rec->speciesSD);
     }
+    if (rec->randomNumberContext != NULL) {
+        FreeRandomNumberContext(&(rec->randomNumberContext));
+    }
+    if (rec->runStartValues != NULL) {
+        FREE(rec->runStartValues);
+    }
+    if (rec->runStartEventTimes != NULL) {
+        FREE(rec->runStartEventTimes);
+    }
+    if (rec->runStartTriggersEnabled != NULL) {
+        FREE(rec->runStartTriggersEnabled);
+    }
 
     meanPrinter->Destroy(meanPrinter);
     varPrinter->Destroy(varPrinter);
@@ -2155,7 +2674,7 @@ static RET_VAL _PrintStatistics(MPDE_MONTE_CARLO_RECORD *rec, FILE *file) {
 
 	for (i = 0; i < speciesSize; i++) {
 		species = speciesArray[i];
-		SetAmountInSpeciesNode(species, GetInitialAmountInSpeciesNode(species));
+		SetSpeciesAmountInSimState(rec->state, i, GetInitialAmountInSpeciesNode(species));
 		fprintf( file, "%s = %f" NEW_LINE, *GetSpeciesNodeID(species), GetInitialAmountInSpeciesNode(species));
 	}
 	fprintf( file, NEW_LINE);
@@ -2261,19 +2780,14 @@ static BOOL _IsTerminationConditionMet(MPDE_MONTE_CARLO_RECORD *rec) {
     return FALSE;
 }
 
+/*
+ * The propensity tree is kept current by _CalculatePropensity, so its root is the total.
+ */
 static RET_VAL _CalculateTotalPropensities(MPDE_MONTE_CARLO_RECORD *rec) {
     RET_VAL ret = SUCCESS;
-    UINT32 i = 0;
-    UINT32 size = rec->reactionsSize;
     double total = 0.0;
-    REACTION **reactionArray = rec->reactionArray;
 
-    if (size > 0) {
-        total = GetReactionRate(reactionArray[0]);
-        for (i = 1; i < size; i++) {
-            total += GetReactionRate(reactionArray[i]);
-        }
-    }
+    total = GetTotalInSumTree(rec->propensityTree);
     rec->totalPropensities = total;
     TRACE_1("the total propensity is %f", total);
     return ret;
@@ -2298,11 +2812,6 @@ static RET_VAL _CalculatePropensities(MPDE_MONTE_CARLO_RECORD *rec) {
             }
         }
     }
-#if 0
-    /* qsort is not good way to sort an array which is nearly sorted. */
-    qsort( rec->reactionArray, size, sizeof(REACTION*), (int(*)(const void *, const void *))_ComparePropensity );
-#endif
-
 #ifdef DEBUG
     for( i = 0; i < size; i++ ) {
         printf( "(%s, %f), ", GetCharArrayOfString( GetReactionNodeName( rec->reactionArray[i] ) ), GetReactionRate( rec->reactionArray[i] ) );
@@ -2314,88 +2823,24 @@ static RET_VAL _CalculatePropensities(MPDE_MONTE_CARLO_RECORD *rec) {
 
 static RET_VAL _CalculatePropensity(MPDE_MONTE_CARLO_RECORD *rec, REACTION *reaction) {
     RET_VAL ret = SUCCESS;
-    double stoichiometry = 0.0;
-    double amount = 0;
     double propensity = 0.0;
-    double time = rec->time;
-    SPECIES *species = NULL;
-    IR_EDGE *edge = NULL;
-    LINKED_LIST *edges = NULL;
     KINETIC_LAW *law = NULL;
     KINETIC_LAW_EVALUATER *evaluator = rec->evaluator;
-    REB2SAC_SYMBOL *speciesRef = NULL;
-    REB2SAC_SYMBOL *convFactor = NULL;
 
-    edges = GetReactantEdges((IR_NODE*) reaction);
-    ResetCurrentElement(edges);
-    while ((edge = GetNextEdge(edges)) != NULL) {
-      speciesRef = GetSpeciesRefInIREdge( edge );
-      if (speciesRef) {
-	stoichiometry = GetCurrentRealValueInSymbol( speciesRef );
-      } else {
-	stoichiometry = GetStoichiometryInIREdge( edge );
-      }
-      species = GetSpeciesInIREdge(edge);
-      if (( convFactor = GetConversionFactorInSpeciesNode( species ) )!=NULL) {
-	stoichiometry *= GetCurrentRealValueInSymbol( convFactor );
-      }
-      amount = GetAmountInSpeciesNode(species);
-      if (amount < stoichiometry) {
-	if (IS_FAILED((ret = SetReactionRate(reaction, 0.0)))) {
-	  return ret;
-	}
-#ifdef DEBUG
-	printf( "(%s, %f)" NEW_LINE, GetCharArrayOfString( GetReactionNodeName( reaction ) ),
-		GetReactionRate( reaction ) );
-#endif
-	return SUCCESS;
-      }
-    }
-#if 0
-    edges = GetModifierEdges( (IR_NODE*)reaction );
-    ResetCurrentElement( edges );
-    while( ( edge = GetNextEdge( edges ) ) != NULL ) {
-      speciesRef = GetSpeciesRefInIREdge( edge );
-      if (speciesRef) {
-	stoichiometry = GetCurrentRealValueInSymbol( speciesRef );
-      } else {
-	stoichiometry = GetStoichiometryInIREdge( edge );
-      }
-      species = GetSpeciesInIREdge( edge );
-      if (( convFactor = GetConversionFactorInSpeciesNode( species ) )!=NULL) {
-	stoichiometry *= GetCurrentRealValueInSymbol( convFactor );
-      }
-      amount = GetAmountInSpeciesNode( species );
-      if( amount < stoichiometry ) {
-	if( IS_FAILED( ( ret = SetReactionRate( reaction, 0.0 ) ) ) ) {
-	  return ret;
-	}
-#ifdef DEBUG
-	printf( "(%s, %f)" NEW_LINE, GetCharArrayOfString( GetReactionNodeName( reaction ) ),
-		GetReactionRate( reaction ) );
-#endif
-	return SUCCESS;
-      }
-    }
-#endif
-
-    evaluator = rec->evaluator;
-    law = GetKineticLawInReactionNode(reaction);
-    propensity = evaluator->EvaluateWithCurrentAmountsDeter(evaluator, law);
-    if (propensity <= 0.0) {
-        if (IS_FAILED((ret = SetReactionRate(reaction, 0.0)))) {
-            return ret;
+    if (HasEnoughReactantsInSimState(rec->state, GetReactionIndex(reaction))) {
+        law = GetKineticLawInReactionNode(reaction);
+        propensity = evaluator->EvaluateWithCurrentAmountsDeter(evaluator, law);
+        /* in case nan */
+        if ((propensity <= 0.0) || !(propensity < DBL_MAX)) {
+            propensity = 0.0;
         }
     }
-    /* in case nan */
-    else if (!(propensity < DBL_MAX)) {
-        if (IS_FAILED((ret = SetReactionRate(reaction, 0.0)))) {
-            return ret;
-        }
-    } else {
-        if (IS_FAILED((ret = SetReactionRate(reaction, propensity)))) {
-            return ret;
-        }
+    rec->state->propensities[GetReactionIndex(reaction)] = propensity;
+    if (IS_FAILED((ret = UpdateValueInSumTree(rec->propensityTree, GetReactionIndex(reaction), propensity)))) {
+        return ret;
+    }
+    if (IS_FAILED((ret = SetReactionRate(reaction, propensity)))) {
+        return ret;
     }
 #ifdef DEBUG
     printf( "(%s, %f)" NEW_LINE, GetCharArrayOfString( GetReactionNodeName( reaction ) ),
@@ -2409,7 +2854,7 @@ static RET_VAL _FindNextReactionTime(MPDE_MONTE_CARLO_RECORD *rec) {
     double random = 0.0;
     double t = 0.0;
 
-    random = GetNextUnitUniformRandomNumber();
+    random = GetNextUnitUniformRandomNumberInContext(rec->randomNumberContext);
     t = log(1.0 / random) / rec->totalPropensities;
     rec->time += t;
     rec->t = t;
@@ -2421,27 +2866,23 @@ static RET_VAL _FindNextReactionTime(MPDE_MONTE_CARLO_RECORD *rec) {
     return ret;
 }
 
+/*
+ * Selects the reaction whose cumulative propensity interval holds the threshold in 
+ * O(log R) on the propensity tree, instead of scanning the propensities in order.
+ */
 static RET_VAL _FindNextReaction(MPDE_MONTE_CARLO_RECORD *rec) {
     RET_VAL ret = SUCCESS;
     UINT32 i = 0;
-    UINT32 size = rec->reactionsSize - 1;
     double random = 0.0;
     double threshold = 0.0;
-    double sum = 0.0;
-    REACTION *reaction = NULL;
     REACTION **reactionArray = rec->reactionArray;
 
-    random = GetNextUnitUniformRandomNumber();
+    random = GetNextUnitUniformRandomNumberInContext(rec->randomNumberContext);
     threshold = random * rec->totalPropensities;
 
     TRACE_1("next reaction threshold is %f", threshold);
 
-    for (i = 0; i < size; i++) {
-        sum += GetReactionRate(reactionArray[i]);
-        if (sum >= threshold) {
-            break;
-        }
-    }
+    i = FindIndexInSumTree(rec->propensityTree, threshold);
 
     rec->nextReaction = reactionArray[i];
     TRACE_1("next reaction is %s", GetCharArrayOfString(GetReactionNodeName(rec->nextReaction)));
@@ -2555,9 +2996,9 @@ static double fireEvents(MPDE_MONTE_CARLO_RECORD *rec, double time) {
 	    if ((eventToFire==(-1)) || (priority > prMax)) {
 	      eventToFire = i;
 	      prMax = priority;
-	      prMax2=GetNextUniformRandomNumber(0,1);	   
+	      prMax2=GetNextUniformRandomNumberInContext(rec->randomNumberContext,0,1);	   
 	    } else if (priority == prMax) {
-	      randChoice=GetNextUniformRandomNumber(0,1);	   
+	      randChoice=GetNextUniformRandomNumberInContext(rec->randomNumberContext,0,1);	   
 	      if (randChoice > prMax2) {
 		eventToFire = i;
 		prMax2 = randChoice;
@@ -2693,14 +3134,14 @@ static void fireEvent(EVENT *event, MPDE_MONTE_CARLO_RECORD *rec) {
 	amount = GetEventAssignmentNextValueTime(eventAssignment, rec->time);
         //printf("conc = %g\n",amount);
         if (varType == SPECIES_EVENT_ASSIGNMENT) {
-            SetAmountInSpeciesNode(rec->speciesArray[j], amount);
+            SetSpeciesAmountInSimState(rec->state, j, amount);
             _UpdateReactionRateUpdateTimeForSpecies(rec, rec->speciesArray[j]);
         } else if (varType == COMPARTMENT_EVENT_ASSIGNMENT) {
-            SetCurrentSizeInCompartment(rec->compartmentArray[j], amount);
-            _UpdateAllReactionRateUpdateTimes(rec, rec->time);
+            SetCompartmentSizeInSimState(rec->state, j, amount);
+            _UpdateReactionRateUpdateTimeForCompartment(rec, j);
         } else {
-            SetCurrentRealValueInSymbol(rec->symbolArray[j], amount);
-            _UpdateAllReactionRateUpdateTimes(rec, rec->time);
+            SetSymbolValueInSimState(rec->state, j, amount);
+            _UpdateReactionRateUpdateTimeForSymbol(rec, j);
         }
     }
 }
@@ -2719,14 +3160,14 @@ static void ExecuteAssignments(MPDE_MONTE_CARLO_RECORD *rec) {
             varType = GetRuleVarType(rec->ruleArray[i]);
             j = GetRuleIndex(rec->ruleArray[i]);
             if (varType == SPECIES_RULE) {
-                SetAmountInSpeciesNode(rec->speciesArray[j], amount);
+                SetSpeciesAmountInSimState(rec->state, j, amount);
                 _UpdateReactionRateUpdateTimeForSpecies(rec, rec->speciesArray[j]);
             } else if (varType == COMPARTMENT_RULE) {
-                SetCurrentSizeInCompartment(rec->compartmentArray[j], amount);
-                _UpdateAllReactionRateUpdateTimes(rec, rec->time);
+                SetCompartmentSizeInSimState(rec->state, j, amount);
+                _UpdateReactionRateUpdateTimeForCompartment(rec, j);
             } else {
-                SetCurrentRealValueInSymbol(rec->symbolArray[j], amount);
-                _UpdateAllReactionRateUpdateTimes(rec, rec->time);
+                SetSymbolValueInSimState(rec->state, j, amount);
+                _UpdateReactionRateUpdateTimeForSymbol(rec, j);
             }
         }
     }
@@ -2746,7 +3187,7 @@ int MPDEalgebraicRules(const gsl_vector * x, void *params, gsl_vector * f) {
     if (IsSpeciesNodeAlgebraic( species )) {
       amount = gsl_vector_get (x, j);
       j++; 
-      SetAmountInSpeciesNode( species, amount );
+      SetSpeciesAmountInSimState( rec->state, i, amount );
     }
   }
   for( i = 0; i < rec->compartmentsSize; i++ ) {
@@ -2754,7 +3195,7 @@ int MPDEalgebraicRules(const gsl_vector * x, void *params, gsl_vector * f) {
     if (IsCompartmentAlgebraic( compartment )) {
       amount = gsl_vector_get (x, j);
       j++;
-      SetCurrentSizeInCompartment( compartment, amount );
+      SetCompartmentSizeInSimState( rec->state, i, amount );
     }
   }
   for( i = 0; i < rec->symbolsSize; i++ ) {
@@ -2762,7 +3203,7 @@ int MPDEalgebraicRules(const gsl_vector * x, void *params, gsl_vector * f) {
     if (IsSymbolAlgebraic( symbol )) {
       amount = gsl_vector_get (x, j);
       j++;
-      SetCurrentRealValueInSymbol( symbol, amount );
+      SetSymbolValueInSimState( rec->state, i, amount );
     }
   }
   j = 0;
@@ -2882,9 +3323,9 @@ int MPDEfastReactions(const gsl_vector * x, void *params, gsl_vector * f) {
       amount = gsl_vector_get (x, j);
       j++; 
       if (HasOnlySubstanceUnitsInSpeciesNode( species )) {
-	SetAmountInSpeciesNode( species, amount );
+	SetSpeciesAmountInSimState( rec->state, i, amount );
       } else {
-	SetConcentrationInSpeciesNode( species, amount );
+	SetSpeciesConcentrationInSimState( rec->state, i, amount );
       }
     }
   }
@@ -3162,7 +3603,7 @@ static RET_VAL ExecuteFastReactions( MPDE_MONTE_CARLO_RECORD *rec ) {
       //if (IsSpeciesNodeFast( species )) {
       amount = gsl_vector_get (s->x, j);
       j++; 
-      SetAmountInSpeciesNode( species, amount );
+      SetSpeciesAmountInSimState( rec->state, i, amount );
     }
   }
      
@@ -3173,21 +3614,14 @@ static RET_VAL ExecuteFastReactions( MPDE_MONTE_CARLO_RECORD *rec ) {
 
 static RET_VAL _UpdateSpeciesValues(MPDE_MONTE_CARLO_RECORD *rec) {
     RET_VAL ret = SUCCESS;
-    double stoichiometry = 0;
     double amount = 0;
     double change = 0;
-    SPECIES *species = NULL;
-    IR_EDGE *edge = NULL;
     REACTION *reaction = rec->nextReaction;
-    LINKED_LIST *edges = NULL;
-    KINETIC_LAW_EVALUATER *evaluator = rec->evaluator;
     UINT i = 0;
     UINT j = 0;
     double deltaTime;
     BOOL triggerEnabled;
     BYTE varType;
-    REB2SAC_SYMBOL *speciesRef = NULL;
-    REB2SAC_SYMBOL *convFactor = NULL;
 
     for (i = 0; i < rec->rulesSize; i++) {
         if (GetRuleType(rec->ruleArray[i]) == RULE_TYPE_RATE_ASSIGNMENT) {
@@ -3219,68 +3653,27 @@ static RET_VAL _UpdateSpeciesValues(MPDE_MONTE_CARLO_RECORD *rec) {
             varType = GetRuleVarType(rec->ruleArray[i]);
             j = GetRuleIndex(rec->ruleArray[i]);
             if (varType == SPECIES_RULE) {
-                SetAmountInSpeciesNode(rec->speciesArray[j], amount);
+                SetSpeciesAmountInSimState(rec->state, j, amount);
                 _UpdateReactionRateUpdateTimeForSpecies(rec, rec->speciesArray[j]);
             } else if (varType == COMPARTMENT_RULE) {
-                SetCurrentSizeInCompartment(rec->compartmentArray[j], amount);
-                _UpdateAllReactionRateUpdateTimes(rec, rec->time);
+                SetCompartmentSizeInSimState(rec->state, j, amount);
+                _UpdateReactionRateUpdateTimeForCompartment(rec, j);
             } else {
-                SetCurrentRealValueInSymbol(rec->symbolArray[j], amount);
-                _UpdateAllReactionRateUpdateTimes(rec, rec->time);
+                SetSymbolValueInSimState(rec->state, j, amount);
+                _UpdateReactionRateUpdateTimeForSymbol(rec, j);
             }
         }
     }
 
     if (reaction) {
-        edges = GetReactantEdges((IR_NODE*) reaction);
-        ResetCurrentElement(edges);
-        while ((edge = GetNextEdge(edges)) != NULL) {
-	  speciesRef = GetSpeciesRefInIREdge( edge );
-	  if (speciesRef) {
-	    stoichiometry = GetCurrentRealValueInSymbol( speciesRef );
-	  } else {
-	    stoichiometry = GetStoichiometryInIREdge( edge );
-	  }
-	  species = GetSpeciesInIREdge(edge);
-	  if (( convFactor = GetConversionFactorInSpeciesNode( species ) )!=NULL) {
-	    stoichiometry *= GetCurrentRealValueInSymbol( convFactor );
-	  }
-	  if (HasBoundaryConditionInSpeciesNode(species))
-	    continue;
-	  amount = GetAmountInSpeciesNode(species) - stoichiometry;
-	  TRACE_3("the amount of %s decreases from %g to %g", GetCharArrayOfString(GetSpeciesNodeName(species)),
-		  GetAmountInSpeciesNode(species), amount);
-	  SetAmountInSpeciesNode(species, amount);
-	  if (IS_FAILED((ret = evaluator->SetSpeciesValue(evaluator, species, amount)))) {
-	    return ret;
-	  }
-        }
-        edges = GetProductEdges((IR_NODE*) reaction);
-        ResetCurrentElement(edges);
-        while ((edge = GetNextEdge(edges)) != NULL) {
-	  speciesRef = GetSpeciesRefInIREdge( edge );
-	  if (speciesRef) {
-	    stoichiometry = GetCurrentRealValueInSymbol( speciesRef );
-	  } else {
-	    stoichiometry = GetStoichiometryInIREdge( edge );
-	  }
-	  species = GetSpeciesInIREdge(edge);
-	  if (( convFactor = GetConversionFactorInSpeciesNode( species ) )!=NULL) {
-	    stoichiometry *= GetCurrentRealValueInSymbol( convFactor );
-	  }
-	  if (HasBoundaryConditionInSpeciesNode(species))
-	    continue;
-	  amount = GetAmountInSpeciesNode(species) + stoichiometry;
-	  TRACE_3("the amount of %s increases from %g to %g", GetCharArrayOfString(GetSpeciesNodeName(species)),
-		  GetAmountInSpeciesNode(species), amount);
-	  SetAmountInSpeciesNode(species, amount);
-        }
+        FireReactionInSimState(rec->state, GetReactionIndex(reaction), 1.0);
     }
 
     for (j = 0; j < rec->symbolsSize; j++) {
         if ((strcmp(GetCharArrayOfString(GetSymbolID(rec->symbolArray[j])), "t") == 0) || (strcmp(GetCharArrayOfString(
                 GetSymbolID(rec->symbolArray[j])), "time") == 0)) {
-            SetCurrentRealValueInSymbol(rec->symbolArray[j], rec->time);
+            SetSymbolValueInSimState(rec->state, j, rec->time);
+            _UpdateReactionRateUpdateTimeForSymbol(rec, j);
         }
     }
 
@@ -3307,6 +3700,38 @@ static RET_VAL _UpdateAllReactionRateUpdateTimes(MPDE_MONTE_CARLO_RECORD *rec, d
     return ret;
 }
 
+/*
+ * A changed compartment or symbol updates only the reactions whose kinetic laws read it, 
+ * directly or through assignment rules, as recorded in the dependency graph.
+ */
+static RET_VAL _UpdateReactionRateUpdateTimeForCompartment(MPDE_MONTE_CARLO_RECORD *rec, UINT32 index) {
+    UINT32 size = 0;
+    UINT32 *reactions = NULL;
+
+    reactions = GetReactionsDependingOnCompartment(rec->dependencyGraph, index, &size);
+    return _UpdateReactionRateUpdateTimes(rec, reactions, size);
+}
+
+static RET_VAL _UpdateReactionRateUpdateTimeForSymbol(MPDE_MONTE_CARLO_RECORD *rec, UINT32 index) {
+    UINT32 size = 0;
+    UINT32 *reactions = NULL;
+
+    reactions = GetReactionsDependingOnSymbol(rec->dependencyGraph, index, &size);
+    return _UpdateReactionRateUpdateTimes(rec, reactions, size);
+}
+
+static RET_VAL _UpdateReactionRateUpdateTimes(MPDE_MONTE_CARLO_RECORD *rec, UINT32 *reactions, UINT32 size) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+
+    for (i = 0; i < size; i++) {
+        if (IS_FAILED((ret = SetReactionRateUpdatedTime(rec->reactionArray[reactions[i]], rec->time)))) {
+            return ret;
+        }
+    }
+    return ret;
+}
+
 static RET_VAL _UpdateReactionRateUpdateTimeForSpecies(MPDE_MONTE_CARLO_RECORD *rec, SPECIES* species) {
     RET_VAL ret = SUCCESS;
     double time = rec->time;
@@ -3373,19 +3798,6 @@ static RET_VAL _UpdateReactionRateUpdateTime(MPDE_MONTE_CARLO_RECORD *rec) {
     return ret;
 }
 
-static int _ComparePropensity(REACTION *a, REACTION *b) {
-    double d1 = 0.0;
-    double d2 = 0.0;
-
-    d1 = GetReactionRate(a);
-    d2 = GetReactionRate(b);
-
-    if (IS_REAL_EQUAL(d1, d2)) {
-        return 0;
-    }
-    return (d1 < d2) ? -1 : 1;
-}
-
 static gsl_matrix* _GetStoichiometricMatrix(MPDE_MONTE_CARLO_RECORD *rec) {
     double stoichiometry = 0;
     UINT32 i = 0;
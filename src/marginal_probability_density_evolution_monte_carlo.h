@@ -2,6 +2,9 @@
 #define HAVE_MPDE_MONTE_CARLO
 
 #include "simulation_method.h"
+#include "sim_state.h"
+#include "sum_tree.h"
+#include "dependency_graph.h"
 
 BEGIN_C_NAMESPACE
 
@@ -13,6 +16,9 @@ DLLSCOPE RET_VAL STDCALL CloseMPDEMonteCarloAnalyzer(BACK_END_PROCESSOR *backend
 #define GET_SEED_FROM_COMMAND_LINE 1
 #endif
 
+struct _MPDE_WORKER;
+typedef struct _MPDE_WORKER MPDE_WORKER;
+
 typedef struct {
     REACTION **reactionArray;
     UINT32 reactionsSize;
@@ -51,10 +57,21 @@ typedef struct {
     double timeLimit;
     double timeStep;
     KINETIC_LAW_EVALUATER *evaluator;
+    SIM_STATE *state;
+    NEXT_REACTION_DEPENDENCY_GRAPH *dependencyGraph;
     KINETIC_LAW_FIND_NEXT_TIME *findNextTime;
+    SUM_TREE *propensityTree;
     double totalPropensities;
     UINT32 seed;
     UINT32 runs;
+    UINT32 threads;
+    UINT32 intervalIndex;
+    RANDOM_NUMBER_CONTEXT *randomNumberContext;
+    double *runStartValues;
+    double *runStartEventTimes;
+    BYTE *runStartTriggersEnabled;
+    MPDE_WORKER *workers;
+    UINT32 workersSize;
     char *outDir;
     int startIndex;
     double *oldSpeciesMeans;
@@ -86,6 +103,20 @@ typedef struct {
     BOOL *isBifurcated;
 } BIFURCATION_RECORD;
 
+// This struct holds what every run of a print interval starts from. The runs of an
+// interval only read it, so they can be advanced in any order and in any process
+
+typedef struct {
+    double time;
+    double end;
+    double start;
+    double smallProp;
+    double remainingEvents;
+    double nextPrintTime;
+    double *mpRun;
+    BIFURCATION_RECORD *birec;
+} MPDE_INTERVAL;
+
 #define BIFURCATION_THRESHOLD 0.2
 #define false 0
 #define true 1
@@ -27,7 +27,34 @@ BEGIN_C_NAMESPACE
 #define MARKOV_CHAIN_ANALYSIS_TIME_LIMIT_KEY "markov.chain.time.limit"
 #define DEFAULT_MARKOV_CHAIN_ANALYSIS_TIME_LIMIT 0.01
 
+/* comma separated, increasing times at which the transient distribution is reported */
+#define MARKOV_CHAIN_ANALYSIS_TIME_POINTS_KEY "markov.chain.time.points"
+
+#define MARKOV_CHAIN_TRANSIENT_METHOD_KEY "markov.chain.transient.method"
+#define MARKOV_CHAIN_TRANSIENT_METHOD_UNIFORMIZATION "uniformization"
+#define MARKOV_CHAIN_TRANSIENT_METHOD_KRYLOV "krylov"
+#define MARKOV_CHAIN_TRANSIENT_METHOD_FIXED_STEP "fixed.step"
+#define DEFAULT_MARKOV_CHAIN_TRANSIENT_METHOD MARKOV_CHAIN_TRANSIENT_METHOD_UNIFORMIZATION
+
+#define MARKOV_CHAIN_TRANSIENT_ERROR_KEY "markov.chain.transient.error"
+
+/* 0 means the reachable state space is not bounded */
+#define MARKOV_CHAIN_MAX_STATES_KEY "markov.chain.max.states"
+#define DEFAULT_MARKOV_CHAIN_MAX_STATES 0
+
 #define DEFAULT_CTMC_ANALYSIS_OUTPUT_NAME "markov-transient-analysis.txt"
+#define DEFAULT_CTMC_STATIONARY_ANALYSIS_OUTPUT_NAME "markov-stationary-analysis.txt"
+
+#define MARKOV_CHAIN_STATIONARY_METHOD_KEY "markov.chain.stationary.method"
+#define MARKOV_CHAIN_STATIONARY_METHOD_POWER "power"
+#define MARKOV_CHAIN_STATIONARY_METHOD_GAUSS_SEIDEL "gauss.seidel"
+#define MARKOV_CHAIN_STATIONARY_METHOD_SOR "sor"
+#define MARKOV_CHAIN_STATIONARY_METHOD_BICGSTAB "bicgstab"
+#define DEFAULT_MARKOV_CHAIN_STATIONARY_METHOD MARKOV_CHAIN_STATIONARY_METHOD_GAUSS_SEIDEL
+
+#define MARKOV_CHAIN_STATIONARY_SOR_OMEGA_KEY "markov.chain.stationary.sor.omega"
+#define MARKOV_CHAIN_STATIONARY_TOLERANCE_KEY "markov.chain.stationary.tolerance"
+#define MARKOV_CHAIN_STATIONARY_MAX_ITERATIONS_KEY "markov.chain.stationary.max.iterations"
 
 #define MARKOV_ANALYSIS_RESULT_REPORTER_KEY "markov.analysis.result.reporter"
 
@@ -22,6 +22,18 @@
 #include "gsl/gsl_vector.h"
 #include "gsl/gsl_multiroots.h"
 #include "monte_carlo.h"
+#include "statistics_simulation_printer.h"
+#include "default_simulation_run_termination_decider.h"
+
+#if !defined(WIN32) && !defined(_WIN32)
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/select.h>
+#include <sys/wait.h>
+#define MONTE_CARLO_USE_WORKER_PROCESSES 1
+#endif
 
 
 static BOOL _IsModelConditionSatisfied( IR *ir );
@@ -29,6 +41,11 @@ static BOOL _IsModelConditionSatisfied( IR *ir );
 
 static RET_VAL _InitializeRecord( MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *backend, IR *ir );
 static RET_VAL _InitializeSimulation( MONTE_CARLO_RECORD *rec, int runNum );
+static RET_VAL _EvaluateInitialAssignment( MONTE_CARLO_RECORD *rec, UINT32 index );
+static RET_VAL _DoRun( MONTE_CARLO_RECORD *rec, UINT i );
+#if defined(MONTE_CARLO_USE_WORKER_PROCESSES)
+static RET_VAL _DoRunsInWorkers( MONTE_CARLO_RECORD *rec );
+#endif
 static RET_VAL _RunSimulation( MONTE_CARLO_RECORD *rec );
 
 static RET_VAL _CleanSimulation( MONTE_CARLO_RECORD *rec );
@@ -37,16 +54,49 @@ static RET_VAL _CleanRecord( MONTE_CARLO_RECORD *rec );
 static RET_VAL _CalculateTotalPropensities( MONTE_CARLO_RECORD *rec );
 static RET_VAL _CalculatePropensities( MONTE_CARLO_RECORD *rec );
 static RET_VAL _CalculatePropensity( MONTE_CARLO_RECORD *rec, REACTION *reaction );
+static double _EvaluatePropensity( MONTE_CARLO_RECORD *rec, REACTION *reaction );
+static double _EvaluateLaw( MONTE_CARLO_RECORD *rec, KINETIC_LAW *law );
+static double _EvaluateLawDeter( MONTE_CARLO_RECORD *rec, KINETIC_LAW *law );
+static double _GetStoichiometry( MONTE_CARLO_RECORD *rec, UINT32 reactionIndex, UINT32 entry );
+static RET_VAL _SetPropensity( MONTE_CARLO_RECORD *rec, REACTION *reaction, double propensity );
+static RET_VAL _ScheduleReaction( MONTE_CARLO_RECORD *rec, REACTION *reaction, double propensity );
+static double _GetNextUnitUniformRandomNumber( MONTE_CARLO_RECORD *rec );
 static RET_VAL _FindNextReactionTime( MONTE_CARLO_RECORD *rec );
 static RET_VAL _FindNextReaction( MONTE_CARLO_RECORD *rec );
+static RET_VAL _InitializeTauLeap( MONTE_CARLO_RECORD *rec, REB2SAC_PROPERTIES *properties );
+static RET_VAL _FreeTauLeap( MONTE_CARLO_RECORD *rec );
+static RET_VAL _TauLeap( MONTE_CARLO_RECORD *rec, double maxTime, BOOL *leaped );
+static double _ClassifyCriticalReactions( MONTE_CARLO_RECORD *rec );
+static double _SelectLeap( MONTE_CARLO_RECORD *rec );
+static double _GetHighestOrderFactor( double order, double stoichiometry, double amount );
+static void _SampleFirings( MONTE_CARLO_RECORD *rec, double tau, BOOL criticalFires, double criticalTotal );
+static BOOL _ComputeSpeciesChanges( MONTE_CARLO_RECORD *rec );
+static RET_VAL _SolveImplicitFirings( MONTE_CARLO_RECORD *rec, double tau );
+int MonteCarloImplicitTauLeap(const gsl_vector * y, void *params, gsl_vector * f);
 static RET_VAL _Update( MONTE_CARLO_RECORD *rec );
 static RET_VAL _Print( MONTE_CARLO_RECORD *rec );
 static RET_VAL _PrintStatistics( MONTE_CARLO_RECORD *rec, FILE *file);
 static RET_VAL _UpdateNodeValues( MONTE_CARLO_RECORD *rec );
 static RET_VAL _UpdateSpeciesValues( MONTE_CARLO_RECORD *rec );
-static RET_VAL _UpdateReactionRateUpdateTime( MONTE_CARLO_RECORD *rec );
-static RET_VAL _UpdateReactionRateUpdateTimeForSpecies( MONTE_CARLO_RECORD *rec, SPECIES* species );
-static RET_VAL _UpdateAllReactionRateUpdateTimes( MONTE_CARLO_RECORD *rec, double time );
+static void _MarkReactionsStale( MONTE_CARLO_RECORD *rec, UINT32 *reactions, UINT32 size );
+static void _MarkAllReactionsStale( MONTE_CARLO_RECORD *rec );
+static void _MarkReactionsAffectedByFiring( MONTE_CARLO_RECORD *rec );
+static void _SetSpeciesAmount( MONTE_CARLO_RECORD *rec, UINT32 index, double amount );
+static void _SetCompartmentSize( MONTE_CARLO_RECORD *rec, UINT32 index, double size );
+static void _SetSymbolValue( MONTE_CARLO_RECORD *rec, UINT32 index, double value );
+static RET_VAL _InitializeEventDependencies( MONTE_CARLO_RECORD *rec );
+static RET_VAL _InitializeAssignmentOrder( MONTE_CARLO_RECORD *rec );
+static RET_VAL _IndexReaders( MONTE_CARLO_RECORD *rec, KINETIC_LAW **laws, UINT32 lawsSize, 
+                              UINT32 **offsets, UINT32 **readers, BYTE *isVolatile );
+static RET_VAL _SortAssignments( MONTE_CARLO_RECORD *rec, UINT32 *targets, UINT32 size, UINT32 *offsets, UINT32 *readers, 
+                                 UINT32 *order, UINT32 *orderSize, char *kind );
+static char *_GetVariableName( MONTE_CARLO_RECORD *rec, UINT32 index );
+static BOOL _FindVariablesRead( MONTE_CARLO_RECORD *rec, KINETIC_LAW *law, BYTE *marks, UINT32 *reads, UINT32 *readsSize );
+static void _MarkReadersOfVariable( MONTE_CARLO_RECORD *rec, UINT32 index );
+static void _MarkAllEventsStale( MONTE_CARLO_RECORD *rec );
+static void _ScheduleEvent( MONTE_CARLO_RECORD *rec, UINT32 index, double time );
+static UINT32 _CollectEventsToCheck( MONTE_CARLO_RECORD *rec, double time );
+static int _CompareEventIndices( const void *a, const void *b );
 
 static int _ComparePropensity( REACTION *a, REACTION *b );
 static BOOL _IsTerminationConditionMet( MONTE_CARLO_RECORD *rec );
@@ -64,8 +114,7 @@ DLLSCOPE RET_VAL STDCALL DoMonteCarloAnalysis( BACK_END_PROCESSOR *backend, IR *
     UINT i = 0;
     UINT runs = 1;
     char *namePrefix = NULL;
-    static MONTE_CARLO_RECORD rec;
-    UINT timeout = 0;
+    MONTE_CARLO_RECORD *rec = NULL;
 
     START_FUNCTION("DoMonteCarloAnalysis");
 
@@ -73,39 +122,340 @@ DLLSCOPE RET_VAL STDCALL DoMonteCarloAnalysis( BACK_END_PROCESSOR *backend, IR *
         return ErrorReport( FAILING, "DoMonteCarloAnalysis", " method cannot be applied to the model" );
     }
 
-    if( IS_FAILED( ( ret = _InitializeRecord( &rec, backend, ir ) ) ) )  {
+    if( ( rec = (MONTE_CARLO_RECORD*)MALLOC( sizeof(MONTE_CARLO_RECORD) ) ) == NULL ) {
+        return ErrorReport( FAILING, "DoMonteCarloAnalysis", "could not allocate the record" );
+    }
+    if( IS_FAILED( ( ret = _InitializeRecord( rec, backend, ir ) ) ) )  {
+        _CleanRecord( rec );
+        FREE( rec );
+        backend->_internal1 = NULL;
         return ErrorReport( ret, "DoMonteCarloAnalysis", "initialization of the record failed" );
     }
 
-
-    runs = rec.runs;
+    runs = rec->runs;
+#if defined(MONTE_CARLO_USE_WORKER_PROCESSES)
+    if( ( rec->threads > 1 ) && ( runs > 1 ) ) {
+        ret = _DoRunsInWorkers( rec );
+        END_FUNCTION("DoMonteCarloAnalysis", ret );
+        return ret;
+    }
+#endif
     for( i = 1; i <= runs; i++ ) {
-        SeedRandomNumberGenerators( rec.seed );
-        rec.seed = GetNextUniformRandomNumber(0,RAND_MAX);
-        timeout = 0;
-	do {
-	  SeedRandomNumberGenerators( rec.seed );
-	  if( IS_FAILED( ( ret = _InitializeSimulation( &rec, i ) ) ) ) {
-            return ErrorReport( ret, "DoMonteCarloAnalysis", "initialization of the %i-th simulation failed", i );
-	  }
-	  timeout++;
-	} while ( (ret == CHANGE) && (timeout <= (rec.speciesSize + rec.compartmentsSize + rec.symbolsSize)) );
-	if (timeout > (rec.speciesSize + rec.compartmentsSize + rec.symbolsSize + 1)) {
-	  return ErrorReport( ret, "DoMonteCarloAnalysis", "Cycle detected in initial and rule assignments" );
-	}
-        if( IS_FAILED( ( ret = _RunSimulation( &rec ) ) ) ) {
-            return ErrorReport( ret, "DoMonteCarloAnalysis", "%i-th simulation failed at time %f", i, rec.time );
-        }
-        if( IS_FAILED( ( ret = _CleanSimulation( &rec ) ) ) ) {
-            return ErrorReport( ret, "DoMonteCarloAnalysis", "cleaning of the %i-th simulation failed", i );
+        if( IS_FAILED( ( ret = _DoRun( rec, i ) ) ) ) {
+            return ret;
         }
 	printf("Run = %d\n",i);
 	fflush(stdout);
+	if( IsRunsTargetMetInSimulationPrinter( rec->printer ) ) {
+	    break;
+	}
     }
     END_FUNCTION("DoMonteCarloAnalysis", SUCCESS );
     return ret;
 }
 
+/* 
+ * Runs the i-th simulation on the random number stream ( seed, run index ).  The stream 
+ * is repositioned before the run is initialized, so a run depends only on the seed and its 
+ * index, never on the runs simulated before it.  Cycles in the initial assignments are 
+ * rejected when the record is initialized, so one initialization pass suffices. 
+ */
+static RET_VAL _DoRun( MONTE_CARLO_RECORD *rec, UINT i ) {
+    RET_VAL ret = SUCCESS;
+
+    SeedRandomNumberContext( rec->randomNumberContext, rec->seed, (UINT32)(i + rec->startIndex - 1) );
+    rec->uniformsIndex = MONTE_CARLO_UNIFORMS_BLOCK_SIZE;
+    /* initial assignments are simplified with the default generator */
+    SeedRandomNumberGenerators( GetNextUniformRandomNumberInContext( rec->randomNumberContext, 0, RAND_MAX ) );
+    if( IS_FAILED( ( ret = _InitializeSimulation( rec, i ) ) ) ) {
+        return ErrorReport( ret, "DoMonteCarloAnalysis", "initialization of the %i-th simulation failed", i );
+    }
+    if( IS_FAILED( ( ret = _RunSimulation( rec ) ) ) ) {
+        return ErrorReport( ret, "DoMonteCarloAnalysis", "%i-th simulation failed at time %f", i, rec->time );
+    }
+    if( IS_FAILED( ( ret = _CleanSimulation( rec ) ) ) ) {
+        return ErrorReport( ret, "DoMonteCarloAnalysis", "cleaning of the %i-th simulation failed", i );
+    }
+    return ret;
+}
+
+#if defined(MONTE_CARLO_USE_WORKER_PROCESSES)
+
+typedef struct {
+    pid_t pid;
+    int toWorker;
+    int fromWorker;
+    UINT batch;
+} MONTE_CARLO_WORKER;
+
+typedef struct {
+    UINT batch;
+    RET_VAL ret;
+    UINT32 size;
+} MONTE_CARLO_WORKER_RESULT;
+
+static RET_VAL _WriteFully( int fd, void *buf, size_t size ) {
+    char *p = (char*)buf;
+    ssize_t n = 0;
+
+    while( size > 0 ) {
+        if( ( n = write( fd, p, size ) ) < 0 ) {
+            if( errno == EINTR ) {
+                continue;
+            }
+            return FAILING;
+        }
+        p += n;
+        size -= n;
+    }
+    return SUCCESS;
+}
+
+static RET_VAL _ReadFully( int fd, void *buf, size_t size ) {
+    char *p = (char*)buf;
+    ssize_t n = 0;
+
+    while( size > 0 ) {
+        if( ( n = read( fd, p, size ) ) < 0 ) {
+            if( errno == EINTR ) {
+                continue;
+            }
+            return FAILING;
+        }
+        if( n == 0 ) {
+            return FAILING;
+        }
+        p += n;
+        size -= n;
+    }
+    return SUCCESS;
+}
+
+/*
+ * Worker side: simulate every batch of runs received until 0 arrives, then send back what 
+ * the printer gathered over the batch.  Each worker owns a copy-on-write image of the IR, 
+ * evaluator, printer and generator, so runs never share state.
+ */
+static void _WorkerMain( MONTE_CARLO_RECORD *rec, UINT batchSize, int toWorker, int fromWorker ) {
+    UINT i = 0;
+    UINT first = 0;
+    UINT last = 0;
+    double *buffer = NULL;
+    MONTE_CARLO_WORKER_RESULT result;
+
+    while( !IS_FAILED( _ReadFully( toWorker, &(result.batch), sizeof(result.batch) ) ) ) {
+        if( result.batch == 0 ) {
+            break;
+        }
+        first = ( result.batch - 1 ) * batchSize + 1;
+        last = GET_MIN( result.batch * batchSize, rec->runs );
+        result.ret = StartRunsBatchInSimulationPrinter( rec->printer );
+        for( i = first; !IS_FAILED( result.ret ) && ( i <= last ); i++ ) {
+            result.ret = _DoRun( rec, i );
+        }
+        result.size = 0;
+        if( !IS_FAILED( result.ret ) ) {
+            result.ret = GetRunsBatchOfSimulationPrinter( rec->printer, &buffer, &(result.size) );
+        }
+        fflush( stdout );
+        if( IS_FAILED( _WriteFully( fromWorker, &result, sizeof(result) ) ) ||
+            IS_FAILED( _WriteFully( fromWorker, buffer, result.size * sizeof(double) ) ) || IS_FAILED( result.ret ) ) {
+            break;
+        }
+        if( buffer != NULL ) {
+            FREE( buffer );
+        }
+    }
+    close( toWorker );
+    close( fromWorker );
+    fflush( NULL );
+    _exit( 0 );
+}
+
+/*
+ * Runs rec->runs simulations on rec->threads worker processes.  The parent hands out batches 
+ * of consecutive runs on demand; since every run draws from its own ( seed, run ) stream, 
+ * run-i is identical to the one produced by the serial path regardless of scheduling.  The 
+ * batches are merged into the printer in run order and replayed run by run, so the ensemble 
+ * statistics and the run meeting the runs target match the serial path as well.  Once the 
+ * target is met, no more batches are handed out and those still running are discarded.
+ */
+static RET_VAL _DoRunsInWorkers( MONTE_CARLO_RECORD *rec ) {
+    RET_VAL ret = SUCCESS;
+    UINT i = 0;
+    UINT w = 0;
+    UINT runs = rec->runs;
+    UINT batchSize = 1;
+    UINT batches = 0;
+    UINT nextBatch = 1;
+    UINT mergedBatches = 0;
+    UINT32 mergedRuns = 0;
+    UINT completed = 0;
+    UINT active = 0;
+    UINT stop = 0;
+    UINT workersSize = GET_MIN( rec->threads, rec->runs );
+    int maxFd = -1;
+    int toWorker[2];
+    int fromWorker[2];
+    fd_set readSet;
+    double **buffers = NULL;
+    UINT32 *sizes = NULL;
+    BOOL *isReceived = NULL;
+    MONTE_CARLO_WORKER *workers = NULL;
+    MONTE_CARLO_WORKER *worker = NULL;
+    MONTE_CARLO_WORKER_RESULT result;
+    void (*oldPipeHandler)(int) = NULL;
+
+    batchSize = GetRunsBatchSizeOfSimulationPrinter( rec->printer );
+    batches = ( runs + batchSize - 1 ) / batchSize;
+    workersSize = GET_MIN( workersSize, batches );
+    if( ( ( workers = (MONTE_CARLO_WORKER*)CALLOC( workersSize, sizeof(MONTE_CARLO_WORKER) ) ) == NULL ) ||
+        ( ( buffers = (double**)CALLOC( batches, sizeof(double*) ) ) == NULL ) ||
+        ( ( sizes = (UINT32*)CALLOC( batches, sizeof(UINT32) ) ) == NULL ) ||
+        ( ( isReceived = (BOOL*)CALLOC( batches, sizeof(BOOL) ) ) == NULL ) ) {
+        FREE( workers );
+        FREE( buffers );
+        FREE( sizes );
+        return ErrorReport( FAILING, "_DoRunsInWorkers", "could not allocate memory for workers" );
+    }
+
+    /* a dead worker must surface as an error, not as SIGPIPE in the parent */
+    oldPipeHandler = signal( SIGPIPE, SIG_IGN );
+    fflush( NULL );
+    for( w = 0; w < workersSize; w++ ) {
+        worker = workers + w;
+        if( ( pipe( toWorker ) != 0 ) || ( pipe( fromWorker ) != 0 ) ) {
+            ret = ErrorReport( FAILING, "_DoRunsInWorkers", "could not create pipes for worker %i", w );
+            break;
+        }
+        if( ( worker->pid = fork() ) < 0 ) {
+            close( toWorker[0] );
+            close( toWorker[1] );
+            close( fromWorker[0] );
+            close( fromWorker[1] );
+            ret = ErrorReport( FAILING, "_DoRunsInWorkers", "could not create worker %i", w );
+            break;
+        }
+        if( worker->pid == 0 ) {
+            for( i = 0; i < w; i++ ) {
+                close( workers[i].toWorker );
+                close( workers[i].fromWorker );
+            }
+            close( toWorker[1] );
+            close( fromWorker[0] );
+            _WorkerMain( rec, batchSize, toWorker[0], fromWorker[1] );
+        }
+        close( toWorker[0] );
+        close( fromWorker[1] );
+        worker->toWorker = toWorker[1];
+        worker->fromWorker = fromWorker[0];
+        worker->batch = 0;
+        maxFd = GET_MAX( maxFd, worker->fromWorker );
+    }
+    workersSize = w;
+
+    for( w = 0; w < workersSize; w++ ) {
+        worker = workers + w;
+        if( IS_FAILED( ret ) || ( nextBatch > batches ) ) {
+            break;
+        }
+        if( IS_FAILED( _WriteFully( worker->toWorker, &nextBatch, sizeof(nextBatch) ) ) ) {
+            ret = ErrorReport( FAILING, "_DoRunsInWorkers", "could not send batch %i to worker %i", nextBatch, w );
+            break;
+        }
+        worker->batch = nextBatch;
+        nextBatch++;
+        active++;
+    }
+
+    while( active > 0 ) {
+        FD_ZERO( &readSet );
+        for( w = 0; w < workersSize; w++ ) {
+            if( workers[w].batch != 0 ) {
+                FD_SET( workers[w].fromWorker, &readSet );
+            }
+        }
+        if( select( maxFd + 1, &readSet, NULL, NULL, NULL ) < 0 ) {
+            if( errno == EINTR ) {
+                continue;
+            }
+            ret = ErrorReport( FAILING, "_DoRunsInWorkers", "could not wait for workers" );
+            break;
+        }
+        for( w = 0; w < workersSize; w++ ) {
+            worker = workers + w;
+            if( ( worker->batch == 0 ) || !FD_ISSET( worker->fromWorker, &readSet ) ) {
+                continue;
+            }
+            active--;
+            if( IS_FAILED( _ReadFully( worker->fromWorker, &result, sizeof(result) ) ) ||
+                ( ( result.size > 0 ) && ( ( buffers[worker->batch - 1] = (double*)CALLOC( result.size, sizeof(double) ) ) == NULL ) ) ||
+                IS_FAILED( _ReadFully( worker->fromWorker, buffers[worker->batch - 1], result.size * sizeof(double) ) ) ) {
+                ret = ErrorReport( FAILING, "DoMonteCarloAnalysis", "worker running batch %i of the simulations terminated abnormally", worker->batch );
+                worker->batch = 0;
+                continue;
+            }
+            sizes[worker->batch - 1] = result.size;
+            isReceived[worker->batch - 1] = !IS_FAILED( result.ret );
+            worker->batch = 0;
+            if( IS_FAILED( result.ret ) ) {
+                ret = result.ret;
+                continue;
+            }
+
+            /* merge in run order; the runs target is checked after each run */
+            while( !IS_FAILED( ret ) && ( mergedBatches < batches ) && isReceived[mergedBatches] && 
+                   !IsRunsTargetMetInSimulationPrinter( rec->printer ) ) {
+                mergedRuns = GET_MIN( ( mergedBatches + 1 ) * batchSize, runs ) - mergedBatches * batchSize;
+                if( IS_FAILED( ( ret = MergeRunsBatchIntoSimulationPrinter( rec->printer, buffers[mergedBatches], sizes[mergedBatches],
+                                                                            &mergedRuns ) ) ) ) {
+                    break;
+                }
+                for( i = 0; i < mergedRuns; i++ ) {
+                    completed++;
+                    printf("Run = %d\n",completed);
+                }
+                fflush(stdout);
+                FREE( buffers[mergedBatches] );
+                mergedBatches++;
+            }
+            if( IS_FAILED( ret ) || ( nextBatch > batches ) || IsRunsTargetMetInSimulationPrinter( rec->printer ) ) {
+                continue;
+            }
+            if( IS_FAILED( _WriteFully( worker->toWorker, &nextBatch, sizeof(nextBatch) ) ) ) {
+                ret = ErrorReport( FAILING, "_DoRunsInWorkers", "could not send batch %i to worker %i", nextBatch, w );
+                continue;
+            }
+            worker->batch = nextBatch;
+            nextBatch++;
+            active++;
+        }
+    }
+
+    for( w = 0; w < workersSize; w++ ) {
+        worker = workers + w;
+        _WriteFully( worker->toWorker, &stop, sizeof(stop) );
+        close( worker->toWorker );
+        close( worker->fromWorker );
+    }
+    for( w = 0; w < workersSize; w++ ) {
+        while( ( waitpid( workers[w].pid, NULL, 0 ) < 0 ) && ( errno == EINTR ) );
+    }
+    signal( SIGPIPE, oldPipeHandler );
+    for( i = 0; i < batches; i++ ) {
+        if( buffers[i] != NULL ) {
+            FREE( buffers[i] );
+        }
+    }
+    FREE( buffers );
+    FREE( sizes );
+    FREE( isReceived );
+    FREE( workers );
+    return ret;
+}
+
+#endif
+
 DLLSCOPE RET_VAL STDCALL CloseMonteCarloAnalyzer( BACK_END_PROCESSOR *backend ) {
     RET_VAL ret = SUCCESS;
     MONTE_CARLO_RECORD *rec = (MONTE_CARLO_RECORD *)(backend->_internal1);
@@ -115,6 +465,8 @@ DLLSCOPE RET_VAL STDCALL CloseMonteCarloAnalyzer( BACK_END_PROCESSOR *backend )
     if( IS_FAILED( ( ret = _CleanRecord( rec ) ) ) )  {
         return ErrorReport( ret, "CloseMonteCarloAnalyzer", "cleaning of the record failed" );
     }
+    FREE( rec );
+    backend->_internal1 = NULL;
 
     END_FUNCTION("CloseMonteCarloAnalyzer",  SUCCESS );
     return ret;
@@ -170,9 +522,7 @@ static RET_VAL _InitializeRecord( MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *b
     LINKED_LIST *list = NULL;
     REB2SAC_PROPERTIES *properties = NULL;
 
-#if GET_SEED_FROM_COMMAND_LINE
     PROPERTIES *options = NULL;
-#endif
 
     rec->encoding = backend->encoding;
     list = ir->GetListOfReactionNodes( ir );
@@ -186,6 +536,7 @@ static RET_VAL _InitializeRecord( MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *b
       ResetCurrentElement( list );
       while( ( reaction = (REACTION*)GetNextFromLinkedList( list ) ) != NULL ) {
         reactions[i] = reaction;
+        SetReactionIndex( reaction, i );
         i++;
 	if (IsReactionFastInReactionNode( reaction )) {
 	  rec->numberFastReactions++;
@@ -341,6 +692,60 @@ static RET_VAL _InitializeRecord( MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *b
         return ErrorReport( FAILING, "_InitializeRecord", "could not create find next time" );
     }
 
+    if( ( rec->propensityTree = CreateSumTree( rec->reactionsSize ) ) == NULL ) {
+        return ErrorReport( FAILING, "_InitializeRecord", "could not create propensity tree" );
+    }
+
+    if( ( rec->dependencyGraph = CreateNextReactionDependencyGraph( reactions, rec->reactionsSize, speciesArray, rec->speciesSize,
+                                                                    compartmentArray, rec->compartmentsSize, 
+                                                                    symbolArray, rec->symbolsSize, 
+                                                                    ruleArray, rec->rulesSize ) ) == NULL ) {
+        return ErrorReport( FAILING, "_InitializeRecord", "could not create reaction dependency graph" );
+    }
+    if( rec->reactionsSize > 0 ) {
+        if( ( rec->staleReactions = (UINT32*)MALLOC( rec->reactionsSize * sizeof(UINT32) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_InitializeRecord", "could not allocate memory for stale reactions" );
+        }
+        if( ( rec->isReactionStale = (BYTE*)MALLOC( rec->reactionsSize * sizeof(BYTE) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_InitializeRecord", "could not allocate memory for stale reactions" );
+        }
+    }
+    rec->staleReactionsSize = 0;
+
+    if( ( rec->state = CreateSimState( speciesArray, rec->speciesSize, compartmentArray, rec->compartmentsSize, 
+                                       symbolArray, rec->symbolsSize, reactions, rec->reactionsSize ) ) == NULL ) {
+        return ErrorReport( FAILING, "_InitializeRecord", "could not create simulation state" );
+    }
+    if( ( rec->compiler = CreateKineticLawCompiler( rec->state ) ) == NULL ) {
+        return ErrorReport( FAILING, "_InitializeRecord", "could not create kinetic law compiler" );
+    }
+    if( rec->reactionsSize > 0 ) {
+        if( ( rec->propensityPrograms = (KINETIC_LAW_PROGRAM**)MALLOC( rec->reactionsSize * sizeof(KINETIC_LAW_PROGRAM*) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_InitializeRecord", "could not allocate memory for propensity programs" );
+        }
+        for( i = 0; i < rec->reactionsSize; i++ ) {
+            rec->propensityPrograms[i] = CompileKineticLaw( rec->compiler, GetKineticLawInReactionNode( reactions[i] ), TRUE );
+        }
+    }
+
+    if( strcmp( rec->encoding, "tau-leap" ) == 0 ) {
+        if( IS_FAILED( ( ret = _InitializeTauLeap( rec, properties ) ) ) ) {
+            return ErrorReport( ret, "_InitializeRecord", "could not initialize tau-leaping" );
+        }
+    }
+    if( strcmp( rec->encoding, "nrm" ) == 0 ) {
+        if( ( rec->nextReactionQueue = CreateNextReactionQueue( rec->reactionsSize ) ) == NULL ) {
+            return ErrorReport( FAILING, "_InitializeRecord", "could not create next reaction queue" );
+        }
+    }
+
+    if( ( rec->randomNumberContext = CreateRandomNumberContext() ) == NULL ) {
+        return ErrorReport( FAILING, "_InitializeRecord", "could not create random number context" );
+    }
+    rec->evaluator->randomNumberContext = rec->randomNumberContext;
+    rec->findNextTime->randomNumberContext = rec->randomNumberContext;
+    rec->uniformsIndex = MONTE_CARLO_UNIFORMS_BLOCK_SIZE;
+
     if( ( valueString = properties->GetProperty( properties, MONTE_CARLO_SIMULATION_START_INDEX ) ) == NULL ) {
         rec->startIndex = DEFAULT_MONTE_CARLO_SIMULATION_START_INDEX;
     }
@@ -443,6 +848,27 @@ static RET_VAL _InitializeRecord( MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *b
         }
     }
 
+    options = compRec->options;
+    if( ( valueString = options->GetProperty( options, MONTE_CARLO_SIMULATION_THREADS_OPTION ) ) == NULL ) {
+        valueString = properties->GetProperty( properties, MONTE_CARLO_SIMULATION_THREADS );
+    }
+    if( valueString == NULL ) {
+        rec->threads = DEFAULT_MONTE_CARLO_SIMULATION_THREADS_VALUE;
+    }
+    else {
+        if( IS_FAILED( ( ret = StrToUINT32( &(rec->threads), valueString ) ) ) || ( rec->threads == 0 ) ) {
+            rec->threads = DEFAULT_MONTE_CARLO_SIMULATION_THREADS_VALUE;
+        }
+    }
+    /* termination deciders keep their counts across runs in the process that ran them */
+    if( ( properties->GetProperty( properties, SIMULATION_RUN_TERMINATION_DECIDER_KEY ) != NULL ) ||
+        ( properties->GetProperty( properties, SIMULATION_RUN_TERMINATION_CONDITION_KEY_PREFIX "1" ) != NULL ) ) {
+        if( rec->threads > 1 ) {
+            TRACE_0("termination decider counts are not merged across workers, running serially" );
+        }
+        rec->threads = 1;
+    }
+
     if( ( rec->outDir = properties->GetProperty( properties, MONTE_CARLO_SIMULATION_OUT_DIR ) ) == NULL ) {
         rec->outDir = DEFAULT_MONTE_CARLO_SIMULATION_OUT_DIR_VALUE;
     }
@@ -452,6 +878,9 @@ static RET_VAL _InitializeRecord( MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *b
 						  symbolArray, rec->symbolsSize ) ) == NULL ) {
       return ErrorReport( FAILING, "_InitializeRecord", "could not create simulation printer" );
     }
+    if( ( rec->printer = CreateStatisticsSimulationPrinter( backend, rec->printer, rec->outDir, rec->runs ) ) == NULL ) {
+      return ErrorReport( FAILING, "_InitializeRecord", "could not create simulation statistics printer" );
+    }
 
     if( ( constraintManager = ir->GetConstraintManager( ir ) ) == NULL ) {
         return ErrorReport( FAILING, "_InitializeRecord", "could not get the constraint manager" );
@@ -525,6 +954,12 @@ static RET_VAL _InitializeRecord( MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *b
 	}
       }
     }
+    if( IS_FAILED( ( ret = _InitializeAssignmentOrder( rec ) ) ) ) {
+        return ErrorReport( ret, "_InitializeRecord", "could not order the assignments" );
+    }
+    if( IS_FAILED( ( ret = _InitializeEventDependencies( rec ) ) ) ) {
+        return ErrorReport( ret, "_InitializeRecord", "could not initialize event dependencies" );
+    }
 
     backend->_internal1 = (CADDR_T)rec;
     
@@ -534,7 +969,6 @@ static RET_VAL _InitializeRecord( MONTE_CARLO_RECORD *rec, BACK_END_PROCESSOR *b
 static RET_VAL _InitializeSimulation( MONTE_CARLO_RECORD *rec, int runNum ) {
     RET_VAL ret = SUCCESS;
     char filenameStem[512];
-    double amount = 0;
     double param = 0;
     UINT32 i = 0;
     UINT32 size = 0;
@@ -544,13 +978,10 @@ static RET_VAL _InitializeSimulation( MONTE_CARLO_RECORD *rec, int runNum ) {
     REACTION **reactionArray = rec->reactionArray;
     KINETIC_LAW_EVALUATER *evaluator = rec->evaluator;
     SIMULATION_PRINTER *printer = rec->printer;
-    double compSize = 0.0;
     COMPARTMENT *compartment = NULL;
     COMPARTMENT **compartmentArray = rec->compartmentArray;
     REB2SAC_SYMBOL *symbol = NULL;
     REB2SAC_SYMBOL **symbolArray = rec->symbolArray;
-    KINETIC_LAW *law = NULL;
-    BOOL change = FALSE;
     char filename[512];
     FILE *file = NULL;
 
@@ -564,96 +995,44 @@ static RET_VAL _InitializeSimulation( MONTE_CARLO_RECORD *rec, int runNum ) {
     rec->time = rec->initialTime;
     rec->nextPrintTime = rec->outputStartTime;
     rec->currentStep = 0;
+    /* each initial assignment is evaluated after the ones it reads */
+    for( i = 0; i < rec->initialAssignmentsSize; i++ ) {
+        if( IS_FAILED( ( ret = _EvaluateInitialAssignment( rec, rec->initialAssignmentOrder[i] ) ) ) ) {
+            return ret;
+        }
+    }
     size = rec->compartmentsSize;
     for( i = 0; i < size; i++ ) {
         compartment = compartmentArray[i];
-	if ( (law = (KINETIC_LAW*)GetInitialAssignmentInCompartment( compartment )) == NULL ) {
-	  compSize = GetSizeInCompartment( compartment );
-	} else {
-	  law = CloneKineticLaw( law );
-	  SimplifyInitialAssignment(law);
-	  if (law->valueType == KINETIC_LAW_VALUE_TYPE_REAL) {
-	    compSize = GetRealValueFromKineticLaw(law);
-	  } else if (law->valueType == KINETIC_LAW_VALUE_TYPE_INT) {
-	    compSize = (double)GetIntValueFromKineticLaw(law);
-	  }
-	  if (GetSizeInCompartment( compartment ) != compSize) {
-	    SetSizeInCompartment( compartment, compSize );
-	    change = TRUE;
-	  }
-	  FreeKineticLaw( &(law) );
-	}
-        if( IS_FAILED( ( ret = SetCurrentSizeInCompartment( compartment, compSize ) ) ) ) {
+        if( IS_FAILED( ( ret = SetCurrentSizeInCompartment( compartment, GetSizeInCompartment( compartment ) ) ) ) ) {
             return ret;
         }
     }
     size = rec->speciesSize;
     for( i = 0; i < size; i++ ) {
         species = speciesArray[i];
-	if ( (law = (KINETIC_LAW*)GetInitialAssignmentInSpeciesNode( species )) == NULL ) {
-	  if( IsInitialQuantityInAmountInSpeciesNode( species ) ) {
-	    amount = GetInitialAmountInSpeciesNode( species );
-	  }
-	  else {
-	    amount = GetInitialAmountInSpeciesNode( species );
-	  }
-	} else {
-	  law = CloneKineticLaw( law );
-	  SimplifyInitialAssignment(law);
-	  if (law->valueType == KINETIC_LAW_VALUE_TYPE_REAL) {
-	    amount = GetRealValueFromKineticLaw(law);
-	  } else if (law->valueType == KINETIC_LAW_VALUE_TYPE_INT) {
-	    amount = (double)GetIntValueFromKineticLaw(law);
-	  }
-	  if( IsInitialQuantityInAmountInSpeciesNode( species ) ) {
-	    if (GetInitialAmountInSpeciesNode( species ) != amount) {
-	      SetInitialAmountInSpeciesNode( species, amount );
-	      change = TRUE;
-	    }
-	  }
-	  else {
-	    if (GetInitialAmountInSpeciesNode( species ) != amount) {
-	      SetInitialAmountInSpeciesNode( species, amount );
-	      change = TRUE;
-	    }
-	  }
-	  FreeKineticLaw( &(law) );
-	}
-        if( IS_FAILED( ( ret = SetAmountInSpeciesNode( species, amount ) ) ) ) {
+        if( IS_FAILED( ( ret = SetAmountInSpeciesNode( species, GetInitialAmountInSpeciesNode( species ) ) ) ) ) {
             return ret;
         }
     }
     size = rec->symbolsSize;
     for( i = 0; i < size; i++ ) {
         symbol = symbolArray[i];
-	if ( (law = (KINETIC_LAW*)GetInitialAssignmentInSymbol( symbol )) == NULL ) {
-	  param = GetRealValueInSymbol( symbol );
-	  if ((strcmp(GetCharArrayOfString( GetSymbolID(symbol) ),"time")==0) ||
-	      (strcmp(GetCharArrayOfString( GetSymbolID(symbol) ),"t")==0)) {
-	    param = rec->time;
-	  }
-	} else {
-	  law = CloneKineticLaw( law );
-	  SimplifyInitialAssignment(law);
-	  if (law->valueType == KINETIC_LAW_VALUE_TYPE_REAL) {
-	    param = GetRealValueFromKineticLaw(law);
-	  } else if (law->valueType == KINETIC_LAW_VALUE_TYPE_INT) {
-	    param = (double)GetIntValueFromKineticLaw(law);
-	  }
-	  if( GetRealValueInSymbol( symbol ) != param ) {
-	    SetRealValueInSymbol( symbol, param );
-	    change = TRUE;
-	  }
-	  FreeKineticLaw( &(law) );
+	param = GetRealValueInSymbol( symbol );
+	if ( (GetInitialAssignmentInSymbol( symbol ) == NULL) &&
+	     ((strcmp(GetCharArrayOfString( GetSymbolID(symbol) ),"time")==0) ||
+	      (strcmp(GetCharArrayOfString( GetSymbolID(symbol) ),"t")==0)) ) {
+	  param = rec->time;
 	}
 	if( IS_FAILED( ( ret = SetCurrentRealValueInSymbol( symbol, param ) ) ) ) {
 	  return ret;
 	}
     }
+    LoadSimStateFromIR( rec->state );
     for (i = 0; i < rec->eventsSize; i++) {
       /* SetTriggerEnabledInEvent( rec->eventArray[i], FALSE ); */
       /* Use the line below to support true SBML semantics, i.e., nothing can be trigger at t=0 */
-      if (rec->evaluator->EvaluateWithCurrentAmountsDeter( rec->evaluator,
+      if (_EvaluateLawDeter( rec,
 						      (KINETIC_LAW*)GetTriggerInEvent( rec->eventArray[i] ) )) {
 	if (GetTriggerInitialValue( rec->eventArray[i] )) {
 	  SetTriggerEnabledInEvent( rec->eventArray[i], TRUE );
@@ -671,8 +1050,24 @@ static RET_VAL _InitializeSimulation( MONTE_CARLO_RECORD *rec, int runNum ) {
 	return ret;
       }
     }
-    if( IS_FAILED( ( ret = _UpdateAllReactionRateUpdateTimes( rec, 0 ) ) ) ) {
-      return ret;
+    ResetSumTree( rec->propensityTree );
+    if( rec->nextReactionQueue != NULL ) {
+        ResetNextReactionQueue( rec->nextReactionQueue );
+    }
+    rec->firedReaction = NULL;
+    if( rec->tauLeap != NULL ) {
+        rec->tauLeap->ssaStepsLeft = 0;
+    }
+    _MarkAllReactionsStale( rec );
+    if( rec->rulesSize > 0 ) {
+        memset( rec->isRuleStale, TRUE, rec->rulesSize * sizeof(BYTE) );
+    }
+    if( rec->eventQueue != NULL ) {
+        ResetNextReactionQueue( rec->eventQueue );
+        for( i = 0; i < rec->eventsSize; i++ ) {
+            _ScheduleEvent( rec, i, GetNextEventTimeInEvent( rec->eventArray[i] ) );
+        }
+        _MarkAllEventsStale( rec );
     }
     if (rec->algebraicRulesSize > 0) {
       EvaluateAlgebraicRules( rec );
@@ -690,8 +1085,57 @@ static RET_VAL _InitializeSimulation( MONTE_CARLO_RECORD *rec, int runNum ) {
     }
     fclose( file );
     */
-    if (change)
-      return CHANGE;
+    return ret;
+}
+
+/* 
+ * Evaluates the initial assignment of the variable at index in the state and stores the 
+ * value as its initial value, which the initial assignments evaluated after it read. 
+ */
+static RET_VAL _EvaluateInitialAssignment( MONTE_CARLO_RECORD *rec, UINT32 index ) {
+    RET_VAL ret = SUCCESS;
+    double value = 0.0;
+    KINETIC_LAW *law = NULL;
+    SPECIES *species = NULL;
+    COMPARTMENT *compartment = NULL;
+    REB2SAC_SYMBOL *symbol = NULL;
+
+    if( index < rec->speciesSize ) {
+        species = rec->speciesArray[index];
+        law = (KINETIC_LAW*)GetInitialAssignmentInSpeciesNode( species );
+        value = GetInitialAmountInSpeciesNode( species );
+    }
+    else if( index < rec->speciesSize + rec->compartmentsSize ) {
+        compartment = rec->compartmentArray[index - rec->speciesSize];
+        law = (KINETIC_LAW*)GetInitialAssignmentInCompartment( compartment );
+        value = GetSizeInCompartment( compartment );
+    }
+    else {
+        symbol = rec->symbolArray[index - rec->speciesSize - rec->compartmentsSize];
+        law = (KINETIC_LAW*)GetInitialAssignmentInSymbol( symbol );
+        value = GetRealValueInSymbol( symbol );
+    }
+    if( ( law = CloneKineticLaw( law ) ) == NULL ) {
+        return ErrorReport( FAILING, "_EvaluateInitialAssignment", "could not clone the initial assignment of %s", 
+                            _GetVariableName( rec, index ) );
+    }
+    SimplifyInitialAssignment( law );
+    if (law->valueType == KINETIC_LAW_VALUE_TYPE_REAL) {
+      value = GetRealValueFromKineticLaw(law);
+    } else if (law->valueType == KINETIC_LAW_VALUE_TYPE_INT) {
+      value = (double)GetIntValueFromKineticLaw(law);
+    }
+    FreeKineticLaw( &(law) );
+
+    if( species != NULL ) {
+        ret = SetInitialAmountInSpeciesNode( species, value );
+    }
+    else if( compartment != NULL ) {
+        ret = SetSizeInCompartment( compartment, value );
+    }
+    else {
+        ret = SetRealValueInSymbol( symbol, value );
+    }
     return ret;
 }
 
@@ -708,6 +1152,7 @@ static RET_VAL _RunSimulation( MONTE_CARLO_RECORD *rec ) {
     SIMULATION_RUN_TERMINATION_DECIDER *decider = NULL;
     int nextEvent = 0;
     double nextEventTime = 0;
+    BOOL leaped = FALSE;
 
     printer = rec->printer;
     decider = rec->decider;
@@ -754,6 +1199,17 @@ static RET_VAL _RunSimulation( MONTE_CARLO_RECORD *rec ) {
 	  }
 	}
 	else {
+	  leaped = FALSE;
+	  if( rec->tauLeap != NULL ) {
+	    if( IS_FAILED( ( ret = _TauLeap( rec, maxTime, &leaped ) ) ) ) {
+	      return ret;
+	    }
+	  }
+	  if( leaped ) {
+	    reaction = NULL;
+	    maxTime = rec->time;
+	    continue;
+	  }
 	  if( IS_FAILED( ( ret = _FindNextReactionTime( rec ) ) ) ) {
 	    return ret;
 	  }
@@ -827,14 +1283,17 @@ static RET_VAL _CleanRecord( MONTE_CARLO_RECORD *rec ) {
     SIMULATION_PRINTER *printer = rec->printer;
     SIMULATION_RUN_TERMINATION_DECIDER *decider = rec->decider;
 
-    sprintf( filename, "%s%csim-rep.txt", rec->outDir, FILE_SEPARATOR );
-    if( ( file = fopen( filename, "w" ) ) == NULL ) {
-        return ErrorReport( FAILING, "_CleanRecord", "could not create a report file" );
-    }
-    if( IS_FAILED( ( ret = decider->Report( decider, file ) ) ) ) {
-        return ret;
+    /* a record whose initialization failed is cleaned too, so parts of it may be missing */
+    if( decider != NULL ) {
+        sprintf( filename, "%s%csim-rep.txt", rec->outDir, FILE_SEPARATOR );
+        if( ( file = fopen( filename, "w" ) ) == NULL ) {
+            return ErrorReport( FAILING, "_CleanRecord", "could not create a report file" );
+        }
+        if( IS_FAILED( ( ret = decider->Report( decider, file ) ) ) ) {
+            return ret;
+        }
+        fclose( file );
     }
-    fclose( file );
 
     if( rec->evaluator != NULL ) {
         FreeKineticLawEvaluater( &(rec->evaluator) );
@@ -842,6 +1301,79 @@ static RET_VAL _CleanRecord( MONTE_CARLO_RECORD *rec ) {
     if( rec->findNextTime != NULL ) {
         FreeKineticLawFind_Next_Time( &(rec->findNextTime) );
     }
+    if( rec->randomNumberContext != NULL ) {
+        FreeRandomNumberContext( &(rec->randomNumberContext) );
+    }
+    if( rec->propensityTree != NULL ) {
+        FreeSumTree( &(rec->propensityTree) );
+    }
+    if( rec->dependencyGraph != NULL ) {
+        FreeNextReactionDependencyGraph( &(rec->dependencyGraph) );
+    }
+    if( rec->compiler != NULL ) {
+        FreeKineticLawCompiler( &(rec->compiler) );
+    }
+    if( rec->state != NULL ) {
+        FreeSimState( &(rec->state) );
+    }
+    if( rec->propensityPrograms != NULL ) {
+        FREE( rec->propensityPrograms );
+    }
+    if( rec->nextReactionQueue != NULL ) {
+        FreeNextReactionQueue( &(rec->nextReactionQueue) );
+    }
+    if( rec->eventQueue != NULL ) {
+        FreeNextReactionQueue( &(rec->eventQueue) );
+    }
+    if( rec->initialAssignmentOrder != NULL ) {
+        FREE( rec->initialAssignmentOrder );
+    }
+    if( rec->assignmentRuleOrder != NULL ) {
+        FREE( rec->assignmentRuleOrder );
+    }
+    if( rec->ruleReaderOffsets != NULL ) {
+        FREE( rec->ruleReaderOffsets );
+    }
+    if( rec->ruleReaders != NULL ) {
+        FREE( rec->ruleReaders );
+    }
+    if( rec->isRuleVolatile != NULL ) {
+        FREE( rec->isRuleVolatile );
+    }
+    if( rec->isRuleStale != NULL ) {
+        FREE( rec->isRuleStale );
+    }
+    if( rec->eventReaderOffsets != NULL ) {
+        FREE( rec->eventReaderOffsets );
+    }
+    if( rec->eventReaders != NULL ) {
+        FREE( rec->eventReaders );
+    }
+    if( rec->isEventVolatile != NULL ) {
+        FREE( rec->isEventVolatile );
+    }
+    if( rec->volatileEvents != NULL ) {
+        FREE( rec->volatileEvents );
+    }
+    if( rec->staleEvents != NULL ) {
+        FREE( rec->staleEvents );
+    }
+    if( rec->isEventStale != NULL ) {
+        FREE( rec->isEventStale );
+    }
+    if( rec->eventsToCheck != NULL ) {
+        FREE( rec->eventsToCheck );
+    }
+    if( rec->isEventToCheck != NULL ) {
+        FREE( rec->isEventToCheck );
+    }
+    _FreeTauLeap( rec );
+    if( rec->staleReactions != NULL ) {
+        FREE( rec->staleReactions );
+    }
+    if( rec->isReactionStale != NULL ) {
+        FREE( rec->isReactionStale );
+    }
     if( rec->reactionArray != NULL ) {
         FREE( rec->reactionArray );
     }
@@ -849,8 +1381,12 @@ static RET_VAL _CleanRecord( MONTE_CARLO_RECORD *rec ) {
         FREE( rec->speciesArray );
     }
 
-    printer->Destroy( printer );
-    decider->Destroy( decider );
+    if( printer != NULL ) {
+        printer->Destroy( printer );
+    }
+    if( decider != NULL ) {
+        decider->Destroy( decider );
+    }
 
     return ret;
 }
@@ -894,6 +1430,7 @@ static RET_VAL _PrintStatistics(MONTE_CARLO_RECORD *rec, FILE *file) {
 		fprintf( file, "%s = %f" NEW_LINE, *GetSpeciesNodeID(species), GetInitialAmountInSpeciesNode(species));
 	}
 	fprintf( file, NEW_LINE);
+	LoadSimStateFromIR( rec->state );
 
 	gsl_matrix *delta_matrix = gsl_matrix_alloc(speciesSize, reactionsSize);
 	gsl_matrix *reactant_matrix = gsl_matrix_alloc(speciesSize, reactionsSize);
@@ -905,9 +1442,7 @@ static RET_VAL _PrintStatistics(MONTE_CARLO_RECORD *rec, FILE *file) {
 		}
 	}
 
-	if (IS_FAILED((ret = _UpdateAllReactionRateUpdateTimes(rec, rec->time)))) {
-		return ret;
-	}
+	_MarkAllReactionsStale(rec);
 	if (IS_FAILED((ret = _CalculatePropensities(rec)))) {
 		return ret;
 	}
@@ -998,51 +1533,46 @@ static BOOL _IsTerminationConditionMet( MONTE_CARLO_RECORD *rec ) {
 
 
 
+/* 
+ * The propensity tree is kept current by _SetPropensity, so its root is the total. 
+ */
 static RET_VAL _CalculateTotalPropensities( MONTE_CARLO_RECORD *rec ) {
     RET_VAL ret = SUCCESS;
-    UINT32 i = 0;
-    UINT32 size = rec->reactionsSize;
     double total = 0.0;
-    REACTION **reactionArray = rec->reactionArray;
 
-    if (size > 0) {
-      total = GetReactionRate( reactionArray[0] );
-      for( i = 1; i < size; i++ ) {
-        total += GetReactionRate( reactionArray[i] );
-      }
-    }
+    total = GetTotalInSumTree( rec->propensityTree );
     rec->totalPropensities = total;
     TRACE_1( "the total propensity is %f", total );
     return ret;
 }
 
+/* 
+ * Only the reactions marked stale since the last call are recomputed. 
+ */
 static RET_VAL _CalculatePropensities( MONTE_CARLO_RECORD *rec ) {
     RET_VAL ret = SUCCESS;
-    int i = 0;
-    int size = 0;
-    double time = rec->time;
-    double updatedTime = 0.0;
-    REACTION *reaction = NULL;
+    UINT32 i = 0;
+    UINT32 index = 0;
     REACTION **reactionArray = rec->reactionArray;
 
-    size = rec->reactionsSize;
-    for( i = 0; i < size; i++ ) {
-        reaction = reactionArray[i];
-        updatedTime = GetReactionRateUpdatedTime( reaction );
-        if( IS_REAL_EQUAL( updatedTime, time ) ) {
-            if( IS_FAILED( ( ret = _CalculatePropensity( rec, reaction ) ) ) ) {
-                return ret;
-            }
-	}
+    for( i = 0; i < rec->staleReactionsSize; i++ ) {
+        index = rec->staleReactions[i];
+        rec->isReactionStale[index] = FALSE;
+        if( IS_FAILED( ( ret = _CalculatePropensity( rec, reactionArray[index] ) ) ) ) {
+            rec->staleReactionsSize = 0;
+            _MarkAllReactionsStale( rec );
+            return ret;
+        }
     }
+    rec->staleReactionsSize = 0;
 #if 0
     /* qsort is not good way to sort an array which is nearly sorted. */
-    qsort( rec->reactionArray, size, sizeof(REACTION*), (int(*)(const void *, const void *))_ComparePropensity );
+    qsort( rec->reactionArray, rec->reactionsSize, sizeof(REACTION*), (int(*)(const void *, const void *))_ComparePropensity );
 #endif
 
 #ifdef DEBUG
-    for( i = 0; i < size; i++ ) {
-        printf( "(%s, %f), ", GetCharArrayOfString( GetReactionNodeName( rec->reactionArray[i] ) ), GetReactionRate( rec->reactionArray[i] ) );
+    for( i = 0; i < rec->reactionsSize; i++ ) {
+        printf( "(%s, %f), ", GetCharArrayOfString( GetReactionNodeName( rec->reactionArray[i] ) ), rec->state->propensities[i] );
     }
     printf( NEW_LINE );
 #endif
@@ -1050,111 +1580,174 @@ static RET_VAL _CalculatePropensities( MONTE_CARLO_RECORD *rec ) {
 }
 
 
+static RET_VAL _SetPropensity( MONTE_CARLO_RECORD *rec, REACTION *reaction, double propensity ) {
+    RET_VAL ret = SUCCESS;
+
+    if( IS_FAILED( ( ret = SetReactionRate( reaction, propensity ) ) ) ) {
+        return ret;
+    }
+    rec->state->propensities[GetReactionIndex( reaction )] = propensity;
+    if( IS_FAILED( ( ret = UpdateValueInSumTree( rec->propensityTree, GetReactionIndex( reaction ), propensity ) ) ) ) {
+        return ret;
+    }
+    if( rec->nextReactionQueue != NULL ) {
+        return _ScheduleReaction( rec, reaction, propensity );
+    }
+    return ret;
+}
+
+/*
+ * Gibson and Bruck's update of a putative firing time.  The reaction that has just fired, 
+ * and a reaction whose propensity becomes positive, draw a fresh exponential waiting time.  
+ * Any other reaction keeps its random number by rescaling its remaining waiting time by the 
+ * ratio of the old to the new propensity.
+ */
+static RET_VAL _ScheduleReaction( MONTE_CARLO_RECORD *rec, REACTION *reaction, double propensity ) {
+    UINT32 index = GetReactionIndex( reaction );
+    double oldPropensity = 0.0;
+    double firingTime = DBL_MAX;
+    BOOL fired = FALSE;
+    NEXT_REACTION_QUEUE *queue = rec->nextReactionQueue;
+
+    if( reaction == rec->firedReaction ) {
+        fired = TRUE;
+        rec->firedReaction = NULL;
+    }
+    oldPropensity = GetPropensityInNextReactionQueue( queue, index );
+    if( propensity <= 0.0 ) {
+        firingTime = DBL_MAX;
+    }
+    else if( fired || ( oldPropensity <= 0.0 ) ) {
+        firingTime = rec->time + log( 1.0 / _GetNextUnitUniformRandomNumber( rec ) ) / propensity;
+    }
+    else if( oldPropensity == propensity ) {
+        return SUCCESS;
+    }
+    else {
+        firingTime = rec->time + ( oldPropensity / propensity ) * ( GetFiringTimeInNextReactionQueue( queue, index ) - rec->time );
+    }
+    return SetFiringTimeInNextReactionQueue( queue, index, propensity, firingTime );
+}
+
 static RET_VAL _CalculatePropensity( MONTE_CARLO_RECORD *rec, REACTION *reaction ) {
     RET_VAL ret = SUCCESS;
-    double stoichiometry = 0.0;
-    double amount = 0.0;
+
+    if( IS_FAILED( ( ret = _SetPropensity( rec, reaction, _EvaluatePropensity( rec, reaction ) ) ) ) ) {
+        return ret;
+    }
+#ifdef DEBUG
+    printf( "(%s, %f)" NEW_LINE, GetCharArrayOfString( GetReactionNodeName( reaction ) ),
+        GetReactionRate( reaction ) );
+#endif
+    return ret;
+}
+
+/* 
+ * Returns the propensity of the reaction in the current state without recording it. 
+ * Reactions lacking the reactants to fire, and laws that evaluate to a negative number 
+ * or nan, have propensity 0. 
+ */
+static double _EvaluatePropensity( MONTE_CARLO_RECORD *rec, REACTION *reaction ) {
     double propensity = 0.0;
-    double time = rec->time;
-    SPECIES *species = NULL;
-    IR_EDGE *edge = NULL;
-    LINKED_LIST *edges = NULL;
+    UINT32 index = GetReactionIndex( reaction );
     KINETIC_LAW *law = NULL;
+    KINETIC_LAW_PROGRAM *program = rec->propensityPrograms[index];
     KINETIC_LAW_EVALUATER *evaluator = rec->evaluator;
-    REB2SAC_SYMBOL *speciesRef = NULL;
-    REB2SAC_SYMBOL *convFactor = NULL;
-
-    edges = GetReactantEdges( (IR_NODE*)reaction );
-    ResetCurrentElement( edges );
-    while( ( edge = GetNextEdge( edges ) ) != NULL ) {
-      speciesRef = GetSpeciesRefInIREdge( edge );
-      if (speciesRef) {
-	stoichiometry = GetCurrentRealValueInSymbol( speciesRef );
-      } else {
-	stoichiometry = GetStoichiometryInIREdge( edge );
-      }
-      species = GetSpeciesInIREdge( edge );
-      if (( convFactor = GetConversionFactorInSpeciesNode( species ) )!=NULL) {
-	stoichiometry *= GetCurrentRealValueInSymbol( convFactor );
-      }
-      amount = GetAmountInSpeciesNode( species );
-      if( amount < stoichiometry ) {
-	if( IS_FAILED( ( ret = SetReactionRate( reaction, 0.0 ) ) ) ) {
-	  return ret;
-	}
-#ifdef DEBUG
-	printf( "(%s, %f)" NEW_LINE, GetCharArrayOfString( GetReactionNodeName( reaction ) ),
-                GetReactionRate( reaction ) );
-#endif
-	return SUCCESS;
-        }
-    }
-#if 0
-    edges = GetModifierEdges( (IR_NODE*)reaction );
-    ResetCurrentElement( edges );
-    while( ( edge = GetNextEdge( edges ) ) != NULL ) {
-      speciesRef = GetSpeciesRefInIREdge( edge );
-      if (speciesRef) {
-	stoichiometry = GetCurrentRealValueInSymbol( speciesRef );
-      } else {
-	stoichiometry = GetStoichiometryInIREdge( edge );
-      }
-      species = GetSpeciesInIREdge( edge );
-      if (( convFactor = GetConversionFactorInSpeciesNode( species ) )!=NULL) {
-	stoichiometry *= GetCurrentRealValueInSymbol( convFactor );
-      }
-      amount = GetAmountInSpeciesNode( species );
-      if( amount < stoichiometry ) {
-	if( IS_FAILED( ( ret = SetReactionRate( reaction, 0.0 ) ) ) ) {
-	  return ret;
-	}
-#ifdef DEBUG
-	printf( "(%s, %f)" NEW_LINE, GetCharArrayOfString( GetReactionNodeName( reaction ) ),
-                GetReactionRate( reaction ) );
-#endif
-	return SUCCESS;
-      }
+
+    if( !HasEnoughReactantsInSimState( rec->state, index ) ) {
+        return 0.0;
     }
-#endif
 
-    evaluator = rec->evaluator;
     law = GetKineticLawInReactionNode( reaction );
     //STRING* string = ToStringKineticLaw( law );
     //printf( "Law=%s" NEW_LINE, GetCharArrayOfString( string ) );
-    propensity = evaluator->EvaluateWithCurrentAmountsDeter( evaluator, law );
+    if( program != NULL ) {
+        propensity = EvaluateKineticLawProgram( program, rec->state->values, rec->randomNumberContext );
+    }
+    else {
+        propensity = evaluator->EvaluateWithCurrentAmountsDeter( evaluator, law );
+    }
     if( propensity <= 0.0 ) {
-        if( IS_FAILED( ( ret = SetReactionRate( reaction, 0.0 ) ) ) ) {
-            return ret;
-        }
+        return 0.0;
     }
     /* in case nan */
     else if( !( propensity < DBL_MAX ) ) {
-        if( IS_FAILED( ( ret = SetReactionRate( reaction, 0.0 ) ) ) ) {
-            return ret;
-        }
+        return 0.0;
     }
-    else {
-        if( IS_FAILED( ( ret = SetReactionRate( reaction, propensity ) ) ) ) {
-            return ret;
-        }
+    return propensity;
+}
+
+/*
+ * Evaluate a law with its compiled program, or with the evaluator if it could not be 
+ * compiled.  _EvaluateLaw samples the random operators; _EvaluateLawDeter uses their means.
+ */
+static double _EvaluateLaw( MONTE_CARLO_RECORD *rec, KINETIC_LAW *law ) {
+    KINETIC_LAW_PROGRAM *program = NULL;
+
+    if( ( program = CompileKineticLaw( rec->compiler, law, FALSE ) ) == NULL ) {
+        return rec->evaluator->EvaluateWithCurrentAmounts( rec->evaluator, law );
     }
-#ifdef DEBUG
-    printf( "(%s, %f)" NEW_LINE, GetCharArrayOfString( GetReactionNodeName( reaction ) ),
-        GetReactionRate( reaction ) );
-#endif
-    return ret;
+    return EvaluateKineticLawProgram( program, rec->state->values, rec->randomNumberContext );
+}
+
+static double _EvaluateLawDeter( MONTE_CARLO_RECORD *rec, KINETIC_LAW *law ) {
+    KINETIC_LAW_PROGRAM *program = NULL;
+
+    if( ( program = CompileKineticLaw( rec->compiler, law, TRUE ) ) == NULL ) {
+        return rec->evaluator->EvaluateWithCurrentAmountsDeter( rec->evaluator, law );
+    }
+    return EvaluateKineticLawProgram( program, rec->state->values, rec->randomNumberContext );
+}
+
+/* 
+ * The stoichiometry of an entry of the stoichiometry matrix, scaled by the species' 
+ * conversion factor; negative for reactants. 
+ */
+static double _GetStoichiometry( MONTE_CARLO_RECORD *rec, UINT32 reactionIndex, UINT32 entry ) {
+    SIM_STATE *state = rec->state;
+    double stoichiometry = 0.0;
+
+    stoichiometry = GetStoichiometryInSimState( state, entry ) * 
+        GetConversionFactorInSimState( state, state->stoichiometrySpecies[entry] );
+    return ( entry < state->productOffsets[reactionIndex] ) ? -stoichiometry : stoichiometry;
 }
 
 
+/* 
+ * Uniform deviates in (0,1) are drawn a block at a time from the run's stream. 
+ */
+static double _GetNextUnitUniformRandomNumber( MONTE_CARLO_RECORD *rec ) {
+    if( rec->uniformsIndex >= MONTE_CARLO_UNIFORMS_BLOCK_SIZE ) {
+        FillUnitUniformRandomNumbersInContext( rec->randomNumberContext, rec->uniforms, MONTE_CARLO_UNIFORMS_BLOCK_SIZE );
+        rec->uniformsIndex = 0;
+    }
+    return rec->uniforms[rec->uniformsIndex++];
+}
+
 static RET_VAL _FindNextReactionTime( MONTE_CARLO_RECORD *rec ) {
     RET_VAL ret = SUCCESS;
     double random = 0.0;
     double average = 0.0;
     double t = 0.0;
 
-    //if (strcmp(rec->encoding,"gillespie")==0) {
-    if (rec->encoding[0]=='g') {
-      random = GetNextUnitUniformRandomNumber();
+    if (rec->nextReactionQueue != NULL) {
+      t = GetNextFiringTimeInNextReactionQueue( rec->nextReactionQueue ) - rec->time;
+      rec->time += t;
+      rec->t = t;
+      if( rec->time > rec->timeLimit ) {
+	rec->t -= rec->time - rec->timeLimit;
+	rec->time = rec->timeLimit;
+      }
+      //} else if (strcmp(rec->encoding,"gillespie")==0) {
+      /* a tau-leap run falls back to an exact step whenever _TauLeap declines to leap */
+    } else if ((rec->encoding[0]=='g') || (rec->tauLeap != NULL)) {
+      if( rec->totalPropensities <= 0.0 ) {
+        rec->t = rec->timeLimit - rec->time;
+        rec->time = rec->timeLimit;
+        TRACE_0( "the total propensity is 0, no reaction fires before the time limit" );
+        return ret;
+      }
+      random = _GetNextUnitUniformRandomNumber( rec );
       t = log( 1.0 / random ) / rec->totalPropensities;
       rec->time += t;
       rec->t = t;
@@ -1164,7 +1757,7 @@ static RET_VAL _FindNextReactionTime( MONTE_CARLO_RECORD *rec ) {
       }
       //} else if (strcmp(rec->encoding,"bunker")==0) {
     } else if (rec->encoding[0]=='b') {
-      random = GetNextUnitUniformRandomNumber();
+      random = _GetNextUnitUniformRandomNumber( rec );
       /* in bunker's method, just use mean value for time */
       t = 1.0 / rec->totalPropensities;
       rec->time += t;
@@ -1176,7 +1769,7 @@ static RET_VAL _FindNextReactionTime( MONTE_CARLO_RECORD *rec ) {
       //} else if (strcmp(rec->encoding,"nmc")==0) {
     } else if (rec->encoding[0]=='n') {
       average = 1.0 / rec->totalPropensities;
-      t = GetNextNormalRandomNumber( average, sqrt( average ) );
+      t = GetNextNormalRandomNumberInContext( rec->randomNumberContext, average, sqrt( average ) );
       rec->time += t;
       rec->t = t;
       if( rec->time > rec->timeLimit ) {
@@ -1196,23 +1789,20 @@ static RET_VAL _FindNextReactionTime( MONTE_CARLO_RECORD *rec ) {
 static RET_VAL _FindNextReaction( MONTE_CARLO_RECORD *rec ) {
     RET_VAL ret = SUCCESS;
     UINT32 i = 0;
-    UINT32 size = rec->reactionsSize - 1;
     double random = 0.0;
     double threshold = 0.0;
-    double sum = 0.0;
-    REACTION *reaction = NULL;
     REACTION **reactionArray = rec->reactionArray;
 
-    random = GetNextUnitUniformRandomNumber();
-    threshold = random * rec->totalPropensities;
+    if( rec->nextReactionQueue != NULL ) {
+        i = GetNextReactionInNextReactionQueue( rec->nextReactionQueue );
+    }
+    else {
+        random = _GetNextUnitUniformRandomNumber( rec );
+        threshold = random * rec->totalPropensities;
 
-    TRACE_1( "next reaction threshold is %f", threshold );
+        TRACE_1( "next reaction threshold is %f", threshold );
 
-    for( i = 0; i < size; i++ ) {
-        sum += GetReactionRate( reactionArray[i] );
-        if( sum >= threshold ) {
-            break;
-        }
+        i = FindIndexInSumTree( rec->propensityTree, threshold );
     }
 
     rec->nextReaction = reactionArray[i];
@@ -1220,6 +1810,499 @@ static RET_VAL _FindNextReaction( MONTE_CARLO_RECORD *rec ) {
     return ret;
 }
 
+/*
+ * Reads the tau-leaping properties and lists, for every reaction, the species it changes.  
+ * Species with a boundary condition are never changed by a reaction and are left out.
+ */
+static RET_VAL _InitializeTauLeap( MONTE_CARLO_RECORD *rec, REB2SAC_PROPERTIES *properties ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 j = 0;
+    UINT32 size = 0;
+    char *valueString = NULL;
+    BYTE *isImplicit = NULL;
+    SIM_STATE *state = rec->state;
+    MONTE_CARLO_TAU_LEAP *tauLeap = NULL;
+
+    if( ( tauLeap = (MONTE_CARLO_TAU_LEAP*)MALLOC( sizeof(MONTE_CARLO_TAU_LEAP) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_InitializeTauLeap", "could not allocate memory for tau-leaping" );
+    }
+    rec->tauLeap = tauLeap;
+
+    if( ( valueString = properties->GetProperty( properties, MONTE_CARLO_SIMULATION_TAU_LEAP_EPSILON ) ) == NULL ) {
+        tauLeap->epsilon = DEFAULT_MONTE_CARLO_SIMULATION_TAU_LEAP_EPSILON_VALUE;
+    }
+    else {
+        if( IS_FAILED( ( ret = StrToFloat( &(tauLeap->epsilon), valueString ) ) ) || ( tauLeap->epsilon <= 0.0 ) ) {
+            tauLeap->epsilon = DEFAULT_MONTE_CARLO_SIMULATION_TAU_LEAP_EPSILON_VALUE;
+        }
+    }
+    if( ( valueString = properties->GetProperty( properties, MONTE_CARLO_SIMULATION_TAU_LEAP_CRITICAL_FIRINGS ) ) == NULL ) {
+        tauLeap->criticalFirings = DEFAULT_MONTE_CARLO_SIMULATION_TAU_LEAP_CRITICAL_FIRINGS_VALUE;
+    }
+    else {
+        if( IS_FAILED( ( ret = StrToUINT32( &(tauLeap->criticalFirings), valueString ) ) ) ) {
+            tauLeap->criticalFirings = DEFAULT_MONTE_CARLO_SIMULATION_TAU_LEAP_CRITICAL_FIRINGS_VALUE;
+        }
+    }
+    if( ( valueString = properties->GetProperty( properties, MONTE_CARLO_SIMULATION_TAU_LEAP_SSA_FACTOR ) ) == NULL ) {
+        tauLeap->ssaFactor = DEFAULT_MONTE_CARLO_SIMULATION_TAU_LEAP_SSA_FACTOR_VALUE;
+    }
+    else {
+        if( IS_FAILED( ( ret = StrToFloat( &(tauLeap->ssaFactor), valueString ) ) ) ) {
+            tauLeap->ssaFactor = DEFAULT_MONTE_CARLO_SIMULATION_TAU_LEAP_SSA_FACTOR_VALUE;
+        }
+    }
+    if( ( valueString = properties->GetProperty( properties, MONTE_CARLO_SIMULATION_TAU_LEAP_SSA_STEPS ) ) == NULL ) {
+        tauLeap->ssaSteps = DEFAULT_MONTE_CARLO_SIMULATION_TAU_LEAP_SSA_STEPS_VALUE;
+    }
+    else {
+        if( IS_FAILED( ( ret = StrToUINT32( &(tauLeap->ssaSteps), valueString ) ) ) || ( tauLeap->ssaSteps == 0 ) ) {
+            tauLeap->ssaSteps = DEFAULT_MONTE_CARLO_SIMULATION_TAU_LEAP_SSA_STEPS_VALUE;
+        }
+    }
+    if( ( valueString = properties->GetProperty( properties, MONTE_CARLO_SIMULATION_TAU_LEAP_IMPLICIT ) ) == NULL ) {
+        valueString = DEFAULT_MONTE_CARLO_SIMULATION_TAU_LEAP_IMPLICIT_VALUE;
+    }
+    tauLeap->implicit = ( strcmp( valueString, "true" ) == 0 );
+    ret = SUCCESS;
+
+    size = GET_MAX( rec->reactionsSize, 1 );
+    if( ( ( tauLeap->firings = (double*)MALLOC( size * sizeof(double) ) ) == NULL ) ||
+        ( ( tauLeap->firingLimits = (double*)MALLOC( size * sizeof(double) ) ) == NULL ) ||
+        ( ( tauLeap->isCritical = (BYTE*)MALLOC( size * sizeof(BYTE) ) ) == NULL ) ) {
+        return ErrorReport( FAILING, "_InitializeTauLeap", "could not allocate memory for tau-leaping" );
+    }
+    size = GET_MAX( rec->speciesSize, 1 );
+    if( ( ( tauLeap->speciesChanges = (double*)MALLOC( size * sizeof(double) ) ) == NULL ) ||
+        ( ( tauLeap->drifts = (double*)MALLOC( size * sizeof(double) ) ) == NULL ) ||
+        ( ( tauLeap->variances = (double*)MALLOC( size * sizeof(double) ) ) == NULL ) ||
+        ( ( tauLeap->orderFactors = (double*)MALLOC( size * sizeof(double) ) ) == NULL ) ||
+        ( ( tauLeap->amounts = (double*)MALLOC( size * sizeof(double) ) ) == NULL ) ||
+        ( ( tauLeap->implicitSpecies = (UINT32*)MALLOC( size * sizeof(UINT32) ) ) == NULL ) ||
+        ( ( isImplicit = (BYTE*)MALLOC( size * sizeof(BYTE) ) ) == NULL ) ) {
+        return ErrorReport( FAILING, "_InitializeTauLeap", "could not allocate memory for tau-leaping" );
+    }
+
+    for( j = 0; j < state->stoichiometryOffsets[rec->reactionsSize]; j++ ) {
+        if( !state->isBoundary[state->stoichiometrySpecies[j]] ) {
+            isImplicit[state->stoichiometrySpecies[j]] = TRUE;
+        }
+    }
+    for( j = 0, i = 0; i < rec->speciesSize; i++ ) {
+        if( isImplicit[i] ) {
+            tauLeap->implicitSpecies[j++] = i;
+        }
+    }
+    tauLeap->implicitSpeciesSize = j;
+    FREE( isImplicit );
+    return ret;
+}
+
+static RET_VAL _FreeTauLeap( MONTE_CARLO_RECORD *rec ) {
+    MONTE_CARLO_TAU_LEAP *tauLeap = rec->tauLeap;
+
+    if( tauLeap == NULL ) {
+        return SUCCESS;
+    }
+    FREE( tauLeap->firings );
+    FREE( tauLeap->firingLimits );
+    FREE( tauLeap->isCritical );
+    FREE( tauLeap->speciesChanges );
+    FREE( tauLeap->drifts );
+    FREE( tauLeap->variances );
+    FREE( tauLeap->orderFactors );
+    FREE( tauLeap->amounts );
+    FREE( tauLeap->implicitSpecies );
+    FREE( rec->tauLeap );
+    return SUCCESS;
+}
+
+/*
+ * Tau-leaping after Cao, Gillespie and Petzold (2006).  A reaction is critical when it could 
+ * exhaust a reactant within criticalFirings firings.  Critical reactions fire at most once 
+ * per leap, picked as in the direct method; the others fire a Poisson number of times, or a 
+ * binomial number when a reactant bounds them.  The leap keeps the expected relative change 
+ * of every reactant below epsilon.  A leap shorter than ssaFactor / a0 is declined and the 
+ * next ssaSteps steps are exact.  A leap that would drive a species negative is retried with 
+ * half the step.
+ */
+static RET_VAL _TauLeap( MONTE_CARLO_RECORD *rec, double maxTime, BOOL *leaped ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    double tau = 0.0;
+    double tau1 = 0.0;
+    double tau2 = 0.0;
+    double limit = 0.0;
+    double criticalTotal = 0.0;
+    BOOL criticalFires = FALSE;
+    MONTE_CARLO_TAU_LEAP *tauLeap = rec->tauLeap;
+
+    *leaped = FALSE;
+    if( tauLeap->ssaStepsLeft > 0 ) {
+        tauLeap->ssaStepsLeft--;
+        return ret;
+    }
+    limit = GET_MIN( maxTime, rec->timeLimit ) - rec->time;
+    criticalTotal = _ClassifyCriticalReactions( rec );
+    tau1 = _SelectLeap( rec );
+    while( TRUE ) {
+        if( ( tau1 * rec->totalPropensities < tauLeap->ssaFactor ) || !( limit > 0.0 ) ) {
+            tauLeap->ssaStepsLeft = tauLeap->ssaSteps - 1;
+            return ret;
+        }
+        if( criticalTotal > 0.0 ) {
+            tau2 = log( 1.0 / _GetNextUnitUniformRandomNumber( rec ) ) / criticalTotal;
+        }
+        else {
+            tau2 = DBL_MAX;
+        }
+        tau = GET_MIN( tau1, tau2 );
+        criticalFires = ( tau2 <= tau1 );
+        if( tau >= limit ) {
+            tau = limit;
+            criticalFires = FALSE;
+        }
+        _SampleFirings( rec, tau, criticalFires, criticalTotal );
+        if( tauLeap->implicit ) {
+            if( IS_FAILED( ( ret = _SolveImplicitFirings( rec, tau ) ) ) ) {
+                return ret;
+            }
+        }
+        if( _ComputeSpeciesChanges( rec ) ) {
+            break;
+        }
+        TRACE_1( "leap of %g would make a species negative, halving it", tau );
+        tau1 = tau / 2.0;
+    }
+
+    rec->t = tau;
+    rec->time += tau;
+    rec->nextReaction = NULL;
+    if( IS_FAILED( ( ret = _Print( rec ) ) ) ) {
+        return ret;
+    }
+    for( i = 0; i < rec->speciesSize; i++ ) {
+        if( tauLeap->speciesChanges[i] != 0.0 ) {
+            SetSpeciesAmountInSimState( rec->state, i, rec->state->amounts[i] + tauLeap->speciesChanges[i] );
+        }
+    }
+    for( i = 0; i < rec->reactionsSize; i++ ) {
+        if( tauLeap->firings[i] > 0.0 ) {
+            rec->nextReaction = rec->reactionArray[i];
+            _MarkReactionsAffectedByFiring( rec );
+        }
+    }
+    rec->nextReaction = NULL;
+    rec->firedReaction = NULL;
+    if( IS_FAILED( ( ret = _UpdateNodeValues( rec ) ) ) ) {
+        return ret;
+    }
+    *leaped = TRUE;
+    return ret;
+}
+
+/* 
+ * Sets the firing limit of every reaction, the number of firings that exhausts its scarcest 
+ * reactant, marks the critical reactions, and returns their total propensity. 
+ */
+static double _ClassifyCriticalReactions( MONTE_CARLO_RECORD *rec ) {
+    UINT32 i = 0;
+    UINT32 j = 0;
+    UINT32 k = 0;
+    double change = 0.0;
+    double firings = 0.0;
+    double propensity = 0.0;
+    double total = 0.0;
+    SIM_STATE *state = rec->state;
+    MONTE_CARLO_TAU_LEAP *tauLeap = rec->tauLeap;
+
+    for( i = 0; i < rec->reactionsSize; i++ ) {
+        tauLeap->firingLimits[i] = DBL_MAX;
+        for( j = state->stoichiometryOffsets[i]; j < state->productOffsets[i]; j++ ) {
+            if( state->isBoundary[state->stoichiometrySpecies[j]] ) {
+                continue;
+            }
+            change = 0.0;
+            for( k = state->stoichiometryOffsets[i]; k < state->stoichiometryOffsets[i+1]; k++ ) {
+                if( state->stoichiometrySpecies[k] == state->stoichiometrySpecies[j] ) {
+                    change += _GetStoichiometry( rec, i, k );
+                }
+            }
+            if( change < 0.0 ) {
+                firings = floor( state->amounts[state->stoichiometrySpecies[j]] / -change );
+                tauLeap->firingLimits[i] = GET_MIN( tauLeap->firingLimits[i], firings );
+            }
+        }
+        propensity = rec->state->propensities[i];
+        tauLeap->isCritical[i] = ( propensity > 0.0 ) && ( tauLeap->firingLimits[i] < (double)tauLeap->criticalFirings );
+        if( tauLeap->isCritical[i] ) {
+            total += propensity;
+        }
+    }
+    return total;
+}
+
+/*
+ * The leap of Cao, Gillespie and Petzold: for every reactant i of a non-critical reaction, 
+ * the mean and variance of its change over the leap are bounded by max( epsilon x_i / g_i, 1 ), 
+ * where g_i accounts for the highest order reaction consuming i. 
+ */
+static double _SelectLeap( MONTE_CARLO_RECORD *rec ) {
+    UINT32 i = 0;
+    UINT32 j = 0;
+    UINT32 s = 0;
+    double propensity = 0.0;
+    double change = 0.0;
+    double order = 0.0;
+    double bound = 0.0;
+    double amount = 0.0;
+    double factor = 0.0;
+    double tau = DBL_MAX;
+    SIM_STATE *state = rec->state;
+    MONTE_CARLO_TAU_LEAP *tauLeap = rec->tauLeap;
+
+    for( i = 0; i < rec->speciesSize; i++ ) {
+        tauLeap->drifts[i] = 0.0;
+        tauLeap->variances[i] = 0.0;
+        tauLeap->orderFactors[i] = 0.0;
+    }
+    for( i = 0; i < rec->reactionsSize; i++ ) {
+        propensity = rec->state->propensities[i];
+        if( tauLeap->isCritical[i] || !( propensity > 0.0 ) ) {
+            continue;
+        }
+        order = 0.0;
+        for( j = state->stoichiometryOffsets[i]; j < state->productOffsets[i]; j++ ) {
+            order -= _GetStoichiometry( rec, i, j );
+        }
+        for( j = state->stoichiometryOffsets[i]; j < state->stoichiometryOffsets[i+1]; j++ ) {
+            s = state->stoichiometrySpecies[j];
+            if( state->isBoundary[s] ) {
+                continue;
+            }
+            change = _GetStoichiometry( rec, i, j );
+            tauLeap->drifts[s] += change * propensity;
+            tauLeap->variances[s] += change * change * propensity;
+            if( j < state->productOffsets[i] ) {
+                amount = state->amounts[s];
+                factor = _GetHighestOrderFactor( order, -change, amount );
+                tauLeap->orderFactors[s] = GET_MAX( tauLeap->orderFactors[s], factor );
+            }
+        }
+    }
+    for( i = 0; i < rec->speciesSize; i++ ) {
+        if( tauLeap->orderFactors[i] <= 0.0 ) {
+            continue;
+        }
+        bound = GET_MAX( tauLeap->epsilon * state->amounts[i] / tauLeap->orderFactors[i], 1.0 );
+        if( tauLeap->drifts[i] != 0.0 ) {
+            tau = GET_MIN( tau, bound / fabs( tauLeap->drifts[i] ) );
+        }
+        if( tauLeap->variances[i] > 0.0 ) {
+            tau = GET_MIN( tau, bound * bound / tauLeap->variances[i] );
+        }
+    }
+    return tau;
+}
+
+static double _GetHighestOrderFactor( double order, double stoichiometry, double amount ) {
+    if( order <= 1.0 ) {
+        return 1.0;
+    }
+    if( order <= 2.0 ) {
+        if( ( stoichiometry >= 2.0 ) && ( amount > 1.0 ) ) {
+            return 2.0 + 1.0 / ( amount - 1.0 );
+        }
+        return 2.0;
+    }
+    if( order <= 3.0 ) {
+        if( ( stoichiometry >= 3.0 ) && ( amount > 2.0 ) ) {
+            return 3.0 + 1.0 / ( amount - 1.0 ) + 2.0 / ( amount - 2.0 );
+        }
+        if( ( stoichiometry >= 2.0 ) && ( amount > 1.0 ) ) {
+            return 1.5 * ( 2.0 + 1.0 / ( amount - 1.0 ) );
+        }
+        return 3.0;
+    }
+    return order;
+}
+
+static void _SampleFirings( MONTE_CARLO_RECORD *rec, double tau, BOOL criticalFires, double criticalTotal ) {
+    UINT32 i = 0;
+    UINT32 chosen = 0;
+    double propensity = 0.0;
+    double mean = 0.0;
+    double limit = 0.0;
+    double threshold = 0.0;
+    MONTE_CARLO_TAU_LEAP *tauLeap = rec->tauLeap;
+
+    for( i = 0; i < rec->reactionsSize; i++ ) {
+        tauLeap->firings[i] = 0.0;
+        propensity = rec->state->propensities[i];
+        if( tauLeap->isCritical[i] || !( propensity > 0.0 ) ) {
+            continue;
+        }
+        mean = propensity * tau;
+        limit = tauLeap->firingLimits[i];
+        if( limit < DBL_MAX ) {
+            if( mean >= limit ) {
+                tauLeap->firings[i] = limit;
+            }
+            else {
+                tauLeap->firings[i] = GetNextBinomialRandomNumberInContext( rec->randomNumberContext, mean / limit, (unsigned int)limit );
+            }
+        }
+        else {
+            tauLeap->firings[i] = GetNextPoissonRandomNumberInContext( rec->randomNumberContext, mean );
+        }
+    }
+    if( !criticalFires ) {
+        return;
+    }
+    threshold = _GetNextUnitUniformRandomNumber( rec ) * criticalTotal;
+    for( i = 0; i < rec->reactionsSize; i++ ) {
+        if( !tauLeap->isCritical[i] ) {
+            continue;
+        }
+        chosen = i;
+        threshold -= rec->state->propensities[i];
+        if( threshold < 0.0 ) {
+            break;
+        }
+    }
+    tauLeap->firings[chosen] = 1.0;
+}
+
+/* returns FALSE if the firings would make a species negative */
+static BOOL _ComputeSpeciesChanges( MONTE_CARLO_RECORD *rec ) {
+    UINT32 i = 0;
+    UINT32 j = 0;
+    UINT32 s = 0;
+    SIM_STATE *state = rec->state;
+    MONTE_CARLO_TAU_LEAP *tauLeap = rec->tauLeap;
+
+    for( i = 0; i < rec->speciesSize; i++ ) {
+        tauLeap->speciesChanges[i] = 0.0;
+    }
+    for( i = 0; i < rec->reactionsSize; i++ ) {
+        if( tauLeap->firings[i] == 0.0 ) {
+            continue;
+        }
+        for( j = state->stoichiometryOffsets[i]; j < state->stoichiometryOffsets[i+1]; j++ ) {
+            s = state->stoichiometrySpecies[j];
+            if( !state->isBoundary[s] ) {
+                tauLeap->speciesChanges[s] += tauLeap->firings[i] * _GetStoichiometry( rec, i, j );
+            }
+        }
+    }
+    for( i = 0; i < rec->speciesSize; i++ ) {
+        if( state->amounts[i] + tauLeap->speciesChanges[i] < 0.0 ) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*
+ * Implicit tau-leaping after Rathinam, Petzold, Cao and Gillespie (2003).  The new state y solves
+ *   y = x + sum_j v_j ( k_j - a_j(x) tau + a_j(y) tau )
+ * for the sampled firings k_j of the non-critical reactions, which damps the drift of stiff 
+ * reactions.  The firings are then replaced by round( k_j - a_j(x) tau + a_j(y) tau ).  The 
+ * system is solved with the same GSL solver as the algebraic rules.
+ */
+static RET_VAL _SolveImplicitFirings( MONTE_CARLO_RECORD *rec, double tau ) {
+    const gsl_multiroot_fsolver_type *T;
+    gsl_multiroot_fsolver *s;
+    gsl_vector *x = NULL;
+    int status;
+    size_t k, iter = 0;
+    UINT32 i = 0;
+    double firings = 0.0;
+    double propensity = 0.0;
+    MONTE_CARLO_TAU_LEAP *tauLeap = rec->tauLeap;
+    const size_t n = tauLeap->implicitSpeciesSize;
+
+    if( n == 0 ) {
+        return SUCCESS;
+    }
+    tauLeap->tau = tau;
+    for( k = 0; k < n; k++ ) {
+        tauLeap->amounts[k] = rec->state->amounts[tauLeap->implicitSpecies[k]];
+    }
+
+    gsl_multiroot_function f = {&MonteCarloImplicitTauLeap, n, rec};
+    x = gsl_vector_alloc (n);
+    for( k = 0; k < n; k++ ) {
+        gsl_vector_set (x, k, tauLeap->amounts[k]);
+    }
+    T = gsl_multiroot_fsolver_hybrids;
+    s = gsl_multiroot_fsolver_alloc (T, n);
+    gsl_multiroot_fsolver_set (s, &f, x);
+    do {
+        iter++;
+        status = gsl_multiroot_fsolver_iterate (s);
+        if (status)   /* check if solver is stuck */
+            break;
+        status = gsl_multiroot_test_residual (s->f, 1e-7);
+    } while (status == GSL_CONTINUE && iter < 1000);
+
+    for( k = 0; k < n; k++ ) {
+        SetSpeciesAmountInSimState( rec->state, tauLeap->implicitSpecies[k], gsl_vector_get (s->x, k) );
+    }
+    for( i = 0; i < rec->reactionsSize; i++ ) {
+        if( tauLeap->isCritical[i] ) {
+            continue;
+        }
+        propensity = _EvaluatePropensity( rec, rec->reactionArray[i] );
+        firings = floor( tauLeap->firings[i] + ( propensity - rec->state->propensities[i] ) * tau + 0.5 );
+        tauLeap->firings[i] = GET_MAX( firings, 0.0 );
+    }
+    for( k = 0; k < n; k++ ) {
+        SetSpeciesAmountInSimState( rec->state, tauLeap->implicitSpecies[k], tauLeap->amounts[k] );
+    }
+
+    gsl_multiroot_fsolver_free (s);
+    gsl_vector_free (x);
+    return SUCCESS;
+}
+
+int MonteCarloImplicitTauLeap(const gsl_vector * y, void *params, gsl_vector * f) {
+  UINT32 i = 0;
+  UINT32 j = 0;
+  size_t k = 0;
+  double firings = 0.0;
+  MONTE_CARLO_RECORD *rec = ((MONTE_CARLO_RECORD*)params);
+  SIM_STATE *state = rec->state;
+  MONTE_CARLO_TAU_LEAP *tauLeap = rec->tauLeap;
+  double tau = tauLeap->tau;
+
+  for( k = 0; k < tauLeap->implicitSpeciesSize; k++ ) {
+    SetSpeciesAmountInSimState( state, tauLeap->implicitSpecies[k], gsl_vector_get (y, k) );
+  }
+  for( i = 0; i < rec->speciesSize; i++ ) {
+    tauLeap->speciesChanges[i] = 0.0;
+  }
+  for( i = 0; i < rec->reactionsSize; i++ ) {
+    firings = tauLeap->firings[i];
+    if( !tauLeap->isCritical[i] ) {
+      firings += ( _EvaluatePropensity( rec, rec->reactionArray[i] ) - rec->state->propensities[i] ) * tau;
+    }
+    if( firings == 0.0 ) {
+      continue;
+    }
+    for( j = state->stoichiometryOffsets[i]; j < state->stoichiometryOffsets[i+1]; j++ ) {
+      if( !state->isBoundary[state->stoichiometrySpecies[j]] ) {
+	tauLeap->speciesChanges[state->stoichiometrySpecies[j]] += firings * _GetStoichiometry( rec, i, j );
+      }
+    }
+  }
+  for( k = 0; k < tauLeap->implicitSpeciesSize; k++ ) {
+    gsl_vector_set (f, k, gsl_vector_get (y, k) - tauLeap->amounts[k] - tauLeap->speciesChanges[tauLeap->implicitSpecies[k]]);
+  }
+  return GSL_SUCCESS;
+}
+
 static RET_VAL _Update( MONTE_CARLO_RECORD *rec ) {
     RET_VAL ret = SUCCESS;
 
@@ -1275,41 +2358,55 @@ static RET_VAL _Print( MONTE_CARLO_RECORD *rec ) {
 static RET_VAL _UpdateNodeValues( MONTE_CARLO_RECORD *rec ) {
     RET_VAL ret = SUCCESS;
 
+    _MarkReactionsAffectedByFiring( rec );
     if( IS_FAILED( ( ret = _UpdateSpeciesValues( rec ) ) ) ) {
         return ret;
     }
-    if( IS_FAILED( ( ret = _UpdateReactionRateUpdateTime( rec ) ) ) ) {
-        return ret;
-    }
 
     return ret;
 }
 
+/*
+ * A pass checks only the events whose trigger read a variable that changed since the last 
+ * pass, the volatile events, and the scheduled events that are due, which are popped from 
+ * the event queue.  They are checked in index order, as the random tie breaks depend on it.
+ */
 static double fireEvents( MONTE_CARLO_RECORD *rec, double time ) {
     int i;
+    UINT32 k;
+    UINT32 size;
     double nextEventTime;
     BOOL triggerEnabled;
+    BOOL isTriggered = FALSE;
     double deltaTime;
     BOOL eventFired = FALSE;
     double firstEventTime = -1.0;
+    double firstTriggerTime = -1.0;
     int eventToFire = -1;
     double prMax,prMax2;
     double priority = 0.0;
     double randChoice = 0.0;
 
+    if (rec->eventsSize == 0) {
+      return -1.0;
+    }
     do {
       eventFired = FALSE;
       eventToFire = -1;
-      for (i = 0; i < rec->eventsSize; i++) {
+      firstTriggerTime = -1.0;
+      size = _CollectEventsToCheck( rec, time );
+      for (k = 0; k < size; k++) {
+	i = (int)rec->eventsToCheck[k];
+	/* nothing the checks below do changes the state */
+	isTriggered = (_EvaluateLawDeter( rec, (KINETIC_LAW*)GetTriggerInEvent( rec->eventArray[i] ) ) != 0.0);
 	nextEventTime = GetNextEventTimeInEvent( rec->eventArray[i] );
 	triggerEnabled = GetTriggerEnabledInEvent( rec->eventArray[i] );
 	if (nextEventTime != -1.0) {
 	  /* Disable event, if necessary */
 	  if ((triggerEnabled) && (GetTriggerCanBeDisabled( rec->eventArray[i] ))) {
-	    if (!rec->evaluator->EvaluateWithCurrentAmountsDeter( rec->evaluator,
-							     (KINETIC_LAW*)GetTriggerInEvent( rec->eventArray[i] ) )) { 
+	    if (!isTriggered) { 
 	      nextEventTime = -1.0;
-	      SetNextEventTimeInEvent( rec->eventArray[i], -1.0 );
+	      _ScheduleEvent( rec, i, -1.0 );
 	      SetTriggerEnabledInEvent( rec->eventArray[i], FALSE );
 	      continue;
 	    }
@@ -1319,72 +2416,61 @@ static double fireEvents( MONTE_CARLO_RECORD *rec, double time ) {
 	      priority = 0;
 	    }
 	    else {
-	      priority = rec->evaluator->EvaluateWithCurrentAmounts( rec->evaluator,
+	      priority = _EvaluateLaw( rec,
 								     (KINETIC_LAW*)GetPriorityInEvent( rec->eventArray[i] ) );
 	    }
 	    if ((eventToFire==(-1)) || (priority > prMax)) {
 	      eventToFire = i;
 	      prMax = priority;
-	      prMax2=GetNextUniformRandomNumber(0,1);	   
+	      prMax2=_GetNextUnitUniformRandomNumber(rec);	   
 	    } else if (priority == prMax) {
-	      randChoice=GetNextUniformRandomNumber(0,1);	   
+	      randChoice=_GetNextUnitUniformRandomNumber(rec);	   
 	      if (randChoice > prMax2) {
 		eventToFire = i;
 		prMax2 = randChoice;
 	      }
 	    }
-	  } else {
-	    /* Determine time to next event */
-	    if ((firstEventTime == -1.0) || (nextEventTime < firstEventTime)) {
-	      firstEventTime = nextEventTime;
-	    }
 	  }
 	}
-	/* Try to find time to next event trigger */
-	nextEventTime = /*time +*/ 
-	  rec->findNextTime->FindNextTimeWithCurrentAmounts( rec->findNextTime,
-							     (KINETIC_LAW*)GetTriggerInEvent( rec->eventArray[i] ));
-	if (nextEventTime >= 0) 
-	  nextEventTime = time + nextEventTime;
-	if ((firstEventTime == -1.0) || (nextEventTime < firstEventTime)) {
-	  firstEventTime = nextEventTime;
+	if (rec->isEventVolatile[i]) {
+	  /* Try to find time to next event trigger */
+	  nextEventTime = 
+	    rec->findNextTime->FindNextTimeWithCurrentAmounts( rec->findNextTime,
+							       (KINETIC_LAW*)GetTriggerInEvent( rec->eventArray[i] ));
+	  if (nextEventTime >= 0) {
+	    nextEventTime = time + nextEventTime;
+	    if ((firstTriggerTime == -1.0) || (nextEventTime < firstTriggerTime)) {
+	      firstTriggerTime = nextEventTime;
+	    }
+	  }
 	}
 	if (!triggerEnabled) {
 	  /* Check if event has been triggered */
-	  if (rec->evaluator->EvaluateWithCurrentAmountsDeter( rec->evaluator,
-							  (KINETIC_LAW*)GetTriggerInEvent( rec->eventArray[i] ) )) {
+	  if (isTriggered) {
 	    SetTriggerEnabledInEvent( rec->eventArray[i], TRUE );
 	    /* Calculate delay until the event fires */
 	    if (GetDelayInEvent( rec->eventArray[i] )==NULL) {
 	      deltaTime = 0;
 	    }
 	    else {
-	      deltaTime = rec->evaluator->EvaluateWithCurrentAmounts( rec->evaluator,
+	      deltaTime = _EvaluateLaw( rec,
 								      (KINETIC_LAW*)GetDelayInEvent( rec->eventArray[i] ) );
 	    }
 	    if (deltaTime == 0) eventFired = TRUE;
 	    if (deltaTime >= 0) {
 	      /* Set time for event to fire and get assignment values, if necessary */
-	      SetNextEventTimeInEvent( rec->eventArray[i], time + deltaTime );
+	      _ScheduleEvent( rec, i, time + deltaTime );
 	      if (GetUseValuesFromTriggerTime( rec->eventArray[i] )) {
 		SetEventAssignmentsNextValuesTime( rec->eventArray[i], rec, time + deltaTime ); 
 	      }
-	      if ((firstEventTime == -1.0) || (time + deltaTime < firstEventTime)) {
-		firstEventTime = time + deltaTime;
-	      }
-	    } /* else if (deltaTime == 0) {
-	      SetEventAssignmentsNextValues( rec->eventArray[i], rec ); 
-	      fireEvent( rec->eventArray[i], rec );
-	      eventFired = TRUE;
-	      } */ else {
+	    } else {
 	      ErrorReport( FAILING, "_Update", "delay for event evaluates to a negative number" );
 	      return -2;
 	    }
 	  }
 	} else {
 	  /* Set trigger enabled to false, if it has become disabled */
-	  if (!rec->evaluator->EvaluateWithCurrentAmountsDeter( rec->evaluator,
-							   (KINETIC_LAW*)GetTriggerInEvent( rec->eventArray[i] ) )) {
+	  if (!isTriggered) {
 	    SetTriggerEnabledInEvent( rec->eventArray[i], FALSE );
 	  } 
 	}
@@ -1396,10 +2482,9 @@ static double fireEvents( MONTE_CARLO_RECORD *rec, double time ) {
 	}
 	rec->time = time;
 	fireEvent( rec->eventArray[eventToFire], rec );
-	SetNextEventTimeInEvent( rec->eventArray[eventToFire], -1.0 );
+	_ScheduleEvent( rec, eventToFire, -1.0 );
 	eventFired = TRUE;
 	eventToFire = -1;
-	firstEventTime = -1;
 
 	/* When an event fires, update algebraic rules and fast reactions */
 	ExecuteAssignments( rec );
@@ -1413,6 +2498,12 @@ static double fireEvents( MONTE_CARLO_RECORD *rec, double time ) {
       /* Repeat as long as events are firing */
     } while (eventFired);
     /* Return the time for the next event firing or potential triggering */
+    if ((firstEventTime = GetNextFiringTimeInNextReactionQueue( rec->eventQueue )) == DBL_MAX) {
+      firstEventTime = -1.0;
+    }
+    if ((firstTriggerTime != -1.0) && ((firstEventTime == -1.0) || (firstTriggerTime < firstEventTime))) {
+      firstEventTime = firstTriggerTime;
+    }
     return firstEventTime;
 }
 
@@ -1426,7 +2517,7 @@ static void SetEventAssignmentsNextValues( EVENT *event, MONTE_CARLO_RECORD *rec
   list = GetEventAssignments( event );
   ResetCurrentElement( list );
   while( ( eventAssignment = (EVENT_ASSIGNMENT*)GetNextFromLinkedList( list ) ) != NULL ) {
-    amount = rec->evaluator->EvaluateWithCurrentAmounts( rec->evaluator, eventAssignment->assignment );
+    amount = _EvaluateLaw( rec, eventAssignment->assignment );
     SetEventAssignmentNextValueTime( eventAssignment, amount, rec->time );
   }
 }
@@ -1441,7 +2532,7 @@ static void SetEventAssignmentsNextValuesTime( EVENT *event, MONTE_CARLO_RECORD
   list = GetEventAssignments( event );
   ResetCurrentElement( list );
   while( ( eventAssignment = (EVENT_ASSIGNMENT*)GetNextFromLinkedList( list ) ) != NULL ) {
-    amount = rec->evaluator->EvaluateWithCurrentAmounts( rec->evaluator, eventAssignment->assignment );
+    amount = _EvaluateLaw( rec, eventAssignment->assignment );
     SetEventAssignmentNextValueTime( eventAssignment, amount, time );
   }
 }
@@ -1466,40 +2557,40 @@ static void fireEvent( EVENT *event, MONTE_CARLO_RECORD *rec ) {
     amount = GetEventAssignmentNextValueTime( eventAssignment, rec->time );
     /* printf("conc = %g\n",amount); */
     if ( varType == SPECIES_EVENT_ASSIGNMENT ) {
-      SetAmountInSpeciesNode( rec->speciesArray[j], amount );
-      _UpdateReactionRateUpdateTimeForSpecies( rec, rec->speciesArray[j] );
+      _SetSpeciesAmount( rec, j, amount );
     } else if ( varType == COMPARTMENT_EVENT_ASSIGNMENT ) {
-      SetCurrentSizeInCompartment( rec->compartmentArray[j], amount );
-      _UpdateAllReactionRateUpdateTimes( rec, rec->time );
+      _SetCompartmentSize( rec, j, amount );
     } else {
-      SetCurrentRealValueInSymbol( rec->symbolArray[j], amount );
-      _UpdateAllReactionRateUpdateTimes( rec, rec->time );
+      _SetSymbolValue( rec, j, amount );
     }
   }
 }
 
-/* Update values using assignments rules */
+/* 
+ * Update values using assignments rules.  The rules are sorted so that a rule comes after 
+ * the rules assigning what it reads, and one is evaluated only if one of its inputs changed. 
+ */
 static void ExecuteAssignments( MONTE_CARLO_RECORD *rec ) {
   UINT32 i = 0;
   UINT32 j = 0;
+  UINT32 k = 0;
   double amount = 0.0;
   BYTE varType;
 
-  for (i = 0; i < rec->rulesSize; i++) {
-    if ( GetRuleType( rec->ruleArray[i] ) == RULE_TYPE_ASSIGNMENT ) {
-      amount = rec->evaluator->EvaluateWithCurrentAmountsDeter( rec->evaluator,
+  for (k = 0; k < rec->assignmentRulesSize; k++) {
+    i = rec->assignmentRuleOrder[k];
+    if ( rec->isRuleStale[i] || rec->isRuleVolatile[i] ) {
+      rec->isRuleStale[i] = FALSE;
+      amount = _EvaluateLawDeter( rec,
 							   (KINETIC_LAW*)GetMathInRule( rec->ruleArray[i] ) );
       varType = GetRuleVarType( rec->ruleArray[i] );
       j = GetRuleIndex( rec->ruleArray[i] );
       if ( varType == SPECIES_RULE ) {
-	SetAmountInSpeciesNode( rec->speciesArray[j], amount );
-	_UpdateReactionRateUpdateTimeForSpecies( rec, rec->speciesArray[j] );
+	_SetSpeciesAmount( rec, j, amount );
       } else if ( varType == COMPARTMENT_RULE ) {
-	SetCurrentSizeInCompartment( rec->compartmentArray[j], amount );
-	_UpdateAllReactionRateUpdateTimes( rec, rec->time );
+	_SetCompartmentSize( rec, j, amount );
       } else {
-	SetCurrentRealValueInSymbol( rec->symbolArray[j], amount );
-	_UpdateAllReactionRateUpdateTimes( rec, rec->time );
+	_SetSymbolValue( rec, j, amount );
       }
     } 
   }
@@ -1519,7 +2610,7 @@ int algebraicRules(const gsl_vector * x, void *params, gsl_vector * f) {
     if (IsSpeciesNodeAlgebraic( species )) {
       amount = gsl_vector_get (x, j);
       j++; 
-      SetAmountInSpeciesNode( species, amount );
+      SetSpeciesAmountInSimState( rec->state, i, amount );
     }
   }
   for( i = 0; i < rec->compartmentsSize; i++ ) {
@@ -1527,7 +2618,7 @@ int algebraicRules(const gsl_vector * x, void *params, gsl_vector * f) {
     if (IsCompartmentAlgebraic( compartment )) {
       amount = gsl_vector_get (x, j);
       j++;
-      SetCurrentSizeInCompartment( compartment, amount );
+      SetCompartmentSizeInSimState( rec->state, i, amount );
     }
   }
   for( i = 0; i < rec->symbolsSize; i++ ) {
@@ -1535,13 +2626,13 @@ int algebraicRules(const gsl_vector * x, void *params, gsl_vector * f) {
     if (IsSymbolAlgebraic( symbol )) {
       amount = gsl_vector_get (x, j);
       j++;
-      SetCurrentRealValueInSymbol( symbol, amount );
+      SetSymbolValueInSimState( rec->state, i, amount );
     }
   }
   j = 0;
   for (i = 0; i < rec->rulesSize; i++) {
     if ( GetRuleType( rec->ruleArray[i] ) == RULE_TYPE_ALGEBRAIC ) {
-      amount = rec->evaluator->EvaluateWithCurrentAmountsDeter( rec->evaluator,
+      amount = _EvaluateLawDeter( rec,
 							   (KINETIC_LAW*)GetMathInRule( rec->ruleArray[i] ) );
       gsl_vector_set (f, j, amount);
       j++;
@@ -1575,6 +2666,8 @@ static RET_VAL EvaluateAlgebraicRules( MONTE_CARLO_RECORD *rec ) {
   int status;
   size_t i, j, iter = 0;
   double amount;
+  UINT32 size = 0;
+  UINT32 *reactions = NULL;
 
   const size_t n = rec->algebraicRulesSize;
 
@@ -1626,6 +2719,29 @@ static RET_VAL EvaluateAlgebraicRules( MONTE_CARLO_RECORD *rec ) {
   } while (status == GSL_CONTINUE && iter < 1000);
      
   //printf ("status = %s\n", gsl_strerror (status));
+
+  /* the solver wrote the algebraic variables directly */
+  for( i = 0; i < rec->speciesSize; i++ ) {
+    if (IsSpeciesNodeAlgebraic( rec->speciesArray[i] )) {
+      reactions = GetReactionsDependingOnSpecies( rec->dependencyGraph, i, &size );
+      _MarkReactionsStale( rec, reactions, size );
+      _MarkReadersOfVariable( rec, i );
+    }
+  }
+  for( i = 0; i < rec->compartmentsSize; i++ ) {
+    if (IsCompartmentAlgebraic( rec->compartmentArray[i] )) {
+      reactions = GetReactionsDependingOnCompartment( rec->dependencyGraph, i, &size );
+      _MarkReactionsStale( rec, reactions, size );
+      _MarkReadersOfVariable( rec, rec->speciesSize + i );
+    }
+  }
+  for( i = 0; i < rec->symbolsSize; i++ ) {
+    if (IsSymbolAlgebraic( rec->symbolArray[i] )) {
+      reactions = GetReactionsDependingOnSymbol( rec->dependencyGraph, i, &size );
+      _MarkReactionsStale( rec, reactions, size );
+      _MarkReadersOfVariable( rec, rec->speciesSize + rec->compartmentsSize + i );
+    }
+  }
      
   gsl_multiroot_fsolver_free (s);
   gsl_vector_free (x);
@@ -1654,7 +2770,7 @@ int MonteCarlofastReactions(const gsl_vector * x, void *params, gsl_vector * f)
     if (IsSpeciesNodeFast( species )) {
       amount = gsl_vector_get (x, j);
       j++; 
-      SetAmountInSpeciesNode( species, amount );
+      _SetSpeciesAmount( rec, i, amount );
     }
   }
   _CalculatePropensities( rec );
@@ -1929,7 +3045,7 @@ static RET_VAL ExecuteFastReactions( MONTE_CARLO_RECORD *rec ) {
       //if (IsSpeciesNodeFast( species )) {
       amount = gsl_vector_get (s->x, j);
       j++; 
-      SetAmountInSpeciesNode( species, amount );
+      _SetSpeciesAmount( rec, i, amount );
     }
   }
      
@@ -1940,25 +3056,18 @@ static RET_VAL ExecuteFastReactions( MONTE_CARLO_RECORD *rec ) {
 
 static RET_VAL _UpdateSpeciesValues( MONTE_CARLO_RECORD *rec ) {
     RET_VAL ret = SUCCESS;
-    double stoichiometry = 0;
     double amount = 0;
     double change = 0;
-    SPECIES *species = NULL;
-    IR_EDGE *edge = NULL;
     REACTION *reaction = rec->nextReaction;
-    LINKED_LIST *edges = NULL;
-    KINETIC_LAW_EVALUATER *evaluator = rec->evaluator;
     UINT i = 0;
     UINT j = 0;
     double deltaTime;
     BOOL triggerEnabled;
     BYTE varType;
-    REB2SAC_SYMBOL *speciesRef = NULL;
-    REB2SAC_SYMBOL *convFactor = NULL;
 
     for (i = 0; i < rec->rulesSize; i++) {
       if ( GetRuleType( rec->ruleArray[i] ) == RULE_TYPE_RATE_ASSIGNMENT ) {
-	change = rec->evaluator->EvaluateWithCurrentAmountsDeter( rec->evaluator,
+	change = _EvaluateLawDeter( rec,
 							     (KINETIC_LAW*)GetMathInRule( rec->ruleArray[i] ) );
 	varType = GetRuleVarType( rec->ruleArray[i] );
 	j = GetRuleIndex( rec->ruleArray[i] );
@@ -1986,70 +3095,24 @@ static RET_VAL _UpdateSpeciesValues( MONTE_CARLO_RECORD *rec ) {
 	varType = GetRuleVarType( rec->ruleArray[i] );
 	j = GetRuleIndex( rec->ruleArray[i] );
 	if ( varType == SPECIES_RULE ) {
-	  SetAmountInSpeciesNode( rec->speciesArray[j], amount );
-	  _UpdateReactionRateUpdateTimeForSpecies( rec, rec->speciesArray[j] );
+	  _SetSpeciesAmount( rec, j, amount );
 	} else if ( varType == COMPARTMENT_RULE ) {
-	  SetCurrentSizeInCompartment( rec->compartmentArray[j], amount );
-	  _UpdateAllReactionRateUpdateTimes( rec, rec->time );
+	  _SetCompartmentSize( rec, j, amount );
 	} else {
-	  SetCurrentRealValueInSymbol( rec->symbolArray[j], amount );
-	  _UpdateAllReactionRateUpdateTimes( rec, rec->time );
+	  _SetSymbolValue( rec, j, amount );
 	}
       }
     }
 
     if (reaction) {
-      edges = GetReactantEdges( (IR_NODE*)reaction );
-      ResetCurrentElement( edges );
-      while( ( edge = GetNextEdge( edges ) ) != NULL ) {
-	speciesRef = GetSpeciesRefInIREdge( edge );
-	if (speciesRef) {
-	  stoichiometry = GetCurrentRealValueInSymbol( speciesRef );
-	} else {
-	  stoichiometry = GetStoichiometryInIREdge( edge );
-	}
-        species = GetSpeciesInIREdge( edge );
-	if (( convFactor = GetConversionFactorInSpeciesNode( species ) )!=NULL) {
-	  stoichiometry *= GetCurrentRealValueInSymbol( convFactor );
-	}
-	if (HasBoundaryConditionInSpeciesNode(species)) continue;
-        amount = GetAmountInSpeciesNode( species ) - stoichiometry;
-        TRACE_3( "the amount of %s decreases from %g to %g",
-		 GetCharArrayOfString( GetSpeciesNodeName( species ) ),
-		 GetAmountInSpeciesNode( species ),
-		 amount );
-        SetAmountInSpeciesNode( species, amount );
-        if( IS_FAILED( ( ret = evaluator->SetSpeciesValue( evaluator, species, amount ) ) ) ) {
-            return ret;
-        }
-      }
-      edges = GetProductEdges( (IR_NODE*)reaction );
-      ResetCurrentElement( edges );
-      while( ( edge = GetNextEdge( edges ) ) != NULL ) {
-	speciesRef = GetSpeciesRefInIREdge( edge );
-	if (speciesRef) {
-	  stoichiometry = GetCurrentRealValueInSymbol( speciesRef );
-	} else {
-	  stoichiometry = GetStoichiometryInIREdge( edge );
-	}
-        species = GetSpeciesInIREdge( edge );
-	if (( convFactor = GetConversionFactorInSpeciesNode( species ) )!=NULL) {
-	  stoichiometry *= GetCurrentRealValueInSymbol( convFactor );
-	}
-	if (HasBoundaryConditionInSpeciesNode(species)) continue;
-        amount = GetAmountInSpeciesNode( species ) + stoichiometry;
-        TRACE_3( "the amount of %s increases from %g to %g",
-		 GetCharArrayOfString( GetSpeciesNodeName( species ) ),
-		 GetAmountInSpeciesNode( species ),
-		 amount );
-        SetAmountInSpeciesNode( species, amount );
-      }
+      TRACE_1( "firing %s", GetCharArrayOfString( GetReactionNodeName( reaction ) ) );
+      FireReactionInSimState( rec->state, GetReactionIndex( reaction ), 1.0 );
     }
 
     for (j = 0; j < rec->symbolsSize; j++) {
       if ((strcmp(GetCharArrayOfString( GetSymbolID(rec->symbolArray[j]) ),"t")==0) ||
 	  (strcmp(GetCharArrayOfString( GetSymbolID(rec->symbolArray[j]) ),"time")==0)) {
-	SetCurrentRealValueInSymbol( rec->symbolArray[j], rec->time );
+	_SetSymbolValue( rec, j, rec->time );
       }
     }
 
@@ -2064,84 +3127,581 @@ static RET_VAL _UpdateSpeciesValues( MONTE_CARLO_RECORD *rec ) {
     return ret;
 }
 
-static RET_VAL _UpdateAllReactionRateUpdateTimes( MONTE_CARLO_RECORD *rec, double time ) {
-  RET_VAL ret = SUCCESS;
-  UINT i;
+static void _MarkReactionsStale( MONTE_CARLO_RECORD *rec, UINT32 *reactions, UINT32 size ) {
+  UINT32 i;
+  UINT32 index;
 
-  for (i = 0; i < rec->reactionsSize; i++) {
-    if( IS_FAILED( ( ret = SetReactionRateUpdatedTime( rec->reactionArray[i], time ) ) ) ) {
-      return ret;
+  for (i = 0; i < size; i++) {
+    index = reactions[i];
+    if (!rec->isReactionStale[index]) {
+      rec->isReactionStale[index] = TRUE;
+      rec->staleReactions[rec->staleReactionsSize++] = index;
     }
   }
-  return ret;
 }
 
-static RET_VAL _UpdateReactionRateUpdateTimeForSpecies( MONTE_CARLO_RECORD *rec, SPECIES* species ) {
+static void _MarkAllReactionsStale( MONTE_CARLO_RECORD *rec ) {
+  UINT32 i;
+
+  for (i = 0; i < rec->reactionsSize; i++) {
+    rec->isReactionStale[i] = TRUE;
+    rec->staleReactions[i] = i;
+  }
+  rec->staleReactionsSize = rec->reactionsSize;
+}
+
+static void _MarkReactionsAffectedByFiring( MONTE_CARLO_RECORD *rec ) {
+  UINT32 k = 0;
+  UINT32 index = 0;
+  UINT32 size = 0;
+  UINT32 *reactions = NULL;
+  SIM_STATE *state = rec->state;
+
+  if (rec->nextReaction == NULL) {
+    return;
+  }
+  rec->firedReaction = rec->nextReaction;
+  index = GetReactionIndex( rec->nextReaction );
+  reactions = GetAffectedReactionsInDependencyGraph( rec->dependencyGraph, index, &size );
+  _MarkReactionsStale( rec, reactions, size );
+  for (k = state->stoichiometryOffsets[index]; k < state->stoichiometryOffsets[index+1]; k++) {
+    _MarkReadersOfVariable( rec, state->stoichiometrySpecies[k] );
+  }
+}
+
+/* 
+ * The setters below mark the reactions and the event triggers reading a variable only when 
+ * its value changes, so assignment rules that are re-evaluated every step cost nothing while 
+ * they are steady. 
+ */
+static void _SetSpeciesAmount( MONTE_CARLO_RECORD *rec, UINT32 index, double amount ) {
+  UINT32 size = 0;
+  UINT32 *reactions = NULL;
+
+  if (rec->state->amounts[index] == amount) {
+    return;
+  }
+  SetSpeciesAmountInSimState( rec->state, index, amount );
+  reactions = GetReactionsDependingOnSpecies( rec->dependencyGraph, index, &size );
+  _MarkReactionsStale( rec, reactions, size );
+  _MarkReadersOfVariable( rec, index );
+}
+
+static void _SetCompartmentSize( MONTE_CARLO_RECORD *rec, UINT32 index, double size ) {
+  UINT32 reactionsSize = 0;
+  UINT32 *reactions = NULL;
+
+  if (rec->state->sizes[index] == size) {
+    return;
+  }
+  SetCompartmentSizeInSimState( rec->state, index, size );
+  reactions = GetReactionsDependingOnCompartment( rec->dependencyGraph, index, &reactionsSize );
+  _MarkReactionsStale( rec, reactions, reactionsSize );
+  _MarkReadersOfVariable( rec, rec->speciesSize + index );
+}
+
+static void _SetSymbolValue( MONTE_CARLO_RECORD *rec, UINT32 index, double value ) {
+  UINT32 size = 0;
+  UINT32 *reactions = NULL;
+
+  if (rec->state->params[index] == value) {
+    return;
+  }
+  SetSymbolValueInSimState( rec->state, index, value );
+  reactions = GetReactionsDependingOnSymbol( rec->dependencyGraph, index, &size );
+  _MarkReactionsStale( rec, reactions, size );
+  _MarkReadersOfVariable( rec, rec->speciesSize + rec->compartmentsSize + index );
+}
+/*
+ * Indexes, for every variable of the state, the events whose trigger reads it, so that a 
+ * trigger is re-evaluated only after one of its inputs changed.  Triggers that can change 
+ * while their inputs do not are volatile and checked on every pass.
+ */
+static RET_VAL _InitializeEventDependencies( MONTE_CARLO_RECORD *rec ) {
     RET_VAL ret = SUCCESS;
-    double time = rec->time;
-    IR_EDGE *updateEdge = NULL;
-    REACTION *reaction = NULL;
-    LINKED_LIST *updateEdges = NULL;
+    UINT32 i = 0;
+    KINETIC_LAW **triggers = NULL;
+
+    if( rec->eventsSize == 0 ) {
+        return SUCCESS;
+    }
+    if( ( rec->eventQueue = CreateNextReactionQueue( rec->eventsSize ) ) == NULL ) {
+        return ErrorReport( FAILING, "_InitializeEventDependencies", "could not create event queue" );
+    }
+    if( ( ( rec->isEventVolatile = (BYTE*)MALLOC( rec->eventsSize * sizeof(BYTE) ) ) == NULL ) ||
+        ( ( rec->volatileEvents = (UINT32*)MALLOC( rec->eventsSize * sizeof(UINT32) ) ) == NULL ) ||
+        ( ( rec->isEventStale = (BYTE*)MALLOC( rec->eventsSize * sizeof(BYTE) ) ) == NULL ) ||
+        ( ( rec->staleEvents = (UINT32*)MALLOC( rec->eventsSize * sizeof(UINT32) ) ) == NULL ) ||
+        ( ( rec->isEventToCheck = (BYTE*)MALLOC( rec->eventsSize * sizeof(BYTE) ) ) == NULL ) ||
+        ( ( rec->eventsToCheck = (UINT32*)MALLOC( rec->eventsSize * sizeof(UINT32) ) ) == NULL ) ||
+        ( ( triggers = (KINETIC_LAW**)MALLOC( rec->eventsSize * sizeof(KINETIC_LAW*) ) ) == NULL ) ) {
+        return ErrorReport( FAILING, "_InitializeEventDependencies", "could not allocate memory for event dependencies" );
+    }
+    for( i = 0; i < rec->eventsSize; i++ ) {
+        triggers[i] = (KINETIC_LAW*)GetTriggerInEvent( rec->eventArray[i] );
+    }
+    if( IS_FAILED( ( ret = _IndexReaders( rec, triggers, rec->eventsSize, 
+                                          &(rec->eventReaderOffsets), &(rec->eventReaders), rec->isEventVolatile ) ) ) ) {
+        FREE( triggers );
+        return ErrorReport( ret, "_InitializeEventDependencies", "could not index the trigger inputs" );
+    }
+    FREE( triggers );
+    rec->volatileEventsSize = 0;
+    for( i = 0; i < rec->eventsSize; i++ ) {
+        if( rec->isEventVolatile[i] ) {
+            rec->volatileEvents[rec->volatileEventsSize++] = i;
+        }
+    }
+    return SUCCESS;
+}
 
-    updateEdges = GetReactantEdges( (IR_NODE*)species );
-    ResetCurrentElement( updateEdges );
-    while( ( updateEdge = GetNextEdge( updateEdges ) ) != NULL ) {
-      reaction = GetReactionInIREdge( updateEdge );
-      if( IS_FAILED( ( ret = SetReactionRateUpdatedTime( reaction, time ) ) ) ) {
-	return ret;
-      }
+/*
+ * Sorts the initial assignments and the assignment rules so that each is evaluated after 
+ * the ones assigning the variables it reads, and indexes the assignment rules reading each 
+ * variable, so that a rule is re-evaluated only after one of its inputs changed.
+ */
+static RET_VAL _InitializeAssignmentOrder( MONTE_CARLO_RECORD *rec ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 size = rec->state->valuesSize;
+    UINT32 *targets = NULL;
+    UINT32 *offsets = NULL;
+    UINT32 *readers = NULL;
+    KINETIC_LAW **laws = NULL;
+
+    if( size > 0 ) {
+        if( ( ( laws = (KINETIC_LAW**)MALLOC( size * sizeof(KINETIC_LAW*) ) ) == NULL ) ||
+            ( ( targets = (UINT32*)MALLOC( size * sizeof(UINT32) ) ) == NULL ) ||
+            ( ( rec->initialAssignmentOrder = (UINT32*)MALLOC( size * sizeof(UINT32) ) ) == NULL ) ) {
+            ret = ErrorReport( FAILING, "_InitializeAssignmentOrder", "could not allocate memory for initial assignments" );
+            goto CLEANUP;
+        }
+        for( i = 0; i < rec->speciesSize; i++ ) {
+            laws[i] = (KINETIC_LAW*)GetInitialAssignmentInSpeciesNode( rec->speciesArray[i] );
+        }
+        for( i = 0; i < rec->compartmentsSize; i++ ) {
+            laws[rec->speciesSize + i] = (KINETIC_LAW*)GetInitialAssignmentInCompartment( rec->compartmentArray[i] );
+        }
+        for( i = 0; i < rec->symbolsSize; i++ ) {
+            laws[rec->speciesSize + rec->compartmentsSize + i] = (KINETIC_LAW*)GetInitialAssignmentInSymbol( rec->symbolArray[i] );
+        }
+        for( i = 0; i < size; i++ ) {
+            targets[i] = ( laws[i] == NULL ) ? SIM_STATE_NO_INDEX : i;
+        }
+        if( IS_FAILED( ( ret = _IndexReaders( rec, laws, size, &offsets, &readers, NULL ) ) ) || 
+            IS_FAILED( ( ret = _SortAssignments( rec, targets, size, offsets, readers, 
+                                                 rec->initialAssignmentOrder, &(rec->initialAssignmentsSize), "initial assignments" ) ) ) ) {
+            goto CLEANUP;
+        }
+        FREE( laws );
+        FREE( targets );
+        FREE( offsets );
+        FREE( readers );
+    }
+
+    if( rec->rulesSize > 0 ) {
+        if( ( ( laws = (KINETIC_LAW**)MALLOC( rec->rulesSize * sizeof(KINETIC_LAW*) ) ) == NULL ) ||
+            ( ( targets = (UINT32*)MALLOC( rec->rulesSize * sizeof(UINT32) ) ) == NULL ) ||
+            ( ( rec->assignmentRuleOrder = (UINT32*)MALLOC( rec->rulesSize * sizeof(UINT32) ) ) == NULL ) ||
+            ( ( rec->isRuleVolatile = (BYTE*)MALLOC( rec->rulesSize * sizeof(BYTE) ) ) == NULL ) ||
+            ( ( rec->isRuleStale = (BYTE*)MALLOC( rec->rulesSize * sizeof(BYTE) ) ) == NULL ) ) {
+            ret = ErrorReport( FAILING, "_InitializeAssignmentOrder", "could not allocate memory for assignment rules" );
+            goto CLEANUP;
+        }
+        for( i = 0; i < rec->rulesSize; i++ ) {
+            targets[i] = SIM_STATE_NO_INDEX;
+            if( GetRuleType( rec->ruleArray[i] ) != RULE_TYPE_ASSIGNMENT ) {
+                continue;
+            }
+            laws[i] = (KINETIC_LAW*)GetMathInRule( rec->ruleArray[i] );
+            targets[i] = GetRuleIndex( rec->ruleArray[i] );
+            if( GetRuleVarType( rec->ruleArray[i] ) == COMPARTMENT_RULE ) {
+                targets[i] += rec->speciesSize;
+            }
+            else if( GetRuleVarType( rec->ruleArray[i] ) != SPECIES_RULE ) {
+                targets[i] += rec->speciesSize + rec->compartmentsSize;
+            }
+        }
+        if( IS_FAILED( ( ret = _IndexReaders( rec, laws, rec->rulesSize, 
+                                              &(rec->ruleReaderOffsets), &(rec->ruleReaders), rec->isRuleVolatile ) ) ) || 
+            IS_FAILED( ( ret = _SortAssignments( rec, targets, rec->rulesSize, rec->ruleReaderOffsets, rec->ruleReaders, 
+                                                 rec->assignmentRuleOrder, &(rec->assignmentRulesSize), "assignment rules" ) ) ) ) {
+            goto CLEANUP;
+        }
     }
 
-    updateEdges = GetModifierEdges( (IR_NODE*)species );
-    ResetCurrentElement( updateEdges );
-    while( ( updateEdge = GetNextEdge( updateEdges ) ) != NULL ) {
-      reaction = GetReactionInIREdge( updateEdge );
-      if( IS_FAILED( ( ret = SetReactionRateUpdatedTime( reaction, time ) ) ) ) {
-	return ret;
-      }
+CLEANUP:
+    FREE( laws );
+    FREE( targets );
+    FREE( offsets );
+    FREE( readers );
+    return ret;
+}
+
+/*
+ * Indexes, for every variable of the state, the laws reading it: the readers of variable v 
+ * are readers[offsets[v], offsets[v+1]), in index order.  NULL laws read nothing.  If 
+ * isVolatile is not NULL, it flags the laws that can change while their inputs do not.
+ */
+static RET_VAL _IndexReaders( MONTE_CARLO_RECORD *rec, KINETIC_LAW **laws, UINT32 lawsSize, 
+                              UINT32 **offsets, UINT32 **readers, BYTE *isVolatile ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 k = 0;
+    UINT32 size = rec->state->valuesSize;
+    UINT32 readsSize = 0;
+    UINT32 *reads = NULL;
+    UINT32 *starts = NULL;
+    BYTE *marks = NULL;
+
+    if( ( ( starts = (UINT32*)MALLOC( ( size + 1 ) * sizeof(UINT32) ) ) == NULL ) ||
+        ( ( reads = (UINT32*)MALLOC( ( size + 1 ) * sizeof(UINT32) ) ) == NULL ) ||
+        ( ( marks = (BYTE*)MALLOC( ( size + 1 ) * sizeof(BYTE) ) ) == NULL ) ) {
+        ret = ErrorReport( FAILING, "_IndexReaders", "could not allocate memory for the readers" );
+        goto CLEANUP;
+    }
+
+    /* count the readers of every variable */
+    for( i = 0; i < lawsSize; i++ ) {
+        readsSize = 0;
+        if( !_FindVariablesRead( rec, laws[i], marks, reads, &readsSize ) && ( isVolatile != NULL ) ) {
+            isVolatile[i] = TRUE;
+        }
+        for( k = 0; k < readsSize; k++ ) {
+            marks[reads[k]] = 0;
+            starts[reads[k] + 1]++;
+        }
+    }
+    for( k = 0; k < size; k++ ) {
+        starts[k + 1] += starts[k];
+    }
+    if( starts[size] > 0 ) {
+        if( ( *readers = (UINT32*)MALLOC( starts[size] * sizeof(UINT32) ) ) == NULL ) {
+            ret = ErrorReport( FAILING, "_IndexReaders", "could not allocate memory for the readers" );
+            goto CLEANUP;
+        }
     }
 
-    updateEdges = GetProductEdges( (IR_NODE*)species );
-    ResetCurrentElement( updateEdges );
-    while( ( updateEdge = GetNextEdge( updateEdges ) ) != NULL ) {
-      reaction = GetReactionInIREdge( updateEdge );
-      if( IS_FAILED( ( ret = SetReactionRateUpdatedTime( reaction, time ) ) ) ) {
-	return ret;
-      }
+    /* fill them in, advancing each start to the start of the next variable */
+    for( i = 0; i < lawsSize; i++ ) {
+        readsSize = 0;
+        _FindVariablesRead( rec, laws[i], marks, reads, &readsSize );
+        for( k = 0; k < readsSize; k++ ) {
+            marks[reads[k]] = 0;
+            (*readers)[starts[reads[k]]++] = i;
+        }
+    }
+    for( k = size; k > 0; k-- ) {
+        starts[k] = starts[k - 1];
     }
+    starts[0] = 0;
+    *offsets = starts;
+    starts = NULL;
+
+CLEANUP:
+    FREE( starts );
+    FREE( reads );
+    FREE( marks );
     return ret;
 }
 
-static RET_VAL _UpdateReactionRateUpdateTime( MONTE_CARLO_RECORD *rec ) {
+/*
+ * Orders the assignments so that each comes after the ones assigning the variables it reads 
+ * (Kahn's algorithm); targets[k] is the variable assignment k assigns, or SIM_STATE_NO_INDEX 
+ * if there is no assignment k.  The variables on a cycle are named in the error.
+ */
+static RET_VAL _SortAssignments( MONTE_CARLO_RECORD *rec, UINT32 *targets, UINT32 size, UINT32 *offsets, UINT32 *readers, 
+                                 UINT32 *order, UINT32 *orderSize, char *kind ) {
     RET_VAL ret = SUCCESS;
-    double rate = 0.0;
-    IR_EDGE *edge = NULL;
-    LINKED_LIST *edges = NULL;
+    UINT32 i = 0;
+    UINT32 j = 0;
+    UINT32 k = 0;
+    UINT32 n = 0;
+    UINT32 present = 0;
+    UINT32 length = 0;
+    UINT32 *inDegrees = NULL;
+    BOOL changed = FALSE;
+    BOOL isRead = FALSE;
+    char *names = NULL;
+    char *name = NULL;
+
+    if( ( inDegrees = (UINT32*)MALLOC( size * sizeof(UINT32) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_SortAssignments", "could not allocate memory for the in-degrees" );
+    }
+    for( j = 0; j < size; j++ ) {
+        if( targets[j] == SIM_STATE_NO_INDEX ) {
+            continue;
+        }
+        for( k = offsets[targets[j]]; k < offsets[targets[j] + 1]; k++ ) {
+            inDegrees[readers[k]]++;
+        }
+    }
+    for( j = 0; j < size; j++ ) {
+        if( targets[j] != SIM_STATE_NO_INDEX ) {
+            present++;
+            if( inDegrees[j] == 0 ) {
+                order[n++] = j;
+            }
+        }
+    }
+    for( i = 0; i < n; i++ ) {
+        j = order[i];
+        for( k = offsets[targets[j]]; k < offsets[targets[j] + 1]; k++ ) {
+            if( --inDegrees[readers[k]] == 0 ) {
+                order[n++] = readers[k];
+            }
+        }
+    }
+    *orderSize = n;
+    if( n == present ) {
+        FREE( inDegrees );
+        return SUCCESS;
+    }
+
+    /* what is left reads a cycle; drop the assignments no other one left reads */
+    do {
+        changed = FALSE;
+        for( j = 0; j < size; j++ ) {
+            if( inDegrees[j] == 0 ) {
+                continue;
+            }
+            isRead = FALSE;
+            for( k = offsets[targets[j]]; k < offsets[targets[j] + 1]; k++ ) {
+                if( inDegrees[readers[k]] > 0 ) {
+                    isRead = TRUE;
+                    break;
+                }
+            }
+            if( !isRead ) {
+                inDegrees[j] = 0;
+                changed = TRUE;
+            }
+        }
+    } while( changed );
+    for( j = 0; j < size; j++ ) {
+        if( inDegrees[j] > 0 ) {
+            length += strlen( _GetVariableName( rec, targets[j] ) ) + 2;
+        }
+    }
+    if( ( names = (char*)MALLOC( length + 1 ) ) == NULL ) {
+        FREE( inDegrees );
+        return ErrorReport( FAILING, "_SortAssignments", "cycle detected in %s", kind );
+    }
+    for( j = 0; j < size; j++ ) {
+        if( inDegrees[j] > 0 ) {
+            name = _GetVariableName( rec, targets[j] );
+            if( names[0] != '\0' ) {
+                strcat( names, ", " );
+            }
+            strcat( names, name );
+        }
+    }
+    ret = ErrorReport( FAILING, "_SortAssignments", "cycle detected in %s of %s", kind, names );
+    FREE( names );
+    FREE( inDegrees );
+    return ret;
+}
+
+static char *_GetVariableName( MONTE_CARLO_RECORD *rec, UINT32 index ) {
+    if( index < rec->speciesSize ) {
+        return GetCharArrayOfString( GetSpeciesNodeID( rec->speciesArray[index] ) );
+    }
+    index -= rec->speciesSize;
+    if( index < rec->compartmentsSize ) {
+        return GetCharArrayOfString( GetCompartmentID( rec->compartmentArray[index] ) );
+    }
+    index -= rec->compartmentsSize;
+    return GetCharArrayOfString( GetSymbolID( rec->symbolArray[index] ) );
+}
+
+/*
+ * Collects the variables of the state the law reads into reads, once each, and returns 
+ * FALSE if its value or the time findNextTime predicts for it can change while none of them 
+ * does: it reads the time, a function symbol or a variable outside the state, or it uses a 
+ * delay, a rate or a random operator, whose samples findNextTime draws.
+ */
+static BOOL _FindVariablesRead( MONTE_CARLO_RECORD *rec, KINETIC_LAW *law, BYTE *marks, UINT32 *reads, UINT32 *readsSize ) {
+    UINT32 i = 0;
+    UINT32 index = 0;
+    BOOL isSteady = TRUE;
+    char *id = NULL;
+    CADDR_T node = NULL;
     SPECIES *species = NULL;
+    KINETIC_LAW *child = NULL;
+    LINKED_LIST *children = NULL;
+
+    if( law == NULL ) {
+        return TRUE;
+    }
+    if( IsFunctionSymbolKineticLaw( law ) ) {
+        return FALSE;
+    }
+    if( IsSpeciesKineticLaw( law ) ) {
+        species = GetSpeciesFromKineticLaw( law );
+        node = (CADDR_T)species;
+        /* a concentration also reads the size of the compartment */
+        if( !HasOnlySubstanceUnitsInSpeciesNode( species ) && 
+            FindVariableInSimState( rec->state, (CADDR_T)GetCompartmentInSpeciesNode( species ), &index ) && 
+            !marks[index] ) {
+            marks[index] = 1;
+            reads[(*readsSize)++] = index;
+        }
+    }
+    else if( IsCompartmentKineticLaw( law ) ) {
+        node = (CADDR_T)GetCompartmentFromKineticLaw( law );
+    }
+    else if( IsSymbolKineticLaw( law ) ) {
+        node = (CADDR_T)GetSymbolFromKineticLaw( law );
+        id = GetCharArrayOfString( GetSymbolID( (REB2SAC_SYMBOL*)node ) );
+        if( ( strcmp( id, "t" ) == 0 ) || ( strcmp( id, "time" ) == 0 ) ) {
+            isSteady = FALSE;
+        }
+    }
+    if( node != NULL ) {
+        if( !FindVariableInSimState( rec->state, node, &index ) ) {
+            return FALSE;
+        }
+        if( !marks[index] ) {
+            marks[index] = 1;
+            reads[(*readsSize)++] = index;
+        }
+        return isSteady;
+    }
+    if( IsOpKineticLaw( law ) ) {
+        switch( GetOpTypeFromKineticLaw( law ) ) {
+            case KINETIC_LAW_OP_DELAY:
+            case KINETIC_LAW_OP_UNIFORM:
+            case KINETIC_LAW_OP_NORMAL:
+            case KINETIC_LAW_OP_GAMMA:
+            case KINETIC_LAW_OP_BINOMIAL:
+            case KINETIC_LAW_OP_LOGNORMAL:
+                isSteady = FALSE;
+            break;
+        }
+        if( !_FindVariablesRead( rec, GetOpLeftFromKineticLaw( law ), marks, reads, readsSize ) ) {
+            isSteady = FALSE;
+        }
+        if( !_FindVariablesRead( rec, GetOpRightFromKineticLaw( law ), marks, reads, readsSize ) ) {
+            isSteady = FALSE;
+        }
+        return isSteady;
+    }
+    if( IsUnaryOpKineticLaw( law ) ) {
+        switch( GetUnaryOpTypeFromKineticLaw( law ) ) {
+            case KINETIC_LAW_UNARY_OP_EXPRAND:
+            case KINETIC_LAW_UNARY_OP_POISSON:
+            case KINETIC_LAW_UNARY_OP_CHISQ:
+            case KINETIC_LAW_UNARY_OP_LAPLACE:
+            case KINETIC_LAW_UNARY_OP_CAUCHY:
+            case KINETIC_LAW_UNARY_OP_RAYLEIGH:
+            case KINETIC_LAW_UNARY_OP_BERNOULLI:
+            case KINETIC_LAW_UNARY_OP_RATE:
+                isSteady = FALSE;
+            break;
+        }
+        if( !_FindVariablesRead( rec, GetUnaryOpChildFromKineticLaw( law ), marks, reads, readsSize ) ) {
+            isSteady = FALSE;
+        }
+        return isSteady;
+    }
+    if( IsPWKineticLaw( law ) ) {
+        children = GetPWChildrenFromKineticLaw( law );
+        for( i = 0; i < GetLinkedListSize( children ); i++ ) {
+            child = (KINETIC_LAW*)GetElementByIndex( i, children );
+            if( !_FindVariablesRead( rec, child, marks, reads, readsSize ) ) {
+                isSteady = FALSE;
+            }
+        }
+    }
+    return isSteady;
+}
+
+/* marks the event triggers and the assignment rules reading the variable */
+static void _MarkReadersOfVariable( MONTE_CARLO_RECORD *rec, UINT32 index ) {
+  UINT32 k = 0;
+  UINT32 event = 0;
 
-    if (rec->nextReaction == NULL) {
-      return ret;
+  if (rec->ruleReaderOffsets != NULL) {
+    for (k = rec->ruleReaderOffsets[index]; k < rec->ruleReaderOffsets[index+1]; k++) {
+      rec->isRuleStale[rec->ruleReaders[k]] = TRUE;
     }
-    edges = GetReactantEdges( (IR_NODE*)rec->nextReaction );
-    ResetCurrentElement( edges );
-    while( ( edge = GetNextEdge( edges ) ) != NULL ) {
-        species = GetSpeciesInIREdge( edge );
-	if( IS_FAILED( ( ret = _UpdateReactionRateUpdateTimeForSpecies( rec, species ) ) ) ) {
-	  return ret;
-	}
+  }
+  if (rec->eventReaderOffsets != NULL) {
+    for (k = rec->eventReaderOffsets[index]; k < rec->eventReaderOffsets[index+1]; k++) {
+      event = rec->eventReaders[k];
+      if (!rec->isEventStale[event]) {
+        rec->isEventStale[event] = TRUE;
+        rec->staleEvents[rec->staleEventsSize++] = event;
+      }
     }
+  }
+}
 
-    edges = GetProductEdges( (IR_NODE*)rec->nextReaction );
-    ResetCurrentElement( edges );
-    while( ( edge = GetNextEdge( edges ) ) != NULL ) {
-        species = GetSpeciesInIREdge( edge );
-	if( IS_FAILED( ( ret = _UpdateReactionRateUpdateTimeForSpecies( rec, species ) ) ) ) {
-	  return ret;
-	}
+static void _MarkAllEventsStale( MONTE_CARLO_RECORD *rec ) {
+  UINT32 i;
+
+  for (i = 0; i < rec->eventsSize; i++) {
+    rec->isEventStale[i] = TRUE;
+    rec->staleEvents[i] = i;
+  }
+  rec->staleEventsSize = rec->eventsSize;
+}
+
+/* sets the time the event fires, or -1 if it is not scheduled, in the event and the queue */
+static void _ScheduleEvent( MONTE_CARLO_RECORD *rec, UINT32 index, double time ) {
+  SetNextEventTimeInEvent( rec->eventArray[index], time );
+  SetFiringTimeInNextReactionQueue( rec->eventQueue, index, 0.0, ( time == -1.0 ) ? DBL_MAX : time );
+}
+
+/* 
+ * Collects the stale, the volatile and the due events into eventsToCheck, in index order, 
+ * and clears the stale events. 
+ */
+static UINT32 _CollectEventsToCheck( MONTE_CARLO_RECORD *rec, double time ) {
+  UINT32 k = 0;
+  UINT32 index = 0;
+  UINT32 size = 0;
+
+  for (k = 0; k < rec->staleEventsSize; k++) {
+    index = rec->staleEvents[k];
+    rec->isEventStale[index] = FALSE;
+    rec->isEventToCheck[index] = TRUE;
+    rec->eventsToCheck[size++] = index;
+  }
+  rec->staleEventsSize = 0;
+  for (k = 0; k < rec->volatileEventsSize; k++) {
+    index = rec->volatileEvents[k];
+    if (!rec->isEventToCheck[index]) {
+      rec->isEventToCheck[index] = TRUE;
+      rec->eventsToCheck[size++] = index;
     }
-    return ret;
+  }
+  /* pop the due events; they are pushed back below with their times unchanged */
+  while (GetNextFiringTimeInNextReactionQueue( rec->eventQueue ) <= time) {
+    index = GetNextReactionInNextReactionQueue( rec->eventQueue );
+    SetFiringTimeInNextReactionQueue( rec->eventQueue, index, 0.0, DBL_MAX );
+    if (!rec->isEventToCheck[index]) {
+      rec->isEventToCheck[index] = TRUE;
+      rec->eventsToCheck[size++] = index;
+    }
+  }
+  for (k = 0; k < size; k++) {
+    index = rec->eventsToCheck[k];
+    rec->isEventToCheck[index] = FALSE;
+    _ScheduleEvent( rec, index, GetNextEventTimeInEvent( rec->eventArray[index] ) );
+  }
+  qsort( rec->eventsToCheck, size, sizeof(UINT32), _CompareEventIndices );
+  return size;
+}
+
+static int _CompareEventIndices( const void *a, const void *b ) {
+  UINT32 i = *(const UINT32*)a;
+  UINT32 j = *(const UINT32*)b;
+
+  return ( i < j ) ? -1 : ( ( i > j ) ? 1 : 0 );
 }
 
+
 static int _ComparePropensity( REACTION *a, REACTION *b ) {
     double d1 = 0.0;
     double d2 = 0.0;
@@ -21,9 +21,16 @@
 #define HAVE_MONTE_CARLO
 
 #include "simulation_method.h"
+#include "sum_tree.h"
+#include "dependency_graph.h"
+#include "sim_state.h"
+#include "next_reaction_simulation.h"
+#include "kinetic_law_program.h"
 
 BEGIN_C_NAMESPACE
 
+#define MONTE_CARLO_UNIFORMS_BLOCK_SIZE 64
+
 
 DLLSCOPE RET_VAL STDCALL DoMonteCarloAnalysis( BACK_END_PROCESSOR *backend, IR *ir );
 DLLSCOPE RET_VAL STDCALL CloseMonteCarloAnalyzer( BACK_END_PROCESSOR *backend );
@@ -33,6 +40,31 @@ DLLSCOPE RET_VAL STDCALL CloseMonteCarloAnalyzer( BACK_END_PROCESSOR *backend );
 #define GET_SEED_FROM_COMMAND_LINE 1
 #endif
 
+/*
+ * State of the tau-leaping method.  The species each reaction changes are read from the 
+ * stoichiometry matrix of the SIM_STATE; the arrays are scratch space indexed by reaction 
+ * or by species.
+ */
+typedef struct {
+    BOOL implicit;
+    double epsilon;
+    UINT32 criticalFirings;
+    double ssaFactor;
+    UINT32 ssaSteps;
+    UINT32 ssaStepsLeft;
+    double tau;
+    double *firings;
+    double *firingLimits;
+    BYTE *isCritical;
+    double *speciesChanges;
+    double *drifts;
+    double *variances;
+    double *orderFactors;
+    double *amounts;
+    UINT32 *implicitSpecies;
+    UINT32 implicitSpeciesSize;
+} MONTE_CARLO_TAU_LEAP;
+
 typedef struct {
     char *encoding;
     REACTION **reactionArray;
@@ -68,11 +100,45 @@ typedef struct {
     double timeStep;
     KINETIC_LAW_EVALUATER *evaluator;
     KINETIC_LAW_FIND_NEXT_TIME *findNextTime;
+    SIM_STATE *state;
+    KINETIC_LAW_COMPILER *compiler;
+    KINETIC_LAW_PROGRAM **propensityPrograms;
+    RANDOM_NUMBER_CONTEXT *randomNumberContext;
+    double uniforms[MONTE_CARLO_UNIFORMS_BLOCK_SIZE];
+    UINT32 uniformsIndex;
     double totalPropensities;
+    SUM_TREE *propensityTree;
+    NEXT_REACTION_DEPENDENCY_GRAPH *dependencyGraph;
+    UINT32 *staleReactions;
+    UINT32 staleReactionsSize;
+    BYTE *isReactionStale;
+    NEXT_REACTION_QUEUE *nextReactionQueue;
+    UINT32 *initialAssignmentOrder;
+    UINT32 initialAssignmentsSize;
+    UINT32 *assignmentRuleOrder;
+    UINT32 assignmentRulesSize;
+    UINT32 *ruleReaderOffsets;
+    UINT32 *ruleReaders;
+    BYTE *isRuleVolatile;
+    BYTE *isRuleStale;
+    NEXT_REACTION_QUEUE *eventQueue;
+    UINT32 *eventReaderOffsets;
+    UINT32 *eventReaders;
+    BYTE *isEventVolatile;
+    UINT32 *volatileEvents;
+    UINT32 volatileEventsSize;
+    UINT32 *staleEvents;
+    UINT32 staleEventsSize;
+    BYTE *isEventStale;
+    UINT32 *eventsToCheck;
+    BYTE *isEventToCheck;
+    REACTION *firedReaction;
+    MONTE_CARLO_TAU_LEAP *tauLeap;
     UINT32 seed;
     UINT32 runs; 
     char *outDir; 
     int startIndex;
+    UINT32 threads;
 } MONTE_CARLO_RECORD;
 
 
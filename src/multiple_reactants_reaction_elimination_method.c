@@ -221,18 +221,17 @@ static RET_VAL _DoTransformation( ABSTRACTION_METHOD *method, IR *ir, REACTION *
 
 
 static BOOL _FindSpecies( KINETIC_LAW *kineticLaw, SPECIES *species ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     BOOL flag = FALSE;
     
     START_FUNCTION("_FindSpecies");
     
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToFindSpecies;
-        visitor.VisitInt = _VisitIntToFindSpecies;
-        visitor.VisitReal = _VisitRealToFindSpecies;
-        visitor.VisitSpecies = _VisitSpeciesToFindSpecies;
-        visitor.VisitSymbol = _VisitSymbolToFindSpecies;
-    }
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToFindSpecies;
+    visitor.VisitInt = _VisitIntToFindSpecies;
+    visitor.VisitReal = _VisitRealToFindSpecies;
+    visitor.VisitSpecies = _VisitSpeciesToFindSpecies;
+    visitor.VisitSymbol = _VisitSymbolToFindSpecies;
     
     visitor._internal1 = (CADDR_T)species;
     visitor._internal2 = (CADDR_T)(&flag);
@@ -1,6 +1,6 @@
 /***************************************************************************
  *   Copyright (C) 2004 by Hiroyuki Kuwahara                               *
- *   kuwahara@cs.utah.edu                                                  *
+ *   kuwahara@cs.utah.edu                                                 *
  *                                                                         *
  *   This program is free software; you can redistribute it and/or modify  *
  *   it under the terms of the GNU General Public License as published by  *
@@ -17,4 +17,143 @@
  *   Free Software Foundation, Inc.,                                       *
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
+#include <float.h>
 #include "next_reaction_simulation.h"
+
+static void _SiftUp( NEXT_REACTION_QUEUE *queue, UINT32 position );
+static void _SiftDown( NEXT_REACTION_QUEUE *queue, UINT32 position );
+static void _Swap( NEXT_REACTION_QUEUE *queue, UINT32 a, UINT32 b );
+
+DLLSCOPE NEXT_REACTION_QUEUE * STDCALL CreateNextReactionQueue( UINT32 size ) {
+    NEXT_REACTION_QUEUE *queue = NULL;
+    UINT32 allocated = GET_MAX( size, 1 );
+
+    START_FUNCTION("CreateNextReactionQueue");
+
+    if( ( queue = (NEXT_REACTION_QUEUE*)MALLOC( sizeof(NEXT_REACTION_QUEUE) ) ) == NULL ) {
+        END_FUNCTION("CreateNextReactionQueue", FAILING );
+        return NULL;
+    }
+    queue->size = size;
+    if( ( ( queue->times = (double*)CALLOC( allocated, sizeof(double) ) ) == NULL ) ||
+        ( ( queue->propensities = (double*)CALLOC( allocated, sizeof(double) ) ) == NULL ) ||
+        ( ( queue->heap = (UINT32*)CALLOC( allocated, sizeof(UINT32) ) ) == NULL ) ||
+        ( ( queue->positions = (UINT32*)CALLOC( allocated, sizeof(UINT32) ) ) == NULL ) ) {
+        FreeNextReactionQueue( &queue );
+        END_FUNCTION("CreateNextReactionQueue", FAILING );
+        return NULL;
+    }
+    ResetNextReactionQueue( queue );
+
+    END_FUNCTION("CreateNextReactionQueue", SUCCESS );
+    return queue;
+}
+
+DLLSCOPE RET_VAL STDCALL FreeNextReactionQueue( NEXT_REACTION_QUEUE **queue ) {
+    RET_VAL ret = SUCCESS;
+
+    START_FUNCTION("FreeNextReactionQueue");
+
+    if( ( queue == NULL ) || ( *queue == NULL ) ) {
+        END_FUNCTION("FreeNextReactionQueue", SUCCESS );
+        return ret;
+    }
+    FREE( (*queue)->times );
+    FREE( (*queue)->propensities );
+    FREE( (*queue)->heap );
+    FREE( (*queue)->positions );
+    FREE( *queue );
+
+    END_FUNCTION("FreeNextReactionQueue", SUCCESS );
+    return ret;
+}
+
+DLLSCOPE RET_VAL STDCALL ResetNextReactionQueue( NEXT_REACTION_QUEUE *queue ) {
+    UINT32 i = 0;
+
+    for( i = 0; i < queue->size; i++ ) {
+        queue->times[i] = DBL_MAX;
+        queue->propensities[i] = 0.0;
+        queue->heap[i] = i;
+        queue->positions[i] = i;
+    }
+    return SUCCESS;
+}
+
+DLLSCOPE RET_VAL STDCALL SetFiringTimeInNextReactionQueue( NEXT_REACTION_QUEUE *queue, UINT32 index, double propensity, double time ) {
+    double oldTime = 0.0;
+
+    if( index >= queue->size ) {
+        return ErrorReport( FAILING, "SetFiringTimeInNextReactionQueue", "index %lu is out of range", index );
+    }
+    oldTime = queue->times[index];
+    queue->times[index] = time;
+    queue->propensities[index] = propensity;
+    if( time < oldTime ) {
+        _SiftUp( queue, queue->positions[index] );
+    }
+    else if( time > oldTime ) {
+        _SiftDown( queue, queue->positions[index] );
+    }
+    return SUCCESS;
+}
+
+DLLSCOPE double STDCALL GetFiringTimeInNextReactionQueue( NEXT_REACTION_QUEUE *queue, UINT32 index ) {
+    return queue->times[index];
+}
+
+DLLSCOPE double STDCALL GetPropensityInNextReactionQueue( NEXT_REACTION_QUEUE *queue, UINT32 index ) {
+    return queue->propensities[index];
+}
+
+DLLSCOPE UINT32 STDCALL GetNextReactionInNextReactionQueue( NEXT_REACTION_QUEUE *queue ) {
+    return queue->heap[0];
+}
+
+DLLSCOPE double STDCALL GetNextFiringTimeInNextReactionQueue( NEXT_REACTION_QUEUE *queue ) {
+    if( queue->size == 0 ) {
+        return DBL_MAX;
+    }
+    return queue->times[queue->heap[0]];
+}
+
+
+static void _SiftUp( NEXT_REACTION_QUEUE *queue, UINT32 position ) {
+    UINT32 parent = 0;
+    double *times = queue->times;
+
+    while( position > 0 ) {
+        parent = ( position - 1 ) >> 1;
+        if( times[queue->heap[parent]] <= times[queue->heap[position]] ) {
+            break;
+        }
+        _Swap( queue, parent, position );
+        position = parent;
+    }
+}
+
+static void _SiftDown( NEXT_REACTION_QUEUE *queue, UINT32 position ) {
+    UINT32 child = 0;
+    UINT32 size = queue->size;
+    double *times = queue->times;
+
+    while( ( child = 2 * position + 1 ) < size ) {
+        if( ( child + 1 < size ) && ( times[queue->heap[child + 1]] < times[queue->heap[child]] ) ) {
+            child++;
+        }
+        if( times[queue->heap[position]] <= times[queue->heap[child]] ) {
+            break;
+        }
+        _Swap( queue, position, child );
+        position = child;
+    }
+}
+
+static void _Swap( NEXT_REACTION_QUEUE *queue, UINT32 a, UINT32 b ) {
+    UINT32 index = queue->heap[a];
+
+    queue->heap[a] = queue->heap[b];
+    queue->heap[b] = index;
+    queue->positions[queue->heap[a]] = a;
+    queue->positions[queue->heap[b]] = b;
+}
@@ -20,35 +20,35 @@
 #if !defined(HAVE_NEXT_REACTION_SIMULATION)
 #define HAVE_NEXT_REACTION_SIMULATION
 
-#include "simulation_method.h"
+#include "common.h"
 
 BEGIN_C_NAMESPACE
 
-
-DLLSCOPE RET_VAL STDCALL DoNextReactionSimulation( BACK_END_PROCESSOR *backend, IR *ir );
-DLLSCOPE RET_VAL STDCALL CloseNextReactionSimulator( BACK_END_PROCESSOR *backend );
-
-
+/*
+ * Indexed binary min-heap of putative firing times for Gibson and Bruck's next reaction 
+ * method.  Reactions are identified by their index, and positions[i] locates reaction i in 
+ * the heap, so the firing time of any reaction can be changed in O(log size).  The propensity 
+ * each time was computed from is kept alongside, since the method rescales the remaining 
+ * waiting time when a propensity changes.  Reactions that cannot fire have time DBL_MAX.
+ * The Monte Carlo simulator keeps the firing times of scheduled events in one as well.
+ */
 typedef struct {
-    REACTION **reactionArray;
-    UINT32 reactionsSize;
-    SPECIES **speciesArray;
-    UINT32 speciesSize;
-    REACTION *nextReaction;    
-    SIMULATION_PRINTER *printer;
-    SIMULATION_RUN_TERMINATION_DECIDER *decider;
-    double time;
-    double printInterval;
-    double nextPrintTime;    
-    double timeLimit;
-    KINETIC_LAW_EVALUATER *evaluator;
-    double totalPropensities;
-    UINT32 seed;
-    UINT32 runs; 
-    char *outDir; 
-} NEXT_REACTION_SIMULATION_RECORD;
-
-
+    UINT32 size;
+    double *times;
+    double *propensities;
+    UINT32 *heap;
+    UINT32 *positions;
+} NEXT_REACTION_QUEUE;
+
+DLLSCOPE NEXT_REACTION_QUEUE * STDCALL CreateNextReactionQueue( UINT32 size );
+DLLSCOPE RET_VAL STDCALL FreeNextReactionQueue( NEXT_REACTION_QUEUE **queue );
+
+DLLSCOPE RET_VAL STDCALL ResetNextReactionQueue( NEXT_REACTION_QUEUE *queue );
+DLLSCOPE RET_VAL STDCALL SetFiringTimeInNextReactionQueue( NEXT_REACTION_QUEUE *queue, UINT32 index, double propensity, double time );
+DLLSCOPE double STDCALL GetFiringTimeInNextReactionQueue( NEXT_REACTION_QUEUE *queue, UINT32 index );
+DLLSCOPE double STDCALL GetPropensityInNextReactionQueue( NEXT_REACTION_QUEUE *queue, UINT32 index );
+DLLSCOPE UINT32 STDCALL GetNextReactionInNextReactionQueue( NEXT_REACTION_QUEUE *queue );
+DLLSCOPE double STDCALL GetNextFiringTimeInNextReactionQueue( NEXT_REACTION_QUEUE *queue );
 
 END_C_NAMESPACE
 
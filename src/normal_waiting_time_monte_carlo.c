@@ -22,6 +22,7 @@
 #include "gsl/gsl_vector.h"
 #include "gsl/gsl_multiroots.h"
 #include "normal_waiting_time_monte_carlo.h"
+#include "statistics_simulation_printer.h"
 
 
 
@@ -63,7 +64,7 @@ DLLSCOPE RET_VAL STDCALL DoNormalWaitingTimeMonteCarloAnalysis( BACK_END_PROCESS
     UINT i = 0;
     UINT runs = 1;
     char *namePrefix = NULL;
-    static NORMAL_WAITING_TIME_MONTE_CARLO_RECORD rec;
+    NORMAL_WAITING_TIME_MONTE_CARLO_RECORD *rec = NULL;
     UINT timeout = 0;
 
     START_FUNCTION("DoNormalWaitingTimeMonteCarloAnalysis");
@@ -72,33 +73,42 @@ DLLSCOPE RET_VAL STDCALL DoNormalWaitingTimeMonteCarloAnalysis( BACK_END_PROCESS
         return ErrorReport( FAILING, "DoNormalWaitingTimeMonteCarloAnalysis", "NormalWaitingTime method cannot be applied to the model" );
     }
 
-    if( IS_FAILED( ( ret = _InitializeRecord( &rec, backend, ir ) ) ) )  {
+    if( ( rec = (NORMAL_WAITING_TIME_MONTE_CARLO_RECORD*)MALLOC( sizeof(NORMAL_WAITING_TIME_MONTE_CARLO_RECORD) ) ) == NULL ) {
+        return ErrorReport( FAILING, "DoNormalWaitingTimeMonteCarloAnalysis", "could not allocate the record" );
+    }
+    if( IS_FAILED( ( ret = _InitializeRecord( rec, backend, ir ) ) ) )  {
+        _CleanRecord( rec );
+        FREE( rec );
+        backend->_internal1 = NULL;
         return ErrorReport( ret, "DoNormalWaitingTimeMonteCarloAnalysis", "initialization of the record failed" );
     }
 
-    runs = rec.runs;
+    runs = rec->runs;
     for( i = 1; i <= runs; i++ ) {
-        SeedRandomNumberGenerators( rec.seed );
-        rec.seed = GetNextUniformRandomNumber(0,RAND_MAX);
+        SeedRandomNumberGenerators( rec->seed );
+        rec->seed = GetNextUniformRandomNumber(0,RAND_MAX);
         timeout = 0;
 	do {
-	  SeedRandomNumberGenerators( rec.seed );
-	  if( IS_FAILED( ( ret = _InitializeSimulation( &rec, i ) ) ) ) {
+	  SeedRandomNumberGenerators( rec->seed );
+	  if( IS_FAILED( ( ret = _InitializeSimulation( rec, i ) ) ) ) {
             return ErrorReport( ret, "DoNormalWaitingTimeMonteCarloAnalysis", "initialization of the %i-th simulation failed", i );
 	  }
 	  timeout++;
-	} while ( (ret == CHANGE) && (timeout <= (rec.speciesSize + rec.compartmentsSize + rec.symbolsSize)) );
-	if (timeout > (rec.speciesSize + rec.compartmentsSize + rec.symbolsSize)) {
+	} while ( (ret == CHANGE) && (timeout <= (rec->speciesSize + rec->compartmentsSize + rec->symbolsSize)) );
+	if (timeout > (rec->speciesSize + rec->compartmentsSize + rec->symbolsSize)) {
 	  return ErrorReport( ret, "DoNormalWaitingTimeMonteCarloAnalysis", "Cycle detected in initial and rule assignments" );
 	}
-        if( IS_FAILED( ( ret = _RunSimulation( &rec ) ) ) ) {
-            return ErrorReport( ret, "DoNormalWaitingTimeMonteCarloAnalysis", "%i-th simulation failed at time %f", i, rec.time );
+        if( IS_FAILED( ( ret = _RunSimulation( rec ) ) ) ) {
+            return ErrorReport( ret, "DoNormalWaitingTimeMonteCarloAnalysis", "%i-th simulation failed at time %f", i, rec->time );
         }
-        if( IS_FAILED( ( ret = _CleanSimulation( &rec ) ) ) ) {
+        if( IS_FAILED( ( ret = _CleanSimulation( rec ) ) ) ) {
             return ErrorReport( ret, "DoNormalWaitingTimeMonteCarloAnalysis", "cleaning of the %i-th simulation failed", i );
         }
       printf("Run = %d\n",i);
       fflush(stdout);
+      if( IsRunsTargetMetInSimulationPrinter( rec->printer ) ) {
+          break;
+      }
     }
     END_FUNCTION("DoNormalWaitingTimeMonteCarloAnalysis", SUCCESS );
     return ret;
@@ -113,6 +123,8 @@ DLLSCOPE RET_VAL STDCALL CloseNormalWaitingTimeMonteCarloAnalyzer( BACK_END_PROC
     if( IS_FAILED( ( ret = _CleanRecord( rec ) ) ) )  {
         return ErrorReport( ret, "CloseNormalWaitingTimeMonteCarloAnalyzer", "cleaning of the record failed" );
     }
+    FREE( rec );
+    backend->_internal1 = NULL;
 
     END_FUNCTION("CloseNormalWaitingTimeMonteCarloAnalyzer",  SUCCESS );
     return ret;
@@ -379,6 +391,9 @@ static RET_VAL _InitializeRecord( NORMAL_WAITING_TIME_MONTE_CARLO_RECORD *rec, B
 						  symbolArray, rec->symbolsSize ) ) == NULL ) {
         return ErrorReport( FAILING, "_InitializeRecord", "could not create simulation printer" );
     }
+    if( ( rec->printer = CreateStatisticsSimulationPrinter( backend, rec->printer, rec->outDir, rec->runs ) ) == NULL ) {
+        return ErrorReport( FAILING, "_InitializeRecord", "could not create simulation statistics printer" );
+    }
 
     if( ( constraintManager = ir->GetConstraintManager( ir ) ) == NULL ) {
         return ErrorReport( FAILING, "_InitializeRecord", "could not get the constraint manager" );
@@ -735,14 +750,16 @@ static RET_VAL _CleanRecord( NORMAL_WAITING_TIME_MONTE_CARLO_RECORD *rec ) {
     SIMULATION_PRINTER *printer = rec->printer;
     SIMULATION_RUN_TERMINATION_DECIDER *decider = rec->decider;
 
-    sprintf( filename, "%s%csim-rep.txt", rec->outDir, FILE_SEPARATOR );
-    if( ( file = fopen( filename, "w" ) ) == NULL ) {
-        return ErrorReport( FAILING, "_CleanRecord", "could not create a report file" );
-    }
-    if( IS_FAILED( ( ret = decider->Report( decider, file ) ) ) ) {
-        return ret;
+    if( decider != NULL ) {
+        sprintf( filename, "%s%csim-rep.txt", rec->outDir, FILE_SEPARATOR );
+        if( ( file = fopen( filename, "w" ) ) == NULL ) {
+            return ErrorReport( FAILING, "_CleanRecord", "could not create a report file" );
+        }
+        if( IS_FAILED( ( ret = decider->Report( decider, file ) ) ) ) {
+            return ret;
+        }
+        fclose( file );
     }
-    fclose( file );
 
     if( rec->evaluator != NULL ) {
         FreeKineticLawEvaluater( &(rec->evaluator) );
@@ -754,8 +771,12 @@ static RET_VAL _CleanRecord( NORMAL_WAITING_TIME_MONTE_CARLO_RECORD *rec ) {
         FREE( rec->speciesArray );
     }
 
-    printer->Destroy( printer );
-    decider->Destroy( decider );
+    if( printer != NULL ) {
+        printer->Destroy( printer );
+    }
+    if( decider != NULL ) {
+        decider->Destroy( decider );
+    }
 
     return ret;
 }
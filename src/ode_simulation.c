@@ -26,6 +26,7 @@
 #include "gsl/gsl_odeiv.h"
 #include "gsl/gsl_linalg.h"
 #include "ode_simulation.h"
+#include "kinetic_law_derivative.h"
 
 
 static BOOL _IsModelConditionSatisfied( IR *ir );
@@ -41,12 +42,31 @@ static RET_VAL _CleanRecord( ODE_SIMULATION_RECORD *rec );
 static RET_VAL _CalculateReactionRates( ODE_SIMULATION_RECORD *rec );
 static RET_VAL _CalculateReactionRate( ODE_SIMULATION_RECORD *rec, REACTION *reaction );
 static int _Update( double t, const double y[], double f[], ODE_SIMULATION_RECORD *rec );
+static RET_VAL _InitializeRightHandSide( ODE_SIMULATION_RECORD *rec );
+static RET_VAL _InitializeEventLocation( ODE_SIMULATION_RECORD *rec );
+static UINT32 _GetRuleTargetIndex( ODE_SIMULATION_RECORD *rec, RULE *rule );
+static double _EvaluateRule( ODE_SIMULATION_RECORD *rec, UINT32 index );
+static double _EvaluateKineticLaw( ODE_SIMULATION_RECORD *rec, KINETIC_LAW *law );
+static void _LoadStateFromValues( ODE_SIMULATION_RECORD *rec, const double y[] );
+static double _EvaluateTriggerFunction( ODE_SIMULATION_RECORD *rec, KINETIC_LAW *trigger, BOOL *isTriggered );
+static RET_VAL _LocateEventInStep( ODE_SIMULATION_RECORD *rec, gsl_odeiv_step *step, gsl_odeiv_system *system, 
+                                   double startTime, double *time, double y[] );
+static RET_VAL _InitializeJacobian( ODE_SIMULATION_RECORD *rec );
+static KINETIC_LAW *_CreateRateWithAssignmentsExpanded( ODE_SIMULATION_RECORD *rec, KINETIC_LAW *law, RULE **assignments );
+static RET_VAL _ExpandAssignmentsInKineticLaw( ODE_SIMULATION_RECORD *rec, KINETIC_LAW *law, RULE **assignments, UINT32 depth );
+static UINT32 _MarkVariablesInKineticLaw( ODE_SIMULATION_RECORD *rec, KINETIC_LAW *law, UINT32 limit, BYTE *marks );
+static RET_VAL _CreatePartials( ODE_SIMULATION_RECORD *rec, KINETIC_LAW *law, BYTE *marks, UINT32 *next, 
+                                UINT32 *partialSpecies, KINETIC_LAW **partials );
+static double _EvaluatePartial( ODE_SIMULATION_RECORD *rec, KINETIC_LAW *partial, UINT32 speciesIndex );
+static int _Jacobian( double t, const double y[], double *dfdy, double dfdt[], ODE_SIMULATION_RECORD *rec );
 static RET_VAL _Print( ODE_SIMULATION_RECORD *rec, double time );
 static RET_VAL _PrintStatistics( ODE_SIMULATION_RECORD *rec, FILE *file);
 
 static double fireEvents( ODE_SIMULATION_RECORD *rec, double time );
 static void fireEvent( EVENT *event, ODE_SIMULATION_RECORD *rec );
 static void ExecuteAssignments( ODE_SIMULATION_RECORD *rec );
+static void ExecuteRateAssignments( ODE_SIMULATION_RECORD *rec );
+static void ExecuteAssignment( ODE_SIMULATION_RECORD *rec, UINT32 index );
 static void SetEventAssignmentsNextValues( EVENT *event, ODE_SIMULATION_RECORD *rec );
 static void SetEventAssignmentsNextValuesTime( EVENT *event, ODE_SIMULATION_RECORD *rec, double time );
 static RET_VAL EvaluateAlgebraicRules( ODE_SIMULATION_RECORD *rec );
@@ -57,7 +77,7 @@ DLLSCOPE RET_VAL STDCALL DoODESimulation( BACK_END_PROCESSOR *backend, IR *ir )
     UINT i = 0;
     UINT runs = 1;
     char *namePrefix = NULL;
-    static ODE_SIMULATION_RECORD rec;
+    ODE_SIMULATION_RECORD *rec = NULL;
     UINT timeout = 0;
 
     START_FUNCTION("DoODESimulation");
@@ -67,28 +87,34 @@ DLLSCOPE RET_VAL STDCALL DoODESimulation( BACK_END_PROCESSOR *backend, IR *ir )
                             "Embedded Runge-Kutta-Fehlberg method cannot be applied to the model" );
     }
 
-    if( IS_FAILED( ( ret = _InitializeRecord( &rec, backend, ir ) ) ) )  {
+    if( ( rec = (ODE_SIMULATION_RECORD*)MALLOC( sizeof(ODE_SIMULATION_RECORD) ) ) == NULL ) {
+        return ErrorReport( FAILING, "DoODESimulation", "could not allocate the record" );
+    }
+    if( IS_FAILED( ( ret = _InitializeRecord( rec, backend, ir ) ) ) )  {
+        _CleanRecord( rec );
+        FREE( rec );
+        backend->_internal1 = NULL;
         return ErrorReport( ret, "DoODESimulation", "initialization of the record failed" );
     }
-    runs = rec.runs;
+    runs = rec->runs;
     for( i = 1; i <= runs; i++ ) {
       timeout = 0;
-      SeedRandomNumberGenerators( rec.seed );
-      rec.seed = GetNextUniformRandomNumber(0,RAND_MAX);
+      SeedRandomNumberGenerators( rec->seed );
+      rec->seed = GetNextUniformRandomNumber(0,RAND_MAX);
       do {
-	SeedRandomNumberGenerators( rec.seed );
-	if( IS_FAILED( ( ret = _InitializeSimulation( &rec, i ) ) ) ) {
+	SeedRandomNumberGenerators( rec->seed );
+	if( IS_FAILED( ( ret = _InitializeSimulation( rec, i ) ) ) ) {
 	  return ErrorReport( ret, "DoODESimulation", "initialization of the %i-th simulation failed", i );
 	}
 	timeout++;
-      } while ( (ret == CHANGE) && (timeout <= (rec.speciesSize + rec.compartmentsSize + rec.symbolsSize)) );
-      if (timeout > (rec.speciesSize + rec.compartmentsSize + rec.symbolsSize + 1)) {
+      } while ( (ret == CHANGE) && (timeout <= (rec->speciesSize + rec->compartmentsSize + rec->symbolsSize)) );
+      if (timeout > (rec->speciesSize + rec->compartmentsSize + rec->symbolsSize + 1)) {
 	return ErrorReport( ret, "DoODESimulation", "Cycle detected in initial and rule assignments" );
       }
-      if( IS_FAILED( ( ret = _RunSimulation( &rec ) ) ) ) {
-        return ErrorReport( ret, "DoODESimulation", "%i-th simulation failed at time %f", i, rec.time );
+      if( IS_FAILED( ( ret = _RunSimulation( rec ) ) ) ) {
+        return ErrorReport( ret, "DoODESimulation", "%i-th simulation failed at time %f", i, rec->time );
       }
-      if( IS_FAILED( ( ret = _CleanSimulation( &rec ) ) ) ) {
+      if( IS_FAILED( ( ret = _CleanSimulation( rec ) ) ) ) {
         return ErrorReport( ret, "DoODESimulation", "cleaning of the %i-th simulation failed", i );
       }
       printf("Run = %d\n",i);
@@ -108,6 +134,8 @@ DLLSCOPE RET_VAL STDCALL CloseODESimulation( BACK_END_PROCESSOR *backend ) {
     if( IS_FAILED( ( ret = _CleanRecord( rec ) ) ) )  {
         return ErrorReport( ret, "CloseODESimulation", "cleaning of the record failed" );
     }
+    FREE( rec );
+    backend->_internal1 = NULL;
 
     END_FUNCTION("CloseODESimulation",  SUCCESS );
     return ret;
@@ -173,6 +201,7 @@ static RET_VAL _InitializeRecord( ODE_SIMULATION_RECORD *rec, BACK_END_PROCESSOR
       ResetCurrentElement( list );
       while( ( reaction = (REACTION*)GetNextFromLinkedList( list ) ) != NULL ) {
         reactions[i] = reaction;
+        SetReactionIndex( reaction, i );
         i++;
 	if (IsReactionFastInReactionNode( reaction )) {
 	  rec->numberFastReactions++;
@@ -418,6 +447,12 @@ static RET_VAL _InitializeRecord( ODE_SIMULATION_RECORD *rec, BACK_END_PROCESSOR
     if( ( rec->evaluator = CreateKineticLawEvaluater() ) == NULL ) {
         return ErrorReport( FAILING, "_InitializeRecord", "could not create evaluator" );
     }
+    rec->evaluator->interpolateDelays = TRUE;
+
+    if( ( rec->state = CreateSimState( rec->speciesArray, rec->speciesSize, rec->compartmentArray, rec->compartmentsSize, 
+                                       rec->symbolArray, rec->symbolsSize, rec->reactionArray, rec->reactionsSize ) ) == NULL ) {
+        return ErrorReport( FAILING, "_InitializeRecord", "could not create simulation state" );
+    }
 
     if( ( rec->findNextTime = CreateKineticLawFind_Next_Time() ) == NULL ) {
         return ErrorReport( FAILING, "_InitializeRecord", "could not create find next time" );
@@ -464,6 +499,15 @@ static RET_VAL _InitializeRecord( ODE_SIMULATION_RECORD *rec, BACK_END_PROCESSOR
       }
     }
 
+    if( ( valueString = properties->GetProperty( properties, ODE_SIMULATION_EVENT_TOLERANCE ) ) == NULL ) {
+        rec->eventTolerance = DEFAULT_ODE_SIMULATION_EVENT_TOLERANCE;
+    }
+    else {
+      if( IS_FAILED( ( ret = StrToFloat( &(rec->eventTolerance), valueString ) ) ) || !( rec->eventTolerance > 0.0 ) ) {
+	rec->eventTolerance = DEFAULT_ODE_SIMULATION_EVENT_TOLERANCE;
+      }
+    }
+
     if( ( valueString = properties->GetProperty( properties, SIMULATION_OUTPUT_START_TIME ) ) == NULL ) {
         rec->outputStartTime = DEFAULT_SIMULATION_OUTPUT_START_TIME_VALUE;
     }
@@ -640,6 +684,22 @@ static RET_VAL _InitializeRecord( ODE_SIMULATION_RECORD *rec, BACK_END_PROCESSOR
       }
     }
 
+    if( rec->eventsSize > 0 ) {
+        if( IS_FAILED( ( ret = _InitializeEventLocation( rec ) ) ) ) {
+            return ErrorReport( ret, "_InitializeRecord", "could not prepare the location of events" );
+        }
+    }
+
+    if( IS_FAILED( ( ret = _InitializeRightHandSide( rec ) ) ) ) {
+        return ErrorReport( ret, "_InitializeRecord", "could not prepare the right-hand side" );
+    }
+
+    if( strcmp( rec->encoding, "bsimp" ) == 0 ) {
+        if( IS_FAILED( ( ret = _InitializeJacobian( rec ) ) ) ) {
+            return ErrorReport( ret, "_InitializeRecord", "could not create the Jacobian for %s", rec->encoding );
+        }
+    }
+
     backend->_internal1 = (CADDR_T)rec;
 
     return ret;
@@ -793,6 +853,7 @@ static RET_VAL _InitializeSimulation( ODE_SIMULATION_RECORD *rec, int runNum ) {
 	}
 	concentrations[rec->compartmentsSize + rec->speciesSize + i] = param;
     }
+    LoadSimStateFromIR( rec->state );
     for (i = 0; i < rec->eventsSize; i++) {
       /* SetTriggerEnabledInEvent( rec->eventArray[i], FALSE ); */
       /* Use the line below to support true SBML semantics, i.e., nothing can be trigger at t=0 */
@@ -831,7 +892,6 @@ static RET_VAL _InitializeSimulation( ODE_SIMULATION_RECORD *rec, int runNum ) {
 static RET_VAL _RunSimulation( ODE_SIMULATION_RECORD *rec ) {
     RET_VAL ret = SUCCESS;
     int status = GSL_SUCCESS;
-    int i;
     double h = ODE_SIMULATION_H;
     double *y = rec->concentrations;
     double *y_err;
@@ -841,6 +901,7 @@ static RET_VAL _RunSimulation( ODE_SIMULATION_RECORD *rec ) {
     double timeLimit = rec->timeLimit;
     double nextEventTime;
     double maxTime;
+    double stepStartTime;
     double minTimeStep = rec->minTimeStep;
     int curStep = 0;
     double numberSteps = rec->numberSteps;
@@ -854,7 +915,7 @@ static RET_VAL _RunSimulation( ODE_SIMULATION_RECORD *rec ) {
     gsl_odeiv_system system =
     {
         (int(*)(double , const double [], double [], void*))_Update,
-        NULL,
+        rec->hasJacobian ? (int(*)(double , const double [], double *, double [], void*))_Jacobian : NULL,
         size,
         rec
     };
@@ -869,6 +930,8 @@ static RET_VAL _RunSimulation( ODE_SIMULATION_RECORD *rec ) {
       stepType = gsl_odeiv_step_rk4imp;
     } else if (strcmp(rec->encoding,"gear1")==0) {
       stepType = gsl_odeiv_step_gear1;
+    } else if (strcmp(rec->encoding,"bsimp")==0) {
+      stepType = gsl_odeiv_step_bsimp;
     } else {
       stepType = gsl_odeiv_step_gear2;
     } 
@@ -939,6 +1002,10 @@ static RET_VAL _RunSimulation( ODE_SIMULATION_RECORD *rec ) {
 	if (time > maxTime) {
 	  maxTime = time;
 	}
+	stepStartTime = time;
+	if (rec->eventsSize > 0) {
+	  memcpy( rec->stepStartValues, y, size * sizeof(double) );
+	}
 	if (h >= minTimeStep) {
 	  status = gsl_odeiv_evolve_apply( evolve, control, step,
 					   &system, &time, maxTime,
@@ -952,23 +1019,23 @@ static RET_VAL _RunSimulation( ODE_SIMULATION_RECORD *rec ) {
 	  status = gsl_odeiv_step_apply( step, time, h, y, y_err, NULL, NULL, &system );
 	  time = time + h;
 	}
-	if (status == GSL_ETOL) {
-	  maxTime = time + rec->timeStep;
-	  for( i = 0; i < rec->speciesSize; i++ ) {
-	    SetAmountInSpeciesNode( rec->speciesArray[i], y[i] );
-	  }
-	  for( i = 0; i < rec->compartmentsSize; i++ ) {
-	    SetCurrentSizeInCompartment( rec->compartmentArray[i], y[rec->speciesSize + i] );
+	if( status != GSL_SUCCESS ) {
+	  return FAILING;
+	}
+	/* Move back to the first trigger crossing within the step, if any, and restart there */
+	if (rec->eventsSize > 0) {
+	  if( IS_FAILED( ( ret = _LocateEventInStep( rec, step, &system, stepStartTime, &time, y ) ) ) ) {
+	    return ret;
 	  }
-	  for( i = 0; i < rec->symbolsSize; i++ ) {
-	    SetCurrentRealValueInSymbol( rec->symbolArray[i], y[rec->speciesSize + rec->compartmentsSize + i] );
+	  if (ret == CHANGE) {
+	    gsl_odeiv_step_reset( step );
+	    gsl_odeiv_evolve_reset( evolve );
+	    ret = SUCCESS;
 	  }
-	  ExecuteAssignments( rec );
-	  status = GSL_SUCCESS;
-	  //printf("Adjusting time step\n");
 	}
-	if( status != GSL_SUCCESS ) {
-	  return FAILING;
+	/* _Update only executes the assignment rules the rates read */
+	if (rec->rateAssignmentRulesSize < rec->assignmentRulesSize) {
+	  ExecuteAssignments( rec );
 	}
       }
       if (time > 0.0) printf("Time = %g\n",time);
@@ -997,6 +1064,7 @@ static RET_VAL _CleanSimulation( ODE_SIMULATION_RECORD *rec ) {
 
 static RET_VAL _CleanRecord( ODE_SIMULATION_RECORD *rec ) {
     RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
     char filename[512];
     FILE *file = NULL;
     SIMULATION_PRINTER *printer = rec->printer;
@@ -1005,6 +1073,39 @@ static RET_VAL _CleanRecord( ODE_SIMULATION_RECORD *rec ) {
     if( rec->evaluator != NULL ) {
         FreeKineticLawEvaluater( &(rec->evaluator) );
     }
+    if( rec->compiler != NULL ) {
+        FreeKineticLawCompiler( &(rec->compiler) );
+    }
+    if( rec->ratePrograms != NULL ) {
+        FREE( rec->ratePrograms );
+    }
+    if( rec->rulePrograms != NULL ) {
+        FREE( rec->rulePrograms );
+    }
+    if( rec->isTimeSymbol != NULL ) {
+        FREE( rec->isTimeSymbol );
+    }
+    if( rec->rateAssignmentRules != NULL ) {
+        FREE( rec->rateAssignmentRules );
+    }
+    if( rec->stepStartValues != NULL ) {
+        FREE( rec->stepStartValues );
+    }
+    if( rec->eventValues != NULL ) {
+        FREE( rec->eventValues );
+    }
+    if( rec->eventErrors != NULL ) {
+        FREE( rec->eventErrors );
+    }
+    if( rec->triggerValues != NULL ) {
+        FREE( rec->triggerValues );
+    }
+    if( rec->triggerFlags != NULL ) {
+        FREE( rec->triggerFlags );
+    }
+    if( rec->state != NULL ) {
+        FreeSimState( &(rec->state) );
+    }
     if( rec->reactionArray != NULL ) {
         FREE( rec->reactionArray );
     }
@@ -1014,9 +1115,37 @@ static RET_VAL _CleanRecord( ODE_SIMULATION_RECORD *rec ) {
     if( rec->concentrations != NULL ) {
         FREE( rec->concentrations );
     }
+    if( rec->reactionPartials != NULL ) {
+        for( i = 0; i < rec->reactionPartialOffsets[rec->reactionsSize]; i++ ) {
+            FreeKineticLaw( &(rec->reactionPartials[i]) );
+        }
+        FREE( rec->reactionPartials );
+    }
+    if( rec->rulePartials != NULL ) {
+        for( i = 0; i < rec->rulePartialOffsets[rec->rulesSize]; i++ ) {
+            FreeKineticLaw( &(rec->rulePartials[i]) );
+        }
+        FREE( rec->rulePartials );
+    }
+    if( rec->reactionPartialOffsets != NULL ) {
+        FREE( rec->reactionPartialOffsets );
+    }
+    if( rec->reactionPartialSpecies != NULL ) {
+        FREE( rec->reactionPartialSpecies );
+    }
+    if( rec->rulePartialOffsets != NULL ) {
+        FREE( rec->rulePartialOffsets );
+    }
+    if( rec->rulePartialSpecies != NULL ) {
+        FREE( rec->rulePartialSpecies );
+    }
 
-    printer->Destroy( printer );
-    decider->Destroy( decider );
+    if( printer != NULL ) {
+        printer->Destroy( printer );
+    }
+    if( decider != NULL ) {
+        decider->Destroy( decider );
+    }
 
     return ret;
 }
@@ -1056,7 +1185,7 @@ static RET_VAL _PrintStatistics(ODE_SIMULATION_RECORD *rec, FILE *file) {
 
 	for (i = 0; i < speciesSize; i++) {
 		species = speciesArray[i];
-		SetAmountInSpeciesNode(species, GetInitialAmountInSpeciesNode(species));
+		SetSpeciesAmountInSimState(rec->state, i, GetInitialAmountInSpeciesNode(species));
 		fprintf( file, "%s = %f" NEW_LINE, *GetSpeciesNodeID(species), GetInitialAmountInSpeciesNode(species));
 	}
 	fprintf( file, NEW_LINE);
@@ -1184,13 +1313,20 @@ static RET_VAL _CalculateReactionRate( ODE_SIMULATION_RECORD *rec, REACTION *rea
     double rate = 0.0;
     SPECIES *species = NULL;
     KINETIC_LAW *law = NULL;
+    KINETIC_LAW_PROGRAM *program = rec->ratePrograms[GetReactionIndex( reaction )];
     KINETIC_LAW_EVALUATER *evaluator = rec->evaluator;
 
-    law = GetKineticLawInReactionNode( reaction );
-    rate = evaluator->EvaluateWithCurrentConcentrationsDeter( evaluator, law );
+    if( program != NULL ) {
+        rate = EvaluateKineticLawProgram( program, rec->state->values, NULL );
+    }
+    else {
+        law = GetKineticLawInReactionNode( reaction );
+        rate = evaluator->EvaluateWithCurrentConcentrationsDeter( evaluator, law );
+    }
     if( !( rate < DBL_MAX ) ) {
         rate = 0.0;
     }
+    rec->state->propensities[GetReactionIndex( reaction )] = rate;
     if( IS_FAILED( ( ret = SetReactionRate( reaction, rate ) ) ) ) {
         return ret;
     }
@@ -1337,35 +1473,6 @@ static double fireEvents( ODE_SIMULATION_RECORD *rec, double time ) {
     return firstEventTime;
 }
 
-static BOOL canTriggerEvent( ODE_SIMULATION_RECORD *rec, double time ) {
-    int i;
-    double nextEventTime;
-    BOOL triggerEnabled;
-
-    rec->time = time;
-    for (i = 0; i < rec->eventsSize; i++) {
-      nextEventTime = GetNextEventTimeInEvent( rec->eventArray[i] );
-      triggerEnabled = GetTriggerEnabledInEvent( rec->eventArray[i] );
-      if (nextEventTime != -1.0) {
-	if  (time > nextEventTime) {
-	  /*
-	  if (!GetUseValuesFromTriggerTime( rec->eventArray[i] )) {
-	    SetEventAssignmentsNextValues( rec->eventArray[i], rec ); 
-	  }
-	  */
-	  return TRUE;
-	}
-      }
-      if (!triggerEnabled) {
-	if (rec->evaluator->EvaluateWithCurrentConcentrationsDeter( rec->evaluator,
-								    (KINETIC_LAW*)GetTriggerInEvent( rec->eventArray[i] ) )) {
-	  return TRUE;
-	}
-      }
-    }
-    return FALSE;
-}
-
 static void SetEventAssignmentsNextValues( EVENT *event, ODE_SIMULATION_RECORD *rec ) {
   LINKED_LIST *list = NULL;
   EVENT_ASSIGNMENT *eventAssignment;
@@ -1419,18 +1526,18 @@ static void fireEvent( EVENT *event, ODE_SIMULATION_RECORD *rec ) {
     //	   GetCharArrayOfString(eventAssignment->var),rec->time,varType,j,concentration);
     if ( varType == SPECIES_EVENT_ASSIGNMENT ) {
 	if (HasOnlySubstanceUnitsInSpeciesNode( rec->speciesArray[j] )) {
-	  SetAmountInSpeciesNode( rec->speciesArray[j], concentration );
+	  SetSpeciesAmountInSimState( rec->state, j, concentration );
 	  rec->concentrations[j] = concentration;
 	} else {
-	  SetConcentrationInSpeciesNode( rec->speciesArray[j], concentration );
+	  SetSpeciesConcentrationInSimState( rec->state, j, concentration );
 	  rec->concentrations[j] = GetAmountInSpeciesNode(rec->speciesArray[j]);
 	}
     } else if ( varType == COMPARTMENT_EVENT_ASSIGNMENT ) {
-      SetCurrentSizeInCompartment( rec->compartmentArray[j], concentration );
+      SetCompartmentSizeInSimState( rec->state, j, concentration );
       rec->concentrations[rec->speciesSize + j] = concentration;
     } else {
       //printf("j=%d conc=%g\n",j,concentration);
-      SetCurrentRealValueInSymbol( rec->symbolArray[j], concentration );
+      SetSymbolValueInSimState( rec->state, j, concentration );
       rec->concentrations[rec->speciesSize + rec->compartmentsSize + j] = concentration;
     }
   }
@@ -1439,36 +1546,49 @@ static void fireEvent( EVENT *event, ODE_SIMULATION_RECORD *rec ) {
 /* Update values using assignments rules */
 static void ExecuteAssignments( ODE_SIMULATION_RECORD *rec ) {
   UINT32 i = 0;
-  UINT32 j = 0;
-  double concentration = 0.0;
-  BYTE varType;
 
   for (i = 0; i < rec->rulesSize; i++) {
     if ( GetRuleType( rec->ruleArray[i] ) == RULE_TYPE_ASSIGNMENT ) {
-      concentration = rec->evaluator->EvaluateWithCurrentConcentrationsDeter( rec->evaluator,
-									 (KINETIC_LAW*)GetMathInRule( rec->ruleArray[i] ) );
-      varType = GetRuleVarType( rec->ruleArray[i] );
-      //printf("Conc=%g\n",concentration);
-      j = GetRuleIndex( rec->ruleArray[i] );
-      if ( varType == SPECIES_RULE ) {
-	if (HasOnlySubstanceUnitsInSpeciesNode( rec->speciesArray[j] )) {
-	  SetAmountInSpeciesNode( rec->speciesArray[j], concentration );
-	  rec->concentrations[j] = concentration;
-	} else {
-	  SetConcentrationInSpeciesNode( rec->speciesArray[j], concentration );
-	  rec->concentrations[j] = GetAmountInSpeciesNode(rec->speciesArray[j]);
-	}
-      } else if ( varType == COMPARTMENT_RULE ) {
-	SetCurrentSizeInCompartment( rec->compartmentArray[j], concentration );
-	rec->concentrations[rec->speciesSize + j] = concentration;
-      } else {
-	SetCurrentRealValueInSymbol( rec->symbolArray[j], concentration );
-	rec->concentrations[rec->speciesSize + rec->compartmentsSize + j] = concentration;
-      }
+      ExecuteAssignment( rec, i );
     }
   }
 }
 
+/* executes only the assignment rules the right-hand side reads, in the order of ruleArray */
+static void ExecuteRateAssignments( ODE_SIMULATION_RECORD *rec ) {
+  UINT32 i = 0;
+
+  for (i = 0; i < rec->rateAssignmentRulesSize; i++) {
+    ExecuteAssignment( rec, rec->rateAssignmentRules[i] );
+  }
+}
+
+static void ExecuteAssignment( ODE_SIMULATION_RECORD *rec, UINT32 index ) {
+  UINT32 j = 0;
+  double concentration = 0.0;
+  BYTE varType;
+
+  concentration = _EvaluateRule( rec, index );
+  varType = GetRuleVarType( rec->ruleArray[index] );
+  //printf("Conc=%g\n",concentration);
+  j = GetRuleIndex( rec->ruleArray[index] );
+  if ( varType == SPECIES_RULE ) {
+    if (HasOnlySubstanceUnitsInSpeciesNode( rec->speciesArray[j] )) {
+      SetSpeciesAmountInSimState( rec->state, j, concentration );
+      rec->concentrations[j] = concentration;
+    } else {
+      SetSpeciesConcentrationInSimState( rec->state, j, concentration );
+      rec->concentrations[j] = GetAmountInSpeciesNode(rec->speciesArray[j]);
+    }
+  } else if ( varType == COMPARTMENT_RULE ) {
+    SetCompartmentSizeInSimState( rec->state, j, concentration );
+    rec->concentrations[rec->speciesSize + j] = concentration;
+  } else {
+    SetSymbolValueInSimState( rec->state, j, concentration );
+    rec->concentrations[rec->speciesSize + rec->compartmentsSize + j] = concentration;
+  }
+}
+
 int ODE_print_state (size_t iter,gsl_multiroot_fsolver * s,int n) {
   int i = 0;
 
@@ -1499,9 +1619,9 @@ int ODEalgebraicRules(const gsl_vector * x, void *params, gsl_vector * f) {
       amount = gsl_vector_get (x, j);
       j++; 
       if (HasOnlySubstanceUnitsInSpeciesNode( species )) {
-	SetAmountInSpeciesNode( species, amount );
+	SetSpeciesAmountInSimState( rec->state, i, amount );
       } else {
-	SetConcentrationInSpeciesNode( species, amount );
+	SetSpeciesConcentrationInSimState( rec->state, i, amount );
       }
     }
   }
@@ -1510,7 +1630,7 @@ int ODEalgebraicRules(const gsl_vector * x, void *params, gsl_vector * f) {
     if (IsCompartmentAlgebraic( compartment )) {
       amount = gsl_vector_get (x, j);
       j++;
-      SetCurrentSizeInCompartment( compartment, amount );
+      SetCompartmentSizeInSimState( rec->state, i, amount );
     }
   }
   for( i = 0; i < rec->symbolsSize; i++ ) {
@@ -1518,7 +1638,7 @@ int ODEalgebraicRules(const gsl_vector * x, void *params, gsl_vector * f) {
     if (IsSymbolAlgebraic( symbol )) {
       amount = gsl_vector_get (x, j);
       j++;
-      SetCurrentRealValueInSymbol( symbol, amount );
+      SetSymbolValueInSimState( rec->state, i, amount );
     }
   }
   j = 0;
@@ -1629,10 +1749,10 @@ int ODEfastReactions(const gsl_vector * x, void *params, gsl_vector * f) {
       amount = gsl_vector_get (x, j);
       j++; 
       if (HasOnlySubstanceUnitsInSpeciesNode( species )) {
-	SetAmountInSpeciesNode( species, amount );
+	SetSpeciesAmountInSimState( rec->state, i, amount );
 	rec->concentrations[i] = amount;
       } else {
-	SetConcentrationInSpeciesNode( species, amount );
+	SetSpeciesConcentrationInSimState( rec->state, i, amount );
 	rec->concentrations[i] = amount;
       }
     }
@@ -2032,10 +2152,10 @@ static RET_VAL ExecuteFastReactions( ODE_SIMULATION_RECORD *rec ) {
       amount = gsl_vector_get (s->x, j);
       j++; 
       if (HasOnlySubstanceUnitsInSpeciesNode( species )) {
-	SetAmountInSpeciesNode( species, amount );
+	SetSpeciesAmountInSimState( rec->state, i, amount );
 	rec->concentrations[i] = amount;
       } else {
-	SetConcentrationInSpeciesNode( species, amount );
+	SetSpeciesConcentrationInSimState( rec->state, i, amount );
 	rec->concentrations[i] = amount;
       }
     }
@@ -2058,8 +2178,6 @@ static int _Update( double t, const double y[], double f[], ODE_SIMULATION_RECOR
     double size = 0.0;
     double deltaTime = 0.0;
     double rate = 0.0;
-    IR_EDGE *edge = NULL;
-    REACTION *reaction = NULL;
     COMPARTMENT *compartment = NULL;
     COMPARTMENT **compartmentsArray = rec->compartmentArray;
     UINT32 symbolsSize = rec->symbolsSize;
@@ -2067,21 +2185,15 @@ static int _Update( double t, const double y[], double f[], ODE_SIMULATION_RECOR
     REB2SAC_SYMBOL **symbolArray = rec->symbolArray;
     SPECIES *species = NULL;
     SPECIES **speciesArray = rec->speciesArray;
-    LINKED_LIST *edges = NULL;
     KINETIC_LAW_EVALUATER *evaluator = rec->evaluator;
-    double nextEventTime;
-    BOOL triggerEnabled;
     BYTE varType;
-    REB2SAC_SYMBOL *speciesRef = NULL;
-    REB2SAC_SYMBOL *convFactor = NULL;
+    SIM_STATE *state = rec->state;
 
     /* Update values from y[] */
     for( i = 0; i < speciesSize; i++ ) {
         species = speciesArray[i];
 	if (f[i] != 0.0) {
-	  if( IS_FAILED( ( ret = SetAmountInSpeciesNode( species, y[i] ) ) ) ) {
-	    return GSL_FAILURE;
-	  }
+	  SetSpeciesAmountInSimState( rec->state, i, y[i] );
 	}
 	if( IS_FAILED( ( ret = SetRateInSpeciesNode( species, f[i] ) ) ) ) {
 	  return GSL_FAILURE;
@@ -2091,9 +2203,7 @@ static int _Update( double t, const double y[], double f[], ODE_SIMULATION_RECOR
     for( i = 0; i < compartmentsSize; i++ ) {
         compartment = compartmentsArray[i];
 	if (f[speciesSize + i] != 0.0) {
-	  if( IS_FAILED( ( ret = SetCurrentSizeInCompartment( compartment, y[speciesSize + i] ) ) ) ) {
-            return GSL_FAILURE;
-	  }
+	  SetCompartmentSizeInSimState( rec->state, i, y[speciesSize + i] );
 	}
 	if( IS_FAILED( ( ret = SetCurrentRateInCompartment( compartment, f[speciesSize + i] ) ) ) ) {
 	  return GSL_FAILURE;
@@ -2103,34 +2213,26 @@ static int _Update( double t, const double y[], double f[], ODE_SIMULATION_RECOR
     for( i = 0; i < symbolsSize; i++ ) {
         symbol = symbolArray[i];
 	if (f[speciesSize + compartmentsSize + i] != 0.0) {
-	  if( IS_FAILED( ( ret = SetCurrentRealValueInSymbol( symbol, y[speciesSize + compartmentsSize + i] ) ) ) ) {
-            return GSL_FAILURE;
-	  }
+	  SetSymbolValueInSimState( rec->state, i, y[speciesSize + compartmentsSize + i] );
 	}
 	if( IS_FAILED( ( ret = SetCurrentRateInSymbol( symbol, f[speciesSize + compartmentsSize + i] ) ) ) ) {
 	  return GSL_FAILURE;
 	}
 	f[speciesSize + compartmentsSize + i] = 0.0;
-	if ((strcmp(GetCharArrayOfString( GetSymbolID(symbol) ),"time")==0) ||
-	    (strcmp(GetCharArrayOfString( GetSymbolID(symbol) ),"t")==0)) {
+	if (rec->isTimeSymbol[i]) {
 	  f[speciesSize + compartmentsSize + i] = 1.0;
 	}
     }
 
-    ExecuteAssignments( rec );
+    ExecuteRateAssignments( rec );
     if (rec->algebraicRulesSize > 0) {
       EvaluateAlgebraicRules( rec );
     }
-    if ((rec->timeStep != 0.00001) && (canTriggerEvent( rec, t ))) {
-      rec->timeStep = 0.00001;
-      return GSL_ETOL;
-    }
 
     /* Update rates using rate rules */
     for (i = 0; i < rec->rulesSize; i++) {
       if (GetRuleType( rec->ruleArray[i] ) == RULE_TYPE_RATE_ASSIGNMENT ) {
-	rate = rec->evaluator->EvaluateWithCurrentConcentrationsDeter( rec->evaluator,
-								  (KINETIC_LAW*)GetMathInRule( rec->ruleArray[i] ) );
+	rate = _EvaluateRule( rec, i );
 	varType = GetRuleVarType( rec->ruleArray[i] );
 	j = GetRuleIndex( rec->ruleArray[i] );
 	if ( varType == SPECIES_RULE ) {
@@ -2173,48 +2275,845 @@ static int _Update( double t, const double y[], double f[], ODE_SIMULATION_RECOR
     if( IS_FAILED( ( ret = _CalculateReactionRates( rec ) ) ) ) {
         return GSL_FAILURE;
     }
+    /* one pass over the stoichiometry matrix, reactants first in every reaction */
+    for( i = 0; i < rec->reactionsSize; i++ ) {
+        if( state->isFast[i] ) {
+            continue;
+        }
+        rate = state->propensities[i];
+        for( k = state->stoichiometryOffsets[i]; k < state->stoichiometryOffsets[i+1]; k++ ) {
+            j = state->stoichiometrySpecies[k];
+            if( state->isBoundary[j] ) {
+                continue;
+            }
+            stoichiometry = GetStoichiometryInSimState( state, k );
+            if( k < state->productOffsets[i] ) {
+                f[j] -= stoichiometry * rate;
+            }
+            else {
+                f[j] += stoichiometry * rate;
+            }
+        }
+    }
     for( i = 0; i < speciesSize; i++ ) {
-        species = speciesArray[i];
-	if (HasBoundaryConditionInSpeciesNode(species)) continue;
-	/* size = GetCurrentSizeInCompartment( GetCompartmentInSpeciesNode( species ) ); */
-	TRACE_2( "%s changes from %g", GetCharArrayOfString( GetSpeciesNodeName( species ) ),
-            concentration );
-        edges = GetReactantEdges( (IR_NODE*)species );
-        ResetCurrentElement( edges );
-        while( ( edge = GetNextEdge( edges ) ) != NULL ) {
-	    speciesRef = GetSpeciesRefInIREdge( edge );
-	    if (speciesRef) {
-	      stoichiometry = GetCurrentRealValueInSymbol( speciesRef );
-	    } else {
-	      stoichiometry = GetStoichiometryInIREdge( edge );
-	    }
-            reaction = GetReactionInIREdge( edge );
-	    if (IsReactionFastInReactionNode( reaction )) continue;
-            rate = GetReactionRate( reaction );
-	    f[i] -= (stoichiometry * rate);
-            TRACE_2( "\tchanges from %s is %g", GetCharArrayOfString( GetReactionNodeName( reaction ) ),
-               -(stoichiometry * rate));
-        }
-        edges = GetProductEdges( (IR_NODE*)species );
-        ResetCurrentElement( edges );
-        while( ( edge = GetNextEdge( edges ) ) != NULL ) {
-	    speciesRef = GetSpeciesRefInIREdge( edge );
-	    if (speciesRef) {
-	      stoichiometry = GetCurrentRealValueInSymbol( speciesRef );
-	    } else {
-	      stoichiometry = GetStoichiometryInIREdge( edge );
-	    }
-            reaction = GetReactionInIREdge( edge );
-	    if (IsReactionFastInReactionNode( reaction )) continue;
-            rate = GetReactionRate( reaction );
-	    f[i] += (stoichiometry * rate);
-            TRACE_2( "\tchanges from %s is %g", GetCharArrayOfString( GetReactionNodeName( reaction ) ),
-               (stoichiometry * rate));
+        if( state->isBoundary[i] ) {
+            continue;
+        }
+        f[i] *= GetConversionFactorInSimState( state, i );
+        TRACE_2( "change of %s is %g\n", GetCharArrayOfString( GetSpeciesNodeName( speciesArray[i] ) ), f[i] );
+    }
+    return GSL_SUCCESS;
+}
+
+/*
+ * Prepares the right-hand side evaluated by _Update.  The time symbols are resolved once, 
+ * the kinetic laws of the reactions and the math of the rules are compiled, and the 
+ * assignment rules are narrowed to the ones the reactions, the rate rules, the conversion 
+ * factors, the stoichiometries and the event triggers read, directly or through other 
+ * assignment rules.  The remaining assignment rules are executed once a step is taken.
+ */
+static RET_VAL _InitializeRightHandSide( ODE_SIMULATION_RECORD *rec ) {
+    UINT32 i = 0;
+    UINT32 j = 0;
+    UINT32 k = 0;
+    UINT32 index = 0;
+    UINT32 size = rec->speciesSize + rec->compartmentsSize + rec->symbolsSize;
+    BOOL changed = FALSE;
+    BYTE *marks = NULL;
+    BYTE *isSelected = NULL;
+    char *id = NULL;
+    RULE *rule = NULL;
+    SIM_STATE *state = rec->state;
+
+    if( ( rec->compiler = CreateKineticLawCompiler( state ) ) == NULL ) {
+        return ErrorReport( FAILING, "_InitializeRightHandSide", "could not create kinetic law compiler" );
+    }
+    rec->compiler->interpolateDelays = TRUE;
+    if( rec->symbolsSize > 0 ) {
+        if( ( rec->isTimeSymbol = (BYTE*)MALLOC( rec->symbolsSize * sizeof(BYTE) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_InitializeRightHandSide", "could not allocate memory for time symbols" );
+        }
+        for( i = 0; i < rec->symbolsSize; i++ ) {
+            id = GetCharArrayOfString( GetSymbolID( rec->symbolArray[i] ) );
+            rec->isTimeSymbol[i] = ( ( strcmp( id, "time" ) == 0 ) || ( strcmp( id, "t" ) == 0 ) ) ? 1 : 0;
+        }
+    }
+    if( rec->reactionsSize > 0 ) {
+        if( ( rec->ratePrograms = (KINETIC_LAW_PROGRAM**)MALLOC( rec->reactionsSize * sizeof(KINETIC_LAW_PROGRAM*) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_InitializeRightHandSide", "could not allocate memory for rate programs" );
+        }
+        for( i = 0; i < rec->reactionsSize; i++ ) {
+            rec->ratePrograms[i] = CompileKineticLaw( rec->compiler, GetKineticLawInReactionNode( rec->reactionArray[i] ), TRUE );
+        }
+    }
+    if( rec->rulesSize == 0 ) {
+        return SUCCESS;
+    }
+    if( ( rec->rulePrograms = (KINETIC_LAW_PROGRAM**)MALLOC( rec->rulesSize * sizeof(KINETIC_LAW_PROGRAM*) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_InitializeRightHandSide", "could not allocate memory for rule programs" );
+    }
+    rec->assignmentRulesSize = 0;
+    for( i = 0; i < rec->rulesSize; i++ ) {
+        rule = rec->ruleArray[i];
+        if( GetRuleType( rule ) == RULE_TYPE_ASSIGNMENT ) {
+            rec->assignmentRulesSize++;
+        }
+        else if( GetRuleType( rule ) != RULE_TYPE_RATE_ASSIGNMENT ) {
+            continue;
+        }
+        rec->rulePrograms[i] = CompileKineticLaw( rec->compiler, (KINETIC_LAW*)GetMathInRule( rule ), TRUE );
+    }
+    if( rec->assignmentRulesSize == 0 ) {
+        return SUCCESS;
+    }
+    if( ( rec->rateAssignmentRules = (UINT32*)MALLOC( rec->assignmentRulesSize * sizeof(UINT32) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_InitializeRightHandSide", "could not allocate memory for rate assignment rules" );
+    }
+    rec->rateAssignmentRulesSize = 0;
+
+    /* the algebraic rules may read anything */
+    if( rec->algebraicRulesSize > 0 ) {
+        for( i = 0; i < rec->rulesSize; i++ ) {
+            if( GetRuleType( rec->ruleArray[i] ) == RULE_TYPE_ASSIGNMENT ) {
+                rec->rateAssignmentRules[rec->rateAssignmentRulesSize++] = i;
+            }
+        }
+        return SUCCESS;
+    }
+
+    if( ( ( marks = (BYTE*)MALLOC( ( size + 1 ) * sizeof(BYTE) ) ) == NULL ) || 
+        ( ( isSelected = (BYTE*)MALLOC( rec->rulesSize * sizeof(BYTE) ) ) == NULL ) ) {
+        FREE( marks );
+        return ErrorReport( FAILING, "_InitializeRightHandSide", "could not allocate memory for variable marks" );
+    }
+    for( i = 0; i < rec->reactionsSize; i++ ) {
+        _MarkVariablesInKineticLaw( rec, GetKineticLawInReactionNode( rec->reactionArray[i] ), size, marks );
+        for( k = state->stoichiometryOffsets[i]; k < state->stoichiometryOffsets[i+1]; k++ ) {
+            if( state->stoichiometryReferences[k] != SIM_STATE_NO_INDEX ) {
+                marks[rec->speciesSize + rec->compartmentsSize + state->stoichiometryReferences[k]] = 1;
+            }
+        }
+    }
+    for( i = 0; i < rec->speciesSize; i++ ) {
+        if( state->conversionFactors[i] != SIM_STATE_NO_INDEX ) {
+            marks[rec->speciesSize + rec->compartmentsSize + state->conversionFactors[i]] = 1;
+        }
+    }
+    for( i = 0; i < rec->rulesSize; i++ ) {
+        rule = rec->ruleArray[i];
+        if( GetRuleType( rule ) != RULE_TYPE_RATE_ASSIGNMENT ) {
+            continue;
+        }
+        _MarkVariablesInKineticLaw( rec, (KINETIC_LAW*)GetMathInRule( rule ), size, marks );
+        /* the rate of a species in a changing compartment reads its concentration */
+        if( GetRuleVarType( rule ) == SPECIES_RULE ) {
+            j = GetRuleIndex( rule );
+            marks[j] = 1;
+            if( FindVariableInSimState( state, (CADDR_T)GetCompartmentInSpeciesNode( rec->speciesArray[j] ), &index ) ) {
+                marks[index] = 1;
+            }
+        }
+    }
+    for( i = 0; i < rec->eventsSize; i++ ) {
+        _MarkVariablesInKineticLaw( rec, GetTriggerInEvent( rec->eventArray[i] ), size, marks );
+    }
+
+    /* close over the assignment rules whose variables are read */
+    do {
+        changed = FALSE;
+        for( i = 0; i < rec->rulesSize; i++ ) {
+            rule = rec->ruleArray[i];
+            if( isSelected[i] || ( GetRuleType( rule ) != RULE_TYPE_ASSIGNMENT ) ) {
+                continue;
+            }
+            index = _GetRuleTargetIndex( rec, rule );
+            if( ( index < size ) && !marks[index] ) {
+                continue;
+            }
+            isSelected[i] = 1;
+            _MarkVariablesInKineticLaw( rec, (KINETIC_LAW*)GetMathInRule( rule ), size, marks );
+            changed = TRUE;
+        }
+    } while( changed );
+
+    for( i = 0; i < rec->rulesSize; i++ ) {
+        if( isSelected[i] ) {
+            rec->rateAssignmentRules[rec->rateAssignmentRulesSize++] = i;
+        }
+    }
+    TRACE_2( "%i of %i assignment rules are read by the rates\n", rec->rateAssignmentRulesSize, rec->assignmentRulesSize );
+
+    FREE( marks );
+    FREE( isSelected );
+    return SUCCESS;
+}
+
+/* the index in the values of the state of the variable rule assigns */
+static UINT32 _GetRuleTargetIndex( ODE_SIMULATION_RECORD *rec, RULE *rule ) {
+    BYTE varType = GetRuleVarType( rule );
+    UINT32 j = GetRuleIndex( rule );
+
+    if( varType == SPECIES_RULE ) {
+        return j;
+    }
+    else if( varType == COMPARTMENT_RULE ) {
+        return rec->speciesSize + j;
+    }
+    return rec->speciesSize + rec->compartmentsSize + j;
+}
+
+/* evaluates the math of the index-th rule with its compiled program if there is one */
+static double _EvaluateRule( ODE_SIMULATION_RECORD *rec, UINT32 index ) {
+    KINETIC_LAW_PROGRAM *program = rec->rulePrograms[index];
+
+    if( program != NULL ) {
+        return EvaluateKineticLawProgram( program, rec->state->values, NULL );
+    }
+    return rec->evaluator->EvaluateWithCurrentConcentrationsDeter( rec->evaluator, 
+                                                                    (KINETIC_LAW*)GetMathInRule( rec->ruleArray[index] ) );
+}
+
+/* 
+ * Allocates the values _LocateEventInStep keeps for the start of a step, for a point 
+ * inside it, and for the triggers at the ends and the middle of the bracket 
+ */
+static RET_VAL _InitializeEventLocation( ODE_SIMULATION_RECORD *rec ) {
+    UINT32 size = rec->speciesSize + rec->compartmentsSize + rec->symbolsSize + 1;
+
+    if( ( ( rec->stepStartValues = (double*)MALLOC( size * sizeof(double) ) ) == NULL ) ||
+        ( ( rec->eventValues = (double*)MALLOC( size * sizeof(double) ) ) == NULL ) ||
+        ( ( rec->eventErrors = (double*)MALLOC( size * sizeof(double) ) ) == NULL ) ) {
+        return ErrorReport( FAILING, "_InitializeEventLocation", "could not allocate memory for event location" );
+    }
+    if( ( ( rec->triggerValues = (double*)MALLOC( 3 * rec->eventsSize * sizeof(double) ) ) == NULL ) ||
+        ( ( rec->triggerFlags = (BYTE*)MALLOC( 3 * rec->eventsSize * sizeof(BYTE) ) ) == NULL ) ) {
+        return ErrorReport( FAILING, "_InitializeEventLocation", "could not allocate memory for triggers" );
+    }
+    return SUCCESS;
+}
+
+/* evaluates law with its compiled program if there is one */
+static double _EvaluateKineticLaw( ODE_SIMULATION_RECORD *rec, KINETIC_LAW *law ) {
+    KINETIC_LAW_PROGRAM *program = NULL;
+
+    if( ( program = CompileKineticLaw( rec->compiler, law, TRUE ) ) == NULL ) {
+        return rec->evaluator->EvaluateWithCurrentConcentrationsDeter( rec->evaluator, law );
+    }
+    return EvaluateKineticLawProgram( program, rec->state->values, NULL );
+}
+
+/* loads y into the state and brings the assignment rules the triggers read up to date */
+static void _LoadStateFromValues( ODE_SIMULATION_RECORD *rec, const double y[] ) {
+    UINT32 i = 0;
+
+    for( i = 0; i < rec->speciesSize; i++ ) {
+        SetSpeciesAmountInSimState( rec->state, i, y[i] );
+    }
+    for( i = 0; i < rec->compartmentsSize; i++ ) {
+        SetCompartmentSizeInSimState( rec->state, i, y[rec->speciesSize + i] );
+    }
+    for( i = 0; i < rec->symbolsSize; i++ ) {
+        SetSymbolValueInSimState( rec->state, i, y[rec->speciesSize + rec->compartmentsSize + i] );
+    }
+    ExecuteRateAssignments( rec );
+}
+
+/*
+ * Evaluates trigger on the current state and returns a function of time whose sign follows 
+ * it: the difference of the operands of an inequality, and +1 or -1 for any other trigger.
+ */
+static double _EvaluateTriggerFunction( ODE_SIMULATION_RECORD *rec, KINETIC_LAW *trigger, BOOL *isTriggered ) {
+    BYTE opType = 0;
+    double left = 0.0;
+    double right = 0.0;
+
+    if( trigger == NULL ) {
+        *isTriggered = FALSE;
+        return -1.0;
+    }
+    *isTriggered = ( _EvaluateKineticLaw( rec, trigger ) != 0.0 ) ? TRUE : FALSE;
+    if( IsOpKineticLaw( trigger ) ) {
+        opType = GetOpTypeFromKineticLaw( trigger );
+        if( ( opType == KINETIC_LAW_OP_GT ) || ( opType == KINETIC_LAW_OP_GEQ ) || 
+            ( opType == KINETIC_LAW_OP_LT ) || ( opType == KINETIC_LAW_OP_LEQ ) ) {
+            left = _EvaluateKineticLaw( rec, GetOpLeftFromKineticLaw( trigger ) );
+            right = _EvaluateKineticLaw( rec, GetOpRightFromKineticLaw( trigger ) );
+            if( ( opType == KINETIC_LAW_OP_GT ) || ( opType == KINETIC_LAW_OP_GEQ ) ) {
+                return left - right;
+            }
+            return right - left;
+        }
+    }
+    return *isTriggered ? 1.0 : -1.0;
+}
+
+/*
+ * Looks for triggers that were off at startTime and are on at *time, the end of the step 
+ * just taken.  If there are any, the earliest crossing is bracketed with the Illinois 
+ * variant of regula falsi until the bracket is narrower than the event tolerance, where 
+ * the solution inside the step is obtained by repeating the step from its start with a 
+ * shorter length.  *time and y are then moved to the end of the bracket, where the trigger 
+ * is on, and CHANGE is returned so the integrator can be restarted there.
+ */
+static RET_VAL _LocateEventInStep( ODE_SIMULATION_RECORD *rec, gsl_odeiv_step *step, gsl_odeiv_system *system, 
+                                   double startTime, double *time, double y[] ) {
+    UINT32 i = 0;
+    UINT32 iteration = 0;
+    UINT32 size = rec->speciesSize + rec->compartmentsSize + rec->symbolsSize;
+    UINT32 eventsSize = rec->eventsSize;
+    int side = 0;
+    int previousSide = 0;
+    double low = startTime;
+    double high = *time;
+    double middle = 0.0;
+    double estimate = 0.0;
+    double width = 0.0;
+    double alpha = 1.0;
+    double tolerance = rec->eventTolerance;
+    double *lowValues = rec->triggerValues;
+    double *highValues = rec->triggerValues + eventsSize;
+    double *middleValues = rec->triggerValues + 2 * eventsSize;
+    BYTE *isCandidate = rec->triggerFlags;
+    BYTE *isOnAtHigh = rec->triggerFlags + eventsSize;
+    BYTE *isOnAtMiddle = rec->triggerFlags + 2 * eventsSize;
+    BOOL isTriggered = FALSE;
+    BOOL hasCrossing = FALSE;
+
+    _LoadStateFromValues( rec, y );
+    for( i = 0; i < eventsSize; i++ ) {
+        isCandidate[i] = GetTriggerEnabledInEvent( rec->eventArray[i] ) ? 0 : 1;
+        isOnAtHigh[i] = 0;
+        if( isCandidate[i] ) {
+            highValues[i] = _EvaluateTriggerFunction( rec, GetTriggerInEvent( rec->eventArray[i] ), &isTriggered );
+            if( isTriggered ) {
+                isOnAtHigh[i] = 1;
+                hasCrossing = TRUE;
+            }
+        }
+    }
+    if( !hasCrossing ) {
+        return SUCCESS;
+    }
+    _LoadStateFromValues( rec, rec->stepStartValues );
+    for( i = 0; i < eventsSize; i++ ) {
+        if( isCandidate[i] ) {
+            lowValues[i] = _EvaluateTriggerFunction( rec, GetTriggerInEvent( rec->eventArray[i] ), &isTriggered );
+        }
+    }
+
+    while( ( high - low > tolerance ) && ( iteration < ODE_SIMULATION_MAX_EVENT_ITERATIONS ) ) {
+        iteration++;
+        width = high - low;
+        middle = high;
+        for( i = 0; i < eventsSize; i++ ) {
+            if( !isOnAtHigh[i] ) {
+                continue;
+            }
+            if( highValues[i] - alpha * lowValues[i] > 0.0 ) {
+                estimate = high - width * highValues[i] / ( highValues[i] - alpha * lowValues[i] );
+            }
+            else {
+                estimate = low + 0.5 * width;
+            }
+            if( estimate < middle ) {
+                middle = estimate;
+            }
+        }
+        /* keep away from the ends of the bracket, as in the root finding of CVODE */
+        if( middle - low < 0.5 * tolerance ) {
+            middle = low + ( ( width / tolerance > 5.0 ) ? 0.1 : 0.5 * tolerance / width ) * width;
+        }
+        if( high - middle < 0.5 * tolerance ) {
+            middle = high - ( ( width / tolerance > 5.0 ) ? 0.1 : 0.5 * tolerance / width ) * width;
+        }
+        if( !( middle > low ) || !( middle < high ) ) {
+            break;
+        }
+
+        memcpy( rec->eventValues, rec->stepStartValues, size * sizeof(double) );
+        _LoadStateFromValues( rec, rec->stepStartValues );
+        gsl_odeiv_step_reset( step );
+        if( gsl_odeiv_step_apply( step, startTime, middle - startTime, rec->eventValues, rec->eventErrors, 
+                                  NULL, NULL, system ) != GSL_SUCCESS ) {
+            return ErrorReport( FAILING, "_LocateEventInStep", "could not integrate to %g", middle );
+        }
+        _LoadStateFromValues( rec, rec->eventValues );
+        hasCrossing = FALSE;
+        for( i = 0; i < eventsSize; i++ ) {
+            isOnAtMiddle[i] = 0;
+            if( isCandidate[i] ) {
+                middleValues[i] = _EvaluateTriggerFunction( rec, GetTriggerInEvent( rec->eventArray[i] ), &isTriggered );
+                if( isTriggered ) {
+                    isOnAtMiddle[i] = 1;
+                    hasCrossing = TRUE;
+                }
+            }
+        }
+        if( hasCrossing ) {
+            high = middle;
+            memcpy( highValues, middleValues, eventsSize * sizeof(double) );
+            memcpy( isOnAtHigh, isOnAtMiddle, eventsSize * sizeof(BYTE) );
+            memcpy( y, rec->eventValues, size * sizeof(double) );
+            side = 1;
+        }
+        else {
+            low = middle;
+            memcpy( lowValues, middleValues, eventsSize * sizeof(double) );
+            side = 2;
+        }
+        /* Illinois: weigh down the end of the bracket that has not moved twice in a row */
+        if( side == previousSide ) {
+            alpha = ( side == 1 ) ? alpha * 0.5 : alpha * 2.0;
+        }
+        else {
+            alpha = 1.0;
+        }
+        previousSide = side;
+    }
+    TRACE_3( "event located at %g after %i iterations, step ended at %g\n", high, iteration, *time );
+
+    *time = high;
+    _LoadStateFromValues( rec, y );
+    return CHANGE;
+}
+
+/*
+ * Differentiates the kinetic law of every reaction and the math of every rate rule with 
+ * respect to each species it reads.  The partials of reaction r are 
+ * [reactionPartialOffsets[r], reactionPartialOffsets[r+1]) and those of rule i are 
+ * [rulePartialOffsets[i], rulePartialOffsets[i+1]).
+ *
+ * A law that reads the target of an assignment rule is differentiated with the target 
+ * replaced by the math of its rule, so the partials follow the chain rule through 
+ * assignment rules.
+ */
+static RET_VAL _InitializeJacobian( ODE_SIMULATION_RECORD *rec ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 next = 0;
+    UINT32 index = 0;
+    UINT32 valuesSize = rec->state->valuesSize;
+    BYTE varType;
+    BYTE *marks = NULL;
+    RULE **assignments = NULL;
+    KINETIC_LAW *law = NULL;
+    KINETIC_LAW **laws = NULL;
+
+    if( ( marks = (BYTE*)MALLOC( ( rec->speciesSize + 1 ) * sizeof(BYTE) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_InitializeJacobian", "could not allocate memory for species marks" );
+    }
+    if( ( rec->reactionPartialOffsets = (UINT32*)MALLOC( ( rec->reactionsSize + 1 ) * sizeof(UINT32) ) ) == NULL ) {
+        FREE( marks );
+        return ErrorReport( FAILING, "_InitializeJacobian", "could not allocate memory for reaction partials" );
+    }
+    if( ( rec->rulePartialOffsets = (UINT32*)MALLOC( ( rec->rulesSize + 1 ) * sizeof(UINT32) ) ) == NULL ) {
+        FREE( marks );
+        return ErrorReport( FAILING, "_InitializeJacobian", "could not allocate memory for rule partials" );
+    }
+    if( ( ( assignments = (RULE**)MALLOC( ( valuesSize + 1 ) * sizeof(RULE*) ) ) == NULL ) || 
+        ( ( laws = (KINETIC_LAW**)MALLOC( ( rec->reactionsSize + rec->rulesSize + 1 ) * sizeof(KINETIC_LAW*) ) ) == NULL ) ) {
+        FREE( marks );
+        FREE( assignments );
+        return ErrorReport( FAILING, "_InitializeJacobian", "could not allocate memory for expanded rates" );
+    }
+
+    /* the assignment rule of each variable in the values of the state, if any */
+    for( i = 0; i < rec->rulesSize; i++ ) {
+        if( GetRuleType( rec->ruleArray[i] ) != RULE_TYPE_ASSIGNMENT ) {
+            continue;
+        }
+        varType = GetRuleVarType( rec->ruleArray[i] );
+        index = GetRuleIndex( rec->ruleArray[i] );
+        if( varType == COMPARTMENT_RULE ) {
+            index += rec->speciesSize;
+        }
+        else if( varType == PARAMETER_RULE ) {
+            index += rec->speciesSize + rec->compartmentsSize;
+        }
+        else if( varType != SPECIES_RULE ) {
+            continue;
+        }
+        if( index < valuesSize ) {
+            assignments[index] = rec->ruleArray[i];
+        }
+    }
+    for( i = 0; i < rec->reactionsSize; i++ ) {
+        law = GetKineticLawInReactionNode( rec->reactionArray[i] );
+        if( ( law != NULL ) && ( ( laws[i] = _CreateRateWithAssignmentsExpanded( rec, law, assignments ) ) == NULL ) ) {
+            ret = ErrorReport( FAILING, "_InitializeJacobian", "the assignment rules read by the kinetic law of %s cannot be expanded", 
+                               GetCharArrayOfString( GetReactionNodeName( rec->reactionArray[i] ) ) );
+            goto END;
+        }
+    }
+    for( i = 0; i < rec->rulesSize; i++ ) {
+        if( GetRuleType( rec->ruleArray[i] ) != RULE_TYPE_RATE_ASSIGNMENT ) {
+            continue;
+        }
+        law = (KINETIC_LAW*)GetMathInRule( rec->ruleArray[i] );
+        if( ( law != NULL ) && 
+            ( ( laws[rec->reactionsSize + i] = _CreateRateWithAssignmentsExpanded( rec, law, assignments ) ) == NULL ) ) {
+            ret = ErrorReport( FAILING, "_InitializeJacobian", "the assignment rules read by the rate rule for %s cannot be expanded", 
+                               GetCharArrayOfString( GetRuleVar( rec->ruleArray[i] ) ) );
+            goto END;
+        }
+    }
+
+    for( i = 0; i < rec->reactionsSize; i++ ) {
+        rec->reactionPartialOffsets[i] = next;
+        memset( marks, 0, rec->speciesSize * sizeof(BYTE) );
+        next += _MarkVariablesInKineticLaw( rec, laws[i], rec->speciesSize, marks );
+    }
+    rec->reactionPartialOffsets[rec->reactionsSize] = next;
+    if( next > 0 ) {
+        if( ( ( rec->reactionPartialSpecies = (UINT32*)MALLOC( next * sizeof(UINT32) ) ) == NULL ) || 
+            ( ( rec->reactionPartials = (KINETIC_LAW**)MALLOC( next * sizeof(KINETIC_LAW*) ) ) == NULL ) ) {
+            ret = ErrorReport( FAILING, "_InitializeJacobian", "could not allocate memory for reaction partials" );
+            goto END;
+        }
+    }
+    next = 0;
+    for( i = 0; i < rec->reactionsSize; i++ ) {
+        if( IS_FAILED( ( ret = _CreatePartials( rec, laws[i], marks, &next, rec->reactionPartialSpecies, rec->reactionPartials ) ) ) ) {
+            ret = ErrorReport( ret, "_InitializeJacobian", "the kinetic law of %s cannot be differentiated", 
+                               GetCharArrayOfString( GetReactionNodeName( rec->reactionArray[i] ) ) );
+            goto END;
+        }
+    }
+
+    next = 0;
+    for( i = 0; i < rec->rulesSize; i++ ) {
+        rec->rulePartialOffsets[i] = next;
+        if( GetRuleType( rec->ruleArray[i] ) == RULE_TYPE_RATE_ASSIGNMENT ) {
+            memset( marks, 0, rec->speciesSize * sizeof(BYTE) );
+            next += _MarkVariablesInKineticLaw( rec, laws[rec->reactionsSize + i], rec->speciesSize, marks );
+        }
+    }
+    rec->rulePartialOffsets[rec->rulesSize] = next;
+    if( next > 0 ) {
+        if( ( ( rec->rulePartialSpecies = (UINT32*)MALLOC( next * sizeof(UINT32) ) ) == NULL ) || 
+            ( ( rec->rulePartials = (KINETIC_LAW**)MALLOC( next * sizeof(KINETIC_LAW*) ) ) == NULL ) ) {
+            ret = ErrorReport( FAILING, "_InitializeJacobian", "could not allocate memory for rule partials" );
+            goto END;
+        }
+    }
+    next = 0;
+    for( i = 0; i < rec->rulesSize; i++ ) {
+        if( GetRuleType( rec->ruleArray[i] ) != RULE_TYPE_RATE_ASSIGNMENT ) {
+            continue;
+        }
+        if( IS_FAILED( ( ret = _CreatePartials( rec, laws[rec->reactionsSize + i], marks, &next, 
+                                                rec->rulePartialSpecies, rec->rulePartials ) ) ) ) {
+            ret = ErrorReport( ret, "_InitializeJacobian", "the rate rule for %s cannot be differentiated", 
+                               GetCharArrayOfString( GetRuleVar( rec->ruleArray[i] ) ) );
+            goto END;
+        }
+    }
+    rec->hasJacobian = TRUE;
+
+END:
+    for( i = 0; i < rec->reactionsSize + rec->rulesSize; i++ ) {
+        if( laws[i] != NULL ) {
+            FreeKineticLaw( &(laws[i]) );
+        }
+    }
+    FREE( laws );
+    FREE( assignments );
+    FREE( marks );
+    return ret;
+}
+
+/* 
+ * creates a copy of law in which every target of an assignment rule is replaced by the 
+ * math of its rule, repeatedly, so the copy reads no target of an assignment rule 
+ */
+static KINETIC_LAW *_CreateRateWithAssignmentsExpanded( ODE_SIMULATION_RECORD *rec, KINETIC_LAW *law, RULE **assignments ) {
+    KINETIC_LAW *expanded = NULL;
+
+    if( law == NULL ) {
+        return NULL;
+    }
+    if( ( expanded = CloneKineticLaw( law ) ) == NULL ) {
+        return NULL;
+    }
+    if( IS_FAILED( _ExpandAssignmentsInKineticLaw( rec, expanded, assignments, 0 ) ) ) {
+        FreeKineticLaw( &expanded );
+        return NULL;
+    }
+    return expanded;
+}
+
+/* 
+ * replaces the targets of assignment rules in law by the math of their rules; depth counts 
+ * the rules being expanded, and more of them than there are rules means the rules are cyclic 
+ */
+static RET_VAL _ExpandAssignmentsInKineticLaw( ODE_SIMULATION_RECORD *rec, KINETIC_LAW *law, RULE **assignments, UINT32 depth ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 index = 0;
+    CADDR_T node = NULL;
+    KINETIC_LAW *replacement = NULL;
+    LINKED_LIST *children = NULL;
+
+    if( law == NULL ) {
+        return SUCCESS;
+    }
+    if( IsOpKineticLaw( law ) ) {
+        if( IS_FAILED( ( ret = _ExpandAssignmentsInKineticLaw( rec, GetOpLeftFromKineticLaw( law ), assignments, depth ) ) ) ) {
+            return ret;
+        }
+        return _ExpandAssignmentsInKineticLaw( rec, GetOpRightFromKineticLaw( law ), assignments, depth );
+    }
+    if( IsUnaryOpKineticLaw( law ) ) {
+        return _ExpandAssignmentsInKineticLaw( rec, GetUnaryOpChildFromKineticLaw( law ), assignments, depth );
+    }
+    if( IsPWKineticLaw( law ) ) {
+        children = GetPWChildrenFromKineticLaw( law );
+        for( i = 0; i < GetLinkedListSize( children ); i++ ) {
+            if( IS_FAILED( ( ret = _ExpandAssignmentsInKineticLaw( rec, (KINETIC_LAW*)GetElementByIndex( i, children ), 
+                                                                   assignments, depth ) ) ) ) {
+                return ret;
+            }
+        }
+        return SUCCESS;
+    }
+    if( IsSpeciesKineticLaw( law ) ) {
+        node = (CADDR_T)GetSpeciesFromKineticLaw( law );
+    }
+    else if( IsCompartmentKineticLaw( law ) ) {
+        node = (CADDR_T)GetCompartmentFromKineticLaw( law );
+    }
+    else if( IsSymbolKineticLaw( law ) ) {
+        node = (CADDR_T)GetSymbolFromKineticLaw( law );
+    }
+    if( ( node == NULL ) || !FindVariableInSimState( rec->state, node, &index ) || 
+        ( index >= rec->state->valuesSize ) || ( assignments[index] == NULL ) ) {
+        return SUCCESS;
+    }
+    if( depth >= rec->rulesSize ) {
+        return ErrorReport( FAILING, "_ExpandAssignmentsInKineticLaw", "the assignment rule for %s reads itself", 
+                            GetCharArrayOfString( GetRuleVar( assignments[index] ) ) );
+    }
+    if( ( replacement = CloneKineticLaw( (KINETIC_LAW*)GetMathInRule( assignments[index] ) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_ExpandAssignmentsInKineticLaw", "could not copy the assignment rule for %s", 
+                            GetCharArrayOfString( GetRuleVar( assignments[index] ) ) );
+    }
+    if( IS_FAILED( ( ret = _ExpandAssignmentsInKineticLaw( rec, replacement, assignments, depth + 1 ) ) ) ) {
+        FreeKineticLaw( &replacement );
+        return ret;
+    }
+    /* a variable node owns nothing, so it can take over the root of the replacement */
+    *law = *replacement;
+    FREE( replacement );
+    return SUCCESS;
+}
+
+/* 
+ * marks the variables below limit in the values of the state that law reads and that are 
+ * not marked yet, and returns how many there are; a species that is not in substance 
+ * units also reads the size of its compartment 
+ */
+static UINT32 _MarkVariablesInKineticLaw( ODE_SIMULATION_RECORD *rec, KINETIC_LAW *law, UINT32 limit, BYTE *marks ) {
+    UINT32 i = 0;
+    UINT32 count = 0;
+    UINT32 index = 0;
+    CADDR_T node = NULL;
+    SPECIES *species = NULL;
+    KINETIC_LAW *child = NULL;
+    LINKED_LIST *children = NULL;
+
+    if( law == NULL ) {
+        return 0;
+    }
+    if( IsSpeciesKineticLaw( law ) ) {
+        species = GetSpeciesFromKineticLaw( law );
+        node = (CADDR_T)species;
+        if( !HasOnlySubstanceUnitsInSpeciesNode( species ) && 
+            FindVariableInSimState( rec->state, (CADDR_T)GetCompartmentInSpeciesNode( species ), &index ) && 
+            ( index < limit ) && !marks[index] ) {
+            marks[index] = 1;
+            count++;
+        }
+    }
+    else if( IsCompartmentKineticLaw( law ) ) {
+        node = (CADDR_T)GetCompartmentFromKineticLaw( law );
+    }
+    else if( IsSymbolKineticLaw( law ) ) {
+        node = (CADDR_T)GetSymbolFromKineticLaw( law );
+    }
+    if( node != NULL ) {
+        if( FindVariableInSimState( rec->state, node, &index ) && ( index < limit ) && !marks[index] ) {
+            marks[index] = 1;
+            count++;
+        }
+        return count;
+    }
+    if( IsOpKineticLaw( law ) ) {
+        count = _MarkVariablesInKineticLaw( rec, GetOpLeftFromKineticLaw( law ), limit, marks );
+        return count + _MarkVariablesInKineticLaw( rec, GetOpRightFromKineticLaw( law ), limit, marks );
+    }
+    if( IsUnaryOpKineticLaw( law ) ) {
+        return _MarkVariablesInKineticLaw( rec, GetUnaryOpChildFromKineticLaw( law ), limit, marks );
+    }
+    if( IsPWKineticLaw( law ) ) {
+        children = GetPWChildrenFromKineticLaw( law );
+        for( i = 0; i < GetLinkedListSize( children ); i++ ) {
+            child = (KINETIC_LAW*)GetElementByIndex( i, children );
+            count += _MarkVariablesInKineticLaw( rec, child, limit, marks );
+        }
+    }
+    return count;
+}
+
+/* stores the non-zero partials of law from position *next on */
+static RET_VAL _CreatePartials( ODE_SIMULATION_RECORD *rec, KINETIC_LAW *law, BYTE *marks, UINT32 *next, 
+                                UINT32 *partialSpecies, KINETIC_LAW **partials ) {
+    UINT32 j = 0;
+    KINETIC_LAW *partial = NULL;
+
+    memset( marks, 0, rec->speciesSize * sizeof(BYTE) );
+    if( _MarkVariablesInKineticLaw( rec, law, rec->speciesSize, marks ) == 0 ) {
+        return SUCCESS;
+    }
+    for( j = 0; j < rec->speciesSize; j++ ) {
+        if( !marks[j] ) {
+            continue;
+        }
+        if( ( partial = CreateDerivativeOfKineticLaw( law, rec->speciesArray[j] ) ) == NULL ) {
+            return FAILING;
+        }
+        partialSpecies[*next] = j;
+        partials[*next] = partial;
+        (*next)++;
+    }
+    return SUCCESS;
+}
+
+/* evaluates a partial with respect to the value of a species and converts it to one with respect to its amount */
+static double _EvaluatePartial( ODE_SIMULATION_RECORD *rec, KINETIC_LAW *partial, UINT32 speciesIndex ) {
+    double value = 0.0;
+    SPECIES *species = rec->speciesArray[speciesIndex];
+
+    if( IsRealValueKineticLaw( partial ) ) {
+        value = GetRealValueFromKineticLaw( partial );
+    }
+    else {
+        value = rec->evaluator->EvaluateWithCurrentConcentrationsDeter( rec->evaluator, partial );
+    }
+    if( !HasOnlySubstanceUnitsInSpeciesNode( species ) ) {
+        value /= GetCurrentSizeInCompartment( GetCompartmentInSpeciesNode( species ) );
+    }
+    if( !( fabs( value ) < DBL_MAX ) ) {
+        value = 0.0;
+    }
+    return value;
+}
+
+/*
+ * Jacobian of _Update with respect to the species amounts.  Compartment sizes and symbol 
+ * values are treated as constant, so their columns are zero; the time dependence enters 
+ * through the time symbol, so dfdt is zero.
+ */
+static int _Jacobian( double t, const double y[], double *dfdy, double dfdt[], ODE_SIMULATION_RECORD *rec ) {
+    UINT32 i = 0;
+    UINT32 j = 0;
+    UINT32 k = 0;
+    UINT32 p = 0;
+    UINT32 row = 0;
+    UINT32 speciesSize = rec->speciesSize;
+    UINT32 compartmentsSize = rec->compartmentsSize;
+    UINT32 size = speciesSize + compartmentsSize + rec->symbolsSize;
+    double scale = 0.0;
+    double partial = 0.0;
+    double conversionFactor = 0.0;
+    BYTE varType;
+    SPECIES **speciesArray = rec->speciesArray;
+    SIM_STATE *state = rec->state;
+
+    /* Update values from y[] the way _Update does */
+    for( i = 0; i < speciesSize; i++ ) {
+        if( GetRateInSpeciesNode( speciesArray[i] ) != 0.0 ) {
+            SetSpeciesAmountInSimState( state, i, y[i] );
+        }
+    }
+    for( i = 0; i < compartmentsSize; i++ ) {
+        if( GetCurrentRateInCompartment( rec->compartmentArray[i] ) != 0.0 ) {
+            SetCompartmentSizeInSimState( state, i, y[speciesSize + i] );
+        }
+    }
+    for( i = 0; i < rec->symbolsSize; i++ ) {
+        if( GetCurrentRateInSymbol( rec->symbolArray[i] ) != 0.0 ) {
+            SetSymbolValueInSimState( state, i, y[speciesSize + compartmentsSize + i] );
+        }
+    }
+    ExecuteRateAssignments( rec );
+
+    for( i = 0; i < size * size; i++ ) {
+        dfdy[i] = 0.0;
+    }
+    for( i = 0; i < size; i++ ) {
+        dfdt[i] = 0.0;
+    }
+
+    /* rate rules */
+    for( i = 0; i < rec->rulesSize; i++ ) {
+        if( rec->rulePartialOffsets[i] == rec->rulePartialOffsets[i+1] ) {
+            continue;
+        }
+        varType = GetRuleVarType( rec->ruleArray[i] );
+        j = GetRuleIndex( rec->ruleArray[i] );
+        scale = 1.0;
+        if( varType == SPECIES_RULE ) {
+            row = j;
+            if( !HasOnlySubstanceUnitsInSpeciesNode( speciesArray[j] ) ) {
+                scale = GetCurrentSizeInCompartment( GetCompartmentInSpeciesNode( speciesArray[j] ) );
+            }
+        } 
+        else if( varType == COMPARTMENT_RULE ) {
+            row = speciesSize + j;
+        } 
+        else {
+            row = speciesSize + compartmentsSize + j;
+        }
+        for( p = rec->rulePartialOffsets[i]; p < rec->rulePartialOffsets[i+1]; p++ ) {
+            partial = _EvaluatePartial( rec, rec->rulePartials[p], rec->rulePartialSpecies[p] );
+            dfdy[row * size + rec->rulePartialSpecies[p]] += scale * partial;
+        }
+    }
+
+    /* reactions, over the same stoichiometry matrix as _Update */
+    for( i = 0; i < rec->reactionsSize; i++ ) {
+        if( state->isFast[i] ) {
+            continue;
+        }
+        for( p = rec->reactionPartialOffsets[i]; p < rec->reactionPartialOffsets[i+1]; p++ ) {
+            partial = _EvaluatePartial( rec, rec->reactionPartials[p], rec->reactionPartialSpecies[p] );
+            if( partial == 0.0 ) {
+                continue;
+            }
+            for( k = state->stoichiometryOffsets[i]; k < state->stoichiometryOffsets[i+1]; k++ ) {
+                j = state->stoichiometrySpecies[k];
+                if( state->isBoundary[j] ) {
+                    continue;
+                }
+                if( k < state->productOffsets[i] ) {
+                    dfdy[j * size + rec->reactionPartialSpecies[p]] -= GetStoichiometryInSimState( state, k ) * partial;
+                }
+                else {
+                    dfdy[j * size + rec->reactionPartialSpecies[p]] += GetStoichiometryInSimState( state, k ) * partial;
+                }
+            }
+        }
+    }
+    for( i = 0; i < speciesSize; i++ ) {
+        if( state->isBoundary[i] ) {
+            continue;
+        }
+        conversionFactor = GetConversionFactorInSimState( state, i );
+        if( conversionFactor != 1.0 ) {
+            for( j = 0; j < speciesSize; j++ ) {
+                dfdy[i * size + j] *= conversionFactor;
+            }
         }
-	if (( convFactor = GetConversionFactorInSpeciesNode( species ) )!=NULL) {
-	  f[i] *= GetCurrentRealValueInSymbol( convFactor );
-	}
-        TRACE_2( "change of %s is %g\n", GetCharArrayOfString( GetSpeciesNodeName( species ) ), f[i] );
     }
     return GSL_SUCCESS;
 }
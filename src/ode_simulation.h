@@ -21,6 +21,8 @@
 #define HAVE_ODE_SIMULATION
 
 #include "simulation_method.h"
+#include "sim_state.h"
+#include "kinetic_law_program.h"
 #include <gsl/gsl_matrix.h>
 
 BEGIN_C_NAMESPACE
@@ -28,6 +30,7 @@ BEGIN_C_NAMESPACE
 //#define ODE_SIMULATION_ABSOLUTE_ERROR 1.0e-9
 //#define ODE_SIMULATION_LOCAL_ERROR 0.0
 #define ODE_SIMULATION_H 1.0e-9
+#define ODE_SIMULATION_MAX_EVENT_ITERATIONS 100
 
 DLLSCOPE RET_VAL STDCALL DoODESimulation( BACK_END_PROCESSOR *backend, IR *ir );
 DLLSCOPE RET_VAL STDCALL CloseODESimulation( BACK_END_PROCESSOR *backend );
@@ -69,7 +72,28 @@ typedef struct {
     double originalTimeStep;
     double absoluteError;
     double relativeError;
+    double eventTolerance;
     KINETIC_LAW_EVALUATER *evaluator;
+    SIM_STATE *state;
+    KINETIC_LAW_COMPILER *compiler;
+    KINETIC_LAW_PROGRAM **ratePrograms;
+    KINETIC_LAW_PROGRAM **rulePrograms;
+    BYTE *isTimeSymbol;
+    UINT32 assignmentRulesSize;
+    UINT32 *rateAssignmentRules;
+    UINT32 rateAssignmentRulesSize;
+    double *stepStartValues;
+    double *eventValues;
+    double *eventErrors;
+    double *triggerValues;
+    BYTE *triggerFlags;
+    BOOL hasJacobian;
+    UINT32 *reactionPartialOffsets;
+    UINT32 *reactionPartialSpecies;
+    KINETIC_LAW **reactionPartials;
+    UINT32 *rulePartialOffsets;
+    UINT32 *rulePartialSpecies;
+    KINETIC_LAW **rulePartials;
     KINETIC_LAW_FIND_NEXT_TIME *findNextTime;
     UINT32 seed;
     UINT32 runs; 
@@ -96,7 +96,7 @@ static RET_VAL _ApplyPowKineticLawTransformationMethod( ABSTRACTION_METHOD *meth
 }      
 
 static RET_VAL _TransformPowOfMultiplicationTerm( ABSTRACTION_METHOD *method, IR *ir, REACTION *reaction ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;    
     KINETIC_LAW *kineticLaw = NULL;
 #ifdef DEBUG
@@ -105,13 +105,12 @@ static RET_VAL _TransformPowOfMultiplicationTerm( ABSTRACTION_METHOD *method, IR
 
     START_FUNCTION("_TransformPowOfMultiplicationTerm");
 
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToTransformPowOfMultiplicationTerm;
-        visitor.VisitInt = _VisitIntToTransformPowOfMultiplicationTerm;
-        visitor.VisitReal = _VisitRealToTransformPowOfMultiplicationTerm;
-        visitor.VisitSpecies = _VisitSpeciesToTransformPowOfMultiplicationTerm;
-        visitor.VisitSymbol = _VisitSymbolToTransformPowOfMultiplicationTerm;
-    }    
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToTransformPowOfMultiplicationTerm;
+    visitor.VisitInt = _VisitIntToTransformPowOfMultiplicationTerm;
+    visitor.VisitReal = _VisitRealToTransformPowOfMultiplicationTerm;
+    visitor.VisitSpecies = _VisitSpeciesToTransformPowOfMultiplicationTerm;
+    visitor.VisitSymbol = _VisitSymbolToTransformPowOfMultiplicationTerm;
 
     kineticLaw = GetKineticLawInReactionNode( reaction );
     
@@ -243,20 +242,19 @@ static RET_VAL _VisitSymbolToTransformPowOfMultiplicationTerm( KINETIC_LAW_VISIT
 
 
 static BOOL _IsMultiplicationTerm( KINETIC_LAW *kineticLaw ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;    
     BOOL isMultiplicationTerm = TRUE;
 
     if( !IsOpKineticLaw( kineticLaw ) ) {
         return FALSE;
     }
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpForMultiplicationTerm;
-        visitor.VisitInt = _VisitIntForMultiplicationTerm;
-        visitor.VisitReal = _VisitRealForMultiplicationTerm;
-        visitor.VisitSpecies = _VisitSpeciesForMultiplicationTerm;
-        visitor.VisitSymbol = _VisitSymbolForMultiplicationTerm;
-    }    
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpForMultiplicationTerm;
+    visitor.VisitInt = _VisitIntForMultiplicationTerm;
+    visitor.VisitReal = _VisitRealForMultiplicationTerm;
+    visitor.VisitSpecies = _VisitSpeciesForMultiplicationTerm;
+    visitor.VisitSymbol = _VisitSymbolForMultiplicationTerm;
 
     visitor._internal1 = (CADDR_T)(&isMultiplicationTerm);
     if( IS_FAILED( ( ret = kineticLaw->Accept( kineticLaw, &visitor ) ) ) ) {    
@@ -317,17 +315,16 @@ static RET_VAL _VisitSymbolForMultiplicationTerm( KINETIC_LAW_VISITOR *visitor,
 
 
 static KINETIC_LAW *_CreateReplacement( KINETIC_LAW *kineticLaw, double power ) {
-    static KINETIC_LAW_VISITOR visitor;
+    KINETIC_LAW_VISITOR visitor;
     RET_VAL ret = SUCCESS;    
     BOOL isMultiplicationTerm = FALSE;
 
-    if( visitor.VisitOp == NULL ) {
-        visitor.VisitOp = _VisitOpToCreateReplacement;
-        visitor.VisitInt = _VisitIntToCreateReplacement;
-        visitor.VisitReal = _VisitRealToCreateReplacement;
-        visitor.VisitSpecies = _VisitSpeciesToCreateReplacement;
-        visitor.VisitSymbol = _VisitSymbolToCreateReplacement;
-    }    
+    memset( &visitor, 0, sizeof(visitor) );
+    visitor.VisitOp = _VisitOpToCreateReplacement;
+    visitor.VisitInt = _VisitIntToCreateReplacement;
+    visitor.VisitReal = _VisitRealToCreateReplacement;
+    visitor.VisitSpecies = _VisitSpeciesToCreateReplacement;
+    visitor.VisitSymbol = _VisitSymbolToCreateReplacement;
     
     visitor._internal1 = NULL;
     visitor._internal2 = (CADDR_T)(&power);
@@ -18,12 +18,51 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 #include <math.h>
+#include <stdint.h>
 #include <gsl/gsl_rng.h>
 #include <gsl/gsl_randist.h>
 #include "random_number_generator.h"
 
+/* Philox4x32-10 (Salmon et al., SC'11) wrapped as a gsl_rng_type so gsl_ran_* can use it */
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U
+#define PHILOX_W1 0xBB67AE85U
+#define PHILOX_ROUNDS 10
+#define PHILOX_TWO_TO_MINUS_32 2.3283064365386963e-10
+
+typedef struct {
+    uint32_t key[2];
+    uint32_t counter[4];
+    uint32_t output[4];
+    int index;
+} PHILOX_STATE;
+
+struct _RANDOM_NUMBER_CONTEXT {
+    gsl_rng *rng;
+};
+
+static void _PhiloxBlock( PHILOX_STATE *state );
+static void _PhiloxSet( void *vstate, unsigned long int s );
+static unsigned long int _PhiloxGet( void *vstate );
+static double _PhiloxGetDouble( void *vstate );
+
+static const gsl_rng_type _philoxType = {
+    "philox4x32",
+    0xffffffffUL,
+    0,
+    sizeof(PHILOX_STATE),
+    &_PhiloxSet,
+    &_PhiloxGet,
+    &_PhiloxGetDouble
+};
+
+static RANDOM_NUMBER_CONTEXT _defaultContext;
+
 gsl_rng * r;
 
+#define _GET_RNG(context) ( ( (context) == NULL ) ? _defaultContext.rng : (context)->rng )
+
 void CreateRandomNumberGenerators( ) {
   const gsl_rng_type * T;
      
@@ -31,11 +70,14 @@ void CreateRandomNumberGenerators( ) {
      
   T = gsl_rng_default;
   r = gsl_rng_alloc(T);
+  _defaultContext.rng = r;
 }
 
 void FreeRandomNumberGenerators( ) {
 
   gsl_rng_free(r);
+  r = NULL;
+  _defaultContext.rng = NULL;
 }
 
 void SeedRandomNumberGenerators( double s ) {
@@ -43,26 +85,163 @@ void SeedRandomNumberGenerators( double s ) {
   gsl_rng_set(r,s);
 }
 
+RANDOM_NUMBER_CONTEXT *CreateRandomNumberContext( ) {
+    RANDOM_NUMBER_CONTEXT *context = NULL;
+
+    if( ( context = (RANDOM_NUMBER_CONTEXT*)MALLOC( sizeof(RANDOM_NUMBER_CONTEXT) ) ) == NULL ) {
+        return NULL;
+    }
+    if( ( context->rng = gsl_rng_alloc( &_philoxType ) ) == NULL ) {
+        FREE( context );
+        return NULL;
+    }
+    return context;
+}
+
+void FreeRandomNumberContext( RANDOM_NUMBER_CONTEXT **context ) {
+    if( ( context == NULL ) || ( *context == NULL ) ) {
+        return;
+    }
+    gsl_rng_free( (*context)->rng );
+    FREE( *context );
+    *context = NULL;
+}
+
+/*
+ * Positions the context at the start of stream number stream for the given seed.  For 
+ * counter-based contexts this is O(1); the default generator falls back to a plain reseed.
+ */
+void SeedRandomNumberContext( RANDOM_NUMBER_CONTEXT *context, UINT32 seed, UINT32 stream ) {
+    gsl_rng *rng = _GET_RNG( context );
+    PHILOX_STATE *state = NULL;
+
+    if( rng->type != &_philoxType ) {
+        gsl_rng_set( rng, (unsigned long int)seed + 2654435761UL * (unsigned long int)stream );
+        return;
+    }
+    state = (PHILOX_STATE*)(rng->state);
+    state->key[0] = (uint32_t)seed;
+    state->key[1] = (uint32_t)stream;
+    state->counter[0] = state->counter[1] = state->counter[2] = state->counter[3] = 0;
+    state->index = 4;
+}
+
+RANDOM_NUMBER_CONTEXT *GetDefaultRandomNumberContext( ) {
+    return &_defaultContext;
+}
+
+/*
+ * Fills values with n uniform deviates in (0,1).  Counter-based contexts generate 
+ * whole blocks at once instead of going through gsl_rng_uniform for every value.
+ */
+void FillUnitUniformRandomNumbersInContext( RANDOM_NUMBER_CONTEXT *context, double *values, UINT32 n ) {
+    gsl_rng *rng = _GET_RNG( context );
+    PHILOX_STATE *state = NULL;
+    UINT32 i = 0;
+
+    if( rng->type != &_philoxType ) {
+        for( i = 0; i < n; i++ ) {
+            values[i] = gsl_rng_uniform_pos( rng );
+        }
+        return;
+    }
+    state = (PHILOX_STATE*)(rng->state);
+    while( ( i < n ) && ( state->index < 4 ) ) {
+        values[i++] = ( (double)(state->output[state->index++]) + 0.5 ) * PHILOX_TWO_TO_MINUS_32;
+    }
+    for( ; i + 4 <= n; i += 4 ) {
+        _PhiloxBlock( state );
+        values[i] = ( (double)(state->output[0]) + 0.5 ) * PHILOX_TWO_TO_MINUS_32;
+        values[i + 1] = ( (double)(state->output[1]) + 0.5 ) * PHILOX_TWO_TO_MINUS_32;
+        values[i + 2] = ( (double)(state->output[2]) + 0.5 ) * PHILOX_TWO_TO_MINUS_32;
+        values[i + 3] = ( (double)(state->output[3]) + 0.5 ) * PHILOX_TWO_TO_MINUS_32;
+    }
+    state->index = 4;
+    if( i < n ) {
+        _PhiloxBlock( state );
+        state->index = 0;
+        while( i < n ) {
+            values[i++] = ( (double)(state->output[state->index++]) + 0.5 ) * PHILOX_TWO_TO_MINUS_32;
+        }
+    }
+}
+
 double GetNextUniformRandomNumber( double minUniform, double maxUniform ) {
-  return gsl_ran_flat( r, minUniform, maxUniform );
+  return GetNextUniformRandomNumberInContext( NULL, minUniform, maxUniform );
 }
 
-double GetNextUnitUniformRandomNumber( double minUniform, double maxUniform ) {
-  return gsl_ran_flat( r, 0.0, 1.0 );
+double GetNextUnitUniformRandomNumber( ) {
+  return GetNextUnitUniformRandomNumberInContext( NULL );
 }
 
 double GetNextNormalRandomNumber( double mean, double stdDeviation ) {
+  return GetNextNormalRandomNumberInContext( NULL, mean, stdDeviation );
+}
+
+double GetNextUnitNormalRandomNumber( ) {
+  return GetNextUnitNormalRandomNumberInContext( NULL );
+}
+
+double GetNextExponentialRandomNumber( double lambda ) {
+  return GetNextExponentialRandomNumberInContext( NULL, lambda );
+}
+
+double GetNextGammaRandomNumber( double a, double b ) {
+  return GetNextGammaRandomNumberInContext( NULL, a, b );
+}
+
+double GetNextPoissonRandomNumber( double mu ) {
+  return GetNextPoissonRandomNumberInContext( NULL, mu );
+}
+
+double GetNextBinomialRandomNumber( double p, unsigned int n ) {
+  return GetNextBinomialRandomNumberInContext( NULL, p, n );
+}
+
+double GetNextLogNormalRandomNumber( double zeta, double sigma ) {
+  return GetNextLogNormalRandomNumberInContext( NULL, zeta, sigma );
+}
+
+double GetNextChiSquaredRandomNumber( double nu ) {
+  return GetNextChiSquaredRandomNumberInContext( NULL, nu );
+}
+
+double GetNextLaplaceRandomNumber( double a ) {
+  return GetNextLaplaceRandomNumberInContext( NULL, a );
+}
+
+double GetNextCauchyRandomNumber( double a ) {
+  return GetNextCauchyRandomNumberInContext( NULL, a );
+}
+
+double GetNextRayleighRandomNumber( double a ) {
+  return GetNextRayleighRandomNumberInContext( NULL, a );
+}
+
+double GetNextBernoulliRandomNumber( double a ) {
+  return GetNextBernoulliRandomNumberInContext( NULL, a );
+}
+
+double GetNextUniformRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double minUniform, double maxUniform ) {
+  return gsl_ran_flat( _GET_RNG( context ), minUniform, maxUniform );
+}
+
+double GetNextUnitUniformRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context ) {
+  return gsl_ran_flat( _GET_RNG( context ), 0.0, 1.0 );
+}
+
+double GetNextNormalRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double mean, double stdDeviation ) {
     double unitNormal = 0.0;
     double normal = 0.0;
 
-    unitNormal = GetNextUnitNormalRandomNumber();
+    unitNormal = GetNextUnitNormalRandomNumberInContext( context );
     normal = ( unitNormal * stdDeviation ) + mean;
     
     return normal;
 }
 
-double GetNextUnitNormalRandomNumber( ) {
-  return gsl_ran_gaussian(r, 1.0);
+double GetNextUnitNormalRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context ) {
+  return gsl_ran_gaussian( _GET_RNG( context ), 1.0 );
   /*    static BOOL haveNextNormal = FALSE;
     static double nextNormal = 0.0;
     
@@ -90,42 +269,99 @@ double GetNextUnitNormalRandomNumber( ) {
 	} */
 }
 
-double GetNextExponentialRandomNumber( double lambda ) {
-  return gsl_ran_exponential(r, 1/lambda);
+double GetNextExponentialRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double lambda ) {
+  return gsl_ran_exponential( _GET_RNG( context ), 1/lambda );
 }
 
-double GetNextGammaRandomNumber( double a, double b ) {
-    return gsl_ran_gamma(r, a, b);
+double GetNextGammaRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double a, double b ) {
+    return gsl_ran_gamma( _GET_RNG( context ), a, b );
 }
 
-double GetNextPoissonRandomNumber( double mu ) {
-  return (double)gsl_ran_poisson(r, mu);
+double GetNextPoissonRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double mu ) {
+  return (double)gsl_ran_poisson( _GET_RNG( context ), mu );
 }
 
-double GetNextBinomialRandomNumber( double p, unsigned int n ) {
-  return (double)gsl_ran_binomial(r, p, n);
+double GetNextBinomialRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double p, unsigned int n ) {
+  return (double)gsl_ran_binomial( _GET_RNG( context ), p, n );
 }
 
-double GetNextLogNormalRandomNumber( double zeta, double sigma ) {
-  return gsl_ran_lognormal(r, zeta, sigma);
+double GetNextLogNormalRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double zeta, double sigma ) {
+  return gsl_ran_lognormal( _GET_RNG( context ), zeta, sigma );
 }
 
-double GetNextChiSquaredRandomNumber( double nu ) {
-  return gsl_ran_chisq(r, nu);
+double GetNextChiSquaredRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double nu ) {
+  return gsl_ran_chisq( _GET_RNG( context ), nu );
 }
 
-double GetNextLaplaceRandomNumber( double a ) {
-  return gsl_ran_laplace(r, a);
+double GetNextLaplaceRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double a ) {
+  return gsl_ran_laplace( _GET_RNG( context ), a );
 }
 
-double GetNextCauchyRandomNumber( double a ) {
-  return gsl_ran_cauchy(r, a);
+double GetNextCauchyRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double a ) {
+  return gsl_ran_cauchy( _GET_RNG( context ), a );
 }
 
-double GetNextRayleighRandomNumber( double a ) {
-  return gsl_ran_rayleigh(r, a);
+double GetNextRayleighRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double a ) {
+  return gsl_ran_rayleigh( _GET_RNG( context ), a );
 }
 
-double GetNextBernoulliRandomNumber( double a ) {
-  return (double)gsl_ran_bernoulli(r, a);
+double GetNextBernoulliRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double a ) {
+  return (double)gsl_ran_bernoulli( _GET_RNG( context ), a );
+}
+
+
+static void _PhiloxBlock( PHILOX_STATE *state ) {
+    uint32_t c0 = state->counter[0];
+    uint32_t c1 = state->counter[1];
+    uint32_t c2 = state->counter[2];
+    uint32_t c3 = state->counter[3];
+    uint32_t k0 = state->key[0];
+    uint32_t k1 = state->key[1];
+    uint64_t p0 = 0;
+    uint64_t p1 = 0;
+    int i = 0;
+
+    for( i = 0; i < PHILOX_ROUNDS; i++ ) {
+        p0 = (uint64_t)PHILOX_M0 * c0;
+        p1 = (uint64_t)PHILOX_M1 * c2;
+        c0 = (uint32_t)( p1 >> 32 ) ^ c1 ^ k0;
+        c2 = (uint32_t)( p0 >> 32 ) ^ c3 ^ k1;
+        c1 = (uint32_t)p1;
+        c3 = (uint32_t)p0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    state->output[0] = c0;
+    state->output[1] = c1;
+    state->output[2] = c2;
+    state->output[3] = c3;
+
+    if( ++(state->counter[0]) == 0 ) {
+        if( ++(state->counter[1]) == 0 ) {
+            ++(state->counter[2]);
+        }
+    }
+}
+
+static void _PhiloxSet( void *vstate, unsigned long int s ) {
+    PHILOX_STATE *state = (PHILOX_STATE*)vstate;
+
+    state->key[0] = (uint32_t)s;
+    state->key[1] = 0;
+    state->counter[0] = state->counter[1] = state->counter[2] = state->counter[3] = 0;
+    state->index = 4;
+}
+
+static unsigned long int _PhiloxGet( void *vstate ) {
+    PHILOX_STATE *state = (PHILOX_STATE*)vstate;
+
+    if( state->index >= 4 ) {
+        _PhiloxBlock( state );
+        state->index = 0;
+    }
+    return (unsigned long int)(state->output[state->index++]);
+}
+
+static double _PhiloxGetDouble( void *vstate ) {
+    return ( (double)_PhiloxGet( vstate ) + 0.5 ) * PHILOX_TWO_TO_MINUS_32;
 }
@@ -25,10 +25,27 @@
 
 BEGIN_C_NAMESPACE
 
+/*
+ * A random number context is an independent generator.  Contexts created by 
+ * CreateRandomNumberContext are counter-based (Philox4x32-10), so the stream 
+ * selected by ( seed, stream ) can be positioned directly without replaying other 
+ * streams.  Passing NULL as a context selects the default process-wide generator, 
+ * which is the one used by the functions without a context argument.
+ */
+struct _RANDOM_NUMBER_CONTEXT;
+typedef struct _RANDOM_NUMBER_CONTEXT RANDOM_NUMBER_CONTEXT;
+
 void CreateRandomNumberGenerators( );
 void SeedRandomNumberGenerators( double s );
 void FreeRandomNumberGenerators( );
 
+RANDOM_NUMBER_CONTEXT *CreateRandomNumberContext( );
+void FreeRandomNumberContext( RANDOM_NUMBER_CONTEXT **context );
+void SeedRandomNumberContext( RANDOM_NUMBER_CONTEXT *context, UINT32 seed, UINT32 stream );
+RANDOM_NUMBER_CONTEXT *GetDefaultRandomNumberContext( );
+
+void FillUnitUniformRandomNumbersInContext( RANDOM_NUMBER_CONTEXT *context, double *values, UINT32 n );
+
 double GetNextUniformRandomNumber( double minUniform, double maxUniform );
 double GetNextUnitUniformRandomNumber( );
 
@@ -45,8 +62,6 @@ double GetNextBinomialRandomNumber( double p, unsigned int n );
 
 double GetNextLogNormalRandomNumber( double zeta, double sigma );
 
-double GetNextLogNormalRandomNumber( double zeta, double sigma );
-
 double GetNextChiSquaredRandomNumber( double nu );
 
 double GetNextLaplaceRandomNumber( double a );
@@ -57,6 +72,21 @@ double GetNextRayleighRandomNumber( double a );
 
 double GetNextBernoulliRandomNumber( double a );
 
+double GetNextUniformRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double minUniform, double maxUniform );
+double GetNextUnitUniformRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context );
+double GetNextNormalRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double mean, double stdDeviation );
+double GetNextUnitNormalRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context );
+double GetNextGammaRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double a, double b );
+double GetNextExponentialRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double lambda );
+double GetNextPoissonRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double mu );
+double GetNextBinomialRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double p, unsigned int n );
+double GetNextLogNormalRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double zeta, double sigma );
+double GetNextChiSquaredRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double nu );
+double GetNextLaplaceRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double a );
+double GetNextCauchyRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double a );
+double GetNextRayleighRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double a );
+double GetNextBernoulliRandomNumberInContext( RANDOM_NUMBER_CONTEXT *context, double a );
+
 END_C_NAMESPACE
 
 #endif
@@ -42,6 +42,7 @@ RET_VAL InitReactionNode( REACTION *reaction, char *name ) {
     reaction->GetType = _GetType;
     reaction->ReleaseResource = _ReleaseResource;
     reaction->count = 0;
+    reaction->index = 0;
     reaction->compartment = NULL;
     
     END_FUNCTION("InitReactionNode", SUCCESS );
@@ -414,4 +415,23 @@ static RET_VAL _ReleaseResource( IR_NODE *reaction ) {
     return ret;
 }
 
+UINT32 GetReactionIndex( REACTION *reaction ) {
+    START_FUNCTION("GetReactionIndex");
+    if( reaction == NULL ) {
+        END_FUNCTION("GetReactionIndex", FAILING );
+        return 0;
+    }
+    END_FUNCTION("GetReactionIndex", SUCCESS );
+    return reaction->index;
+}
 
+RET_VAL SetReactionIndex( REACTION *reaction, UINT32 index ) {
+    RET_VAL ret = SUCCESS;
+    START_FUNCTION("SetReactionIndex");
+    if( reaction == NULL ) {
+        return ErrorReport( FAILING, "SetReactionIndex", "input reaction node is NULL" );
+    }
+    reaction->index = index;
+    END_FUNCTION("SetReactionIndex", SUCCESS );
+    return ret;
+}
@@ -49,6 +49,7 @@ typedef struct {
     double rateUpdatedTime;
     KINETIC_LAW *waitingTime;
     double count;
+    UINT32 index;
 } REACTION;
 
 RET_VAL InitReactionNode( REACTION *reaction, char *name );
@@ -95,6 +96,9 @@ double GetReactionFireCount( REACTION *reaction );
 RET_VAL IncrementReactionFireCount( REACTION *reaction );
 RET_VAL ResetReactionFireCount( REACTION *reaction );
 
+UINT32 GetReactionIndex( REACTION *reaction );
+RET_VAL SetReactionIndex( REACTION *reaction, UINT32 index );
+
 END_C_NAMESPACE
 
 #endif
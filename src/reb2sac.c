@@ -89,14 +89,17 @@ static RET_VAL InitCompiler( int argc, char *argv[], COMPILER_RECORD_T *record )
 
 static RET_VAL CompilerMain( COMPILER_RECORD_T *record ) {
     RET_VAL ret = SUCCESS;
-    static FRONT_END_PROCESSOR frontend;
-    static ABSTRACTION_ENGINE abstractionEngine;
-    static BACK_END_PROCESSOR backend;
+    FRONT_END_PROCESSOR frontend;
+    ABSTRACTION_ENGINE abstractionEngine;
+    BACK_END_PROCESSOR backend;
     IR *ir = NULL;
     REB2SAC_PROPERTIES *properties = NULL;
           
     START_FUNCTION("CompilerMain");
             
+    BZERO( &frontend, sizeof(FRONT_END_PROCESSOR) );
+    BZERO( &abstractionEngine, sizeof(ABSTRACTION_ENGINE) );
+    BZERO( &backend, sizeof(BACK_END_PROCESSOR) );
     ir = record->ir;
     
     properties = record->properties;
@@ -293,6 +296,7 @@ static void _PrintWrongInputMessage( FILE *file ) {
     "--out=<target-filename> if this option is not provided, the target filename is specified by backend" NEW_LINE
     "--reb2sac.properties=default is default" NEW_LINE
     "--reb2sac.properties.file can be used to specfied a properties file for default reb2sac properties handler" NEW_LINE 
+    "--threads=<n> runs Monte Carlo simulation runs on n worker processes, 1 is default" NEW_LINE
     );
     END_FUNCTION("_PrintWrongInputMessage", SUCCESS );
 }
@@ -0,0 +1,385 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the reb2sac contributors                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+/*
+ * Converts the .bin files written by the bin.printer simulation printer back to the tsd or 
+ * csv format the corresponding printers write.
+ *
+ *   reb2sac_convert [--tsd|--csv] input.bin [output]
+ *
+ * The output defaults to the input name with its extension replaced.
+ */
+#include "binary_simulation_printer.h"
+
+#define REB2SAC_CONVERT_TSD 0
+#define REB2SAC_CONVERT_CSV 1
+
+typedef struct {
+    FILE *in;
+    BOOL swap;
+    UINT32 valueSize;
+    UINT32 columnsSize;
+    BYTE *kinds;
+    char **names;
+    double *block;
+    BYTE *rawBlock;
+} BINARY_TRAJECTORY;
+
+static int _Usage( char *program );
+static int _ReadHeader( BINARY_TRAJECTORY *trajectory );
+static int _ReadBlock( BINARY_TRAJECTORY *trajectory, UINT32 *rowsSize );
+static int _ReadUINT32( BINARY_TRAJECTORY *trajectory, UINT32 *value );
+static void _SwapBytes( BYTE *bytes, UINT32 size );
+static UINT32 _SwapUINT32( UINT32 value );
+static void _WriteTsdHeader( BINARY_TRAJECTORY *trajectory, FILE *out );
+static void _WriteTsdRows( BINARY_TRAJECTORY *trajectory, UINT32 rowsSize, FILE *out );
+static void _WriteCsvHeader( BINARY_TRAJECTORY *trajectory, UINT32 *order, FILE *out );
+static void _WriteCsvRows( BINARY_TRAJECTORY *trajectory, UINT32 *order, UINT32 rowsSize, FILE *out );
+static void _FreeTrajectory( BINARY_TRAJECTORY *trajectory );
+
+
+int main( int argc, char *argv[] ) {
+    int i = 1;
+    int format = REB2SAC_CONVERT_TSD;
+    int status = 0;
+    UINT32 j = 0;
+    UINT32 k = 0;
+    UINT32 rowsSize = 0;
+    UINT32 *order = NULL;
+    char *input = NULL;
+    char *extension = NULL;
+    char output[1024];
+    FILE *out = NULL;
+    BINARY_TRAJECTORY trajectory;
+    /* the csv printer writes species before compartments */
+    static BYTE csvKinds[] = { BINARY_SIMULATION_PRINTER_COLUMN_SPECIES, 
+                               BINARY_SIMULATION_PRINTER_COLUMN_COMPARTMENT, 
+                               BINARY_SIMULATION_PRINTER_COLUMN_SYMBOL };
+    
+    memset( &trajectory, 0, sizeof(trajectory) );
+    if( ( i < argc ) && ( argv[i][0] == '-' ) ) {
+        if( strcmp( argv[i], "--tsd" ) == 0 ) {
+            format = REB2SAC_CONVERT_TSD;
+        }
+        else if( strcmp( argv[i], "--csv" ) == 0 ) {
+            format = REB2SAC_CONVERT_CSV;
+        }
+        else {
+            return _Usage( argv[0] );
+        }
+        i++;
+    }
+    if( ( i >= argc ) || ( argc - i > 2 ) ) {
+        return _Usage( argv[0] );
+    }
+    input = argv[i];
+    if( i + 1 < argc ) {
+        strncpy( output, argv[i + 1], sizeof(output) - 1 );
+        output[sizeof(output) - 1] = '\0';
+    }
+    else {
+        if( strlen( input ) + 5 > sizeof(output) ) {
+            fprintf( stderr, "%s: input name %s is too long" NEW_LINE, argv[0], input );
+            return 1;
+        }
+        strcpy( output, input );
+        if( ( ( extension = strrchr( output, '.' ) ) != NULL ) && ( strchr( extension, '/' ) == NULL ) ) {
+            *extension = '\0';
+        }
+        strcat( output, ( format == REB2SAC_CONVERT_TSD ) ? ".tsd" : ".csv" );
+    }
+    
+    if( ( trajectory.in = fopen( input, "rb" ) ) == NULL ) {
+        fprintf( stderr, "%s: could not open %s" NEW_LINE, argv[0], input );
+        return 1;
+    }
+    if( ( status = _ReadHeader( &trajectory ) ) != 0 ) {
+        fprintf( stderr, "%s: %s is not a valid bin.printer file" NEW_LINE, argv[0], input );
+        _FreeTrajectory( &trajectory );
+        return status;
+    }
+    if( ( out = fopen( output, "w" ) ) == NULL ) {
+        fprintf( stderr, "%s: could not open %s" NEW_LINE, argv[0], output );
+        _FreeTrajectory( &trajectory );
+        return 1;
+    }
+    
+    if( format == REB2SAC_CONVERT_TSD ) {
+        _WriteTsdHeader( &trajectory, out );
+    }
+    else {
+        if( ( order = (UINT32*)MALLOC( trajectory.columnsSize * sizeof(UINT32) ) ) == NULL ) {
+            fprintf( stderr, "%s: could not allocate memory" NEW_LINE, argv[0] );
+            fclose( out );
+            _FreeTrajectory( &trajectory );
+            return 1;
+        }
+        order[0] = 0;
+        for( k = 0, i = 1; k < sizeof(csvKinds); k++ ) {
+            for( j = 1; j < trajectory.columnsSize; j++ ) {
+                if( trajectory.kinds[j] == csvKinds[k] ) {
+                    order[i++] = j;
+                }
+            }
+        }
+        _WriteCsvHeader( &trajectory, order, out );
+    }
+    while( ( status = _ReadBlock( &trajectory, &rowsSize ) ) == 0 && ( rowsSize > 0 ) ) {
+        if( format == REB2SAC_CONVERT_TSD ) {
+            _WriteTsdRows( &trajectory, rowsSize, out );
+        }
+        else {
+            _WriteCsvRows( &trajectory, order, rowsSize, out );
+        }
+    }
+    if( format == REB2SAC_CONVERT_TSD ) {
+        fprintf( out, ")" );
+    }
+    if( status != 0 ) {
+        fprintf( stderr, "%s: %s is truncated" NEW_LINE, argv[0], input );
+    }
+    if( fclose( out ) != 0 ) {
+        fprintf( stderr, "%s: could not write %s" NEW_LINE, argv[0], output );
+        status = 1;
+    }
+    if( order != NULL ) {
+        FREE( order );
+    }
+    _FreeTrajectory( &trajectory );
+    return status;
+}
+
+static int _Usage( char *program ) {
+    fprintf( stderr, "usage: %s [--tsd|--csv] input.bin [output]" NEW_LINE, program );
+    return 1;
+}
+
+static int _ReadHeader( BINARY_TRAJECTORY *trajectory ) {
+    UINT32 i = 0;
+    UINT32 version = 0;
+    UINT32 byteOrder = 0;
+    UINT32 length = 0;
+    char magic[BINARY_SIMULATION_PRINTER_MAGIC_SIZE];
+    
+    if( ( fread( magic, 1, sizeof(magic), trajectory->in ) != sizeof(magic) ) || 
+        ( strncmp( magic, BINARY_SIMULATION_PRINTER_MAGIC, sizeof(magic) ) != 0 ) ) {
+        return 1;
+    }
+    if( ( _ReadUINT32( trajectory, &version ) != 0 ) || ( _ReadUINT32( trajectory, &byteOrder ) != 0 ) ) {
+        return 1;
+    }
+    if( byteOrder != BINARY_SIMULATION_PRINTER_BYTE_ORDER ) {
+        version = _SwapUINT32( version );
+        byteOrder = _SwapUINT32( byteOrder );
+        if( byteOrder != BINARY_SIMULATION_PRINTER_BYTE_ORDER ) {
+            return 1;
+        }
+        trajectory->swap = TRUE;
+    }
+    if( ( version != BINARY_SIMULATION_PRINTER_VERSION ) || 
+        ( _ReadUINT32( trajectory, &(trajectory->valueSize) ) != 0 ) || 
+        ( _ReadUINT32( trajectory, &(trajectory->columnsSize) ) != 0 ) ) {
+        return 1;
+    }
+    if( ( ( trajectory->valueSize != sizeof(double) ) && ( trajectory->valueSize != sizeof(float) ) ) || 
+        ( trajectory->columnsSize == 0 ) ) {
+        return 1;
+    }
+    
+    if( ( ( trajectory->kinds = (BYTE*)MALLOC( trajectory->columnsSize * sizeof(BYTE) ) ) == NULL ) || 
+        ( ( trajectory->names = (char**)MALLOC( trajectory->columnsSize * sizeof(char*) ) ) == NULL ) || 
+        ( ( trajectory->block = (double*)MALLOC( trajectory->columnsSize * BINARY_SIMULATION_PRINTER_BLOCK_ROWS * sizeof(double) ) ) == NULL ) || 
+        ( ( trajectory->rawBlock = (BYTE*)MALLOC( BINARY_SIMULATION_PRINTER_BLOCK_ROWS * trajectory->valueSize ) ) == NULL ) ) {
+        return 1;
+    }
+    for( i = 0; i < trajectory->columnsSize; i++ ) {
+        if( ( fread( trajectory->kinds + i, sizeof(BYTE), 1, trajectory->in ) != 1 ) || 
+            ( _ReadUINT32( trajectory, &length ) != 0 ) ) {
+            return 1;
+        }
+        if( ( trajectory->names[i] = (char*)MALLOC( length + 1 ) ) == NULL ) {
+            return 1;
+        }
+        if( fread( trajectory->names[i], 1, length, trajectory->in ) != length ) {
+            return 1;
+        }
+        trajectory->names[i][length] = '\0';
+    }
+    return 0;
+}
+
+/*
+ * Reads the next block of rows into trajectory->block, column by column.  rowsSize is 0 at 
+ * the end of the file.
+ */
+static int _ReadBlock( BINARY_TRAJECTORY *trajectory, UINT32 *rowsSize ) {
+    UINT32 i = 0;
+    UINT32 j = 0;
+    uint32_t rowsField = 0;
+    float singleValue = 0.0;
+    double *column = NULL;
+    BYTE *raw = NULL;
+    size_t count = 0;
+    
+    *rowsSize = 0;
+    if( ( count = fread( &rowsField, sizeof(uint32_t), 1, trajectory->in ) ) != 1 ) {
+        return feof( trajectory->in ) ? 0 : 1;
+    }
+    if( trajectory->swap ) {
+        _SwapBytes( (BYTE*)&rowsField, sizeof(uint32_t) );
+    }
+    *rowsSize = rowsField;
+    if( ( *rowsSize == 0 ) || ( *rowsSize > BINARY_SIMULATION_PRINTER_BLOCK_ROWS ) ) {
+        *rowsSize = 0;
+        return 1;
+    }
+    for( i = 0; i < trajectory->columnsSize; i++ ) {
+        column = trajectory->block + i * BINARY_SIMULATION_PRINTER_BLOCK_ROWS;
+        if( fread( trajectory->rawBlock, trajectory->valueSize, *rowsSize, trajectory->in ) != *rowsSize ) {
+            *rowsSize = 0;
+            return 1;
+        }
+        for( j = 0; j < *rowsSize; j++ ) {
+            raw = trajectory->rawBlock + j * trajectory->valueSize;
+            if( trajectory->swap ) {
+                _SwapBytes( raw, trajectory->valueSize );
+            }
+            if( trajectory->valueSize == sizeof(float) ) {
+                memcpy( &singleValue, raw, sizeof(float) );
+                column[j] = singleValue;
+            }
+            else {
+                memcpy( column + j, raw, sizeof(double) );
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * Fields on disk are always 32 bits wide; UINT32 is an unsigned long and may be wider.
+ */
+static int _ReadUINT32( BINARY_TRAJECTORY *trajectory, UINT32 *value ) {
+    uint32_t field = 0;
+    
+    if( fread( &field, sizeof(uint32_t), 1, trajectory->in ) != 1 ) {
+        return 1;
+    }
+    if( trajectory->swap ) {
+        _SwapBytes( (BYTE*)&field, sizeof(uint32_t) );
+    }
+    *value = field;
+    return 0;
+}
+
+static UINT32 _SwapUINT32( UINT32 value ) {
+    uint32_t field = (uint32_t)value;
+    
+    _SwapBytes( (BYTE*)&field, sizeof(uint32_t) );
+    return field;
+}
+
+static void _SwapBytes( BYTE *bytes, UINT32 size ) {
+    UINT32 i = 0;
+    BYTE byte = 0;
+    
+    for( i = 0; i < size / 2; i++ ) {
+        byte = bytes[i];
+        bytes[i] = bytes[size - 1 - i];
+        bytes[size - 1 - i] = byte;
+    }
+}
+
+static void _WriteTsdHeader( BINARY_TRAJECTORY *trajectory, FILE *out ) {
+    UINT32 i = 0;
+    
+    fprintf( out, "((\"%s\"", trajectory->names[0] );
+    for( i = 1; i < trajectory->columnsSize; i++ ) {
+        fprintf( out, ",\"%s\"", trajectory->names[i] );
+    }
+    fprintf( out, ")" );
+}
+
+static void _WriteTsdRows( BINARY_TRAJECTORY *trajectory, UINT32 rowsSize, FILE *out ) {
+    UINT32 i = 0;
+    UINT32 j = 0;
+    double *block = trajectory->block;
+    
+    for( j = 0; j < rowsSize; j++ ) {
+        fprintf( out, ",(%.12g", block[j] );
+        for( i = 1; i < trajectory->columnsSize; i++ ) {
+            /* the tsd printer separates species values with a space as well */
+            fprintf( out, ( trajectory->kinds[i] == BINARY_SIMULATION_PRINTER_COLUMN_SPECIES ) ? ", %.12g" : ",%.12g", 
+                     block[i * BINARY_SIMULATION_PRINTER_BLOCK_ROWS + j] );
+        }
+        fprintf( out, ")" );
+    }
+}
+
+static void _WriteCsvHeader( BINARY_TRAJECTORY *trajectory, UINT32 *order, FILE *out ) {
+    UINT32 i = 0;
+    
+    fprintf( out, "%s", trajectory->names[0] );
+    for( i = 1; i < trajectory->columnsSize; i++ ) {
+        fprintf( out, ", %s", trajectory->names[order[i]] );
+    }
+    fprintf( out, NEW_LINE );
+}
+
+static void _WriteCsvRows( BINARY_TRAJECTORY *trajectory, UINT32 *order, UINT32 rowsSize, FILE *out ) {
+    UINT32 i = 0;
+    UINT32 j = 0;
+    double *block = trajectory->block;
+    
+    for( j = 0; j < rowsSize; j++ ) {
+        fprintf( out, "%.12g", block[j] );
+        for( i = 1; i < trajectory->columnsSize; i++ ) {
+            fprintf( out, ", %.12g", block[order[i] * BINARY_SIMULATION_PRINTER_BLOCK_ROWS + j] );
+        }
+        fprintf( out, NEW_LINE );
+    }
+}
+
+static void _FreeTrajectory( BINARY_TRAJECTORY *trajectory ) {
+    UINT32 i = 0;
+    
+    if( trajectory->in != NULL ) {
+        fclose( trajectory->in );
+    }
+    if( trajectory->names != NULL ) {
+        for( i = 0; i < trajectory->columnsSize; i++ ) {
+            if( trajectory->names[i] != NULL ) {
+                FREE( trajectory->names[i] );
+            }
+        }
+        FREE( trajectory->names );
+    }
+    if( trajectory->kinds != NULL ) {
+        FREE( trajectory->kinds );
+    }
+    if( trajectory->block != NULL ) {
+        FREE( trajectory->block );
+    }
+    if( trajectory->rawBlock != NULL ) {
+        FREE( trajectory->rawBlock );
+    }
+}
@@ -0,0 +1,357 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the reb2sac contributors                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#include "sim_state.h"
+
+static RET_VAL _AddVariables( SIM_STATE *state, CADDR_T array, UINT32 size, UINT32 offset );
+static RET_VAL _BuildStoichiometryMatrix( SIM_STATE *state );
+static UINT32 _FindSymbol( SIM_STATE *state, REB2SAC_SYMBOL *symbol );
+
+
+DLLSCOPE SIM_STATE * STDCALL CreateSimState( SPECIES **speciesArray, UINT32 speciesSize,
+                                             COMPARTMENT **compartmentArray, UINT32 compartmentsSize,
+                                             REB2SAC_SYMBOL **symbolArray, UINT32 symbolsSize,
+                                             REACTION **reactionArray, UINT32 reactionsSize ) {
+    UINT32 i = 0;
+    UINT32 size = 0;
+    SIM_STATE *state = NULL;
+
+    START_FUNCTION("CreateSimState");
+
+    if( ( state = (SIM_STATE*)MALLOC( sizeof(SIM_STATE) ) ) == NULL ) {
+        END_FUNCTION("CreateSimState", FAILING );
+        return NULL;
+    }
+    state->speciesArray = speciesArray;
+    state->speciesSize = speciesSize;
+    state->compartmentArray = compartmentArray;
+    state->compartmentsSize = compartmentsSize;
+    state->symbolArray = symbolArray;
+    state->symbolsSize = symbolsSize;
+    state->reactionArray = reactionArray;
+    state->reactionsSize = reactionsSize;
+    state->valuesSize = speciesSize + compartmentsSize + symbolsSize;
+
+    size = GET_MAX( state->valuesSize, 1 );
+    if( ( ( state->values = (double*)MALLOC( size * sizeof(double) ) ) == NULL ) ||
+        ( ( state->indices = (UINT32*)MALLOC( size * sizeof(UINT32) ) ) == NULL ) ||
+        ( ( state->variables = CreateHashTable( GET_MAX( size, 16 ) ) ) == NULL ) ) {
+        FreeSimState( &state );
+        END_FUNCTION("CreateSimState", FAILING );
+        return NULL;
+    }
+    state->amounts = state->values;
+    state->sizes = state->values + speciesSize;
+    state->params = state->values + speciesSize + compartmentsSize;
+    for( i = 0; i < state->valuesSize; i++ ) {
+        state->indices[i] = i;
+    }
+    if( IS_FAILED( _AddVariables( state, (CADDR_T)speciesArray, speciesSize, 0 ) ) ||
+        IS_FAILED( _AddVariables( state, (CADDR_T)compartmentArray, compartmentsSize, speciesSize ) ) ||
+        IS_FAILED( _AddVariables( state, (CADDR_T)symbolArray, symbolsSize, speciesSize + compartmentsSize ) ) ) {
+        FreeSimState( &state );
+        END_FUNCTION("CreateSimState", FAILING );
+        return NULL;
+    }
+
+    size = GET_MAX( speciesSize, 1 );
+    if( ( ( state->conversionFactors = (UINT32*)MALLOC( size * sizeof(UINT32) ) ) == NULL ) ||
+        ( ( state->conversionFactorSymbols = (REB2SAC_SYMBOL**)MALLOC( size * sizeof(REB2SAC_SYMBOL*) ) ) == NULL ) ||
+        ( ( state->isBoundary = (BYTE*)MALLOC( size * sizeof(BYTE) ) ) == NULL ) ) {
+        FreeSimState( &state );
+        END_FUNCTION("CreateSimState", FAILING );
+        return NULL;
+    }
+    for( i = 0; i < speciesSize; i++ ) {
+        state->conversionFactorSymbols[i] = GetConversionFactorInSpeciesNode( speciesArray[i] );
+        state->conversionFactors[i] = _FindSymbol( state, state->conversionFactorSymbols[i] );
+        state->isBoundary[i] = HasBoundaryConditionInSpeciesNode( speciesArray[i] ) ? TRUE : FALSE;
+    }
+
+    size = GET_MAX( reactionsSize, 1 );
+    if( ( ( state->propensities = (double*)MALLOC( size * sizeof(double) ) ) == NULL ) ||
+        ( ( state->isFast = (BYTE*)MALLOC( size * sizeof(BYTE) ) ) == NULL ) ) {
+        FreeSimState( &state );
+        END_FUNCTION("CreateSimState", FAILING );
+        return NULL;
+    }
+    for( i = 0; i < reactionsSize; i++ ) {
+        state->isFast[i] = IsReactionFastInReactionNode( reactionArray[i] ) ? TRUE : FALSE;
+    }
+    if( IS_FAILED( _BuildStoichiometryMatrix( state ) ) ) {
+        FreeSimState( &state );
+        END_FUNCTION("CreateSimState", FAILING );
+        return NULL;
+    }
+
+    LoadSimStateFromIR( state );
+
+    END_FUNCTION("CreateSimState", SUCCESS );
+    return state;
+}
+
+DLLSCOPE RET_VAL STDCALL FreeSimState( SIM_STATE **state ) {
+    SIM_STATE *target = *state;
+
+    START_FUNCTION("FreeSimState");
+
+    if( target == NULL ) {
+        END_FUNCTION("FreeSimState", SUCCESS );
+        return SUCCESS;
+    }
+    if( target->variables != NULL ) {
+        DeleteHashTable( &(target->variables) );
+    }
+    FREE( target->values );
+    FREE( target->indices );
+    FREE( target->propensities );
+    FREE( target->stoichiometryOffsets );
+    FREE( target->productOffsets );
+    FREE( target->stoichiometrySpecies );
+    FREE( target->stoichiometries );
+    FREE( target->stoichiometryReferences );
+    FREE( target->stoichiometrySymbols );
+    FREE( target->conversionFactors );
+    FREE( target->conversionFactorSymbols );
+    FREE( target->isBoundary );
+    FREE( target->isFast );
+    FREE( *state );
+
+    END_FUNCTION("FreeSimState", SUCCESS );
+    return SUCCESS;
+}
+
+/*
+ * Copies the current amounts, sizes and values held in the IR into the state.
+ */
+DLLSCOPE RET_VAL STDCALL LoadSimStateFromIR( SIM_STATE *state ) {
+    UINT32 i = 0;
+
+    for( i = 0; i < state->speciesSize; i++ ) {
+        state->amounts[i] = GetAmountInSpeciesNode( state->speciesArray[i] );
+    }
+    for( i = 0; i < state->compartmentsSize; i++ ) {
+        state->sizes[i] = GetCurrentSizeInCompartment( state->compartmentArray[i] );
+    }
+    for( i = 0; i < state->symbolsSize; i++ ) {
+        state->params[i] = GetCurrentRealValueInSymbol( state->symbolArray[i] );
+    }
+    return SUCCESS;
+}
+
+/*
+ * Copies the state back into the IR, for a simulator that changed the arrays directly.
+ */
+DLLSCOPE RET_VAL STDCALL StoreSimStateInIR( SIM_STATE *state ) {
+    UINT32 i = 0;
+
+    for( i = 0; i < state->speciesSize; i++ ) {
+        SetAmountInSpeciesNode( state->speciesArray[i], state->amounts[i] );
+    }
+    for( i = 0; i < state->compartmentsSize; i++ ) {
+        SetCurrentSizeInCompartment( state->compartmentArray[i], state->sizes[i] );
+    }
+    for( i = 0; i < state->symbolsSize; i++ ) {
+        SetCurrentRealValueInSymbol( state->symbolArray[i], state->params[i] );
+    }
+    return SUCCESS;
+}
+
+/*
+ * Finds the position in the values block of a species, compartment or symbol.
+ */
+DLLSCOPE BOOL STDCALL FindVariableInSimState( SIM_STATE *state, CADDR_T node, UINT32 *index ) {
+    UINT32 *position = NULL;
+
+    if( ( position = (UINT32*)GetValueFromHashTable( (CADDR_T)&node, sizeof(node), state->variables ) ) == NULL ) {
+        return FALSE;
+    }
+    *index = *position;
+    return TRUE;
+}
+
+DLLSCOPE void STDCALL SetSpeciesAmountInSimState( SIM_STATE *state, UINT32 index, double amount ) {
+    state->amounts[index] = amount;
+    SetAmountInSpeciesNode( state->speciesArray[index], amount );
+}
+
+/* the species' amount becomes the concentration times the current size of its compartment */
+DLLSCOPE void STDCALL SetSpeciesConcentrationInSimState( SIM_STATE *state, UINT32 index, double concentration ) {
+    SPECIES *species = state->speciesArray[index];
+
+    SetConcentrationInSpeciesNode( species, concentration );
+    state->amounts[index] = GetAmountInSpeciesNode( species );
+}
+
+DLLSCOPE void STDCALL SetCompartmentSizeInSimState( SIM_STATE *state, UINT32 index, double size ) {
+    state->sizes[index] = size;
+    SetCurrentSizeInCompartment( state->compartmentArray[index], size );
+}
+
+DLLSCOPE void STDCALL SetSymbolValueInSimState( SIM_STATE *state, UINT32 index, double value ) {
+    state->params[index] = value;
+    SetCurrentRealValueInSymbol( state->symbolArray[index], value );
+}
+
+/*
+ * The stoichiometry of an entry, without the conversion factor of its species.
+ */
+DLLSCOPE double STDCALL GetStoichiometryInSimState( SIM_STATE *state, UINT32 entry ) {
+    UINT32 reference = state->stoichiometryReferences[entry];
+
+    if( reference != SIM_STATE_NO_INDEX ) {
+        return state->params[reference];
+    }
+    if( state->stoichiometrySymbols[entry] != NULL ) {
+        return GetCurrentRealValueInSymbol( state->stoichiometrySymbols[entry] );
+    }
+    return state->stoichiometries[entry];
+}
+
+DLLSCOPE double STDCALL GetConversionFactorInSimState( SIM_STATE *state, UINT32 speciesIndex ) {
+    UINT32 factor = state->conversionFactors[speciesIndex];
+
+    if( factor != SIM_STATE_NO_INDEX ) {
+        return state->params[factor];
+    }
+    if( state->conversionFactorSymbols[speciesIndex] != NULL ) {
+        return GetCurrentRealValueInSymbol( state->conversionFactorSymbols[speciesIndex] );
+    }
+    return 1.0;
+}
+
+/*
+ * A reaction can fire only if each reactant has at least the amount it consumes.
+ */
+DLLSCOPE BOOL STDCALL HasEnoughReactantsInSimState( SIM_STATE *state, UINT32 reactionIndex ) {
+    UINT32 j = 0;
+    UINT32 end = state->productOffsets[reactionIndex];
+    UINT32 species = 0;
+
+    for( j = state->stoichiometryOffsets[reactionIndex]; j < end; j++ ) {
+        species = state->stoichiometrySpecies[j];
+        if( state->amounts[species] < GetStoichiometryInSimState( state, j ) * GetConversionFactorInSimState( state, species ) ) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*
+ * Applies the given number of firings of a reaction.  Boundary species are left unchanged.
+ */
+DLLSCOPE void STDCALL FireReactionInSimState( SIM_STATE *state, UINT32 reactionIndex, double firings ) {
+    UINT32 j = 0;
+    UINT32 products = state->productOffsets[reactionIndex];
+    UINT32 end = state->stoichiometryOffsets[reactionIndex + 1];
+    UINT32 species = 0;
+    double change = 0.0;
+
+    for( j = state->stoichiometryOffsets[reactionIndex]; j < end; j++ ) {
+        species = state->stoichiometrySpecies[j];
+        if( state->isBoundary[species] ) {
+            continue;
+        }
+        change = GetStoichiometryInSimState( state, j ) * GetConversionFactorInSimState( state, species ) * firings;
+        if( j < products ) {
+            SetSpeciesAmountInSimState( state, species, state->amounts[species] - change );
+        }
+        else {
+            SetSpeciesAmountInSimState( state, species, state->amounts[species] + change );
+        }
+    }
+}
+
+
+static RET_VAL _AddVariables( SIM_STATE *state, CADDR_T array, UINT32 size, UINT32 offset ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+
+    for( i = 0; i < size; i++ ) {
+        if( IS_FAILED( ( ret = PutInHashTable( array + i * sizeof(CADDR_T), sizeof(CADDR_T), 
+                                               (CADDR_T)(state->indices + offset + i), state->variables ) ) ) ) {
+            return ret;
+        }
+    }
+    return ret;
+}
+
+/*
+ * Species that are not in the state are left out of the matrix.
+ */
+static RET_VAL _BuildStoichiometryMatrix( SIM_STATE *state ) {
+    UINT32 i = 0;
+    UINT32 k = 0;
+    UINT32 size = 0;
+    UINT32 index = 0;
+    SPECIES *species = NULL;
+    IR_EDGE *edge = NULL;
+    LINKED_LIST *edges = NULL;
+    REACTION *reaction = NULL;
+
+    for( i = 0; i < state->reactionsSize; i++ ) {
+        size += GetLinkedListSize( GetReactantEdges( (IR_NODE*)state->reactionArray[i] ) );
+        size += GetLinkedListSize( GetProductEdges( (IR_NODE*)state->reactionArray[i] ) );
+    }
+    size = GET_MAX( size, 1 );
+    if( ( ( state->stoichiometryOffsets = (UINT32*)MALLOC( ( state->reactionsSize + 1 ) * sizeof(UINT32) ) ) == NULL ) ||
+        ( ( state->productOffsets = (UINT32*)MALLOC( GET_MAX( state->reactionsSize, 1 ) * sizeof(UINT32) ) ) == NULL ) ||
+        ( ( state->stoichiometrySpecies = (UINT32*)MALLOC( size * sizeof(UINT32) ) ) == NULL ) ||
+        ( ( state->stoichiometries = (double*)MALLOC( size * sizeof(double) ) ) == NULL ) ||
+        ( ( state->stoichiometryReferences = (UINT32*)MALLOC( size * sizeof(UINT32) ) ) == NULL ) ||
+        ( ( state->stoichiometrySymbols = (REB2SAC_SYMBOL**)MALLOC( size * sizeof(REB2SAC_SYMBOL*) ) ) == NULL ) ) {
+        return ErrorReport( FAILING, "_BuildStoichiometryMatrix", "could not allocate memory for the stoichiometry matrix" );
+    }
+
+    for( size = 0, i = 0; i < state->reactionsSize; i++ ) {
+        reaction = state->reactionArray[i];
+        state->stoichiometryOffsets[i] = size;
+        for( k = 0; k < 2; k++ ) {
+            if( k == 0 ) {
+                edges = GetReactantEdges( (IR_NODE*)reaction );
+            }
+            else {
+                state->productOffsets[i] = size;
+                edges = GetProductEdges( (IR_NODE*)reaction );
+            }
+            ResetCurrentElement( edges );
+            while( ( edge = GetNextEdge( edges ) ) != NULL ) {
+                species = GetSpeciesInIREdge( edge );
+                if( !FindVariableInSimState( state, (CADDR_T)species, &index ) || ( index >= state->speciesSize ) ) {
+                    continue;
+                }
+                state->stoichiometrySpecies[size] = index;
+                state->stoichiometries[size] = GetStoichiometryInIREdge( edge );
+                state->stoichiometrySymbols[size] = GetSpeciesRefInIREdge( edge );
+                state->stoichiometryReferences[size] = _FindSymbol( state, state->stoichiometrySymbols[size] );
+                size++;
+            }
+        }
+    }
+    state->stoichiometryOffsets[state->reactionsSize] = size;
+    return SUCCESS;
+}
+
+static UINT32 _FindSymbol( SIM_STATE *state, REB2SAC_SYMBOL *symbol ) {
+    UINT32 index = 0;
+
+    if( ( symbol == NULL ) || !FindVariableInSimState( state, (CADDR_T)symbol, &index ) ) {
+        return SIM_STATE_NO_INDEX;
+    }
+    return index - state->speciesSize - state->compartmentsSize;
+}
@@ -0,0 +1,100 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the reb2sac contributors                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#if !defined(HAVE_SIM_STATE)
+#define HAVE_SIM_STATE
+
+#include "common.h"
+#include "IR.h"
+#include "hash_table.h"
+
+BEGIN_C_NAMESPACE
+
+#define SIM_STATE_NO_INDEX ((UINT32)0xFFFFFFFF)
+
+struct _SIM_STATE;
+typedef struct _SIM_STATE SIM_STATE;
+
+/*
+ * Dense state of a simulation.  The amounts of the species, the sizes of the compartments 
+ * and the values of the symbols are held in one contiguous block, in that order, so that
+ * compiled kinetic laws can index it directly; amounts, sizes and params point into it.
+ *
+ * The stoichiometry matrix is stored in compressed sparse row form, one row per reaction, 
+ * reactants first: the entries of reaction r are [stoichiometryOffsets[r], 
+ * stoichiometryOffsets[r+1]) and its products start at productOffsets[r].  A stoichiometry 
+ * given by a species reference is read from params at the entry's reference index.
+ *
+ * The setters below also store the new value in the IR, since printers, termination 
+ * deciders and the kinetic law evaluator still read it there; the hot paths of the 
+ * simulators read the arrays.
+ */
+struct _SIM_STATE {
+    SPECIES **speciesArray;
+    UINT32 speciesSize;
+    COMPARTMENT **compartmentArray;
+    UINT32 compartmentsSize;
+    REB2SAC_SYMBOL **symbolArray;
+    UINT32 symbolsSize;
+    REACTION **reactionArray;
+    UINT32 reactionsSize;
+    double *values;
+    UINT32 valuesSize;
+    double *amounts;
+    double *sizes;
+    double *params;
+    double *propensities;
+    UINT32 *stoichiometryOffsets;
+    UINT32 *productOffsets;
+    UINT32 *stoichiometrySpecies;
+    double *stoichiometries;
+    UINT32 *stoichiometryReferences;
+    REB2SAC_SYMBOL **stoichiometrySymbols;
+    UINT32 *conversionFactors;
+    REB2SAC_SYMBOL **conversionFactorSymbols;
+    BYTE *isBoundary;
+    BYTE *isFast;
+    UINT32 *indices;
+    HASH_TABLE *variables;
+};
+
+
+DLLSCOPE SIM_STATE * STDCALL CreateSimState( SPECIES **speciesArray, UINT32 speciesSize,
+                                             COMPARTMENT **compartmentArray, UINT32 compartmentsSize,
+                                             REB2SAC_SYMBOL **symbolArray, UINT32 symbolsSize,
+                                             REACTION **reactionArray, UINT32 reactionsSize );
+DLLSCOPE RET_VAL STDCALL FreeSimState( SIM_STATE **state );
+
+DLLSCOPE RET_VAL STDCALL LoadSimStateFromIR( SIM_STATE *state );
+DLLSCOPE RET_VAL STDCALL StoreSimStateInIR( SIM_STATE *state );
+DLLSCOPE BOOL STDCALL FindVariableInSimState( SIM_STATE *state, CADDR_T node, UINT32 *index );
+
+DLLSCOPE void STDCALL SetSpeciesAmountInSimState( SIM_STATE *state, UINT32 index, double amount );
+DLLSCOPE void STDCALL SetSpeciesConcentrationInSimState( SIM_STATE *state, UINT32 index, double concentration );
+DLLSCOPE void STDCALL SetCompartmentSizeInSimState( SIM_STATE *state, UINT32 index, double size );
+DLLSCOPE void STDCALL SetSymbolValueInSimState( SIM_STATE *state, UINT32 index, double value );
+
+DLLSCOPE double STDCALL GetStoichiometryInSimState( SIM_STATE *state, UINT32 entry );
+DLLSCOPE double STDCALL GetConversionFactorInSimState( SIM_STATE *state, UINT32 speciesIndex );
+DLLSCOPE BOOL STDCALL HasEnoughReactantsInSimState( SIM_STATE *state, UINT32 reactionIndex );
+DLLSCOPE void STDCALL FireReactionInSimState( SIM_STATE *state, UINT32 reactionIndex, double firings );
+
+
+END_C_NAMESPACE
+
+#endif
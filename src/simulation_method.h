@@ -60,6 +60,9 @@
 #define ODE_SIMULATION_TIME_STEP "ode.simulation.time.step"
 #define DEFAULT_ODE_SIMULATION_TIME_STEP 1.0
 
+#define ODE_SIMULATION_EVENT_TOLERANCE "ode.simulation.event.tolerance"
+#define DEFAULT_ODE_SIMULATION_EVENT_TOLERANCE 1.0e-9
+
 #define ODE_SIMULATION_OUT_DIR "ode.simulation.out.dir"
 #define DEFAULT_ODE_SIMULATION_OUT_DIR_VALUE "."
 
@@ -88,6 +91,25 @@
 #define MONTE_CARLO_SIMULATION_RUNS "monte.carlo.simulation.runs"
 #define DEFAULT_MONTE_CARLO_SIMULATION_RUNS_VALUE 1
 
+#define MONTE_CARLO_SIMULATION_THREADS "monte.carlo.simulation.threads"
+#define MONTE_CARLO_SIMULATION_THREADS_OPTION "threads"
+#define DEFAULT_MONTE_CARLO_SIMULATION_THREADS_VALUE 1
+
+#define MONTE_CARLO_SIMULATION_TAU_LEAP_EPSILON "monte.carlo.simulation.tau.leap.epsilon"
+#define DEFAULT_MONTE_CARLO_SIMULATION_TAU_LEAP_EPSILON_VALUE 0.03
+
+#define MONTE_CARLO_SIMULATION_TAU_LEAP_CRITICAL_FIRINGS "monte.carlo.simulation.tau.leap.critical.firings"
+#define DEFAULT_MONTE_CARLO_SIMULATION_TAU_LEAP_CRITICAL_FIRINGS_VALUE 10
+
+#define MONTE_CARLO_SIMULATION_TAU_LEAP_SSA_FACTOR "monte.carlo.simulation.tau.leap.ssa.factor"
+#define DEFAULT_MONTE_CARLO_SIMULATION_TAU_LEAP_SSA_FACTOR_VALUE 10.0
+
+#define MONTE_CARLO_SIMULATION_TAU_LEAP_SSA_STEPS "monte.carlo.simulation.tau.leap.ssa.steps"
+#define DEFAULT_MONTE_CARLO_SIMULATION_TAU_LEAP_SSA_STEPS_VALUE 100
+
+#define MONTE_CARLO_SIMULATION_TAU_LEAP_IMPLICIT "monte.carlo.simulation.tau.leap.implicit"
+#define DEFAULT_MONTE_CARLO_SIMULATION_TAU_LEAP_IMPLICIT_VALUE "false"
+
 #define MONTE_CARLO_CI_CONFIDENCE_LEVEL "monte.carlo.ci.confidence.level"
 #define DEFAULT_MONTE_CARLO_CI_CONFIDENCE_LEVEL_VALUE 0.95
 
@@ -97,6 +119,21 @@
 #define MONTE_CARLO_SIMULATION_START_INDEX  "monte.carlo.simulation.start.index"
 #define DEFAULT_MONTE_CARLO_SIMULATION_START_INDEX  1
 
+#define MONTE_CARLO_SIMULATION_STATISTICS "monte.carlo.simulation.statistics"
+#define DEFAULT_MONTE_CARLO_SIMULATION_STATISTICS_VALUE "false"
+
+#define MONTE_CARLO_SIMULATION_STATISTICS_QUANTILES "monte.carlo.simulation.statistics.quantiles"
+
+#define MONTE_CARLO_SIMULATION_RUN_FILES "monte.carlo.simulation.run.files"
+#define DEFAULT_MONTE_CARLO_SIMULATION_RUN_FILES_VALUE "true"
+
+#define MONTE_CARLO_SIMULATION_CI_OBSERVABLES "monte.carlo.simulation.ci.observables"
+
+#define MONTE_CARLO_SIMULATION_CI_TIMES "monte.carlo.simulation.ci.times"
+
+#define MONTE_CARLO_SIMULATION_CI_MIN_RUNS "monte.carlo.simulation.ci.min.runs"
+#define DEFAULT_MONTE_CARLO_SIMULATION_CI_MIN_RUNS_VALUE 10
+
 #define ISSA_NUMBER_PATHS  "reb2sac.iSSA.number.paths"
 #define DEFAULT_ISSA_NUMBER_PATHS 1
 
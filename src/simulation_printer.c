@@ -22,6 +22,7 @@
 #include "csv_simulation_printer.h"
 #include "gnuplot_dat_simulation_printer.h"
 #include "null_simulation_printer.h"
+#include "binary_simulation_printer.h"
 
 #define DEFAULT_SIMULATION_PRINTER TSD_SIMULATION_PRINTER
 
@@ -32,32 +33,59 @@ DLLSCOPE SIMULATION_PRINTER * STDCALL CreateSimulationPrinter( BACK_END_PROCESSO
     int i = 0;
     SPECIES *species = NULL;
     SIMULATION_PRINTER *printer = NULL;
-    char *valueString = NULL;
-    COMPILER_RECORD_T *compRec = backend->record;
-    REB2SAC_PROPERTIES *properties = NULL;
-    BOOL isAmount = TRUE;
     
     START_FUNCTION("CreateSimulationPrinter");
     
+    printer = CreateSimulationPrinterOfQuantity( backend, compartmentArray, compSize,
+                                                 speciesArray, size, 
+                                                 symbolArray, symSize, 
+                                                 IsAmountTrackedBySimulationPrinter( backend ) );
+    
+    END_FUNCTION("CreateSimulationPrinter",  printer == NULL ? FAILING : SUCCESS );
+    
+    return printer;
+}
+
+DLLSCOPE BOOL STDCALL IsAmountTrackedBySimulationPrinter( BACK_END_PROCESSOR *backend ) {
+    char *valueString = NULL;
+    COMPILER_RECORD_T *compRec = backend->record;
+    REB2SAC_PROPERTIES *properties = compRec->properties;
     
-    properties = compRec->properties;
     if( ( valueString = properties->GetProperty( properties, SIMULATION_PRINTER_TRACKING_QUANTITY_KEY ) ) == NULL ) {
-        isAmount = TRUE;
-    }
-    else {
-        if( strcmp( valueString, SIMULATION_PRINTER_TRACKING_QUANTITY_CONCENTRATION ) == 0 ) {
-            isAmount = FALSE;
-        }
-        else {
-            isAmount = TRUE;
-        }
+        return TRUE;
     }
+    return ( strcmp( valueString, SIMULATION_PRINTER_TRACKING_QUANTITY_CONCENTRATION ) == 0 ) ? FALSE : TRUE;
+}
+
+/*
+ * Creates the printer selected by SIMULATION_PRINTER_KEY, printing species amounts or 
+ * concentrations as given by isAmount instead of the tracking quantity property.
+ */
+DLLSCOPE SIMULATION_PRINTER * STDCALL CreateSimulationPrinterOfQuantity( BACK_END_PROCESSOR *backend, 
+									 COMPARTMENT **compartmentArray, UINT32 compSize,
+									 SPECIES **speciesArray, UINT32 size, 
+									 REB2SAC_SYMBOL **symbolArray, UINT32 symSize,
+									 BOOL isAmount ) {
+    SIMULATION_PRINTER *printer = NULL;
+    char *valueString = NULL;
+    COMPILER_RECORD_T *compRec = backend->record;
+    REB2SAC_PROPERTIES *properties = compRec->properties;
+    
+    START_FUNCTION("CreateSimulationPrinterOfQuantity");
     
     if( ( valueString = properties->GetProperty( properties, SIMULATION_PRINTER_KEY ) ) == NULL ) {
         valueString = DEFAULT_SIMULATION_PRINTER;
     }
 
     switch( valueString[0] ) {
+        case 'b':
+            if( strcmp( valueString, BINARY_SIMULATION_PRINTER ) == 0 ) {
+	      printer = CreateBinarySimulationPrinter( backend, compartmentArray, compSize,
+						       speciesArray, size, 
+						       symbolArray, symSize, isAmount );
+            }
+        break;
+        
         case 'c':
             if( strcmp( valueString, CSV_SIMULATION_PRINTER ) == 0 ) {
 	      printer = CreateCsvSimulationPrinter( backend, compartmentArray, compSize,
@@ -93,7 +121,7 @@ DLLSCOPE SIMULATION_PRINTER * STDCALL CreateSimulationPrinter( BACK_END_PROCESSO
         default:
             FREE( speciesArray );
             TRACE_1( "%s is not a valid simulation printer", valueString );
-            END_FUNCTION("CreateSimulationPrinter",  FAILING );
+            END_FUNCTION("CreateSimulationPrinterOfQuantity",  FAILING );
             return NULL;        
         break;    
     }
@@ -101,11 +129,11 @@ DLLSCOPE SIMULATION_PRINTER * STDCALL CreateSimulationPrinter( BACK_END_PROCESSO
     if( printer == NULL ) {
         FREE( speciesArray );
         TRACE_1( "failed to create %s", valueString );
-        END_FUNCTION("CreateSimulationPrinter",  FAILING );
+        END_FUNCTION("CreateSimulationPrinterOfQuantity",  FAILING );
         return NULL;        
     }        
     
-    END_FUNCTION("CreateSimulationPrinter",  SUCCESS );
+    END_FUNCTION("CreateSimulationPrinterOfQuantity",  SUCCESS );
     
     return printer;
 }
@@ -122,6 +150,37 @@ DLLSCOPE RET_VAL STDCALL DestroySimulationPrinter( SIMULATION_PRINTER *printer )
     
     return SUCCESS;
 }
- 
- 
 
+/*
+ * Opens the output file of a run behind a buffer of SIMULATION_PRINTER_BUFFER_SIZE, kept by 
+ * the printer across runs, so rows are written in large blocks instead of one by one.
+ */
+DLLSCOPE FILE * STDCALL OpenSimulationPrinterFile( SIMULATION_PRINTER *printer, char *filename, char *mode ) {
+    FILE *out = NULL;
+    
+    if( ( out = fopen( filename, mode ) ) == NULL ) {
+        return NULL;
+    }
+    if( printer->buffer == NULL ) {
+        printer->buffer = (char*)MALLOC( SIMULATION_PRINTER_BUFFER_SIZE );
+    }
+    if( printer->buffer != NULL ) {
+        setvbuf( out, printer->buffer, _IOFBF, SIMULATION_PRINTER_BUFFER_SIZE );
+    }
+    printer->out = out;
+    return out;
+}
+
+DLLSCOPE RET_VAL STDCALL CloseSimulationPrinterFile( SIMULATION_PRINTER *printer ) {
+    RET_VAL ret = SUCCESS;
+    
+    if( printer->out == NULL ) {
+        return ret;
+    }
+    if( fclose( printer->out ) != 0 ) {
+        ret = FAILING;
+    }
+    printer->out = NULL;
+    return ret;
+}
+ 
@@ -31,6 +31,9 @@ BEGIN_C_NAMESPACE
 #define SIMULATION_PRINTER_TRACKING_QUANTITY_AMOUNT "amount"
 #define SIMULATION_PRINTER_TRACKING_QUANTITY_CONCENTRATION "concentration"
 
+/* output files are fully buffered in blocks of this size and flushed only when closed */
+#define SIMULATION_PRINTER_BUFFER_SIZE 1048576
+
 
 
 struct _SIMULATION_PRINTER;
@@ -44,6 +47,7 @@ struct _SIMULATION_PRINTER {
     REB2SAC_SYMBOL **symbolArray;
     int symSize;
     FILE *out;
+    char *buffer;
     RET_VAL (*PrintStart)( SIMULATION_PRINTER *printer, char *filenameStem );
     RET_VAL (*PrintHeader)( SIMULATION_PRINTER *printer );
     RET_VAL (*PrintValues)( SIMULATION_PRINTER *printer, double time );
@@ -56,8 +60,19 @@ DLLSCOPE SIMULATION_PRINTER * STDCALL CreateSimulationPrinter( BACK_END_PROCESSO
 							       SPECIES **speciesArray, UINT32 size, 
 							       REB2SAC_SYMBOL **symbolArray, UINT32 symSize );
 
+DLLSCOPE SIMULATION_PRINTER * STDCALL CreateSimulationPrinterOfQuantity( BACK_END_PROCESSOR *backend, 
+									 COMPARTMENT **compartmentArray, UINT32 compSize,
+									 SPECIES **speciesArray, UINT32 size, 
+									 REB2SAC_SYMBOL **symbolArray, UINT32 symSize,
+									 BOOL isAmount );
+
+DLLSCOPE BOOL STDCALL IsAmountTrackedBySimulationPrinter( BACK_END_PROCESSOR *backend );
+
 DLLSCOPE RET_VAL STDCALL DestroySimulationPrinter( SIMULATION_PRINTER *printer );
 
+DLLSCOPE FILE * STDCALL OpenSimulationPrinterFile( SIMULATION_PRINTER *printer, char *filename, char *mode );
+DLLSCOPE RET_VAL STDCALL CloseSimulationPrinterFile( SIMULATION_PRINTER *printer );
+
 END_C_NAMESPACE
 
 #endif
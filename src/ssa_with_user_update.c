@@ -22,6 +22,7 @@
 #include "gsl/gsl_vector.h"
 #include "gsl/gsl_multiroots.h"
 #include "ssa_with_user_update.h"
+#include "statistics_simulation_printer.h"
 
 
 
@@ -64,7 +65,7 @@ DLLSCOPE RET_VAL STDCALL DoSSAWithUserUpdateAnalysis( BACK_END_PROCESSOR *backen
     UINT i = 0;
     UINT runs = 1;
     char *namePrefix = NULL;
-    static SSA_WITH_USER_UPDATE_RECORD rec;
+    SSA_WITH_USER_UPDATE_RECORD *rec = NULL;
     UINT timeout = 0;
 
     START_FUNCTION("DoSSAWithUserUpdateAnalysis");
@@ -73,30 +74,39 @@ DLLSCOPE RET_VAL STDCALL DoSSAWithUserUpdateAnalysis( BACK_END_PROCESSOR *backen
         return ErrorReport( FAILING, "DoSSAWithUserUpdateAnalysis", "Gillespie method cannot be applied to the model" );
     }
     
-    if( IS_FAILED( ( ret = _InitializeRecord( &rec, backend, ir ) ) ) )  {
+    if( ( rec = (SSA_WITH_USER_UPDATE_RECORD*)MALLOC( sizeof(SSA_WITH_USER_UPDATE_RECORD) ) ) == NULL ) {
+        return ErrorReport( FAILING, "DoSSAWithUserUpdateAnalysis", "could not allocate the record" );
+    }
+    if( IS_FAILED( ( ret = _InitializeRecord( rec, backend, ir ) ) ) )  {
+        _CleanRecord( rec );
+        FREE( rec );
+        backend->_internal1 = NULL;
         return ErrorReport( ret, "DoSSAWithUserUpdateAnalysis", "initialization of the record failed" );
     }
     
-    runs = rec.runs;    
+    runs = rec->runs;    
     for( i = 1; i <= runs; i++ ) {
-        SeedRandomNumberGenerators( rec.seed );
-        rec.seed = GetNextUniformRandomNumber(0,RAND_MAX);
+        SeedRandomNumberGenerators( rec->seed );
+        rec->seed = GetNextUniformRandomNumber(0,RAND_MAX);
         timeout = 0;
 	do {
-	  SeedRandomNumberGenerators( rec.seed );
-	  if( IS_FAILED( ( ret = _InitializeSimulation( &rec, i ) ) ) ) {
+	  SeedRandomNumberGenerators( rec->seed );
+	  if( IS_FAILED( ( ret = _InitializeSimulation( rec, i ) ) ) ) {
             return ErrorReport( ret, "DoGillespieMonteCarloAnalysis", "initialization of the %i-th simulation failed", i );
 	  }
 	  timeout++;
-	} while ( (ret == CHANGE) && (timeout <= (rec.speciesSize + rec.compartmentsSize + rec.symbolsSize)) );
-        if( IS_FAILED( ( ret = _RunSimulation( &rec ) ) ) ) {
-            return ErrorReport( ret, "DoSSAWithUserUpdateAnalysis", "%i-th simulation failed at time %f", i, rec.time );
+	} while ( (ret == CHANGE) && (timeout <= (rec->speciesSize + rec->compartmentsSize + rec->symbolsSize)) );
+        if( IS_FAILED( ( ret = _RunSimulation( rec ) ) ) ) {
+            return ErrorReport( ret, "DoSSAWithUserUpdateAnalysis", "%i-th simulation failed at time %f", i, rec->time );
         }
-        if( IS_FAILED( ( ret = _CleanSimulation( &rec ) ) ) ) {
+        if( IS_FAILED( ( ret = _CleanSimulation( rec ) ) ) ) {
             return ErrorReport( ret, "DoSSAWithUserUpdateAnalysis", "cleaning of the %i-th simulation failed", i );
         }         
 	printf("Run = %d\n",i);
         fflush(stdout);
+	if( IsRunsTargetMetInSimulationPrinter( rec->printer ) ) {
+	    break;
+	}
     }
     END_FUNCTION("DoSSAWithUserUpdateAnalysis", SUCCESS );
     return ret;            
@@ -111,6 +121,8 @@ DLLSCOPE RET_VAL STDCALL CloseSSAWithUserUpdateAnalyzer( BACK_END_PROCESSOR *bac
     if( IS_FAILED( ( ret = _CleanRecord( rec ) ) ) )  {
         return ErrorReport( ret, "CloseSSAWithUserUpdateAnalyzer", "cleaning of the record failed" );
     }
+    FREE( rec );
+    backend->_internal1 = NULL;
         
     END_FUNCTION("CloseSSAWithUserUpdateAnalyzer",  SUCCESS );
     return ret;            
@@ -310,6 +322,9 @@ static RET_VAL _InitializeRecord( SSA_WITH_USER_UPDATE_RECORD *rec, BACK_END_PRO
 						  speciesArray, rec->speciesSize,
 						  symbolArray, rec->symbolsSize ) ) == NULL ) {
         return ErrorReport( FAILING, "_InitializeRecord", "could not create simulation printer" );
+    }
+    if( ( rec->printer = CreateStatisticsSimulationPrinter( backend, rec->printer, rec->outDir, rec->runs ) ) == NULL ) {
+        return ErrorReport( FAILING, "_InitializeRecord", "could not create simulation statistics printer" );
     }                
 
     if( ( constraintManager = ir->GetConstraintManager( ir ) ) == NULL ) {
@@ -646,8 +661,12 @@ static RET_VAL _CleanRecord( SSA_WITH_USER_UPDATE_RECORD *rec ) {
         FREE( rec->speciesArray );    
     }
     
-    printer->Destroy( printer );
-    decider->Destroy( decider );
+    if( printer != NULL ) {
+        printer->Destroy( printer );
+    }
+    if( decider != NULL ) {
+        decider->Destroy( decider );
+    }
     
     return ret;            
 }
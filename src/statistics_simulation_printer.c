@@ -0,0 +1,917 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the reb2sac contributors                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#include <ctype.h>
+#include <math.h>
+#include "statistics_simulation_printer.h"
+#include "simulation_method.h"
+
+static RET_VAL _PrintStart( SIMULATION_PRINTER *printer, char *filenameStem );
+static RET_VAL _PrintHeader( SIMULATION_PRINTER *printer );
+static RET_VAL _PrintValues( SIMULATION_PRINTER *printer, double time );
+static RET_VAL _PrintEnd( SIMULATION_PRINTER *printer );
+static RET_VAL _Destroy( SIMULATION_PRINTER *printer );
+
+static RET_VAL _ParseNumbers( char *valueString, double *numbers, UINT32 maxSize, UINT32 *size );
+static RET_VAL _InitializeRunsTarget( STATISTICS_SIMULATION_PRINTER_RECORD *rec, BACK_END_PROCESSOR *backend );
+static RET_VAL _FindObservable( STATISTICS_SIMULATION_PRINTER_RECORD *rec, char *id, UINT32 *column );
+static double _GetColumnValue( STATISTICS_SIMULATION_PRINTER_RECORD *rec, UINT32 column );
+static void _SampleObservables( STATISTICS_SIMULATION_PRINTER_RECORD *rec, double time );
+static RET_VAL _AddSamples( STATISTICS_SIMULATION_PRINTER_RECORD *rec );
+static void _CheckRunsTarget( STATISTICS_SIMULATION_PRINTER_RECORD *rec );
+static RET_VAL _EndRun( STATISTICS_SIMULATION_PRINTER_RECORD *rec );
+static RET_VAL _AppendToBatch( STATISTICS_SIMULATION_PRINTER_RECORD *rec, double value );
+static RET_VAL _AddRow( STATISTICS_SIMULATION_PRINTER_RECORD *rec );
+static RET_VAL _Accumulate( STATISTICS_SIMULATION_PRINTER_RECORD *rec, double time, double *values );
+static void _UpdateQuantile( double *markers, UINT32 count, double p, double x );
+static double _GetQuantile( double *markers, UINT32 count, double p );
+static double _GetStatistic( STATISTICS_SIMULATION_PRINTER_RECORD *rec, STATISTICS_SIMULATION_PRINTER_ROW *row, 
+                             UINT32 column, UINT32 statistic );
+static RET_VAL _PrintStatistics( STATISTICS_SIMULATION_PRINTER_RECORD *rec );
+
+
+DLLSCOPE BOOL STDCALL IsStatisticsRequestedForSimulation( BACK_END_PROCESSOR *backend ) {
+    char *valueString = NULL;
+    REB2SAC_PROPERTIES *properties = backend->record->properties;
+    
+    if( ( valueString = properties->GetProperty( properties, MONTE_CARLO_SIMULATION_STATISTICS ) ) == NULL ) {
+        valueString = DEFAULT_MONTE_CARLO_SIMULATION_STATISTICS_VALUE;
+    }
+    return ( strcmp( valueString, "true" ) == 0 ) ? TRUE : FALSE;
+}
+
+DLLSCOPE BOOL STDCALL IsRunsTargetRequestedForSimulation( BACK_END_PROCESSOR *backend ) {
+    REB2SAC_PROPERTIES *properties = backend->record->properties;
+    
+    return ( properties->GetProperty( properties, MONTE_CARLO_SIMULATION_CI_OBSERVABLES ) != NULL ) ? TRUE : FALSE;
+}
+
+DLLSCOPE BOOL STDCALL IsRunsTargetMetInSimulationPrinter( SIMULATION_PRINTER *printer ) {
+    if( printer->PrintStart != _PrintStart ) {
+        return FALSE;
+    }
+    return ((STATISTICS_SIMULATION_PRINTER_RECORD*)printer)->isRunsTargetMet;
+}
+
+DLLSCOPE UINT32 STDCALL GetRunsBatchSizeOfSimulationPrinter( SIMULATION_PRINTER *printer ) {
+    if( printer->PrintStart != _PrintStart ) {
+        return 1;
+    }
+    return STATISTICS_SIMULATION_PRINTER_BATCH_RUNS;
+}
+
+DLLSCOPE RET_VAL STDCALL StartRunsBatchInSimulationPrinter( SIMULATION_PRINTER *printer ) {
+    STATISTICS_SIMULATION_PRINTER_RECORD *rec = (STATISTICS_SIMULATION_PRINTER_RECORD*)printer;
+    
+    if( printer->PrintStart != _PrintStart ) {
+        return SUCCESS;
+    }
+    rec->isBatch = TRUE;
+    rec->batchRuns = 0;
+    rec->batchSize = 0;
+    /* the number of runs is filled in when the batch is taken */
+    return _AppendToBatch( rec, 0.0 );
+}
+
+/*
+ * The batch is laid out as the number of runs, then for every run the number of rows it 
+ * printed, the time and column values of each row and, with stop rules, the samples of the 
+ * run followed by flags telling which were taken.  The caller owns the returned buffer.
+ */
+DLLSCOPE RET_VAL STDCALL GetRunsBatchOfSimulationPrinter( SIMULATION_PRINTER *printer, double **buffer, UINT32 *size ) {
+    STATISTICS_SIMULATION_PRINTER_RECORD *rec = (STATISTICS_SIMULATION_PRINTER_RECORD*)printer;
+    
+    *buffer = NULL;
+    *size = 0;
+    if( ( printer->PrintStart != _PrintStart ) || ( rec->batch == NULL ) ) {
+        return SUCCESS;
+    }
+    rec->batch[0] = (double)rec->batchRuns;
+    *buffer = rec->batch;
+    *size = rec->batchSize;
+    rec->batch = NULL;
+    rec->batchSize = 0;
+    rec->batchCapacity = 0;
+    return SUCCESS;
+}
+
+/*
+ * Replays the runs of a batch as if they had been simulated here: every row goes through 
+ * _Accumulate and every run end through _EndRun, so the statistics and the run at which the 
+ * runs target is met are the same as those of the serial path.  Runs after the one meeting 
+ * the target are dropped, and runs is set to the number of runs merged.
+ */
+DLLSCOPE RET_VAL STDCALL MergeRunsBatchIntoSimulationPrinter( SIMULATION_PRINTER *printer, double *buffer, UINT32 size, 
+                                                              UINT32 *runs ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 k = 0;
+    UINT32 r = 0;
+    UINT32 batchRuns = 0;
+    UINT32 rowsSize = 0;
+    double *p = buffer;
+    double *end = buffer + size;
+    STATISTICS_SIMULATION_PRINTER_RECORD *rec = (STATISTICS_SIMULATION_PRINTER_RECORD*)printer;
+    
+    if( printer->PrintStart != _PrintStart ) {
+        return SUCCESS;
+    }
+    *runs = 0;
+    if( size < 1 ) {
+        return ErrorReport( FAILING, "MergeRunsBatchIntoSimulationPrinter", "batch is empty" );
+    }
+    batchRuns = (UINT32)*(p++);
+    for( r = 0; ( r < batchRuns ) && !rec->isRunsTargetMet; r++ ) {
+        if( p >= end ) {
+            return ErrorReport( FAILING, "MergeRunsBatchIntoSimulationPrinter", "batch is truncated at run %i", r );
+        }
+        rowsSize = (UINT32)*(p++);
+        if( p + rowsSize * ( 1 + rec->columnsSize ) + ( rec->isAdaptive ? 2 * rec->stopRulesSize : 0 ) > end ) {
+            return ErrorReport( FAILING, "MergeRunsBatchIntoSimulationPrinter", "batch is truncated at run %i", r );
+        }
+        rec->currentRow = 0;
+        rec->isLastRowAccumulated = FALSE;
+        for( k = 0; k < rowsSize; k++ ) {
+            if( IS_FAILED( ( ret = _Accumulate( rec, p[0], p + 1 ) ) ) ) {
+                return ret;
+            }
+            p += 1 + rec->columnsSize;
+        }
+        if( rec->isAdaptive ) {
+            for( i = 0; i < rec->stopRulesSize; i++ ) {
+                rec->samples[i] = p[i];
+                rec->isSampled[i] = ( p[rec->stopRulesSize + i] != 0.0 ) ? TRUE : FALSE;
+            }
+            p += 2 * rec->stopRulesSize;
+        }
+        if( IS_FAILED( ( ret = _EndRun( rec ) ) ) ) {
+            return ret;
+        }
+        (*runs)++;
+    }
+    return ret;
+}
+
+DLLSCOPE SIMULATION_PRINTER * STDCALL CreateStatisticsSimulationPrinter( BACK_END_PROCESSOR *backend, 
+									 SIMULATION_PRINTER *printer, 
+									 char *outDir, UINT32 runs ) {
+    UINT32 i = 0;
+    BOOL doStatistics = FALSE;
+    BOOL hasRunFiles = TRUE;
+    BOOL isAdaptive = FALSE;
+    char *valueString = NULL;
+    REB2SAC_PROPERTIES *properties = backend->record->properties;
+    STATISTICS_SIMULATION_PRINTER_RECORD *rec = NULL;
+    
+    START_FUNCTION("CreateStatisticsSimulationPrinter");
+    
+    doStatistics = IsStatisticsRequestedForSimulation( backend );
+    if( ( valueString = properties->GetProperty( properties, MONTE_CARLO_SIMULATION_RUN_FILES ) ) == NULL ) {
+        valueString = DEFAULT_MONTE_CARLO_SIMULATION_RUN_FILES_VALUE;
+    }
+    hasRunFiles = ( strcmp( valueString, "false" ) == 0 ) ? FALSE : TRUE;
+    isAdaptive = IsRunsTargetRequestedForSimulation( backend );
+    if( !doStatistics && hasRunFiles && !isAdaptive ) {
+        END_FUNCTION("CreateStatisticsSimulationPrinter",  SUCCESS );
+        return printer;
+    }
+    
+    if( ( rec = (STATISTICS_SIMULATION_PRINTER_RECORD*)MALLOC( sizeof(STATISTICS_SIMULATION_PRINTER_RECORD) ) ) == NULL ) {
+        printer->Destroy( printer );
+        END_FUNCTION("CreateStatisticsSimulationPrinter",  FAILING );
+        return NULL;
+    }
+    
+    rec->compartmentArray = printer->compartmentArray;
+    rec->compSize = printer->compSize;
+    rec->speciesArray = printer->speciesArray;
+    rec->size = printer->size;
+    rec->symbolArray = printer->symbolArray;
+    rec->symSize = printer->symSize;
+    rec->PrintStart = _PrintStart;
+    rec->PrintHeader = _PrintHeader;
+    rec->PrintValues = _PrintValues;
+    rec->PrintEnd = _PrintEnd;
+    rec->Destroy = _Destroy;
+    
+    if( hasRunFiles ) {
+        rec->runPrinter = printer;
+    }
+    else {
+        printer->Destroy( printer );
+    }
+    rec->doStatistics = doStatistics;
+    rec->isAmount = IsAmountTrackedBySimulationPrinter( backend );
+    rec->outDir = outDir;
+    rec->runs = runs;
+    rec->columnsSize = rec->compSize + rec->size + rec->symSize;
+    if( isAdaptive ) {
+        if( IS_FAILED( _InitializeRunsTarget( rec, backend ) ) ) {
+            _Destroy( (SIMULATION_PRINTER*)rec );
+            END_FUNCTION("CreateStatisticsSimulationPrinter",  FAILING );
+            return NULL;
+        }
+    }
+    if( !doStatistics ) {
+        END_FUNCTION("CreateStatisticsSimulationPrinter",  SUCCESS );
+        return (SIMULATION_PRINTER*)rec;
+    }
+    
+    if( ( valueString = properties->GetProperty( properties, MONTE_CARLO_SIMULATION_STATISTICS_QUANTILES ) ) != NULL ) {
+        if( IS_FAILED( _ParseNumbers( valueString, rec->quantiles, STATISTICS_SIMULATION_PRINTER_MAX_QUANTILES, 
+                                      &(rec->quantilesSize) ) ) ) {
+            _Destroy( (SIMULATION_PRINTER*)rec );
+            END_FUNCTION("CreateStatisticsSimulationPrinter",  FAILING );
+            return NULL;
+        }
+    }
+    for( i = 0; i < rec->quantilesSize; i++ ) {
+        if( ( rec->quantiles[i] <= 0.0 ) || ( rec->quantiles[i] >= 1.0 ) ) {
+            ErrorReport( FAILING, "CreateStatisticsSimulationPrinter", "quantile %g is not between 0 and 1", rec->quantiles[i] );
+            _Destroy( (SIMULATION_PRINTER*)rec );
+            END_FUNCTION("CreateStatisticsSimulationPrinter",  FAILING );
+            return NULL;
+        }
+    }
+    /* mean, M2, minimum and maximum, then the markers and their positions for each quantile */
+    rec->stride = 4 + rec->quantilesSize * 2 * STATISTICS_SIMULATION_PRINTER_MARKERS;
+    if( ( rec->columnValues = (double*)CALLOC( GET_MAX( rec->columnsSize, 1 ), sizeof(double) ) ) == NULL ) {
+        _Destroy( (SIMULATION_PRINTER*)rec );
+        END_FUNCTION("CreateStatisticsSimulationPrinter",  FAILING );
+        return NULL;
+    }
+    
+    /* the statistics are stored in species nodes as amounts before they are printed */
+    rec->statisticsPrintersSize = STATISTICS_SIMULATION_PRINTER_QUANTILE + rec->quantilesSize;
+    if( ( rec->statisticsPrinters = (SIMULATION_PRINTER**)CALLOC( rec->statisticsPrintersSize, sizeof(SIMULATION_PRINTER*) ) ) == NULL ) {
+        _Destroy( (SIMULATION_PRINTER*)rec );
+        END_FUNCTION("CreateStatisticsSimulationPrinter",  FAILING );
+        return NULL;
+    }
+    for( i = 0; i < rec->statisticsPrintersSize; i++ ) {
+        if( ( rec->statisticsPrinters[i] = CreateSimulationPrinterOfQuantity( backend, rec->compartmentArray, rec->compSize,
+                                                                              rec->speciesArray, rec->size,
+                                                                              rec->symbolArray, rec->symSize, TRUE ) ) == NULL ) {
+            _Destroy( (SIMULATION_PRINTER*)rec );
+            END_FUNCTION("CreateStatisticsSimulationPrinter",  FAILING );
+            return NULL;
+        }
+    }
+    
+    END_FUNCTION("CreateStatisticsSimulationPrinter",  SUCCESS );
+    return (SIMULATION_PRINTER*)rec;
+}
+
+static RET_VAL _ParseNumbers( char *valueString, double *numbers, UINT32 maxSize, UINT32 *size ) {
+    char *current = valueString;
+    char *end = NULL;
+    double number = 0.0;
+    
+    *size = 0;
+    while( *current != '\0' ) {
+        if( ( *current == ',' ) || isspace( *current ) ) {
+            current++;
+            continue;
+        }
+        number = strtod( current, &end );
+        if( end == current ) {
+            return ErrorReport( FAILING, "_ParseNumbers", "%s is not a list of numbers", valueString );
+        }
+        if( *size == maxSize ) {
+            return ErrorReport( FAILING, "_ParseNumbers", "%s has more than %i numbers", valueString, maxSize );
+        }
+        numbers[*size] = number;
+        (*size)++;
+        current = end;
+    }
+    return SUCCESS;
+}
+
+static RET_VAL _InitializeRunsTarget( STATISTICS_SIMULATION_PRINTER_RECORD *rec, BACK_END_PROCESSOR *backend ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 length = 0;
+    double confidenceLevel = DEFAULT_MONTE_CARLO_CI_CONFIDENCE_LEVEL_VALUE;
+    double tolerance = DEFAULT_MONTE_CARLO_CI_ERROR_TOLERANCE_VALUE;
+    char id[256];
+    char *current = NULL;
+    char *valueString = NULL;
+    REB2SAC_PROPERTIES *properties = backend->record->properties;
+    
+    rec->isAdaptive = TRUE;
+    if( ( valueString = properties->GetProperty( properties, MONTE_CARLO_CI_CONFIDENCE_LEVEL ) ) != NULL ) {
+        if( IS_FAILED( StrToFloat( &confidenceLevel, valueString ) ) ) {
+            confidenceLevel = DEFAULT_MONTE_CARLO_CI_CONFIDENCE_LEVEL_VALUE;
+        }
+    }
+    if( ( valueString = properties->GetProperty( properties, MONTE_CARLO_CI_ERROR_TOLERANCE ) ) != NULL ) {
+        if( IS_FAILED( StrToFloat( &tolerance, valueString ) ) ) {
+            tolerance = DEFAULT_MONTE_CARLO_CI_ERROR_TOLERANCE_VALUE;
+        }
+    }
+    rec->minRuns = DEFAULT_MONTE_CARLO_SIMULATION_CI_MIN_RUNS_VALUE;
+    if( ( valueString = properties->GetProperty( properties, MONTE_CARLO_SIMULATION_CI_MIN_RUNS ) ) != NULL ) {
+        if( IS_FAILED( StrToUINT32( &(rec->minRuns), valueString ) ) ) {
+            rec->minRuns = DEFAULT_MONTE_CARLO_SIMULATION_CI_MIN_RUNS_VALUE;
+        }
+    }
+    /* at least two samples are needed for an interval */
+    rec->minRuns = GET_MAX( rec->minRuns, 2 );
+    if( ( valueString = properties->GetProperty( properties, MONTE_CARLO_SIMULATION_CI_TIMES ) ) != NULL ) {
+        if( IS_FAILED( ( ret = _ParseNumbers( valueString, rec->ciTimes, STATISTICS_SIMULATION_PRINTER_MAX_CI_TIMES, 
+                                              &(rec->ciTimesSize) ) ) ) ) {
+            return ret;
+        }
+    }
+    
+    valueString = properties->GetProperty( properties, MONTE_CARLO_SIMULATION_CI_OBSERVABLES );
+    if( ( rec->observables = (UINT32*)CALLOC( strlen( valueString ) + 1, sizeof(UINT32) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_InitializeRunsTarget", "could not allocate memory for observables" );
+    }
+    current = valueString;
+    while( *current != '\0' ) {
+        if( ( *current == ',' ) || isspace( *current ) ) {
+            current++;
+            continue;
+        }
+        for( length = 0; ( current[length] != '\0' ) && ( current[length] != ',' ) && !isspace( current[length] ); length++ );
+        if( length >= sizeof(id) ) {
+            return ErrorReport( FAILING, "_InitializeRunsTarget", "observable id in %s is too long", valueString );
+        }
+        strncpy( id, current, length );
+        id[length] = '\0';
+        if( IS_FAILED( ( ret = _FindObservable( rec, id, rec->observables + rec->observablesSize ) ) ) ) {
+            return ret;
+        }
+        rec->observablesSize++;
+        current += length;
+    }
+    if( rec->observablesSize == 0 ) {
+        return ErrorReport( FAILING, "_InitializeRunsTarget", "no observable is given in %s", MONTE_CARLO_SIMULATION_CI_OBSERVABLES );
+    }
+    
+    /* one rule per observable and time; the final value counts as a single time */
+    rec->stopRulesSize = rec->observablesSize * GET_MAX( rec->ciTimesSize, 1 );
+    if( ( ( rec->stopRules = (CONFIDENCE_INTERVAL_STOP_RULE**)CALLOC( rec->stopRulesSize, sizeof(CONFIDENCE_INTERVAL_STOP_RULE*) ) ) == NULL ) ||
+        ( ( rec->samples = (double*)CALLOC( rec->stopRulesSize, sizeof(double) ) ) == NULL ) ||
+        ( ( rec->isSampled = (BOOL*)CALLOC( rec->stopRulesSize, sizeof(BOOL) ) ) == NULL ) ) {
+        return ErrorReport( FAILING, "_InitializeRunsTarget", "could not allocate memory for stop rules" );
+    }
+    for( i = 0; i < rec->stopRulesSize; i++ ) {
+        if( ( rec->stopRules[i] = CreateSampleMeanConfidenceIntervalStopRule( confidenceLevel, tolerance ) ) == NULL ) {
+            return ErrorReport( FAILING, "_InitializeRunsTarget", "could not create stop rule" );
+        }
+    }
+    return ret;
+}
+
+static RET_VAL _FindObservable( STATISTICS_SIMULATION_PRINTER_RECORD *rec, char *id, UINT32 *column ) {
+    UINT32 i = 0;
+    
+    for( i = 0; i < (UINT32)rec->compSize; i++ ) {
+        if( strcmp( id, GetCharArrayOfString( GetCompartmentID( rec->compartmentArray[i] ) ) ) == 0 ) {
+            *column = i;
+            return SUCCESS;
+        }
+    }
+    for( i = 0; i < (UINT32)rec->size; i++ ) {
+        if( strcmp( id, GetCharArrayOfString( GetSpeciesNodeName( rec->speciesArray[i] ) ) ) == 0 ) {
+            *column = rec->compSize + i;
+            return SUCCESS;
+        }
+    }
+    for( i = 0; i < (UINT32)rec->symSize; i++ ) {
+        if( strcmp( id, GetCharArrayOfString( GetSymbolID( rec->symbolArray[i] ) ) ) == 0 ) {
+            *column = rec->compSize + rec->size + i;
+            return SUCCESS;
+        }
+    }
+    return ErrorReport( FAILING, "_FindObservable", "observable %s is not a compartment, species or parameter", id );
+}
+
+static RET_VAL _PrintStart( SIMULATION_PRINTER *printer, char *filenameStem ) {
+    RET_VAL ret = SUCCESS;
+    STATISTICS_SIMULATION_PRINTER_RECORD *rec = (STATISTICS_SIMULATION_PRINTER_RECORD*)printer;
+    
+    rec->currentRow = 0;
+    rec->isLastRowAccumulated = FALSE;
+    if( rec->isAdaptive ) {
+        memset( rec->isSampled, 0, rec->stopRulesSize * sizeof(BOOL) );
+    }
+    if( rec->isBatch ) {
+        /* the number of rows of the run, counted by _PrintValues */
+        rec->batchRowsIndex = rec->batchSize;
+        if( IS_FAILED( ( ret = _AppendToBatch( rec, 0.0 ) ) ) ) {
+            return ret;
+        }
+    }
+    if( rec->runPrinter == NULL ) {
+        return SUCCESS;
+    }
+    return rec->runPrinter->PrintStart( rec->runPrinter, filenameStem );
+}
+
+static RET_VAL _PrintHeader( SIMULATION_PRINTER *printer ) {
+    STATISTICS_SIMULATION_PRINTER_RECORD *rec = (STATISTICS_SIMULATION_PRINTER_RECORD*)printer;
+    
+    if( rec->runPrinter == NULL ) {
+        return SUCCESS;
+    }
+    return rec->runPrinter->PrintHeader( rec->runPrinter );
+}
+
+static RET_VAL _PrintValues( SIMULATION_PRINTER *printer, double time ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    STATISTICS_SIMULATION_PRINTER_RECORD *rec = (STATISTICS_SIMULATION_PRINTER_RECORD*)printer;
+    
+    if( rec->runPrinter != NULL ) {
+        if( IS_FAILED( ( ret = rec->runPrinter->PrintValues( rec->runPrinter, time ) ) ) ) {
+            return ret;
+        }
+    }
+    if( rec->isAdaptive ) {
+        _SampleObservables( rec, time );
+    }
+    if( !rec->doStatistics ) {
+        return ret;
+    }
+    if( rec->isBatch ) {
+        /* the parent accumulates the row when it merges the batch */
+        rec->batch[rec->batchRowsIndex] += 1.0;
+        if( IS_FAILED( ( ret = _AppendToBatch( rec, time ) ) ) ) {
+            return ret;
+        }
+        for( i = 0; i < rec->columnsSize; i++ ) {
+            if( IS_FAILED( ( ret = _AppendToBatch( rec, _GetColumnValue( rec, i ) ) ) ) ) {
+                return ret;
+            }
+        }
+        return ret;
+    }
+    for( i = 0; i < rec->columnsSize; i++ ) {
+        rec->columnValues[i] = _GetColumnValue( rec, i );
+    }
+    return _Accumulate( rec, time, rec->columnValues );
+}
+
+static RET_VAL _PrintEnd( SIMULATION_PRINTER *printer ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    STATISTICS_SIMULATION_PRINTER_RECORD *rec = (STATISTICS_SIMULATION_PRINTER_RECORD*)printer;
+    
+    if( rec->runPrinter != NULL ) {
+        if( IS_FAILED( ( ret = rec->runPrinter->PrintEnd( rec->runPrinter ) ) ) ) {
+            return ret;
+        }
+    }
+    if( !rec->isBatch ) {
+        return _EndRun( rec );
+    }
+    rec->batchRuns++;
+    if( rec->isAdaptive ) {
+        /* the parent adds the samples to its stop rules in run order */
+        for( i = 0; i < rec->stopRulesSize; i++ ) {
+            if( IS_FAILED( ( ret = _AppendToBatch( rec, rec->samples[i] ) ) ) ) {
+                return ret;
+            }
+        }
+        for( i = 0; i < rec->stopRulesSize; i++ ) {
+            if( IS_FAILED( ( ret = _AppendToBatch( rec, rec->isSampled[i] ? 1.0 : 0.0 ) ) ) ) {
+                return ret;
+            }
+        }
+    }
+    return ret;
+}
+
+static RET_VAL _EndRun( STATISTICS_SIMULATION_PRINTER_RECORD *rec ) {
+    RET_VAL ret = SUCCESS;
+    
+    rec->completedRuns++;
+    if( rec->isAdaptive ) {
+        if( IS_FAILED( ( ret = _AddSamples( rec ) ) ) ) {
+            return ret;
+        }
+        _CheckRunsTarget( rec );
+    }
+    if( !rec->doStatistics ) {
+        return ret;
+    }
+    if( rec->isLastRowAccumulated ) {
+        rec->rows[rec->currentRow - 1].finalCount++;
+    }
+    if( ( rec->completedRuns == rec->runs ) || rec->isRunsTargetMet ) {
+        ret = _PrintStatistics( rec );
+    }
+    return ret;
+}
+
+static RET_VAL _AppendToBatch( STATISTICS_SIMULATION_PRINTER_RECORD *rec, double value ) {
+    UINT32 capacity = 0;
+    double *batch = NULL;
+    
+    if( rec->batchSize == rec->batchCapacity ) {
+        capacity = ( rec->batchCapacity == 0 ) ? 1024 : 2 * rec->batchCapacity;
+        if( ( batch = (double*)REALLOC( rec->batch, capacity * sizeof(double) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_AppendToBatch", "could not allocate memory for the batch" );
+        }
+        rec->batch = batch;
+        rec->batchCapacity = capacity;
+    }
+    rec->batch[rec->batchSize] = value;
+    rec->batchSize++;
+    return SUCCESS;
+}
+
+static RET_VAL _Destroy( SIMULATION_PRINTER *printer ) {
+    UINT32 i = 0;
+    STATISTICS_SIMULATION_PRINTER_RECORD *rec = (STATISTICS_SIMULATION_PRINTER_RECORD*)printer;
+    
+    if( rec->runPrinter != NULL ) {
+        rec->runPrinter->Destroy( rec->runPrinter );
+    }
+    if( rec->statisticsPrinters != NULL ) {
+        for( i = 0; i < rec->statisticsPrintersSize; i++ ) {
+            if( rec->statisticsPrinters[i] != NULL ) {
+                rec->statisticsPrinters[i]->Destroy( rec->statisticsPrinters[i] );
+            }
+        }
+        FREE( rec->statisticsPrinters );
+    }
+    for( i = 0; i < rec->rowsSize; i++ ) {
+        FREE( rec->rows[i].values );
+    }
+    if( rec->rows != NULL ) {
+        FREE( rec->rows );
+    }
+    if( rec->stopRules != NULL ) {
+        for( i = 0; i < rec->stopRulesSize; i++ ) {
+            if( rec->stopRules[i] != NULL ) {
+                FreeConfidenceIntervalStopRule( &(rec->stopRules[i]) );
+            }
+        }
+        FREE( rec->stopRules );
+    }
+    if( rec->observables != NULL ) {
+        FREE( rec->observables );
+    }
+    if( rec->samples != NULL ) {
+        FREE( rec->samples );
+    }
+    if( rec->isSampled != NULL ) {
+        FREE( rec->isSampled );
+    }
+    if( rec->columnValues != NULL ) {
+        FREE( rec->columnValues );
+    }
+    if( rec->batch != NULL ) {
+        FREE( rec->batch );
+    }
+    FREE( rec );
+    return SUCCESS;
+}
+
+/*
+ * Folds values, one per column, into the row of the current print index.  Rows are 
+ * matched by index, so a row whose time differs from the one recorded for its index is left 
+ * out.  That only happens for the last row of a run stopped early, and if every value of a 
+ * row came from such last rows, the row is restarted with the run that reaches it further.
+ */
+static RET_VAL _Accumulate( STATISTICS_SIMULATION_PRINTER_RECORD *rec, double time, double *values ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 j = 0;
+    UINT32 n = 0;
+    double x = 0.0;
+    double delta = 0.0;
+    double *cell = NULL;
+    STATISTICS_SIMULATION_PRINTER_ROW *row = NULL;
+    
+    if( rec->currentRow == rec->rowsSize ) {
+        if( IS_FAILED( ( ret = _AddRow( rec ) ) ) ) {
+            return ret;
+        }
+    }
+    row = rec->rows + rec->currentRow;
+    rec->currentRow++;
+    rec->isLastRowAccumulated = FALSE;
+    
+    if( ( row->count > 0 ) && ( row->time != time ) ) {
+        if( row->finalCount < row->count ) {
+            return SUCCESS;
+        }
+        row->count = 0;
+        row->finalCount = 0;
+    }
+    row->time = time;
+    row->count++;
+    n = row->count;
+    
+    for( i = 0; i < rec->columnsSize; i++ ) {
+        x = values[i];
+        cell = row->values + i * rec->stride;
+        if( n == 1 ) {
+            cell[0] = x;
+            cell[1] = 0.0;
+            cell[2] = x;
+            cell[3] = x;
+        }
+        else {
+            delta = x - cell[0];
+            cell[0] += delta / (double)n;
+            cell[1] += delta * ( x - cell[0] );
+            if( x < cell[2] ) {
+                cell[2] = x;
+            }
+            if( x > cell[3] ) {
+                cell[3] = x;
+            }
+        }
+        for( j = 0; j < rec->quantilesSize; j++ ) {
+            _UpdateQuantile( cell + 4 + j * 2 * STATISTICS_SIMULATION_PRINTER_MARKERS, n, rec->quantiles[j], x );
+        }
+    }
+    rec->isLastRowAccumulated = TRUE;
+    return SUCCESS;
+}
+
+static RET_VAL _AddRow( STATISTICS_SIMULATION_PRINTER_RECORD *rec ) {
+    UINT32 capacity = 0;
+    STATISTICS_SIMULATION_PRINTER_ROW *rows = NULL;
+    STATISTICS_SIMULATION_PRINTER_ROW *row = NULL;
+    
+    if( rec->rowsSize == rec->rowsCapacity ) {
+        capacity = ( rec->rowsCapacity == 0 ) ? 64 : 2 * rec->rowsCapacity;
+        if( ( rows = (STATISTICS_SIMULATION_PRINTER_ROW*)REALLOC( rec->rows, 
+                                                                   capacity * sizeof(STATISTICS_SIMULATION_PRINTER_ROW) ) ) == NULL ) {
+            return ErrorReport( FAILING, "_AddRow", "could not allocate memory for statistics rows" );
+        }
+        rec->rows = rows;
+        rec->rowsCapacity = capacity;
+    }
+    row = rec->rows + rec->rowsSize;
+    if( ( row->values = (double*)MALLOC( GET_MAX( rec->columnsSize, 1 ) * rec->stride * sizeof(double) ) ) == NULL ) {
+        return ErrorReport( FAILING, "_AddRow", "could not allocate memory for statistics of row %i", rec->rowsSize );
+    }
+    row->count = 0;
+    row->finalCount = 0;
+    rec->rowsSize++;
+    return SUCCESS;
+}
+
+static double _GetColumnValue( STATISTICS_SIMULATION_PRINTER_RECORD *rec, UINT32 column ) {
+    if( column < (UINT32)rec->compSize ) {
+        return GetCurrentSizeInCompartment( rec->compartmentArray[column] );
+    }
+    column -= rec->compSize;
+    if( column < (UINT32)rec->size ) {
+        return rec->isAmount ? GetAmountInSpeciesNode( rec->speciesArray[column] ) 
+                             : GetConcentrationInSpeciesNode( rec->speciesArray[column] );
+    }
+    return GetCurrentRealValueInSymbol( rec->symbolArray[column - rec->size] );
+}
+
+/*
+ * Values are only seen when a row is printed, so the value at a time of 
+ * MONTE_CARLO_SIMULATION_CI_TIMES is taken from the first row printed at or after it; 
+ * placing the times on the print grid makes them exact.  Without times, the last row wins.
+ */
+static void _SampleObservables( STATISTICS_SIMULATION_PRINTER_RECORD *rec, double time ) {
+    UINT32 i = 0;
+    UINT32 j = 0;
+    UINT32 k = 0;
+    
+    for( i = 0; i < rec->observablesSize; i++ ) {
+        if( rec->ciTimesSize == 0 ) {
+            rec->samples[i] = _GetColumnValue( rec, rec->observables[i] );
+            rec->isSampled[i] = TRUE;
+            continue;
+        }
+        for( j = 0; j < rec->ciTimesSize; j++ ) {
+            k = i * rec->ciTimesSize + j;
+            if( !rec->isSampled[k] && ( time >= rec->ciTimes[j] ) ) {
+                rec->samples[k] = _GetColumnValue( rec, rec->observables[i] );
+                rec->isSampled[k] = TRUE;
+            }
+        }
+    }
+}
+
+/*
+ * Adds the samples of the run that just ended.  A time the run did not reach adds nothing.
+ */
+static RET_VAL _AddSamples( STATISTICS_SIMULATION_PRINTER_RECORD *rec ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    CONFIDENCE_INTERVAL_STOP_RULE *stopRule = NULL;
+    
+    for( i = 0; i < rec->stopRulesSize; i++ ) {
+        stopRule = rec->stopRules[i];
+        if( rec->isSampled[i] ) {
+            if( IS_FAILED( ( ret = stopRule->AddNewSample( stopRule, rec->samples[i] ) ) ) ) {
+                return ret;
+            }
+        }
+    }
+    return ret;
+}
+
+static void _CheckRunsTarget( STATISTICS_SIMULATION_PRINTER_RECORD *rec ) {
+    UINT32 i = 0;
+    BOOL isMet = TRUE;
+    CONFIDENCE_INTERVAL_STOP_RULE *stopRule = NULL;
+    
+    for( i = 0; i < rec->stopRulesSize; i++ ) {
+        stopRule = rec->stopRules[i];
+        if( !stopRule->IsConditionMet( stopRule ) ) {
+            isMet = FALSE;
+        }
+    }
+    if( isMet && ( rec->completedRuns >= rec->minRuns ) && ( rec->completedRuns < rec->runs ) ) {
+        TRACE_1( "confidence intervals are within the tolerance after %i runs", rec->completedRuns );
+        rec->isRunsTargetMet = TRUE;
+    }
+}
+
+/*
+ * P-square estimate of the p-quantile (Jain and Chlamtac, 1985): five marker heights 
+ * followed by their 1-based positions.  The first five observations are kept sorted; 
+ * afterwards the inner markers are moved towards their desired positions with a 
+ * piecewise-parabolic prediction.
+ */
+static void _UpdateQuantile( double *markers, UINT32 count, double p, double x ) {
+    int i = 0;
+    int k = 0;
+    int s = 0;
+    double d = 0.0;
+    double desired = 0.0;
+    double q = 0.0;
+    double *heights = markers;
+    double *positions = markers + STATISTICS_SIMULATION_PRINTER_MARKERS;
+    double increments[STATISTICS_SIMULATION_PRINTER_MARKERS];
+    
+    if( count <= STATISTICS_SIMULATION_PRINTER_MARKERS ) {
+        for( i = count - 1; ( i > 0 ) && ( heights[i - 1] > x ); i-- ) {
+            heights[i] = heights[i - 1];
+        }
+        heights[i] = x;
+        if( count == STATISTICS_SIMULATION_PRINTER_MARKERS ) {
+            for( i = 0; i < STATISTICS_SIMULATION_PRINTER_MARKERS; i++ ) {
+                positions[i] = (double)( i + 1 );
+            }
+        }
+        return;
+    }
+    
+    if( x < heights[0] ) {
+        heights[0] = x;
+        k = 0;
+    }
+    else if( x >= heights[4] ) {
+        heights[4] = x;
+        k = 3;
+    }
+    else {
+        for( k = 0; ( k < 3 ) && ( x >= heights[k + 1] ); k++ );
+    }
+    for( i = k + 1; i < STATISTICS_SIMULATION_PRINTER_MARKERS; i++ ) {
+        positions[i] += 1.0;
+    }
+    
+    increments[1] = p / 2.0;
+    increments[2] = p;
+    increments[3] = ( 1.0 + p ) / 2.0;
+    for( i = 1; i < 4; i++ ) {
+        desired = 1.0 + (double)( count - 1 ) * increments[i];
+        d = desired - positions[i];
+        if( ( ( d >= 1.0 ) && ( positions[i + 1] - positions[i] > 1.0 ) ) ||
+            ( ( d <= -1.0 ) && ( positions[i - 1] - positions[i] < -1.0 ) ) ) {
+            s = ( d >= 0.0 ) ? 1 : -1;
+            q = heights[i] + (double)s / ( positions[i + 1] - positions[i - 1] ) *
+                ( ( positions[i] - positions[i - 1] + s ) * ( heights[i + 1] - heights[i] ) / ( positions[i + 1] - positions[i] ) +
+                  ( positions[i + 1] - positions[i] - s ) * ( heights[i] - heights[i - 1] ) / ( positions[i] - positions[i - 1] ) );
+            if( ( q <= heights[i - 1] ) || ( q >= heights[i + 1] ) ) {
+                q = heights[i] + s * ( heights[i + s] - heights[i] ) / ( positions[i + s] - positions[i] );
+            }
+            heights[i] = q;
+            positions[i] += s;
+        }
+    }
+}
+
+static double _GetQuantile( double *markers, UINT32 count, double p ) {
+    if( count > STATISTICS_SIMULATION_PRINTER_MARKERS ) {
+        return markers[2];
+    }
+    return markers[(UINT32)floor( p * (double)( count - 1 ) + 0.5 )];
+}
+
+static double _GetStatistic( STATISTICS_SIMULATION_PRINTER_RECORD *rec, STATISTICS_SIMULATION_PRINTER_ROW *row, 
+                             UINT32 column, UINT32 statistic ) {
+    UINT32 j = 0;
+    double *cell = row->values + column * rec->stride;
+    double variance = ( row->count > 1 ) ? cell[1] / (double)( row->count - 1 ) : 0.0;
+    
+    switch( statistic ) {
+        case STATISTICS_SIMULATION_PRINTER_MEAN:
+            return cell[0];
+        case STATISTICS_SIMULATION_PRINTER_VARIANCE:
+            return variance;
+        case STATISTICS_SIMULATION_PRINTER_STANDARD_DEVIATION:
+            return sqrt( variance );
+        case STATISTICS_SIMULATION_PRINTER_MINIMUM:
+            return cell[2];
+        case STATISTICS_SIMULATION_PRINTER_MAXIMUM:
+            return cell[3];
+        default:
+            j = statistic - STATISTICS_SIMULATION_PRINTER_QUANTILE;
+            return _GetQuantile( cell + 4 + j * 2 * STATISTICS_SIMULATION_PRINTER_MARKERS, row->count, rec->quantiles[j] );
+    }
+}
+
+/*
+ * Writes one file per statistic.  Like the iSSA mean and variance printers, the values of a 
+ * row are stored in the model before the row is printed, species as amounts.
+ */
+static RET_VAL _PrintStatistics( STATISTICS_SIMULATION_PRINTER_RECORD *rec ) {
+    RET_VAL ret = SUCCESS;
+    UINT32 i = 0;
+    UINT32 k = 0;
+    UINT32 statistic = 0;
+    double value = 0.0;
+    char filenameStem[512];
+    SIMULATION_PRINTER *printer = NULL;
+    STATISTICS_SIMULATION_PRINTER_ROW *row = NULL;
+    
+    for( statistic = 0; statistic < rec->statisticsPrintersSize; statistic++ ) {
+        printer = rec->statisticsPrinters[statistic];
+        switch( statistic ) {
+            case STATISTICS_SIMULATION_PRINTER_MEAN:
+                sprintf( filenameStem, "%s%cmean", rec->outDir, FILE_SEPARATOR );
+            break;
+            case STATISTICS_SIMULATION_PRINTER_VARIANCE:
+                sprintf( filenameStem, "%s%cvariance", rec->outDir, FILE_SEPARATOR );
+            break;
+            case STATISTICS_SIMULATION_PRINTER_STANDARD_DEVIATION:
+                sprintf( filenameStem, "%s%cstandard_deviation", rec->outDir, FILE_SEPARATOR );
+            break;
+            case STATISTICS_SIMULATION_PRINTER_MINIMUM:
+                sprintf( filenameStem, "%s%cminimum", rec->outDir, FILE_SEPARATOR );
+            break;
+            case STATISTICS_SIMULATION_PRINTER_MAXIMUM:
+                sprintf( filenameStem, "%s%cmaximum", rec->outDir, FILE_SEPARATOR );
+            break;
+            default:
+                sprintf( filenameStem, "%s%cquantile_%g", rec->outDir, FILE_SEPARATOR, 
+                         rec->quantiles[statistic - STATISTICS_SIMULATION_PRINTER_QUANTILE] );
+            break;
+        }
+        if( IS_FAILED( ( ret = printer->PrintStart( printer, filenameStem ) ) ) ) {
+            return ErrorReport( ret, "_PrintStatistics", "could not create %s", filenameStem );
+        }
+        if( IS_FAILED( ( ret = printer->PrintHeader( printer ) ) ) ) {
+            return ret;
+        }
+        for( k = 0; k < rec->rowsSize; k++ ) {
+            row = rec->rows + k;
+            if( row->count == 0 ) {
+                continue;
+            }
+            for( i = 0; i < rec->columnsSize; i++ ) {
+                value = _GetStatistic( rec, row, i, statistic );
+                if( i < (UINT32)rec->compSize ) {
+                    SetCurrentSizeInCompartment( rec->compartmentArray[i], value );
+                }
+                else if( i - rec->compSize < (UINT32)rec->size ) {
+                    SetAmountInSpeciesNode( rec->speciesArray[i - rec->compSize], value );
+                }
+                else {
+                    SetCurrentRealValueInSymbol( rec->symbolArray[i - rec->compSize - rec->size], value );
+                }
+            }
+            if( IS_FAILED( ( ret = printer->PrintValues( printer, row->time ) ) ) ) {
+                return ret;
+            }
+        }
+        if( IS_FAILED( ( ret = printer->PrintEnd( printer ) ) ) ) {
+            return ret;
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,152 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the reb2sac contributors                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#if !defined(HAVE_STATISTICS_SIMULATION_PRINTER)
+#define HAVE_STATISTICS_SIMULATION_PRINTER
+
+#include "simulation_printer.h"
+#include "confidence_interval_stop_rule.h"
+
+BEGIN_C_NAMESPACE
+
+/*
+ * The statistics printer wraps the printer of a stochastic simulator and summarizes the 
+ * ensemble while the runs are simulated.  Every row a run prints is folded into the row of 
+ * the same print index: Welford's mean and variance, the minimum and maximum and, when 
+ * MONTE_CARLO_SIMULATION_STATISTICS_QUANTILES lists probabilities, P-square quantile 
+ * estimates.  Once the last run ends, the statistics are written with the selected printer 
+ * to mean, variance, standard_deviation, minimum, maximum and quantile_<p> files in the 
+ * output directory.  The per-run files are still written unless 
+ * MONTE_CARLO_SIMULATION_RUN_FILES is "false".
+ *
+ * When MONTE_CARLO_SIMULATION_CI_OBSERVABLES names compartments, species or parameters, the 
+ * printer also decides how many runs are needed: each run contributes the final value of 
+ * every observable, or its value at each time of MONTE_CARLO_SIMULATION_CI_TIMES, to a 
+ * confidence interval stop rule.  Once MONTE_CARLO_SIMULATION_CI_MIN_RUNS runs are done and 
+ * every interval is within the relative tolerance, IsRunsTargetMetInSimulationPrinter 
+ * becomes true; the runs property is then only a cap.  An observable whose samples so far 
+ * have a zero mean or do not vary keeps the runs going up to the cap.
+ */
+#define STATISTICS_SIMULATION_PRINTER_MEAN 0
+#define STATISTICS_SIMULATION_PRINTER_VARIANCE 1
+#define STATISTICS_SIMULATION_PRINTER_STANDARD_DEVIATION 2
+#define STATISTICS_SIMULATION_PRINTER_MINIMUM 3
+#define STATISTICS_SIMULATION_PRINTER_MAXIMUM 4
+#define STATISTICS_SIMULATION_PRINTER_QUANTILE 5
+
+#define STATISTICS_SIMULATION_PRINTER_MAX_QUANTILES 16
+#define STATISTICS_SIMULATION_PRINTER_MARKERS 5
+#define STATISTICS_SIMULATION_PRINTER_MAX_CI_TIMES 64
+#define STATISTICS_SIMULATION_PRINTER_BATCH_RUNS 8
+
+typedef struct {
+    double time;
+    UINT32 count;
+    UINT32 finalCount;
+    double *values;
+} STATISTICS_SIMULATION_PRINTER_ROW;
+
+struct _STATISTICS_SIMULATION_PRINTER_RECORD;
+typedef struct _STATISTICS_SIMULATION_PRINTER_RECORD STATISTICS_SIMULATION_PRINTER_RECORD;
+
+struct _STATISTICS_SIMULATION_PRINTER_RECORD {
+    COMPARTMENT **compartmentArray;
+    int compSize;
+    SPECIES **speciesArray;
+    int size;
+    REB2SAC_SYMBOL **symbolArray;
+    int symSize;
+    FILE *out;
+    char *buffer;
+    RET_VAL (*PrintStart)( SIMULATION_PRINTER *printer, char *filenameStem );
+    RET_VAL (*PrintHeader)( SIMULATION_PRINTER *printer );
+    RET_VAL (*PrintValues)( SIMULATION_PRINTER *printer, double time );
+    RET_VAL (*PrintEnd)( SIMULATION_PRINTER *printer );
+    RET_VAL (*Destroy)( SIMULATION_PRINTER *printer );
+    
+    SIMULATION_PRINTER *runPrinter;
+    BOOL doStatistics;
+    BOOL isAmount;
+    char *outDir;
+    UINT32 runs;
+    UINT32 completedRuns;
+    UINT32 columnsSize;
+    UINT32 stride;
+    double quantiles[STATISTICS_SIMULATION_PRINTER_MAX_QUANTILES];
+    UINT32 quantilesSize;
+    STATISTICS_SIMULATION_PRINTER_ROW *rows;
+    UINT32 rowsSize;
+    UINT32 rowsCapacity;
+    UINT32 currentRow;
+    BOOL isLastRowAccumulated;
+    SIMULATION_PRINTER **statisticsPrinters;
+    UINT32 statisticsPrintersSize;
+    
+    BOOL isAdaptive;
+    BOOL isRunsTargetMet;
+    UINT32 minRuns;
+    UINT32 *observables;
+    UINT32 observablesSize;
+    double ciTimes[STATISTICS_SIMULATION_PRINTER_MAX_CI_TIMES];
+    UINT32 ciTimesSize;
+    CONFIDENCE_INTERVAL_STOP_RULE **stopRules;
+    UINT32 stopRulesSize;
+    double *samples;
+    BOOL *isSampled;
+    
+    double *columnValues;
+    
+    BOOL isBatch;
+    double *batch;
+    UINT32 batchSize;
+    UINT32 batchCapacity;
+    UINT32 batchRuns;
+    UINT32 batchRowsIndex;
+};
+
+/*
+ * Returns printer itself when neither the statistics nor the suppression of the per-run 
+ * files is requested.  Otherwise the returned printer owns printer, and the statistics are 
+ * written when the runs-th run ends.
+ */
+DLLSCOPE SIMULATION_PRINTER * STDCALL CreateStatisticsSimulationPrinter( BACK_END_PROCESSOR *backend, 
+									 SIMULATION_PRINTER *printer, 
+									 char *outDir, UINT32 runs );
+
+DLLSCOPE BOOL STDCALL IsStatisticsRequestedForSimulation( BACK_END_PROCESSOR *backend );
+DLLSCOPE BOOL STDCALL IsRunsTargetRequestedForSimulation( BACK_END_PROCESSOR *backend );
+DLLSCOPE BOOL STDCALL IsRunsTargetMetInSimulationPrinter( SIMULATION_PRINTER *printer );
+
+/*
+ * Worker processes simulate batches of consecutive runs on their own copies of the printer.  
+ * StartRunsBatchInSimulationPrinter switches a copy to recording, and after the batch 
+ * GetRunsBatchOfSimulationPrinter hands over what each run printed and sampled as an array 
+ * of doubles.  The parent passes the batches to MergeRunsBatchIntoSimulationPrinter in run 
+ * order, which replays them run by run; the statistics and the run meeting the runs target 
+ * are then exactly those of a serial simulation, whatever the number of workers.  The batch 
+ * size is fixed, and for any other printer these do nothing and the batch size is 1.
+ */
+DLLSCOPE UINT32 STDCALL GetRunsBatchSizeOfSimulationPrinter( SIMULATION_PRINTER *printer );
+DLLSCOPE RET_VAL STDCALL StartRunsBatchInSimulationPrinter( SIMULATION_PRINTER *printer );
+DLLSCOPE RET_VAL STDCALL GetRunsBatchOfSimulationPrinter( SIMULATION_PRINTER *printer, double **buffer, UINT32 *size );
+DLLSCOPE RET_VAL STDCALL MergeRunsBatchIntoSimulationPrinter( SIMULATION_PRINTER *printer, double *buffer, UINT32 size, 
+                                                              UINT32 *runs );
+
+END_C_NAMESPACE
+
+#endif
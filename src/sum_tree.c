@@ -0,0 +1,117 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the reb2sac contributors                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#include "sum_tree.h"
+
+DLLSCOPE SUM_TREE * STDCALL CreateSumTree( UINT32 size ) {
+    SUM_TREE *tree = NULL;
+    UINT32 capacity = 1;
+
+    START_FUNCTION("CreateSumTree");
+
+    while( capacity < size ) {
+        capacity <<= 1;
+    }
+    if( ( tree = (SUM_TREE*)MALLOC( sizeof(SUM_TREE) ) ) == NULL ) {
+        END_FUNCTION("CreateSumTree", FAILING );
+        return NULL;
+    }
+    if( ( tree->nodes = (double*)CALLOC( 2 * capacity, sizeof(double) ) ) == NULL ) {
+        FREE( tree );
+        END_FUNCTION("CreateSumTree", FAILING );
+        return NULL;
+    }
+    tree->size = size;
+    tree->capacity = capacity;
+
+    END_FUNCTION("CreateSumTree", SUCCESS );
+    return tree;
+}
+
+DLLSCOPE RET_VAL STDCALL FreeSumTree( SUM_TREE **tree ) {
+    RET_VAL ret = SUCCESS;
+
+    START_FUNCTION("FreeSumTree");
+
+    if( ( tree == NULL ) || ( *tree == NULL ) ) {
+        END_FUNCTION("FreeSumTree", SUCCESS );
+        return ret;
+    }
+    FREE( (*tree)->nodes );
+    FREE( *tree );
+    *tree = NULL;
+
+    END_FUNCTION("FreeSumTree", SUCCESS );
+    return ret;
+}
+
+DLLSCOPE RET_VAL STDCALL ResetSumTree( SUM_TREE *tree ) {
+    RET_VAL ret = SUCCESS;
+
+    memset( tree->nodes, 0, 2 * tree->capacity * sizeof(double) );
+    return ret;
+}
+
+/*
+ * Sets the index-th value and recomputes the sums on its path to the root.  Parents 
+ * are recomputed from their children rather than adjusted by the difference, so no 
+ * rounding error accumulates over many updates.
+ */
+DLLSCOPE RET_VAL STDCALL UpdateValueInSumTree( SUM_TREE *tree, UINT32 index, double value ) {
+    RET_VAL ret = SUCCESS;
+    double *nodes = tree->nodes;
+    UINT32 k = 0;
+
+    if( index >= tree->size ) {
+        return ErrorReport( FAILING, "UpdateValueInSumTree", "index %lu is out of range", index );
+    }
+    k = tree->capacity + index;
+    nodes[k] = value;
+    for( k >>= 1; k > 0; k >>= 1 ) {
+        nodes[k] = nodes[2 * k] + nodes[2 * k + 1];
+    }
+    return ret;
+}
+
+DLLSCOPE double STDCALL GetValueInSumTree( SUM_TREE *tree, UINT32 index ) {
+    return tree->nodes[tree->capacity + index];
+}
+
+DLLSCOPE double STDCALL GetTotalInSumTree( SUM_TREE *tree ) {
+    return tree->nodes[1];
+}
+
+/*
+ * Returns the index i such that the sum of values before i is at most threshold and 
+ * the sum up to and including i exceeds it.  Thresholds at or beyond the total, which 
+ * can only come from rounding, resolve to the last non-zero value.
+ */
+DLLSCOPE UINT32 STDCALL FindIndexInSumTree( SUM_TREE *tree, double threshold ) {
+    double *nodes = tree->nodes;
+    UINT32 capacity = tree->capacity;
+    UINT32 k = 1;
+
+    while( k < capacity ) {
+        k <<= 1;
+        if( ( threshold >= nodes[k] ) && ( nodes[k + 1] > 0.0 ) ) {
+            threshold -= nodes[k];
+            k++;
+        }
+    }
+    return k - capacity;
+}
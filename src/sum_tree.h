@@ -0,0 +1,49 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the reb2sac contributors                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#if !defined(HAVE_SUM_TREE)
+#define HAVE_SUM_TREE
+
+#include "common.h"
+
+BEGIN_C_NAMESPACE
+
+/*
+ * A complete binary tree of partial sums over size non-negative values.  Leaves 
+ * are stored from nodes[capacity] on, and nodes[k] holds the sum of nodes[2k] and 
+ * nodes[2k+1], so nodes[1] is always the current total.  Updating a value and 
+ * selecting the value that a cumulative threshold falls into are both O(log size).
+ */
+typedef struct {
+    double *nodes;
+    UINT32 size;
+    UINT32 capacity;
+} SUM_TREE;
+
+DLLSCOPE SUM_TREE * STDCALL CreateSumTree( UINT32 size );
+DLLSCOPE RET_VAL STDCALL FreeSumTree( SUM_TREE **tree );
+
+DLLSCOPE RET_VAL STDCALL ResetSumTree( SUM_TREE *tree );
+DLLSCOPE RET_VAL STDCALL UpdateValueInSumTree( SUM_TREE *tree, UINT32 index, double value );
+DLLSCOPE double STDCALL GetValueInSumTree( SUM_TREE *tree, UINT32 index );
+DLLSCOPE double STDCALL GetTotalInSumTree( SUM_TREE *tree );
+DLLSCOPE UINT32 STDCALL FindIndexInSumTree( SUM_TREE *tree, double threshold );
+
+END_C_NAMESPACE
+
+#endif
@@ -0,0 +1,44 @@
+#!/bin/sh
+#
+# Simulates the birth-death model with the tsd printer and with the binary printer, converts 
+# the binary runs back with reb2sac_convert and requires them to match the tsd runs byte for 
+# byte.  Run from the build directory; srcdir points at the sources.
+#
+srcdir=${srcdir:-.}
+REB2SAC=${REB2SAC:-`pwd`/reb2sac}
+REB2SAC_CONVERT=${REB2SAC_CONVERT:-`pwd`/reb2sac_convert}
+work=`mktemp -d 2>/dev/null || echo /tmp/reb2sac_roundtrip.$$`
+mkdir -p $work
+trap 'rm -rf $work' 0 1 2 15
+
+cp $srcdir/tests/birth_death.xml $work/ || exit 1
+
+simulate() {
+    mkdir -p $work/$1
+    cat > $work/birth_death.properties <<END
+reb2sac.interesting.species.1=X
+monte.carlo.simulation.time.limit=20.0
+monte.carlo.simulation.print.interval=0.5
+monte.carlo.simulation.random.seed=314159
+monte.carlo.simulation.runs=3
+monte.carlo.simulation.out.dir=$work/$1
+simulation.printer=$2
+END
+    ( cd $work && $REB2SAC --target.encoding=gillespie birth_death.xml > $work/$1.log 2>&1 ) || {
+        cat $work/$1.log
+        echo "reb2sac failed with $2"
+        exit 1
+    }
+}
+
+simulate tsd tsd.printer
+simulate bin bin.printer
+
+for i in 1 2 3; do
+    $REB2SAC_CONVERT --tsd $work/bin/run-$i.bin $work/bin/run-$i.tsd || exit 1
+    if ! cmp $work/tsd/run-$i.tsd $work/bin/run-$i.tsd; then
+        echo "run-$i.bin does not convert back to run-$i.tsd"
+        exit 1
+    fi
+done
+exit 0
@@ -0,0 +1,62 @@
+#!/bin/sh
+#
+# Simulates the birth-death model with the iSSA engine in mpde mode and with the gillespie 
+# statistics printer, and requires the mean and the variance of X, averaged over 10 <= t <= 20, 
+# to be near the stationary mean and variance k / d = 10.  The seed is fixed, so the outcome 
+# is reproducible; the tolerances are about four standard errors for 2000 runs.  Run from the 
+# build directory; srcdir points at the sources.
+#
+srcdir=${srcdir:-.}
+REB2SAC=${REB2SAC:-`pwd`/reb2sac}
+work=`mktemp -d 2>/dev/null || echo /tmp/reb2sac_birth_death.$$`
+mkdir -p $work
+trap 'rm -rf $work' 0 1 2 15
+
+cp $srcdir/tests/birth_death.xml $work/ || exit 1
+
+simulate() {
+    mkdir -p $work/$1
+    cat > $work/birth_death.properties <<END
+reb2sac.interesting.species.1=X
+reb2sac.iSSA.type=mpde
+monte.carlo.simulation.time.limit=20.0
+monte.carlo.simulation.time.step=0.5
+monte.carlo.simulation.print.interval=0.5
+monte.carlo.simulation.random.seed=161803
+monte.carlo.simulation.runs=2000
+monte.carlo.simulation.statistics=true
+monte.carlo.simulation.run.files=false
+monte.carlo.simulation.out.dir=$work/$1
+simulation.printer=tsd.printer
+END
+    ( cd $work && $REB2SAC --target.encoding=$2 birth_death.xml > $work/$1.log 2>&1 ) || {
+        cat $work/$1.log
+        echo "reb2sac failed with $2"
+        exit 1
+    }
+}
+
+# prints the average of column X of a tsd file over 10 <= t <= 20
+average() {
+    tr -d ' ' < $1 | awk '{ gsub( /\),\(/, "\n" ); gsub( /[()]/, "" ); print }' | awk -F, '
+        NR == 1 { for( i = 1; i <= NF; i++ ) if( $i == "\"X\"" ) column = i; next }
+        column && ( $1 >= 10 ) && ( $1 <= 20 ) { sum += $column; n++ }
+        END { if( n == 0 ) exit 1; printf( "%g\n", sum / n ) }'
+}
+
+# requires the value to lie within tolerance of expected
+check() {
+    if ! awk -v v=$2 -v e=$3 -v t=$4 'BEGIN { d = v - e; if( d < 0 ) d = -d; exit !( d <= t ) }'; then
+        echo "$1 is $2, expected $3 within $4"
+        exit 1
+    fi
+}
+
+for encoding in iSSA gillespie; do
+    simulate $encoding $encoding
+    mean=`average $work/$encoding/mean.tsd` || { echo "no mean of X with $encoding"; exit 1; }
+    variance=`average $work/$encoding/variance.tsd` || { echo "no variance of X with $encoding"; exit 1; }
+    check "the $encoding mean" $mean 10 0.5
+    check "the $encoding variance" $variance 10 1.5
+done
+exit 0
@@ -0,0 +1,46 @@
+#!/bin/sh
+#
+# Simulates the birth-death model serially and then several times on worker processes, and 
+# requires every run file and every statistics file to match the serial ones byte for byte.  
+# Run from the build directory; srcdir points at the sources.
+#
+srcdir=${srcdir:-.}
+REB2SAC=${REB2SAC:-`pwd`/reb2sac}
+work=`mktemp -d 2>/dev/null || echo /tmp/reb2sac_concurrent.$$`
+mkdir -p $work
+trap 'rm -rf $work' 0 1 2 15
+
+cp $srcdir/tests/birth_death.xml $work/ || exit 1
+
+simulate() {
+    mkdir -p $work/$1
+    cat > $work/birth_death.properties <<END
+reb2sac.interesting.species.1=X
+monte.carlo.simulation.time.limit=20.0
+monte.carlo.simulation.print.interval=0.5
+monte.carlo.simulation.random.seed=271828
+monte.carlo.simulation.runs=40
+monte.carlo.simulation.threads=$2
+monte.carlo.simulation.statistics=true
+monte.carlo.simulation.out.dir=$work/$1
+simulation.printer=tsd.printer
+END
+    ( cd $work && $REB2SAC --target.encoding=gillespie birth_death.xml > $work/$1.log 2>&1 ) || {
+        cat $work/$1.log
+        echo "reb2sac failed with $2 threads"
+        exit 1
+    }
+}
+
+simulate serial 1
+for threads in 2 4 8 4 8; do
+    simulate parallel $threads
+    for file in `cd $work/serial && ls *.tsd`; do
+        if ! cmp $work/serial/$file $work/parallel/$file; then
+            echo "$file differs with $threads threads"
+            exit 1
+        fi
+    done
+    rm -rf $work/parallel
+done
+exit 0
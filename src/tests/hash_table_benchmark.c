@@ -0,0 +1,212 @@
+/***************************************************************************
+ *  Micro-benchmark of HASH_TABLE against the chained table it replaced.
+ *
+ *  Builds keys shaped like model ids ("species_17", "reaction_3", ...), then
+ *  times puts, repeated lookups and removals on the open-addressing
+ *  HASH_TABLE and on a copy of the former design: bucket_size linked-list
+ *  buckets indexed by ComputeBucketIndex, one malloc'd entry per key.  Both
+ *  tables are created with 128 buckets, as the managers create theirs.
+ *
+ *  "make benchmark" builds and runs it.  The arguments are the number of keys
+ *  (default 20000) and the number of lookup rounds (default 20).  It exits
+ *  with 1 if the two tables disagree on a value; the timings are only printed.
+ ***************************************************************************/
+#include <time.h>
+#include "hash_table.h"
+
+#define BENCHMARK_BUCKETS 128
+
+UINT32 ComputeBucketIndex( CADDR_T key, UINT32 key_size, UINT32 bucket_size );
+
+typedef struct {
+    CADDR_T key;
+    UINT32 key_size;
+    CADDR_T value;
+} CHAINED_ENTRY;
+
+typedef struct {
+    LINKED_LIST **buckets;
+    UINT32 bucket_size;
+} CHAINED_TABLE;
+
+static CHAINED_TABLE *_CreateChainedTable( UINT32 bucket_size );
+static void _DeleteChainedTable( CHAINED_TABLE *table );
+static CHAINED_ENTRY *_FindInChainedTable( CADDR_T key, UINT32 key_size, CHAINED_TABLE *table, BOOL remove );
+static RET_VAL _PutInChainedTable( CADDR_T key, UINT32 key_size, CADDR_T value, CHAINED_TABLE *table );
+static double _Seconds( clock_t start );
+
+
+int main( int argc, char *argv[] ) {
+    UINT32 i = 0;
+    UINT32 round = 0;
+    UINT32 size = 20000;
+    UINT32 rounds = 20;
+    UINT32 mismatches = 0;
+    char **keys = NULL;
+    HASH_TABLE *table = NULL;
+    CHAINED_TABLE *chained = NULL;
+    CHAINED_ENTRY *entry = NULL;
+    clock_t start;
+    double times[2][3];
+    static const char *prefixes[] = { "species_", "reaction_", "parameter_", "compartment_" };
+
+    if( argc > 1 ) {
+        size = (UINT32)atol( argv[1] );
+    }
+    if( argc > 2 ) {
+        rounds = (UINT32)atol( argv[2] );
+    }
+    if( ( size == 0 ) || ( ( keys = (char**)MALLOC( size * sizeof(char*) ) ) == NULL ) ) {
+        fprintf( stderr, "usage: %s [keys [rounds]]" NEW_LINE, argv[0] );
+        return 2;
+    }
+    for( i = 0; i < size; i++ ) {
+        if( ( keys[i] = (char*)MALLOC( 32 ) ) == NULL ) {
+            return 2;
+        }
+        sprintf( keys[i], "%s%lu", prefixes[i % 4], (unsigned long)( i / 4 ) );
+    }
+    if( ( ( table = CreateHashTable( BENCHMARK_BUCKETS ) ) == NULL ) ||
+        ( ( chained = _CreateChainedTable( BENCHMARK_BUCKETS ) ) == NULL ) ) {
+        return 2;
+    }
+
+    start = clock();
+    for( i = 0; i < size; i++ ) {
+        _PutInChainedTable( keys[i], strlen( keys[i] ), (CADDR_T)keys[i], chained );
+    }
+    times[0][0] = _Seconds( start );
+    start = clock();
+    for( round = 0; round < rounds; round++ ) {
+        for( i = 0; i < size; i++ ) {
+            entry = _FindInChainedTable( keys[i], strlen( keys[i] ), chained, FALSE );
+            if( ( entry == NULL ) || ( entry->value != (CADDR_T)keys[i] ) ) {
+                mismatches++;
+            }
+        }
+    }
+    times[0][1] = _Seconds( start );
+    start = clock();
+    for( i = 0; i < size; i++ ) {
+        if( ( entry = _FindInChainedTable( keys[i], strlen( keys[i] ), chained, TRUE ) ) != NULL ) {
+            FREE( entry );
+        }
+    }
+    times[0][2] = _Seconds( start );
+
+    start = clock();
+    for( i = 0; i < size; i++ ) {
+        PutInHashTable( keys[i], strlen( keys[i] ), (CADDR_T)keys[i], table );
+    }
+    times[1][0] = _Seconds( start );
+    start = clock();
+    for( round = 0; round < rounds; round++ ) {
+        for( i = 0; i < size; i++ ) {
+            if( GetValueFromHashTable( keys[i], strlen( keys[i] ), table ) != (CADDR_T)keys[i] ) {
+                mismatches++;
+            }
+        }
+    }
+    times[1][1] = _Seconds( start );
+    start = clock();
+    for( i = 0; i < size; i++ ) {
+        RemoveFromHashTable( keys[i], strlen( keys[i] ), table );
+    }
+    times[1][2] = _Seconds( start );
+    if( table->entry_count != 0 ) {
+        mismatches++;
+    }
+
+    printf( "%lu keys, %lu lookup rounds, %i buckets" NEW_LINE, (unsigned long)size, (unsigned long)rounds, BENCHMARK_BUCKETS );
+    printf( "%-16s %10s %10s %10s" NEW_LINE, "table", "put (s)", "get (s)", "remove (s)" );
+    printf( "%-16s %10.4f %10.4f %10.4f" NEW_LINE, "chained", times[0][0], times[0][1], times[0][2] );
+    printf( "%-16s %10.4f %10.4f %10.4f" NEW_LINE, "open addressing", times[1][0], times[1][1], times[1][2] );
+
+    DeleteHashTable( &table );
+    _DeleteChainedTable( chained );
+    for( i = 0; i < size; i++ ) {
+        FREE( keys[i] );
+    }
+    FREE( keys );
+    if( mismatches > 0 ) {
+        fprintf( stderr, "%lu lookups returned the wrong value" NEW_LINE, (unsigned long)mismatches );
+        return 1;
+    }
+    return 0;
+}
+
+static CHAINED_TABLE *_CreateChainedTable( UINT32 bucket_size ) {
+    UINT32 i = 0;
+    CHAINED_TABLE *table = NULL;
+
+    if( ( table = (CHAINED_TABLE*)MALLOC( sizeof(CHAINED_TABLE) ) ) == NULL ) {
+        return NULL;
+    }
+    if( ( table->buckets = (LINKED_LIST**)MALLOC( bucket_size * sizeof(LINKED_LIST*) ) ) == NULL ) {
+        FREE( table );
+        return NULL;
+    }
+    table->bucket_size = bucket_size;
+    for( i = 0; i < bucket_size; i++ ) {
+        if( ( table->buckets[i] = CreateLinkedList() ) == NULL ) {
+            _DeleteChainedTable( table );
+            return NULL;
+        }
+    }
+    return table;
+}
+
+static void _DeleteChainedTable( CHAINED_TABLE *table ) {
+    UINT32 i = 0;
+    CHAINED_ENTRY *entry = NULL;
+
+    for( i = 0; i < table->bucket_size; i++ ) {
+        if( table->buckets[i] == NULL ) {
+            continue;
+        }
+        ResetCurrentElement( table->buckets[i] );
+        while( ( entry = (CHAINED_ENTRY*)GetNextFromLinkedList( table->buckets[i] ) ) != NULL ) {
+            FREE( entry );
+        }
+        DeleteLinkedList( &(table->buckets[i]) );
+    }
+    FREE( table->buckets );
+    FREE( table );
+}
+
+/* the former lookup: a linear scan of the bucket the byte sum of the key selects */
+static CHAINED_ENTRY *_FindInChainedTable( CADDR_T key, UINT32 key_size, CHAINED_TABLE *table, BOOL remove ) {
+    LINKED_LIST *list = table->buckets[ComputeBucketIndex( key, key_size, table->bucket_size )];
+    CHAINED_ENTRY *entry = NULL;
+
+    ResetCurrentElement( list );
+    while( ( entry = (CHAINED_ENTRY*)GetNextFromLinkedList( list ) ) != NULL ) {
+        if( ( key_size == entry->key_size ) && ( memcmp( key, entry->key, key_size ) == 0 ) ) {
+            if( remove ) {
+                RemoveCurrentFromLinkedList( list );
+            }
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static RET_VAL _PutInChainedTable( CADDR_T key, UINT32 key_size, CADDR_T value, CHAINED_TABLE *table ) {
+    CHAINED_ENTRY *entry = NULL;
+
+    if( ( entry = _FindInChainedTable( key, key_size, table, FALSE ) ) != NULL ) {
+        entry->value = value;
+        return SUCCESS;
+    }
+    if( ( entry = (CHAINED_ENTRY*)MALLOC( sizeof(CHAINED_ENTRY) ) ) == NULL ) {
+        return FAILING;
+    }
+    entry->key = key;
+    entry->key_size = key_size;
+    entry->value = value;
+    return AddElementInLinkedList( (CADDR_T)entry, table->buckets[ComputeBucketIndex( key, key_size, table->bucket_size )] );
+}
+
+static double _Seconds( clock_t start ) {
+    return (double)( clock() - start ) / CLOCKS_PER_SEC;
+}
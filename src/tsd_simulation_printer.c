@@ -68,12 +68,10 @@ static RET_VAL _PrintStart( SIMULATION_PRINTER *printer, char *filenameStem ) {
     FILE *out = NULL;
     
     sprintf( filename, "%s.tsd", filenameStem );
-    if( ( out = fopen( filename, "w" ) ) == NULL ) {
+    if( ( out = OpenSimulationPrinterFile( printer, filename, "w" ) ) == NULL ) {
         TRACE_1( "could not open %s", filename );
         return FAILING;
     }
-    
-    printer->out = out;    
     fprintf( out, "(" );
     
     return ret;            
@@ -107,7 +105,6 @@ static RET_VAL _PrintHeader( SIMULATION_PRINTER *printer ) {
       }
     }
     fprintf( out, ")" );
-    fflush(out);
     
     return ret;            
 }
@@ -140,7 +137,6 @@ static RET_VAL _PrintValues( SIMULATION_PRINTER *printer, double time ) {
       }
     }                 
     fprintf( out, ")" );
-    fflush(out);
     
     return ret;            
 }
@@ -173,7 +169,6 @@ static RET_VAL _PrintConcentrationValues( SIMULATION_PRINTER *printer, double ti
       }
     }                 
     fprintf( out, ")" );
-    fflush(out);
     
     return ret;            
 }
@@ -184,12 +179,14 @@ static RET_VAL _PrintEnd( SIMULATION_PRINTER *printer ) {
     FILE *out = printer->out;
     
     fprintf( out, ")" );
-    fflush( out );
-    fclose( out );
+    ret = CloseSimulationPrinterFile( printer );
     return ret;            
 }
 
 static RET_VAL _Destroy( SIMULATION_PRINTER *printer ) {
+    if( printer->buffer != NULL ) {
+        FREE( printer->buffer );
+    }
     FREE( printer );
     return SUCCESS;
 }